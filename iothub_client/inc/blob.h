@@ -36,6 +36,24 @@ extern "C"
 #define MAX_BLOCK_COUNT 50000
 #endif
 
+/* Allow unit tests to override BLOB_BLOCK_UPLOAD_MAX_RETRIES */
+#ifndef BLOB_BLOCK_UPLOAD_MAX_RETRIES
+/* Number of times a block is sent again when storage answers with a server error (5xx) */
+#define BLOB_BLOCK_UPLOAD_MAX_RETRIES 2
+#endif
+
+/* Allow unit tests to override BLOB_BLOCK_UPLOAD_RETRY_INITIAL_DELAY_MS */
+#ifndef BLOB_BLOCK_UPLOAD_RETRY_INITIAL_DELAY_MS
+/* Milliseconds waited before sending a block again the first time; the wait doubles on each next retry */
+#define BLOB_BLOCK_UPLOAD_RETRY_INITIAL_DELAY_MS 1000
+#endif
+
+/* Allow unit tests to override BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS */
+#ifndef BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS
+/* Longest wait before sending a block again, the doubling stops there */
+#define BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS 8000
+#endif
+
 #define BLOB_RESULT_VALUES \
     BLOB_OK,               \
     BLOB_ERROR,            \
@@ -46,6 +64,8 @@ extern "C"
 
 DEFINE_ENUM(BLOB_RESULT, BLOB_RESULT_VALUES)
 
+typedef struct BLOB_UPLOAD_DATA_TAG* BLOB_UPLOAD_HANDLE;
+
 /**
 * @brief  Synchronously uploads a byte array to blob storage
 *
@@ -56,10 +76,34 @@ DEFINE_ENUM(BLOB_RESULT, BLOB_RESULT_VALUES)
 * @param  httpResponse      A BUFFER_HANDLE that receives the HTTP response from the server (available only when the return value is BLOB_OK)
 * @param  certificates      A null terminated string containing CA certificates to be used
 * @param    proxyOptions    A structure that contains optional web proxy information
+* @param  contentEncoding   Optional Content-Encoding stored with the blob, or NULL. The data is uploaded unchanged, so it must describe the bytes returned by getDataCallbackEx
 *
 * @return	A @c BLOB_RESULT. BLOB_OK means the blob has been uploaded successfully. Any other value indicates an error
 */
-MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadMultipleBlocksFromSasUri, const char*, SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, void*, context, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse, const char*, certificates, HTTP_PROXY_OPTIONS*, proxyOptions)
+MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadMultipleBlocksFromSasUri, const char*, SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, void*, context, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse, const char*, certificates, HTTP_PROXY_OPTIONS*, proxyOptions, const char*, contentEncoding)
+
+/**
+* @brief  Synchronously resumes an interrupted upload of a byte array to blob storage
+*
+* @details The blocks 0 to firstBlockID - 1 are assumed to have been uploaded already to the same SASURI
+*          and are only added to the committed block list. getDataCallbackEx shall return the data starting
+*          with block firstBlockID. The SAS URI and the number of acknowledged blocks need to be kept by the caller.
+*
+* @param  SASURI            The URI to use to upload data (the same one used by the interrupted upload)
+* @param  firstBlockID      The id of the first block to upload: the number of blocks already acknowledged by the server,
+*                           which is the id of the last acknowledged block plus one. The block whose upload failed is
+*                           not acknowledged and is returned again by getDataCallbackEx.
+* @param  getDataCallbackEx A callback to be invoked to acquire the file chunks to be uploaded, as well as to indicate the status of the upload of the previous block.
+* @param  context           Any data provided by the user to serve as context on getDataCallback.
+* @param  httpStatus        A pointer to an out argument receiving the HTTP status (available only when the return value is BLOB_OK)
+* @param  httpResponse      A BUFFER_HANDLE that receives the HTTP response from the server (available only when the return value is BLOB_OK)
+* @param  certificates      A null terminated string containing CA certificates to be used
+* @param    proxyOptions    A structure that contains optional web proxy information
+* @param  contentEncoding   Optional Content-Encoding stored with the blob, or NULL. The data is uploaded unchanged, so it must describe the bytes returned by getDataCallbackEx
+*
+* @return	A @c BLOB_RESULT. BLOB_OK means the blob has been uploaded successfully. Any other value indicates an error
+*/
+MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_ResumeMultipleBlocksFromSasUri, const char*, SASURI, unsigned int, firstBlockID, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, void*, context, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse, const char*, certificates, HTTP_PROXY_OPTIONS*, proxyOptions, const char*, contentEncoding)
 
 /**
 * @brief  Synchronously uploads a byte array as a new block to blob storage
@@ -72,8 +116,82 @@ MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadMultipleBlocksFromSasUri, const char
 * @param  httpStatus          A pointer to an out argument receiving the HTTP status (available only when the return value is BLOB_OK)
 * @param  httpResponse        A BUFFER_HANDLE that receives the HTTP response from the server (available only when the return value is BLOB_OK)
 */
-//MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadNextBlock, BUFFER_HANDLE, requestContent, unsigned int, blockID, STRING_HANDLE, xml, const char*, relativePath, HTTPAPIEX_HANDLE, httpApiExHandle, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse)
 MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadBlock, HTTPAPIEX_HANDLE, httpApiExHandle, const char*, relativePath, BUFFER_HANDLE, requestContent, unsigned int, blockID, STRING_HANDLE, blockIDList, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse)
+
+/**
+* @brief  Starts a block blob upload that is driven one block at a time by the caller
+*
+* @param  SASURI            The URI to use to upload data (a copy is made)
+* @param  certificates      A null terminated string containing CA certificates to be used
+* @param    proxyOptions    A structure that contains optional web proxy information
+*
+* @return	A @c BLOB_UPLOAD_HANDLE, or NULL on failure
+*/
+MOCKABLE_FUNCTION(, BLOB_UPLOAD_HANDLE, Blob_UploadCreate, const char*, SASURI, const char*, certificates, HTTP_PROXY_OPTIONS*, proxyOptions)
+
+/**
+* @brief  Synchronously uploads the next block of a blob started with Blob_UploadCreate
+*
+* @details Blob_UploadNextBlock sends a single request and never waits. When storage answers with a server error (5xx)
+*          the block is not counted and the caller may call Blob_UploadNextBlock again later with the same block.
+*
+* @param  blobUploadHandle  The handle returned by Blob_UploadCreate
+* @param  source            The data of the block (at most BLOCK_SIZE bytes)
+* @param  size              The size of source
+* @param  httpStatus        A pointer to an out argument receiving the HTTP status (available only when the return value is BLOB_OK)
+* @param  httpResponse      A BUFFER_HANDLE that receives the HTTP response from the server (available only when the return value is BLOB_OK)
+*
+* @return	A @c BLOB_RESULT. BLOB_OK means the request has been executed, httpStatus tells whether storage accepted the block
+*/
+MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadNextBlock, BLOB_UPLOAD_HANDLE, blobUploadHandle, const unsigned char*, source, size_t, size, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse)
+
+/**
+* @brief  Synchronously commits the blocks uploaded so far (Put Block List). Shall be called at most once per handle.
+*
+* @param  blobUploadHandle  The handle returned by Blob_UploadCreate
+* @param  contentEncoding   Optional Content-Encoding stored with the blob, or NULL
+* @param  httpStatus        A pointer to an out argument receiving the HTTP status (available only when the return value is BLOB_OK)
+* @param  httpResponse      A BUFFER_HANDLE that receives the HTTP response from the server (available only when the return value is BLOB_OK)
+*
+* @return	A @c BLOB_RESULT. BLOB_OK means the request has been executed
+*/
+MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadCommit, BLOB_UPLOAD_HANDLE, blobUploadHandle, const char*, contentEncoding, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse)
+
+/**
+* @brief  Frees the resources of a blob upload started with Blob_UploadCreate
+*/
+MOCKABLE_FUNCTION(, void, Blob_UploadDestroy, BLOB_UPLOAD_HANDLE, blobUploadHandle)
+
+typedef struct BLOB_FILE_MAPPING_TAG* BLOB_FILE_MAPPING_HANDLE;
+
+/**
+* @brief  Opens a local file, read only, so that its blocks can be handed to the upload with Blob_ReadFileBlock
+*
+* @details On Windows the file is mapped in memory. On POSIX platforms it is only kept open: a mapping would raise SIGBUS
+*          if another process truncated the file during the upload.
+*
+* @param  filePath          The path of the file
+* @param  size              An out argument receiving the size of the file
+*
+* @return	A @c BLOB_FILE_MAPPING_HANDLE to be released with Blob_UnmapFile, or NULL if the file cannot be opened or the platform has no file mapping
+*/
+MOCKABLE_FUNCTION(, BLOB_FILE_MAPPING_HANDLE, Blob_MapFile, const char*, filePath, size_t*, size)
+
+/**
+* @brief  Returns size bytes of a file opened with Blob_MapFile, starting at offset
+*
+* @details On Windows data points into the mapping. On POSIX platforms the bytes are read into a buffer owned by fileMapping.
+*          data is valid until the next call or Blob_UnmapFile. The call fails if the file was truncated after Blob_MapFile.
+*
+* @return	0 on success, a non-zero value otherwise
+*/
+MOCKABLE_FUNCTION(, int, Blob_ReadFileBlock, BLOB_FILE_MAPPING_HANDLE, fileMapping, size_t, offset, size_t, size, const unsigned char**, data)
+
+/**
+* @brief  Unmaps or closes a file opened with Blob_MapFile
+*/
+MOCKABLE_FUNCTION(, void, Blob_UnmapFile, BLOB_FILE_MAPPING_HANDLE, fileMapping)
+
 #ifdef __cplusplus
 }
 #endif
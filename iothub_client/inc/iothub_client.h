@@ -377,9 +377,21 @@ extern "C"
     * @param destinationFileName      The name of the file to be created in Azure Blob Storage.
     * @param getDataCallbackEx        A callback to be invoked to acquire the file chunks to be uploaded, as well as to indicate the status of the upload of the previous block.
     * @param context                  Any data provided by the user to serve as context on getDataCallback.
+    * @remarks                        The upload is carried out by the worker thread through IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx, one
+    *                                 request to Azure Storage per IoTHubClient_LL_DoWork, instead of by a thread of its own. @p getDataCallbackEx
+    *                                 is therefore called on the worker thread while the client lock is held, and must not call other
+    *                                 IoTHubClient APIs with the same handle.
     * @returns                        An IOTHUB_CLIENT_RESULT value indicating the success or failure of the API call.*/
     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_UploadMultipleBlocksToBlobAsyncEx, IOTHUB_CLIENT_HANDLE, iotHubClientHandle, const char*, destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, void*, context);
 
+    /**
+    * @brief                          Sets the callback notified of the progress of the uploads started by IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex).
+    * @param iotHubClientHandle       The handle created by a call to the IoTHubClient_Create function.
+    * @param progressCallback         The callback invoked, from the worker thread, after every block Azure Storage accepts. NULL stops the notifications.
+    * @param userContextCallback      User specified context that will be provided to the callback. This can be @c NULL.
+    * @returns                        An IOTHUB_CLIENT_RESULT value indicating the success or failure of the API call.*/
+    MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_SetFileUploadProgressCallback, IOTHUB_CLIENT_HANDLE, iotHubClientHandle, IOTHUB_CLIENT_FILE_UPLOAD_PROGRESS_CALLBACK, progressCallback, void*, userContextCallback);
+
 #endif /* DONT_USE_UPLOADTOBLOB */
 
 #ifdef __cplusplus
@@ -0,0 +1,22 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef IOTHUB_CLIENT_HASH_H
+#define IOTHUB_CLIENT_HASH_H
+
+#include <stdint.h>
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 32 bit FNV-1a hash of a null-terminated string, used to index the AMQP device registry and the pending twin operations.
+MOCKABLE_FUNCTION(, uint32_t, iothub_client_hash_string, const char*, value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTHUB_CLIENT_HASH_H
@@ -214,6 +214,14 @@ DEFINE_ENUM(IOTHUB_CLIENT_IOTHUB_METHOD_STATUS, IOTHUB_CLIENT_IOTHUB_METHOD_STAT
     */
     typedef void(*IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK)(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context);
     typedef IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT (*IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX)(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context);
+
+    /**
+    *  @brief                       Callback invoked while IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx uploads are advanced.
+    *  @param destinationFileName   The destinationFileName given when the upload was started.
+    *  @param bytesUploaded         Total number of bytes of that upload stored by Azure Storage so far.
+    *  @param context               User context provided on the call to IoTHubClient_LL_SetFileUploadProgressCallback.
+    */
+    typedef void(*IOTHUB_CLIENT_FILE_UPLOAD_PROGRESS_CALLBACK)(const char* destinationFileName, size_t bytesUploaded, void* context);
 #endif /* DONT_USE_UPLOADTOBLOB */
 
     /** @brief	This struct captures IoTHub client configuration. */
@@ -593,6 +601,23 @@ DEFINE_ENUM(IOTHUB_CLIENT_IOTHUB_METHOD_STATUS, IOTHUB_CLIENT_IOTHUB_METHOD_STAT
     */
      MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_UploadToBlob, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, destinationFileName, const unsigned char*, source, size_t, size);
 
+    /**
+    * @brief	This API uploads to Azure Storage the content of the local file @p localFilePath
+    *           under the blob name devicename/@pdestinationFileName
+    *
+    * @param	iotHubClientHandle	    The handle created by a call to the create function.
+    * @param	destinationFileName     name of the file.
+    * @param	localFilePath           path of the local file to upload.
+    *
+    * @remarks  Only one block of the file is held in memory at a time, and the block size is chosen
+    *           from the size of the file so that it fits in the 50000 blocks a blob can have. The upload
+    *           fails if the file is truncated while it is uploaded. Only Windows and POSIX platforms
+    *           support this API.
+    *
+    * @return	IOTHUB_CLIENT_OK upon success or an error code upon failure.
+    */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_UploadFileToBlob, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, destinationFileName, const char*, localFilePath);
+
      /**
      ** DEPRECATED: Use IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx instead **
      * @brief    This API uploads to Azure Storage the content provided block by block by @p getDataCallback
@@ -621,6 +646,78 @@ DEFINE_ENUM(IOTHUB_CLIENT_IOTHUB_METHOD_STATUS, IOTHUB_CLIENT_IOTHUB_METHOD_STAT
      */
      MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_UploadMultipleBlocksToBlobEx, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, void*, context);
 
+     /**
+     * @brief    This API starts uploading to Azure Storage the content provided block by block by @p getDataCallbackEx
+     *           under the blob name devicename/@pdestinationFileName. The upload is carried out by IoTHubClient_LL_DoWork.
+     *
+     * @param    iotHubClientHandle      The handle created by a call to the create function.
+     * @param    destinationFileName     name of the file.
+     * @param    getDataCallbackEx       A callback to be invoked to acquire the file chunks to be uploaded, as well as to indicate the status of the upload of the previous block.
+     * @param    context                 Any data provided by the user to serve as context on getDataCallbackEx.
+     *
+     * @remarks  No network I/O happens in this call. Each subsequent call to IoTHubClient_LL_DoWork advances one of the
+     *           pending uploads, in turn, by one synchronous request to Azure Storage (plus the notification to IoTHub
+     *           when that upload ends), asking @p getDataCallbackEx for one block at a time. The requests still block:
+     *           IoTHubClient_LL_DoWork takes as long as that round trip, up to a block of BLOCK_SIZE bytes, but never
+     *           as long as the whole upload. The callback set with IoTHubClient_LL_SetFileUploadProgressCallback is
+     *           called after every block Azure Storage accepts. A block refused with a server error is sent again by a
+     *           later call to IoTHubClient_LL_DoWork once a back-off delay has elapsed, never by sleeping, so the data
+     *           handed out by @p getDataCallbackEx must stay valid until its next call. The final call to @p getDataCallbackEx has @c data and
+     *           @c size set to NULL and reports the outcome of the whole upload. Uploads still pending when the handle
+     *           is destroyed are reported as @c FILE_UPLOAD_ERROR.
+     *
+     * @return   IOTHUB_CLIENT_OK if the upload was queued or an error code upon failure.
+     */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, void*, context);
+
+     /**
+     * @brief    Sets the callback notified of the progress of the uploads started by IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx.
+     *
+     * @param    iotHubClientHandle      The handle created by a call to the create function.
+     * @param    progressCallback        The callback invoked after every block Azure Storage accepts. NULL stops the notifications.
+     * @param    userContextCallback     User specified context that will be provided to the callback. This can be @c NULL.
+     *
+     * @return   IOTHUB_CLIENT_OK upon success or an error code upon failure.
+     */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_SetFileUploadProgressCallback, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, IOTHUB_CLIENT_FILE_UPLOAD_PROGRESS_CALLBACK, progressCallback, void*, userContextCallback);
+
+    /**
+     * @brief    This API returns a resume token for the upload that the last call to IoTHubClient_LL_UploadMultipleBlocksToBlobEx
+     *           or IoTHubClient_LL_ResumeMultipleBlocksToBlobEx left interrupted by an HTTP error.
+     *
+     * @param    iotHubClientHandle      The handle created by a call to the create function.
+     * @param    resumeToken             Receives a null terminated string holding the correlation id IoTHub gave to the upload,
+     *                                   the SAS URI of its blob and the number of blocks Azure Storage stored. The application
+     *                                   can persist it to resume the upload after a restart, and shall free it with free().
+     * @param    bytesUploaded           Receives the number of bytes Azure Storage stored, that is the offset in the source
+     *                                   data of the first byte to be returned when resuming.
+     *
+     * @remarks  Uploads are only kept for resuming when the option OPTION_BLOB_UPLOAD_RESUMABLE is set to true. Only the
+     *           latest interrupted upload is kept. Once a resume token is taken the application owns the upload: IoTHub is
+     *           not told it failed when the handle is destroyed, and resuming it with a callback that returns
+     *           IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT reports it as aborted.
+     *
+     * @return   IOTHUB_CLIENT_OK upon success, IOTHUB_CLIENT_ERROR if there is no interrupted upload or upon failure.
+     */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_GetFileUploadResumeToken, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, char**, resumeToken, size_t*, bytesUploaded);
+
+    /**
+     * @brief    This API resumes an interrupted upload, reusing its blob and the correlation id IoTHub gave to it.
+     *
+     * @param    iotHubClientHandle      The handle created by a call to the create function. It does not need to be the
+     *                                   handle the upload was started with, but it shall use the same device credentials.
+     * @param    resumeToken             A token returned by IoTHubClient_LL_GetFileUploadResumeToken.
+     * @param    getDataCallbackEx       A callback to be invoked to acquire the file chunks that follow the first
+     *                                   @c bytesUploaded bytes reported with @p resumeToken. Chunks may have any size.
+     * @param    context                 Any data provided by the user to serve as context on getDataCallbackEx.
+     *
+     * @remarks  If the upload is interrupted again it is kept as the interrupted upload; a new resume token reports the
+     *           progress made, while @p resumeToken stays valid and resumes it from the same point as before.
+     *
+     * @return   IOTHUB_CLIENT_OK upon success, IOTHUB_CLIENT_INVALID_ARG if @p resumeToken is malformed or an error code upon failure.
+     */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_ResumeMultipleBlocksToBlobEx, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, resumeToken, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, void*, context);
+
 #endif /*DONT_USE_UPLOADTOBLOB*/
 
 #ifdef __cplusplus
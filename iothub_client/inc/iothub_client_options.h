@@ -31,12 +31,18 @@ extern "C"
     static STATIC_VAR_UNUSED const char* OPTION_SAS_TOKEN_LIFETIME = "sas_token_lifetime";
     static STATIC_VAR_UNUSED const char* OPTION_SAS_TOKEN_REFRESH_TIME = "sas_token_refresh_time";
     static STATIC_VAR_UNUSED const char* OPTION_CBS_REQUEST_TIMEOUT = "cbs_request_timeout";
+    static STATIC_VAR_UNUSED const char* OPTION_SAS_TOKEN_REFRESH_JITTER = "sas_token_refresh_jitter";
+    static STATIC_VAR_UNUSED const char* OPTION_AMQP_CONNECTION_COUNT = "amqp_connection_count";
 
     static STATIC_VAR_UNUSED const char* OPTION_MIN_POLLING_TIME = "MinimumPollingTime";
+    static STATIC_VAR_UNUSED const char* OPTION_MAX_POLLING_TIME = "MaximumPollingTime";
     static STATIC_VAR_UNUSED const char* OPTION_BATCHING = "Batching";
+    static STATIC_VAR_UNUSED const char* OPTION_HTTP_MAX_DEVICES_PER_DOWORK = "MaxDevicesPerDoWork";
 
     static STATIC_VAR_UNUSED const char* OPTION_MESSAGE_TIMEOUT = "messageTimeout";
     static STATIC_VAR_UNUSED const char* OPTION_BLOB_UPLOAD_TIMEOUT_SECS = "blob_upload_timeout_secs";
+    static STATIC_VAR_UNUSED const char* OPTION_BLOB_UPLOAD_CONTENT_ENCODING = "blob_upload_content_encoding";
+    static STATIC_VAR_UNUSED const char* OPTION_BLOB_UPLOAD_RESUMABLE = "blob_upload_resumable";
     static STATIC_VAR_UNUSED const char* OPTION_PRODUCT_INFO = "product_info";
 
     /*
@@ -8,9 +8,157 @@
 
 #include "azure_c_shared_utility/httpapiex.h"
 #include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/threadapi.h"
 #include "azure_c_shared_utility/base64.h"
 #include "azure_c_shared_utility/shared_util_options.h"
 
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+/*returns the base64 encoding of blockID, to be STRING_delete'd by the caller*/
+static STRING_HANDLE encodeBlockID(unsigned int blockID)
+{
+    STRING_HANDLE result;
+    char temp[7]; /*this will contain 000000... 049999*/
+    if (sprintf(temp, "%6u", (unsigned int)blockID) != 6) /*produces 000000... 049999*/
+    {
+        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+        LogError("failed to sprintf");
+        result = NULL;
+    }
+    else
+    {
+        result = Base64_Encode_Bytes((const unsigned char*)temp, 6);
+        if (result == NULL)
+        {
+            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+            LogError("unable to Base64_Encode_Bytes");
+        }
+    }
+    return result;
+}
+
+/*appends <Latest>id</Latest> to blockIDList, where id is the base64 encoding of blockID; returns the encoded id, to be STRING_delete'd by the caller*/
+static STRING_HANDLE addBlockID(unsigned int blockID, STRING_HANDLE blockIDList)
+{
+    STRING_HANDLE result = encodeBlockID(blockID);
+    if (result != NULL)
+    {
+        /*add the blockId base64 encoded to the XML*/
+        if (!(
+            (STRING_concat(blockIDList, "<Latest>") == 0) &&
+            (STRING_concat_with_STRING(blockIDList, result) == 0) &&
+            (STRING_concat(blockIDList, "</Latest>") == 0)
+            ))
+        {
+            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+            LogError("unable to STRING_concat");
+            STRING_delete(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+/*uploads one block (Put Block), sending it again at most maxRetries times while storage answers with a server error. When blockIDList is NULL the id of the block is already in the list*/
+static BLOB_RESULT uploadBlock(
+        HTTPAPIEX_HANDLE httpApiExHandle,
+        const char* relativePath,
+        BUFFER_HANDLE requestContent,
+        unsigned int blockID,
+        STRING_HANDLE blockIDList,
+        unsigned int maxRetries,
+        unsigned int* httpStatus,
+        BUFFER_HANDLE httpResponse)
+{
+    BLOB_RESULT result;
+    STRING_HANDLE blockIdString = (blockIDList == NULL) ? encodeBlockID(blockID) : addBlockID(blockID, blockIDList);
+    if (blockIdString == NULL)
+    {
+        LogError("unable to add the block id to the block list");
+        result = BLOB_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_BLOB_02_022: [ Blob_UploadMultipleBlocksFromSasUri shall construct a new relativePath from following string: base relativePath + "&comp=block&blockid=BASE64 encoded string of blockId" ]*/
+        STRING_HANDLE newRelativePath = STRING_construct(relativePath);
+        if (newRelativePath == NULL)
+        {
+            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+            LogError("unable to STRING_construct");
+            result = BLOB_ERROR;
+        }
+        else
+        {
+            if (!(
+                (STRING_concat(newRelativePath, "&comp=block&blockid=") == 0) &&
+                (STRING_concat_with_STRING(newRelativePath, blockIdString) == 0)
+                ))
+            {
+                /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+                LogError("unable to STRING concatenate");
+                result = BLOB_ERROR;
+            }
+            else
+            {
+                HTTPAPIEX_RESULT httpApiExResult;
+                unsigned int retryCount = 0;
+                unsigned int retryDelayInMs = BLOB_BLOCK_UPLOAD_RETRY_INITIAL_DELAY_MS;
+
+                /*Codes_SRS_BLOB_02_024: [ Blob_UploadMultipleBlocksFromSasUri shall call HTTPAPIEX_ExecuteRequest with a PUT operation, passing httpStatus and httpResponse. ]*/
+                /*Codes_SRS_BLOB_09_001: [ If the HTTP response code is >=500, Blob_UploadMultipleBlocksFromSasUri shall call HTTPAPIEX_ExecuteRequest again for the same block, at most BLOB_BLOCK_UPLOAD_MAX_RETRIES times, before evaluating the response code as above. ]*/
+                while (((httpApiExResult = HTTPAPIEX_ExecuteRequest(
+                    httpApiExHandle,
+                    HTTPAPI_REQUEST_PUT,
+                    STRING_c_str(newRelativePath),
+                    NULL,
+                    requestContent,
+                    httpStatus,
+                    NULL,
+                    httpResponse)) == HTTPAPIEX_OK) &&
+                    (*httpStatus >= 500) &&
+                    (retryCount < maxRetries)
+                    )
+                {
+                    LogInfo("HTTP status from storage is %u for block %u, uploading the block again in %u ms", *httpStatus, blockID, retryDelayInMs);
+
+                    /*Codes_SRS_BLOB_09_020: [ Before each retry Blob_UploadMultipleBlocksFromSasUri shall wait using ThreadAPI_Sleep, BLOB_BLOCK_UPLOAD_RETRY_INITIAL_DELAY_MS milliseconds before the first retry and twice as long as the previous wait before each next one, but never longer than BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS milliseconds. ]*/
+                    ThreadAPI_Sleep(retryDelayInMs);
+                    retryDelayInMs = (retryDelayInMs > BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS / 2) ? BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS : retryDelayInMs * 2;
+                    retryCount++;
+                }
+
+                if (httpApiExResult != HTTPAPIEX_OK)
+                {
+                    /*Codes_SRS_BLOB_02_025: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
+                    LogError("unable to HTTPAPIEX_ExecuteRequest");
+                    result = BLOB_HTTP_ERROR;
+                }
+                else if (*httpStatus >= 300)
+                {
+                    /*Codes_SRS_BLOB_02_026: [ Otherwise, if HTTP response code is >=300 then Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
+                    LogError("HTTP status from storage does not indicate success (%d)", (int)*httpStatus);
+                    result = BLOB_OK;
+                }
+                else
+                {
+                    /*Codes_SRS_BLOB_02_027: [ Otherwise Blob_UploadMultipleBlocksFromSasUri shall continue execution. ]*/
+                    result = BLOB_OK;
+                }
+            }
+            STRING_delete(newRelativePath);
+        }
+        STRING_delete(blockIdString);
+    }
+    return result;
+}
+
 BLOB_RESULT Blob_UploadBlock(
         HTTPAPIEX_HANDLE httpApiExHandle,
         const char* relativePath,
@@ -34,347 +182,667 @@ BLOB_RESULT Blob_UploadBlock(
     }
     else
     {
-        char temp[7]; /*this will contain 000000... 049999*/
-        if (sprintf(temp, "%6u", (unsigned int)blockID) != 6) /*produces 000000... 049999*/
+        result = uploadBlock(httpApiExHandle, relativePath, requestContent, blockID, blockIDList, BLOB_BLOCK_UPLOAD_MAX_RETRIES, httpStatus, httpResponse);
+    }
+    return result;
+}
+
+typedef struct BLOB_UPLOAD_DATA_TAG
+{
+    char* hostname; /*copy of the storage hostname taken from the SASURI*/
+    const char* relativePath; /*points inside the SASURI*/
+    HTTPAPIEX_HANDLE httpApiExHandle;
+    STRING_HANDLE blockIDList; /*the XML "build as we go"*/
+    unsigned int blockID; /*id of the next block to be uploaded*/
+    int blockIDListed; /*1 when the id of blockID is already in blockIDList because storage answered its last Put Block with a server error*/
+}BLOB_UPLOAD_DATA;
+
+static BLOB_RESULT initUploadData(BLOB_UPLOAD_DATA* uploadData, const char* SASURI, const char* certificates, HTTP_PROXY_OPTIONS *proxyOptions)
+{
+    BLOB_RESULT result;
+    /*Codes_SRS_BLOB_02_017: [ Blob_UploadMultipleBlocksFromSasUri shall copy from SASURI the hostname to a new const char* ]*/
+    /*to find the hostname, the following logic is applied:*/
+    /*the hostname starts at the first character after "://"*/
+    /*the hostname ends at the first character before the next "/" after "://"*/
+    const char* hostnameBegin = strstr(SASURI, "://");
+    if (hostnameBegin == NULL)
+    {
+        /*Codes_SRS_BLOB_02_005: [ If the hostname cannot be determined, then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+        LogError("hostname cannot be determined");
+        result = BLOB_INVALID_ARG;
+    }
+    else
+    {
+        hostnameBegin += 3; /*have to skip 3 characters which are "://"*/
+        const char* hostnameEnd = strchr(hostnameBegin, '/');
+        if (hostnameEnd == NULL)
         {
-            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-            LogError("failed to sprintf");
-            result = BLOB_ERROR;
+            /*Codes_SRS_BLOB_02_005: [ If the hostname cannot be determined, then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+            LogError("hostname cannot be determined");
+            result = BLOB_INVALID_ARG;
         }
         else
         {
-            STRING_HANDLE blockIdString = Base64_Encode_Bytes((const unsigned char*)temp, 6);
-            if (blockIdString == NULL)
+            size_t hostnameSize = hostnameEnd - hostnameBegin;
+            uploadData->hostname = (char*)malloc(hostnameSize + 1); /*+1 because of '\0' at the end*/
+            if (uploadData->hostname == NULL)
             {
-                /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                LogError("unable to Base64_Encode_Bytes");
+                /*Codes_SRS_BLOB_02_016: [ If the hostname copy cannot be made then then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+                LogError("oom - out of memory");
                 result = BLOB_ERROR;
             }
             else
             {
-                /*add the blockId base64 encoded to the XML*/
-                if (!(
-                    (STRING_concat(blockIDList, "<Latest>") == 0) &&
-                    (STRING_concat_with_STRING(blockIDList, blockIdString) == 0) &&
-                    (STRING_concat(blockIDList, "</Latest>") == 0)
-                    ))
+                (void)memcpy(uploadData->hostname, hostnameBegin, hostnameSize);
+                uploadData->hostname[hostnameSize] = '\0';
+
+                /*Codes_SRS_BLOB_02_018: [ Blob_UploadMultipleBlocksFromSasUri shall create a new HTTPAPI_EX_HANDLE by calling HTTPAPIEX_Create passing the hostname. ]*/
+                uploadData->httpApiExHandle = HTTPAPIEX_Create(uploadData->hostname);
+                if (uploadData->httpApiExHandle == NULL)
                 {
-                    /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                    LogError("unable to STRING_concat");
+                    /*Codes_SRS_BLOB_02_007: [ If HTTPAPIEX_Create fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+                    LogError("unable to create a HTTPAPIEX_HANDLE");
                     result = BLOB_ERROR;
                 }
                 else
                 {
-                    /*Codes_SRS_BLOB_02_022: [ Blob_UploadMultipleBlocksFromSasUri shall construct a new relativePath from following string: base relativePath + "&comp=block&blockid=BASE64 encoded string of blockId" ]*/
-                    STRING_HANDLE newRelativePath = STRING_construct(relativePath);
-                    if (newRelativePath == NULL)
+                    if ((certificates != NULL)&& (HTTPAPIEX_SetOption(uploadData->httpApiExHandle, "TrustedCerts", certificates) == HTTPAPIEX_ERROR))
                     {
-                        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                        LogError("unable to STRING_construct");
+                        LogError("failure in setting trusted certificates");
+                        result = BLOB_ERROR;
+                    }
+                    else if ((proxyOptions != NULL && proxyOptions->host_address != NULL) && HTTPAPIEX_SetOption(uploadData->httpApiExHandle, OPTION_HTTP_PROXY, proxyOptions) == HTTPAPIEX_ERROR)
+                    {
+                        LogError("failure in setting proxy options");
                         result = BLOB_ERROR;
                     }
                     else
                     {
-                        if (!(
-                            (STRING_concat(newRelativePath, "&comp=block&blockid=") == 0) &&
-                            (STRING_concat_with_STRING(newRelativePath, blockIdString) == 0)
-                            ))
+                        /*Codes_SRS_BLOB_02_019: [ Blob_UploadMultipleBlocksFromSasUri shall compute the base relative path of the request from the SASURI parameter. ]*/
+                        uploadData->relativePath = hostnameEnd; /*this is where the relative path begins in the SasUri*/
+
+                        /*Codes_SRS_BLOB_02_028: [ Blob_UploadMultipleBlocksFromSasUri shall construct an XML string with the following content: ]*/
+                        uploadData->blockIDList = STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>"); /*the XML "build as we go"*/
+                        if (uploadData->blockIDList == NULL)
                         {
                             /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                            LogError("unable to STRING concatenate");
-                            result = BLOB_ERROR;
+                            LogError("failed to STRING_construct");
+                            result = BLOB_HTTP_ERROR;
                         }
                         else
                         {
-                            /*Codes_SRS_BLOB_02_024: [ Blob_UploadMultipleBlocksFromSasUri shall call HTTPAPIEX_ExecuteRequest with a PUT operation, passing httpStatus and httpResponse. ]*/
-                            if (HTTPAPIEX_ExecuteRequest(
-                                httpApiExHandle,
-                                HTTPAPI_REQUEST_PUT,
-                                STRING_c_str(newRelativePath),
-                                NULL,
-                                requestContent,
-                                httpStatus,
-                                NULL,
-                                httpResponse) != HTTPAPIEX_OK
-                                )
-                            {
-                                /*Codes_SRS_BLOB_02_025: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
-                                LogError("unable to HTTPAPIEX_ExecuteRequest");
-                                result = BLOB_HTTP_ERROR;
-                            }
-                            else if (*httpStatus >= 300)
-                            {
-                                /*Codes_SRS_BLOB_02_026: [ Otherwise, if HTTP response code is >=300 then Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
-                                LogError("HTTP status from storage does not indicate success (%d)", (int)*httpStatus);
-                                result = BLOB_OK;
-                            }
-                            else
-                            {
-                                /*Codes_SRS_BLOB_02_027: [ Otherwise Blob_UploadMultipleBlocksFromSasUri shall continue execution. ]*/
-                                result = BLOB_OK;
-                            }
+                            uploadData->blockID = 0;
+                            uploadData->blockIDListed = 0;
+                            result = BLOB_OK;
                         }
-                        STRING_delete(newRelativePath);
+                    }
+
+                    if (result != BLOB_OK)
+                    {
+                        HTTPAPIEX_Destroy(uploadData->httpApiExHandle);
                     }
                 }
-                STRING_delete(blockIdString);
+
+                if (result != BLOB_OK)
+                {
+                    free(uploadData->hostname);
+                }
             }
         }
     }
     return result;
 }
 
-BLOB_RESULT Blob_UploadMultipleBlocksFromSasUri(const char* SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates, HTTP_PROXY_OPTIONS *proxyOptions)
+static void deinitUploadData(BLOB_UPLOAD_DATA* uploadData)
+{
+    STRING_delete(uploadData->blockIDList);
+    HTTPAPIEX_Destroy(uploadData->httpApiExHandle);
+    free(uploadData->hostname);
+}
+
+static BLOB_RESULT uploadNextBlock(BLOB_UPLOAD_DATA* uploadData, const unsigned char* source, size_t size, unsigned int maxRetries, unsigned int* httpStatus, BUFFER_HANDLE httpResponse)
 {
     BLOB_RESULT result;
-    /*Codes_SRS_BLOB_02_001: [ If SASURI is NULL then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
-    if (SASURI == NULL)
+    if (size > BLOCK_SIZE)
     {
-        LogError("parameter SASURI is NULL");
+        /*Codes_SRS_BLOB_99_001: [ If the size of the block returned by `getDataCallbackEx` is bigger than 4MB, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
+        LogError("tried to upload block of size %zu, max allowed size is %d", size, BLOCK_SIZE);
+        result = BLOB_INVALID_ARG;
+    }
+    else if (uploadData->blockID >= MAX_BLOCK_COUNT)
+    {
+        /*Codes_SRS_BLOB_99_003: [ If `getDataCallbackEx` returns more than 50000 blocks, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
+        LogError("unable to upload more than %zu blocks in one blob", MAX_BLOCK_COUNT);
         result = BLOB_INVALID_ARG;
     }
     else
     {
-        /*Codes_SRS_BLOB_02_002: [ If getDataCallbackEx is NULL then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
-        if (getDataCallbackEx == NULL)
+        /*Codes_SRS_BLOB_02_023: [ Blob_UploadMultipleBlocksFromSasUri shall create a BUFFER_HANDLE from source and size parameters. ]*/
+        /*this copies the block: HTTPAPIEX only sends request content it gets as a BUFFER_HANDLE, which owns its memory*/
+        BUFFER_HANDLE requestContent = BUFFER_create(source, size);
+        if (requestContent == NULL)
         {
-            LogError("IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx is NULL");
-            result = BLOB_INVALID_ARG;
+            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+            LogError("unable to BUFFER_create");
+            result = BLOB_ERROR;
+        }
+        else
+        {
+            result = uploadBlock(
+                    uploadData->httpApiExHandle,
+                    uploadData->relativePath,
+                    requestContent,
+                    uploadData->blockID,
+                    uploadData->blockIDListed ? NULL : uploadData->blockIDList,
+                    maxRetries,
+                    httpStatus,
+                    httpResponse);
+
+            BUFFER_delete(requestContent);
+        }
+
+        if (result == BLOB_OK && *httpStatus >= 500)
+        {
+            /*the same block can be sent again under the same id*/
+            uploadData->blockIDListed = 1;
+        }
+        else
+        {
+            uploadData->blockIDListed = 0;
+            uploadData->blockID++;
+        }
+    }
+    return result;
+}
+
+static BLOB_RESULT commitBlockList(BLOB_UPLOAD_DATA* uploadData, const char* contentEncoding, unsigned int* httpStatus, BUFFER_HANDLE httpResponse)
+{
+    BLOB_RESULT result;
+    /*complete the XML*/
+    if (STRING_concat(uploadData->blockIDList, "</BlockList>") != 0)
+    {
+        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+        LogError("failed to STRING_concat");
+        result = BLOB_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_BLOB_02_029: [Blob_UploadMultipleBlocksFromSasUri shall construct a new relativePath from following string : base relativePath + "&comp=blocklist"]*/
+        STRING_HANDLE newRelativePath = STRING_construct(uploadData->relativePath);
+        if (newRelativePath == NULL)
+        {
+            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+            LogError("failed to STRING_construct");
+            result = BLOB_ERROR;
         }
-        /*the below define avoid a "condition always false" on some compilers*/
         else
         {
-            /*Codes_SRS_BLOB_02_017: [ Blob_UploadMultipleBlocksFromSasUri shall copy from SASURI the hostname to a new const char* ]*/
-            /*to find the hostname, the following logic is applied:*/
-            /*the hostname starts at the first character after "://"*/
-            /*the hostname ends at the first character before the next "/" after "://"*/
-            const char* hostnameBegin = strstr(SASURI, "://");
-            if (hostnameBegin == NULL)
+            if (STRING_concat(newRelativePath, "&comp=blocklist") != 0)
             {
-                /*Codes_SRS_BLOB_02_005: [ If the hostname cannot be determined, then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
-                LogError("hostname cannot be determined");
-                result = BLOB_INVALID_ARG;
+                /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+                LogError("failed to STRING_concat");
+                result = BLOB_ERROR;
             }
             else
             {
-                hostnameBegin += 3; /*have to skip 3 characters which are "://"*/
-                const char* hostnameEnd = strchr(hostnameBegin, '/');
-                if (hostnameEnd == NULL)
+                /*Codes_SRS_BLOB_02_030: [ Blob_UploadMultipleBlocksFromSasUri shall call HTTPAPIEX_ExecuteRequest with a PUT operation, passing the new relativePath, httpStatus and httpResponse and the XML string as content. ]*/
+                const char* s = STRING_c_str(uploadData->blockIDList);
+                BUFFER_HANDLE blockIDListAsBuffer = BUFFER_create((const unsigned char*)s, strlen(s));
+                if (blockIDListAsBuffer == NULL)
                 {
-                    /*Codes_SRS_BLOB_02_005: [ If the hostname cannot be determined, then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
-                    LogError("hostname cannot be determined");
-                    result = BLOB_INVALID_ARG;
+                    /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+                    LogError("failed to BUFFER_create");
+                    result = BLOB_ERROR;
                 }
                 else
                 {
-                    size_t hostnameSize = hostnameEnd - hostnameBegin;
-                    char* hostname = (char*)malloc(hostnameSize + 1); /*+1 because of '\0' at the end*/
-                    if (hostname == NULL)
+                    HTTP_HEADERS_HANDLE requestHttpHeaders = NULL;
+                    /*Codes_SRS_BLOB_09_005: [ If contentEncoding is not NULL, Blob_UploadMultipleBlocksFromSasUri shall add the HTTP header "x-ms-blob-content-encoding: contentEncoding" to the Put Block List request. ]*/
+                    if ((contentEncoding != NULL) &&
+                        (((requestHttpHeaders = HTTPHeaders_Alloc()) == NULL) ||
+                        (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "x-ms-blob-content-encoding", contentEncoding) != HTTP_HEADERS_OK)))
                     {
-                        /*Codes_SRS_BLOB_02_016: [ If the hostname copy cannot be made then then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                        LogError("oom - out of memory");
+                        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+                        LogError("unable to set the blob content encoding");
                         result = BLOB_ERROR;
                     }
+                    else if (HTTPAPIEX_ExecuteRequest(
+                        uploadData->httpApiExHandle,
+                        HTTPAPI_REQUEST_PUT,
+                        STRING_c_str(newRelativePath),
+                        requestHttpHeaders,
+                        blockIDListAsBuffer,
+                        httpStatus,
+                        NULL,
+                        httpResponse
+                    ) != HTTPAPIEX_OK)
+                    {
+                        /*Codes_SRS_BLOB_02_031: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
+                        LogError("unable to HTTPAPIEX_ExecuteRequest");
+                        result = BLOB_HTTP_ERROR;
+                    }
                     else
                     {
-                        HTTPAPIEX_HANDLE httpApiExHandle;
-                        (void)memcpy(hostname, hostnameBegin, hostnameSize);
-                        hostname[hostnameSize] = '\0';
+                        /*Codes_SRS_BLOB_02_032: [ Otherwise, Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
+                        result = BLOB_OK;
+                    }
+                    if (requestHttpHeaders != NULL)
+                    {
+                        HTTPHeaders_Free(requestHttpHeaders);
+                    }
+                    BUFFER_delete(blockIDListAsBuffer);
+                }
+            }
+            STRING_delete(newRelativePath);
+        }
+    }
+    return result;
+}
 
-                        /*Codes_SRS_BLOB_02_018: [ Blob_UploadMultipleBlocksFromSasUri shall create a new HTTPAPI_EX_HANDLE by calling HTTPAPIEX_Create passing the hostname. ]*/
-                        httpApiExHandle = HTTPAPIEX_Create(hostname);
-                        if (httpApiExHandle == NULL)
-                        {
-                            /*Codes_SRS_BLOB_02_007: [ If HTTPAPIEX_Create fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
-                            LogError("unable to create a HTTPAPIEX_HANDLE");
-                            result = BLOB_ERROR;
-                        }
-                        else
-                        {
-                            if ((certificates != NULL)&& (HTTPAPIEX_SetOption(httpApiExHandle, "TrustedCerts", certificates) == HTTPAPIEX_ERROR))
-                            {
-                                LogError("failure in setting trusted certificates");
-                                result = BLOB_ERROR;
-                            }
-                            else if ((proxyOptions != NULL && proxyOptions->host_address != NULL) && HTTPAPIEX_SetOption(httpApiExHandle, OPTION_HTTP_PROXY, proxyOptions) == HTTPAPIEX_ERROR)
-                            {
-                                LogError("failure in setting proxy options");
-                                result = BLOB_ERROR;
-                            }
-                            else
-                            {
-                                /*Codes_SRS_BLOB_02_019: [ Blob_UploadMultipleBlocksFromSasUri shall compute the base relative path of the request from the SASURI parameter. ]*/
-                                const char* relativePath = hostnameEnd; /*this is where the relative path begins in the SasUri*/
-
-                                /*Codes_SRS_BLOB_02_028: [ Blob_UploadMultipleBlocksFromSasUri shall construct an XML string with the following content: ]*/
-                                STRING_HANDLE blockIDList = STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>"); /*the XML "build as we go"*/
-                                if (blockIDList == NULL)
-                                {
-                                    /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                                    LogError("failed to STRING_construct");
-                                    result = BLOB_HTTP_ERROR;
-                                }
-                                else
-                                {
-                                    /*Codes_SRS_BLOB_02_021: [ For every block returned by `getDataCallbackEx` the following operations shall happen: ]*/
-                                    unsigned int blockID = 0; /* incremented for each new block */
-                                    unsigned int isError = 0; /* set to 1 if a block upload fails or if getDataCallbackEx returns incorrect blocks to upload */
-                                    unsigned int uploadOneMoreBlock = 1; /* set to 1 while getDataCallbackEx returns correct blocks to upload */
-                                    unsigned char const * source; /* data set by getDataCallbackEx */
-                                    size_t size; /* source size set by getDataCallbackEx */
-                                    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT getDataReturnValue;
-
-                                    do
-                                    {
-                                        getDataReturnValue = getDataCallbackEx(FILE_UPLOAD_OK, &source, &size, context);
-                                        if (getDataReturnValue == IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT)
-                                        {
-                                            /*Codes_SRS_BLOB_99_004: [ If `getDataCallbackEx` returns `IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT_ABORT`, then `Blob_UploadMultipleBlocksFromSasUri` shall exit the loop and return `BLOB_ABORTED`. ]*/
-                                            LogInfo("Upload to blob has been aborted by the user");
-                                            uploadOneMoreBlock = 0;
-                                            result = BLOB_ABORTED;
-                                        }
-                                        else if (source == NULL || size == 0)
-                                        {
-                                            /*Codes_SRS_BLOB_99_002: [ If the size of the block returned by `getDataCallbackEx` is 0 or if the data is NULL, then `Blob_UploadMultipleBlocksFromSasUri` shall exit the loop. ]*/
-                                            uploadOneMoreBlock = 0;
-                                            result = BLOB_OK;
-                                        }
-                                        else
-                                        {
-                                            if (size > BLOCK_SIZE)
-                                            {
-                                                /*Codes_SRS_BLOB_99_001: [ If the size of the block returned by `getDataCallbackEx` is bigger than 4MB, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
-                                                LogError("tried to upload block of size %zu, max allowed size is %d", size, BLOCK_SIZE);
-                                                result = BLOB_INVALID_ARG;
-                                                isError = 1;
-                                            }
-                                            else if (blockID >= MAX_BLOCK_COUNT)
-                                            {
-                                                /*Codes_SRS_BLOB_99_003: [ If `getDataCallbackEx` returns more than 50000 blocks, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
-                                                LogError("unable to upload more than %zu blocks in one blob", MAX_BLOCK_COUNT);
-                                                result = BLOB_INVALID_ARG;
-                                                isError = 1;
-                                            }
-                                            else
-                                            {
-                                                /*Codes_SRS_BLOB_02_023: [ Blob_UploadMultipleBlocksFromSasUri shall create a BUFFER_HANDLE from source and size parameters. ]*/
-                                                BUFFER_HANDLE requestContent = BUFFER_create(source, size);
-                                                if (requestContent == NULL)
-                                                {
-                                                    /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                    LogError("unable to BUFFER_create");
-                                                    result = BLOB_ERROR;
-                                                    isError = 1;
-                                                }
-                                                else
-                                                {
-                                                    result = Blob_UploadBlock(
-                                                            httpApiExHandle,
-                                                            relativePath,
-                                                            requestContent,
-                                                            blockID,
-                                                            blockIDList,
-                                                            httpStatus,
-                                                            httpResponse);
-
-                                                    BUFFER_delete(requestContent);
-                                                }
-
-                                                /*Codes_SRS_BLOB_02_026: [ Otherwise, if HTTP response code is >=300 then Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
-                                                if (result != BLOB_OK || *httpStatus >= 300)
-                                                {
-                                                    LogError("unable to Blob_UploadBlock. Returned value=%d, httpStatus=%u", result, httpStatus);
-                                                    isError = 1;
-                                                }
-                                            }
-                                            blockID++;
-                                        }
-                                    }
-                                    while(uploadOneMoreBlock && !isError);
-
-                                    if (isError || result != BLOB_OK)
-                                    {
-                                        /*do nothing, it will be reported "as is"*/
-                                    }
-                                    else
-                                    {
-                                        /*complete the XML*/
-                                        if (STRING_concat(blockIDList, "</BlockList>") != 0)
-                                        {
-                                            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                                            LogError("failed to STRING_concat");
-                                            result = BLOB_ERROR;
-                                        }
-                                        else
-                                        {
-                                            /*Codes_SRS_BLOB_02_029: [Blob_UploadMultipleBlocksFromSasUri shall construct a new relativePath from following string : base relativePath + "&comp=blocklist"]*/
-                                            STRING_HANDLE newRelativePath = STRING_construct(relativePath);
-                                            if (newRelativePath == NULL)
-                                            {
-                                                /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                LogError("failed to STRING_construct");
-                                                result = BLOB_ERROR;
-                                            }
-                                            else
-                                            {
-                                                if (STRING_concat(newRelativePath, "&comp=blocklist") != 0)
-                                                {
-                                                    /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                    LogError("failed to STRING_concat");
-                                                    result = BLOB_ERROR;
-                                                }
-                                                else
-                                                {
-                                                    /*Codes_SRS_BLOB_02_030: [ Blob_UploadMultipleBlocksFromSasUri shall call HTTPAPIEX_ExecuteRequest with a PUT operation, passing the new relativePath, httpStatus and httpResponse and the XML string as content. ]*/
-                                                    const char* s = STRING_c_str(blockIDList);
-                                                    BUFFER_HANDLE blockIDListAsBuffer = BUFFER_create((const unsigned char*)s, strlen(s));
-                                                    if (blockIDListAsBuffer == NULL)
-                                                    {
-                                                        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                        LogError("failed to BUFFER_create");
-                                                        result = BLOB_ERROR;
-                                                    }
-                                                    else
-                                                    {
-                                                        if (HTTPAPIEX_ExecuteRequest(
-                                                            httpApiExHandle,
-                                                            HTTPAPI_REQUEST_PUT,
-                                                            STRING_c_str(newRelativePath),
-                                                            NULL,
-                                                            blockIDListAsBuffer,
-                                                            httpStatus,
-                                                            NULL,
-                                                            httpResponse
-                                                        ) != HTTPAPIEX_OK)
-                                                        {
-                                                            /*Codes_SRS_BLOB_02_031: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
-                                                            LogError("unable to HTTPAPIEX_ExecuteRequest");
-                                                            result = BLOB_HTTP_ERROR;
-                                                        }
-                                                        else
-                                                        {
-                                                            /*Codes_SRS_BLOB_02_032: [ Otherwise, Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
-                                                            result = BLOB_OK;
-                                                        }
-                                                        BUFFER_delete(blockIDListAsBuffer);
-                                                    }
-                                                }
-                                                STRING_delete(newRelativePath);
-                                            }
-                                        }
-                                    }
-                                    STRING_delete(blockIDList);
-                                }
-
-                            }
-                            HTTPAPIEX_Destroy(httpApiExHandle);
-                        }
-                        free(hostname);
+static BLOB_RESULT uploadMultipleBlocksFromSasUri(const char* SASURI, unsigned int firstBlockID, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates, HTTP_PROXY_OPTIONS *proxyOptions, const char* contentEncoding)
+{
+    BLOB_RESULT result;
+    /*Codes_SRS_BLOB_02_001: [ If SASURI is NULL then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+    if (SASURI == NULL)
+    {
+        LogError("parameter SASURI is NULL");
+        result = BLOB_INVALID_ARG;
+    }
+    /*Codes_SRS_BLOB_02_002: [ If getDataCallbackEx is NULL then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+    else if (getDataCallbackEx == NULL)
+    {
+        LogError("IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx is NULL");
+        result = BLOB_INVALID_ARG;
+    }
+    else
+    {
+        BLOB_UPLOAD_DATA uploadData;
+        result = initUploadData(&uploadData, SASURI, certificates, proxyOptions);
+        if (result != BLOB_OK)
+        {
+            LogError("unable to start the upload to storage");
+        }
+        else
+        {
+            /*Codes_SRS_BLOB_02_021: [ For every block returned by `getDataCallbackEx` the following operations shall happen: ]*/
+            unsigned int isError = 0; /* set to 1 if a block upload fails or if getDataCallbackEx returns incorrect blocks to upload */
+            unsigned int uploadOneMoreBlock = 1; /* set to 1 while getDataCallbackEx returns correct blocks to upload */
+            unsigned char const * source; /* data set by getDataCallbackEx */
+            size_t size; /* source size set by getDataCallbackEx */
+            IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT getDataReturnValue;
+
+            /*Codes_SRS_BLOB_09_003: [ Blob_ResumeMultipleBlocksFromSasUri shall add to the XML the ids of the blocks 0 to firstBlockID - 1 without uploading them. ]*/
+            while (uploadData.blockID < firstBlockID && !isError)
+            {
+                STRING_HANDLE blockIdString = addBlockID(uploadData.blockID, uploadData.blockIDList);
+                if (blockIdString == NULL)
+                {
+                    LogError("unable to add committed block %u to the block list", uploadData.blockID);
+                    result = BLOB_ERROR;
+                    isError = 1;
+                }
+                else
+                {
+                    STRING_delete(blockIdString);
+                }
+                uploadData.blockID++;
+            }
+
+            /*Codes_SRS_BLOB_09_004: [ Blob_ResumeMultipleBlocksFromSasUri shall then upload the blocks returned by getDataCallbackEx starting with block id firstBlockID. ]*/
+            while (uploadOneMoreBlock && !isError)
+            {
+                getDataReturnValue = getDataCallbackEx(FILE_UPLOAD_OK, &source, &size, context);
+                if (getDataReturnValue == IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT)
+                {
+                    /*Codes_SRS_BLOB_99_004: [ If `getDataCallbackEx` returns `IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT_ABORT`, then `Blob_UploadMultipleBlocksFromSasUri` shall exit the loop and return `BLOB_ABORTED`. ]*/
+                    LogInfo("Upload to blob has been aborted by the user");
+                    uploadOneMoreBlock = 0;
+                    result = BLOB_ABORTED;
+                }
+                else if (source == NULL || size == 0)
+                {
+                    /*Codes_SRS_BLOB_99_002: [ If the size of the block returned by `getDataCallbackEx` is 0 or if the data is NULL, then `Blob_UploadMultipleBlocksFromSasUri` shall exit the loop. ]*/
+                    uploadOneMoreBlock = 0;
+                    result = BLOB_OK;
+                }
+                else
+                {
+                    result = uploadNextBlock(&uploadData, source, size, BLOB_BLOCK_UPLOAD_MAX_RETRIES, httpStatus, httpResponse);
+
+                    /*Codes_SRS_BLOB_02_026: [ Otherwise, if HTTP response code is >=300 then Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
+                    if (result != BLOB_OK || *httpStatus >= 300)
+                    {
+                        LogError("unable to Blob_UploadBlock. Returned value=%d, httpStatus=%u", result, httpStatus);
+                        isError = 1;
                     }
                 }
             }
+
+            if (isError || result != BLOB_OK)
+            {
+                /*do nothing, it will be reported "as is"*/
+            }
+            else
+            {
+                result = commitBlockList(&uploadData, contentEncoding, httpStatus, httpResponse);
+            }
+            deinitUploadData(&uploadData);
         }
     }
     return result;
 }
+
+BLOB_RESULT Blob_UploadMultipleBlocksFromSasUri(const char* SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates, HTTP_PROXY_OPTIONS *proxyOptions, const char* contentEncoding)
+{
+    return uploadMultipleBlocksFromSasUri(SASURI, 0, getDataCallbackEx, context, httpStatus, httpResponse, certificates, proxyOptions, contentEncoding);
+}
+
+BLOB_RESULT Blob_ResumeMultipleBlocksFromSasUri(const char* SASURI, unsigned int firstBlockID, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates, HTTP_PROXY_OPTIONS *proxyOptions, const char* contentEncoding)
+{
+    BLOB_RESULT result;
+    /*Codes_SRS_BLOB_09_002: [ If firstBlockID is bigger than MAX_BLOCK_COUNT then Blob_ResumeMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+    if (firstBlockID > MAX_BLOCK_COUNT)
+    {
+        LogError("invalid firstBlockID=%u, maximum is %d", firstBlockID, MAX_BLOCK_COUNT);
+        result = BLOB_INVALID_ARG;
+    }
+    else
+    {
+        result = uploadMultipleBlocksFromSasUri(SASURI, firstBlockID, getDataCallbackEx, context, httpStatus, httpResponse, certificates, proxyOptions, contentEncoding);
+    }
+    return result;
+}
+
+BLOB_UPLOAD_HANDLE Blob_UploadCreate(const char* SASURI, const char* certificates, HTTP_PROXY_OPTIONS* proxyOptions)
+{
+    BLOB_UPLOAD_DATA* result;
+    /*Codes_SRS_BLOB_09_006: [ If SASURI is NULL then Blob_UploadCreate shall fail and return NULL. ]*/
+    if (SASURI == NULL)
+    {
+        LogError("parameter SASURI is NULL");
+        result = NULL;
+    }
+    else
+    {
+        /*Codes_SRS_BLOB_09_007: [ Blob_UploadCreate shall keep a copy of SASURI and prepare the upload as Blob_UploadMultipleBlocksFromSasUri does before requesting the first block. ]*/
+        size_t sasUriSize = strlen(SASURI) + 1;
+        result = (BLOB_UPLOAD_DATA*)malloc(sizeof(BLOB_UPLOAD_DATA) + sasUriSize); /*the copy of SASURI follows the structure, relativePath points inside it*/
+        if (result == NULL)
+        {
+            /*Codes_SRS_BLOB_09_008: [ If any operation fails then Blob_UploadCreate shall fail and return NULL. ]*/
+            LogError("oom - out of memory");
+        }
+        else
+        {
+            char* sasUriCopy = (char*)(result + 1);
+            (void)memcpy(sasUriCopy, SASURI, sasUriSize);
+            if (initUploadData(result, sasUriCopy, certificates, proxyOptions) != BLOB_OK)
+            {
+                /*Codes_SRS_BLOB_09_008: [ If any operation fails then Blob_UploadCreate shall fail and return NULL. ]*/
+                LogError("unable to start the upload to storage");
+                free(result);
+                result = NULL;
+            }
+        }
+    }
+    return result;
+}
+
+BLOB_RESULT Blob_UploadNextBlock(BLOB_UPLOAD_HANDLE blobUploadHandle, const unsigned char* source, size_t size, unsigned int* httpStatus, BUFFER_HANDLE httpResponse)
+{
+    BLOB_RESULT result;
+    /*Codes_SRS_BLOB_09_009: [ If blobUploadHandle, source, httpStatus or httpResponse is NULL or size is 0 then Blob_UploadNextBlock shall fail and return BLOB_INVALID_ARG. ]*/
+    if ((blobUploadHandle == NULL) || (source == NULL) || (size == 0) || (httpStatus == NULL) || (httpResponse == NULL))
+    {
+        LogError("invalid argument detected blobUploadHandle=%p source=%p size=%zu httpStatus=%p httpResponse=%p", blobUploadHandle, source, size, httpStatus, httpResponse);
+        result = BLOB_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_BLOB_09_010: [ Otherwise Blob_UploadNextBlock shall upload source as the next block, as Blob_UploadMultipleBlocksFromSasUri does for each block returned by getDataCallbackEx, but with a single request and without waiting. ]*/
+        /*Codes_SRS_BLOB_09_021: [ If storage answers with a server error (5xx), Blob_UploadNextBlock shall return BLOB_OK and keep the block id, so that the next call to Blob_UploadNextBlock sends the block again under the same id. ]*/
+        result = uploadNextBlock(blobUploadHandle, source, size, 0, httpStatus, httpResponse);
+    }
+    return result;
+}
+
+BLOB_RESULT Blob_UploadCommit(BLOB_UPLOAD_HANDLE blobUploadHandle, const char* contentEncoding, unsigned int* httpStatus, BUFFER_HANDLE httpResponse)
+{
+    BLOB_RESULT result;
+    /*Codes_SRS_BLOB_09_011: [ If blobUploadHandle, httpStatus or httpResponse is NULL then Blob_UploadCommit shall fail and return BLOB_INVALID_ARG. ]*/
+    if ((blobUploadHandle == NULL) || (httpStatus == NULL) || (httpResponse == NULL))
+    {
+        LogError("invalid argument detected blobUploadHandle=%p httpStatus=%p httpResponse=%p", blobUploadHandle, httpStatus, httpResponse);
+        result = BLOB_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_BLOB_09_012: [ Otherwise Blob_UploadCommit shall send the Put Block List request for the blocks uploaded so far, as Blob_UploadMultipleBlocksFromSasUri does after the last block. ]*/
+        result = commitBlockList(blobUploadHandle, contentEncoding, httpStatus, httpResponse);
+    }
+    return result;
+}
+
+void Blob_UploadDestroy(BLOB_UPLOAD_HANDLE blobUploadHandle)
+{
+    if (blobUploadHandle == NULL)
+    {
+        /*Codes_SRS_BLOB_09_013: [ If blobUploadHandle is NULL then Blob_UploadDestroy shall return. ]*/
+        LogError("parameter blobUploadHandle is NULL");
+    }
+    else
+    {
+        /*Codes_SRS_BLOB_09_014: [ Otherwise Blob_UploadDestroy shall free all resources held by blobUploadHandle. ]*/
+        deinitUploadData(blobUploadHandle);
+        free(blobUploadHandle);
+    }
+}
+
+typedef struct BLOB_FILE_MAPPING_TAG
+{
+    size_t size;
+#if defined(_WIN32)
+    void* data; /*NULL for an empty file, nothing is mapped then*/
+    HANDLE fileMapping;
+#elif defined(__unix__) || defined(__APPLE__)
+    int fd;
+    unsigned char* block; /*receives the bytes returned by Blob_ReadFileBlock*/
+    size_t blockCapacity;
+#endif
+}BLOB_FILE_MAPPING;
+
+BLOB_FILE_MAPPING_HANDLE Blob_MapFile(const char* filePath, size_t* size)
+{
+    BLOB_FILE_MAPPING* result;
+    /*Codes_SRS_BLOB_09_015: [ If filePath or size is NULL then Blob_MapFile shall fail and return NULL. ]*/
+    if ((filePath == NULL) || (size == NULL))
+    {
+        LogError("invalid argument detected filePath=%p size=%p", filePath, size);
+        result = NULL;
+    }
+    else if ((result = (BLOB_FILE_MAPPING*)malloc(sizeof(BLOB_FILE_MAPPING))) == NULL)
+    {
+        /*Codes_SRS_BLOB_09_017: [ If any operation fails, or the platform cannot map files, then Blob_MapFile shall fail and return NULL. ]*/
+        LogError("oom - out of memory");
+    }
+    else
+    {
+        /*Codes_SRS_BLOB_09_016: [ Blob_MapFile shall open the file read only and return its size in size. On Windows the whole file is mapped, an empty file is not mapped. On POSIX platforms the file is only kept open. ]*/
+        int isError = 0;
+        result->size = 0;
+#if defined(_WIN32)
+        result->data = NULL;
+        result->fileMapping = NULL;
+        HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            LogError("unable to open %s, error %lu", filePath, (unsigned long)GetLastError());
+            isError = 1;
+        }
+        else
+        {
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize) || ((unsigned long long)fileSize.QuadPart > (size_t)-1))
+            {
+                LogError("unable to get the size of %s", filePath);
+                isError = 1;
+            }
+            else if (fileSize.QuadPart > 0)
+            {
+                /*while the view is mapped Windows refuses to truncate the file, so the view stays readable*/
+                if ((result->fileMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL)) == NULL)
+                {
+                    LogError("unable to CreateFileMappingA, error %lu", (unsigned long)GetLastError());
+                    isError = 1;
+                }
+                else if ((result->data = MapViewOfFile(result->fileMapping, FILE_MAP_READ, 0, 0, 0)) == NULL)
+                {
+                    LogError("unable to MapViewOfFile, error %lu", (unsigned long)GetLastError());
+                    (void)CloseHandle(result->fileMapping);
+                    isError = 1;
+                }
+                else
+                {
+                    result->size = (size_t)fileSize.QuadPart;
+                }
+            }
+            (void)CloseHandle(file);
+        }
+#elif defined(__unix__) || defined(__APPLE__)
+        /*the file is not mmap'ed: reading a mapping past the end of a file truncated by another process raises SIGBUS, pread reports it instead*/
+        result->block = NULL;
+        result->blockCapacity = 0;
+        result->fd = open(filePath, O_RDONLY);
+        if (result->fd < 0)
+        {
+            LogError("unable to open %s", filePath);
+            isError = 1;
+        }
+        else
+        {
+            struct stat fileStat;
+            if ((fstat(result->fd, &fileStat) != 0) || ((unsigned long long)fileStat.st_size > (size_t)-1))
+            {
+                LogError("unable to get the size of %s", filePath);
+                (void)close(result->fd);
+                isError = 1;
+            }
+            else
+            {
+                result->size = (size_t)fileStat.st_size;
+            }
+        }
+#else
+        /*Codes_SRS_BLOB_09_017: [ If any operation fails, or the platform cannot map files, then Blob_MapFile shall fail and return NULL. ]*/
+        LogError("this platform cannot map %s in memory", filePath);
+        isError = 1;
+#endif
+        if (isError)
+        {
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            *size = result->size;
+        }
+    }
+    return result;
+}
+
+int Blob_ReadFileBlock(BLOB_FILE_MAPPING_HANDLE fileMapping, size_t offset, size_t size, const unsigned char** data)
+{
+    int result;
+    /*Codes_SRS_BLOB_09_022: [ If fileMapping or data is NULL, or the bytes offset to offset + size - 1 are not within the size returned by Blob_MapFile, then Blob_ReadFileBlock shall fail and return a non-zero value. ]*/
+    if ((fileMapping == NULL) || (data == NULL) || (offset > fileMapping->size) || (size > fileMapping->size - offset))
+    {
+        LogError("invalid argument detected fileMapping=%p data=%p offset=%zu size=%zu", fileMapping, data, offset, size);
+        result = __FAILURE__;
+    }
+    else
+    {
+#if defined(_WIN32)
+        /*Codes_SRS_BLOB_09_023: [ On Windows Blob_ReadFileBlock shall return in data the address of the bytes in the mapping. ]*/
+        *data = (const unsigned char*)fileMapping->data + offset;
+        result = 0;
+#elif defined(__unix__) || defined(__APPLE__)
+        /*Codes_SRS_BLOB_09_024: [ On POSIX platforms Blob_ReadFileBlock shall read the bytes with pread into a buffer owned by fileMapping, which is valid until the next call or Blob_UnmapFile, and return its address in data. ]*/
+        if (size > fileMapping->blockCapacity)
+        {
+            unsigned char* newBlock = (unsigned char*)realloc(fileMapping->block, size);
+            if (newBlock == NULL)
+            {
+                LogError("oom - unable to allocate %zu bytes", size);
+                size = 0;
+                result = __FAILURE__;
+            }
+            else
+            {
+                fileMapping->block = newBlock;
+                fileMapping->blockCapacity = size;
+                result = 0;
+            }
+        }
+        else
+        {
+            result = 0;
+        }
+
+        if (result == 0)
+        {
+            size_t bytesRead = 0;
+            while (bytesRead < size)
+            {
+                ssize_t n = pread(fileMapping->fd, fileMapping->block + bytesRead, size - bytesRead, (off_t)(offset + bytesRead));
+                if (n > 0)
+                {
+                    bytesRead += (size_t)n;
+                }
+                else if ((n < 0) && (errno == EINTR))
+                {
+                    /*interrupted before anything was read, try again*/
+                }
+                else
+                {
+                    /*Codes_SRS_BLOB_09_025: [ If the file is shorter than offset + size, because it was truncated after Blob_MapFile, or reading fails, then Blob_ReadFileBlock shall fail and return a non-zero value. ]*/
+                    LogError("unable to read %zu bytes at offset %zu, the file was truncated or cannot be read", size, offset);
+                    result = __FAILURE__;
+                    break;
+                }
+            }
+
+            if (result == 0)
+            {
+                *data = fileMapping->block;
+            }
+        }
+#else
+        result = __FAILURE__;
+#endif
+    }
+    return result;
+}
+
+void Blob_UnmapFile(BLOB_FILE_MAPPING_HANDLE fileMapping)
+{
+    if (fileMapping == NULL)
+    {
+        /*Codes_SRS_BLOB_09_018: [ If fileMapping is NULL then Blob_UnmapFile shall return. ]*/
+        LogError("parameter fileMapping is NULL");
+    }
+    else
+    {
+        /*Codes_SRS_BLOB_09_019: [ Otherwise Blob_UnmapFile shall unmap or close the file and free fileMapping. ]*/
+#if defined(_WIN32)
+        if (fileMapping->data != NULL)
+        {
+            (void)UnmapViewOfFile(fileMapping->data);
+            (void)CloseHandle(fileMapping->fileMapping);
+        }
+#elif defined(__unix__) || defined(__APPLE__)
+        (void)close(fileMapping->fd);
+        free(fileMapping->block);
+#endif
+        free(fileMapping);
+    }
+}
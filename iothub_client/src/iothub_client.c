@@ -47,6 +47,10 @@ typedef struct IOTHUB_CLIENT_INSTANCE_TAG
     struct IOTHUB_QUEUE_CONTEXT_TAG* connection_status_user_context;
     struct IOTHUB_QUEUE_CONTEXT_TAG* message_user_context;
     struct IOTHUB_QUEUE_CONTEXT_TAG* method_user_context;
+#ifndef DONT_USE_UPLOADTOBLOB
+    IOTHUB_CLIENT_FILE_UPLOAD_PROGRESS_CALLBACK file_upload_progress_callback;
+    struct IOTHUB_QUEUE_CONTEXT_TAG* file_upload_progress_user_context;
+#endif
 } IOTHUB_CLIENT_INSTANCE;
 
 #ifndef DONT_USE_UPLOADTOBLOB
@@ -61,7 +65,8 @@ typedef struct UPLOADTOBLOB_MULTIBLOCK_SAVED_DATA_TAG
 {
     IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK getDataCallback;
     IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx;
-}UPLOADTOBLOB_MULTIBLOCK_SAVED_DATA;
+    void* context;
+}UPLOADTOBLOB_MULTIBLOCK_SAVED_DATA; /*handed to IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx, freed by the last call to uploadMultipleBlocksAsyncCallback*/
 
 typedef struct UPLOADTOBLOB_THREAD_INFO_TAG
 {
@@ -72,7 +77,6 @@ typedef struct UPLOADTOBLOB_THREAD_INFO_TAG
     IOTHUB_CLIENT_HANDLE iotHubClientHandle;
     void* context;
     UPLOADTOBLOB_SAVED_DATA uploadBlobSavedData;
-    UPLOADTOBLOB_MULTIBLOCK_SAVED_DATA uploadBlobMultiblockSavedData;
 }UPLOADTOBLOB_THREAD_INFO;
 
 #endif
@@ -84,7 +88,8 @@ typedef struct UPLOADTOBLOB_THREAD_INFO_TAG
     CALLBACK_TYPE_CONNECTION_STATUS,    \
     CALLBACK_TYPE_DEVICE_METHOD,        \
     CALLBACK_TYPE_INBOUD_DEVICE_METHOD, \
-    CALLBACK_TYPE_MESSAGE
+    CALLBACK_TYPE_MESSAGE,              \
+    CALLBACK_TYPE_FILE_UPLOAD_PROGRESS
 
 DEFINE_ENUM(USER_CALLBACK_TYPE, USER_CALLBACK_TYPE_VALUES)
 DEFINE_ENUM_STRINGS(USER_CALLBACK_TYPE, USER_CALLBACK_TYPE_VALUES)
@@ -119,6 +124,12 @@ typedef struct METHOD_CALLBACK_INFO_TAG
     METHOD_HANDLE method_id;
 } METHOD_CALLBACK_INFO;
 
+typedef struct FILE_UPLOAD_PROGRESS_CALLBACK_INFO_TAG
+{
+    char* destinationFileName;
+    size_t bytesUploaded;
+} FILE_UPLOAD_PROGRESS_CALLBACK_INFO;
+
 typedef struct USER_CALLBACK_INFO_TAG
 {
     USER_CALLBACK_TYPE type;
@@ -131,6 +142,7 @@ typedef struct USER_CALLBACK_INFO_TAG
         CONNECTION_STATUS_CALLBACK_INFO connection_status_cb_info;
         METHOD_CALLBACK_INFO method_cb_info;
         MESSAGE_CALLBACK_INFO* message_cb_info;
+        FILE_UPLOAD_PROGRESS_CALLBACK_INFO file_upload_progress_cb_info;
     } iothub_callback;
 } USER_CALLBACK_INFO;
 
@@ -419,6 +431,30 @@ static void iothub_ll_device_twin_callback(DEVICE_TWIN_UPDATE_STATE update_state
     }
 }
 
+#ifndef DONT_USE_UPLOADTOBLOB
+static void iothub_ll_file_upload_progress_callback(const char* destinationFileName, size_t bytesUploaded, void* userContextCallback)
+{
+    IOTHUB_QUEUE_CONTEXT* queue_context = (IOTHUB_QUEUE_CONTEXT*)userContextCallback;
+    if (queue_context != NULL)
+    {
+        USER_CALLBACK_INFO queue_cb_info;
+        queue_cb_info.type = CALLBACK_TYPE_FILE_UPLOAD_PROGRESS;
+        queue_cb_info.userContextCallback = queue_context->userContextCallback;
+        queue_cb_info.iothub_callback.file_upload_progress_cb_info.bytesUploaded = bytesUploaded;
+        /*Codes_SRS_IOTHUBCLIENT_09_013: [ The progress notifications of IoTHubClient_LL shall be queued with a copy of destinationFileName and delivered to progressCallback by the worker thread without holding the lock. ]*/
+        if (mallocAndStrcpy_s(&queue_cb_info.iothub_callback.file_upload_progress_cb_info.destinationFileName, destinationFileName) != 0)
+        {
+            LogError("failure copying destinationFileName in file upload progress callback.");
+        }
+        else if (VECTOR_push_back(queue_context->iotHubClientHandle->saved_user_callback_list, &queue_cb_info, 1) != 0)
+        {
+            LogError("file upload progress callback vector push failed.");
+            free(queue_cb_info.iothub_callback.file_upload_progress_cb_info.destinationFileName);
+        }
+    }
+}
+#endif
+
 static void dispatch_user_callbacks(IOTHUB_CLIENT_INSTANCE* iotHubClientInstance, VECTOR_HANDLE call_backs)
 {
     size_t callbacks_length = VECTOR_size(call_backs);
@@ -433,6 +469,9 @@ static void dispatch_user_callbacks(IOTHUB_CLIENT_INSTANCE* iotHubClientInstance
     IOTHUB_CLIENT_MESSAGE_CALLBACK_ASYNC message_callback = NULL;
     IOTHUB_CLIENT_HANDLE message_user_context_handle = NULL;
     IOTHUB_CLIENT_HANDLE method_user_context_handle = NULL;
+#ifndef DONT_USE_UPLOADTOBLOB
+    IOTHUB_CLIENT_FILE_UPLOAD_PROGRESS_CALLBACK file_upload_progress_callback = NULL;
+#endif
 
     // Make a local copy of these callbacks, as we don't run with a lock held and iotHubClientInstance may change mid-run.
     if (Lock(iotHubClientInstance->LockHandle) != LOCK_OK)
@@ -448,6 +487,9 @@ static void dispatch_user_callbacks(IOTHUB_CLIENT_INSTANCE* iotHubClientInstance
         device_method_callback = iotHubClientInstance->device_method_callback;
         inbound_device_method_callback = iotHubClientInstance->inbound_device_method_callback;
         message_callback = iotHubClientInstance->message_callback;
+#ifndef DONT_USE_UPLOADTOBLOB
+        file_upload_progress_callback = iotHubClientInstance->file_upload_progress_callback;
+#endif
         if (iotHubClientInstance->method_user_context)
         {
             method_user_context_handle = iotHubClientInstance->method_user_context->iotHubClientHandle;
@@ -565,6 +607,15 @@ static void dispatch_user_callbacks(IOTHUB_CLIENT_INSTANCE* iotHubClientInstance
                         }
                     }
                     break;
+#ifndef DONT_USE_UPLOADTOBLOB
+                case CALLBACK_TYPE_FILE_UPLOAD_PROGRESS:
+                    if (file_upload_progress_callback)
+                    {
+                        file_upload_progress_callback(queued_cb->iothub_callback.file_upload_progress_cb_info.destinationFileName, queued_cb->iothub_callback.file_upload_progress_cb_info.bytesUploaded, queued_cb->userContextCallback);
+                    }
+                    free(queued_cb->iothub_callback.file_upload_progress_cb_info.destinationFileName);
+                    break;
+#endif
                 default:
                     LogError("Invalid callback type '%s'", ENUM_TO_STRING(USER_CALLBACK_TYPE, queued_cb->type));
                     break;
@@ -846,6 +897,10 @@ static IOTHUB_CLIENT_INSTANCE* create_iothub_instance(const IOTHUB_CLIENT_CONFIG
                     result->message_callback = NULL;
                     result->message_user_context = NULL;
                     result->method_user_context = NULL;
+#ifndef DONT_USE_UPLOADTOBLOB
+                    result->file_upload_progress_callback = NULL;
+                    result->file_upload_progress_user_context = NULL;
+#endif
                 }
             }
         }
@@ -1054,6 +1109,10 @@ void IoTHubClient_Destroy(IOTHUB_CLIENT_HANDLE iotHubClientHandle)
                         iotHubClientInstance->event_confirm_callback(queue_cb_info->iothub_callback.event_confirm_cb_info.confirm_result, queue_cb_info->userContextCallback);
                     }
                 }
+                else if (queue_cb_info->type == CALLBACK_TYPE_FILE_UPLOAD_PROGRESS)
+                {
+                    free(queue_cb_info->iothub_callback.file_upload_progress_cb_info.destinationFileName);
+                }
             }
         }
         VECTOR_destroy(iotHubClientInstance->saved_user_callback_list);
@@ -1079,6 +1138,12 @@ void IoTHubClient_Destroy(IOTHUB_CLIENT_HANDLE iotHubClientHandle)
         {
             free(iotHubClientInstance->method_user_context);
         }
+#ifndef DONT_USE_UPLOADTOBLOB
+        if (iotHubClientInstance->file_upload_progress_user_context != NULL)
+        {
+            free(iotHubClientInstance->file_upload_progress_user_context);
+        }
+#endif
         free(iotHubClientInstance);
     }
 }
@@ -2070,24 +2135,28 @@ IOTHUB_CLIENT_RESULT IoTHubClient_UploadToBlobAsync(IOTHUB_CLIENT_HANDLE iotHubC
     return result;
 }
 
-static int uploadMultipleBlock_thread(void* data)
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT uploadMultipleBlocksAsyncCallback(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context)
 {
-    UPLOADTOBLOB_THREAD_INFO* threadInfo = (UPLOADTOBLOB_THREAD_INFO*)data;
-    IOTHUB_CLIENT_LL_HANDLE llHandle = threadInfo->iotHubClientHandle->IoTHubClientLLHandle;
-
-    /*Codes_SRS_IOTHUBCLIENT_99_078: [ The thread shall call `IoTHubClient_LL_UploadMultipleBlocksToBlob` or `IoTHubClient_LL_UploadMultipleBlocksToBlobEx` passing the information packed in the structure. ]*/
-    IOTHUB_CLIENT_RESULT result;
+    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT getDataResult;
+    UPLOADTOBLOB_MULTIBLOCK_SAVED_DATA* savedData = (UPLOADTOBLOB_MULTIBLOCK_SAVED_DATA*)context;
 
-    if (threadInfo->uploadBlobMultiblockSavedData.getDataCallback != NULL)
+    /*Codes_SRS_IOTHUBCLIENT_99_078: [ The callback given to `IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx` shall call `getDataCallback` or `getDataCallbackEx` with the same arguments and the saved `context`, and free the structure after the last call, the one with `data` set to NULL. ]*/
+    if (savedData->getDataCallback != NULL)
     {
-        result = IoTHubClient_LL_UploadMultipleBlocksToBlob(llHandle, threadInfo->destinationFileName, threadInfo->uploadBlobMultiblockSavedData.getDataCallback, threadInfo->context);
+        savedData->getDataCallback(result, data, size, savedData->context);
+        getDataResult = IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
     }
     else
     {
-        result = IoTHubClient_LL_UploadMultipleBlocksToBlobEx(llHandle, threadInfo->destinationFileName, threadInfo->uploadBlobMultiblockSavedData.getDataCallbackEx, threadInfo->context);
-    }        
+        getDataResult = savedData->getDataCallbackEx(result, data, size, savedData->context);
+    }
 
-    return markThreadReadyToBeGarbageCollected(threadInfo);
+    if (data == NULL)
+    {
+        free(savedData);
+    }
+
+    return getDataResult;
 }
 
 IOTHUB_CLIENT_RESULT IoTHubClient_UploadMultipleBlocksToBlobAsync_Impl(IOTHUB_CLIENT_HANDLE iotHubClientHandle, const char* destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK getDataCallback, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
@@ -2113,36 +2182,50 @@ IOTHUB_CLIENT_RESULT IoTHubClient_UploadMultipleBlocksToBlobAsync_Impl(IOTHUB_CL
     }
     else
     {
-        /*Codes_SRS_IOTHUBCLIENT_99_075: [ `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall copy the `destinationFileName`, `getDataCallback`, `context`  and `iotHubClientHandle` into a structure. ]*/
-        UPLOADTOBLOB_THREAD_INFO *threadInfo = allocateUploadToBlob(destinationFileName, iotHubClientHandle, context);
-        if (threadInfo == NULL)
+        /*Codes_SRS_IOTHUBCLIENT_99_075: [ `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall copy the `getDataCallback` or `getDataCallbackEx` and the `context` into a structure. ]*/
+        UPLOADTOBLOB_MULTIBLOCK_SAVED_DATA* savedData = (UPLOADTOBLOB_MULTIBLOCK_SAVED_DATA*)malloc(sizeof(UPLOADTOBLOB_MULTIBLOCK_SAVED_DATA));
+        if (savedData == NULL)
         {
-            /*Codes_SRS_IOTHUBCLIENT_02_053: [ If copying to the structure or spawning the thread fails, then IoTHubClient_UploadToBlobAsync shall fail and return IOTHUB_CLIENT_ERROR. ]*/
-            LogError("unable to create upload thread info");
+            /*Codes_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure, starting the worker thread or queuing the upload fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+            LogError("unable to allocate the upload data");
             result = IOTHUB_CLIENT_ERROR;
         }
         else
         {
-            /*Codes_SRS_IOTHUBCLIENT_99_075: [ `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall copy the `destinationFileName`, `getDataCallback`, `context`  and `iotHubClientHandle` into a structure. ]*/
-            threadInfo->uploadBlobMultiblockSavedData.getDataCallback = getDataCallback;
-            threadInfo->uploadBlobMultiblockSavedData.getDataCallbackEx = getDataCallbackEx;
+            savedData->getDataCallback = getDataCallback;
+            savedData->getDataCallbackEx = getDataCallbackEx;
+            savedData->context = context;
 
+            /*Codes_SRS_IOTHUBCLIENT_99_076: [ `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall start the worker thread if it was not previously started and, under the lock created in `IoTHubClient_Create`, call `IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx` with the structure, so that the upload is carried out by the `IoTHubClient_LL_DoWork` calls of the worker thread. ]*/
             if ((result = StartWorkerThreadIfNeeded(iotHubClientHandle)) != IOTHUB_CLIENT_OK)
             {
-                /*Codes_SRS_IOTHUBCLIENT_02_053: [ If copying to the structure or spawning the thread fails, then IoTHubClient_UploadToBlobAsync shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+                /*Codes_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure, starting the worker thread or queuing the upload fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
                 LogError("Could not start worker thread");
-                freeUploadToBlobThreadInfo(threadInfo);
-            }            
-            else if ((result = startUploadToBlobWorkerThread(threadInfo, uploadMultipleBlock_thread)) != IOTHUB_CLIENT_OK)
+                free(savedData);
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else if (Lock(iotHubClientHandle->LockHandle) != LOCK_OK)
             {
-                /*Codes_SRS_IOTHUBCLIENT_02_053: [ If copying to the structure or spawning the thread fails, then IoTHubClient_UploadToBlobAsync shall fail and return IOTHUB_CLIENT_ERROR. ]*/
-                LogError("unable to start upload thread");
-                freeUploadToBlobThreadInfo(threadInfo);
+                /*Codes_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure, starting the worker thread or queuing the upload fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+                LogError("Could not acquire lock");
+                free(savedData);
+                result = IOTHUB_CLIENT_ERROR;
             }
             else
             {
-                /*Codes_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure and spawning the thread succeeds, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall return `IOTHUB_CLIENT_OK`. ]*/
-                result = IOTHUB_CLIENT_OK;
+                if (IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx(iotHubClientHandle->IoTHubClientLLHandle, destinationFileName, uploadMultipleBlocksAsyncCallback, savedData) != IOTHUB_CLIENT_OK)
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure, starting the worker thread or queuing the upload fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+                    LogError("unable to IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx");
+                    free(savedData);
+                    result = IOTHUB_CLIENT_ERROR;
+                }
+                else
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure and queuing the upload succeeds, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall return `IOTHUB_CLIENT_OK`. ]*/
+                    result = IOTHUB_CLIENT_OK;
+                }
+                (void)Unlock(iotHubClientHandle->LockHandle);
             }
         }
     }
@@ -2159,4 +2242,69 @@ IOTHUB_CLIENT_RESULT IoTHubClient_UploadMultipleBlocksToBlobAsyncEx(IOTHUB_CLIEN
     return IoTHubClient_UploadMultipleBlocksToBlobAsync_Impl(iotHubClientHandle, destinationFileName, NULL, getDataCallbackEx, context);
 }
 
+IOTHUB_CLIENT_RESULT IoTHubClient_SetFileUploadProgressCallback(IOTHUB_CLIENT_HANDLE iotHubClientHandle, IOTHUB_CLIENT_FILE_UPLOAD_PROGRESS_CALLBACK progressCallback, void* userContextCallback)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    if (iotHubClientHandle == NULL)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_09_010: [ If `iotHubClientHandle` is `NULL` then `IoTHubClient_SetFileUploadProgressCallback` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+        result = IOTHUB_CLIENT_INVALID_ARG;
+        LogError("NULL iothubClientHandle");
+    }
+    else
+    {
+        IOTHUB_CLIENT_INSTANCE* iotHubClientInstance = (IOTHUB_CLIENT_INSTANCE*)iotHubClientHandle;
+
+        /*Codes_SRS_IOTHUBCLIENT_09_011: [ `IoTHubClient_SetFileUploadProgressCallback` shall start the worker thread if it was not previously started and, under the lock created in `IoTHubClient_Create`, save `progressCallback` and call `IoTHubClient_LL_SetFileUploadProgressCallback` with a callback that queues the notifications and a context holding `userContextCallback`. ]*/
+        if ((result = StartWorkerThreadIfNeeded(iotHubClientInstance)) != IOTHUB_CLIENT_OK)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_09_012: [ If any of these operations fails, `IoTHubClient_SetFileUploadProgressCallback` shall return `IOTHUB_CLIENT_ERROR`. ]*/
+            result = IOTHUB_CLIENT_ERROR;
+            LogError("Could not start worker thread");
+        }
+        else if (Lock(iotHubClientInstance->LockHandle) != LOCK_OK)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_09_012: [ If any of these operations fails, `IoTHubClient_SetFileUploadProgressCallback` shall return `IOTHUB_CLIENT_ERROR`. ]*/
+            result = IOTHUB_CLIENT_ERROR;
+            LogError("Could not acquire lock");
+        }
+        else
+        {
+            IOTHUB_QUEUE_CONTEXT* queue_context = (IOTHUB_QUEUE_CONTEXT*)malloc(sizeof(IOTHUB_QUEUE_CONTEXT));
+            if (queue_context == NULL)
+            {
+                /*Codes_SRS_IOTHUBCLIENT_09_012: [ If any of these operations fails, `IoTHubClient_SetFileUploadProgressCallback` shall return `IOTHUB_CLIENT_ERROR`. ]*/
+                result = IOTHUB_CLIENT_ERROR;
+                LogError("Failed allocating QUEUE_CONTEXT");
+            }
+            else
+            {
+                queue_context->iotHubClientHandle = iotHubClientInstance;
+                queue_context->userContextCallback = userContextCallback;
+
+                if (IoTHubClient_LL_SetFileUploadProgressCallback(iotHubClientInstance->IoTHubClientLLHandle, iothub_ll_file_upload_progress_callback, queue_context) != IOTHUB_CLIENT_OK)
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_09_012: [ If any of these operations fails, `IoTHubClient_SetFileUploadProgressCallback` shall return `IOTHUB_CLIENT_ERROR`. ]*/
+                    result = IOTHUB_CLIENT_ERROR;
+                    LogError("IoTHubClient_LL_SetFileUploadProgressCallback failed");
+                    free(queue_context);
+                }
+                else
+                {
+                    if (iotHubClientInstance->file_upload_progress_user_context != NULL)
+                    {
+                        free(iotHubClientInstance->file_upload_progress_user_context);
+                    }
+                    iotHubClientInstance->file_upload_progress_user_context = queue_context;
+                    iotHubClientInstance->file_upload_progress_callback = progressCallback;
+                    result = IOTHUB_CLIENT_OK;
+                }
+            }
+            (void)Unlock(iotHubClientInstance->LockHandle);
+        }
+    }
+    return result;
+}
+
 #endif /*DONT_USE_UPLOADTOBLOB*/
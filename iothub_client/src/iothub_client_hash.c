@@ -0,0 +1,26 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "iothub_client_hash.h"
+
+#define FNV_32_OFFSET_BASIS 2166136261u
+#define FNV_32_PRIME        16777619u
+
+uint32_t iothub_client_hash_string(const char* value)
+{
+	// Codes_SRS_IOTHUB_CLIENT_HASH_09_001: [`iothub_client_hash_string` shall return the 32 bit FNV-1a hash of the characters of `value` up to its terminating null character]
+	// Codes_SRS_IOTHUB_CLIENT_HASH_09_002: [If `value` is NULL, `iothub_client_hash_string` shall return the hash of an empty string]
+	uint32_t hash = FNV_32_OFFSET_BASIS;
+
+	if (value != NULL)
+	{
+		while (*value != '\0')
+		{
+			hash ^= (unsigned char)*value;
+			hash *= FNV_32_PRIME;
+			value++;
+		}
+	}
+
+	return hash;
+}
@@ -1006,6 +1006,21 @@ void IoTHubClient_LL_Destroy(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
     }
 }
 
+/*inserts newEntry after the last record with the same or higher priority, so messages of one priority keep their FIFO order*/
+static void insert_by_priority(PDLIST_ENTRY waitingToSend, IOTHUB_MESSAGE_LIST* newEntry)
+{
+    PDLIST_ENTRY insertBefore = waitingToSend;
+
+    while (insertBefore->Blink != waitingToSend &&
+        containingRecord(insertBefore->Blink, IOTHUB_MESSAGE_LIST, entry)->priority < newEntry->priority)
+    {
+        insertBefore = insertBefore->Blink;
+    }
+
+    /*inserting at the tail of the list "headed" by insertBefore places newEntry right before it*/
+    DList_InsertTailList(insertBefore, &(newEntry->entry));
+}
+
 /*Codes_SRS_IOTHUBCLIENT_LL_02_044: [ Messages already delivered to IoTHubClient_LL shall not have their timeouts modified by a new call to IoTHubClient_LL_SetOption. ]*/
 /*returns 0 on success, any other value is error*/
 static int attach_ms_timesOutAfter(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, IOTHUB_MESSAGE_LIST *newEntry)
@@ -1088,7 +1103,9 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_SendEventAsync(IOTHUB_CLIENT_LL_HANDLE iotH
                     /*Codes_SRS_IOTHUBCLIENT_LL_02_013: [IoTHubClient_LL_SendEventAsync shall add the DLIST waitingToSend a new record cloning the information from eventMessageHandle, eventConfirmationCallback, userContextCallback.]*/
                     newEntry->callback = eventConfirmationCallback;
                     newEntry->context = userContextCallback;
-                    DList_InsertTailList(&(iotHubClientHandle->waitingToSend), &(newEntry->entry));
+                    /*Codes_SRS_IOTHUBCLIENT_LL_09_011: [IoTHubClient_LL_SendEventAsync shall insert the new record in waitingToSend after all records with the same or higher priority, as returned by IoTHubMessage_GetPriority.]*/
+                    newEntry->priority = IoTHubMessage_GetPriority(newEntry->messageHandle);
+                    insert_by_priority(&(iotHubClientHandle->waitingToSend), newEntry);
                     /*Codes_SRS_IOTHUBCLIENT_LL_02_015: [Otherwise IoTHubClient_LL_SendEventAsync shall succeed and return IOTHUB_CLIENT_OK.] */
                     result = IOTHUB_CLIENT_OK;
                 }
@@ -1336,6 +1353,11 @@ void IoTHubClient_LL_DoWork(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
 
         /*Codes_SRS_IOTHUBCLIENT_LL_02_021: [Otherwise, IoTHubClient_LL_DoWork shall invoke the underlaying layer's _DoWork function.]*/
         handleData->IoTHubTransport_DoWork(handleData->transportHandle, iotHubClientHandle);
+
+#ifndef DONT_USE_UPLOADTOBLOB
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_025: [ IoTHubClient_LL_DoWork shall then call IoTHubClient_LL_UploadToBlob_DoWork to advance the pending asynchronous uploads. ]*/
+        IoTHubClient_LL_UploadToBlob_DoWork(handleData->uploadToBlobHandle);
+#endif /*DONT_USE_UPLOADTOBLOB*/
     }
 }
 
@@ -1762,7 +1784,9 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_SetOption(IOTHUB_CLIENT_LL_HANDLE iotHubCli
                 result = IOTHUB_CLIENT_OK;
             }
         }
-        else if (strcmp(optionName, OPTION_BLOB_UPLOAD_TIMEOUT_SECS) == 0)
+        else if ((strcmp(optionName, OPTION_BLOB_UPLOAD_TIMEOUT_SECS) == 0) ||
+            (strcmp(optionName, OPTION_BLOB_UPLOAD_CONTENT_ENCODING) == 0) ||
+            (strcmp(optionName, OPTION_BLOB_UPLOAD_RESUMABLE) == 0))
         {
 #ifndef DONT_USE_UPLOADTOBLOB
             // This option just gets passed down into IoTHubClient_LL_UploadToBlob
@@ -2101,6 +2125,27 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob(IOTHUB_CLIENT_LL_HANDLE iotHub
     return result;
 }
 
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadFileToBlob(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, const char* destinationFileName, const char* localFilePath)
+{
+    IOTHUB_CLIENT_RESULT result;
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_047: [ If iotHubClientHandle, destinationFileName or localFilePath is NULL then IoTHubClient_LL_UploadFileToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (iotHubClientHandle == NULL) ||
+        (destinationFileName == NULL) ||
+        (localFilePath == NULL)
+        )
+    {
+        LogError("invalid parameters IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle=%p, const char* destinationFileName=%p, const char* localFilePath=%p", iotHubClientHandle, destinationFileName, localFilePath);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_048: [ Otherwise IoTHubClient_LL_UploadFileToBlob shall call IoTHubClient_LL_UploadFileToBlob_Impl and return its result. ]*/
+        result = IoTHubClient_LL_UploadFileToBlob_Impl(iotHubClientHandle->uploadToBlobHandle, destinationFileName, localFilePath);
+    }
+    return result;
+}
+
 typedef struct UPLOAD_MULTIPLE_BLOCKS_WRAPPER_CONTEXT_TAG
 {
     IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK getDataCallback;
@@ -2163,6 +2208,86 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlobEx(IOTHUB_CLIENT_
     return result;
 }
 
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_GetFileUploadResumeToken(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, char** resumeToken, size_t* bytesUploaded)
+{
+    IOTHUB_CLIENT_RESULT result;
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_065: [ If iotHubClientHandle, resumeToken or bytesUploaded is NULL then IoTHubClient_LL_GetFileUploadResumeToken shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (iotHubClientHandle == NULL) ||
+        (resumeToken == NULL) ||
+        (bytesUploaded == NULL)
+        )
+    {
+        LogError("invalid parameters IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle=%p, resumeToken=%p, bytesUploaded=%p", iotHubClientHandle, resumeToken, bytesUploaded);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_066: [ Otherwise IoTHubClient_LL_GetFileUploadResumeToken shall call IoTHubClient_LL_UploadToBlob_GetResumeToken and return its result. ]*/
+        result = IoTHubClient_LL_UploadToBlob_GetResumeToken(iotHubClientHandle->uploadToBlobHandle, resumeToken, bytesUploaded);
+    }
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_ResumeMultipleBlocksToBlobEx(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, const char* resumeToken, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
+{
+    IOTHUB_CLIENT_RESULT result;
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_039: [ If iotHubClientHandle, resumeToken or getDataCallbackEx is NULL then IoTHubClient_LL_ResumeMultipleBlocksToBlobEx shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (iotHubClientHandle == NULL) ||
+        (resumeToken == NULL) ||
+        (getDataCallbackEx == NULL)
+        )
+    {
+        LogError("invalid parameters IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle=%p, resumeToken=%p, getDataCallbackEx=%p", iotHubClientHandle, resumeToken, getDataCallbackEx);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_040: [ Otherwise IoTHubClient_LL_ResumeMultipleBlocksToBlobEx shall call IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl and return its result. ]*/
+        result = IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl(iotHubClientHandle->uploadToBlobHandle, resumeToken, getDataCallbackEx, context);
+    }
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, const char* destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
+{
+    IOTHUB_CLIENT_RESULT result;
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_026: [ If iotHubClientHandle, destinationFileName or getDataCallbackEx is NULL then IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (iotHubClientHandle == NULL) ||
+        (destinationFileName == NULL) ||
+        (getDataCallbackEx == NULL)
+        )
+    {
+        LogError("invalid parameters IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle=%p, destinationFileName=%p, getDataCallbackEx=%p", iotHubClientHandle, destinationFileName, getDataCallbackEx);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_027: [ Otherwise IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx shall call IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl and return its result. ]*/
+        result = IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(iotHubClientHandle->uploadToBlobHandle, destinationFileName, getDataCallbackEx, context);
+    }
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_SetFileUploadProgressCallback(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_FILE_UPLOAD_PROGRESS_CALLBACK progressCallback, void* userContextCallback)
+{
+    IOTHUB_CLIENT_RESULT result;
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_049: [ If iotHubClientHandle is NULL then IoTHubClient_LL_SetFileUploadProgressCallback shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (iotHubClientHandle == NULL)
+    {
+        LogError("invalid parameters IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle=%p", iotHubClientHandle);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_050: [ Otherwise IoTHubClient_LL_SetFileUploadProgressCallback shall call IoTHubClient_LL_UploadToBlob_SetProgressCallback and return its result. ]*/
+        result = IoTHubClient_LL_UploadToBlob_SetProgressCallback(iotHubClientHandle->uploadToBlobHandle, progressCallback, userContextCallback);
+    }
+    return result;
+}
+
 
 
 #endif /* DONT_USE_UPLOADTOBLOB */
@@ -7,6 +7,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/string_tokenizer.h"
@@ -72,15 +73,80 @@ typedef struct IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA_TAG
     HTTP_PROXY_OPTIONS http_proxy_options;
     size_t curl_verbose;
     size_t blob_upload_timeout_secs;
+    char* blob_content_encoding; /*Content-Encoding stored with the uploaded blobs, if any*/
+    struct UPLOADTOBLOB_ASYNC_CONTEXT_TAG* pendingUploads; /*uploads started by IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl, advanced by IoTHubClient_LL_UploadToBlob_DoWork*/
+    bool blob_upload_resumable; /*when true an upload interrupted by an HTTP error is kept in interruptedUpload instead of being reported to IoTHub*/
+    struct UPLOADTOBLOB_INTERRUPTED_UPLOAD_TAG* interruptedUpload; /*the latest interrupted upload, IoTHubClient_LL_UploadToBlob_GetResumeToken makes a resume token out of it*/
+    IOTHUB_CLIENT_FILE_UPLOAD_PROGRESS_CALLBACK progressCallback; /*notified after every block of a pending upload stored by Azure Storage*/
+    void* progressCallbackContext;
 }IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA;
 
 typedef struct BLOB_UPLOAD_CONTEXT_TAG
 {
     const unsigned char* blobSource; /* source to upload */
+    BLOB_FILE_MAPPING_HANDLE fileMapping; /* when not NULL, the blocks are read from this file instead of blobSource */
     size_t blobSourceSize; /* size of the source */
     size_t remainingSizeToUpload; /* size not yet uploaded */
+    size_t blockSize; /* size of the blocks handed to Blob_UploadMultipleBlocksFromSasUri */
 }BLOB_UPLOAD_CONTEXT;
 
+/*smallest block IoTHubClient_LL_UploadFileToBlob_Impl uses, smaller blocks would only add requests to storage*/
+#define FILE_UPLOAD_MIN_BLOCK_SIZE (1024 * 1024)
+
+#define UPLOADTOBLOB_ASYNC_STATE_VALUES \
+    UPLOADTOBLOB_ASYNC_STATE_START,         \
+    UPLOADTOBLOB_ASYNC_STATE_UPLOAD_BLOCKS, \
+    UPLOADTOBLOB_ASYNC_STATE_RETRY_BLOCK,   \
+    UPLOADTOBLOB_ASYNC_STATE_COMMIT
+DEFINE_ENUM(UPLOADTOBLOB_ASYNC_STATE, UPLOADTOBLOB_ASYNC_STATE_VALUES);
+
+typedef struct UPLOADTOBLOB_ASYNC_CONTEXT_TAG
+{
+    struct UPLOADTOBLOB_ASYNC_CONTEXT_TAG* next;
+    UPLOADTOBLOB_ASYNC_STATE state;
+    char* destinationFileName;
+    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx;
+    void* context;
+    HTTPAPIEX_HANDLE iotHubHttpApiExHandle; /*these are built by step 1 and used by step 3 too*/
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    STRING_HANDLE correlationId;
+    STRING_HANDLE sasUri;
+    BUFFER_HANDLE responseToIoTHub;
+    BLOB_UPLOAD_HANDLE blobUploadHandle; /*step 2, one storage request per call to IoTHubClient_LL_UploadToBlob_DoWork*/
+    unsigned int httpResponse;
+    size_t bytesUploaded; /*reported to progressCallback*/
+    const unsigned char* retrySource; /*block refused by storage with a server error, sent again once retryDelayInMs have elapsed since retryStartTime*/
+    size_t retrySize;
+    unsigned int retryCount; /*retries of the current block*/
+    tickcounter_ms_t retryDelayInMs;
+    tickcounter_ms_t retryStartTime;
+    TICK_COUNTER_HANDLE tickCounter; /*created on the first retry*/
+}UPLOADTOBLOB_ASYNC_CONTEXT;
+
+typedef struct UPLOADTOBLOB_INTERRUPTED_UPLOAD_TAG
+{
+    STRING_HANDLE correlationId; /*step 3 of the resumed upload reports to IoTHub under the correlationId of step 1*/
+    STRING_HANDLE sasUri;
+    unsigned int blockCount; /*blocks 0 to blockCount - 1 are stored by Azure Storage, the upload resumes with block blockCount*/
+    size_t bytesUploaded; /*size of the stored blocks*/
+    bool resumeTokenTaken; /*the application holds a resume token, so the upload can be resumed after the handle is destroyed*/
+}UPLOADTOBLOB_INTERRUPTED_UPLOAD;
+
+typedef struct UPLOADTOBLOB_BLOCK_COUNTER_TAG
+{
+    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx;
+    void* context;
+    unsigned int blockCount; /*blocks returned by getDataCallbackEx*/
+    size_t bytesCount;
+    size_t lastBlockSize;
+    bool endOfData; /*getDataCallbackEx returned no data, every block returned was handed to Azure Storage*/
+}UPLOADTOBLOB_BLOCK_COUNTER;
+
+#define RESUME_TOKEN_CORRELATION_ID "correlationId"
+#define RESUME_TOKEN_SAS_URI "sasUri"
+#define RESUME_TOKEN_BLOCK_COUNT "blockCount"
+#define RESUME_TOKEN_BYTES_UPLOADED "bytesUploaded"
+
 IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE IoTHubClient_LL_UploadToBlob_Create(const IOTHUB_CLIENT_CONFIG* config)
 {
     IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData = malloc(sizeof(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA));
@@ -125,6 +191,12 @@ IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE IoTHubClient_LL_UploadToBlob_Create(const I
                 memset(&(handleData->http_proxy_options), 0, sizeof(HTTP_PROXY_OPTIONS));
                 handleData->curl_verbose = 0;
                 handleData->blob_upload_timeout_secs = 0;
+                handleData->blob_content_encoding = NULL;
+                handleData->pendingUploads = NULL;
+                handleData->blob_upload_resumable = false;
+                handleData->interruptedUpload = NULL;
+                handleData->progressCallback = NULL;
+                handleData->progressCallbackContext = NULL;
 
                 if ((config->deviceSasToken != NULL) && (config->deviceKey == NULL))
                 {
@@ -175,6 +247,29 @@ IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE IoTHubClient_LL_UploadToBlob_Create(const I
 }
 
 /*returns 0 when correlationId, sasUri contain data*/
+/*adds the request HTTP headers shared by steps 1 and 3, returns 0 on success*/
+static int addRequestHttpHeaders(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, HTTP_HEADERS_HANDLE requestHttpHeaders)
+{
+    int result;
+    /*Codes_SRS_IOTHUBCLIENT_LL_02_072: [ IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall add the following name:value to request HTTP headers: ] "Content-Type": "application/json" "Accept": "application/json" "User-Agent": "iothubclient/" IOTHUB_SDK_VERSION*/
+    /*Codes_SRS_IOTHUBCLIENT_LL_02_107: [ - "Authorization" header shall not be build. ]*/
+    if (!(
+        (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "Content-Type", "application/json") == HTTP_HEADERS_OK) &&
+        (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "Accept", "application/json") == HTTP_HEADERS_OK) &&
+        (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "User-Agent", "iothubclient/" IOTHUB_SDK_VERSION) == HTTP_HEADERS_OK) &&
+        (handleData->authorizationScheme == X509 || (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "Authorization", "") == HTTP_HEADERS_OK))
+        ))
+    {
+        LogError("unable to HTTPHeaders_AddHeaderNameValuePair");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
 static int IoTHubClient_LL_UploadToBlob_step1and2(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, HTTPAPIEX_HANDLE iotHubHttpApiExHandle, HTTP_HEADERS_HANDLE requestHttpHeaders, const char* destinationFileName,
     STRING_HANDLE correlationId, STRING_HANDLE sasUri)
 {
@@ -244,17 +339,10 @@ static int IoTHubClient_LL_UploadToBlob_step1and2(IOTHUB_CLIENT_LL_UPLOADTOBLOB_
                         }
                         else
                         {
-                            /*Codes_SRS_IOTHUBCLIENT_LL_02_072: [ IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall add the following name:value to request HTTP headers: ] "Content-Type": "application/json" "Accept": "application/json" "User-Agent": "iothubclient/" IOTHUB_SDK_VERSION*/
-                            /*Codes_SRS_IOTHUBCLIENT_LL_02_107: [ - "Authorization" header shall not be build. ]*/
-                            if (!(
-                                (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "Content-Type", "application/json") == HTTP_HEADERS_OK) &&
-                                (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "Accept", "application/json") == HTTP_HEADERS_OK) &&
-                                (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "User-Agent", "iothubclient/" IOTHUB_SDK_VERSION) == HTTP_HEADERS_OK) &&
-                                (handleData->authorizationScheme == X509 || (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "Authorization", "") == HTTP_HEADERS_OK))
-                                ))
+                            if (addRequestHttpHeaders(handleData, requestHttpHeaders) != 0)
                             {
                                 /*Codes_SRS_IOTHUBCLIENT_LL_02_071: [ If creating the HTTP headers fails then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall fail and return IOTHUB_CLIENT_ERROR. ]*/
-                                LogError("unable to HTTPHeaders_AddHeaderNameValuePair");
+                                LogError("unable to add the request HTTP headers");
                                 result = __FAILURE__;
                             }
                             else
@@ -776,6 +864,7 @@ static int IoTHubClient_LL_UploadToBlob_step3(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HAND
 // this callback splits the source data into blocks to be fed to IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)_Impl
 static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT FileUpload_GetData_Callback(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context)
 {
+    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT getDataResult = IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
     BLOB_UPLOAD_CONTEXT* uploadContext = (BLOB_UPLOAD_CONTEXT*) context;
 
     if (data == NULL || size == NULL)
@@ -797,13 +886,30 @@ static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT FileUpload_GetData_Callback(IOT
     else
     {
         // Upload next block
-        size_t thisBlockSize = (uploadContext->remainingSizeToUpload > BLOCK_SIZE) ? BLOCK_SIZE : uploadContext->remainingSizeToUpload;
-        *data = (unsigned char*)uploadContext->blobSource + (uploadContext->blobSourceSize - uploadContext->remainingSizeToUpload);
-        *size = thisBlockSize;
-        uploadContext->remainingSizeToUpload -= thisBlockSize;
+        size_t thisBlockSize = (uploadContext->remainingSizeToUpload > uploadContext->blockSize) ? uploadContext->blockSize : uploadContext->remainingSizeToUpload;
+        size_t offset = uploadContext->blobSourceSize - uploadContext->remainingSizeToUpload;
+        if (uploadContext->fileMapping == NULL)
+        {
+            *data = (unsigned char*)uploadContext->blobSource + offset;
+            *size = thisBlockSize;
+            uploadContext->remainingSizeToUpload -= thisBlockSize;
+        }
+        else if (Blob_ReadFileBlock(uploadContext->fileMapping, offset, thisBlockSize, data) != 0)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_068: [ If Blob_ReadFileBlock fails then IoTHubClient_LL_UploadFileToBlob_Impl shall abort the upload. ]*/
+            LogError("unable to read the block at offset %zu of the file", offset);
+            *data = NULL;
+            *size = 0;
+            getDataResult = IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT;
+        }
+        else
+        {
+            *size = thisBlockSize;
+            uploadContext->remainingSizeToUpload -= thisBlockSize;
+        }
     }
 
-    return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
+    return getDataResult;
 }
 
 static HTTPAPIEX_RESULT set_transfer_timeout(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, HTTPAPIEX_HANDLE iotHubHttpApiExHandle)
@@ -822,6 +928,386 @@ static HTTPAPIEX_RESULT set_transfer_timeout(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDL
     return result;
 }
 
+/*returns a HTTPAPIEX_HANDLE to the IoTHub hostname with all the options of handleData set, or NULL*/
+static HTTPAPIEX_HANDLE createIotHubHttpApiExHandle(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData)
+{
+    /*Codes_SRS_IOTHUBCLIENT_LL_02_064: [ IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall create an HTTPAPIEX_HANDLE to the IoTHub hostname. ]*/
+    HTTPAPIEX_HANDLE result = HTTPAPIEX_Create(handleData->hostname);
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_02_065: [ If creating the HTTPAPIEX_HANDLE fails then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+    if (result == NULL)
+    {
+        LogError("unable to HTTPAPIEX_Create");
+    }
+    /*Codes_SRS_IOTHUBCLIENT_LL_30_020: [ If the blob_upload_timeout_secs option has been set to non-zero, IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall set the timeout on the underlying transport accordingly. ]*/
+    else if (set_transfer_timeout(handleData, result) != HTTPAPIEX_OK)
+    {
+        LogError("unable to set blob transfer timeout");
+        HTTPAPIEX_Destroy(result);
+        result = NULL;
+    }
+    else
+    {
+        (void)HTTPAPIEX_SetOption(result, OPTION_CURL_VERBOSE, &handleData->curl_verbose);
+
+        if (
+            (handleData->authorizationScheme == X509) &&
+
+            /*transmit the x509certificate and x509privatekey*/
+            /*Codes_SRS_IOTHUBCLIENT_LL_02_106: [ - x509certificate and x509privatekey saved options shall be passed on the HTTPAPIEX_SetOption ]*/
+            (!(
+                (HTTPAPIEX_SetOption(result, OPTION_X509_CERT, handleData->credentials.x509credentials.x509certificate) == HTTPAPIEX_OK) &&
+                (HTTPAPIEX_SetOption(result, OPTION_X509_PRIVATE_KEY, handleData->credentials.x509credentials.x509privatekey) == HTTPAPIEX_OK)
+            ))
+            )
+        {
+            LogError("unable to HTTPAPIEX_SetOption for x509");
+            HTTPAPIEX_Destroy(result);
+            result = NULL;
+        }
+        /*Codes_SRS_IOTHUBCLIENT_LL_02_111: [ If certificates is non-NULL then certificates shall be passed to HTTPAPIEX_SetOption with optionName TrustedCerts. ]*/
+        else if ((handleData->certificates != NULL) && (HTTPAPIEX_SetOption(result, "TrustedCerts", handleData->certificates) != HTTPAPIEX_OK))
+        {
+            LogError("unable to set TrustedCerts!");
+            HTTPAPIEX_Destroy(result);
+            result = NULL;
+        }
+        else if (handleData->http_proxy_options.host_address != NULL)
+        {
+            HTTP_PROXY_OPTIONS proxy_options;
+            proxy_options = handleData->http_proxy_options;
+
+            if (HTTPAPIEX_SetOption(result, OPTION_HTTP_PROXY, &proxy_options) != HTTPAPIEX_OK)
+            {
+                LogError("unable to set http proxy!");
+                HTTPAPIEX_Destroy(result);
+                result = NULL;
+            }
+        }
+    }
+    return result;
+}
+
+/*builds the notification of step 3 out of the result of step 2 and sends it to IoTHub*/
+static IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_notify(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, STRING_HANDLE correlationId, HTTPAPIEX_HANDLE iotHubHttpApiExHandle, HTTP_HEADERS_HANDLE requestHttpHeaders,
+    BLOB_RESULT uploadMultipleBlocksResult, unsigned int httpResponse, BUFFER_HANDLE responseToIoTHub)
+{
+    IOTHUB_CLIENT_RESULT result;
+    if (uploadMultipleBlocksResult == BLOB_ABORTED)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_99_008: [ If step 2 is aborted by the client, then the HTTP message body shall look like:  ]*/
+        LogInfo("Blob_UploadFromSasUri aborted file upload");
+
+        if (BUFFER_build(responseToIoTHub, (const unsigned char*)FILE_UPLOAD_ABORTED_BODY, sizeof(FILE_UPLOAD_ABORTED_BODY) / sizeof(FILE_UPLOAD_ABORTED_BODY[0])) == 0)
+        {
+            if (IoTHubClient_LL_UploadToBlob_step3(handleData, correlationId, iotHubHttpApiExHandle, requestHttpHeaders, responseToIoTHub) != 0)
+            {
+                LogError("IoTHubClient_LL_UploadToBlob_step3 failed");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_99_009: [ If step 2 is aborted by the client and if step 3 succeeds, then `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` shall return `IOTHUB_CLIENT_OK`. ] */
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        else
+        {
+            LogError("Unable to BUFFER_build, can't perform IoTHubClient_LL_UploadToBlob_step3");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+    }
+    else if (uploadMultipleBlocksResult != BLOB_OK)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_02_084: [ If Blob_UploadFromSasUri fails then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+        LogError("unable to Blob_UploadFromSasUri");
+
+        /*do step 3*/ /*try*/
+        /*Codes_SRS_IOTHUBCLIENT_LL_02_091: [ If step 2 fails without establishing an HTTP dialogue, then the HTTP message body shall look like: ]*/
+        if (BUFFER_build(responseToIoTHub, (const unsigned char*)FILE_UPLOAD_FAILED_BODY, sizeof(FILE_UPLOAD_FAILED_BODY) / sizeof(FILE_UPLOAD_FAILED_BODY[0])) == 0)
+        {
+            if (IoTHubClient_LL_UploadToBlob_step3(handleData, correlationId, iotHubHttpApiExHandle, requestHttpHeaders, responseToIoTHub) != 0)
+            {
+                LogError("IoTHubClient_LL_UploadToBlob_step3 failed");
+            }
+        }
+        result = IOTHUB_CLIENT_ERROR;
+    }
+    else
+    {
+        /*must make a json*/
+
+        int requiredStringLength = snprintf(NULL, 0, "{\"isSuccess\":%s, \"statusCode\":%d, \"statusDescription\":\"%s\"}", ((httpResponse < 300) ? "true" : "false"), httpResponse, BUFFER_u_char(responseToIoTHub));
+
+        char * requiredString = malloc(requiredStringLength + 1);
+        if (requiredString == 0)
+        {
+            LogError("unable to malloc");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            /*do again snprintf*/
+            BUFFER_HANDLE toBeTransmitted = NULL;
+            (void)snprintf(requiredString, requiredStringLength + 1, "{\"isSuccess\":%s, \"statusCode\":%d, \"statusDescription\":\"%s\"}", ((httpResponse < 300) ? "true" : "false"), httpResponse, BUFFER_u_char(responseToIoTHub));
+            toBeTransmitted = BUFFER_create((const unsigned char*)requiredString, requiredStringLength);
+            if (toBeTransmitted == NULL)
+            {
+                LogError("unable to BUFFER_create");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                if (IoTHubClient_LL_UploadToBlob_step3(handleData, correlationId, iotHubHttpApiExHandle, requestHttpHeaders, toBeTransmitted) != 0)
+                {
+                    LogError("IoTHubClient_LL_UploadToBlob_step3 failed");
+                    result = IOTHUB_CLIENT_ERROR;
+                }
+                else
+                {
+                    result = (httpResponse < 300) ? IOTHUB_CLIENT_OK : IOTHUB_CLIENT_ERROR;
+                }
+                BUFFER_delete(toBeTransmitted);
+            }
+            free(requiredString);
+        }
+    }
+    return result;
+}
+
+static void destroyInterruptedUpload(UPLOADTOBLOB_INTERRUPTED_UPLOAD* interruptedUpload)
+{
+    STRING_delete(interruptedUpload->sasUri);
+    STRING_delete(interruptedUpload->correlationId);
+    free(interruptedUpload);
+}
+
+static UPLOADTOBLOB_INTERRUPTED_UPLOAD* createInterruptedUpload(const char* correlationId, const char* sasUri, unsigned int blockCount, size_t bytesUploaded)
+{
+    UPLOADTOBLOB_INTERRUPTED_UPLOAD* result = (UPLOADTOBLOB_INTERRUPTED_UPLOAD*)malloc(sizeof(UPLOADTOBLOB_INTERRUPTED_UPLOAD));
+    if (result == NULL)
+    {
+        LogError("oom - malloc");
+        /*return as is*/
+    }
+    else if ((result->correlationId = STRING_construct(correlationId)) == NULL)
+    {
+        LogError("unable to STRING_construct");
+        free(result);
+        result = NULL;
+    }
+    else if ((result->sasUri = STRING_construct(sasUri)) == NULL)
+    {
+        LogError("unable to STRING_construct");
+        STRING_delete(result->correlationId);
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        result->blockCount = blockCount;
+        result->bytesUploaded = bytesUploaded;
+        result->resumeTokenTaken = false;
+    }
+    return result;
+}
+
+/*builds the request HTTP headers step 3 of a kept upload is sent with, the same step 1 was sent with*/
+static HTTP_HEADERS_HANDLE createNotificationHttpHeaders(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData)
+{
+    HTTP_HEADERS_HANDLE result = HTTPHeaders_Alloc();
+    if (result == NULL)
+    {
+        LogError("unable to HTTPHeaders_Alloc");
+    }
+    else if (addRequestHttpHeaders(handleData, result) != 0)
+    {
+        LogError("unable to add the request HTTP headers");
+        HTTPHeaders_Free(result);
+        result = NULL;
+    }
+    else if (
+        (handleData->authorizationScheme == SAS_TOKEN) &&
+        (HTTPHeaders_ReplaceHeaderNameValuePair(result, "Authorization", STRING_c_str(handleData->credentials.sas)) != HTTP_HEADERS_OK)
+        )
+    {
+        LogError("unable to HTTPHeaders_ReplaceHeaderNameValuePair");
+        HTTPHeaders_Free(result);
+        result = NULL;
+    }
+    return result;
+}
+
+/*performs step 3 for a kept upload*/
+static IOTHUB_CLIENT_RESULT notifyInterruptedUpload(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, UPLOADTOBLOB_INTERRUPTED_UPLOAD* interruptedUpload, HTTPAPIEX_HANDLE iotHubHttpApiExHandle,
+    BLOB_RESULT uploadMultipleBlocksResult, unsigned int httpResponse, BUFFER_HANDLE responseToIoTHub)
+{
+    IOTHUB_CLIENT_RESULT result;
+    HTTP_HEADERS_HANDLE requestHttpHeaders = createNotificationHttpHeaders(handleData);
+    if (requestHttpHeaders == NULL)
+    {
+        LogError("unable to create the request HTTP headers");
+        result = IOTHUB_CLIENT_ERROR;
+    }
+    else
+    {
+        result = IoTHubClient_LL_UploadToBlob_notify(handleData, interruptedUpload->correlationId, iotHubHttpApiExHandle, requestHttpHeaders, uploadMultipleBlocksResult, httpResponse, responseToIoTHub);
+        HTTPHeaders_Free(requestHttpHeaders);
+    }
+    return result;
+}
+
+/*reports the kept interrupted upload to IoTHub as failed*/
+static void abandonInterruptedUpload(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, UPLOADTOBLOB_INTERRUPTED_UPLOAD* interruptedUpload)
+{
+    HTTPAPIEX_HANDLE iotHubHttpApiExHandle = createIotHubHttpApiExHandle(handleData);
+    if (iotHubHttpApiExHandle == NULL)
+    {
+        LogError("unable to create the HTTPAPIEX_HANDLE to IoTHub, the interrupted upload is not reported");
+    }
+    else
+    {
+        BUFFER_HANDLE responseToIoTHub = BUFFER_new();
+        if (responseToIoTHub == NULL)
+        {
+            LogError("unable to BUFFER_new, the interrupted upload is not reported");
+        }
+        else
+        {
+            (void)notifyInterruptedUpload(handleData, interruptedUpload, iotHubHttpApiExHandle, BLOB_ERROR, 0, responseToIoTHub);
+            BUFFER_delete(responseToIoTHub);
+        }
+        HTTPAPIEX_Destroy(iotHubHttpApiExHandle);
+    }
+}
+
+/*forgets the kept interrupted upload, IoTHub is told it failed unless the application can still resume it from a resume token*/
+static void releaseInterruptedUpload(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData)
+{
+    UPLOADTOBLOB_INTERRUPTED_UPLOAD* interruptedUpload = handleData->interruptedUpload;
+    if (interruptedUpload != NULL)
+    {
+        handleData->interruptedUpload = NULL;
+        if (!interruptedUpload->resumeTokenTaken)
+        {
+            abandonInterruptedUpload(handleData, interruptedUpload);
+        }
+        destroyInterruptedUpload(interruptedUpload);
+    }
+}
+
+/*makes interruptedUpload the kept interrupted upload*/
+static void keepInterruptedUpload(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, UPLOADTOBLOB_INTERRUPTED_UPLOAD* interruptedUpload)
+{
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_030: [ Only the latest interrupted upload is kept; an interrupted upload kept before shall be reported to IoTHub as failed by performing step 3, unless a resume token was taken for it. ]*/
+    releaseInterruptedUpload(handleData);
+    handleData->interruptedUpload = interruptedUpload;
+}
+
+/*the kept upload is the one being resumed: it is superseded without reporting it, a resume token taken for it before stays usable*/
+static void forgetResumedUpload(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, UPLOADTOBLOB_INTERRUPTED_UPLOAD* resumedUpload)
+{
+    if ((handleData->interruptedUpload != NULL) &&
+        (strcmp(STRING_c_str(handleData->interruptedUpload->correlationId), STRING_c_str(resumedUpload->correlationId)) == 0))
+    {
+        resumedUpload->resumeTokenTaken = handleData->interruptedUpload->resumeTokenTaken;
+        destroyInterruptedUpload(handleData->interruptedUpload);
+        handleData->interruptedUpload = NULL;
+    }
+}
+
+static void initBlockCounter(UPLOADTOBLOB_BLOCK_COUNTER* blockCounter, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
+{
+    blockCounter->getDataCallbackEx = getDataCallbackEx;
+    blockCounter->context = context;
+    blockCounter->blockCount = 0;
+    blockCounter->bytesCount = 0;
+    blockCounter->lastBlockSize = 0;
+    blockCounter->endOfData = false;
+}
+
+/*forwards to the application's getDataCallbackEx and counts the blocks it returns, so that an interrupted upload knows where to resume*/
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT BlockCounter_GetData_Callback(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context)
+{
+    UPLOADTOBLOB_BLOCK_COUNTER* blockCounter = (UPLOADTOBLOB_BLOCK_COUNTER*)context;
+    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT getDataResult = blockCounter->getDataCallbackEx(result, data, size, blockCounter->context);
+    if ((getDataResult == IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK) && (data != NULL) && (size != NULL))
+    {
+        if ((*data == NULL) || (*size == 0))
+        {
+            blockCounter->endOfData = true;
+        }
+        else
+        {
+            blockCounter->blockCount++;
+            blockCounter->bytesCount += *size;
+            blockCounter->lastBlockSize = *size;
+        }
+    }
+    return getDataResult;
+}
+
+/*Azure Storage has stored every block returned before the interruption but the one it was sent, or all of them when the block list could not be committed*/
+static unsigned int getStoredBlockCount(const UPLOADTOBLOB_BLOCK_COUNTER* blockCounter, size_t* bytesStored)
+{
+    unsigned int result;
+    if (blockCounter->endOfData || (blockCounter->blockCount == 0))
+    {
+        result = blockCounter->blockCount;
+        *bytesStored = blockCounter->bytesCount;
+    }
+    else
+    {
+        result = blockCounter->blockCount - 1;
+        *bytesStored = blockCounter->bytesCount - blockCounter->lastBlockSize;
+    }
+    return result;
+}
+
+/*creates the kept upload out of a resume token, returns IOTHUB_CLIENT_INVALID_ARG when the token is not one IoTHubClient_LL_UploadToBlob_GetResumeToken produced*/
+static IOTHUB_CLIENT_RESULT parseResumeToken(const char* resumeToken, UPLOADTOBLOB_INTERRUPTED_UPLOAD** interruptedUpload)
+{
+    IOTHUB_CLIENT_RESULT result;
+    JSON_Value* tokenJson = json_parse_string(resumeToken);
+    if (tokenJson == NULL)
+    {
+        LogError("unable to json_parse_string the resume token");
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        JSON_Object* tokenObject = json_value_get_object(tokenJson);
+        if (tokenObject == NULL)
+        {
+            LogError("the resume token is not a JSON object");
+            result = IOTHUB_CLIENT_INVALID_ARG;
+        }
+        else
+        {
+            const char* correlationId = json_object_get_string(tokenObject, RESUME_TOKEN_CORRELATION_ID);
+            const char* sasUri = json_object_get_string(tokenObject, RESUME_TOKEN_SAS_URI);
+            double blockCount = json_object_get_number(tokenObject, RESUME_TOKEN_BLOCK_COUNT);
+            double bytesUploaded = json_object_get_number(tokenObject, RESUME_TOKEN_BYTES_UPLOADED);
+            if ((correlationId == NULL) || (sasUri == NULL) || (blockCount < 0) || (blockCount > MAX_BLOCK_COUNT) || (bytesUploaded < 0))
+            {
+                LogError("the resume token is malformed");
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else if ((*interruptedUpload = createInterruptedUpload(correlationId, sasUri, (unsigned int)blockCount, (size_t)bytesUploaded)) == NULL)
+            {
+                LogError("unable to create the interrupted upload");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        json_value_free(tokenJson);
+    }
+    return result;
+}
+
 IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, const char* destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -842,218 +1328,622 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(IOTHUB_CLIE
     {
         IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA*)handle;
 
-        /*Codes_SRS_IOTHUBCLIENT_LL_02_064: [ IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall create an HTTPAPIEX_HANDLE to the IoTHub hostname. ]*/
-        HTTPAPIEX_HANDLE iotHubHttpApiExHandle = HTTPAPIEX_Create(handleData->hostname);
-
-        /*Codes_SRS_IOTHUBCLIENT_LL_02_065: [ If creating the HTTPAPIEX_HANDLE fails then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+        HTTPAPIEX_HANDLE iotHubHttpApiExHandle = createIotHubHttpApiExHandle(handleData);
         if (iotHubHttpApiExHandle == NULL)
         {
-            LogError("unable to HTTPAPIEX_Create");
-            result = IOTHUB_CLIENT_ERROR;
-        }
-        /*Codes_SRS_IOTHUBCLIENT_LL_30_020: [ If the blob_upload_timeout_secs option has been set to non-zero, IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall set the timeout on the underlying transport accordingly. ]*/
-        else if (set_transfer_timeout(handleData, iotHubHttpApiExHandle) != HTTPAPIEX_OK)
-        {
-            LogError("unable to set blob transfer timeout");
+            LogError("unable to create the HTTPAPIEX_HANDLE to IoTHub");
             result = IOTHUB_CLIENT_ERROR;
-
         }
         else
         {
-            (void)HTTPAPIEX_SetOption(iotHubHttpApiExHandle, OPTION_CURL_VERBOSE, &handleData->curl_verbose);
-
-            if (
-                (handleData->authorizationScheme == X509) &&
-
-                /*transmit the x509certificate and x509privatekey*/
-                /*Codes_SRS_IOTHUBCLIENT_LL_02_106: [ - x509certificate and x509privatekey saved options shall be passed on the HTTPAPIEX_SetOption ]*/
-                (!(
-                    (HTTPAPIEX_SetOption(iotHubHttpApiExHandle, OPTION_X509_CERT, handleData->credentials.x509credentials.x509certificate) == HTTPAPIEX_OK) &&
-                    (HTTPAPIEX_SetOption(iotHubHttpApiExHandle, OPTION_X509_PRIVATE_KEY, handleData->credentials.x509credentials.x509privatekey) == HTTPAPIEX_OK)
-                ))
-                )
+            STRING_HANDLE correlationId = STRING_new();
+            if (correlationId == NULL)
             {
-                LogError("unable to HTTPAPIEX_SetOption for x509");
+                LogError("unable to STRING_new");
                 result = IOTHUB_CLIENT_ERROR;
             }
             else
             {
-                /*Codes_SRS_IOTHUBCLIENT_LL_02_111: [ If certificates is non-NULL then certificates shall be passed to HTTPAPIEX_SetOption with optionName TrustedCerts. ]*/
-                if ((handleData->certificates != NULL) && (HTTPAPIEX_SetOption(iotHubHttpApiExHandle, "TrustedCerts", handleData->certificates) != HTTPAPIEX_OK))
+                STRING_HANDLE sasUri = STRING_new();
+                if (sasUri == NULL)
                 {
-                    LogError("unable to set TrustedCerts!");
+                    LogError("unable to STRING_new");
                     result = IOTHUB_CLIENT_ERROR;
                 }
                 else
                 {
-
-                    if (handleData->http_proxy_options.host_address != NULL)
+                    /*Codes_SRS_IOTHUBCLIENT_LL_02_070: [ IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall create request HTTP headers. ]*/
+                    HTTP_HEADERS_HANDLE requestHttpHeaders = HTTPHeaders_Alloc(); /*these are build by step 1 and used by step 3 too*/
+                    if (requestHttpHeaders == NULL)
                     {
-                        HTTP_PROXY_OPTIONS proxy_options;
-                        proxy_options = handleData->http_proxy_options;
-
-                        if (HTTPAPIEX_SetOption(iotHubHttpApiExHandle, OPTION_HTTP_PROXY, &proxy_options) != HTTPAPIEX_OK)
-                        {
-                            LogError("unable to set http proxy!");
-                            result = IOTHUB_CLIENT_ERROR;
-                        }
-                        else
-                        {
-                            result = IOTHUB_CLIENT_OK;
-                        }
+                        LogError("unable to HTTPHeaders_Alloc");
+                        result = IOTHUB_CLIENT_ERROR;
                     }
                     else
                     {
-                        result = IOTHUB_CLIENT_OK;
-                    }
-
-                    if (result != IOTHUB_CLIENT_ERROR)
-                    {
-                        STRING_HANDLE correlationId = STRING_new();
-                        if (correlationId == NULL)
+                        /*do step 1*/
+                        if (IoTHubClient_LL_UploadToBlob_step1and2(handleData, iotHubHttpApiExHandle, requestHttpHeaders, destinationFileName, correlationId, sasUri) != 0)
                         {
-                            LogError("unable to STRING_new");
+                            LogError("error in IoTHubClient_LL_UploadToBlob_step1");
                             result = IOTHUB_CLIENT_ERROR;
                         }
                         else
                         {
-                            STRING_HANDLE sasUri = STRING_new();
-                            if (sasUri == NULL)
+                            /*do step 2.*/
+
+                            unsigned int httpResponse;
+                            BUFFER_HANDLE responseToIoTHub = BUFFER_new();
+                            if (responseToIoTHub == NULL)
                             {
-                                LogError("unable to STRING_new");
                                 result = IOTHUB_CLIENT_ERROR;
+                                LogError("unable to BUFFER_new");
                             }
                             else
                             {
-                                /*Codes_SRS_IOTHUBCLIENT_LL_02_070: [ IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall create request HTTP headers. ]*/
-                                HTTP_HEADERS_HANDLE requestHttpHeaders = HTTPHeaders_Alloc(); /*these are build by step 1 and used by step 3 too*/
-                                if (requestHttpHeaders == NULL)
+                                UPLOADTOBLOB_BLOCK_COUNTER blockCounter;
+                                BLOB_RESULT uploadMultipleBlocksResult;
+                                UPLOADTOBLOB_INTERRUPTED_UPLOAD* interruptedUpload;
+                                unsigned int blocksStored;
+                                size_t bytesStored;
+                                initBlockCounter(&blockCounter, getDataCallbackEx, context);
+
+                                /*Codes_SRS_IOTHUBCLIENT_LL_02_083: [ IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall call Blob_UploadFromSasUri and capture the HTTP return code and HTTP body. ]*/
+                                uploadMultipleBlocksResult = Blob_UploadMultipleBlocksFromSasUri(STRING_c_str(sasUri), BlockCounter_GetData_Callback, &blockCounter, &httpResponse, responseToIoTHub, handleData->certificates, &(handleData->http_proxy_options), handleData->blob_content_encoding);
+                                blocksStored = getStoredBlockCount(&blockCounter, &bytesStored);
+
+                                /*Codes_SRS_IOTHUBCLIENT_LL_09_029: [ If blob_upload_resumable is true and Blob_UploadMultipleBlocksFromSasUri returns BLOB_HTTP_ERROR then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall keep the correlationId, the SAS URI, the number of blocks Azure Storage stored and their size in bytes, skip step 3 and return IOTHUB_CLIENT_ERROR. ]*/
+                                if ((uploadMultipleBlocksResult == BLOB_HTTP_ERROR) &&
+                                    handleData->blob_upload_resumable &&
+                                    ((interruptedUpload = createInterruptedUpload(STRING_c_str(correlationId), STRING_c_str(sasUri), blocksStored, bytesStored)) != NULL))
                                 {
-                                    LogError("unable to HTTPHeaders_Alloc");
+                                    keepInterruptedUpload(handleData, interruptedUpload);
+                                    LogError("upload to storage was interrupted after %lu bytes, it can be resumed with IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl", (unsigned long)bytesStored);
                                     result = IOTHUB_CLIENT_ERROR;
                                 }
                                 else
                                 {
-                                    /*do step 1*/
-                                    if (IoTHubClient_LL_UploadToBlob_step1and2(handleData, iotHubHttpApiExHandle, requestHttpHeaders, destinationFileName, correlationId, sasUri) != 0)
-                                    {
-                                        LogError("error in IoTHubClient_LL_UploadToBlob_step1");
-                                        result = IOTHUB_CLIENT_ERROR;
-                                    }
-                                    else
-                                    {
-                                        /*do step 2.*/
+                                    /*do step 3*/
+                                    result = IoTHubClient_LL_UploadToBlob_notify(handleData, correlationId, iotHubHttpApiExHandle, requestHttpHeaders, uploadMultipleBlocksResult, httpResponse, responseToIoTHub);
+                                }
+                                BUFFER_delete(responseToIoTHub);
+                            }
+                        }
+                        HTTPHeaders_Free(requestHttpHeaders);
+                    }
+                    STRING_delete(sasUri);
+                }
+                STRING_delete(correlationId);
+            }
+            HTTPAPIEX_Destroy(iotHubHttpApiExHandle);
+        }
+    }
 
-                                        unsigned int httpResponse;
-                                        BUFFER_HANDLE responseToIoTHub = BUFFER_new();
-                                        if (responseToIoTHub == NULL)
-                                        {
-                                            result = IOTHUB_CLIENT_ERROR;
-                                            LogError("unable to BUFFER_new");
-                                        }
-                                        else
-                                        {
-                                            /*Codes_SRS_IOTHUBCLIENT_LL_02_083: [ IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall call Blob_UploadFromSasUri and capture the HTTP return code and HTTP body. ]*/
-                                            BLOB_RESULT uploadMultipleBlocksResult = Blob_UploadMultipleBlocksFromSasUri(STRING_c_str(sasUri), getDataCallbackEx, context, &httpResponse, responseToIoTHub, handleData->certificates, &(handleData->http_proxy_options));
-                                            if (uploadMultipleBlocksResult == BLOB_ABORTED)
-                                            {
-                                                /*Codes_SRS_IOTHUBCLIENT_LL_99_008: [ If step 2 is aborted by the client, then the HTTP message body shall look like:  ]*/
-                                                LogInfo("Blob_UploadFromSasUri aborted file upload");
+    /*Codes_SRS_IOTHUBCLIENT_LL_99_003: [ If `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` return `IOTHUB_CLIENT_OK`, it shall call `getDataCallbackEx` with `result` set to `FILE_UPLOAD_OK`, and `data` and `size` set to NULL. ]*/
+    /*Codes_SRS_IOTHUBCLIENT_LL_99_004: [ If `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` does not return `IOTHUB_CLIENT_OK`, it shall call `getDataCallbackEx` with `result` set to `FILE_UPLOAD_ERROR`, and `data` and `size` set to NULL. ]*/
+    (void)getDataCallbackEx(result == IOTHUB_CLIENT_OK ? FILE_UPLOAD_OK : FILE_UPLOAD_ERROR, NULL, NULL, context);
 
-                                                if (BUFFER_build(responseToIoTHub, (const unsigned char*)FILE_UPLOAD_ABORTED_BODY, sizeof(FILE_UPLOAD_ABORTED_BODY) / sizeof(FILE_UPLOAD_ABORTED_BODY[0])) == 0)
-                                                {
-                                                    if (IoTHubClient_LL_UploadToBlob_step3(handleData, correlationId, iotHubHttpApiExHandle, requestHttpHeaders, responseToIoTHub) != 0)
-                                                    {
-                                                        LogError("IoTHubClient_LL_UploadToBlob_step3 failed");
-                                                        result = IOTHUB_CLIENT_ERROR;
-                                                    }
-                                                    else
-                                                    {
-                                                        /*Codes_SRS_IOTHUBCLIENT_LL_99_009: [ If step 2 is aborted by the client and if step 3 succeeds, then `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` shall return `IOTHUB_CLIENT_OK`. ] */
-                                                        result = IOTHUB_CLIENT_OK;
-                                                    }
-                                                }
-                                                else
-                                                {
-                                                    LogError("Unable to BUFFER_build, can't perform IoTHubClient_LL_UploadToBlob_step3");
-                                                    result = IOTHUB_CLIENT_ERROR;
-                                                }
-                                            }
-                                            else if (uploadMultipleBlocksResult != BLOB_OK)
-                                            {
-                                                /*Codes_SRS_IOTHUBCLIENT_LL_02_084: [ If Blob_UploadFromSasUri fails then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall fail and return IOTHUB_CLIENT_ERROR. ]*/
-                                                LogError("unable to Blob_UploadFromSasUri");
+    return result;
+}
 
-                                                /*do step 3*/ /*try*/
-                                                /*Codes_SRS_IOTHUBCLIENT_LL_02_091: [ If step 2 fails without establishing an HTTP dialogue, then the HTTP message body shall look like: ]*/
-                                                if (BUFFER_build(responseToIoTHub, (const unsigned char*)FILE_UPLOAD_FAILED_BODY, sizeof(FILE_UPLOAD_FAILED_BODY) / sizeof(FILE_UPLOAD_FAILED_BODY[0])) == 0)
-                                                {
-                                                    if (IoTHubClient_LL_UploadToBlob_step3(handleData, correlationId, iotHubHttpApiExHandle, requestHttpHeaders, responseToIoTHub) != 0)
-                                                    {
-                                                        LogError("IoTHubClient_LL_UploadToBlob_step3 failed");
-                                                    }
-                                                }
-                                                result = IOTHUB_CLIENT_ERROR;
-                                            }
-                                            else
-                                            {
-                                                /*must make a json*/
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_GetResumeToken(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, char** resumeToken, size_t* bytesUploaded)
+{
+    IOTHUB_CLIENT_RESULT result;
 
-                                                int requiredStringLength = snprintf(NULL, 0, "{\"isSuccess\":%s, \"statusCode\":%d, \"statusDescription\":\"%s\"}", ((httpResponse < 300) ? "true" : "false"), httpResponse, BUFFER_u_char(responseToIoTHub));
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_058: [ If handle, resumeToken or bytesUploaded is NULL then IoTHubClient_LL_UploadToBlob_GetResumeToken shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (handle == NULL) ||
+        (resumeToken == NULL) ||
+        (bytesUploaded == NULL)
+        )
+    {
+        LogError("invalid argument detected handle=%p resumeToken=%p bytesUploaded=%p", handle, resumeToken, bytesUploaded);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA*)handle;
+        UPLOADTOBLOB_INTERRUPTED_UPLOAD* interruptedUpload = handleData->interruptedUpload;
+        if (interruptedUpload == NULL)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_059: [ If there is no interrupted upload then IoTHubClient_LL_UploadToBlob_GetResumeToken shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+            LogError("there is no interrupted upload");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_060: [ IoTHubClient_LL_UploadToBlob_GetResumeToken shall serialize to a JSON object the correlationId, the SAS URI, the number of blocks stored by Azure Storage and their size in bytes. ]*/
+            JSON_Value* tokenJson = json_value_init_object();
+            if (tokenJson == NULL)
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_09_062: [ If any operation fails then IoTHubClient_LL_UploadToBlob_GetResumeToken shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+                LogError("unable to json_value_init_object");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                JSON_Object* tokenObject = json_value_get_object(tokenJson);
+                char* serializedToken;
+                if (
+                    (tokenObject == NULL) ||
+                    (json_object_set_string(tokenObject, RESUME_TOKEN_CORRELATION_ID, STRING_c_str(interruptedUpload->correlationId)) != JSONSuccess) ||
+                    (json_object_set_string(tokenObject, RESUME_TOKEN_SAS_URI, STRING_c_str(interruptedUpload->sasUri)) != JSONSuccess) ||
+                    (json_object_set_number(tokenObject, RESUME_TOKEN_BLOCK_COUNT, (double)interruptedUpload->blockCount) != JSONSuccess) ||
+                    (json_object_set_number(tokenObject, RESUME_TOKEN_BYTES_UPLOADED, (double)interruptedUpload->bytesUploaded) != JSONSuccess)
+                    )
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_LL_09_062: [ If any operation fails then IoTHubClient_LL_UploadToBlob_GetResumeToken shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+                    LogError("unable to build the resume token");
+                    result = IOTHUB_CLIENT_ERROR;
+                }
+                else if ((serializedToken = json_serialize_to_string(tokenJson)) == NULL)
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_LL_09_062: [ If any operation fails then IoTHubClient_LL_UploadToBlob_GetResumeToken shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+                    LogError("unable to json_serialize_to_string");
+                    result = IOTHUB_CLIENT_ERROR;
+                }
+                else
+                {
+                    if (mallocAndStrcpy_s(resumeToken, serializedToken) != 0)
+                    {
+                        /*Codes_SRS_IOTHUBCLIENT_LL_09_062: [ If any operation fails then IoTHubClient_LL_UploadToBlob_GetResumeToken shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+                        LogError("unable to mallocAndStrcpy_s");
+                        result = IOTHUB_CLIENT_ERROR;
+                    }
+                    else
+                    {
+                        /*Codes_SRS_IOTHUBCLIENT_LL_09_061: [ IoTHubClient_LL_UploadToBlob_GetResumeToken shall return in resumeToken a copy of the serialized JSON that the caller frees, set bytesUploaded to the size of the stored blocks, remember that a resume token was taken and return IOTHUB_CLIENT_OK. ]*/
+                        *bytesUploaded = interruptedUpload->bytesUploaded;
+                        interruptedUpload->resumeTokenTaken = true;
+                        result = IOTHUB_CLIENT_OK;
+                    }
+                    json_free_serialized_string(serializedToken);
+                }
+                json_value_free(tokenJson);
+            }
+        }
+    }
+    return result;
+}
 
-                                                char * requiredString = malloc(requiredStringLength + 1);
-                                                if (requiredString == 0)
-                                                {
-                                                    LogError("unable to malloc");
-                                                    result = IOTHUB_CLIENT_ERROR;
-                                                }
-                                                else
-                                                {
-                                                    /*do again snprintf*/
-                                                    BUFFER_HANDLE toBeTransmitted = NULL;
-                                                    (void)snprintf(requiredString, requiredStringLength + 1, "{\"isSuccess\":%s, \"statusCode\":%d, \"statusDescription\":\"%s\"}", ((httpResponse < 300) ? "true" : "false"), httpResponse, BUFFER_u_char(responseToIoTHub));
-                                                    toBeTransmitted = BUFFER_create((const unsigned char*)requiredString, requiredStringLength);
-                                                    if (toBeTransmitted == NULL)
-                                                    {
-                                                        LogError("unable to BUFFER_create");
-                                                        result = IOTHUB_CLIENT_ERROR;
-                                                    }
-                                                    else
-                                                    {
-                                                        if (IoTHubClient_LL_UploadToBlob_step3(handleData, correlationId, iotHubHttpApiExHandle, requestHttpHeaders, toBeTransmitted) != 0)
-                                                        {
-                                                            LogError("IoTHubClient_LL_UploadToBlob_step3 failed");
-                                                            result = IOTHUB_CLIENT_ERROR;
-                                                        }
-                                                        else
-                                                        {
-                                                            result = (httpResponse < 300) ? IOTHUB_CLIENT_OK : IOTHUB_CLIENT_ERROR;
-                                                        }
-                                                        BUFFER_delete(toBeTransmitted);
-                                                    }
-                                                    free(requiredString);
-                                                }
-                                            }
-                                            BUFFER_delete(responseToIoTHub);
-                                        }
-                                    }
-                                    HTTPHeaders_Free(requestHttpHeaders);
-                                }
-                                STRING_delete(sasUri);
-                            }
-                            STRING_delete(correlationId);
-                        }
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, const char* resumeToken, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_031: [ If handle, resumeToken or getDataCallbackEx is NULL then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (handle == NULL) ||
+        (resumeToken == NULL) ||
+        (getDataCallbackEx == NULL)
+        )
+    {
+        LogError("invalid argument detected handle=%p resumeToken=%p getDataCallbackEx=%p", handle, resumeToken, getDataCallbackEx);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA*)handle;
+        UPLOADTOBLOB_INTERRUPTED_UPLOAD* interruptedUpload;
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_032: [ If resumeToken cannot be parsed into a correlationId, a SAS URI, a block count no bigger than MAX_BLOCK_COUNT and a size then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+        result = parseResumeToken(resumeToken, &interruptedUpload);
+        if (result != IOTHUB_CLIENT_OK)
+        {
+            LogError("unable to parse the resume token");
+        }
+        else
+        {
+            HTTPAPIEX_HANDLE iotHubHttpApiExHandle = createIotHubHttpApiExHandle(handleData);
+            if (iotHubHttpApiExHandle == NULL)
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_09_036: [ If any other operation fails then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall fail and return IOTHUB_CLIENT_ERROR; resumeToken stays valid. ]*/
+                LogError("unable to create the HTTPAPIEX_HANDLE to IoTHub");
+                destroyInterruptedUpload(interruptedUpload);
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                unsigned int httpResponse;
+                BUFFER_HANDLE responseToIoTHub = BUFFER_new();
+                if (responseToIoTHub == NULL)
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_LL_09_036: [ If any other operation fails then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall fail and return IOTHUB_CLIENT_ERROR; resumeToken stays valid. ]*/
+                    LogError("unable to BUFFER_new");
+                    destroyInterruptedUpload(interruptedUpload);
+                    result = IOTHUB_CLIENT_ERROR;
+                }
+                else
+                {
+                    UPLOADTOBLOB_BLOCK_COUNTER blockCounter;
+                    BLOB_RESULT uploadMultipleBlocksResult;
+                    initBlockCounter(&blockCounter, getDataCallbackEx, context);
+
+                    /*Codes_SRS_IOTHUBCLIENT_LL_09_033: [ IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall call Blob_ResumeMultipleBlocksFromSasUri with the SAS URI of resumeToken and its block count as firstBlockID, so that the first block getDataCallbackEx returns is the one that follows the bytes already uploaded. ]*/
+                    uploadMultipleBlocksResult = Blob_ResumeMultipleBlocksFromSasUri(STRING_c_str(interruptedUpload->sasUri), interruptedUpload->blockCount, BlockCounter_GetData_Callback, &blockCounter, &httpResponse, responseToIoTHub, handleData->certificates, &(handleData->http_proxy_options), handleData->blob_content_encoding);
+                    if (uploadMultipleBlocksResult == BLOB_HTTP_ERROR)
+                    {
+                        /*Codes_SRS_IOTHUBCLIENT_LL_09_034: [ If Blob_ResumeMultipleBlocksFromSasUri returns BLOB_HTTP_ERROR then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall add the blocks stored since resuming to the block count, keep the upload as the interrupted upload, superseding without reporting it a kept upload with the same correlationId, and return IOTHUB_CLIENT_ERROR. ]*/
+                        size_t bytesStored;
+                        interruptedUpload->blockCount += getStoredBlockCount(&blockCounter, &bytesStored);
+                        interruptedUpload->bytesUploaded += bytesStored;
+                        forgetResumedUpload(handleData, interruptedUpload);
+                        keepInterruptedUpload(handleData, interruptedUpload);
+                        LogError("upload to storage was interrupted again, %lu bytes are stored", (unsigned long)interruptedUpload->bytesUploaded);
+                        result = IOTHUB_CLIENT_ERROR;
+                    }
+                    else if (uploadMultipleBlocksResult == BLOB_INVALID_ARG)
+                    {
+                        /*Codes_SRS_IOTHUBCLIENT_LL_09_063: [ If Blob_ResumeMultipleBlocksFromSasUri returns BLOB_INVALID_ARG then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall return IOTHUB_CLIENT_INVALID_ARG; resumeToken stays valid. ]*/
+                        LogError("Blob_ResumeMultipleBlocksFromSasUri rejected the upload");
+                        destroyInterruptedUpload(interruptedUpload);
+                        result = IOTHUB_CLIENT_INVALID_ARG;
+                    }
+                    else
+                    {
+                        /*Codes_SRS_IOTHUBCLIENT_LL_09_035: [ Otherwise IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall perform step 3 as IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) does, using the correlationId of resumeToken and request HTTP headers built as step 1 builds them, and return the same result. ]*/
+                        result = notifyInterruptedUpload(handleData, interruptedUpload, iotHubHttpApiExHandle, uploadMultipleBlocksResult, httpResponse, responseToIoTHub);
+
+                        /*Codes_SRS_IOTHUBCLIENT_LL_09_064: [ If the kept interrupted upload has the correlationId of resumeToken then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall forget it without reporting it to IoTHub. ]*/
+                        forgetResumedUpload(handleData, interruptedUpload);
+                        destroyInterruptedUpload(interruptedUpload);
                     }
+                    BUFFER_delete(responseToIoTHub);
                 }
+                HTTPAPIEX_Destroy(iotHubHttpApiExHandle);
             }
-            HTTPAPIEX_Destroy(iotHubHttpApiExHandle);
         }
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_037: [ IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall then call getDataCallbackEx with FILE_UPLOAD_OK if it returns IOTHUB_CLIENT_OK and FILE_UPLOAD_ERROR otherwise, and data and size set to NULL. ]*/
+        (void)getDataCallbackEx(result == IOTHUB_CLIENT_OK ? FILE_UPLOAD_OK : FILE_UPLOAD_ERROR, NULL, NULL, context);
     }
+    return result;
+}
 
-    /*Codes_SRS_IOTHUBCLIENT_LL_99_003: [ If `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` return `IOTHUB_CLIENT_OK`, it shall call `getDataCallbackEx` with `result` set to `FILE_UPLOAD_OK`, and `data` and `size` set to NULL. ]*/
-    /*Codes_SRS_IOTHUBCLIENT_LL_99_004: [ If `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` does not return `IOTHUB_CLIENT_OK`, it shall call `getDataCallbackEx` with `result` set to `FILE_UPLOAD_ERROR`, and `data` and `size` set to NULL. ]*/
-    (void)getDataCallbackEx(result == IOTHUB_CLIENT_OK ? FILE_UPLOAD_OK : FILE_UPLOAD_ERROR, NULL, NULL, context);
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, const char* destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_014: [ If handle, destinationFileName or getDataCallbackEx is NULL then IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (handle == NULL) ||
+        (destinationFileName == NULL) ||
+        (getDataCallbackEx == NULL)
+        )
+    {
+        LogError("invalid argument detected handle=%p destinationFileName=%p getDataCallbackEx=%p", handle, destinationFileName, getDataCallbackEx);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA*)handle;
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_015: [ IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl shall save a copy of destinationFileName, getDataCallbackEx and context in a new pending upload and return IOTHUB_CLIENT_OK without performing any I/O. ]*/
+        UPLOADTOBLOB_ASYNC_CONTEXT* asyncContext = (UPLOADTOBLOB_ASYNC_CONTEXT*)malloc(sizeof(UPLOADTOBLOB_ASYNC_CONTEXT));
+        if (asyncContext == NULL)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_016: [ If any operation fails then IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+            LogError("oom - malloc");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else if (mallocAndStrcpy_s(&asyncContext->destinationFileName, destinationFileName) != 0)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_016: [ If any operation fails then IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+            LogError("unable to mallocAndStrcpy_s");
+            free(asyncContext);
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            UPLOADTOBLOB_ASYNC_CONTEXT** last = &handleData->pendingUploads;
+            while (*last != NULL)
+            {
+                last = &((*last)->next);
+            }
+
+            asyncContext->next = NULL;
+            asyncContext->state = UPLOADTOBLOB_ASYNC_STATE_START;
+            asyncContext->getDataCallbackEx = getDataCallbackEx;
+            asyncContext->context = context;
+            asyncContext->iotHubHttpApiExHandle = NULL;
+            asyncContext->requestHttpHeaders = NULL;
+            asyncContext->correlationId = NULL;
+            asyncContext->sasUri = NULL;
+            asyncContext->responseToIoTHub = NULL;
+            asyncContext->blobUploadHandle = NULL;
+            asyncContext->httpResponse = 0;
+            asyncContext->bytesUploaded = 0;
+            asyncContext->retrySource = NULL;
+            asyncContext->retrySize = 0;
+            asyncContext->retryCount = 0;
+            asyncContext->retryDelayInMs = 0;
+            asyncContext->retryStartTime = 0;
+            asyncContext->tickCounter = NULL;
+            *last = asyncContext;
+            result = IOTHUB_CLIENT_OK;
+        }
+    }
+    return result;
+}
+
+static void destroyAsyncUpload(UPLOADTOBLOB_ASYNC_CONTEXT* asyncContext)
+{
+    if (asyncContext->tickCounter != NULL)
+    {
+        tickcounter_destroy(asyncContext->tickCounter);
+    }
+    if (asyncContext->blobUploadHandle != NULL)
+    {
+        Blob_UploadDestroy(asyncContext->blobUploadHandle);
+    }
+    if (asyncContext->responseToIoTHub != NULL)
+    {
+        BUFFER_delete(asyncContext->responseToIoTHub);
+    }
+    if (asyncContext->requestHttpHeaders != NULL)
+    {
+        HTTPHeaders_Free(asyncContext->requestHttpHeaders);
+    }
+    if (asyncContext->sasUri != NULL)
+    {
+        STRING_delete(asyncContext->sasUri);
+    }
+    if (asyncContext->correlationId != NULL)
+    {
+        STRING_delete(asyncContext->correlationId);
+    }
+    if (asyncContext->iotHubHttpApiExHandle != NULL)
+    {
+        HTTPAPIEX_Destroy(asyncContext->iotHubHttpApiExHandle);
+    }
+    free(asyncContext->destinationFileName);
+    free(asyncContext);
+}
 
+/*performs steps 1 and 2 of the upload and gets storage ready for the first block, returns 0 on success*/
+static int startAsyncUpload(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, UPLOADTOBLOB_ASYNC_CONTEXT* asyncContext)
+{
+    int result;
+    if ((asyncContext->iotHubHttpApiExHandle = createIotHubHttpApiExHandle(handleData)) == NULL)
+    {
+        LogError("unable to create the HTTPAPIEX_HANDLE to IoTHub");
+        result = __FAILURE__;
+    }
+    else if (((asyncContext->correlationId = STRING_new()) == NULL) ||
+        ((asyncContext->sasUri = STRING_new()) == NULL))
+    {
+        LogError("unable to STRING_new");
+        result = __FAILURE__;
+    }
+    else if ((asyncContext->requestHttpHeaders = HTTPHeaders_Alloc()) == NULL)
+    {
+        LogError("unable to HTTPHeaders_Alloc");
+        result = __FAILURE__;
+    }
+    else if (IoTHubClient_LL_UploadToBlob_step1and2(handleData, asyncContext->iotHubHttpApiExHandle, asyncContext->requestHttpHeaders, asyncContext->destinationFileName, asyncContext->correlationId, asyncContext->sasUri) != 0)
+    {
+        LogError("error in IoTHubClient_LL_UploadToBlob_step1");
+        result = __FAILURE__;
+    }
+    else if ((asyncContext->responseToIoTHub = BUFFER_new()) == NULL)
+    {
+        LogError("unable to BUFFER_new");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+/*sends one block of a pending upload, returns non-zero when the upload is over*/
+static int uploadAsyncBlock(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, UPLOADTOBLOB_ASYNC_CONTEXT* asyncContext, const unsigned char* source, size_t size, BLOB_RESULT* blobResult)
+{
+    int isDone;
+    *blobResult = Blob_UploadNextBlock(asyncContext->blobUploadHandle, source, size, &asyncContext->httpResponse, asyncContext->responseToIoTHub);
+    if (*blobResult != BLOB_OK)
+    {
+        isDone = 1;
+    }
+    else if ((asyncContext->httpResponse >= 500) && (asyncContext->retryCount < BLOB_BLOCK_UPLOAD_MAX_RETRIES))
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_055: [ If storage answers a block with a server error (5xx), IoTHubClient_LL_UploadToBlob_DoWork shall keep the block and wait, without sleeping, BLOB_BLOCK_UPLOAD_RETRY_INITIAL_DELAY_MS milliseconds before the first retry and twice as long as the previous wait before each next one, but never longer than BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS milliseconds, at most BLOB_BLOCK_UPLOAD_MAX_RETRIES times per block. ]*/
+        if ((asyncContext->tickCounter == NULL) &&
+            ((asyncContext->tickCounter = tickcounter_create()) == NULL))
+        {
+            LogError("unable to tickcounter_create");
+            isDone = 1;
+        }
+        else if (tickcounter_get_current_ms(asyncContext->tickCounter, &asyncContext->retryStartTime) != 0)
+        {
+            LogError("unable to tickcounter_get_current_ms");
+            isDone = 1;
+        }
+        else
+        {
+            asyncContext->retryDelayInMs = (asyncContext->retryCount == 0) ? BLOB_BLOCK_UPLOAD_RETRY_INITIAL_DELAY_MS :
+                (asyncContext->retryDelayInMs > BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS / 2) ? BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS : asyncContext->retryDelayInMs * 2;
+            asyncContext->retryCount++;
+            asyncContext->retrySource = source;
+            asyncContext->retrySize = size;
+            asyncContext->state = UPLOADTOBLOB_ASYNC_STATE_RETRY_BLOCK;
+            LogInfo("HTTP status from storage is %u, uploading the block again in %u ms", asyncContext->httpResponse, (unsigned int)asyncContext->retryDelayInMs);
+            isDone = 0;
+        }
+    }
+    else if (asyncContext->httpResponse >= 300)
+    {
+        isDone = 1;
+    }
+    else
+    {
+        asyncContext->retryCount = 0;
+        asyncContext->retrySource = NULL;
+        asyncContext->retrySize = 0;
+        asyncContext->bytesUploaded += size;
+        if (handleData->progressCallback != NULL)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_053: [ After Azure Storage accepts a block IoTHubClient_LL_UploadToBlob_DoWork shall call the progress callback, if any, with the destinationFileName of the upload, the number of bytes of that upload stored so far and the progress callback context. ]*/
+            handleData->progressCallback(asyncContext->destinationFileName, asyncContext->bytesUploaded, handleData->progressCallbackContext);
+        }
+        isDone = 0;
+    }
+    return isDone;
+}
+
+/*advances one pending upload by one request to storage (and the notification to IoTHub when the upload ends), returns non-zero when the upload is over*/
+static int doWorkAsyncUpload(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, UPLOADTOBLOB_ASYNC_CONTEXT* asyncContext)
+{
+    int isDone;
+    IOTHUB_CLIENT_RESULT uploadResult = IOTHUB_CLIENT_OK;
+    BLOB_RESULT blobResult = BLOB_OK;
+
+    switch (asyncContext->state)
+    {
+        case UPLOADTOBLOB_ASYNC_STATE_START:
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_018: [ For a pending upload that has not started, IoTHubClient_LL_UploadToBlob_DoWork shall perform steps 1 and 2 as IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) does and call Blob_UploadCreate with the SAS URI. ]*/
+            if (startAsyncUpload(handleData, asyncContext) != 0)
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_09_019: [ If steps 1 and 2 fail then IoTHubClient_LL_UploadToBlob_DoWork shall end the upload with IOTHUB_CLIENT_ERROR without performing step 3. ]*/
+                uploadResult = IOTHUB_CLIENT_ERROR;
+                isDone = 1;
+            }
+            else if ((asyncContext->blobUploadHandle = Blob_UploadCreate(STRING_c_str(asyncContext->sasUri), handleData->certificates, &(handleData->http_proxy_options))) == NULL)
+            {
+                LogError("unable to Blob_UploadCreate");
+                blobResult = BLOB_ERROR;
+                isDone = 1;
+            }
+            else
+            {
+                asyncContext->state = UPLOADTOBLOB_ASYNC_STATE_UPLOAD_BLOCKS;
+                isDone = 0;
+            }
+            break;
+        }
+        case UPLOADTOBLOB_ASYNC_STATE_UPLOAD_BLOCKS:
+        {
+            unsigned char const * source;
+            size_t size;
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_020: [ Otherwise IoTHubClient_LL_UploadToBlob_DoWork shall call getDataCallbackEx with FILE_UPLOAD_OK once and upload the returned block with Blob_UploadNextBlock. ]*/
+            if (asyncContext->getDataCallbackEx(FILE_UPLOAD_OK, &source, &size, asyncContext->context) == IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT)
+            {
+                LogInfo("Upload to blob has been aborted by the user");
+                blobResult = BLOB_ABORTED;
+                isDone = 1;
+            }
+            else if (source == NULL || size == 0)
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_09_021: [ When getDataCallbackEx returns no data the next call to IoTHubClient_LL_UploadToBlob_DoWork shall commit the blob with Blob_UploadCommit. ]*/
+                asyncContext->state = UPLOADTOBLOB_ASYNC_STATE_COMMIT;
+                isDone = 0;
+            }
+            else
+            {
+                isDone = uploadAsyncBlock(handleData, asyncContext, source, size, &blobResult);
+            }
+            break;
+        }
+        case UPLOADTOBLOB_ASYNC_STATE_RETRY_BLOCK:
+        {
+            tickcounter_ms_t now;
+            if (tickcounter_get_current_ms(asyncContext->tickCounter, &now) != 0)
+            {
+                LogError("unable to tickcounter_get_current_ms");
+                blobResult = BLOB_ERROR;
+                isDone = 1;
+            }
+            else if (now - asyncContext->retryStartTime < asyncContext->retryDelayInMs)
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_09_056: [ Until the wait is over IoTHubClient_LL_UploadToBlob_DoWork shall not send any request for that upload. ]*/
+                isDone = 0;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_09_057: [ Once the wait is over IoTHubClient_LL_UploadToBlob_DoWork shall send the same block again with Blob_UploadNextBlock, without calling getDataCallbackEx. ]*/
+                asyncContext->state = UPLOADTOBLOB_ASYNC_STATE_UPLOAD_BLOCKS;
+                isDone = uploadAsyncBlock(handleData, asyncContext, asyncContext->retrySource, asyncContext->retrySize, &blobResult);
+            }
+            break;
+        }
+        case UPLOADTOBLOB_ASYNC_STATE_COMMIT:
+        {
+            blobResult = Blob_UploadCommit(asyncContext->blobUploadHandle, handleData->blob_content_encoding, &asyncContext->httpResponse, asyncContext->responseToIoTHub);
+            isDone = 1;
+            break;
+        }
+        default:
+        {
+            LogError("INTERNAL ERROR: unexpected state %s", ENUM_TO_STRING(UPLOADTOBLOB_ASYNC_STATE, asyncContext->state));
+            uploadResult = IOTHUB_CLIENT_ERROR;
+            isDone = 1;
+            break;
+        }
+    }
+
+    if (isDone)
+    {
+        if (uploadResult == IOTHUB_CLIENT_OK)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_022: [ When step 2 is over IoTHubClient_LL_UploadToBlob_DoWork shall perform step 3 as IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) does. ]*/
+            uploadResult = IoTHubClient_LL_UploadToBlob_notify(handleData, asyncContext->correlationId, asyncContext->iotHubHttpApiExHandle, asyncContext->requestHttpHeaders, blobResult, asyncContext->httpResponse, asyncContext->responseToIoTHub);
+        }
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_023: [ When the upload is over IoTHubClient_LL_UploadToBlob_DoWork shall call getDataCallbackEx with FILE_UPLOAD_OK or FILE_UPLOAD_ERROR, and data and size set to NULL, and then free the pending upload. ]*/
+        (void)asyncContext->getDataCallbackEx(uploadResult == IOTHUB_CLIENT_OK ? FILE_UPLOAD_OK : FILE_UPLOAD_ERROR, NULL, NULL, asyncContext->context);
+    }
+    return isDone;
+}
+
+void IoTHubClient_LL_UploadToBlob_DoWork(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle)
+{
+    if (handle == NULL)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_017: [ If handle is NULL then IoTHubClient_LL_UploadToBlob_DoWork shall return. ]*/
+        LogError("unexpected NULL argument");
+    }
+    else
+    {
+        IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA*)handle;
+        UPLOADTOBLOB_ASYNC_CONTEXT* asyncContext = handleData->pendingUploads;
+        if (asyncContext != NULL)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_054: [ IoTHubClient_LL_UploadToBlob_DoWork shall advance only the first pending upload and then move it to the end of the pending uploads, so that each call performs at most one request to Azure Storage and the pending uploads take turns. ]*/
+            handleData->pendingUploads = asyncContext->next;
+            if (doWorkAsyncUpload(handleData, asyncContext) != 0)
+            {
+                destroyAsyncUpload(asyncContext);
+            }
+            else
+            {
+                UPLOADTOBLOB_ASYNC_CONTEXT** last = &handleData->pendingUploads;
+                while (*last != NULL)
+                {
+                    last = &((*last)->next);
+                }
+                asyncContext->next = NULL;
+                *last = asyncContext;
+            }
+        }
+    }
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_SetProgressCallback(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, IOTHUB_CLIENT_FILE_UPLOAD_PROGRESS_CALLBACK progressCallback, void* context)
+{
+    IOTHUB_CLIENT_RESULT result;
+    if (handle == NULL)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_051: [ If handle is NULL then IoTHubClient_LL_UploadToBlob_SetProgressCallback shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+        LogError("invalid argument detected handle=%p", handle);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA*)handle;
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_052: [ Otherwise IoTHubClient_LL_UploadToBlob_SetProgressCallback shall save progressCallback and context, replacing any previous ones, and return IOTHUB_CLIENT_OK. A NULL progressCallback stops the notifications. ]*/
+        handleData->progressCallback = progressCallback;
+        handleData->progressCallbackContext = context;
+        result = IOTHUB_CLIENT_OK;
+    }
     return result;
 }
 
@@ -1067,13 +1957,21 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_Impl(IOTHUB_CLIENT_LL_UPLOADTO
         LogError("invalid source and size combination: source=%p size=%zu", source, size);
         result = IOTHUB_CLIENT_INVALID_ARG;
     }
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_012: [ If size is bigger than MAX_BLOCK_COUNT * BLOCK_SIZE then IoTHubClient_LL_UploadToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG without contacting IoT Hub. ]*/
+    else if ((uint64_t)size > (uint64_t)MAX_BLOCK_COUNT * BLOCK_SIZE)
+    {
+        LogError("source of size %zu cannot be split in at most %d blocks of %d bytes", size, MAX_BLOCK_COUNT, BLOCK_SIZE);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
     else
     {
         /*Codes_SRS_IOTHUBCLIENT_LL_99_001: [ `IoTHubClient_LL_UploadToBlob` shall create a struct containing the `source`, the `size`, and the remaining size to upload.]*/
         BLOB_UPLOAD_CONTEXT context;
         context.blobSource = source;
+        context.fileMapping = NULL;
         context.blobSourceSize = size;
         context.remainingSizeToUpload = size;
+        context.blockSize = BLOCK_SIZE;
 
         /*Codes_SRS_IOTHUBCLIENT_LL_99_002: [ `IoTHubClient_LL_UploadToBlob` shall call `IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl` with `FileUpload_GetData_Callback` as `getDataCallbackEx` and pass the struct created at step SRS_IOTHUBCLIENT_LL_99_001 as `context` ]*/
         result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(handle, destinationFileName, FileUpload_GetData_Callback, &context);
@@ -1081,6 +1979,68 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_Impl(IOTHUB_CLIENT_LL_UPLOADTO
     return result;
 }
 
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadFileToBlob_Impl(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, const char* destinationFileName, const char* localFilePath)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_041: [ If handle, destinationFileName or localFilePath is NULL then IoTHubClient_LL_UploadFileToBlob_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (handle == NULL) ||
+        (destinationFileName == NULL) ||
+        (localFilePath == NULL)
+        )
+    {
+        LogError("invalid argument detected handle=%p destinationFileName=%p localFilePath=%p", handle, destinationFileName, localFilePath);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        size_t size;
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_042: [ IoTHubClient_LL_UploadFileToBlob_Impl shall open the file with Blob_MapFile. ]*/
+        BLOB_FILE_MAPPING_HANDLE fileMapping = Blob_MapFile(localFilePath, &size);
+        if (fileMapping == NULL)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_043: [ If Blob_MapFile fails then IoTHubClient_LL_UploadFileToBlob_Impl shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+            LogError("unable to map %s", localFilePath);
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_044: [ If the file is bigger than MAX_BLOCK_COUNT * BLOCK_SIZE then IoTHubClient_LL_UploadFileToBlob_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG without contacting IoT Hub. ]*/
+            if ((uint64_t)size > (uint64_t)MAX_BLOCK_COUNT * BLOCK_SIZE)
+            {
+                LogError("file of size %zu cannot be split in at most %d blocks of %d bytes", size, MAX_BLOCK_COUNT, BLOCK_SIZE);
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_09_045: [ IoTHubClient_LL_UploadFileToBlob_Impl shall upload the file as IoTHubClient_LL_UploadToBlob does, reading each block with Blob_ReadFileBlock, in blocks of the smallest size that needs at most MAX_BLOCK_COUNT blocks, but not smaller than 1 MiB nor bigger than BLOCK_SIZE. ]*/
+                /*only one block of the file is held in memory at a time; Blob_UploadMultipleBlocksFromSasUri still copies it into the request*/
+                size_t blockSize = (size / MAX_BLOCK_COUNT) + ((size % MAX_BLOCK_COUNT) != 0);
+                BLOB_UPLOAD_CONTEXT context;
+                if (blockSize < FILE_UPLOAD_MIN_BLOCK_SIZE)
+                {
+                    blockSize = FILE_UPLOAD_MIN_BLOCK_SIZE;
+                }
+                else if (blockSize > BLOCK_SIZE)
+                {
+                    blockSize = BLOCK_SIZE;
+                }
+                context.blobSource = NULL;
+                context.fileMapping = fileMapping;
+                context.blobSourceSize = size;
+                context.remainingSizeToUpload = size;
+                context.blockSize = blockSize;
+
+                result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(handle, destinationFileName, FileUpload_GetData_Callback, &context);
+            }
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_046: [ IoTHubClient_LL_UploadFileToBlob_Impl shall close the file with Blob_UnmapFile before returning. ]*/
+            Blob_UnmapFile(fileMapping);
+        }
+    }
+    return result;
+}
+
 void IoTHubClient_LL_UploadToBlob_Destroy(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle)
 {
     if (handle == NULL)
@@ -1090,6 +2050,22 @@ void IoTHubClient_LL_UploadToBlob_Destroy(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h
     else
     {
         IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA*)handle;
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_024: [ IoTHubClient_LL_UploadToBlob_Destroy shall call getDataCallbackEx with FILE_UPLOAD_ERROR, and data and size set to NULL, for every pending upload and free it. ]*/
+        while (handleData->pendingUploads != NULL)
+        {
+            UPLOADTOBLOB_ASYNC_CONTEXT* asyncContext = handleData->pendingUploads;
+            handleData->pendingUploads = asyncContext->next;
+            (void)asyncContext->getDataCallbackEx(FILE_UPLOAD_ERROR, NULL, NULL, asyncContext->context);
+            destroyAsyncUpload(asyncContext);
+        }
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_038: [ IoTHubClient_LL_UploadToBlob_Destroy shall free a kept interrupted upload, reporting it to IoTHub as failed by performing step 3 unless a resume token was taken for it. ]*/
+        if (handleData->interruptedUpload != NULL)
+        {
+            releaseInterruptedUpload(handleData);
+        }
+
         switch (handleData->authorizationScheme)
         {
             case(SAS_TOKEN):
@@ -1138,6 +2114,10 @@ void IoTHubClient_LL_UploadToBlob_Destroy(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h
         {
             free((char *)handleData->http_proxy_options.password);
         }
+        if (handleData->blob_content_encoding != NULL)
+        {
+            free(handleData->blob_content_encoding);
+        }
         free(handleData);
     }
 }
@@ -1314,6 +2294,37 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_SetOption(IOTHUB_CLIENT_LL_UPL
             handleData->blob_upload_timeout_secs = *(size_t*)value;
             result = IOTHUB_CLIENT_OK;
         }
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_013: [ blob_upload_content_encoding - value is a null terminated string that is saved and passed as contentEncoding to Blob_UploadMultipleBlocksFromSasUri. Only "identity" is accepted. An empty string clears the saved value. ]*/
+        else if (strcmp(optionName, OPTION_BLOB_UPLOAD_CONTENT_ENCODING) == 0)
+        {
+            char* tempCopy = NULL;
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_067: [ If the value of blob_upload_content_encoding is neither an empty string nor "identity" then IoTHubClient_LL_UploadToBlob_SetOption shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+            if ((*(const char*)value != '\0') && (strcmp((const char*)value, "identity") != 0))
+            {
+                LogError("content encoding \"%s\" is not supported: the SDK uploads the data unchanged", (const char*)value);
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else if ((*(const char*)value != '\0') && (mallocAndStrcpy_s(&tempCopy, value) != 0))
+            {
+                LogError("failure in mallocAndStrcpy_s");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                if (handleData->blob_content_encoding != NULL)
+                {
+                    free(handleData->blob_content_encoding);
+                }
+                handleData->blob_content_encoding = tempCopy;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_028: [ blob_upload_resumable - value is a pointer to a bool. When true, an upload interrupted by an HTTP error in step 2 is kept for IoTHubClient_LL_UploadToBlob_GetResumeToken instead of being reported to IoTHub. ]*/
+        else if (strcmp(optionName, OPTION_BLOB_UPLOAD_RESUMABLE) == 0)
+        {
+            handleData->blob_upload_resumable = *(const bool*)value;
+            result = IOTHUB_CLIENT_OK;
+        }
         else
         {
             /*Codes_SRS_IOTHUBCLIENT_LL_02_102: [ If an unknown option is presented then IoTHubClient_LL_UploadToBlob_SetOption shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
@@ -16,11 +16,13 @@
 #define DEFAULT_CBS_REQUEST_TIMEOUT_SECS          UINT32_MAX
 #define DEFAULT_SAS_TOKEN_LIFETIME_SECS           3600
 #define DEFAULT_SAS_TOKEN_REFRESH_TIME_SECS       1800
+#define DEFAULT_SAS_TOKEN_REFRESH_JITTER_SECS     300
 
 typedef struct AUTHENTICATION_INSTANCE_TAG 
 {
     const char* device_id;
     STRING_HANDLE iothub_host_fqdn;
+    STRING_HANDLE devices_path;
     
     ON_AUTHENTICATION_STATE_CHANGED_CALLBACK on_state_changed_callback;
     void* on_state_changed_callback_context;
@@ -31,6 +33,11 @@ typedef struct AUTHENTICATION_INSTANCE_TAG
     size_t cbs_request_timeout_secs;
     size_t sas_token_lifetime_secs;
     size_t sas_token_refresh_time_secs;
+    size_t sas_token_refresh_jitter_secs;
+
+    // Amount (up to `sas_token_refresh_jitter_secs`) subtracted from the refresh time of the current token, derived from
+    // the device id and the put time, so devices sharing a connection do not all refresh their SAS tokens on the same DoWork pass.
+    size_t current_sas_token_refresh_jitter_secs;
 
     AUTHENTICATION_STATE state;
     CBS_HANDLE cbs_handle;
@@ -122,7 +129,9 @@ static int verify_sas_token_refresh_timeout(AUTHENTICATION_INSTANCE* instance, b
             result = __FAILURE__;
             LogError("Failed verifying if SAS token refresh timed out (get_time failed)");
         }
-        else if ((uint32_t)get_difftime(current_time, instance->current_sas_token_put_time) >= instance->sas_token_refresh_time_secs)
+        // The jitter is added to the elapsed time instead of subtracted from the refresh time, so a refresh time
+        // reduced by authentication_set_option() below the jitter already drawn cannot wrap around.
+        else if ((size_t)get_difftime(current_time, instance->current_sas_token_put_time) + instance->current_sas_token_refresh_jitter_secs >= instance->sas_token_refresh_time_secs)
         {
             *is_timed_out = true;
             result = RESULT_OK;
@@ -147,6 +156,49 @@ static STRING_HANDLE create_devices_path(STRING_HANDLE iothub_host_fqdn, const c
     return devices_path;
 }
 
+// rand() is not used: it is never seeded by the SDK, so every process would draw the same sequence and
+// devices started together would still refresh in lockstep. Hashing the device id with the put time gives each
+// device its own value, which also changes from one refresh to the next.
+static size_t get_sas_token_refresh_jitter(AUTHENTICATION_INSTANCE* instance, time_t put_time)
+{
+    size_t result;
+
+    if (instance->sas_token_refresh_jitter_secs == 0 || instance->sas_token_refresh_time_secs == 0)
+    {
+        result = 0;
+    }
+    else
+    {
+        // The jitter can never push the refresh to (or before) the moment the token was put.
+        size_t max_jitter_secs = instance->sas_token_refresh_jitter_secs;
+        const char* device_id = instance->device_id;
+        uint32_t hash = 2166136261u; // FNV-1a
+
+        if (max_jitter_secs >= instance->sas_token_refresh_time_secs)
+        {
+            max_jitter_secs = instance->sas_token_refresh_time_secs - 1;
+        }
+
+        while (*device_id != '\0')
+        {
+            hash = (hash ^ (uint8_t)*device_id++) * 16777619u;
+        }
+
+        hash = (hash ^ (uint32_t)put_time) * 16777619u;
+
+        // Final avalanche (MurmurHash3 fmix32), so put times one second apart give unrelated values.
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6bu;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35u;
+        hash ^= hash >> 16;
+
+        result = (size_t)(hash % ((uint32_t)max_jitter_secs + 1));
+    }
+
+    return result;
+}
+
 static void on_cbs_put_token_complete_callback(void* context, CBS_OPERATION_RESULT operation_result, unsigned int status_code, const char* status_description)
 {
 #ifdef NO_LOGGING
@@ -220,6 +272,8 @@ static int put_SAS_token_to_cbs(AUTHENTICATION_INSTANCE* instance, STRING_HANDLE
         }
 
         instance->current_sas_token_put_time = current_time; // If it failed, fear not. `current_sas_token_put_time` shall be checked for INDEFINITE_TIME wherever it is used.
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_129: [If cbs_put_token_async() succeeds, authentication_do_work() shall set `instance->current_sas_token_refresh_jitter_secs` with a value from 0 to `instance->sas_token_refresh_jitter_secs`, limited to `instance->sas_token_refresh_time_secs` minus 1, derived from a hash of `instance->device_id` and `instance->current_sas_token_put_time`]
+        instance->current_sas_token_refresh_jitter_secs = get_sas_token_refresh_jitter(instance, current_time);
 
         result = RESULT_OK;
     }
@@ -231,97 +285,83 @@ static int create_and_put_SAS_token_to_cbs(AUTHENTICATION_INSTANCE* instance)
 {
     int result;
     char* sas_token;
-    STRING_HANDLE devices_path;
 
-    // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_053: [A STRING_HANDLE, referred to as `devices_path`, shall be created from the following parts: iothub_host_fqdn + "/devices/" + device_id]
-    // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_071: [A STRING_HANDLE, referred to as `devices_path`, shall be created from the following parts: iothub_host_fqdn + "/devices/" + device_id]
-    if ((devices_path = create_devices_path(instance->iothub_host_fqdn, instance->device_id)) == NULL)
-    {
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_054: [If `devices_path` failed to be created, authentication_do_work() shall fail and return]
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_072: [If `devices_path` failed to be created, authentication_do_work() shall fail and return]
-        result = __FAILURE__;
-        sas_token = NULL;
-        LogError("Failed creating a SAS token (create_devices_path() failed)");
-    }
-    else
+    // The `devices_path` (iothub_host_fqdn + "/devices/" + device_id) is built once in authentication_create(),
+    // so token refreshes of many devices multiplexed on one connection do not re-format it every time.
+
+    /* Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_07_001: [ authentication_do_work() shall determine what credential type is used SAS_TOKEN or DEVICE_KEY by calling IoTHubClient_Auth_Get_Credential_Type ] */
+    IOTHUB_CREDENTIAL_TYPE cred_type = IoTHubClient_Auth_Get_Credential_Type(instance->authorization_module);
+    if (cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY || cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_AUTH)
     {
-        /* Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_07_001: [ authentication_do_work() shall determine what credential type is used SAS_TOKEN or DEVICE_KEY by calling IoTHubClient_Auth_Get_Credential_Type ] */
-        IOTHUB_CREDENTIAL_TYPE cred_type = IoTHubClient_Auth_Get_Credential_Type(instance->authorization_module);
-        if (cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY || cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_AUTH)
+        /* Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_049: [authentication_do_work() shall create a SAS token using IoTHubClient_Auth_Get_SasToken, unless it has failed previously] */
+        sas_token = IoTHubClient_Auth_Get_SasToken(instance->authorization_module, STRING_c_str(instance->devices_path), instance->sas_token_lifetime_secs);
+        if (sas_token == NULL)
         {
-            /* Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_049: [authentication_do_work() shall create a SAS token using IoTHubClient_Auth_Get_SasToken, unless it has failed previously] */
-            sas_token = IoTHubClient_Auth_Get_SasToken(instance->authorization_module, STRING_c_str(devices_path), instance->sas_token_lifetime_secs);
-            if (sas_token == NULL)
-            {
-                LogError("failure getting sas token.");
-                result = __FAILURE__;
-            }
-            else
-            {
-                result = RESULT_OK;
-            }
+            LogError("failure getting sas token.");
+            result = __FAILURE__;
         }
-        else if (cred_type == IOTHUB_CREDENTIAL_TYPE_SAS_TOKEN)
+        else
         {
-            /* Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_07_002: [ If credential Type is SAS_TOKEN authentication_do_work() shall validate the sas_token, and fail if it's not valid. ] */
-            SAS_TOKEN_STATUS token_status = IoTHubClient_Auth_Is_SasToken_Valid(instance->authorization_module);
-            if (token_status == SAS_TOKEN_STATUS_INVALID)
-            {
-                LogError("sas token is invalid.");
-                sas_token = NULL;
-                result = __FAILURE__;
-            }
-            else if (token_status == SAS_TOKEN_STATUS_FAILED)
-            {
-                LogError("testing Sas Token failed.");
-                sas_token = NULL;
-                result = __FAILURE__;
-            }
-            else
-            {
-                /* Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_049: [authentication_do_work() shall create a SAS token using IoTHubClient_Auth_Get_SasToken, unless it has failed previously] */
-                sas_token = IoTHubClient_Auth_Get_SasToken(instance->authorization_module, NULL, 0);
-                if (sas_token == NULL)
-                {
-                    LogError("failure getting sas Token.");
-                    result = __FAILURE__;
-                }
-                else
-                {
-                    result = RESULT_OK;
-                }
-            }
+            result = RESULT_OK;
         }
-        else if (cred_type == IOTHUB_CREDENTIAL_TYPE_X509 || cred_type == IOTHUB_CREDENTIAL_TYPE_X509_ECC)
+    }
+    else if (cred_type == IOTHUB_CREDENTIAL_TYPE_SAS_TOKEN)
+    {
+        /* Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_07_002: [ If credential Type is SAS_TOKEN authentication_do_work() shall validate the sas_token, and fail if it's not valid. ] */
+        SAS_TOKEN_STATUS token_status = IoTHubClient_Auth_Is_SasToken_Valid(instance->authorization_module);
+        if (token_status == SAS_TOKEN_STATUS_INVALID)
         {
+            LogError("sas token is invalid.");
             sas_token = NULL;
-            result = RESULT_OK;
+            result = __FAILURE__;
         }
-        else
+        else if (token_status == SAS_TOKEN_STATUS_FAILED)
         {
-            LogError("failure unknown credential type found.");
+            LogError("testing Sas Token failed.");
             sas_token = NULL;
             result = __FAILURE__;
         }
-
-
-        if (sas_token != NULL)
+        else
         {
-            if (put_SAS_token_to_cbs(instance, devices_path, sas_token) != RESULT_OK)
+            /* Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_049: [authentication_do_work() shall create a SAS token using IoTHubClient_Auth_Get_SasToken, unless it has failed previously] */
+            sas_token = IoTHubClient_Auth_Get_SasToken(instance->authorization_module, NULL, 0);
+            if (sas_token == NULL)
             {
+                LogError("failure getting sas Token.");
                 result = __FAILURE__;
-                LogError("Failed putting SAS token to CBS");
             }
             else
             {
                 result = RESULT_OK;
             }
-            free(sas_token);
         }
+    }
+    else if (cred_type == IOTHUB_CREDENTIAL_TYPE_X509 || cred_type == IOTHUB_CREDENTIAL_TYPE_X509_ECC)
+    {
+        sas_token = NULL;
+        result = RESULT_OK;
+    }
+    else
+    {
+        LogError("failure unknown credential type found.");
+        sas_token = NULL;
+        result = __FAILURE__;
+    }
 
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_081: [authentication_do_work() shall free the memory it allocated for `devices_path`, `sasTokenKeyName` and SAS token]
-        STRING_delete(devices_path);
+    if (sas_token != NULL)
+    {
+        if (put_SAS_token_to_cbs(instance, instance->devices_path, sas_token) != RESULT_OK)
+        {
+            result = __FAILURE__;
+            LogError("Failed putting SAS token to CBS");
+        }
+        else
+        {
+            result = RESULT_OK;
+        }
+        free(sas_token);
     }
+
     return result;
 }
 
@@ -345,6 +385,7 @@ static void* authentication_clone_option(const char* name, const void* value)
         if (strcmp(AUTHENTICATION_OPTION_CBS_REQUEST_TIMEOUT_SECS, name) == 0 ||
             strcmp(AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_TIME_SECS, name) == 0 ||
             strcmp(AUTHENTICATION_OPTION_SAS_TOKEN_LIFETIME_SECS, name) == 0 ||
+            strcmp(AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, name) == 0 ||
             strcmp(AUTHENTICATION_OPTION_SAVED_OPTIONS, name) == 0)
         {
             result = (void*)value;
@@ -474,6 +515,9 @@ void authentication_destroy(AUTHENTICATION_HANDLE authentication_handle)
             (void)authentication_stop(authentication_handle);
         }
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_108: [authentication_destroy() shall destroy all resouces used by this module]
+        if (instance->devices_path != NULL)
+            STRING_delete(instance->devices_path);
+
         if (instance->iothub_host_fqdn != NULL)
             STRING_delete(instance->iothub_host_fqdn);
 
@@ -539,6 +583,13 @@ AUTHENTICATION_HANDLE authentication_create(const AUTHENTICATION_CONFIG* config)
                 result = NULL;
                 LogError("authentication_create failed (config->iothub_host_fqdn could not be copied; STRING_construct failed)");
             }
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_053: [A STRING_HANDLE, referred to as `devices_path`, shall be created from the following parts: iothub_host_fqdn + "/devices/" + device_id]
+            else if ((instance->devices_path = create_devices_path(instance->iothub_host_fqdn, instance->device_id)) == NULL)
+            {
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_054: [If `devices_path` failed to be created, authentication_create() shall fail and return NULL]
+                result = NULL;
+                LogError("authentication_create failed (could not create the devices path for '%s')", instance->device_id);
+            }
             else
             {
                 instance->state = AUTHENTICATION_STATE_STOPPED;
@@ -557,6 +608,8 @@ AUTHENTICATION_HANDLE authentication_create(const AUTHENTICATION_CONFIG* config)
                 instance->sas_token_lifetime_secs = DEFAULT_SAS_TOKEN_LIFETIME_SECS;
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_023: [authentication_create() shall set `instance->sas_token_refresh_time_secs` with the default value of 30 minutes]
                 instance->sas_token_refresh_time_secs = DEFAULT_SAS_TOKEN_REFRESH_TIME_SECS;
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_130: [authentication_create() shall set `instance->sas_token_refresh_jitter_secs` with the default value of 5 minutes]
+                instance->sas_token_refresh_jitter_secs = DEFAULT_SAS_TOKEN_REFRESH_JITTER_SECS;
 
                 instance->authorization_module = config->authorization_module;
 
@@ -621,7 +674,7 @@ void authentication_do_work(AUTHENTICATION_HANDLE authentication_handle)
             if (IoTHubClient_Auth_Get_Credential_Type(instance->authorization_module) == IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY)
             {
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_039: [If `instance->state` is AUTHENTICATION_STATE_STARTED and device keys were used, authentication_do_work() shall only verify the SAS token refresh time]
-                // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_065: [The SAS token shall be refreshed if the current time minus `instance->current_sas_token_put_time` equals or exceeds `instance->sas_token_refresh_time_secs`]
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_065: [The SAS token shall be refreshed if the current time minus `instance->current_sas_token_put_time` equals or exceeds `instance->sas_token_refresh_time_secs` minus `instance->current_sas_token_refresh_jitter_secs`]
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_066: [If SAS token does not need to be refreshed, authentication_do_work() shall return]
                 bool is_timed_out;
                 if (verify_sas_token_refresh_timeout(instance, &is_timed_out) == RESULT_OK && is_timed_out)
@@ -634,7 +687,7 @@ void authentication_do_work(AUTHENTICATION_HANDLE authentication_handle)
                     // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_068: [If using `instance->device_primary_key` has failed previously and `instance->device_secondary_key` is not provided,  authentication_do_work() shall fail and return]
                     if (create_and_put_SAS_token_to_cbs(instance) != RESULT_OK)
                     {
-                        LogError("Failed refreshing SAS token '%'", instance->device_id);
+                        LogError("Failed refreshing SAS token '%s'", instance->device_id);
                     }
 
                     if (!instance->is_cbs_put_token_in_progress)
@@ -710,6 +763,12 @@ int authentication_set_option(AUTHENTICATION_HANDLE authentication_handle, const
             instance->sas_token_lifetime_secs = *((size_t*)value);
             result = RESULT_OK;
         }
+        else if (strcmp(AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, name) == 0)
+        {
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_131: [If name matches AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, `value` shall be saved on `instance->sas_token_refresh_jitter_secs`]
+            instance->sas_token_refresh_jitter_secs = *((size_t*)value);
+            result = RESULT_OK;
+        }
         else if (strcmp(AUTHENTICATION_OPTION_SAVED_OPTIONS, name) == 0)
         {
             // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_098: [If name matches AUTHENTICATION_OPTION_SAVED_OPTIONS, `value` shall be applied using OptionHandler_FeedOptions]
@@ -778,6 +837,11 @@ OPTIONHANDLER_HANDLE authentication_retrieve_options(AUTHENTICATION_HANDLE authe
                 LogError("Failed to retrieve options from authentication instance (OptionHandler_Create failed for option '%s')", AUTHENTICATION_OPTION_SAS_TOKEN_LIFETIME_SECS);
                 result = NULL;
             }
+            else if (OptionHandler_AddOption(options, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, (void*)&instance->sas_token_refresh_jitter_secs) != OPTIONHANDLER_OK)
+            {
+                LogError("Failed to retrieve options from authentication instance (OptionHandler_Create failed for option '%s')", AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS);
+                result = NULL;
+            }
             else
             {
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_127: [If no failures occur, authentication_retrieve_options shall return the OPTIONHANDLER_HANDLE instance]
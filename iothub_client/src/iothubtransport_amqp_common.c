@@ -10,7 +10,6 @@
 #include "azure_c_shared_utility/agenttime.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
-#include "azure_c_shared_utility/singlylinkedlist.h"
 #include "azure_c_shared_utility/doublylinkedlist.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/platform.h"
@@ -31,6 +30,7 @@
 #include "iothub_client_options.h"
 #include "iothub_client_private.h"
 #include "iothubtransportamqp_methods.h"
+#include "iothub_client_hash.h"
 #include "iothub_client_retry_control.h"
 #include "iothubtransport_amqp_common.h"
 #include "iothubtransport_amqp_connection.h"
@@ -44,6 +44,7 @@
 #define DEFAULT_EVENT_SEND_TIMEOUT_SECS           300
 #define DEFAULT_SAS_TOKEN_LIFETIME_SECS           3600
 #define DEFAULT_SAS_TOKEN_REFRESH_TIME_SECS       1800
+#define DEFAULT_SAS_TOKEN_REFRESH_JITTER_SECS     300
 #define MAX_NUMBER_OF_DEVICE_FAILURES             5
 #define DEFAULT_SERVICE_KEEP_ALIVE_FREQ_SECS      240
 #define DEFAULT_REMOTE_IDLE_PING_RATIO            0.50
@@ -51,6 +52,10 @@
 // DEFAULT_MAX_RETRY_TIME_IN_SECS = 0 means infinite retry.
 #define DEFAULT_MAX_RETRY_TIME_IN_SECS            0
 #define MAX_SERVICE_KEEP_ALIVE_RATIO              0.9
+// Initial number of devices the registry can hold before it needs to grow (must be a power of 2).
+#define DEFAULT_REGISTERED_DEVICES_CAPACITY       8
+#define DEFAULT_NUMBER_OF_AMQP_CONNECTIONS        1
+#define MAX_NUMBER_OF_AMQP_CONNECTIONS            16
 
 // ---------- Data Definitions ---------- //
 
@@ -62,9 +67,9 @@ typedef enum AMQP_TRANSPORT_AUTHENTICATION_MODE_TAG
 } AMQP_TRANSPORT_AUTHENTICATION_MODE;
 
 /*
-Definition of transport states:
+Definition of transport states (each AMQP connection of the transport goes through these states on its own):
 
-AMQP_TRANSPORT_STATE_NOT_CONNECTED:                    Initial state when the transport is created. 
+AMQP_TRANSPORT_STATE_NOT_CONNECTED:                    Initial state when the transport is created, or when a connection is no longer used. 
 AMQP_TRANSPORT_STATE_CONNECTING:                       First connection ever.
 AMQP_TRANSPORT_STATE_CONNECTED:                        Transition from AMQP_TRANSPORT_STATE_CONNECTING or AMQP_TRANSPORT_STATE_RECONNECTING. 
 AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED:            When a failure occurred and the transport identifies a reconnection is needed.
@@ -94,19 +99,32 @@ DEFINE_LOCAL_ENUM(AMQP_TRANSPORT_STATE, AMQP_TRANSPORT_STATE_STRINGS);
 #pragma clang diagnostic pop
 #endif
 
-typedef struct AMQP_TRANSPORT_INSTANCE_TAG
+typedef struct AMQP_TRANSPORT_CONNECTION_TAG
 {
-    STRING_HANDLE iothub_host_fqdn;                                     // FQDN of the IoT Hub.
+    struct AMQP_TRANSPORT_INSTANCE_TAG* transport_instance;            // Saved reference to the transport that owns this connection.
     XIO_HANDLE tls_io;                                                  // TSL I/O transport.
-    AMQP_GET_IO_TRANSPORT underlying_io_transport_provider;             // Pointer to the function that creates the TLS I/O (internal use only).
     AMQP_CONNECTION_HANDLE amqp_connection;                             // Base amqp connection with service.
     AMQP_CONNECTION_STATE amqp_connection_state;                        // Current state of the amqp_connection.
+    size_t number_of_registered_devices;                                // Number of registered devices assigned to this connection.
+    AMQP_TRANSPORT_STATE state;                                         // Current state of this connection; failures of one connection do not affect the others.
+    RETRY_CONTROL_HANDLE retry_control;                                 // Controls when the re-connection attempt of this connection should occur (created on its first failure).
+} AMQP_TRANSPORT_CONNECTION;
+
+typedef struct AMQP_TRANSPORT_INSTANCE_TAG
+{
+    STRING_HANDLE iothub_host_fqdn;                                     // FQDN of the IoT Hub.
+    AMQP_GET_IO_TRANSPORT underlying_io_transport_provider;             // Pointer to the function that creates the TLS I/O (internal use only).
+    AMQP_TRANSPORT_CONNECTION connections[MAX_NUMBER_OF_AMQP_CONNECTIONS]; // AMQP connections the registered devices are spread across (see "AMQP Connection Helpers").
+    size_t number_of_connections;                                       // Number of `connections` in use.
     AMQP_TRANSPORT_AUTHENTICATION_MODE preferred_authentication_mode;   // Used to avoid registered devices using different authentication modes.
-    SINGLYLINKEDLIST_HANDLE registered_devices;                         // List of devices currently registered in this transport.
+    struct AMQP_TRANSPORT_DEVICE_INSTANCE_TAG** registered_devices;     // Devices currently registered in this transport, followed by their index by device id (see "Device Registry Helpers").
+    size_t number_of_registered_devices;                                // Number of devices in `registered_devices`.
+    size_t registered_devices_capacity;                                 // Number of devices `registered_devices` can hold before having to grow; always a power of 2.
     bool is_trace_on;                                                   // Turns logging on and off.
     OPTIONHANDLER_HANDLE saved_tls_options;                             // Here are the options from the xio layer if any is saved.
-    AMQP_TRANSPORT_STATE state;                                         // Current state of the transport.
-    RETRY_CONTROL_HANDLE connection_retry_control;                      // Controls when the re-connection attempt should occur.
+    AMQP_TRANSPORT_STATE state;                                         // Current state of the transport (the state of each AMQP connection is in `connections`).
+    IOTHUB_CLIENT_RETRY_POLICY retry_policy;                            // Policy used by the retry control of each connection.
+    size_t retry_timeout_limit_in_secs;                                 // Maximum time a connection is retried for (0 means no limit).
     size_t svc2cl_keep_alive_timeout_secs;                       // Service to device keep alive frequency
     double cl2svc_keep_alive_send_ratio;								    // Client to service keep alive frequency
 
@@ -117,6 +135,7 @@ typedef struct AMQP_TRANSPORT_INSTANCE_TAG
     
     size_t option_sas_token_lifetime_secs;                              // Device-specific option.
     size_t option_sas_token_refresh_time_secs;                          // Device-specific option.
+    size_t option_sas_token_refresh_jitter_secs;                        // Device-specific option; spreads SAS token refreshes of devices sharing the connection.
     size_t option_cbs_request_timeout_secs;                             // Device-specific option.
     size_t option_send_event_timeout_secs;                              // Device-specific option.
 
@@ -130,6 +149,7 @@ typedef struct AMQP_TRANSPORT_DEVICE_INSTANCE_TAG
     AMQP_DEVICE_HANDLE device_handle;                                   // Logic unit that performs authentication, messaging, etc.
     IOTHUB_CLIENT_LL_HANDLE iothub_client_handle;                       // Saved reference to the IoTHub LL Client.
     AMQP_TRANSPORT_INSTANCE* transport_instance;                        // Saved reference to the transport the device is registered on.
+    AMQP_TRANSPORT_CONNECTION* connection;                              // Connection of `transport_instance` the device is assigned to.
     PDLIST_ENTRY waiting_to_send;                                       // List of events waiting to be sent to the iot hub (i.e., haven't been processed by the transport yet).
     DEVICE_STATE device_state;                                          // Current state of the device_handle instance.
     size_t number_of_previous_failures;                                 // Number of times the device has failed in sequence; this value is reset to 0 if device succeeds to authenticate, send and/or recv messages.
@@ -142,6 +162,9 @@ typedef struct AMQP_TRANSPORT_DEVICE_INSTANCE_TAG
     bool subscribe_methods_needed;                                       // Indicates if should subscribe for device methods.
     // is the transport subscribed for methods?
     bool subscribed_for_methods;                                         // Indicates if device is subscribed for device methods.
+    size_t registry_position;                                           // Position of the device in `transport_instance->registered_devices`.
+    size_t device_id_hash;                                              // Hash of `device_id`, used to index the device in the transport registry.
+    struct AMQP_TRANSPORT_DEVICE_INSTANCE_TAG* next_in_registry_bucket; // Next device in the same bucket of the transport registry index.
 } AMQP_TRANSPORT_DEVICE_INSTANCE;
 
 typedef struct MESSAGE_DISPOSITION_CONTEXT_TAG
@@ -205,9 +228,18 @@ static void update_state(AMQP_TRANSPORT_INSTANCE* transport_instance, AMQP_TRANS
     transport_instance->state = new_state;
 }
 
+static void update_connection_state(AMQP_TRANSPORT_CONNECTION* connection, AMQP_TRANSPORT_STATE new_state)
+{
+    connection->state = new_state;
+}
+
 static void reset_retry_control(AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device)
 {
-    retry_control_reset(registered_device->transport_instance->connection_retry_control);
+    // A connection that never failed has no retry control to reset.
+    if (registered_device->connection != NULL && registered_device->connection->retry_control != NULL)
+    {
+        retry_control_reset(registered_device->connection->retry_control);
+    }
 }
 
 
@@ -252,15 +284,21 @@ static DEVICE_AUTH_MODE get_authentication_mode(const IOTHUB_DEVICE_CONFIG* devi
     return result;
 }
 
-static void raise_connection_status_callback_retry_expired(const void* item, const void* action_context, bool* continue_processing)
+static void raise_connection_status_callback_retry_expired(AMQP_TRANSPORT_INSTANCE* transport_instance, AMQP_TRANSPORT_CONNECTION* connection)
 {
-    (void)action_context;
+    size_t i;
 
-    AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = (AMQP_TRANSPORT_DEVICE_INSTANCE*)item;
+    for (i = 0; i < transport_instance->number_of_registered_devices; i++)
+    {
+        AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = transport_instance->registered_devices[i];
 
-    IoTHubClient_LL_ConnectionStatusCallBack(registered_device->iothub_client_handle, IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED, IOTHUB_CLIENT_CONNECTION_RETRY_EXPIRED);
+        if (registered_device->connection != connection)
+        {
+            continue;
+        }
 
-    *continue_processing = true;
+        IoTHubClient_LL_ConnectionStatusCallBack(registered_device->iothub_client_handle, IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED, IOTHUB_CLIENT_CONNECTION_RETRY_EXPIRED);
+    }
 }
 
 // @brief
@@ -278,7 +316,7 @@ static void on_device_state_changed_callback(void* context, DEVICE_STATE previou
 
         if (new_state == DEVICE_STATE_STARTED)
         {
-            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_127: [If `new_state` is DEVICE_STATE_STARTED, retry_control_reset() shall be invoked passing `instance->connection_retry_control`]
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_127: [If `new_state` is DEVICE_STATE_STARTED and the connection of the device has a retry control, retry_control_reset() shall be invoked passing it]
             reset_retry_control(registered_device);
 
             // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_120: [If `new_state` is DEVICE_STATE_STARTED, IoTHubClient_LL_ConnectionStatusCallBack shall be invoked with IOTHUB_CLIENT_CONNECTION_AUTHENTICATED and IOTHUB_CLIENT_CONNECTION_OK]
@@ -287,14 +325,16 @@ static void on_device_state_changed_callback(void* context, DEVICE_STATE previou
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_121: [If `new_state` is DEVICE_STATE_STOPPED, IoTHubClient_LL_ConnectionStatusCallBack shall be invoked with IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED and IOTHUB_CLIENT_CONNECTION_OK]
         else if (new_state == DEVICE_STATE_STOPPED)
         {
-            if (registered_device->transport_instance->state == AMQP_TRANSPORT_STATE_CONNECTED ||
-                registered_device->transport_instance->state == AMQP_TRANSPORT_STATE_BEING_DESTROYED)
+            AMQP_TRANSPORT_STATE connection_state = (registered_device->connection != NULL ? registered_device->connection->state : AMQP_TRANSPORT_STATE_NOT_CONNECTED);
+
+            if (registered_device->transport_instance->state == AMQP_TRANSPORT_STATE_BEING_DESTROYED ||
+                connection_state == AMQP_TRANSPORT_STATE_CONNECTED)
             {
                 IoTHubClient_LL_ConnectionStatusCallBack(registered_device->iothub_client_handle, IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED, IOTHUB_CLIENT_CONNECTION_OK);
             }
-            else if (registered_device->transport_instance->state == AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED ||
-                registered_device->transport_instance->state == AMQP_TRANSPORT_STATE_READY_FOR_RECONNECTION ||
-                registered_device->transport_instance->state == AMQP_TRANSPORT_STATE_RECONNECTING)
+            else if (connection_state == AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED ||
+                connection_state == AMQP_TRANSPORT_STATE_READY_FOR_RECONNECTION ||
+                connection_state == AMQP_TRANSPORT_STATE_RECONNECTING)
             {
                 IoTHubClient_LL_ConnectionStatusCallBack(registered_device->iothub_client_handle, IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED, IOTHUB_CLIENT_CONNECTION_NO_NETWORK);
             }
@@ -312,65 +352,165 @@ static void on_device_state_changed_callback(void* context, DEVICE_STATE previou
     }
 }
 
-// @brief    Auxiliary function to be used to find a device in the registered_devices list.
-// @returns  true if the device ids match, false otherwise.
-static bool find_device_by_id_callback(LIST_ITEM_HANDLE list_item, const void* match_context)
+// ---------- Device Registry Helpers ---------- //
+
+/*
+The registered devices are stored in a single memory block: a dense array of `registered_devices_capacity` devices
+(used to iterate through them on DoWork, SetOption, etc), followed by an index of `registered_devices_capacity` buckets
+keyed by the hash of the device id (used to look devices up on Register, Unregister, Subscribe, etc).
+Devices that fall in the same bucket are chained through `next_in_registry_bucket`.
+*/
+
+static AMQP_TRANSPORT_DEVICE_INSTANCE** get_registry_bucket(AMQP_TRANSPORT_INSTANCE* transport_instance, size_t device_id_hash)
+{
+    return &transport_instance->registered_devices[transport_instance->registered_devices_capacity + (device_id_hash & (transport_instance->registered_devices_capacity - 1))];
+}
+
+static int create_device_registry(AMQP_TRANSPORT_INSTANCE* transport_instance)
 {
-    bool result;
+    int result;
+    size_t registry_size = 2 * DEFAULT_REGISTERED_DEVICES_CAPACITY * sizeof(AMQP_TRANSPORT_DEVICE_INSTANCE*);
 
-    if (match_context == NULL)
+    if ((transport_instance->registered_devices = (AMQP_TRANSPORT_DEVICE_INSTANCE**)malloc(registry_size)) == NULL)
     {
-        result = false;
+        LogError("Failed allocating the registry of devices (malloc failed)");
+        result = __FAILURE__;
     }
     else
     {
-        AMQP_TRANSPORT_DEVICE_INSTANCE* device_instance = (AMQP_TRANSPORT_DEVICE_INSTANCE*)singlylinkedlist_item_get_value(list_item);
+        memset(transport_instance->registered_devices, 0, registry_size);
+        transport_instance->registered_devices_capacity = DEFAULT_REGISTERED_DEVICES_CAPACITY;
+        transport_instance->number_of_registered_devices = 0;
+        result = RESULT_OK;
+    }
 
-        if (device_instance == NULL || 
-            device_instance->device_id == NULL || 
-            STRING_c_str(device_instance->device_id) != match_context)
-        {
-            result = false;
-        }
-        else
+    return result;
+}
+
+// @brief
+//     Doubles the capacity of the registry and rebuilds its index.
+static int grow_device_registry(AMQP_TRANSPORT_INSTANCE* transport_instance)
+{
+    int result;
+    size_t new_capacity = 2 * transport_instance->registered_devices_capacity;
+    AMQP_TRANSPORT_DEVICE_INSTANCE** new_registered_devices;
+
+    if (new_capacity > SIZE_MAX / (2 * sizeof(AMQP_TRANSPORT_DEVICE_INSTANCE*)))
+    {
+        LogError("Failed growing the registry of devices (maximum number of devices reached)");
+        result = __FAILURE__;
+    }
+    else if ((new_registered_devices = (AMQP_TRANSPORT_DEVICE_INSTANCE**)realloc(transport_instance->registered_devices, 2 * new_capacity * sizeof(AMQP_TRANSPORT_DEVICE_INSTANCE*))) == NULL)
+    {
+        LogError("Failed growing the registry of devices (realloc failed)");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t i;
+
+        transport_instance->registered_devices = new_registered_devices;
+        transport_instance->registered_devices_capacity = new_capacity;
+
+        // The dense array is preserved by realloc, but the index needs to be rebuilt for the new number of buckets.
+        memset(&new_registered_devices[new_capacity], 0, new_capacity * sizeof(AMQP_TRANSPORT_DEVICE_INSTANCE*));
+
+        for (i = 0; i < transport_instance->number_of_registered_devices; i++)
         {
-            result = true;
+            AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = new_registered_devices[i];
+            AMQP_TRANSPORT_DEVICE_INSTANCE** bucket = get_registry_bucket(transport_instance, registered_device->device_id_hash);
+
+            registered_device->next_in_registry_bucket = *bucket;
+            *bucket = registered_device;
         }
+
+        result = RESULT_OK;
     }
 
     return result;
 }
 
-// @brief       Verifies if a device is already registered within the transport that owns the list of registered devices.
-// @remarks     Returns the correspoding LIST_ITEM_HANDLE in registered_devices, if found.
-// @returns     true if the device is already in the list, false otherwise.
-static bool is_device_registered_ex(SINGLYLINKEDLIST_HANDLE registered_devices, const char* device_id, LIST_ITEM_HANDLE *list_item)
+static int add_registered_device(AMQP_TRANSPORT_INSTANCE* transport_instance, AMQP_TRANSPORT_DEVICE_INSTANCE* amqp_device_instance)
 {
-    return ((*list_item = singlylinkedlist_find(registered_devices, find_device_by_id_callback, device_id)) != NULL ? 1 : 0);
+    int result;
+
+    if (transport_instance->number_of_registered_devices == transport_instance->registered_devices_capacity &&
+        grow_device_registry(transport_instance) != RESULT_OK)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        AMQP_TRANSPORT_DEVICE_INSTANCE** bucket = get_registry_bucket(transport_instance, amqp_device_instance->device_id_hash);
+
+        amqp_device_instance->next_in_registry_bucket = *bucket;
+        *bucket = amqp_device_instance;
+
+        amqp_device_instance->registry_position = transport_instance->number_of_registered_devices;
+        transport_instance->registered_devices[transport_instance->number_of_registered_devices++] = amqp_device_instance;
+
+        result = RESULT_OK;
+    }
+
+    return result;
 }
 
-// @brief       Verifies if a device is already registered within the transport that owns the list of registered devices.
-// @returns     true if the device is already in the list, false otherwise.
-static bool is_device_registered(AMQP_TRANSPORT_DEVICE_INSTANCE* amqp_device_instance)
+static void remove_registered_device(AMQP_TRANSPORT_INSTANCE* transport_instance, AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device)
 {
-    LIST_ITEM_HANDLE list_item;
-    const char* device_id = STRING_c_str(amqp_device_instance->device_id);
-    return is_device_registered_ex(amqp_device_instance->transport_instance->registered_devices, device_id, &list_item);
+    AMQP_TRANSPORT_DEVICE_INSTANCE** bucket_link = get_registry_bucket(transport_instance, registered_device->device_id_hash);
+
+    while (*bucket_link != NULL && *bucket_link != registered_device)
+    {
+        bucket_link = &(*bucket_link)->next_in_registry_bucket;
+    }
+
+    if (*bucket_link == NULL)
+    {
+        LogError("Device '%s' is not in the registry index", STRING_c_str(registered_device->device_id));
+    }
+    else
+    {
+        AMQP_TRANSPORT_DEVICE_INSTANCE* last_device;
+
+        *bucket_link = registered_device->next_in_registry_bucket;
+
+        // The last device takes the position of the one removed, so the array stays dense.
+        last_device = transport_instance->registered_devices[--transport_instance->number_of_registered_devices];
+        last_device->registry_position = registered_device->registry_position;
+        transport_instance->registered_devices[last_device->registry_position] = last_device;
+    }
 }
 
-static size_t get_number_of_registered_devices(AMQP_TRANSPORT_INSTANCE* transport)
+// @returns     The registered device with the given id, or NULL if there is no such device registered within the transport.
+static AMQP_TRANSPORT_DEVICE_INSTANCE* find_registered_device(AMQP_TRANSPORT_INSTANCE* transport_instance, const char* device_id)
 {
-    size_t result = 0;
-
-    LIST_ITEM_HANDLE list_item = singlylinkedlist_get_head_item(transport->registered_devices);
+    size_t device_id_hash = iothub_client_hash_string(device_id);
+    AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = *get_registry_bucket(transport_instance, device_id_hash);
 
-    while (list_item != NULL)
+    while (registered_device != NULL)
     {
-        result++;
-        list_item = singlylinkedlist_get_next_item(list_item);
+        if (registered_device->device_id_hash == device_id_hash)
+        {
+            const char* registered_device_id = STRING_c_str(registered_device->device_id);
+
+            if (registered_device_id != NULL && strcmp(registered_device_id, device_id) == 0)
+            {
+                break;
+            }
+        }
+
+        registered_device = registered_device->next_in_registry_bucket;
     }
 
-    return result;
+    return registered_device;
+}
+
+// @brief       Verifies if a device is already registered within the transport that owns the list of registered devices.
+// @returns     true if the device is already in the list, false otherwise.
+static bool is_device_registered(AMQP_TRANSPORT_DEVICE_INSTANCE* amqp_device_instance)
+{
+    const char* device_id = STRING_c_str(amqp_device_instance->device_id);
+    return (device_id != NULL && find_registered_device(amqp_device_instance->transport_instance, device_id) == amqp_device_instance);
 }
 
 
@@ -532,7 +672,7 @@ static int subscribe_methods(AMQP_TRANSPORT_DEVICE_INSTANCE* deviceState)
     {
         SESSION_HANDLE session_handle;
 
-        if ((amqp_connection_get_session_handle(deviceState->transport_instance->amqp_connection, &session_handle)) != RESULT_OK)
+        if ((amqp_connection_get_session_handle(deviceState->connection->amqp_connection, &session_handle)) != RESULT_OK)
         {
             LogError("Device '%s' failed subscribing for methods (failed getting session handle)", STRING_c_str(deviceState->device_id));
             result = __FAILURE__;
@@ -604,14 +744,16 @@ static void on_device_twin_update_received_callback(DEVICE_TWIN_UPDATE_TYPE upda
 //     This is used when the new underlying I/O transport (TLS I/O, or WebSockets, etc) needs to be recreated, 
 //     and the options previously set must persist.
 //
+//     All connections get the same options, so they are retrieved from the first connection that has a TLS I/O instance.
 //     If no TLS I/O instance was created yet, results in failure.
 // @returns
 //     0 if succeeds, non-zero otherwise.
-static int save_underlying_io_transport_options(AMQP_TRANSPORT_INSTANCE* transport_instance)
+// @brief    Saves the options of `tls_io` on `transport_instance->saved_tls_options` (all connections share the same TLS I/O options).
+static int save_options_of_underlying_io_transport(AMQP_TRANSPORT_INSTANCE* transport_instance, XIO_HANDLE tls_io)
 {
     int result;
 
-    if (transport_instance->tls_io == NULL)
+    if (tls_io == NULL)
     {
         LogError("failed saving underlying I/O transport options (tls_io instance is NULL)");
         result = __FAILURE__;
@@ -620,9 +762,9 @@ static int save_underlying_io_transport_options(AMQP_TRANSPORT_INSTANCE* transpo
     {
         OPTIONHANDLER_HANDLE fresh_options;
 
-        if ((fresh_options = xio_retrieveoptions(transport_instance->tls_io)) == NULL)
+        if ((fresh_options = xio_retrieveoptions(tls_io)) == NULL)
         {
-            LogError("failed saving underlying I/O transport options (tls_io instance is NULL)");
+            LogError("failed saving underlying I/O transport options (xio_retrieveoptions failed)");
             result = __FAILURE__;
         }
         else
@@ -642,6 +784,20 @@ static int save_underlying_io_transport_options(AMQP_TRANSPORT_INSTANCE* transpo
     return result;
 }
 
+// @brief    Saves the options of the first connection that has a TLS I/O.
+static int save_underlying_io_transport_options(AMQP_TRANSPORT_INSTANCE* transport_instance)
+{
+    XIO_HANDLE tls_io = NULL;
+    size_t i;
+
+    for (i = 0; i < transport_instance->number_of_connections && tls_io == NULL; i++)
+    {
+        tls_io = transport_instance->connections[i].tls_io;
+    }
+
+    return save_options_of_underlying_io_transport(transport_instance, tls_io);
+}
+
 static void destroy_underlying_io_transport_options(AMQP_TRANSPORT_INSTANCE* transport_instance)
 {
     if (transport_instance->saved_tls_options != NULL)
@@ -680,13 +836,51 @@ static int restore_underlying_io_transport_options(AMQP_TRANSPORT_INSTANCE* tran
 }
 
 // @brief    Destroys the XIO_HANDLE obtained with underlying_io_transport_provider(), saving its options beforehand.
-static void destroy_underlying_io_transport(AMQP_TRANSPORT_INSTANCE* transport_instance)
+static void destroy_underlying_io_transport(AMQP_TRANSPORT_CONNECTION* connection)
 {
-    if (transport_instance->tls_io != NULL)
+    if (connection->tls_io != NULL)
     {
-        xio_destroy(transport_instance->tls_io);
-        transport_instance->tls_io = NULL;
+        xio_destroy(connection->tls_io);
+        connection->tls_io = NULL;
+    }
+}
+
+static bool is_any_underlying_io_transport_created(AMQP_TRANSPORT_INSTANCE* transport_instance)
+{
+    size_t i;
+
+    for (i = 0; i < transport_instance->number_of_connections; i++)
+    {
+        if (transport_instance->connections[i].tls_io != NULL)
+        {
+            break;
+        }
     }
+
+    return (i < transport_instance->number_of_connections);
+}
+
+// @brief
+//     Applies an option to the TLS I/O of every connection that currently has one.
+// @remarks
+//     This does not save the option; the caller must refresh `saved_tls_options` afterwards, 
+//     so the TLS I/O of connections established later get it through get_new_underlying_io_transport().
+static int set_underlying_io_transport_option(AMQP_TRANSPORT_INSTANCE* transport_instance, const char* option, const void* value)
+{
+    int result = RESULT_OK;
+    size_t i;
+
+    for (i = 0; i < transport_instance->number_of_connections; i++)
+    {
+        if (transport_instance->connections[i].tls_io != NULL &&
+            xio_setoption(transport_instance->connections[i].tls_io, option, value) != RESULT_OK)
+        {
+            result = __FAILURE__;
+            break;
+        }
+    }
+
+    return result;
 }
 
 // @brief    Invokes underlying_io_transport_provider() and retrieves a new XIO_HANDLE to use for I/O (TLS, or websockets, or w/e is supported).
@@ -749,33 +943,36 @@ static void on_amqp_connection_state_changed(const void* context, AMQP_CONNECTIO
 {
     if (context != NULL && new_state != previous_state)
     {
-        AMQP_TRANSPORT_INSTANCE* transport_instance = (AMQP_TRANSPORT_INSTANCE*)context;
+        AMQP_TRANSPORT_CONNECTION* connection = (AMQP_TRANSPORT_CONNECTION*)context;
+        AMQP_TRANSPORT_INSTANCE* transport_instance = connection->transport_instance;
 
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_059: [`new_state` shall be saved in to the transport instance]
-        transport_instance->amqp_connection_state = new_state;
+        connection->amqp_connection_state = new_state;
 
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_060: [If `new_state` is AMQP_CONNECTION_STATE_ERROR, the connection shall be flagged as faulty (so the connection retry logic can be triggered)]
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_060: [If `new_state` is AMQP_CONNECTION_STATE_ERROR, the connection shall be flagged as faulty (so the connection retry logic can be triggered for that connection only)]
         if (new_state == AMQP_CONNECTION_STATE_ERROR)
         {
             LogError("Transport received an ERROR from the amqp_connection (state changed %s -> %s); it will be flagged for connection retry.", ENUM_TO_STRING(AMQP_CONNECTION_STATE, previous_state), ENUM_TO_STRING(AMQP_CONNECTION_STATE, new_state));
 
-            update_state(transport_instance, AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED);
+            update_connection_state(connection, AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED);
         }
         else if (new_state == AMQP_CONNECTION_STATE_OPENED)
         {
-            update_state(transport_instance, AMQP_TRANSPORT_STATE_CONNECTED);
+            update_connection_state(connection, AMQP_TRANSPORT_STATE_CONNECTED);
         }
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_115: [If the AMQP connection is closed by the service side, the connection retry logic shall be triggered]
-        else if (new_state == AMQP_CONNECTION_STATE_CLOSED && previous_state == AMQP_CONNECTION_STATE_OPENED && transport_instance->state != AMQP_TRANSPORT_STATE_BEING_DESTROYED)
+        // (`connection->amqp_connection` is only NULL here if the connection is being closed by the transport itself)
+        else if (new_state == AMQP_CONNECTION_STATE_CLOSED && previous_state == AMQP_CONNECTION_STATE_OPENED && 
+            transport_instance->state != AMQP_TRANSPORT_STATE_BEING_DESTROYED && connection->amqp_connection != NULL)
         {
             LogError("amqp_connection was closed unexpectedly; connection retry will be triggered.");
 
-            update_state(transport_instance, AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED);
+            update_connection_state(connection, AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED);
         }
     }
 }
 
-static int establish_amqp_connection(AMQP_TRANSPORT_INSTANCE* transport_instance)
+static int establish_amqp_connection(AMQP_TRANSPORT_INSTANCE* transport_instance, AMQP_TRANSPORT_CONNECTION* connection)
 {
     int result;
 
@@ -787,8 +984,8 @@ static int establish_amqp_connection(AMQP_TRANSPORT_INSTANCE* transport_instance
     // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_023: [If `instance->tls_io` is NULL, it shall be set invoking instance->underlying_io_transport_provider()]
     // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_025: [When `instance->tls_io` is created, it shall be set with `instance->saved_tls_options` using OptionHandler_FeedOptions()]
     // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_111: [If OptionHandler_FeedOptions() fails, it shall be ignored]
-    else if (transport_instance->tls_io == NULL &&
-        get_new_underlying_io_transport(transport_instance, &transport_instance->tls_io) != RESULT_OK)
+    else if (connection->tls_io == NULL &&
+        get_new_underlying_io_transport(transport_instance, &connection->tls_io) != RESULT_OK)
     {
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_024: [If instance->underlying_io_transport_provider() fails, IoTHubTransport_AMQP_Common_DoWork shall fail and return]
         LogError("Failed establishing connection (failed to obtain a TLS I/O transport layer).");
@@ -798,11 +995,11 @@ static int establish_amqp_connection(AMQP_TRANSPORT_INSTANCE* transport_instance
     {
         AMQP_CONNECTION_CONFIG amqp_connection_config;
         amqp_connection_config.iothub_host_fqdn = STRING_c_str(transport_instance->iothub_host_fqdn);
-        amqp_connection_config.underlying_io_transport = transport_instance->tls_io;
+        amqp_connection_config.underlying_io_transport = connection->tls_io;
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_029: [`instance->is_trace_on` shall be set into `AMQP_CONNECTION_CONFIG->is_trace_on`]
         amqp_connection_config.is_trace_on = transport_instance->is_trace_on;
         amqp_connection_config.on_state_changed_callback = on_amqp_connection_state_changed;
-        amqp_connection_config.on_state_changed_context = transport_instance;
+        amqp_connection_config.on_state_changed_context = connection;
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_12_003: [AMQP connection will be configured using the `svc2cl_keep_alive_timeout_secs` value from SetOption ]
         amqp_connection_config.svc2cl_keep_alive_timeout_secs = transport_instance->svc2cl_keep_alive_timeout_secs;
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_99_001: [AMQP connection will be configured using the `remote_idle_timeout_ratio` value from SetOption ]
@@ -822,19 +1019,19 @@ static int establish_amqp_connection(AMQP_TRANSPORT_INSTANCE* transport_instance
         }
         // If new AMQP_TRANSPORT_AUTHENTICATION_MODE values are added, they need to be covered here.
 
-        transport_instance->amqp_connection_state = AMQP_CONNECTION_STATE_CLOSED;
+        connection->amqp_connection_state = AMQP_CONNECTION_STATE_CLOSED;
 
-        if (transport_instance->state == AMQP_TRANSPORT_STATE_READY_FOR_RECONNECTION)
+        if (connection->state == AMQP_TRANSPORT_STATE_READY_FOR_RECONNECTION)
         {
-            update_state(transport_instance, AMQP_TRANSPORT_STATE_RECONNECTING);
+            update_connection_state(connection, AMQP_TRANSPORT_STATE_RECONNECTING);
         }
         else
         {
-            update_state(transport_instance, AMQP_TRANSPORT_STATE_CONNECTING);
+            update_connection_state(connection, AMQP_TRANSPORT_STATE_CONNECTING);
         }
 
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_026: [If `transport->connection` is NULL, it shall be created using amqp_connection_create()]
-        if ((transport_instance->amqp_connection = amqp_connection_create(&amqp_connection_config)) == NULL)
+        if ((connection->amqp_connection = amqp_connection_create(&amqp_connection_config)) == NULL)
         {
             // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_030: [If amqp_connection_create() fails, IoTHubTransport_AMQP_Common_DoWork shall fail and return]
             LogError("Failed establishing connection (failed to create the amqp_connection instance).");
@@ -850,6 +1047,23 @@ static int establish_amqp_connection(AMQP_TRANSPORT_INSTANCE* transport_instance
     return result;
 }
 
+static void destroy_amqp_connection(AMQP_TRANSPORT_CONNECTION* connection)
+{
+    if (connection->amqp_connection != NULL)
+    {
+        AMQP_CONNECTION_HANDLE amqp_connection = connection->amqp_connection;
+
+        // Cleared first so state changes raised while closing are not taken as the service closing the connection.
+        connection->amqp_connection = NULL;
+        amqp_connection_destroy(amqp_connection);
+    }
+
+    connection->amqp_connection_state = AMQP_CONNECTION_STATE_CLOSED;
+    update_connection_state(connection, AMQP_TRANSPORT_STATE_NOT_CONNECTED);
+
+    destroy_underlying_io_transport(connection);
+}
+
 static void prepare_device_for_connection_retry(AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device)
 {
     // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_032: [ Each `instance->registered_devices` shall unsubscribe from receiving C2D method requests by calling `iothubtransportamqp_methods_unsubscribe`]
@@ -869,43 +1083,138 @@ static void prepare_device_for_connection_retry(AMQP_TRANSPORT_DEVICE_INSTANCE*
     registered_device->number_of_send_event_complete_failures = 0;
 }
 
-static void prepare_for_connection_retry(AMQP_TRANSPORT_INSTANCE* transport_instance)
+// @brief    Tears down `connection` and stops the devices assigned to it, so it is established again on the next DoWork; other connections are not affected.
+static void prepare_for_connection_retry(AMQP_TRANSPORT_INSTANCE* transport_instance, AMQP_TRANSPORT_CONNECTION* connection)
 {
-    LogInfo("Preparing transport for re-connection");
+    size_t i;
+
+    LogInfo("Preparing connection for re-connection");
 
-    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_034: [`instance->tls_io` options shall be saved on `instance->saved_tls_options` using xio_retrieveoptions()]
-    if (save_underlying_io_transport_options(transport_instance) != RESULT_OK)
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_034: [The options of the `tls_io` of the connection shall be saved on `instance->saved_tls_options` using xio_retrieveoptions()]
+    if (connection->tls_io != NULL && 
+        save_options_of_underlying_io_transport(transport_instance, connection->tls_io) != RESULT_OK)
     {
         LogError("Failed saving TLS I/O options while preparing for connection retry; failure will be ignored");
     }
 
-    LIST_ITEM_HANDLE list_item = singlylinkedlist_get_head_item(transport_instance->registered_devices);
-
-    while (list_item != NULL)
+    for (i = 0; i < transport_instance->number_of_registered_devices; i++)
     {
-        AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = (AMQP_TRANSPORT_DEVICE_INSTANCE*)singlylinkedlist_item_get_value(list_item);
+        AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = transport_instance->registered_devices[i];
 
-        if (registered_device == NULL)
-        {
-            LogError("Failed preparing device for connection retry (singlylinkedlist_item_get_value failed)");
-        }
-        else
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_170: [Only the registered devices assigned to the connection being retried shall be prepared for the connection retry]
+        if (registered_device->connection == connection)
         {
             prepare_device_for_connection_retry(registered_device);
         }
+    }
+
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_033: [The amqp_connection of the connection shall be destroyed using amqp_connection_destroy()]
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_035: [The `tls_io` of the connection shall be destroyed using xio_destroy()]
+    destroy_amqp_connection(connection);
 
-        list_item = singlylinkedlist_get_next_item(list_item);
+    update_connection_state(connection, AMQP_TRANSPORT_STATE_READY_FOR_RECONNECTION);
+}
+
+// @brief    Runs the connection retry logic of a connection flagged with AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED.
+static void retry_amqp_connection(AMQP_TRANSPORT_INSTANCE* transport_instance, AMQP_TRANSPORT_CONNECTION* connection)
+{
+    RETRY_ACTION retry_action;
+
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_124: [If the connection does not have a retry control yet, it shall be created using retry_control_create(), passing `instance->retry_policy` and `instance->retry_timeout_limit_in_secs`]
+    if (connection->retry_control == NULL &&
+        (connection->retry_control = retry_control_create(transport_instance->retry_policy, (unsigned int)transport_instance->retry_timeout_limit_in_secs)) == NULL)
+    {
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_125: [If retry_control_create() fails, the connection retry shall be attempted immediately]
+        LogError("Failed to create the connection retry control; assuming immediate connection retry for safety.");
+        retry_action = RETRY_ACTION_RETRY_NOW;
+    }
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_126: [The connection retry shall be attempted only if retry_control_should_retry() returns RETRY_ACTION_NOW, or if it fails]
+    else if (retry_control_should_retry(connection->retry_control, &retry_action) != RESULT_OK)
+    {
+        LogError("retry_control_should_retry() failed; assuming immediate connection retry for safety.");
+        retry_action = RETRY_ACTION_RETRY_NOW;
     }
 
-    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_033: [`instance->connection` shall be destroyed using amqp_connection_destroy()]
-    amqp_connection_destroy(transport_instance->amqp_connection);
-    transport_instance->amqp_connection = NULL;
-    transport_instance->amqp_connection_state = AMQP_CONNECTION_STATE_CLOSED;
+    if (retry_action == RETRY_ACTION_RETRY_NOW)
+    {
+        prepare_for_connection_retry(transport_instance, connection);
+    }
+    else if (retry_action == RETRY_ACTION_STOP_RETRYING)
+    {
+        update_connection_state(connection, AMQP_TRANSPORT_STATE_NOT_CONNECTED_NO_MORE_RETRIES);
+
+        raise_connection_status_callback_retry_expired(transport_instance, connection);
+    }
+}
+
 
-    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_035: [`instance->tls_io` shall be destroyed using xio_destroy()]
-    destroy_underlying_io_transport(transport_instance);
+// ---------- AMQP Connection Helpers ---------- //
 
-    update_state(transport_instance, AMQP_TRANSPORT_STATE_READY_FOR_RECONNECTION);
+/*
+Registered devices are spread across `number_of_connections` AMQP connections (each with its own TLS I/O and session),
+so the transport is not limited to the throughput of a single TCP stream. Devices are assigned to connections using
+jump consistent hashing on their device id, so changing the number of connections only moves the minimum number of devices.
+*/
+
+// @returns  The index of the connection the device with the given device id hash is assigned to.
+static size_t get_connection_index_for_device(size_t device_id_hash, size_t number_of_connections)
+{
+    uint64_t key = (uint64_t)device_id_hash;
+    int64_t index = -1;
+    int64_t next_index = 0;
+
+    while (next_index < (int64_t)number_of_connections)
+    {
+        index = next_index;
+        key = key * 2862933555777941757ULL + 1;
+        next_index = (int64_t)((double)(index + 1) * ((double)(1LL << 31) / (double)((key >> 33) + 1)));
+    }
+
+    return (size_t)index;
+}
+
+static void assign_device_to_connection(AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device, AMQP_TRANSPORT_CONNECTION* connection)
+{
+    if (registered_device->connection != NULL)
+    {
+        registered_device->connection->number_of_registered_devices--;
+    }
+
+    registered_device->connection = connection;
+
+    if (connection != NULL)
+    {
+        connection->number_of_registered_devices++;
+    }
+}
+
+// @brief
+//     Changes the number of AMQP connections used by the transport.
+//     Devices assigned to a different connection as a result are stopped, and get started on their new connection
+//     on the next DoWork; the other devices are not affected.
+static void set_number_of_amqp_connections(AMQP_TRANSPORT_INSTANCE* transport_instance, size_t number_of_connections)
+{
+    size_t i;
+
+    for (i = 0; i < transport_instance->number_of_registered_devices; i++)
+    {
+        AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = transport_instance->registered_devices[i];
+        AMQP_TRANSPORT_CONNECTION* connection = &transport_instance->connections[get_connection_index_for_device(registered_device->device_id_hash, number_of_connections)];
+
+        if (connection != registered_device->connection)
+        {
+            prepare_device_for_connection_retry(registered_device);
+            assign_device_to_connection(registered_device, connection);
+        }
+    }
+
+    // Connections no longer used can only have had devices that were moved (and stopped) above.
+    for (i = number_of_connections; i < transport_instance->number_of_connections; i++)
+    {
+        destroy_amqp_connection(&transport_instance->connections[i]);
+    }
+
+    transport_instance->number_of_connections = number_of_connections;
 }
 
 
@@ -1077,7 +1386,7 @@ static int IoTHubTransport_AMQP_Common_Device_DoWork(AMQP_TRANSPORT_DEVICE_INSTA
             CBS_HANDLE cbs_handle = NULL;
 
             // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_039: [amqp_connection_get_session_handle() shall be invoked on `instance->connection`]
-            if (amqp_connection_get_session_handle(registered_device->transport_instance->amqp_connection, &session_handle) != RESULT_OK)
+            if (amqp_connection_get_session_handle(registered_device->connection->amqp_connection, &session_handle) != RESULT_OK)
             {
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_040: [If amqp_connection_get_session_handle() fails, IoTHubTransport_AMQP_Common_DoWork shall fail and return]
                 LogError("Failed performing DoWork for device '%s' (failed to get the amqp_connection session_handle)", STRING_c_str(registered_device->device_id));
@@ -1085,7 +1394,7 @@ static int IoTHubTransport_AMQP_Common_Device_DoWork(AMQP_TRANSPORT_DEVICE_INSTA
             }
             // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_037: [If transport is using CBS authentication, amqp_connection_get_cbs_handle() shall be invoked on `instance->connection`]
             else if (registered_device->transport_instance->preferred_authentication_mode == AMQP_TRANSPORT_AUTHENTICATION_MODE_CBS &&
-                amqp_connection_get_cbs_handle(registered_device->transport_instance->amqp_connection, &cbs_handle) != RESULT_OK)
+                amqp_connection_get_cbs_handle(registered_device->connection->amqp_connection, &cbs_handle) != RESULT_OK)
             {
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_038: [If amqp_connection_get_cbs_handle() fails, IoTHubTransport_AMQP_Common_DoWork shall fail and return]
                 LogError("Failed performing DoWork for device '%s' (failed to get the amqp_connection cbs_handle)", STRING_c_str(registered_device->device_id));
@@ -1225,6 +1534,14 @@ static int replicate_device_options_to(AMQP_TRANSPORT_DEVICE_INSTANCE* dev_insta
             LogError("Failed to apply option DEVICE_OPTION_SAS_TOKEN_REFRESH_TIME_SECS to device '%s' (device_set_option failed)", STRING_c_str(dev_instance->device_id));
             result = __FAILURE__;
         }
+        else if (device_set_option(
+            dev_instance->device_handle,
+            DEVICE_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS,
+            &dev_instance->transport_instance->option_sas_token_refresh_jitter_secs) != RESULT_OK)
+        {
+            LogError("Failed to apply option DEVICE_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS to device '%s' (device_set_option failed)", STRING_c_str(dev_instance->device_id));
+            result = __FAILURE__;
+        }
         else
         {
             result = RESULT_OK;
@@ -1256,6 +1573,10 @@ static const char* get_device_option_name_from(const char* iothubclient_option_n
     {
         device_option_name = DEVICE_OPTION_CBS_REQUEST_TIMEOUT_SECS;
     }
+    else if (strcmp(OPTION_SAS_TOKEN_REFRESH_JITTER, iothubclient_option_name) == 0)
+    {
+        device_option_name = DEVICE_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS;
+    }
     else if (strcmp(OPTION_EVENT_SEND_TIMEOUT_SECS, iothubclient_option_name) == 0)
     {
         device_option_name = DEVICE_OPTION_EVENT_SEND_TIMEOUT_SECS;
@@ -1285,29 +1606,21 @@ static int IoTHubTransport_AMQP_Common_Device_SetOption(TRANSPORT_LL_HANDLE hand
     else
     {
         AMQP_TRANSPORT_INSTANCE* instance = (AMQP_TRANSPORT_INSTANCE*)handle;
-        result = RESULT_OK;
+        size_t i;
 
-        LIST_ITEM_HANDLE list_item = singlylinkedlist_get_head_item(instance->registered_devices);
+        result = RESULT_OK;
 
-        while (list_item != NULL)
+        for (i = 0; i < instance->number_of_registered_devices; i++)
         {
-            AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device;
+            AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = instance->registered_devices[i];
 
-            if ((registered_device = (AMQP_TRANSPORT_DEVICE_INSTANCE*)singlylinkedlist_item_get_value(list_item)) == NULL)
-            {
-                LogError("failed setting option '%s' to registered device (singlylinkedlist_item_get_value failed)", option);
-                result = __FAILURE__;
-                break;
-            }
-            else if (device_set_option(registered_device->device_handle, device_option, value) != RESULT_OK)
+            if (device_set_option(registered_device->device_handle, device_option, value) != RESULT_OK)
             {
                 LogError("failed setting option '%s' to registered device '%s' (device_set_option failed)",
                     option, STRING_c_str(registered_device->device_id));
                 result = __FAILURE__;
                 break;
             }
-
-            list_item = singlylinkedlist_get_next_item(list_item);
         }
     }
 
@@ -1318,30 +1631,40 @@ static void internal_destroy_instance(AMQP_TRANSPORT_INSTANCE* instance)
 {
     if (instance != NULL)
     {
+        size_t i;
+
         update_state(instance, AMQP_TRANSPORT_STATE_BEING_DESTROYED);
 
         if (instance->registered_devices != NULL)
         {
-            LIST_ITEM_HANDLE list_item = singlylinkedlist_get_head_item(instance->registered_devices);
-
-            while (list_item != NULL)
+            // Unregistering moves the last device into the position being vacated, so the devices are unregistered from the end.
+            while (instance->number_of_registered_devices > 0)
             {
-                AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = (AMQP_TRANSPORT_DEVICE_INSTANCE*)singlylinkedlist_item_get_value(list_item);
-                list_item = singlylinkedlist_get_next_item(list_item);
-                IoTHubTransport_AMQP_Common_Unregister(registered_device);
+                size_t number_of_registered_devices = instance->number_of_registered_devices;
+
+                IoTHubTransport_AMQP_Common_Unregister(instance->registered_devices[number_of_registered_devices - 1]);
+
+                if (instance->number_of_registered_devices == number_of_registered_devices)
+                {
+                    LogError("Failed unregistering device while destroying the transport");
+                    break;
+                }
             }
 
-            singlylinkedlist_destroy(instance->registered_devices);
+            free(instance->registered_devices);
         }
 
-        if (instance->amqp_connection != NULL)
+        for (i = 0; i < MAX_NUMBER_OF_AMQP_CONNECTIONS; i++)
         {
-            amqp_connection_destroy(instance->amqp_connection);
+            destroy_amqp_connection(&instance->connections[i]);
+
+            if (instance->connections[i].retry_control != NULL)
+            {
+                retry_control_destroy(instance->connections[i].retry_control);
+            }
         }
 
-        destroy_underlying_io_transport(instance);
         destroy_underlying_io_transport_options(instance);
-        retry_control_destroy(instance->connection_retry_control);
 
         STRING_delete(instance->iothub_host_fqdn);
 
@@ -1415,32 +1738,38 @@ TRANSPORT_LL_HANDLE IoTHubTransport_AMQP_Common_Create(const IOTHUBTRANSPORT_CON
         }
         else
         {
+            size_t i;
+
             memset(instance, 0, sizeof(AMQP_TRANSPORT_INSTANCE));
-            instance->amqp_connection_state = AMQP_CONNECTION_STATE_CLOSED;
+
+            for (i = 0; i < MAX_NUMBER_OF_AMQP_CONNECTIONS; i++)
+            {
+                instance->connections[i].transport_instance = instance;
+                instance->connections[i].amqp_connection_state = AMQP_CONNECTION_STATE_CLOSED;
+            }
+
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_161: [`instance->number_of_connections` shall be set to DEFAULT_NUMBER_OF_AMQP_CONNECTIONS]
+            instance->number_of_connections = DEFAULT_NUMBER_OF_AMQP_CONNECTIONS;
             instance->preferred_authentication_mode = AMQP_TRANSPORT_AUTHENTICATION_MODE_NOT_SET;
             instance->state = AMQP_TRANSPORT_STATE_NOT_CONNECTED;
             instance->authorization_module = config->auth_module_handle;
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_171: [`instance->retry_policy` and `instance->retry_timeout_limit_in_secs` shall be set with the defaults EXPONENTIAL_BACKOFF_WITH_JITTER and 0]
+            instance->retry_policy = DEFAULT_RETRY_POLICY;
+            instance->retry_timeout_limit_in_secs = DEFAULT_MAX_RETRY_TIME_IN_SECS;
 
-            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_124: [`instance->connection_retry_control` shall be set using retry_control_create(), passing defaults EXPONENTIAL_BACKOFF_WITH_JITTER and 0]
-            if ((instance->connection_retry_control = retry_control_create(DEFAULT_RETRY_POLICY, DEFAULT_MAX_RETRY_TIME_IN_SECS)) == NULL)
-            {
-                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_125: [If retry_control_create() fails, IoTHubTransport_AMQP_Common_Create shall fail and return NULL]
-                LogError("Failed to create the connection retry control.");
-                result = NULL;
-            }
             // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_005: [If `config->upperConfig->protocolGatewayHostName` is NULL, `instance->iothub_target_fqdn` shall be set as `config->upperConfig->iotHubName` + "." + `config->upperConfig->iotHubSuffix`]
             // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_006: [If `config->upperConfig->protocolGatewayHostName` is not NULL, `instance->iothub_target_fqdn` shall be set with a copy of it]
-            else if ((instance->iothub_host_fqdn = get_target_iothub_fqdn(config)) == NULL)
+            if ((instance->iothub_host_fqdn = get_target_iothub_fqdn(config)) == NULL)
             {
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_007: [If `instance->iothub_target_fqdn` fails to be set, IoTHubTransport_AMQP_Common_Create shall fail and return NULL]
                 LogError("Failed to obtain the iothub target fqdn.");
                 result = NULL;
             }
-            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_008: [`instance->registered_devices` shall be set using singlylinkedlist_create()]
-            else if ((instance->registered_devices = singlylinkedlist_create()) == NULL)
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_008: [`instance->registered_devices` shall be allocated using malloc() with an initial capacity of DEFAULT_REGISTERED_DEVICES_CAPACITY devices]
+            else if (create_device_registry(instance) != RESULT_OK)
             {
-                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_009: [If singlylinkedlist_create() fails, IoTHubTransport_AMQP_Common_Create shall fail and return NULL]
-                LogError("Failed to initialize the internal list of registered devices (singlylinkedlist_create failed)");
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_009: [If malloc() fails allocating `instance->registered_devices`, IoTHubTransport_AMQP_Common_Create shall fail and return NULL]
+                LogError("Failed to initialize the internal registry of devices");
                 result = NULL;
             }
             else
@@ -1450,6 +1779,7 @@ TRANSPORT_LL_HANDLE IoTHubTransport_AMQP_Common_Create(const IOTHUBTRANSPORT_CON
                 instance->is_trace_on = false;
                 instance->option_sas_token_lifetime_secs = DEFAULT_SAS_TOKEN_LIFETIME_SECS;
                 instance->option_sas_token_refresh_time_secs = DEFAULT_SAS_TOKEN_REFRESH_TIME_SECS;
+                instance->option_sas_token_refresh_jitter_secs = DEFAULT_SAS_TOKEN_REFRESH_JITTER_SECS;
                 instance->option_cbs_request_timeout_secs = DEFAULT_CBS_REQUEST_TIMEOUT_SECS;
                 instance->option_send_event_timeout_secs = DEFAULT_EVENT_SEND_TIMEOUT_SECS;
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_12_002: [The connection idle timeout parameter default value shall be set to 240000 milliseconds using connection_set_idle_timeout()]
@@ -1541,88 +1871,79 @@ void IoTHubTransport_AMQP_Common_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIEN
     else
     {
         AMQP_TRANSPORT_INSTANCE* transport_instance = (AMQP_TRANSPORT_INSTANCE*)handle;
-        LIST_ITEM_HANDLE list_item;
+        size_t i;
 
-        if (transport_instance->state == AMQP_TRANSPORT_STATE_NOT_CONNECTED_NO_MORE_RETRIES)
-        {
-            // Nothing to be done.
-        }
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_017: [If `instance->state` is `RECONNECTION_REQUIRED`, IoTHubTransport_AMQP_Common_DoWork shall attempt to trigger the connection-retry logic and return]
-        else if (transport_instance->state == AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED)
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_018: [If there are no devices registered on the transport, IoTHubTransport_AMQP_Common_DoWork shall skip do_work for devices]
+        if (transport_instance->number_of_registered_devices > 0)
         {
-            RETRY_ACTION retry_action;
-
-            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_126: [The connection retry shall be attempted only if retry_control_should_retry() returns RETRY_ACTION_NOW, or if it fails]
-            if (retry_control_should_retry(transport_instance->connection_retry_control, &retry_action) != RESULT_OK)
+            // We need to check if there are devices, otherwise the amqp_connection won't be able to be created since
+            // there is not a preferred authentication mode set yet on the transport.
+            for (i = 0; i < transport_instance->number_of_connections; i++)
             {
-                LogError("retry_control_should_retry() failed; assuming immediate connection retry for safety.");
-                retry_action = RETRY_ACTION_RETRY_NOW;
-            }
-
-            if (retry_action == RETRY_ACTION_RETRY_NOW)
-            {
-                prepare_for_connection_retry(transport_instance);
-            }
-            else if (retry_action == RETRY_ACTION_STOP_RETRYING)
-            {
-                update_state(transport_instance, AMQP_TRANSPORT_STATE_NOT_CONNECTED_NO_MORE_RETRIES);
-
-                (void)singlylinkedlist_foreach(transport_instance->registered_devices, raise_connection_status_callback_retry_expired, NULL);
-            }
-        }
-        else
-        {
-            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_018: [If there are no devices registered on the transport, IoTHubTransport_AMQP_Common_DoWork shall skip do_work for devices]
-            if ((list_item = singlylinkedlist_get_head_item(transport_instance->registered_devices)) != NULL)
-            {
-                // We need to check if there are devices, otherwise the amqp_connection won't be able to be created since
-                // there is not a preferred authentication mode set yet on the transport.
+                AMQP_TRANSPORT_CONNECTION* connection = &transport_instance->connections[i];
 
+                if (connection->state == AMQP_TRANSPORT_STATE_NOT_CONNECTED_NO_MORE_RETRIES)
+                {
+                    // Nothing to be done for this connection.
+                }
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_017: [If a connection is in state `RECONNECTION_REQUIRED`, IoTHubTransport_AMQP_Common_DoWork shall attempt to trigger the connection-retry logic of that connection only]
+                else if (connection->state == AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED)
+                {
+                    retry_amqp_connection(transport_instance, connection);
+                }
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_019: [If `instance->amqp_connection` is NULL, it shall be established]
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_12_003: [AMQP connection will be configured using the `svc2cl_keep_alive_timeout_secs` value from SetOption ]
-                if (transport_instance->amqp_connection == NULL && establish_amqp_connection(transport_instance) != RESULT_OK)
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_162: [Each of the `instance->number_of_connections` connections that has registered devices assigned shall be established independently]
+                else if (connection->number_of_registered_devices > 0 && connection->amqp_connection == NULL &&
+                    establish_amqp_connection(transport_instance, connection) != RESULT_OK)
                 {
                     LogError("AMQP transport failed to establish connection with service.");
 
-                    update_state(transport_instance, AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED);
+                    update_connection_state(connection, AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED);
                 }
+            }
+
+            for (i = 0; i < transport_instance->number_of_registered_devices; i++)
+            {
+                AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = transport_instance->registered_devices[i];
+
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_020: [If the amqp_connection is OPENED, the transport shall iterate through each registered device and perform a device-specific do_work on each]
-                else if (transport_instance->amqp_connection_state == AMQP_CONNECTION_STATE_OPENED)
+                // (devices of a connection waiting to be retried are skipped, the other connections are not affected)
+                if (registered_device->connection->amqp_connection_state != AMQP_CONNECTION_STATE_OPENED ||
+                    registered_device->connection->state != AMQP_TRANSPORT_STATE_CONNECTED)
                 {
-                    while (list_item != NULL)
-                    {
-                        AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device;
-
-                        if ((registered_device = (AMQP_TRANSPORT_DEVICE_INSTANCE*)singlylinkedlist_item_get_value(list_item)) == NULL)
-                        {
-                            LogError("Transport had an unexpected failure during DoWork (failed to fetch a registered_devices list item value)");
-                        }
-                        else if (registered_device->number_of_send_event_complete_failures >= MAX_NUMBER_OF_DEVICE_FAILURES)
-                        {
-                            LogError("Device '%s' reported a critical failure (events completed sending with failures); connection retry will be triggered.", STRING_c_str(registered_device->device_id));
+                    continue;
+                }
 
-                            update_state(transport_instance, AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED);
-                        }
-                        else if (IoTHubTransport_AMQP_Common_Device_DoWork(registered_device) != RESULT_OK)
-                        {
-                            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_021: [If DoWork fails for the registered device for more than MAX_NUMBER_OF_DEVICE_FAILURES, connection retry shall be triggered]
-                            if (registered_device->number_of_previous_failures >= MAX_NUMBER_OF_DEVICE_FAILURES)
-                            {
-                                LogError("Device '%s' reported a critical failure; connection retry will be triggered.", STRING_c_str(registered_device->device_id));
+                if (registered_device->number_of_send_event_complete_failures >= MAX_NUMBER_OF_DEVICE_FAILURES)
+                {
+                    LogError("Device '%s' reported a critical failure (events completed sending with failures); connection retry will be triggered.", STRING_c_str(registered_device->device_id));
 
-                                update_state(transport_instance, AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED);
-                            }
-                        }
+                    update_connection_state(registered_device->connection, AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED);
+                }
+                else if (IoTHubTransport_AMQP_Common_Device_DoWork(registered_device) != RESULT_OK)
+                {
+                    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_021: [If DoWork fails for the registered device for more than MAX_NUMBER_OF_DEVICE_FAILURES, connection retry shall be triggered]
+                    if (registered_device->number_of_previous_failures >= MAX_NUMBER_OF_DEVICE_FAILURES)
+                    {
+                        LogError("Device '%s' reported a critical failure; connection retry will be triggered.", STRING_c_str(registered_device->device_id));
 
-                        list_item = singlylinkedlist_get_next_item(list_item);
+                        update_connection_state(registered_device->connection, AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED);
                     }
                 }
             }
+        }
 
-            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_022: [If `instance->amqp_connection` is not NULL, amqp_connection_do_work shall be invoked]
-            if (transport_instance->amqp_connection != NULL)
+        for (i = 0; i < transport_instance->number_of_connections; i++)
+        {
+            AMQP_TRANSPORT_CONNECTION* connection = &transport_instance->connections[i];
+
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_022: [If `instance->amqp_connection` is not NULL, amqp_connection_do_work shall be invoked, unless the connection is waiting to be retried]
+            if (connection->amqp_connection != NULL &&
+                connection->state != AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED &&
+                connection->state != AMQP_TRANSPORT_STATE_NOT_CONNECTED_NO_MORE_RETRIES)
             {
-                amqp_connection_do_work(transport_instance->amqp_connection);
+                amqp_connection_do_work(connection->amqp_connection);
             }
         }
     }
@@ -1703,38 +2024,26 @@ int IoTHubTransport_AMQP_Common_Subscribe_DeviceTwin(IOTHUB_DEVICE_HANDLE handle
     {
         AMQP_TRANSPORT_INSTANCE* transport = (AMQP_TRANSPORT_INSTANCE*)handle;
 
-        if (get_number_of_registered_devices(transport) != 1)
+        if (transport->number_of_registered_devices != 1)
         {
             LogError("Device Twin not supported on device multiplexing scenario");
             result = __FAILURE__;
         }
         else
         {
-            LIST_ITEM_HANDLE list_item = singlylinkedlist_get_head_item(transport->registered_devices);
-
-            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_136: [If no errors occur, `IoTHubTransport_AMQP_Common_Subscribe_DeviceTwin` shall return zero.]
-            result = RESULT_OK;
+            AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = transport->registered_devices[0];
 
-            while (list_item != NULL)
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_134: [device_subscribe_for_twin_updates() shall be invoked for the registered device, passing `on_device_twin_update_received_callback`]
+            if (device_subscribe_for_twin_updates(registered_device->device_handle, on_device_twin_update_received_callback, (void*)registered_device) != RESULT_OK)
             {
-                AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device;
-
-                if ((registered_device = (AMQP_TRANSPORT_DEVICE_INSTANCE*)singlylinkedlist_item_get_value(list_item)) == NULL)
-                {
-                    LogError("Failed retrieving registered device information");
-                    result = __FAILURE__;
-                    break;
-                }
-                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_134: [device_subscribe_for_twin_updates() shall be invoked for the registered device, passing `on_device_twin_update_received_callback`]
-                else if (device_subscribe_for_twin_updates(registered_device->device_handle, on_device_twin_update_received_callback, (void*)registered_device) != RESULT_OK)
-                {
-                    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_135: [If device_subscribe_for_twin_updates() fails, `IoTHubTransport_AMQP_Common_Subscribe_DeviceTwin` shall fail and return non-zero.]
-                    LogError("Failed subscribing for device Twin updates");
-                    result = __FAILURE__;
-                    break;
-                }
-
-                list_item = singlylinkedlist_get_next_item(list_item);
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_135: [If device_subscribe_for_twin_updates() fails, `IoTHubTransport_AMQP_Common_Subscribe_DeviceTwin` shall fail and return non-zero.]
+                LogError("Failed subscribing for device Twin updates");
+                result = __FAILURE__;
+            }
+            else
+            {
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_136: [If no errors occur, `IoTHubTransport_AMQP_Common_Subscribe_DeviceTwin` shall return zero.]
+                result = RESULT_OK;
             }
         }
     }
@@ -1753,32 +2062,19 @@ void IoTHubTransport_AMQP_Common_Unsubscribe_DeviceTwin(IOTHUB_DEVICE_HANDLE han
     {
         AMQP_TRANSPORT_INSTANCE* transport = (AMQP_TRANSPORT_INSTANCE*)handle;
 
-        if (get_number_of_registered_devices(transport) != 1)
+        if (transport->number_of_registered_devices != 1)
         {
             LogError("Device Twin not supported on device multiplexing scenario");
         }
         else
         {
-            LIST_ITEM_HANDLE list_item = singlylinkedlist_get_head_item(transport->registered_devices);
+            AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = transport->registered_devices[0];
 
-            while (list_item != NULL)
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_142: [device_unsubscribe_for_twin_updates() shall be invoked for the registered device]
+            if (device_unsubscribe_for_twin_updates(registered_device->device_handle) != RESULT_OK)
             {
-                AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device;
-
-                if ((registered_device = (AMQP_TRANSPORT_DEVICE_INSTANCE*)singlylinkedlist_item_get_value(list_item)) == NULL)
-                {
-                    LogError("Failed retrieving registered device information");
-                    break;
-                }
-                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_142: [device_unsubscribe_for_twin_updates() shall be invoked for the registered device]
-                else if (device_unsubscribe_for_twin_updates(registered_device->device_handle) != RESULT_OK)
-                {
-                    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_143: [If `device_unsubscribe_for_twin_updates` fails, the error shall be ignored]
-                    LogError("Failed unsubscribing for device Twin updates");
-                    break;
-                }
-
-                list_item = singlylinkedlist_get_next_item(list_item);
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_143: [If `device_unsubscribe_for_twin_updates` fails, the error shall be ignored]
+                LogError("Failed unsubscribing for device Twin updates");
             }
         }
     }
@@ -1933,6 +2229,11 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_SetOption(TRANSPORT_LL_HANDLE h
             is_device_specific_option = true;
             transport_instance->option_cbs_request_timeout_secs = *(size_t*)value;
         }
+        else if (strcmp(OPTION_SAS_TOKEN_REFRESH_JITTER, option) == 0)
+        {
+            is_device_specific_option = true;
+            transport_instance->option_sas_token_refresh_jitter_secs = *(size_t*)value;
+        }
         else if (strcmp(OPTION_EVENT_SEND_TIMEOUT_SECS, option) == 0)
         {
             is_device_specific_option = true;
@@ -1976,28 +2277,47 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_SetOption(TRANSPORT_LL_HANDLE h
             }
             
         }
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_104: [If `option` is `logtrace`, `value` shall be saved and applied to `instance->connection` using amqp_connection_set_logging()]
-        else if (strcmp(OPTION_LOG_TRACE, option) == 0)
+        else if (strcmp(OPTION_AMQP_CONNECTION_COUNT, option) == 0)
         {
-            transport_instance->is_trace_on = *((bool*)value);
+            size_t number_of_connections = *(size_t*)value;
 
-            if (transport_instance->amqp_connection != NULL &&
-                amqp_connection_set_logging(transport_instance->amqp_connection, transport_instance->is_trace_on) != RESULT_OK)
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_163: [If `option` is `amqp_connection_count` and `value` is zero or greater than MAX_NUMBER_OF_AMQP_CONNECTIONS, IoTHubTransport_AMQP_Common_SetOption shall fail and return IOTHUB_CLIENT_INVALID_ARG]
+            if (number_of_connections == 0 || number_of_connections > MAX_NUMBER_OF_AMQP_CONNECTIONS)
             {
-                LogError("transport failed setting option '%s' (amqp_connection_set_logging failed)", option);
-                result = IOTHUB_CLIENT_ERROR;
+                LogError("Invalid number of AMQP connections %lu (must be between 1 and %d)", (unsigned long)number_of_connections, MAX_NUMBER_OF_AMQP_CONNECTIONS);
+                result = IOTHUB_CLIENT_INVALID_ARG;
             }
             else
             {
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_164: [If `option` is `amqp_connection_count`, the registered devices shall be re-assigned to the new number of connections, stopping only the devices whose connection changes]
+                set_number_of_amqp_connections(transport_instance, number_of_connections);
                 result = IOTHUB_CLIENT_OK;
             }
         }
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_104: [If `option` is `logtrace`, `value` shall be saved and applied to `instance->connection` using amqp_connection_set_logging()]
+        else if (strcmp(OPTION_LOG_TRACE, option) == 0)
+        {
+            size_t i;
+
+            transport_instance->is_trace_on = *((bool*)value);
+            result = IOTHUB_CLIENT_OK;
+
+            for (i = 0; i < transport_instance->number_of_connections; i++)
+            {
+                if (transport_instance->connections[i].amqp_connection != NULL &&
+                    amqp_connection_set_logging(transport_instance->connections[i].amqp_connection, transport_instance->is_trace_on) != RESULT_OK)
+                {
+                    LogError("transport failed setting option '%s' (amqp_connection_set_logging failed)", option);
+                    result = IOTHUB_CLIENT_ERROR;
+                }
+            }
+        }
         else if (strcmp(OPTION_HTTP_PROXY, option) == 0)
         {
             /* Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_01_032: [ If `option` is `proxy_data`, `value` shall be used as an `HTTP_PROXY_OPTIONS*`. ]*/
             HTTP_PROXY_OPTIONS* proxy_options = (HTTP_PROXY_OPTIONS*)value;
 
-            if (transport_instance->tls_io != NULL)
+            if (is_any_underlying_io_transport_created(transport_instance))
             {
                 /* Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_01_038: [ If the underlying IO has already been created, then `IoTHubTransport_AMQP_Common_SetOption` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
                 LogError("Cannot set proxy option once the underlying IO is created");
@@ -2091,27 +2411,29 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_SetOption(TRANSPORT_LL_HANDLE h
             if (result != IOTHUB_CLIENT_INVALID_ARG)
             {
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_106: [If `instance->tls_io` is NULL, it shall be set invoking instance->underlying_io_transport_provider()]
-                if (transport_instance->tls_io == NULL &&
-                    get_new_underlying_io_transport(transport_instance, &transport_instance->tls_io) != RESULT_OK)
+                if (transport_instance->connections[0].tls_io == NULL &&
+                    get_new_underlying_io_transport(transport_instance, &transport_instance->connections[0].tls_io) != RESULT_OK)
                 {
                     // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_107: [If instance->underlying_io_transport_provider() fails, IoTHubTransport_AMQP_Common_SetOption shall fail and return IOTHUB_CLIENT_ERROR]
                     LogError("transport failed setting option '%s' (failed to obtain a TLS I/O transport).", option);
                     result = IOTHUB_CLIENT_ERROR;
                 }
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_108: [When `instance->tls_io` is created, IoTHubTransport_AMQP_Common_SetOption shall apply `instance->saved_tls_options` with OptionHandler_FeedOptions()]
-                else if (xio_setoption(transport_instance->tls_io, option, value) != RESULT_OK)
+                else if (set_underlying_io_transport_option(transport_instance, option, value) != RESULT_OK)
                 {
                     // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_03_001: [If xio_setoption fails, IoTHubTransport_AMQP_Common_SetOption shall return IOTHUB_CLIENT_ERROR.]
                     LogError("transport failed setting option '%s' (xio_setoption failed)", option);
                     result = IOTHUB_CLIENT_ERROR;
                 }
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_166: [After the option is applied, the options of the TLS I/O shall be saved in `instance->saved_tls_options` using xio_retrieveoptions(), so the TLS I/O of every connection established later is set with them]
+                else if (save_underlying_io_transport_options(transport_instance) != RESULT_OK)
+                {
+                    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_167: [If xio_retrieveoptions() fails, IoTHubTransport_AMQP_Common_SetOption shall fail and return IOTHUB_CLIENT_ERROR]
+                    LogError("transport failed setting option '%s' (failed to save the underlying I/O options for the other connections)", option);
+                    result = IOTHUB_CLIENT_ERROR;
+                }
                 else
                 {
-                    if (save_underlying_io_transport_options(transport_instance) != RESULT_OK)
-                    {
-                        LogError("IoTHubTransport_AMQP_Common_SetOption failed to save underlying I/O options; failure will be ignored");
-                    }
-
                     // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_03_001: [If no failures occur, IoTHubTransport_AMQP_Common_SetOption shall return IOTHUB_CLIENT_OK.]
                     result = IOTHUB_CLIENT_OK;
                 }
@@ -2145,11 +2467,10 @@ IOTHUB_DEVICE_HANDLE IoTHubTransport_AMQP_Common_Register(TRANSPORT_LL_HANDLE ha
     }
     else
     {
-        LIST_ITEM_HANDLE list_item;
         AMQP_TRANSPORT_INSTANCE* transport_instance = (AMQP_TRANSPORT_INSTANCE*)handle;
 
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_064: [If the device is already registered, IoTHubTransport_AMQP_Common_Register shall fail and return NULL.]
-        if (is_device_registered_ex(transport_instance->registered_devices, device->deviceId, &list_item))
+        if (find_registered_device(transport_instance, device->deviceId) != NULL)
         {
             LogError("IoTHubTransport_AMQP_Common_Register failed (device '%s' already registered on this transport instance)", device->deviceId);
             result = NULL;
@@ -2194,6 +2515,7 @@ IOTHUB_DEVICE_HANDLE IoTHubTransport_AMQP_Common_Register(TRANSPORT_LL_HANDLE ha
                 amqp_device_instance->max_state_change_timeout_secs = DEFAULT_DEVICE_STATE_CHANGE_TIMEOUT_SECS;
                 amqp_device_instance->subscribe_methods_needed = false;
                 amqp_device_instance->subscribed_for_methods = false;
+                amqp_device_instance->device_id_hash = iothub_client_hash_string(device->deviceId);
 
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_069: [A copy of `config->deviceId` shall be saved into `device_state->device_id`]
                 if ((amqp_device_instance->device_id = STRING_construct(device->deviceId)) == NULL)
@@ -2224,7 +2546,7 @@ IOTHUB_DEVICE_HANDLE IoTHubTransport_AMQP_Common_Register(TRANSPORT_LL_HANDLE ha
                     }
                     else
                     {
-                        bool is_first_device_being_registered = (singlylinkedlist_get_head_item(transport_instance->registered_devices) == NULL);
+                        bool is_first_device_being_registered = (transport_instance->number_of_registered_devices == 0);
 
                         /* Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_01_010: [ `IoTHubTransport_AMQP_Common_Create` shall create a new iothubtransportamqp_methods instance by calling `iothubtransportamqp_methods_create` while passing to it the the fully qualified domain name and the device Id. ]*/
                         amqp_device_instance->methods_handle = iothubtransportamqp_methods_create(STRING_c_str(transport_instance->iothub_host_fqdn), device->deviceId);
@@ -2242,14 +2564,18 @@ IOTHUB_DEVICE_HANDLE IoTHubTransport_AMQP_Common_Register(TRANSPORT_LL_HANDLE ha
                                 result = NULL;
                             }
                             // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_074: [IoTHubTransport_AMQP_Common_Register shall add the `amqp_device_instance` to `instance->registered_devices`]
-                            else if (singlylinkedlist_add(transport_instance->registered_devices, amqp_device_instance) == NULL)
+                            else if (add_registered_device(transport_instance, amqp_device_instance) != RESULT_OK)
                             {
                                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_075: [If it fails to add `amqp_device_instance`, IoTHubTransport_AMQP_Common_Register shall fail and return NULL]
-                                LogError("Transport failed to register device '%s' (singlylinkedlist_add failed)", device->deviceId);
+                                LogError("Transport failed to register device '%s' (failed adding it to the registry of devices)", device->deviceId);
                                 result = NULL;
                             }
                             else
                             {
+                                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_165: [The device shall be assigned to one of the `instance->number_of_connections` AMQP connections based on the hash of its device id]
+                                assign_device_to_connection(amqp_device_instance,
+                                    &transport_instance->connections[get_connection_index_for_device(amqp_device_instance->device_id_hash, transport_instance->number_of_connections)]);
+
                                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_076: [If the device is the first being registered on the transport, IoTHubTransport_AMQP_Common_Register shall save its authentication mode as the transport preferred authentication mode]
                                 if (transport_instance->preferred_authentication_mode == AMQP_TRANSPORT_AUTHENTICATION_MODE_NOT_SET &&
                                     is_first_device_being_registered)
@@ -2295,7 +2621,6 @@ void IoTHubTransport_AMQP_Common_Unregister(IOTHUB_DEVICE_HANDLE deviceHandle)
     {
         AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = (AMQP_TRANSPORT_DEVICE_INSTANCE*)deviceHandle;
         const char* device_id;
-        LIST_ITEM_HANDLE list_item;
 
         if ((device_id = STRING_c_str(registered_device->device_id)) == NULL)
         {
@@ -2307,22 +2632,30 @@ void IoTHubTransport_AMQP_Common_Unregister(IOTHUB_DEVICE_HANDLE deviceHandle)
             LogError("Failed to unregister device '%s' (deviceHandle does not have a transport state associated to).", device_id);
         }
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_081: [If the device is not registered with this transport, IoTHubTransport_AMQP_Common_Unregister shall return]
-        else if (!is_device_registered_ex(registered_device->transport_instance->registered_devices, device_id, &list_item))
+        else if (find_registered_device(registered_device->transport_instance, device_id) != registered_device)
         {
             LogError("Failed to unregister device '%s' (device is not registered within this transport).", device_id);
         }
         else
         {
             // Removing it first so the race hazzard is reduced between this function and DoWork. Best would be to use locks.
-            if (singlylinkedlist_remove(registered_device->transport_instance->registered_devices, list_item) != RESULT_OK)
-            {
-                LogError("Failed to unregister device '%s' (singlylinkedlist_remove failed).", device_id);
-            }
-            else
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_082: [`device_instance` shall be removed from `instance->registered_devices`]
+            AMQP_TRANSPORT_INSTANCE* transport_instance = registered_device->transport_instance;
+            AMQP_TRANSPORT_CONNECTION* connection = registered_device->connection;
+
+            remove_registered_device(transport_instance, registered_device);
+            assign_device_to_connection(registered_device, NULL);
+
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_01_012: [IoTHubTransport_AMQP_Common_Unregister shall destroy the C2D methods handler by calling iothubtransportamqp_methods_destroy]
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_083: [IoTHubTransport_AMQP_Common_Unregister shall free all the memory allocated for the `device_instance`]
+            internal_destroy_amqp_device_instance(registered_device);
+
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_168: [If no other registered device is assigned to the connection of `device_instance`, its amqp_connection and TLS I/O shall be destroyed, unless the transport is being destroyed]
+            // (the connection is established again on DoWork if a device gets assigned to it later; IoTHubTransport_AMQP_Common_Destroy tears down all connections by itself)
+            if (connection != NULL && connection->number_of_registered_devices == 0 &&
+                transport_instance->state != AMQP_TRANSPORT_STATE_BEING_DESTROYED)
             {
-                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_01_012: [IoTHubTransport_AMQP_Common_Unregister shall destroy the C2D methods handler by calling iothubtransportamqp_methods_destroy]
-                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_083: [IoTHubTransport_AMQP_Common_Unregister shall free all the memory allocated for the `device_instance`]
-                internal_destroy_amqp_device_instance(registered_device);
+                destroy_amqp_connection(connection);
             }
         }
     }
@@ -2355,31 +2688,60 @@ int IoTHubTransport_AMQP_Common_SetRetryPolicy(TRANSPORT_LL_HANDLE handle, IOTHU
     }
     else
     {
-        RETRY_CONTROL_HANDLE new_retry_control;
+        AMQP_TRANSPORT_INSTANCE* transport_instance = (AMQP_TRANSPORT_INSTANCE*)handle;
+        RETRY_CONTROL_HANDLE new_retry_controls[MAX_NUMBER_OF_AMQP_CONNECTIONS];
+        size_t i;
 
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_129: [`transport_instance->connection_retry_control` shall be set using retry_control_create(), passing `retryPolicy` and `retryTimeoutLimitInSeconds`.]
-        if ((new_retry_control = retry_control_create(retryPolicy, (unsigned int)retryTimeoutLimitInSeconds)) == NULL)
+        result = RESULT_OK;
+
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_129: [Each connection that has a retry control shall get a new one created using retry_control_create(), passing `retryPolicy` and `retryTimeoutLimitInSeconds`.]
+        for (i = 0; i < MAX_NUMBER_OF_AMQP_CONNECTIONS; i++)
         {
-            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_130: [If retry_control_create() fails, `IoTHubTransport_AMQP_Common_SetRetryPolicy` shall fail and return non-zero.]
-            LogError("Cannot set retry policy (retry_control_create failed)");
-            result = __FAILURE__;
+            new_retry_controls[i] = NULL;
+
+            if (result == RESULT_OK && transport_instance->connections[i].retry_control != NULL &&
+                (new_retry_controls[i] = retry_control_create(retryPolicy, (unsigned int)retryTimeoutLimitInSeconds)) == NULL)
+            {
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_130: [If retry_control_create() fails, `IoTHubTransport_AMQP_Common_SetRetryPolicy` shall fail and return non-zero.]
+                LogError("Cannot set retry policy (retry_control_create failed)");
+                result = __FAILURE__;
+            }
         }
-        else
+
+        for (i = 0; i < MAX_NUMBER_OF_AMQP_CONNECTIONS; i++)
         {
-            AMQP_TRANSPORT_INSTANCE* transport_instance = (AMQP_TRANSPORT_INSTANCE*)handle;
-            RETRY_CONTROL_HANDLE previous_retry_control = transport_instance->connection_retry_control;
+            AMQP_TRANSPORT_CONNECTION* connection = &transport_instance->connections[i];
 
-            transport_instance->connection_retry_control = new_retry_control;
+            if (new_retry_controls[i] == NULL)
+            {
+                // Connection never failed, or the new retry controls are being rolled back.
+            }
+            else if (result != RESULT_OK)
+            {
+                retry_control_destroy(new_retry_controls[i]);
+            }
+            else
+            {
+                retry_control_destroy(connection->retry_control);
+                connection->retry_control = new_retry_controls[i];
+            }
+        }
 
-            retry_control_destroy(previous_retry_control);
+        if (result == RESULT_OK)
+        {
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_172: [`retryPolicy` and `retryTimeoutLimitInSeconds` shall be saved in `transport_instance`, and used for retry controls of connections that fail later]
+            transport_instance->retry_policy = retryPolicy;
+            transport_instance->retry_timeout_limit_in_secs = retryTimeoutLimitInSeconds;
 
-            if (transport_instance->state == AMQP_TRANSPORT_STATE_NOT_CONNECTED_NO_MORE_RETRIES)
+            for (i = 0; i < MAX_NUMBER_OF_AMQP_CONNECTIONS; i++)
             {
-                transport_instance->state = AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED;
+                if (transport_instance->connections[i].state == AMQP_TRANSPORT_STATE_NOT_CONNECTED_NO_MORE_RETRIES)
+                {
+                    update_connection_state(&transport_instance->connections[i], AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED);
+                }
             }
 
             // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_128: [If no errors occur, `IoTHubTransport_AMQP_Common_SetRetryPolicy` shall return zero.]
-            result = RESULT_OK;
         }
     }
 
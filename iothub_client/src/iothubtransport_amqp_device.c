@@ -1380,7 +1380,8 @@ int device_set_option(AMQP_DEVICE_HANDLE handle, const char* name, void* value)
 
         if (strcmp(DEVICE_OPTION_CBS_REQUEST_TIMEOUT_SECS, name) == 0 ||
             strcmp(DEVICE_OPTION_SAS_TOKEN_REFRESH_TIME_SECS, name) == 0 ||
-            strcmp(DEVICE_OPTION_SAS_TOKEN_LIFETIME_SECS, name) == 0)
+            strcmp(DEVICE_OPTION_SAS_TOKEN_LIFETIME_SECS, name) == 0 ||
+            strcmp(DEVICE_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, name) == 0)
         {
             // Codes_SRS_DEVICE_09_083: [If `name` refers to authentication but CBS authentication is not used, device_set_option shall return a non-zero result]
             if (instance->authentication_handle == NULL)
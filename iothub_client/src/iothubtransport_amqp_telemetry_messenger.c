@@ -37,6 +37,7 @@
 #define STRING_NULL_TERMINATOR                          '\0'
 
 #define AMQP_BATCHING_FORMAT_CODE 0x80013700
+#define MESSENGER_PRIORITY_COUNT                        (IOTHUB_MESSAGE_PRIORITY_HIGH + 1)
  
 typedef struct TELEMETRY_MESSENGER_INSTANCE_TAG
 {
@@ -44,6 +45,7 @@ typedef struct TELEMETRY_MESSENGER_INSTANCE_TAG
     STRING_HANDLE product_info;
     STRING_HANDLE iothub_host_fqdn;
     SINGLYLINKEDLIST_HANDLE waiting_to_send;   // List of MESSENGER_SEND_EVENT_CALLER_INFORMATION's
+    size_t waiting_to_send_count[MESSENGER_PRIORITY_COUNT]; // Number of items in waiting_to_send per IOTHUB_MESSAGE_PRIORITY
     SINGLYLINKEDLIST_HANDLE in_progress_list;  // List of MESSENGER_SEND_EVENT_TASK's
     TELEMETRY_MESSENGER_STATE state;
     
@@ -76,6 +78,7 @@ typedef struct TELEMETRY_MESSENGER_INSTANCE_TAG
 typedef struct MESSENGER_SEND_EVENT_CALLER_INFORMATION_TAG
 {
     IOTHUB_MESSAGE_LIST* message;
+    IOTHUB_MESSAGE_PRIORITY priority;
     ON_TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE on_event_send_complete_callback;
     void* context;
 } MESSENGER_SEND_EVENT_CALLER_INFORMATION;
@@ -864,7 +867,7 @@ static int copy_events_to_list(SINGLYLINKEDLIST_HANDLE from_list, SINGLYLINKEDLI
     return result;
 }
 
-static int copy_events_from_in_progress_to_waiting_list(TELEMETRY_MESSENGER_INSTANCE* instance, SINGLYLINKEDLIST_HANDLE to_list)
+static int copy_events_from_in_progress_to_waiting_list(TELEMETRY_MESSENGER_INSTANCE* instance, SINGLYLINKEDLIST_HANDLE to_list, size_t* copied_count)
 {
     int result;
     LIST_ITEM_HANDLE list_task_item;
@@ -892,6 +895,8 @@ static int copy_events_from_in_progress_to_waiting_list(TELEMETRY_MESSENGER_INST
                 break;
             }
 
+            copied_count[caller_information->priority]++;
+
             list_caller_item = singlylinkedlist_get_next_item(list_caller_item);
         }
         
@@ -921,6 +926,9 @@ static int move_events_to_wait_to_send_list(TELEMETRY_MESSENGER_INSTANCE* instan
     else
     {
         SINGLYLINKEDLIST_HANDLE new_wait_to_send_list;
+        size_t moved_count[MESSENGER_PRIORITY_COUNT];
+
+        memset(moved_count, 0, sizeof(moved_count));
 
         if ((new_wait_to_send_list = singlylinkedlist_create()) == NULL)
         {
@@ -931,7 +939,7 @@ static int move_events_to_wait_to_send_list(TELEMETRY_MESSENGER_INSTANCE* instan
         {
             SINGLYLINKEDLIST_HANDLE new_in_progress_list;
         
-            if (copy_events_from_in_progress_to_waiting_list(instance, new_wait_to_send_list) != RESULT_OK)
+            if (copy_events_from_in_progress_to_waiting_list(instance, new_wait_to_send_list, moved_count) != RESULT_OK)
             {
                 LogError("Failed moving events back to wait_to_send list (failed adding in_progress_list items to new_wait_to_send_list)");
                 singlylinkedlist_destroy(new_wait_to_send_list);
@@ -951,6 +959,13 @@ static int move_events_to_wait_to_send_list(TELEMETRY_MESSENGER_INSTANCE* instan
             }
             else 
             {
+                size_t i;
+
+                for (i = 0; i < MESSENGER_PRIORITY_COUNT; i++)
+                {
+                    instance->waiting_to_send_count[i] += moved_count[i];
+                }
+
                 singlylinkedlist_destroy(instance->waiting_to_send);
                 singlylinkedlist_destroy(instance->in_progress_list);
                 instance->waiting_to_send = new_wait_to_send_list;
@@ -1049,6 +1064,18 @@ static void internal_on_event_send_complete_callback(void* context, MESSAGE_SEND
     }
 }
 
+static IOTHUB_MESSAGE_PRIORITY get_highest_waiting_priority(TELEMETRY_MESSENGER_INSTANCE* instance)
+{
+    size_t i = MESSENGER_PRIORITY_COUNT - 1;
+
+    while (i > 0 && instance->waiting_to_send_count[i] == 0)
+    {
+        i--;
+    }
+
+    return (IOTHUB_MESSAGE_PRIORITY)i;
+}
+
 static MESSENGER_SEND_EVENT_CALLER_INFORMATION* get_next_caller_message_to_send(TELEMETRY_MESSENGER_INSTANCE* instance)
 {
     MESSENGER_SEND_EVENT_CALLER_INFORMATION* caller_info;
@@ -1060,12 +1087,27 @@ static MESSENGER_SEND_EVENT_CALLER_INFORMATION* get_next_caller_message_to_send(
     }
     else
     {
+        IOTHUB_MESSAGE_PRIORITY highest_priority = get_highest_waiting_priority(instance);
+        LIST_ITEM_HANDLE next_item;
+
         caller_info = (MESSENGER_SEND_EVENT_CALLER_INFORMATION*)singlylinkedlist_item_get_value(list_item);
 
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_191: [The events shall be taken from `instance->waiting_to_send` in order of priority, and in the order they were added within the same priority]
+        while (caller_info->priority < highest_priority && (next_item = singlylinkedlist_get_next_item(list_item)) != NULL)
+        {
+            list_item = next_item;
+            caller_info = (MESSENGER_SEND_EVENT_CALLER_INFORMATION*)singlylinkedlist_item_get_value(list_item);
+        }
+
         if (singlylinkedlist_remove(instance->waiting_to_send, list_item) != RESULT_OK)
         {
             LogError("Failed removing item from waiting_to_send list (singlylinkedlist_remove failed)");
         }
+
+        if (instance->waiting_to_send_count[caller_info->priority] > 0)
+        {
+            instance->waiting_to_send_count[caller_info->priority]--;
+        }
     }
 
     return caller_info;
@@ -1580,6 +1622,7 @@ int telemetry_messenger_send_async(TELEMETRY_MESSENGER_HANDLE messenger_handle,
     {
         MESSENGER_SEND_EVENT_CALLER_INFORMATION *caller_info;
         TELEMETRY_MESSENGER_INSTANCE *instance = (TELEMETRY_MESSENGER_INSTANCE*)messenger_handle;
+        IOTHUB_MESSAGE_PRIORITY priority;
 
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_137: [telemetry_messenger_send_async() shall allocate memory for a MESSENGER_SEND_EVENT_CALLER_INFORMATION structure]  
         if ((caller_info = (MESSENGER_SEND_EVENT_CALLER_INFORMATION*)malloc(sizeof(MESSENGER_SEND_EVENT_CALLER_INFORMATION))) == NULL)
@@ -1588,6 +1631,13 @@ int telemetry_messenger_send_async(TELEMETRY_MESSENGER_HANDLE messenger_handle,
             LogError("Failed sending event (failed to create struct for task; malloc failed)");
             result = __FAILURE__;
         }
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_190: [The priority of the event shall be obtained with IoTHubMessage_GetPriority() and kept with it in `instance->waiting_to_send`]
+        else if ((size_t)(priority = IoTHubMessage_GetPriority(message->messageHandle)) >= MESSENGER_PRIORITY_COUNT)
+        {
+            LogError("Failed sending event (invalid message priority %d)", priority);
+            result = __FAILURE__;
+            free(caller_info);
+        }
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_100: [`task` shall be added to `instance->waiting_to_send` using singlylinkedlist_add()]  
         else if (singlylinkedlist_add(instance->waiting_to_send, caller_info) == NULL)
         {
@@ -1603,8 +1653,10 @@ int telemetry_messenger_send_async(TELEMETRY_MESSENGER_HANDLE messenger_handle,
         {
             memset(caller_info, 0, sizeof(MESSENGER_SEND_EVENT_CALLER_INFORMATION));
             caller_info->message = message;
+            caller_info->priority = priority;
             caller_info->on_event_send_complete_callback = on_messenger_event_send_complete_callback;
             caller_info->context = context;
+            instance->waiting_to_send_count[priority]++;
             
             // Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_143: [If no failures occur, telemetry_messenger_send_async() shall return zero]  
             result = RESULT_OK;
@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include "azure_c_shared_utility/optimize_size.h"
@@ -14,8 +15,10 @@
 #include "azure_uamqp_c/amqp_definitions_fields.h"
 #include "azure_uamqp_c/messaging.h"
 #include "iothub_client_private.h"
+#include "iothub_client_hash.h"
 #include "iothubtransport_amqp_messenger.h"
 #include "iothubtransport_amqp_twin_messenger.h"
+#include "parson.h"
 
 DEFINE_ENUM_STRINGS(TWIN_MESSENGER_SEND_STATUS, TWIN_MESSENGER_SEND_STATUS_VALUES);
 DEFINE_ENUM_STRINGS(TWIN_REPORT_STATE_RESULT, TWIN_REPORT_STATE_RESULT_VALUES);
@@ -49,6 +52,10 @@ DEFINE_ENUM_STRINGS(TWIN_UPDATE_TYPE, TWIN_UPDATE_TYPE_VALUES);
 #define DEFAULT_MAX_TWIN_SUBSCRIPTION_ERROR_COUNT		3
 #define DEFAULT_TWIN_OPERATION_TIMEOUT_SECS				300.0
 
+// Initial number of buckets of the index of `operations` by correlation-id; must be a power of 2.
+// The index doubles whenever the number of outstanding operations exceeds it, so lookups stay O(1) with any load.
+#define DEFAULT_TWIN_OPERATIONS_INDEX_SIZE				8
+
 static char* DEFAULT_TWIN_SEND_LINK_SOURCE_NAME =		"twin";
 static char* DEFAULT_TWIN_RECEIVE_LINK_TARGET_NAME =	"twin";
 
@@ -96,6 +103,12 @@ typedef struct TWIN_MESSENGER_INSTANCE_TAG
 
 	SINGLYLINKEDLIST_HANDLE pending_patches;
 	SINGLYLINKEDLIST_HANDLE operations;
+	// Items of `operations` indexed by the hash of their correlation-id, chained through `next_in_index`.
+	struct TWIN_OPERATION_CONTEXT_TAG** operations_index;
+	// Number of buckets in `operations_index`; always a power of 2.
+	size_t operations_index_size;
+	// Number of items currently in `operations_index`.
+	size_t operations_index_count;
 	
 	TWIN_MESSENGER_STATE_CHANGED_CALLBACK on_state_changed_callback;
 	void* on_state_changed_context;
@@ -116,6 +129,7 @@ typedef struct TWIN_PATCH_OPERATION_CONTEXT_TAG
 	TWIN_MESSENGER_REPORT_STATE_COMPLETE_CALLBACK on_report_state_complete_callback;
 	const void* on_report_state_complete_context;
 	time_t time_enqueued;
+	struct TWIN_PATCH_OPERATION_CONTEXT_TAG* next_in_batch;
 } TWIN_PATCH_OPERATION_CONTEXT;
 
 typedef struct TWIN_OPERATION_CONTEXT_TAG
@@ -123,11 +137,24 @@ typedef struct TWIN_OPERATION_CONTEXT_TAG
 	TWIN_OPERATION_TYPE type;
 	TWIN_MESSENGER_INSTANCE* msgr;
 	char* correlation_id;
+	size_t correlation_id_hash;
+	LIST_ITEM_HANDLE list_item;
+	struct TWIN_OPERATION_CONTEXT_TAG* next_in_index;
 	TWIN_MESSENGER_REPORT_STATE_COMPLETE_CALLBACK on_report_state_complete_callback;
 	const void* on_report_state_complete_context;
+	// Other reported state PATCHES merged into this request; their callbacks are invoked along with the one above.
+	TWIN_PATCH_OPERATION_CONTEXT* batched_patches;
 	time_t time_sent;
 } TWIN_OPERATION_CONTEXT;
 
+typedef struct TWIN_PATCH_BATCH_TAG
+{
+	TWIN_MESSENGER_INSTANCE* msgr;
+	TWIN_PATCH_OPERATION_CONTEXT* first_patch;
+	TWIN_PATCH_OPERATION_CONTEXT* last_patch;
+	JSON_Value* merged_patches;
+} TWIN_PATCH_BATCH;
+
 
 
 
@@ -394,6 +421,7 @@ static TWIN_OPERATION_CONTEXT* create_twin_operation_context(TWIN_MESSENGER_INST
 		}
 		else
 		{
+			result->correlation_id_hash = iothub_client_hash_string(result->correlation_id);
 			result->type = type;
 			result->msgr = twin_msgr;
 		}
@@ -402,10 +430,130 @@ static TWIN_OPERATION_CONTEXT* create_twin_operation_context(TWIN_MESSENGER_INST
 	return result;
 }
 
-static bool find_twin_operation_by_correlation_id(LIST_ITEM_HANDLE list_item, const void* match_context)
+static TWIN_OPERATION_CONTEXT** get_operations_index_bucket(TWIN_MESSENGER_INSTANCE* twin_msgr, size_t correlation_id_hash)
 {
-	TWIN_OPERATION_CONTEXT* twin_op_ctx = (TWIN_OPERATION_CONTEXT*)singlylinkedlist_item_get_value(list_item);
-	return (strcmp(twin_op_ctx->correlation_id, (const char*)match_context) == 0);
+	return &twin_msgr->operations_index[correlation_id_hash & (twin_msgr->operations_index_size - 1)];
+}
+
+static int create_operations_index(TWIN_MESSENGER_INSTANCE* twin_msgr)
+{
+	int result;
+	size_t index_size = DEFAULT_TWIN_OPERATIONS_INDEX_SIZE * sizeof(TWIN_OPERATION_CONTEXT*);
+
+	if ((twin_msgr->operations_index = (TWIN_OPERATION_CONTEXT**)malloc(index_size)) == NULL)
+	{
+		LogError("Failed allocating the index of TWIN operations (malloc failed)");
+		result = __FAILURE__;
+	}
+	else
+	{
+		memset(twin_msgr->operations_index, 0, index_size);
+		twin_msgr->operations_index_size = DEFAULT_TWIN_OPERATIONS_INDEX_SIZE;
+		twin_msgr->operations_index_count = 0;
+		result = RESULT_OK;
+	}
+
+	return result;
+}
+
+// @brief
+//     Doubles the number of buckets of the index and moves the operations into the new buckets.
+static int grow_operations_index(TWIN_MESSENGER_INSTANCE* twin_msgr)
+{
+	int result;
+	size_t new_index_size = 2 * twin_msgr->operations_index_size;
+	TWIN_OPERATION_CONTEXT** old_index = twin_msgr->operations_index;
+	size_t old_index_size = twin_msgr->operations_index_size;
+	TWIN_OPERATION_CONTEXT** new_index;
+
+	if (new_index_size > SIZE_MAX / sizeof(TWIN_OPERATION_CONTEXT*))
+	{
+		LogError("Failed growing the index of TWIN operations (maximum size reached)");
+		result = __FAILURE__;
+	}
+	else if ((new_index = (TWIN_OPERATION_CONTEXT**)malloc(new_index_size * sizeof(TWIN_OPERATION_CONTEXT*))) == NULL)
+	{
+		LogError("Failed growing the index of TWIN operations (malloc failed)");
+		result = __FAILURE__;
+	}
+	else
+	{
+		size_t i;
+
+		memset(new_index, 0, new_index_size * sizeof(TWIN_OPERATION_CONTEXT*));
+		twin_msgr->operations_index = new_index;
+		twin_msgr->operations_index_size = new_index_size;
+
+		for (i = 0; i < old_index_size; i++)
+		{
+			TWIN_OPERATION_CONTEXT* twin_op_ctx = old_index[i];
+
+			while (twin_op_ctx != NULL)
+			{
+				TWIN_OPERATION_CONTEXT* next_in_index = twin_op_ctx->next_in_index;
+				TWIN_OPERATION_CONTEXT** bucket = get_operations_index_bucket(twin_msgr, twin_op_ctx->correlation_id_hash);
+
+				twin_op_ctx->next_in_index = *bucket;
+				*bucket = twin_op_ctx;
+				twin_op_ctx = next_in_index;
+			}
+		}
+
+		free(old_index);
+		result = RESULT_OK;
+	}
+
+	return result;
+}
+
+static void add_twin_operation_context_to_index(TWIN_OPERATION_CONTEXT* twin_op_ctx)
+{
+	TWIN_MESSENGER_INSTANCE* twin_msgr = twin_op_ctx->msgr;
+	TWIN_OPERATION_CONTEXT** bucket;
+
+	// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_114: [When the number of TWIN requests in `twin_msgr->operations` exceeds the number of buckets of `twin_msgr->operations_index`, the index shall be rebuilt with twice as many buckets]
+	// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_115: [If rebuilding `twin_msgr->operations_index` fails, the TWIN request shall be added to the current buckets]
+	if (twin_msgr->operations_index_count == twin_msgr->operations_index_size)
+	{
+		(void)grow_operations_index(twin_msgr);
+	}
+
+	bucket = get_operations_index_bucket(twin_msgr, twin_op_ctx->correlation_id_hash);
+	twin_op_ctx->next_in_index = *bucket;
+	*bucket = twin_op_ctx;
+	twin_msgr->operations_index_count++;
+}
+
+static TWIN_OPERATION_CONTEXT* find_twin_operation_by_correlation_id(TWIN_MESSENGER_INSTANCE* twin_msgr, const char* correlation_id)
+{
+	size_t correlation_id_hash = iothub_client_hash_string(correlation_id);
+	TWIN_OPERATION_CONTEXT* twin_op_ctx = *get_operations_index_bucket(twin_msgr, correlation_id_hash);
+
+	while (twin_op_ctx != NULL &&
+		(twin_op_ctx->correlation_id_hash != correlation_id_hash || strcmp(twin_op_ctx->correlation_id, correlation_id) != 0))
+	{
+		twin_op_ctx = twin_op_ctx->next_in_index;
+	}
+
+	return twin_op_ctx;
+}
+
+static void remove_twin_operation_context_from_index(TWIN_OPERATION_CONTEXT* twin_op_ctx)
+{
+	TWIN_OPERATION_CONTEXT** bucket_link = get_operations_index_bucket(twin_op_ctx->msgr, twin_op_ctx->correlation_id_hash);
+
+	while (*bucket_link != NULL)
+	{
+		if (*bucket_link == twin_op_ctx)
+		{
+			*bucket_link = twin_op_ctx->next_in_index;
+			twin_op_ctx->next_in_index = NULL;
+			twin_op_ctx->msgr->operations_index_count--;
+			break;
+		}
+
+		bucket_link = &(*bucket_link)->next_in_index;
+	}
 }
 
 static bool find_twin_operation_by_type(LIST_ITEM_HANDLE list_item, const void* match_context)
@@ -414,8 +562,46 @@ static bool find_twin_operation_by_type(LIST_ITEM_HANDLE list_item, const void*
 	return (twin_op_ctx->type == *(TWIN_OPERATION_TYPE*)match_context);
 }
 
+static void invoke_twin_patch_callbacks(TWIN_PATCH_OPERATION_CONTEXT* twin_patch_ctx, TWIN_REPORT_STATE_RESULT result, TWIN_REPORT_STATE_REASON reason, int status_code)
+{
+	for (; twin_patch_ctx != NULL; twin_patch_ctx = twin_patch_ctx->next_in_batch)
+	{
+		if (twin_patch_ctx->on_report_state_complete_callback != NULL)
+		{
+			twin_patch_ctx->on_report_state_complete_callback(result, reason, status_code, twin_patch_ctx->on_report_state_complete_context);
+		}
+	}
+}
+
+static void destroy_twin_patches(TWIN_PATCH_OPERATION_CONTEXT* twin_patch_ctx)
+{
+	while (twin_patch_ctx != NULL)
+	{
+		TWIN_PATCH_OPERATION_CONTEXT* next_in_batch = twin_patch_ctx->next_in_batch;
+
+		if (twin_patch_ctx->data != NULL)
+		{
+			CONSTBUFFER_Destroy(twin_patch_ctx->data);
+		}
+
+		free(twin_patch_ctx);
+		twin_patch_ctx = next_in_batch;
+	}
+}
+
+static void invoke_report_state_complete_callbacks(TWIN_OPERATION_CONTEXT* twin_op_ctx, TWIN_REPORT_STATE_RESULT result, TWIN_REPORT_STATE_REASON reason, int status_code)
+{
+	if (twin_op_ctx->on_report_state_complete_callback != NULL)
+	{
+		twin_op_ctx->on_report_state_complete_callback(result, reason, status_code, twin_op_ctx->on_report_state_complete_context);
+	}
+
+	invoke_twin_patch_callbacks(twin_op_ctx->batched_patches, result, reason, status_code);
+}
+
 static void destroy_twin_operation_context(TWIN_OPERATION_CONTEXT* op_ctx)
 {
+	destroy_twin_patches(op_ctx->batched_patches);
 	free(op_ctx->correlation_id);
 	free(op_ctx);
 }
@@ -424,13 +610,14 @@ static int add_twin_operation_context_to_queue(TWIN_OPERATION_CONTEXT* twin_op_c
 {
 	int result;
 
-	if (singlylinkedlist_add(twin_op_ctx->msgr->operations, (const void*)twin_op_ctx) == NULL)
+	if ((twin_op_ctx->list_item = singlylinkedlist_add(twin_op_ctx->msgr->operations, (const void*)twin_op_ctx)) == NULL)
 	{
 		LogError("Failed adding TWIN operation context to queue (%s, %s)", ENUM_TO_STRING(TWIN_OPERATION_TYPE, twin_op_ctx->type), twin_op_ctx->correlation_id);
 		result = __FAILURE__;
 	}
 	else
 	{
+		add_twin_operation_context_to_index(twin_op_ctx);
 		result = RESULT_OK;
 	}
 
@@ -440,21 +627,26 @@ static int add_twin_operation_context_to_queue(TWIN_OPERATION_CONTEXT* twin_op_c
 static int remove_twin_operation_context_from_queue(TWIN_OPERATION_CONTEXT* twin_op_ctx)
 {
 	int result;
-	LIST_ITEM_HANDLE list_item;
 
-	if ((list_item = singlylinkedlist_find(twin_op_ctx->msgr->operations, find_twin_operation_by_correlation_id, (const void*)twin_op_ctx->correlation_id)) == NULL)
+	if (twin_op_ctx->list_item == NULL)
 	{
 		result = RESULT_OK;
 	}
-	else if (singlylinkedlist_remove(twin_op_ctx->msgr->operations, list_item) != 0)
-	{
-		LogError("Failed removing TWIN operation context from queue (%s, %s, %s)", 
-			twin_op_ctx->msgr->device_id, ENUM_TO_STRING(TWIN_OPERATION_TYPE, twin_op_ctx->type), twin_op_ctx->correlation_id);
-		result = __FAILURE__;
-	}
 	else
 	{
-		result = RESULT_OK;
+		remove_twin_operation_context_from_index(twin_op_ctx);
+
+		if (singlylinkedlist_remove(twin_op_ctx->msgr->operations, twin_op_ctx->list_item) != 0)
+		{
+			LogError("Failed removing TWIN operation context from queue (%s, %s, %s)", 
+				twin_op_ctx->msgr->device_id, ENUM_TO_STRING(TWIN_OPERATION_TYPE, twin_op_ctx->type), twin_op_ctx->correlation_id);
+			result = __FAILURE__;
+		}
+		else
+		{
+			twin_op_ctx->list_item = NULL;
+			result = RESULT_OK;
+		}
 	}
 
 	return result;
@@ -891,16 +1083,13 @@ static void on_amqp_send_complete_callback(AMQP_MESSENGER_SEND_RESULT result, AM
 			if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PATCH)
 			{
 				// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_095: [If operation is a reported state PATCH, if a failure occurs `on_report_state_complete_callback` shall be invoked with TWIN_REPORT_STATE_RESULT_ERROR, status code from the AMQP response and the saved context]  
-				if (twin_op_ctx->on_report_state_complete_callback != NULL)
-				{
-					TWIN_REPORT_STATE_RESULT callback_result;
-					TWIN_REPORT_STATE_REASON callback_reason;
+				TWIN_REPORT_STATE_RESULT callback_result;
+				TWIN_REPORT_STATE_REASON callback_reason;
 
-					callback_result = get_twin_messenger_result_from(result);
-					callback_reason = get_twin_messenger_reason_from(reason);
+				callback_result = get_twin_messenger_result_from(result);
+				callback_reason = get_twin_messenger_reason_from(reason);
 
-					twin_op_ctx->on_report_state_complete_callback(TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_NONE, 0, (void*)twin_op_ctx->on_report_state_complete_context);
-				}
+				invoke_report_state_complete_callbacks(twin_op_ctx, TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_NONE, 0);
 			}
 			else if (reason != AMQP_MESSENGER_REASON_MESSENGER_DESTROYED)
 			{
@@ -1044,10 +1233,7 @@ static bool remove_expired_twin_operation_request(const void* item, const void*
 			if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PATCH)
 			{
 				// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_081: [If a timed-out item is a reported property PATCH, `on_report_state_complete_callback` shall be invoked with RESULT_ERROR and REASON_TIMEOUT]  
-				if (twin_op_ctx->on_report_state_complete_callback != NULL)
-				{
-					twin_op_ctx->on_report_state_complete_callback(TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_TIMEOUT, 0, twin_op_ctx->on_report_state_complete_context);
-				}
+				invoke_report_state_complete_callbacks(twin_op_ctx, TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_TIMEOUT, 0);
 			}
 			else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_GET)
 			{
@@ -1074,6 +1260,7 @@ static bool remove_expired_twin_operation_request(const void* item, const void*
 				}
 			}
 
+			remove_twin_operation_context_from_index(twin_op_ctx);
 			destroy_twin_operation_context(twin_op_ctx);
 		}
 	}
@@ -1099,7 +1286,126 @@ static void process_timeouts(TWIN_MESSENGER_INSTANCE* twin_msgr)
 	}
 }
 
-static bool send_pending_twin_patch(const void* item, const void* match_context, bool* continue_processing)
+// @brief    Parses a reported state PATCH, which must be a JSON object to be merged with others.
+static JSON_Value* parse_twin_patch(CONSTBUFFER_HANDLE data)
+{
+	JSON_Value* result;
+	const CONSTBUFFER* data_buffer = CONSTBUFFER_GetContent(data);
+	char* json_string;
+
+	if ((json_string = (char*)malloc(data_buffer->size + 1)) == NULL)
+	{
+		LogError("Failed allocating buffer for parsing reported state");
+		result = NULL;
+	}
+	else
+	{
+		(void)memcpy(json_string, data_buffer->buffer, data_buffer->size);
+		json_string[data_buffer->size] = '\0';
+
+		if ((result = json_parse_string(json_string)) == NULL)
+		{
+			LogError("Reported state is not valid JSON; it will not be merged with other reported state PATCHES");
+		}
+		else if (json_value_get_type(result) != JSONObject)
+		{
+			LogError("Reported state is not a JSON object; it will not be merged with other reported state PATCHES");
+			json_value_free(result);
+			result = NULL;
+		}
+
+		free(json_string);
+	}
+
+	return result;
+}
+
+// @brief
+//     Verifies if applying `patch` after `batch` has the same effect as applying a single merge of both.
+//     That is not the case if `patch` has an object where `batch` has a non-object value (the service
+//     would replace the property with the object, while a merged object would be merged with the property).
+static bool is_twin_patch_mergeable(const JSON_Object* batch, const JSON_Object* patch)
+{
+	bool result = true;
+	size_t number_of_members = json_object_get_count(patch);
+	size_t i;
+
+	for (i = 0; result && i < number_of_members; i++)
+	{
+		JSON_Value* patch_member = json_object_get_value_at(patch, i);
+		JSON_Value* batch_member = json_object_get_value(batch, json_object_get_name(patch, i));
+
+		if (batch_member != NULL && json_value_get_type(patch_member) == JSONObject)
+		{
+			result = (json_value_get_type(batch_member) == JSONObject &&
+				is_twin_patch_mergeable(json_value_get_object(batch_member), json_value_get_object(patch_member)));
+		}
+	}
+
+	return result;
+}
+
+static int merge_twin_patch(JSON_Object* batch, const JSON_Object* patch)
+{
+	int result = RESULT_OK;
+	size_t number_of_members = json_object_get_count(patch);
+	size_t i;
+
+	for (i = 0; result == RESULT_OK && i < number_of_members; i++)
+	{
+		const char* name = json_object_get_name(patch, i);
+		JSON_Value* patch_member = json_object_get_value_at(patch, i);
+		JSON_Value* batch_member = json_object_get_value(batch, name);
+
+		if (batch_member != NULL && json_value_get_type(patch_member) == JSONObject)
+		{
+			result = merge_twin_patch(json_value_get_object(batch_member), json_value_get_object(patch_member));
+		}
+		else
+		{
+			JSON_Value* patch_member_copy;
+
+			if ((patch_member_copy = json_value_deep_copy(patch_member)) == NULL)
+			{
+				LogError("Failed copying reported property '%s'", name);
+				result = __FAILURE__;
+			}
+			else if (json_object_set_value(batch, name, patch_member_copy) != JSONSuccess)
+			{
+				LogError("Failed merging reported property '%s'", name);
+				json_value_free(patch_member_copy);
+				result = __FAILURE__;
+			}
+		}
+	}
+
+	return result;
+}
+
+static CONSTBUFFER_HANDLE create_twin_patch_batch_data(JSON_Value* merged_patches)
+{
+	CONSTBUFFER_HANDLE result;
+	char* json_string;
+
+	if ((json_string = json_serialize_to_string(merged_patches)) == NULL)
+	{
+		LogError("Failed serializing merged reported state PATCHES");
+		result = NULL;
+	}
+	else
+	{
+		if ((result = CONSTBUFFER_Create((const unsigned char*)json_string, strlen(json_string))) == NULL)
+		{
+			LogError("Failed creating buffer for merged reported state PATCHES");
+		}
+
+		json_free_serialized_string(json_string);
+	}
+
+	return result;
+}
+
+static bool add_pending_twin_patch_to_batch(const void* item, const void* match_context, bool* continue_processing)
 {
 	bool result;
 
@@ -1111,62 +1417,129 @@ static bool send_pending_twin_patch(const void* item, const void* match_context,
 	}
 	else
 	{
-		TWIN_MESSENGER_INSTANCE* twin_msgr = (TWIN_MESSENGER_INSTANCE*)match_context;
+		TWIN_PATCH_BATCH* batch = (TWIN_PATCH_BATCH*)match_context;
 		TWIN_PATCH_OPERATION_CONTEXT* twin_patch_ctx = (TWIN_PATCH_OPERATION_CONTEXT*)item;
-		TWIN_OPERATION_CONTEXT* twin_op_ctx;
 
-		if ((twin_op_ctx = create_twin_operation_context(twin_msgr, TWIN_OPERATION_TYPE_PATCH)) == NULL)
+		if (batch->first_patch == NULL)
 		{
-			LogError("Failed creating context for sending reported state (%s)", twin_msgr->device_id);
+			// A single PATCH is sent as provided, it only gets parsed if there is another one to merge it with.
+			batch->first_patch = twin_patch_ctx;
+			batch->last_patch = twin_patch_ctx;
+			result = true;
+		}
+		else if (batch->merged_patches == NULL &&
+			(batch->merged_patches = parse_twin_patch(batch->first_patch->data)) == NULL)
+		{
+			result = false;
+		}
+		else
+		{
+			JSON_Value* patch;
 
-			// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_061: [If any other failure occurs sending the PATCH request, `on_report_state_complete_callback` shall be invoked with RESULT_ERROR and REASON_INTERNAL_ERROR]
-			if (twin_patch_ctx->on_report_state_complete_callback != NULL)
+			if ((patch = parse_twin_patch(twin_patch_ctx->data)) == NULL)
 			{
-				twin_patch_ctx->on_report_state_complete_callback(TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_INTERNAL_ERROR, 0, twin_patch_ctx->on_report_state_complete_context);
+				result = false;
+			}
+			else
+			{
+				// If merging fails half-way the PATCH is still sent (by itself) on the next call to do_work;
+				// since applying the same PATCH twice has no additional effect, the batch remains valid.
+				if (!is_twin_patch_mergeable(json_value_get_object(batch->merged_patches), json_value_get_object(patch)) ||
+					merge_twin_patch(json_value_get_object(batch->merged_patches), json_value_get_object(patch)) != RESULT_OK)
+				{
+					result = false;
+				}
+				else
+				{
+					CONSTBUFFER_Destroy(twin_patch_ctx->data);
+					twin_patch_ctx->data = NULL;
+
+					batch->last_patch->next_in_batch = twin_patch_ctx;
+					batch->last_patch = twin_patch_ctx;
+					result = true;
+				}
+
+				json_value_free(patch);
 			}
 		}
+
+		// PATCHES are merged in the order they were reported, so stop at the first one that can't be merged.
+		*continue_processing = result;
+	}
+
+	return result;
+}
+
+static void send_twin_patch_batch(TWIN_PATCH_BATCH* batch)
+{
+	TWIN_MESSENGER_INSTANCE* twin_msgr = batch->msgr;
+	TWIN_PATCH_OPERATION_CONTEXT* twin_patch_ctx = batch->first_patch;
+	CONSTBUFFER_HANDLE data;
+	TWIN_OPERATION_CONTEXT* twin_op_ctx;
+
+	if (twin_patch_ctx->next_in_batch == NULL)
+	{
+		data = twin_patch_ctx->data;
+	}
+	else if ((data = create_twin_patch_batch_data(batch->merged_patches)) == NULL)
+	{
+		LogError("Failed creating merged reported state (%s)", twin_msgr->device_id);
+	}
+
+	if (data == NULL)
+	{
+		// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_061: [If any other failure occurs sending the PATCH request, `on_report_state_complete_callback` shall be invoked with RESULT_ERROR and REASON_INTERNAL_ERROR]
+		invoke_twin_patch_callbacks(twin_patch_ctx, TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_INTERNAL_ERROR, 0);
+	}
+	else if ((twin_op_ctx = create_twin_operation_context(twin_msgr, TWIN_OPERATION_TYPE_PATCH)) == NULL)
+	{
+		LogError("Failed creating context for sending reported state (%s)", twin_msgr->device_id);
+
+		// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_061: [If any other failure occurs sending the PATCH request, `on_report_state_complete_callback` shall be invoked with RESULT_ERROR and REASON_INTERNAL_ERROR]
+		invoke_twin_patch_callbacks(twin_patch_ctx, TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_INTERNAL_ERROR, 0);
+	}
+	else
+	{
+		twin_op_ctx->on_report_state_complete_callback = twin_patch_ctx->on_report_state_complete_callback;
+		twin_op_ctx->on_report_state_complete_context = twin_patch_ctx->on_report_state_complete_context;
+		// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_110: [The callbacks of all the PATCHES merged into the request shall be saved in the PATCH request context]
+		twin_op_ctx->batched_patches = twin_patch_ctx->next_in_batch;
+		twin_patch_ctx->next_in_batch = NULL;
+
 		// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_062: [If amqp_send_async() succeeds, the PATCH request shall be queued into `twin_msgr->operations`]
-		else if (add_twin_operation_context_to_queue(twin_op_ctx) != RESULT_OK)
+		if (add_twin_operation_context_to_queue(twin_op_ctx) != RESULT_OK)
 		{
 			LogError("Failed adding TWIN operation context to queue (%s)", twin_msgr->device_id);
 
 			// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_061: [If any other failure occurs sending the PATCH request, `on_report_state_complete_callback` shall be invoked with RESULT_ERROR and REASON_INTERNAL_ERROR]
-			if (twin_patch_ctx->on_report_state_complete_callback != NULL)
-			{
-				twin_patch_ctx->on_report_state_complete_callback(TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_INTERNAL_ERROR, 0, twin_patch_ctx->on_report_state_complete_context);
-			}
+			invoke_report_state_complete_callbacks(twin_op_ctx, TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_INTERNAL_ERROR, 0);
 
 			destroy_twin_operation_context(twin_op_ctx);
 		}
-		else
+		// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_059: [If reported property PATCH shall be sent as an uAMQP MESSAGE_HANDLE instance using amqp_send_async() passing `on_amqp_send_complete_callback`]
+		else if (send_twin_operation_request(twin_msgr, twin_op_ctx, data) != RESULT_OK)
 		{
-			twin_op_ctx->on_report_state_complete_callback = twin_patch_ctx->on_report_state_complete_callback;
-			twin_op_ctx->on_report_state_complete_context = twin_patch_ctx->on_report_state_complete_context;
-
-			// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_059: [If reported property PATCH shall be sent as an uAMQP MESSAGE_HANDLE instance using amqp_send_async() passing `on_amqp_send_complete_callback`]
-			if (send_twin_operation_request(twin_msgr, twin_op_ctx, twin_patch_ctx->data) != RESULT_OK)
-			{
-				LogError("Failed sending reported state (%s)", twin_msgr->device_id);
+			LogError("Failed sending reported state (%s)", twin_msgr->device_id);
 
-				// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_060: [If amqp_send_async() fails, `on_report_state_complete_callback` shall be invoked with RESULT_ERROR and REASON_FAIL_SENDING]
-				if (twin_patch_ctx->on_report_state_complete_callback != NULL)
-				{
-					twin_patch_ctx->on_report_state_complete_callback(TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_FAIL_SENDING, 0, twin_patch_ctx->on_report_state_complete_context);
-				}
+			// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_060: [If amqp_send_async() fails, `on_report_state_complete_callback` shall be invoked with RESULT_ERROR and REASON_FAIL_SENDING]
+			invoke_report_state_complete_callbacks(twin_op_ctx, TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_FAIL_SENDING, 0);
 
-				(void)remove_twin_operation_context_from_queue(twin_op_ctx);
-				destroy_twin_operation_context(twin_op_ctx);
-			}
+			(void)remove_twin_operation_context_from_queue(twin_op_ctx);
+			destroy_twin_operation_context(twin_op_ctx);
 		}
+	}
 
-		CONSTBUFFER_Destroy(twin_patch_ctx->data);
-		free(twin_patch_ctx);
+	if (data != NULL && data != twin_patch_ctx->data)
+	{
+		CONSTBUFFER_Destroy(data);
+	}
 
-		*continue_processing = true;
-		result = true;
+	if (batch->merged_patches != NULL)
+	{
+		json_value_free(batch->merged_patches);
 	}
 
-	return result;
+	destroy_twin_patches(twin_patch_ctx);
 }
 
 static void process_twin_subscription(TWIN_MESSENGER_INSTANCE* twin_msgr)
@@ -1252,12 +1625,10 @@ static bool cancel_all_pending_twin_operations(const void* item, const void* mat
 
 		if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PATCH)
 		{
-			if (twin_op_ctx->on_report_state_complete_callback != NULL)
-			{
-				twin_op_ctx->on_report_state_complete_callback(TWIN_REPORT_STATE_RESULT_CANCELLED, TWIN_REPORT_STATE_REASON_MESSENGER_DESTROYED, 0, twin_op_ctx->on_report_state_complete_context);
-			}
+			invoke_report_state_complete_callbacks(twin_op_ctx, TWIN_REPORT_STATE_RESULT_CANCELLED, TWIN_REPORT_STATE_REASON_MESSENGER_DESTROYED, 0);
 		}
 
+		remove_twin_operation_context_from_index(twin_op_ctx);
 		destroy_twin_operation_context(twin_op_ctx);
 
 		*continue_processing = true;
@@ -1323,6 +1694,11 @@ static void internal_twin_messenger_destroy(TWIN_MESSENGER_INSTANCE* twin_msgr)
 		singlylinkedlist_destroy(twin_msgr->operations);
 	}
 
+	if (twin_msgr->operations_index != NULL)
+	{
+		free(twin_msgr->operations_index);
+	}
+
 	// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_102: [twin_messenger_destroy() shall release all memory allocated for and within `twin_msgr`]  
 	if (twin_msgr->client_version != NULL)
 	{
@@ -1384,160 +1760,153 @@ static AMQP_MESSENGER_DISPOSITION_RESULT on_amqp_message_received_callback(MESSA
 			{
 				// It is supposed to be a request sent previously (reported properties PATCH, GET, PUT or DELETE).
 
-				LIST_ITEM_HANDLE list_item;
-				if ((list_item = singlylinkedlist_find(twin_msgr->operations, find_twin_operation_by_correlation_id, (const void*)correlation_id)) == NULL)
+				TWIN_OPERATION_CONTEXT* twin_op_ctx;
+
+				// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_116: [The TWIN request `message` responds to shall be looked up in `twin_msgr->operations_index` by its correlation-id]
+				if ((twin_op_ctx = find_twin_operation_by_correlation_id(twin_msgr, correlation_id)) == NULL)
 				{
 					LogError("Could not find context of TWIN incoming message (%s, %s)", twin_msgr->device_id, correlation_id);
 				}
 				else
 				{
-					TWIN_OPERATION_CONTEXT* twin_op_ctx;
+					LIST_ITEM_HANDLE list_item = twin_op_ctx->list_item;
+					TWIN_OPERATION_TYPE twin_op_type = twin_op_ctx->type;
 
-					if ((twin_op_ctx = (TWIN_OPERATION_CONTEXT*)singlylinkedlist_item_get_value(list_item)) == NULL)
-					{
-						LogError("Could not get context for incoming TWIN message (%s, %s)", twin_msgr->device_id, correlation_id);
+					remove_twin_operation_context_from_index(twin_op_ctx);
+
+					if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PATCH)
+					{							
+						if (!has_status_code)
+						{
+							// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_086: [If `message` is a failed response for a PATCH request, the `on_report_state_complete_callback` shall be invoked if provided passing RESULT_ERROR and the status_code zero]  
+							LogError("Received an incoming TWIN message for a PATCH operation, but with no status code (%s, %s)", twin_msgr->device_id, correlation_id);
+
+							disposition_result = AMQP_MESSENGER_DISPOSITION_RESULT_REJECTED;
+							
+							invoke_report_state_complete_callbacks(twin_op_ctx, TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_INVALID_RESPONSE, 0);
+						}
+						else
+						{
+							// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_085: [If `message` is a success response for a PATCH request, the `on_report_state_complete_callback` shall be invoked if provided passing RESULT_SUCCESS and the status_code received]  
+							// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_111: [The response for a batched PATCH request shall be reported to the `on_report_state_complete_callback` of each of the PATCHES merged into it]
+							invoke_report_state_complete_callbacks(twin_op_ctx, TWIN_REPORT_STATE_RESULT_SUCCESS, TWIN_REPORT_STATE_REASON_NONE, status_code);
+						}
 					}
-					else
-					{	
-						if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PATCH)
-						{							
-							if (!has_status_code)
-							{
-								// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_086: [If `message` is a failed response for a PATCH request, the `on_report_state_complete_callback` shall be invoked if provided passing RESULT_ERROR and the status_code zero]  
-								LogError("Received an incoming TWIN message for a PATCH operation, but with no status code (%s, %s)", twin_msgr->device_id, correlation_id);
+					else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_GET)
+					{
+						if (!has_twin_report)
+						{
+							// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_089: [If `message` is a failed response for a GET request, the TWIN messenger shall attempt to send another GET request]  
+							LogError("Received an incoming TWIN message for a GET operation, but with no report (%s, %s)", twin_msgr->device_id, correlation_id);
 
-								disposition_result = AMQP_MESSENGER_DISPOSITION_RESULT_REJECTED;
-								
-								if (twin_op_ctx->on_report_state_complete_callback != NULL)
-								{
-									twin_op_ctx->on_report_state_complete_callback(TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_INVALID_RESPONSE, 0, twin_op_ctx->on_report_state_complete_context);
-								}
+							disposition_result = AMQP_MESSENGER_DISPOSITION_RESULT_REJECTED;
+
+							if (twin_op_ctx->msgr->on_message_received_callback != NULL)
+							{
+								twin_op_ctx->msgr->on_message_received_callback(TWIN_UPDATE_TYPE_COMPLETE, NULL, 0, twin_op_ctx->msgr->on_message_received_context);
 							}
-							else
+
+							if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_GETTING_COMPLETE_PROPERTIES)
 							{
-								// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_085: [If `message` is a success response for a PATCH request, the `on_report_state_complete_callback` shall be invoked if provided passing RESULT_SUCCESS and the status_code received]  
-								if (twin_op_ctx->on_report_state_complete_callback != NULL)
-								{
-									twin_op_ctx->on_report_state_complete_callback(TWIN_REPORT_STATE_RESULT_SUCCESS, TWIN_REPORT_STATE_REASON_NONE, status_code, twin_op_ctx->on_report_state_complete_context);
-								}
+								twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_GET_COMPLETE_PROPERTIES;
+								twin_msgr->subscription_error_count++;
 							}
 						}
-						else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_GET)
+						else
 						{
-							if (!has_twin_report)
+							// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_087: [If `message` is a success response for a GET request, `on_message_received_callback` shall be invoked with TWIN_UPDATE_TYPE_COMPLETE and the message body received]  
+							if (twin_op_ctx->msgr->on_message_received_callback != NULL)
 							{
-								// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_089: [If `message` is a failed response for a GET request, the TWIN messenger shall attempt to send another GET request]  
-								LogError("Received an incoming TWIN message for a GET operation, but with no report (%s, %s)", twin_msgr->device_id, correlation_id);
-
-								disposition_result = AMQP_MESSENGER_DISPOSITION_RESULT_REJECTED;
-
-								if (twin_op_ctx->msgr->on_message_received_callback != NULL)
-								{
-									twin_op_ctx->msgr->on_message_received_callback(TWIN_UPDATE_TYPE_COMPLETE, NULL, 0, twin_op_ctx->msgr->on_message_received_context);
-								}
-
-								if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_GETTING_COMPLETE_PROPERTIES)
-								{
-									twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_GET_COMPLETE_PROPERTIES;
-									twin_msgr->subscription_error_count++;
-								}
+								twin_op_ctx->msgr->on_message_received_callback(TWIN_UPDATE_TYPE_COMPLETE, (const char*)twin_report.bytes, twin_report.length, twin_op_ctx->msgr->on_message_received_context);
 							}
-							else
-							{
-								// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_087: [If `message` is a success response for a GET request, `on_message_received_callback` shall be invoked with TWIN_UPDATE_TYPE_COMPLETE and the message body received]  
-								if (twin_op_ctx->msgr->on_message_received_callback != NULL)
-								{
-									twin_op_ctx->msgr->on_message_received_callback(TWIN_UPDATE_TYPE_COMPLETE, (const char*)twin_report.bytes, twin_report.length, twin_op_ctx->msgr->on_message_received_context);
-								}
 
-								// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_088: [If `message` is a success response for a GET request, the TWIN messenger shall trigger the subscription for partial updates]  
-								if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_GETTING_COMPLETE_PROPERTIES)
-								{
-									twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBE_FOR_UPDATES;
-									twin_msgr->subscription_error_count = 0;
-								}
+							// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_088: [If `message` is a success response for a GET request, the TWIN messenger shall trigger the subscription for partial updates]  
+							if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_GETTING_COMPLETE_PROPERTIES)
+							{
+								twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBE_FOR_UPDATES;
+								twin_msgr->subscription_error_count = 0;
 							}
 						}
-						else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PUT)
+					}
+					else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PUT)
+					{
+						if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_SUBSCRIBED)
 						{
-							if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_SUBSCRIBED)
+							bool subscription_succeeded = true;
+
+							if (!has_status_code)
+							{
+								LogError("Received an incoming TWIN message for a PUT operation, but with no status code (%s, %s)", twin_msgr->device_id, correlation_id);
+								
+								subscription_succeeded = false;
+							}
+							else if (status_code < 200 || status_code >= 300)
 							{
-								bool subscription_succeeded = true;
+								LogError("Received status code %d for TWIN subscription request (%s, %s)", status_code, twin_msgr->device_id, correlation_id);
+								
+								subscription_succeeded = false;
+							}
 
-								if (!has_status_code)
-								{
-									LogError("Received an incoming TWIN message for a PUT operation, but with no status code (%s, %s)", twin_msgr->device_id, correlation_id);
-									
-									subscription_succeeded = false;
-								}
-								else if (status_code < 200 || status_code >= 300)
+							if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_SUBSCRIBING)
+							{
+								if (subscription_succeeded)
 								{
-									LogError("Received status code %d for TWIN subscription request (%s, %s)", status_code, twin_msgr->device_id, correlation_id);
-									
-									subscription_succeeded = false;
+									twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBED;
+									twin_msgr->subscription_error_count = 0;
 								}
-
-								if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_SUBSCRIBING)
+								else
 								{
-									if (subscription_succeeded)
-									{
-										twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBED;
-										twin_msgr->subscription_error_count = 0;
-									}
-									else
-									{
-										// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_090: [If `message` is a failed response for a PUT request, the TWIN messenger shall attempt to send another PUT request]  
-										twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBE_FOR_UPDATES;
-										twin_msgr->subscription_error_count++;
-									}
+									// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_090: [If `message` is a failed response for a PUT request, the TWIN messenger shall attempt to send another PUT request]  
+									twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBE_FOR_UPDATES;
+									twin_msgr->subscription_error_count++;
 								}
 							}
 						}
-						else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_DELETE)
+					}
+					else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_DELETE)
+					{
+						if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_NOT_SUBSCRIBED)
 						{
-							if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_NOT_SUBSCRIBED)
+							bool unsubscription_succeeded = true;
+
+							if (!has_status_code)
+							{
+								LogError("Received an incoming TWIN message for a DELETE operation, but with no status code (%s, %s)", twin_msgr->device_id, correlation_id);
+								
+								unsubscription_succeeded = false;
+							}
+							else if (status_code < 200 || status_code >= 300)
 							{
-								bool unsubscription_succeeded = true;
+								LogError("Received status code %d for TWIN unsubscription request (%s, %s)", status_code, twin_msgr->device_id, correlation_id);
+								
+								unsubscription_succeeded = false;
+							}
 
-								if (!has_status_code)
-								{
-									LogError("Received an incoming TWIN message for a DELETE operation, but with no status code (%s, %s)", twin_msgr->device_id, correlation_id);
-									
-									unsubscription_succeeded = false;
-								}
-								else if (status_code < 200 || status_code >= 300)
+							if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_UNSUBSCRIBING)
+							{
+								if (unsubscription_succeeded)
 								{
-									LogError("Received status code %d for TWIN unsubscription request (%s, %s)", status_code, twin_msgr->device_id, correlation_id);
-									
-									unsubscription_succeeded = false;
+									twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_NOT_SUBSCRIBED;
+									twin_msgr->subscription_error_count = 0;
 								}
-
-								if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_UNSUBSCRIBING)
+								else
 								{
-									if (unsubscription_succeeded)
-									{
-										twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_NOT_SUBSCRIBED;
-										twin_msgr->subscription_error_count = 0;
-									}
-									else
-									{
-										// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_091: [If `message` is a failed response for a DELETE request, the TWIN messenger shall attempt to send another DELETE request]  
-										twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_UNSUBSCRIBE;
-										twin_msgr->subscription_error_count++;
-									}
+									// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_091: [If `message` is a failed response for a DELETE request, the TWIN messenger shall attempt to send another DELETE request]  
+									twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_UNSUBSCRIBE;
+									twin_msgr->subscription_error_count++;
 								}
 							}
 						}
-
-						destroy_twin_operation_context(twin_op_ctx);
 					}
 
+					destroy_twin_operation_context(twin_op_ctx);
+
 					// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_092: [The corresponding TWIN request shall be removed from `twin_msgr->operations` and destroyed]  
 					if (singlylinkedlist_remove(twin_msgr->operations, list_item) != 0)
 					{
 						// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_093: [The corresponding TWIN request failed to be removed from `twin_msgr->operations`, `twin_msgr->state` shall be set to TWIN_MESSENGER_STATE_ERROR and informed to the user]  
 						LogError("Failed removing context for incoming TWIN message (%s, %s, %s)",
-							twin_msgr->device_id, ENUM_TO_STRING(TWIN_OPERATION_TYPE, twin_op_ctx->type), correlation_id);
+							twin_msgr->device_id, ENUM_TO_STRING(TWIN_OPERATION_TYPE, twin_op_type), correlation_id);
 						
 						update_state(twin_msgr, TWIN_MESSENGER_STATE_ERROR);
 					}
@@ -1721,6 +2090,14 @@ TWIN_MESSENGER_HANDLE twin_messenger_create(const TWIN_MESSENGER_CONFIG* messeng
 				internal_twin_messenger_destroy(twin_msgr);
 				twin_msgr = NULL;
 			}
+			// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_112: [`twin_msgr->operations_index` shall be allocated with DEFAULT_TWIN_OPERATIONS_INDEX_SIZE empty buckets]
+			else if (create_operations_index(twin_msgr) != RESULT_OK)
+			{
+				// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_113: [If malloc() fails, twin_messenger_create() shall fail and return NULL]
+				LogError("Failed creating index of operations (%s)", messenger_config->device_id);
+				internal_twin_messenger_destroy(twin_msgr);
+				twin_msgr = NULL;
+			}
 			else if ((link_attach_properties = create_link_attach_properties(twin_msgr)) == NULL)
 			{
 				LogError("Failed creating link attach properties (%s)", messenger_config->device_id);
@@ -1832,6 +2209,7 @@ int twin_messenger_report_state_async(TWIN_MESSENGER_HANDLE twin_msgr_handle, CO
 		{
 			twin_patch_ctx->on_report_state_complete_callback = on_report_state_complete_callback;
 			twin_patch_ctx->on_report_state_complete_context = context;
+			twin_patch_ctx->next_in_batch = NULL;
 
 			// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_029: [`twin_op_ctx` shall be added to `twin_msgr->pending_patches` using singlylinkedlist_add()]  
 			if (singlylinkedlist_add(twin_msgr->pending_patches, twin_patch_ctx) == NULL)
@@ -2027,8 +2405,20 @@ void twin_messenger_do_work(TWIN_MESSENGER_HANDLE twin_msgr_handle)
 
 		if (twin_msgr->state == TWIN_MESSENGER_STATE_STARTED)
 		{
+			TWIN_PATCH_BATCH batch;
+			batch.msgr = twin_msgr;
+			batch.first_patch = NULL;
+			batch.last_patch = NULL;
+			batch.merged_patches = NULL;
+
 			// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_058: [If `twin_msgr->state` is TWIN_MESSENGER_STATE_STARTED, twin_messenger_do_work() shall send the PATCHES in `twin_msgr->pending_patches`, removing them from the list]
-			(void)singlylinkedlist_remove_if(twin_msgr->pending_patches, send_pending_twin_patch, (const void*)twin_msgr);
+			// Codes_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_109: [The PATCHES in `twin_msgr->pending_patches` shall be merged, in order, into a single PATCH request while they are JSON objects whose merge is equivalent to applying them one after the other]
+			(void)singlylinkedlist_remove_if(twin_msgr->pending_patches, add_pending_twin_patch_to_batch, (const void*)&batch);
+
+			if (batch.first_patch != NULL)
+			{
+				send_twin_patch_batch(&batch);
+			}
 
 			process_twin_subscription(twin_msgr);
 		}
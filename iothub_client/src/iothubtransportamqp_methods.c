@@ -39,6 +39,7 @@ typedef struct IOTHUBTRANSPORT_AMQP_METHODS_TAG
     SUBSCRIBE_STATE subscribe_state;
     IOTHUBTRANSPORT_AMQP_METHOD_HANDLE* method_request_handles;
     size_t method_request_handle_count;
+    size_t method_request_handle_capacity;
     bool receiver_link_disconnected;
     bool sender_link_disconnected;
 } IOTHUBTRANSPORT_AMQP_METHODS;
@@ -54,39 +55,22 @@ typedef struct IOTHUBTRANSPORT_AMQP_METHOD_TAG
 {
     IOTHUBTRANSPORT_AMQP_METHODS_HANDLE iothubtransport_amqp_methods_handle;
     uuid correlation_id;
+    size_t tracked_handle_index;
 } IOTHUBTRANSPORT_AMQP_METHOD;
 
+#define INITIAL_METHOD_REQUEST_HANDLE_CAPACITY 4
+
 static void remove_tracked_handle(IOTHUBTRANSPORT_AMQP_METHODS* amqp_methods_handle, IOTHUBTRANSPORT_AMQP_METHOD_HANDLE method_request_handle)
 {
-    size_t i;
-
-    for (i = 0; i < amqp_methods_handle->method_request_handle_count; i++)
-    {
-        if (amqp_methods_handle->method_request_handles[i] == method_request_handle)
-        {
-            if (amqp_methods_handle->method_request_handle_count - i > 1)
-            {
-                (void)memmove(&amqp_methods_handle->method_request_handles[i], &amqp_methods_handle->method_request_handles[i + 1],
-                    (amqp_methods_handle->method_request_handle_count - i - 1) * sizeof(IOTHUBTRANSPORT_AMQP_METHOD_HANDLE));
-            }
-
-            amqp_methods_handle->method_request_handle_count--;
-            i--;
-        }
-    }
+    size_t i = method_request_handle->tracked_handle_index;
 
-    if (amqp_methods_handle->method_request_handle_count == 0)
+    if ((i < amqp_methods_handle->method_request_handle_count) &&
+        (amqp_methods_handle->method_request_handles[i] == method_request_handle))
     {
-        free(amqp_methods_handle->method_request_handles);
-        amqp_methods_handle->method_request_handles = NULL;
-    }
-    else
-    {
-        IOTHUBTRANSPORT_AMQP_METHOD_HANDLE* new_handles = (IOTHUBTRANSPORT_AMQP_METHOD_HANDLE*)realloc(amqp_methods_handle->method_request_handles, amqp_methods_handle->method_request_handle_count * sizeof(IOTHUBTRANSPORT_AMQP_METHOD_HANDLE));
-        if (new_handles != NULL)
-        {
-            amqp_methods_handle->method_request_handles = new_handles;
-        }
+        /* Codes_SRS_IOTHUBTRANSPORT_AMQP_METHODS_01_156: [ The slot of `method_handle` shall be filled with the last tracked handle, without resizing the array used to track the method handles. ]*/
+        amqp_methods_handle->method_request_handle_count--;
+        amqp_methods_handle->method_request_handles[i] = amqp_methods_handle->method_request_handles[amqp_methods_handle->method_request_handle_count];
+        amqp_methods_handle->method_request_handles[i]->tracked_handle_index = i;
     }
 }
 
@@ -137,6 +121,7 @@ IOTHUBTRANSPORT_AMQP_METHODS_HANDLE iothubtransportamqp_methods_create(const cha
                     result->subscribe_state = SUBSCRIBE_STATE_NOT_SUBSCRIBED;
                     result->method_request_handles = NULL;
                     result->method_request_handle_count = 0;
+                    result->method_request_handle_capacity = 0;
                     result->receiver_link_disconnected = false;
                     result->sender_link_disconnected = false;
                 }
@@ -295,9 +280,17 @@ static AMQP_VALUE on_message_received(const void* context, MESSAGE_HANDLE messag
                 }
                 else
                 {
-                    IOTHUBTRANSPORT_AMQP_METHOD_HANDLE* new_handles;
+                    IOTHUBTRANSPORT_AMQP_METHOD_HANDLE* new_handles = amqp_methods_handle->method_request_handles;
+                    size_t new_capacity = amqp_methods_handle->method_request_handle_capacity;
+
                     /* Codes_SRS_IOTHUBTRANSPORT_AMQP_METHODS_01_113: [ All `IOTHUBTRANSPORT_AMQP_METHOD_HANDLE` handles shall be tracked in an array of handles that shall be resized accordingly when a methopd handle is added to it. ]*/
-                    new_handles = (IOTHUBTRANSPORT_AMQP_METHOD_HANDLE*)realloc(amqp_methods_handle->method_request_handles, (amqp_methods_handle->method_request_handle_count + 1) * sizeof(IOTHUBTRANSPORT_AMQP_METHOD_HANDLE));
+                    /* Codes_SRS_IOTHUBTRANSPORT_AMQP_METHODS_01_155: [ The array of tracked handles shall only be resized when all its slots are in use, doubling its capacity (starting with 4 slots). ]*/
+                    if (amqp_methods_handle->method_request_handle_count == new_capacity)
+                    {
+                        new_capacity = (new_capacity == 0) ? INITIAL_METHOD_REQUEST_HANDLE_CAPACITY : new_capacity * 2;
+                        new_handles = (IOTHUBTRANSPORT_AMQP_METHOD_HANDLE*)realloc(amqp_methods_handle->method_request_handles, new_capacity * sizeof(IOTHUBTRANSPORT_AMQP_METHOD_HANDLE));
+                    }
+
                     if (new_handles == NULL)
                     {
                         /* Codes_SRS_IOTHUBTRANSPORT_AMQP_METHODS_01_138: [ If resizing the tracked method handles array fails, the RELEASED outcome shall be returned and an error shall be indicated. ]*/
@@ -308,6 +301,7 @@ static AMQP_VALUE on_message_received(const void* context, MESSAGE_HANDLE messag
                     else
                     {
                         amqp_methods_handle->method_request_handles = new_handles;
+                        amqp_methods_handle->method_request_handle_capacity = new_capacity;
 
                         /* Codes_SRS_IOTHUBTRANSPORT_AMQP_METHODS_01_121: [ The uuid value for the correlation ID shall be obtained by calling `amqpvalue_get_uuid`. ]*/
                         if (amqpvalue_get_uuid(correlation_id, &method_handle->correlation_id) != 0)
@@ -407,6 +401,7 @@ static AMQP_VALUE on_message_received(const void* context, MESSAGE_HANDLE messag
                                                         method_handle->iothubtransport_amqp_methods_handle = amqp_methods_handle;
 
                                                         /* set the method request handle in the handle array */
+                                                        method_handle->tracked_handle_index = amqp_methods_handle->method_request_handle_count;
                                                         amqp_methods_handle->method_request_handles[amqp_methods_handle->method_request_handle_count] = method_handle;
                                                         amqp_methods_handle->method_request_handle_count++;
 
@@ -422,8 +417,8 @@ static AMQP_VALUE on_message_received(const void* context, MESSAGE_HANDLE messag
                                                             /* Codes_SRS_IOTHUBTRANSPORT_AMQP_METHODS_01_147: [ If `on_method_request_received` fails, the REJECTED outcome shall be returned with `amqp:internal-error`. ]*/
                                                             LogError("Cannot execute the callback with the given data");
                                                             amqpvalue_destroy(result);
+                                                            remove_tracked_handle(amqp_methods_handle, method_handle);
                                                             free(method_handle);
-                                                            amqp_methods_handle->method_request_handle_count--;
                                                             message_outcome = MESSAGE_OUTCOME_REJECTED;
                                                             result = messaging_delivery_rejected("amqp:internal-error", "Cannot execute the callback with the given data");
                                                         }
@@ -40,6 +40,9 @@ static const char* IOTHUB_CONTENT_ENCODING_C2D = "ContentEncoding";
 /*the default is 25 minutes*/
 #define DEFAULT_GETMINIMUMPOLLINGTIME ((unsigned int)25*60) 
 
+/*DEFAULT_GETMAXIMUMPOLLINGTIME of 0 disables the adaptive polling: GETs happen every GetMinimumPollingTime seconds*/
+#define DEFAULT_GETMAXIMUMPOLLINGTIME ((unsigned int)0)
+
 #define MAXIMUM_MESSAGE_SIZE (255*1024-1)
 #define MAXIMUM_PAYLOAD_OVERHEAD 384
 #define MAXIMUM_PROPERTY_OVERHEAD 16
@@ -53,6 +56,9 @@ typedef struct HTTPTRANSPORT_HANDLE_DATA_TAG
     HTTPAPIEX_HANDLE httpApiExHandle;
     bool doBatchedTransfers;
     unsigned int getMinimumPollingTime;
+    unsigned int getMaximumPollingTime;
+    unsigned int maxDevicesPerDoWork;
+    size_t nextDeviceIndex;
     VECTOR_HANDLE perDeviceList;
 }HTTPTRANSPORT_HANDLE_DATA;
 
@@ -72,6 +78,7 @@ typedef struct HTTPTRANSPORT_PERDEVICE_DATA_TAG
     bool DoWork_PullMessage;
     time_t lastPollTime;
     bool isFirstPoll;
+    unsigned int emptyPollCount;
 
     IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle;
     PDLIST_ENTRY waitingToSend;
@@ -608,6 +615,7 @@ static IOTHUB_DEVICE_HANDLE IoTHubTransportHttp_Register(TRANSPORT_LL_HANDLE han
                 /*Codes_SRS_TRANSPORTMULTITHTTP_17_128: [ IoTHubTransportHttp_Register shall mark this device as unsubscribed. ]*/
                 result->DoWork_PullMessage = false;
                 result->isFirstPoll = true;
+                result->emptyPollCount = 0;
                 result->waitingToSend = waitingToSend;
                 DList_InitializeListHead(&(result->eventConfirmations));
                 result->transportHandle = (HTTPTRANSPORT_HANDLE_DATA *)handle;
@@ -849,6 +857,9 @@ static TRANSPORT_LL_HANDLE IoTHubTransportHttp_Create(const IOTHUBTRANSPORT_CONF
                 /*Codes_SRS_TRANSPORTMULTITHTTP_17_011: [ Otherwise, IoTHubTransportHttp_Create shall succeed and return a non-NULL value. ]*/
                 result->doBatchedTransfers = false;
                 result->getMinimumPollingTime = DEFAULT_GETMINIMUMPOLLINGTIME;
+                result->getMaximumPollingTime = DEFAULT_GETMAXIMUMPOLLINGTIME;
+                result->maxDevicesPerDoWork = 0;
+                result->nextDeviceIndex = 0;
             }
             else
             {
@@ -1997,6 +2008,24 @@ static MESSAGE_CALLBACK_INFO* MESSAGE_CALLBACK_INFO_Create(IOTHUB_MESSAGE_HANDLE
     return result;
 }
 
+/*computes the time in seconds that has to pass since the last GET of a device before polling again*/
+static unsigned int getPollingTime(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVICE_DATA* deviceData)
+{
+    unsigned int result = handleData->getMinimumPollingTime;
+
+    /*Codes_SRS_TRANSPORTMULTITHTTP_09_011: [ If "MaximumPollingTime" is bigger than "MinimumPollingTime", the time between 2 GETs shall be doubled after every GET that returned no message, without exceeding "MaximumPollingTime". ]*/
+    if (handleData->getMaximumPollingTime > handleData->getMinimumPollingTime)
+    {
+        unsigned int i;
+        for (i = 0; (i < deviceData->emptyPollCount) && (result < handleData->getMaximumPollingTime); i++)
+        {
+            result = (result > handleData->getMaximumPollingTime / 2) ? handleData->getMaximumPollingTime : ((result == 0) ? 1 : result * 2);
+        }
+    }
+
+    return result;
+}
+
 static void DoMessages(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVICE_DATA* deviceData, IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
 {
     /*Codes_SRS_TRANSPORTMULTITHTTP_17_083: [ If device is not subscribed then _DoWork shall advance to the next action. ] */
@@ -2006,7 +2035,7 @@ static void DoMessages(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERD
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_124: [If time is not available then all calls shall be treated as if they are the first one.] */
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_122: [A GET request that happens earlier than GetMinimumPollingTime shall be ignored.] */
         time_t timeNow = get_time(NULL);
-        bool isPollingAllowed = deviceData->isFirstPoll || (timeNow == (time_t)(-1)) || (get_difftime(timeNow, deviceData->lastPollTime) > handleData->getMinimumPollingTime);
+        bool isPollingAllowed = deviceData->isFirstPoll || (timeNow == (time_t)(-1)) || (get_difftime(timeNow, deviceData->lastPollTime) > getPollingTime(handleData, deviceData));
         if (isPollingAllowed)
         {
             HTTP_HEADERS_HANDLE responseHTTPHeaders = HTTPHeaders_Alloc();
@@ -2093,7 +2122,11 @@ static void DoMessages(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERD
                             /*Codes_SRS_TRANSPORTMULTITHTTP_17_086: [If the HTTPAPIEX_SAS_ExecuteRequest executed successfully then status code shall be examined. Any status code different than 200 causes _DoWork to advance to the next action.] */
                             /*this is an expected status code, means "no commands", but logging that creates panic*/
 
-                            /*do nothing, advance to next action*/
+                            /*no message, the next GET can wait longer (the count is bounded, 32 doublings exceed any unsigned int)*/
+                            if (deviceData->emptyPollCount < 32)
+                            {
+                                deviceData->emptyPollCount++;
+                            }
                         }
                         else if (statusCode != 200)
                         {
@@ -2102,6 +2135,9 @@ static void DoMessages(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERD
                         }
                         else
                         {
+                            /*Codes_SRS_TRANSPORTMULTITHTTP_09_012: [ When a GET returns a message, the time between 2 GETs shall go back to "MinimumPollingTime". ]*/
+                            deviceData->emptyPollCount = 0;
+
                             /*Codes_SRS_TRANSPORTMULTITHTTP_17_087: [If status code is 200, then _DoWork shall make a copy of the value of the "ETag" http header.]*/
                             const char* etagValue = HTTPHeaders_FindHeaderValue(responseHTTPHeaders, "ETag");
                             if (etagValue == NULL)
@@ -2318,17 +2354,43 @@ static void IoTHubTransportHttp_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIENT
         HTTPTRANSPORT_HANDLE_DATA* handleData = (HTTPTRANSPORT_HANDLE_DATA*)handle;
         IOTHUB_DEVICE_HANDLE* listItem;
         size_t deviceListSize = VECTOR_size(handleData->perDeviceList);
+        size_t devicesToProcess;
+
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_005: [ If "MaxDevicesPerDoWork" is 0 or not smaller than the number of registered devices, IoTHubTransportHttp_DoWork shall process every device. ]*/
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_006: [ Otherwise IoTHubTransportHttp_DoWork shall process only "MaxDevicesPerDoWork" devices. ]*/
+        /*this only bounds how long one call takes: the devices are still serviced one after the other, each request blocking in HTTPAPIEX*/
+        if (handleData->maxDevicesPerDoWork == 0 || handleData->maxDevicesPerDoWork > deviceListSize)
+        {
+            devicesToProcess = deviceListSize;
+        }
+        else
+        {
+            devicesToProcess = handleData->maxDevicesPerDoWork;
+        }
+
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_008: [ If devices were unregistered and the saved position is past the end of the device list, IoTHubTransportHttp_DoWork shall start from the first device. ]*/
+        if (handleData->nextDeviceIndex >= deviceListSize)
+        {
+            handleData->nextDeviceIndex = 0;
+        }
+
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_052: [ IoTHubTransportHttp_DoWork shall perform a round-robin loop through every deviceHandle in the transport device list, using the iotHubClientHandle field saved in the IOTHUB_DEVICE_HANDLE. ]*/
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_050: [ IoTHubTransportHttp_DoWork shall call loop through the device list. ] */
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_051: [ IF the list is empty, then IoTHubTransportHttp_DoWork shall do nothing. ]*/
-        for (size_t i = 0; i < deviceListSize; i++)
+        for (size_t i = 0; i < devicesToProcess; i++)
         {
-            listItem = (IOTHUB_DEVICE_HANDLE *)VECTOR_element(handleData->perDeviceList, i);
+            listItem = (IOTHUB_DEVICE_HANDLE *)VECTOR_element(handleData->perDeviceList, (handleData->nextDeviceIndex + i) % deviceListSize);
             HTTPTRANSPORT_PERDEVICE_DATA* perDeviceItem = *(HTTPTRANSPORT_PERDEVICE_DATA**)(listItem);
             DoEvent(handleData, perDeviceItem, perDeviceItem->iotHubClientHandle);
             DoMessages(handleData, perDeviceItem, perDeviceItem->iotHubClientHandle);
 
         }
+
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_007: [ The next call to IoTHubTransportHttp_DoWork shall start with the device following the last one processed. ]*/
+        if (deviceListSize > 0)
+        {
+            handleData->nextDeviceIndex = (handleData->nextDeviceIndex + devicesToProcess) % deviceListSize;
+        }
     }
     else
     {
@@ -2412,6 +2474,18 @@ static IOTHUB_CLIENT_RESULT IoTHubTransportHttp_SetOption(TRANSPORT_LL_HANDLE ha
             handleData->getMinimumPollingTime = *(unsigned int*)value;
             result = IOTHUB_CLIENT_OK;
         }
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_013: ["MaximumPollingTime"] */
+        else if (strcmp(OPTION_MAX_POLLING_TIME, option) == 0)
+        {
+            handleData->getMaximumPollingTime = *(unsigned int*)value;
+            result = IOTHUB_CLIENT_OK;
+        }
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_009: ["MaxDevicesPerDoWork"] */
+        else if (strcmp(OPTION_HTTP_MAX_DEVICES_PER_DOWORK, option) == 0)
+        {
+            handleData->maxDevicesPerDoWork = *(unsigned int*)value;
+            result = IOTHUB_CLIENT_OK;
+        }
         else
         {
             /*Codes_SRS_TRANSPORTMULTITHTTP_17_126: [ "TrustedCerts"] */
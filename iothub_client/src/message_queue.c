@@ -386,16 +386,17 @@ static int move_messages_between_lists(SINGLYLINKEDLIST_HANDLE from_list, SINGLY
 
     while ((list_item = singlylinkedlist_get_head_item(from_list)) != NULL)
     {
+        MESSAGE_QUEUE_ITEM* mq_item = (MESSAGE_QUEUE_ITEM*)singlylinkedlist_item_get_value(list_item);
+
         if (singlylinkedlist_remove(from_list, list_item) != 0)
         {
             LogError("failed removing message from list");
             result = __FAILURE__;
+            break;
         }
         else
         {
-            MESSAGE_QUEUE_ITEM* mq_item = (MESSAGE_QUEUE_ITEM*)singlylinkedlist_item_get_value(list_item);
-
-            if (singlylinkedlist_add(to_list, (const void*)mq_item) != 0)
+            if (singlylinkedlist_add(to_list, (const void*)mq_item) == NULL)
             {
                 LogError("failed moving message to list");
 
@@ -10,12 +10,21 @@
 #include <stddef.h>
 #include <string.h>
 #endif
+#include <stdio.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
 
 static void* my_gballoc_malloc(size_t size)
 {
     return malloc(size);
 }
 
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
 static void my_gballoc_free(void* s)
 {
     free(s);
@@ -30,6 +39,7 @@ static void my_gballoc_free(void* s)
 #include "azure_c_shared_utility/httpheaders.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/shared_util_options.h"
+#include "azure_c_shared_utility/threadapi.h"
 #undef ENABLE_MOCKS
 
 #include "blob.h"
@@ -243,6 +253,8 @@ TEST_SUITE_INITIALIZE(TestSuiteInitialize)
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
 
     REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Create, my_HTTPAPIEX_Create);
@@ -317,7 +329,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_with_NULL_SasUri_fails)
     ///arrange
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(NULL, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(NULL, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
@@ -332,7 +344,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_with_NULL_getDataCallBack_and_
     ///arrange
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
@@ -409,7 +421,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_succeeds_when_HTTP_status_code
         .IgnoreArgument_ptr();
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
@@ -487,7 +499,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_HTTPAPIEX_ExecuteRe
         .IgnoreArgument_ptr();
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_HTTP_ERROR, result);
@@ -526,7 +538,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_BUFFER_create_fails
     }
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -554,7 +566,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_HTTPAPIEX_Create_fa
     }
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_ERROR, result);
@@ -577,7 +589,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_malloc_fails)
         ;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_ERROR, result);
@@ -596,7 +608,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_SasUri_is_wrong_fails_1)
     context.toUpload = context.size;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https:/h.h/doms", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL); /*wrong format for protocol, notice it is actually http:\h.h\doms (missing a \ from http)*/
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https:/h.h/doms", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL); /*wrong format for protocol, notice it is actually http:\h.h\doms (missing a \ from http)*/
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
@@ -615,7 +627,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_SasUri_is_wrong_fails_2)
     context.toUpload = context.size;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL); /*there's no relative path here*/
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL); /*there's no relative path here*/
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
@@ -757,7 +769,7 @@ static void Blob_UploadMultipleBlocksFromSasUri_various_sizes_happy_path_Impl(HT
             .IgnoreArgument_ptr();
 
         ///act
-        BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, proxyOptions);
+        BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, proxyOptions, NULL);
 
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -939,7 +951,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_various_sizes_with_certificate
             .IgnoreArgument_ptr();
 
         ///act
-        BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, "a", NULL);
+        BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, "a", NULL, NULL);
 
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -1165,7 +1177,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_64MB_unhappy_paths)
             
             ///act
             context.toUpload = context.size; /* Reinit context */
-            BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+            BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
             ///assert
             ASSERT_ARE_NOT_EQUAL_WITH_MSG(BLOB_RESULT, BLOB_OK, result, temp_str);
@@ -1395,7 +1407,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_64MB_with_certificate_unhappy_
 
             ///act
             context.toUpload = context.size; /* Reinit context */
-            BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, "a", NULL);
+            BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, "a", NULL, NULL);
 
             ///assert
             ASSERT_ARE_NOT_EQUAL_WITH_MSG(BLOB_RESULT, BLOB_OK, result, temp_str);
@@ -1487,7 +1499,7 @@ TEST_FUNCTION(Blob_UploadFromSasUri_when_http_code_is_404_it_immediately_succeed
         .IgnoreArgument_ptr();
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -1498,6 +1510,548 @@ TEST_FUNCTION(Blob_UploadFromSasUri_when_http_code_is_404_it_immediately_succeed
     
 }
 
+static const unsigned int TwoHundredOne = 201;
+static const unsigned int FiveHundredThree = 503;
+
+static void setup_Blob_UploadBlock_until_HTTPAPIEX_ExecuteRequest(unsigned char* content)
+{
+    STRICT_EXPECTED_CALL(BUFFER_create(content, 1)); /*this is the content to be uploaded by this call*/
+
+    /*here some sprintf happens and that produces a string in the form: 000000...049999*/
+    STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/
+        .IgnoreArgument_source();
+
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "<Latest>")) /*this is building the XML*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*this is building the XML*/
+        .IgnoreArgument_s1()
+        .IgnoreArgument_s2();
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</Latest>")) /*this is building the XML*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_construct("/something?a=b")); /*this is building the relativePath*/
+
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "&comp=block&blockid=")) /*this is building the relativePath*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*this is building the relativePath by adding the blockId (base64 encoded_*/
+        .IgnoreArgument_s1()
+        .IgnoreArgument_s2();
+}
+
+static void setup_Blob_UploadBlock_HTTPAPIEX_ExecuteRequest(const unsigned int* statusCode)
+{
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */
+        .IgnoreArgument_handle();
+
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(statusCode, sizeof(*statusCode));
+}
+
+/*this is waiting before uploading the block again, twice as long on each retry up to BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS*/
+static void setup_Blob_UploadBlock_retry_wait(unsigned int retryCount)
+{
+    unsigned int delay = BLOB_BLOCK_UPLOAD_RETRY_INITIAL_DELAY_MS;
+    for (unsigned int i = 0; i < retryCount; i++)
+    {
+        delay = (delay > BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS / 2) ? BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS : delay * 2;
+    }
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(delay));
+}
+
+static void setup_Blob_UploadBlock_cleanup(void)
+{
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this was the content to be uploaded*/
+        .IgnoreArgument_handle();
+}
+
+/*Tests_SRS_BLOB_09_001: [ If the HTTP response code is >=500, Blob_UploadMultipleBlocksFromSasUri shall call HTTPAPIEX_ExecuteRequest again for the same block, at most BLOB_BLOCK_UPLOAD_MAX_RETRIES times, before evaluating the response code as above. ]*/
+/*Tests_SRS_BLOB_09_020: [ Before each retry Blob_UploadMultipleBlocksFromSasUri shall wait using ThreadAPI_Sleep, BLOB_BLOCK_UPLOAD_RETRY_INITIAL_DELAY_MS milliseconds before the first retry and twice as long as the previous wait before each next one, but never longer than BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS milliseconds. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_http_code_is_503_uploads_the_block_again_and_succeeds)
+{
+    ///arrange
+    unsigned char c = '3';
+    context.size = 1;
+    context.source = &c;
+    context.toUpload = context.size;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is creating a copy of the hostname */
+        .IgnoreArgument_size();
+
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h")); /*this is creating the httpapiex handle to storage (it is always the same host)*/
+    STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
+
+    /*uploading the only block (Put Block), storage is busy the first time*/
+    setup_Blob_UploadBlock_until_HTTPAPIEX_ExecuteRequest(&c);
+    setup_Blob_UploadBlock_HTTPAPIEX_ExecuteRequest(&FiveHundredThree);
+    setup_Blob_UploadBlock_retry_wait(0);
+    setup_Blob_UploadBlock_HTTPAPIEX_ExecuteRequest(&TwoHundredOne);
+    setup_Blob_UploadBlock_cleanup();
+
+    /*this part is Put Block list*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_construct("/something?a=b")); /*this is building the relative path for the Put BLock list*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "&comp=blocklist")) /*This is still building relative path for Put Block list*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the XML as const char* so it can be passed to _ExecuteRequest*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG)) /*this is creating the XML body as BUFFER_HANDLE*/
+        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*This is the XML as BUFFER_HANDLE*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is destroying the relative path for Put Block List*/
+        .IgnoreArgument_handle();
+
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of hte hostname*/
+        .IgnoreArgument_ptr();
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 200, httpResponse);
+
+    ///cleanup
+}
+
+/*Tests_SRS_BLOB_09_001: [ If the HTTP response code is >=500, Blob_UploadMultipleBlocksFromSasUri shall call HTTPAPIEX_ExecuteRequest again for the same block, at most BLOB_BLOCK_UPLOAD_MAX_RETRIES times, before evaluating the response code as above. ]*/
+/*Tests_SRS_BLOB_09_020: [ Before each retry Blob_UploadMultipleBlocksFromSasUri shall wait using ThreadAPI_Sleep, BLOB_BLOCK_UPLOAD_RETRY_INITIAL_DELAY_MS milliseconds before the first retry and twice as long as the previous wait before each next one, but never longer than BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS milliseconds. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_http_code_stays_503_gives_up_after_BLOB_BLOCK_UPLOAD_MAX_RETRIES)
+{
+    ///arrange
+    unsigned char c = '3';
+    context.size = 1;
+    context.source = &c;
+    context.toUpload = context.size;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is creating a copy of the hostname */
+        .IgnoreArgument_size();
+
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h")); /*this is creating the httpapiex handle to storage (it is always the same host)*/
+    STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
+
+    setup_Blob_UploadBlock_until_HTTPAPIEX_ExecuteRequest(&c);
+    for (unsigned int i = 0; i < BLOB_BLOCK_UPLOAD_MAX_RETRIES + 1; i++)
+    {
+        if (i > 0)
+        {
+            setup_Blob_UploadBlock_retry_wait(i - 1);
+        }
+        setup_Blob_UploadBlock_HTTPAPIEX_ExecuteRequest(&FiveHundredThree);
+    }
+    setup_Blob_UploadBlock_cleanup();
+
+    /*this part is Put Block list*/ /*notice: no op because the block was not uploaded*/
+
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of hte hostname*/
+        .IgnoreArgument_ptr();
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 503, httpResponse);
+
+    ///cleanup
+    httpResponse = 0;
+}
+
+/*Tests_SRS_BLOB_09_002: [ If firstBlockID is bigger than MAX_BLOCK_COUNT then Blob_ResumeMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_ResumeMultipleBlocksFromSasUri_with_firstBlockID_over_maximum_fails)
+{
+    ///arrange
+    unsigned char c = '3';
+    context.size = 1;
+    context.source = &c;
+    context.toUpload = context.size;
+
+    ///act
+    BLOB_RESULT result = Blob_ResumeMultipleBlocksFromSasUri("https://h.h/something?a=b", MAX_BLOCK_COUNT + 1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+
+    ///cleanup
+}
+
+/*Tests_SRS_BLOB_09_003: [ Blob_ResumeMultipleBlocksFromSasUri shall add to the XML the ids of the blocks 0 to firstBlockID - 1 without uploading them. ]*/
+/*Tests_SRS_BLOB_09_004: [ Blob_ResumeMultipleBlocksFromSasUri shall then upload the blocks returned by getDataCallbackEx starting with block id firstBlockID. ]*/
+TEST_FUNCTION(Blob_ResumeMultipleBlocksFromSasUri_adds_committed_blocks_and_uploads_the_rest)
+{
+    ///arrange
+    unsigned char c = '3';
+    context.size = 1;
+    context.source = &c;
+    context.toUpload = context.size;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is creating a copy of the hostname */
+        .IgnoreArgument_size();
+
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h")); /*this is creating the httpapiex handle to storage (it is always the same host)*/
+    STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
+
+    /*blocks 0 and 1 have already been committed, only their ids are added to the XML*/
+    for (unsigned int i = 0; i < 2; i++)
+    {
+        STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/
+            .IgnoreArgument_source();
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "<Latest>")) /*this is building the XML*/
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*this is building the XML*/
+            .IgnoreArgument_s1()
+            .IgnoreArgument_s2();
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</Latest>")) /*this is building the XML*/
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/
+            .IgnoreArgument_handle();
+    }
+
+    /*uploading block 2 (Put Block)*/
+    setup_Blob_UploadBlock_until_HTTPAPIEX_ExecuteRequest(&c);
+    setup_Blob_UploadBlock_HTTPAPIEX_ExecuteRequest(&TwoHundredOne);
+    setup_Blob_UploadBlock_cleanup();
+
+    /*this part is Put Block list*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_construct("/something?a=b")); /*this is building the relative path for the Put BLock list*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "&comp=blocklist")) /*This is still building relative path for Put Block list*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the XML as const char* so it can be passed to _ExecuteRequest*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG)) /*this is creating the XML body as BUFFER_HANDLE*/
+        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*This is the XML as BUFFER_HANDLE*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is destroying the relative path for Put Block List*/
+        .IgnoreArgument_handle();
+
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of hte hostname*/
+        .IgnoreArgument_ptr();
+
+    ///act
+    BLOB_RESULT result = Blob_ResumeMultipleBlocksFromSasUri("https://h.h/something?a=b", 2, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 200, httpResponse);
+
+    ///cleanup
+}
+
+/*Tests_SRS_BLOB_09_004: [ Blob_ResumeMultipleBlocksFromSasUri shall then upload the blocks returned by getDataCallbackEx starting with block id firstBlockID. ]*/
+TEST_FUNCTION(Blob_ResumeMultipleBlocksFromSasUri_when_blockCount_goes_over_maximum_fails)
+{
+    ///arrange
+    BLOB_UPLOAD_CONTEXT_FAKE fakeContext;
+    fakeContext.blockSent = 0;
+    fakeContext.blockSize = 1;
+    fakeContext.blocksCount = 2;
+    fakeContext.fakeData = NULL;
+    fakeContext.abortOnBlockNumber = -1;
+
+    ///act
+    BLOB_RESULT result = Blob_ResumeMultipleBlocksFromSasUri("https://h.h/something?a=b", MAX_BLOCK_COUNT - 1, FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+
+    ///cleanup
+    gballoc_free(fakeContext.fakeData);
+}
+
+/*Tests_SRS_BLOB_09_005: [ If contentEncoding is not NULL, Blob_UploadMultipleBlocksFromSasUri shall add the HTTP header "x-ms-blob-content-encoding: contentEncoding" to the Put Block List request. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_with_contentEncoding_sets_the_blob_content_encoding)
+{
+    ///arrange
+    unsigned char c = '3';
+    context.size = 1;
+    context.source = &c;
+    context.toUpload = context.size;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is creating a copy of the hostname */
+        .IgnoreArgument_size();
+
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h")); /*this is creating the httpapiex handle to storage (it is always the same host)*/
+    STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
+
+    /*uploading the only block (Put Block)*/
+    setup_Blob_UploadBlock_until_HTTPAPIEX_ExecuteRequest(&c);
+    setup_Blob_UploadBlock_HTTPAPIEX_ExecuteRequest(&TwoHundredOne);
+    setup_Blob_UploadBlock_cleanup();
+
+    /*this part is Put Block list*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_construct("/something?a=b")); /*this is building the relative path for the Put BLock list*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "&comp=blocklist")) /*This is still building relative path for Put Block list*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the XML as const char* so it can be passed to _ExecuteRequest*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG)) /*this is creating the XML body as BUFFER_HANDLE*/
+        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(HTTPHeaders_Alloc()); /*these are the headers of the Put Block List request*/
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "x-ms-blob-content-encoding", "gzip"))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestHttpHeadersHandle()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)) /*these were the headers of the Put Block List request*/
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*This is the XML as BUFFER_HANDLE*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is destroying the relative path for Put Block List*/
+        .IgnoreArgument_handle();
+
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of hte hostname*/
+        .IgnoreArgument_ptr();
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL, "gzip");
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 200, httpResponse);
+
+    ///cleanup
+}
+
+/*Tests_SRS_BLOB_09_006: [ If SASURI is NULL then Blob_UploadCreate shall fail and return NULL. ]*/
+TEST_FUNCTION(Blob_UploadCreate_with_NULL_SASURI_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_UPLOAD_HANDLE result = Blob_UploadCreate(NULL, NULL, NULL);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_008: [ If any operation fails then Blob_UploadCreate shall fail and return NULL. ]*/
+TEST_FUNCTION(Blob_UploadCreate_when_HTTPAPIEX_Create_fails_fails)
+{
+    ///arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is the handle, including the copy of the SASURI*/
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is creating a copy of the hostname */
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h"))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the handle*/
+        .IgnoreArgument_ptr();
+
+    ///act
+    BLOB_UPLOAD_HANDLE result = Blob_UploadCreate("https://h.h/something?a=b", NULL, NULL);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_007: [ Blob_UploadCreate shall keep a copy of SASURI and prepare the upload as Blob_UploadMultipleBlocksFromSasUri does before requesting the first block. ]*/
+/*Tests_SRS_BLOB_09_010: [ Otherwise Blob_UploadNextBlock shall upload source as the next block, as Blob_UploadMultipleBlocksFromSasUri does for each block returned by getDataCallbackEx. ]*/
+/*Tests_SRS_BLOB_09_012: [ Otherwise Blob_UploadCommit shall send the Put Block List request for the blocks uploaded so far, as Blob_UploadMultipleBlocksFromSasUri does after the last block. ]*/
+/*Tests_SRS_BLOB_09_014: [ Otherwise Blob_UploadDestroy shall free all resources held by blobUploadHandle. ]*/
+TEST_FUNCTION(Blob_UploadCreate_Blob_UploadNextBlock_Blob_UploadCommit_happy_path)
+{
+    ///arrange
+    unsigned char c = '3';
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is the handle, including the copy of the SASURI*/
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is creating a copy of the hostname */
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h")); /*this is creating the httpapiex handle to storage (it is always the same host)*/
+    STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
+
+    /*uploading the only block (Put Block)*/
+    setup_Blob_UploadBlock_until_HTTPAPIEX_ExecuteRequest(&c);
+    setup_Blob_UploadBlock_HTTPAPIEX_ExecuteRequest(&TwoHundredOne);
+    setup_Blob_UploadBlock_cleanup();
+
+    /*this part is Put Block list*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_construct("/something?a=b")); /*this is building the relative path for the Put BLock list*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "&comp=blocklist")) /*This is still building relative path for Put Block list*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the XML as const char* so it can be passed to _ExecuteRequest*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG)) /*this is creating the XML body as BUFFER_HANDLE*/
+        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*This is the XML as BUFFER_HANDLE*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is destroying the relative path for Put Block List*/
+        .IgnoreArgument_handle();
+
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the handle*/
+        .IgnoreArgument_ptr();
+
+    ///act
+    BLOB_UPLOAD_HANDLE h = Blob_UploadCreate("https://h.h/something?a=b", NULL, NULL);
+    BLOB_RESULT blockResult = Blob_UploadNextBlock(h, &c, 1, &httpResponse, testValidBufferHandle);
+    unsigned int blockHttpResponse = httpResponse;
+    BLOB_RESULT commitResult = Blob_UploadCommit(h, NULL, &httpResponse, testValidBufferHandle);
+    Blob_UploadDestroy(h);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, blockResult);
+    ASSERT_ARE_EQUAL(int, 201, blockHttpResponse);
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, commitResult);
+    ASSERT_ARE_EQUAL(int, 200, httpResponse);
+
+    ///cleanup
+}
+
+/*Tests_SRS_BLOB_09_010: [ Otherwise Blob_UploadNextBlock shall upload source as the next block, as Blob_UploadMultipleBlocksFromSasUri does for each block returned by getDataCallbackEx, but with a single request and without waiting. ]*/
+/*Tests_SRS_BLOB_09_021: [ If storage answers with a server error (5xx), Blob_UploadNextBlock shall return BLOB_OK and keep the block id, so that the next call to Blob_UploadNextBlock sends the block again under the same id. ]*/
+TEST_FUNCTION(Blob_UploadNextBlock_when_http_code_is_503_returns_without_waiting_and_sends_the_block_again_under_the_same_id)
+{
+    ///arrange
+    unsigned char c = '3';
+    BLOB_UPLOAD_HANDLE h = Blob_UploadCreate("https://h.h/something?a=b", NULL, NULL);
+    umock_c_reset_all_calls();
+
+    /*first attempt, the block id is added to the XML, storage is busy and there is no retry*/
+    setup_Blob_UploadBlock_until_HTTPAPIEX_ExecuteRequest(&c);
+    setup_Blob_UploadBlock_HTTPAPIEX_ExecuteRequest(&FiveHundredThree);
+    setup_Blob_UploadBlock_cleanup();
+
+    /*second attempt, the block id is only encoded because it is already in the XML*/
+    STRICT_EXPECTED_CALL(BUFFER_create(&c, 1));
+    STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6))
+        .IgnoreArgument_source();
+    STRICT_EXPECTED_CALL(STRING_construct("/something?a=b"));
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "&comp=block&blockid="))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_s1()
+        .IgnoreArgument_s2();
+    setup_Blob_UploadBlock_HTTPAPIEX_ExecuteRequest(&TwoHundredOne);
+    setup_Blob_UploadBlock_cleanup();
+
+    ///act
+    BLOB_RESULT firstResult = Blob_UploadNextBlock(h, &c, 1, &httpResponse, testValidBufferHandle);
+    unsigned int firstHttpResponse = httpResponse;
+    BLOB_RESULT secondResult = Blob_UploadNextBlock(h, &c, 1, &httpResponse, testValidBufferHandle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, firstResult);
+    ASSERT_ARE_EQUAL(int, 503, firstHttpResponse);
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, secondResult);
+    ASSERT_ARE_EQUAL(int, 201, httpResponse);
+
+    ///cleanup
+    Blob_UploadDestroy(h);
+    httpResponse = 0;
+}
+
+/*Tests_SRS_BLOB_09_009: [ If blobUploadHandle, source, httpStatus or httpResponse is NULL or size is 0 then Blob_UploadNextBlock shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadNextBlock_with_NULL_handle_fails)
+{
+    ///arrange
+    unsigned char c = '3';
+
+    ///act
+    BLOB_RESULT result = Blob_UploadNextBlock(NULL, &c, 1, &httpResponse, testValidBufferHandle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_011: [ If blobUploadHandle, httpStatus or httpResponse is NULL then Blob_UploadCommit shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadCommit_with_NULL_handle_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadCommit(NULL, NULL, &httpResponse, testValidBufferHandle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_013: [ If blobUploadHandle is NULL then Blob_UploadDestroy shall return. ]*/
+TEST_FUNCTION(Blob_UploadDestroy_with_NULL_handle_does_nothing)
+{
+    ///arrange
+
+    ///act
+    Blob_UploadDestroy(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 /*Tests_SRS_BLOB_99_001: [ If the size of the block returned by `getDataCallback` is bigger than 4MB, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
 TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_blockSize_too_big_fails)
 {
@@ -1510,7 +2064,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_blockSize_too_big_fails)
     fakeContext.abortOnBlockNumber = -1;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
@@ -1531,7 +2085,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_blockSize_is_4MB_succeeds
     fakeContext.abortOnBlockNumber = -1;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
@@ -1552,7 +2106,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_blockCount_is_maximum_suc
     fakeContext.abortOnBlockNumber = -1;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
@@ -1573,7 +2127,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_blockCount_is_one_over_ma
     fakeContext.abortOnBlockNumber = -1;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
@@ -1594,7 +2148,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_returns_BLOB_ABORTED_when_call
     fakeContext.abortOnBlockNumber = 0;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_ABORTED, result);
@@ -1615,7 +2169,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_returns_BLOB_ABORTED_when_call
     fakeContext.abortOnBlockNumber = 5;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, NULL);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_ABORTED, result);
@@ -1624,4 +2178,145 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_returns_BLOB_ABORTED_when_call
     gballoc_free(fakeContext.fakeData);
 }
 
+/*Tests_SRS_BLOB_09_015: [ If filePath or size is NULL then Blob_MapFile shall fail and return NULL. ]*/
+TEST_FUNCTION(Blob_MapFile_with_NULL_filePath_fails)
+{
+    ///arrange
+    size_t size;
+
+    ///act
+    BLOB_FILE_MAPPING_HANDLE result = Blob_MapFile(NULL, &size);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_015: [ If filePath or size is NULL then Blob_MapFile shall fail and return NULL. ]*/
+TEST_FUNCTION(Blob_MapFile_with_NULL_size_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_FILE_MAPPING_HANDLE result = Blob_MapFile("local.txt", NULL);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_022: [ If fileMapping or data is NULL, or the bytes offset to offset + size - 1 are not within the size returned by Blob_MapFile, then Blob_ReadFileBlock shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Blob_ReadFileBlock_with_NULL_fileMapping_fails)
+{
+    ///arrange
+    const unsigned char* data;
+
+    ///act
+    int result = Blob_ReadFileBlock(NULL, 0, 1, &data);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TEST_LOCAL_FILE "blob_ut_local_file.bin"
+
+static void write_test_local_file(size_t size)
+{
+    size_t i;
+    FILE* file = fopen(TEST_LOCAL_FILE, "wb");
+    ASSERT_IS_NOT_NULL(file);
+    for (i = 0; i < size; i++)
+    {
+        (void)fputc((int)(i & 0xFF), file);
+    }
+    (void)fclose(file);
+}
+
+/*Tests_SRS_BLOB_09_016: [ Blob_MapFile shall open the file read only and return its size in size. On Windows the whole file is mapped, an empty file is not mapped. On POSIX platforms the file is only kept open. ]*/
+/*Tests_SRS_BLOB_09_024: [ On POSIX platforms Blob_ReadFileBlock shall read the bytes with pread into a buffer owned by fileMapping, which is valid until the next call or Blob_UnmapFile, and return its address in data. ]*/
+TEST_FUNCTION(Blob_ReadFileBlock_returns_the_bytes_of_the_file)
+{
+    ///arrange
+    const unsigned char* data;
+    size_t size;
+    BLOB_FILE_MAPPING_HANDLE fileMapping;
+    int result;
+    write_test_local_file(10);
+
+    ///act
+    fileMapping = Blob_MapFile(TEST_LOCAL_FILE, &size);
+    result = Blob_ReadFileBlock(fileMapping, 4, 3, &data);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(fileMapping);
+    ASSERT_ARE_EQUAL(size_t, 10, size);
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 4, (int)data[0]);
+    ASSERT_ARE_EQUAL(int, 6, (int)data[2]);
+
+    ///cleanup
+    Blob_UnmapFile(fileMapping);
+    (void)remove(TEST_LOCAL_FILE);
+}
+
+/*Tests_SRS_BLOB_09_022: [ If fileMapping or data is NULL, or the bytes offset to offset + size - 1 are not within the size returned by Blob_MapFile, then Blob_ReadFileBlock shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Blob_ReadFileBlock_past_the_end_of_the_file_fails)
+{
+    ///arrange
+    const unsigned char* data;
+    size_t size;
+    BLOB_FILE_MAPPING_HANDLE fileMapping;
+    int result;
+    write_test_local_file(10);
+    fileMapping = Blob_MapFile(TEST_LOCAL_FILE, &size);
+
+    ///act
+    result = Blob_ReadFileBlock(fileMapping, 8, 3, &data);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    ///cleanup
+    Blob_UnmapFile(fileMapping);
+    (void)remove(TEST_LOCAL_FILE);
+}
+
+/*Tests_SRS_BLOB_09_025: [ If the file is shorter than offset + size, because it was truncated after Blob_MapFile, or reading fails, then Blob_ReadFileBlock shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Blob_ReadFileBlock_fails_when_the_file_was_truncated)
+{
+    ///arrange
+    const unsigned char* data;
+    size_t size;
+    BLOB_FILE_MAPPING_HANDLE fileMapping;
+    int result;
+    write_test_local_file(10);
+    fileMapping = Blob_MapFile(TEST_LOCAL_FILE, &size);
+    ASSERT_ARE_EQUAL(int, 0, truncate(TEST_LOCAL_FILE, 5));
+
+    ///act
+    result = Blob_ReadFileBlock(fileMapping, 4, 3, &data);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    ///cleanup
+    Blob_UnmapFile(fileMapping);
+    (void)remove(TEST_LOCAL_FILE);
+}
+#endif
+
+/*Tests_SRS_BLOB_09_018: [ If fileMapping is NULL then Blob_UnmapFile shall return. ]*/
+TEST_FUNCTION(Blob_UnmapFile_with_NULL_fileMapping_does_nothing)
+{
+    ///arrange
+
+    ///act
+    Blob_UnmapFile(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 END_TEST_SUITE(blob_ut);
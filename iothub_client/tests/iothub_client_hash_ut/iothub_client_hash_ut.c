@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+#include "testrunnerswitcher.h"
+
+#include "iothub_client_hash.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+BEGIN_TEST_SUITE(iothub_client_hash_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_HASH_09_001: [`iothub_client_hash_string` shall return the 32 bit FNV-1a hash of the characters of `value` up to its terminating null character]
+TEST_FUNCTION(iothub_client_hash_string_returns_the_FNV_1a_hash)
+{
+    // act
+    uint32_t hash_a = iothub_client_hash_string("a");
+    uint32_t hash_foobar = iothub_client_hash_string("foobar");
+    uint32_t hash_device_id = iothub_client_hash_string("deviceId");
+
+    // assert
+    ASSERT_ARE_EQUAL(uint32_t, 0xe40c292cu, hash_a);
+    ASSERT_ARE_EQUAL(uint32_t, 0xbf9cf968u, hash_foobar);
+    ASSERT_ARE_EQUAL(uint32_t, 0x7c291d9eu, hash_device_id);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_HASH_09_001: [`iothub_client_hash_string` shall return the 32 bit FNV-1a hash of the characters of `value` up to its terminating null character]
+TEST_FUNCTION(iothub_client_hash_string_of_empty_string_is_the_offset_basis)
+{
+    // act
+    uint32_t hash = iothub_client_hash_string("");
+
+    // assert
+    ASSERT_ARE_EQUAL(uint32_t, 0x811c9dc5u, hash);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_HASH_09_002: [If `value` is NULL, `iothub_client_hash_string` shall return the hash of an empty string]
+TEST_FUNCTION(iothub_client_hash_string_NULL_value)
+{
+    // act
+    uint32_t hash = iothub_client_hash_string(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(uint32_t, 0x811c9dc5u, hash);
+}
+
+END_TEST_SUITE(iothub_client_hash_ut)
@@ -9,6 +9,7 @@
 #include <cstdlib>
 #else
 #include <stdlib.h>
+#include <stdbool.h>
 #endif
 
 static void* my_gballoc_malloc(size_t size)
@@ -46,6 +47,7 @@ static void* my_gballoc_calloc(size_t nmemb, size_t size)
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/urlencode.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #include "blob.h"
 #include "parson.h"
 
@@ -53,6 +55,12 @@ MOCKABLE_FUNCTION(, JSON_Value*, json_parse_string, const char *, string);
 MOCKABLE_FUNCTION(, const char*, json_object_get_string, const JSON_Object *, object, const char *, name);
 MOCKABLE_FUNCTION(, void, json_value_free, JSON_Value *, value);
 MOCKABLE_FUNCTION(, JSON_Object*, json_value_get_object, const JSON_Value *, value);
+MOCKABLE_FUNCTION(, double, json_object_get_number, const JSON_Object *, object, const char *, name);
+MOCKABLE_FUNCTION(, JSON_Value*, json_value_init_object);
+MOCKABLE_FUNCTION(, JSON_Status, json_object_set_string, JSON_Object *, object, const char *, name, const char *, string);
+MOCKABLE_FUNCTION(, JSON_Status, json_object_set_number, JSON_Object *, object, const char *, name, double, number);
+MOCKABLE_FUNCTION(, char*, json_serialize_to_string, const JSON_Value *, value);
+MOCKABLE_FUNCTION(, void, json_free_serialized_string, char *, string);
 
 static STRING_HANDLE my_STRING_construct(const char* psz)
 {
@@ -79,6 +87,12 @@ static STRING_HANDLE my_STRING_from_byte_array(const unsigned char* source, size
     return (STRING_HANDLE)malloc(1);
 }
 
+static STRING_HANDLE my_STRING_clone(STRING_HANDLE handle)
+{
+    (void)handle;
+    return (STRING_HANDLE)malloc(1);
+}
+
 static void my_STRING_delete(STRING_HANDLE handle)
 {
     free(handle);
@@ -95,6 +109,12 @@ static HTTP_HEADERS_HANDLE my_HTTPHeaders_Alloc(void)
     return (HTTP_HEADERS_HANDLE)malloc(1);
 }
 
+static HTTP_HEADERS_HANDLE my_HTTPHeaders_Clone(HTTP_HEADERS_HANDLE h)
+{
+    (void)h;
+    return (HTTP_HEADERS_HANDLE)malloc(1);
+}
+
 static void my_HTTPHeaders_Free(HTTP_HEADERS_HANDLE h)
 {
     free(h);
@@ -160,6 +180,36 @@ static void my_json_value_free(JSON_Value *value)
     free(value);
 }
 
+static JSON_Value* my_json_value_init_object(void)
+{
+    return (JSON_Value *)malloc(1);
+}
+
+#define TEST_RESUME_TOKEN "{\"correlationId\":\"3\",\"sasUri\":\"3\",\"blockCount\":2,\"bytesUploaded\":8388608}"
+
+static char* my_json_serialize_to_string(const JSON_Value *value)
+{
+    char* result = (char*)malloc(sizeof(TEST_RESUME_TOKEN));
+    (void)value;
+    (void)memcpy(result, TEST_RESUME_TOKEN, sizeof(TEST_RESUME_TOKEN));
+    return result;
+}
+
+static void my_json_free_serialized_string(char *string)
+{
+    free(string);
+}
+
+/*the numbers in the resume token parsed by the mocked parson*/
+static double test_token_block_count;
+static double test_token_bytes_uploaded;
+
+static double my_json_object_get_number(const JSON_Object *object, const char *name)
+{
+    (void)object;
+    return (strcmp(name, "blockCount") == 0) ? test_token_block_count : test_token_bytes_uploaded;
+}
+
 static HTTPAPIEX_RESULT my_HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
     HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, unsigned int* statusCode,
     HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
@@ -286,6 +336,67 @@ static TEST_MUTEX_HANDLE g_dllByDll;
 
 DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
 
+/*when set, the mocked Blob_UploadMultipleBlocksFromSasUri asks for the first block and records its size*/
+static bool get_first_block_in_Blob_UploadMultipleBlocksFromSasUri;
+static size_t first_block_size;
+
+/*when not negative, the mocked step 2 asks for this many blocks, which Azure Storage stores, then for the block whose upload is interrupted by an HTTP error*/
+static int blocks_stored_before_interruption;
+
+static BLOB_RESULT interrupt_step2(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
+{
+    int i;
+    for (i = 0; i <= blocks_stored_before_interruption; i++)
+    {
+        unsigned char const * data;
+        size_t size;
+        (void)getDataCallbackEx(FILE_UPLOAD_OK, &data, &size, context);
+    }
+    return BLOB_HTTP_ERROR;
+}
+
+static BLOB_RESULT my_Blob_UploadMultipleBlocksFromSasUri(const char* SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates, HTTP_PROXY_OPTIONS* proxyOptions, const char* contentEncoding)
+{
+    BLOB_RESULT result = BLOB_OK;
+    (void)SASURI;
+    (void)httpResponse;
+    (void)certificates;
+    (void)proxyOptions;
+    (void)contentEncoding;
+    if (blocks_stored_before_interruption >= 0)
+    {
+        result = interrupt_step2(getDataCallbackEx, context);
+    }
+    else if (get_first_block_in_Blob_UploadMultipleBlocksFromSasUri)
+    {
+        unsigned char const * data;
+        (void)getDataCallbackEx(FILE_UPLOAD_OK, &data, &first_block_size, context);
+        *httpStatus = 200;
+    }
+    return result;
+}
+
+static BLOB_RESULT my_Blob_ResumeMultipleBlocksFromSasUri(const char* SASURI, unsigned int firstBlockID, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates, HTTP_PROXY_OPTIONS* proxyOptions, const char* contentEncoding)
+{
+    BLOB_RESULT result;
+    (void)SASURI;
+    (void)firstBlockID;
+    (void)httpResponse;
+    (void)certificates;
+    (void)proxyOptions;
+    (void)contentEncoding;
+    if (blocks_stored_before_interruption >= 0)
+    {
+        result = interrupt_step2(getDataCallbackEx, context);
+    }
+    else
+    {
+        *httpStatus = 200;
+        result = BLOB_OK;
+    }
+    return result;
+}
+
 static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 {
     char temp_str[256];
@@ -304,6 +415,26 @@ static const TRANSPORT_PROVIDER* provideFAKE(void);
 
 #define TEST_STRING_HANDLE_DEVICE_ID ((STRING_HANDLE)0x1)
 #define TEST_STRING_HANDLE_DEVICE_SAS ((STRING_HANDLE)0x2)
+#define TEST_BLOB_UPLOAD_HANDLE ((BLOB_UPLOAD_HANDLE)0x3)
+#define TEST_BLOB_FILE_MAPPING_HANDLE ((BLOB_FILE_MAPPING_HANDLE)0x4)
+#define TEST_MAPPED_FILE ((const unsigned char*)0x5) /*never dereferenced, blocks are only handed over to the mocked Blob_UploadMultipleBlocksFromSasUri*/
+
+static size_t test_mapped_file_size;
+
+static BLOB_FILE_MAPPING_HANDLE my_Blob_MapFile(const char* filePath, size_t* size)
+{
+    (void)filePath;
+    *size = test_mapped_file_size;
+    return TEST_BLOB_FILE_MAPPING_HANDLE;
+}
+
+static int my_Blob_ReadFileBlock(BLOB_FILE_MAPPING_HANDLE fileMapping, size_t offset, size_t size, const unsigned char** data)
+{
+    (void)fileMapping;
+    (void)size;
+    *data = TEST_MAPPED_FILE + offset;
+    return 0;
+}
 
 #define TEST_API_VERSION "?api-version=2016-11-14"
 #define TEST_IOTHUB_SDK_VERSION "1.2.4"
@@ -344,7 +475,28 @@ static const TRANSPORT_PROVIDER* provideFAKE(void)
 }
 
 static const unsigned int TwoHundred = 200;
+static const unsigned int TwoHundredOne = 201;
 static const unsigned int FourHundred = 400;
+static const unsigned int FiveHundredThree = 503;
+
+static tickcounter_ms_t g_current_ms;
+
+static TICK_COUNTER_HANDLE my_tickcounter_create(void)
+{
+    return (TICK_COUNTER_HANDLE)my_gballoc_malloc(1);
+}
+
+static void my_tickcounter_destroy(TICK_COUNTER_HANDLE tick_counter)
+{
+    my_gballoc_free(tick_counter);
+}
+
+static int my_tickcounter_get_current_ms(TICK_COUNTER_HANDLE tick_counter, tickcounter_ms_t * current_ms)
+{
+    (void)tick_counter;
+    *current_ms = g_current_ms;
+    return 0;
+}
 
 static unsigned char TestValid_BUFFER_u_char[] = { '3', '\0' };
 
@@ -379,6 +531,11 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(const unsigned char*, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(BLOB_UPLOAD_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(TICK_COUNTER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(BLOB_FILE_MAPPING_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(const unsigned char**, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(JSON_Status, int);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
@@ -395,10 +552,12 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_RETURN(STRING_concat_with_STRING, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_concat_with_STRING, __FAILURE__);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_copy, __FAILURE__);
+    REGISTER_GLOBAL_MOCK_HOOK(STRING_clone, my_STRING_clone);
     REGISTER_GLOBAL_MOCK_HOOK(STRING_delete, my_STRING_delete);
     REGISTER_GLOBAL_MOCK_HOOK(URL_EncodeString, my_URL_EncodeString);
 
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Alloc, my_HTTPHeaders_Alloc);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Clone, my_HTTPHeaders_Clone);
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Free, my_HTTPHeaders_Free);
 
     REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Create, my_HTTPAPIEX_Create);
@@ -422,6 +581,16 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_RETURN(json_value_get_object, (JSON_Object*)1);
     REGISTER_GLOBAL_MOCK_RETURN(json_object_get_string, "a");
     REGISTER_GLOBAL_MOCK_HOOK(json_value_free, my_json_value_free);
+    REGISTER_GLOBAL_MOCK_HOOK(json_object_get_number, my_json_object_get_number);
+    REGISTER_GLOBAL_MOCK_HOOK(json_value_init_object, my_json_value_init_object);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_value_init_object, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(json_object_set_string, JSONSuccess);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_set_string, JSONFailure);
+    REGISTER_GLOBAL_MOCK_RETURN(json_object_set_number, JSONSuccess);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_set_number, JSONFailure);
+    REGISTER_GLOBAL_MOCK_HOOK(json_serialize_to_string, my_json_serialize_to_string);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_serialize_to_string, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(json_free_serialized_string, my_json_free_serialized_string);
     
 
     REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_OK);
@@ -435,7 +604,23 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_ExecuteRequest, HTTPAPIEX_ERROR);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_SetOption, HTTPAPIEX_ERROR);
 
+    REGISTER_GLOBAL_MOCK_HOOK(Blob_UploadMultipleBlocksFromSasUri, my_Blob_UploadMultipleBlocksFromSasUri);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(Blob_UploadMultipleBlocksFromSasUri, BLOB_ERROR);
+    REGISTER_GLOBAL_MOCK_HOOK(Blob_ResumeMultipleBlocksFromSasUri, my_Blob_ResumeMultipleBlocksFromSasUri);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Blob_ResumeMultipleBlocksFromSasUri, BLOB_ERROR);
+    REGISTER_GLOBAL_MOCK_HOOK(Blob_MapFile, my_Blob_MapFile);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Blob_MapFile, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(Blob_ReadFileBlock, my_Blob_ReadFileBlock);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Blob_ReadFileBlock, __FAILURE__);
+    REGISTER_GLOBAL_MOCK_RETURN(Blob_UploadCreate, TEST_BLOB_UPLOAD_HANDLE);
+
+    REGISTER_GLOBAL_MOCK_HOOK(tickcounter_create, my_tickcounter_create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(tickcounter_destroy, my_tickcounter_destroy);
+    REGISTER_GLOBAL_MOCK_HOOK(tickcounter_get_current_ms, my_tickcounter_get_current_ms);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_get_current_ms, __FAILURE__);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Blob_UploadCreate, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(BUFFER_u_char, TestValid_BUFFER_u_char);
 
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, __FAILURE__);
     REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
@@ -452,6 +637,13 @@ TEST_SUITE_CLEANUP(TestClassCleanup)
 static void reset_test_data()
 {
     memset(&context, 0, sizeof(context));
+    test_mapped_file_size = 0;
+    get_first_block_in_Blob_UploadMultipleBlocksFromSasUri = false;
+    first_block_size = 0;
+    blocks_stored_before_interruption = -1;
+    test_token_block_count = 0;
+    test_token_bytes_uploaded = 0;
+    g_current_ms = 0;
 }
 
 TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
@@ -642,6 +834,26 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_with_NULL_source_and_non_zero_size_fa
     IoTHubClient_LL_UploadToBlob_Destroy(h);
 }
 
+#if SIZE_MAX > UINT32_MAX
+/*Tests_SRS_IOTHUBCLIENT_LL_09_012: [ If size is bigger than MAX_BLOCK_COUNT * BLOCK_SIZE then IoTHubClient_LL_UploadToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG without contacting IoT Hub. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_with_size_over_maximum_blob_size_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_Impl(h, "text.txt", (const unsigned char*)"a", (size_t)MAX_BLOCK_COUNT * BLOCK_SIZE + 1);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+#endif
+
 /*Tests_SRS_IOTHUBCLIENT_LL_99_001: [ IoTHubClient_LL_UploadToBlob shall create a struct containing the source, the size, and the remaining size to upload. ]*/
 /*Tests_SRS_IOTHUBCLIENT_LL_99_002: [ IoTHubClient_LL_UploadToBlob shall call IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl with FileUpload_GetData_Callback as getDataCallback and pass the struct created at step SRS_IOTHUBCLIENT_LL_99_001 as context ]*/
 /*Tests_SRS_IOTHUBCLIENT_LL_02_064: [ IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall create an HTTPAPIEX_HANDLE to the IoTHub hostname. ]*/
@@ -867,7 +1079,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_happypath)
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL))
             .IgnoreArgument(1)
             .IgnoreArgument(4)
             .IgnoreArgument(5)
@@ -1195,7 +1407,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_with_certificates_happypath
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, "some certificates", IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, "some certificates", IGNORED_PTR_ARG, NULL))
             .IgnoreArgument(1)
             .IgnoreArgument(4)
             .IgnoreArgument(5)
@@ -1693,7 +1905,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_httpStatusCode_i
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL))
             .IgnoreArgument(1)
             .IgnoreArgument(4)
             .IgnoreArgument(5)
@@ -2018,7 +2230,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_aborts_succeeds)
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL))
             .IgnoreArgument(1)
             .IgnoreArgument(4)
             .IgnoreArgument(5)
@@ -2332,7 +2544,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_aborts_unhappypa
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL))
             .IgnoreArgument(1)
             .IgnoreArgument(4)
             .IgnoreArgument(5)
@@ -2691,7 +2903,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step3_httpStatusCode_i
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL))
             .IgnoreArgument(1)
             .IgnoreArgument(4)
             .IgnoreArgument(5)
@@ -3026,7 +3238,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_unhappypaths)
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL))
             .IgnoreArgument(1)
             .IgnoreArgument(4)
             .IgnoreArgument(5)
@@ -3525,7 +3737,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_happypath)
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL))
             .IgnoreArgument(1)
             .IgnoreArgument(4)
             .IgnoreArgument(5)
@@ -3884,7 +4096,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_with_timeout_
         .CaptureReturn(&sasUri_as_const_char)
         .IgnoreArgument(1);
         
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL))
         .IgnoreArgument(1)
         .IgnoreArgument(4)
         .IgnoreArgument(5)
@@ -4380,7 +4592,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_deviceKey_when_step3_httpStatusCode_i
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL))
             .IgnoreArgument(1)
             .IgnoreArgument(4)
             .IgnoreArgument(5)
@@ -4735,7 +4947,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_unhappypaths)
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL))
             .IgnoreArgument(1)
             .IgnoreArgument(4)
             .IgnoreArgument(5)
@@ -5132,7 +5344,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_passes_x509_information_to_HTTPAPIEX_
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL))
             .IgnoreArgument(1)
             .IgnoreArgument(4)
             .IgnoreArgument(5)
@@ -5462,7 +5674,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_passes_x509_information_to_HTTPAPIEX_
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL))
             .IgnoreArgument(1)
             .IgnoreArgument(4)
             .IgnoreArgument(5)
@@ -5684,6 +5896,89 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_x509privatekey_succeeds)
     IoTHubClient_LL_UploadToBlob_Destroy(h);
 }
 
+/*Tests_SRS_IOTHUBCLIENT_LL_09_013: [ blob_upload_content_encoding - value is a null terminated string that is saved and passed as contentEncoding to Blob_UploadMultipleBlocksFromSasUri. Only "identity" is accepted. An empty string clears the saved value. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_blob_upload_content_encoding_succeeds)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "identity"))
+        .IgnoreArgument_destination();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_CONTENT_ENCODING, "identity");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_013: [ blob_upload_content_encoding - value is a null terminated string that is saved and passed as contentEncoding to Blob_UploadMultipleBlocksFromSasUri. Only "identity" is accepted. An empty string clears the saved value. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_blob_upload_content_encoding_fails_when_saving_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "identity"))
+        .IgnoreArgument_destination()
+        .SetReturn(__FAILURE__);
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_CONTENT_ENCODING, "identity");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_013: [ blob_upload_content_encoding - value is a null terminated string that is saved and passed as contentEncoding to Blob_UploadMultipleBlocksFromSasUri. Only "identity" is accepted. An empty string clears the saved value. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_blob_upload_content_encoding_empty_string_clears_value)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    (void)IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_CONTENT_ENCODING, "identity");
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_CONTENT_ENCODING, "");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_067: [ If the value of blob_upload_content_encoding is neither an empty string nor "identity" then IoTHubClient_LL_UploadToBlob_SetOption shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_blob_upload_content_encoding_gzip_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    (void)IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_CONTENT_ENCODING, "identity");
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_CONTENT_ENCODING, "gzip");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
 /*Tests_SRS_IOTHUBCLIENT_LL_02_102: [ If an unknown option is presented then IoTHubClient_LL_UploadToBlob_SetOption shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
 TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_x509unknownoption_fails)
 {
@@ -5780,5 +6075,1112 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_x509privatekey_fails_when_s
     IoTHubClient_LL_UploadToBlob_Destroy(h);
 }
 
+/*Tests_SRS_IOTHUBCLIENT_LL_09_014: [ If handle, destinationFileName or getDataCallbackEx is NULL then IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl_with_NULL_handle_fails)
+{
+    ///arrange
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(NULL, "text.txt", FileUpload_GetData_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_015: [ IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl shall save a copy of destinationFileName, getDataCallbackEx and context in a new pending upload and return IOTHUB_CLIENT_OK without performing any I/O. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl_does_not_perform_IO)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "text.txt"))
+        .IgnoreArgument_destination();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(h, "text.txt", FileUpload_GetData_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_016: [ If any operation fails then IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl_fails_when_mallocAndStrcpy_s_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "text.txt"))
+        .IgnoreArgument_destination()
+        .SetReturn(__FAILURE__);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(h, "text.txt", FileUpload_GetData_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_017: [ If handle is NULL then IoTHubClient_LL_UploadToBlob_DoWork shall return. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_DoWork_with_NULL_handle_does_nothing)
+{
+    ///arrange
+
+    ///act
+    IoTHubClient_LL_UploadToBlob_DoWork(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_018: [ For a pending upload that has not started, IoTHubClient_LL_UploadToBlob_DoWork shall perform steps 1 and 2 as IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) does and call Blob_UploadCreate with the SAS URI. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_020: [ Otherwise IoTHubClient_LL_UploadToBlob_DoWork shall call getDataCallbackEx with FILE_UPLOAD_OK once and upload the returned block with Blob_UploadNextBlock. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_021: [ When getDataCallbackEx returns no data the next call to IoTHubClient_LL_UploadToBlob_DoWork shall commit the blob with Blob_UploadCommit. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_022: [ When step 2 is over IoTHubClient_LL_UploadToBlob_DoWork shall perform step 3 as IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) does. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_023: [ When the upload is over IoTHubClient_LL_UploadToBlob_DoWork shall call getDataCallbackEx with FILE_UPLOAD_OK or FILE_UPLOAD_ERROR, and data and size set to NULL, and then free the pending upload. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_DoWork_advances_the_upload_one_step_per_call)
+{
+    ///arrange
+    context.source = (const unsigned char*)"a";
+    context.size = 1;
+    context.toUpload = context.size;
+
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    (void)IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(h, "text.txt", FileUpload_GetData_Callback, &context);
+
+    ///act & assert
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*steps 1 and 2, no block is requested yet*/
+    ASSERT_ARE_EQUAL(size_t, 1, context.toUpload);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Blob_UploadNextBlock(TEST_BLOB_UPLOAD_HANDLE, IGNORED_PTR_ARG, 1, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_source()
+        .IgnoreArgument_httpStatus()
+        .IgnoreArgument_httpResponse();
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*the only block*/
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, context.toUpload);
+
+    umock_c_reset_all_calls();
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*getDataCallbackEx has no more data*/
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(context.lastData);
+
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*Put Block List and step 3*/
+    ASSERT_IS_NULL(context.lastData);
+    ASSERT_IS_NULL(context.lastSize);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, FILE_UPLOAD_OK, context.lastResult);
+
+    umock_c_reset_all_calls();
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*nothing left to do*/
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_054: [ IoTHubClient_LL_UploadToBlob_DoWork shall advance only the first pending upload and then move it to the end of the pending uploads, so that each call performs at most one request to Azure Storage and the pending uploads take turns. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_DoWork_pending_uploads_take_turns)
+{
+    ///arrange
+    BLOB_UPLOAD_CONTEXT first;
+    BLOB_UPLOAD_CONTEXT second;
+    memset(&first, 0, sizeof(first));
+    memset(&second, 0, sizeof(second));
+    first.source = (const unsigned char*)"a";
+    first.size = 1;
+    first.toUpload = first.size;
+    second.source = (const unsigned char*)"b";
+    second.size = 1;
+    second.toUpload = second.size;
+
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    (void)IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(h, "first.txt", FileUpload_GetData_Callback, &first);
+    (void)IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(h, "second.txt", FileUpload_GetData_Callback, &second);
+
+    ///act & assert
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*steps 1 and 2 of the first upload*/
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*steps 1 and 2 of the second upload*/
+    ASSERT_ARE_EQUAL(size_t, 1, first.toUpload);
+    ASSERT_ARE_EQUAL(size_t, 1, second.toUpload);
+
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*the block of the first upload*/
+    ASSERT_ARE_EQUAL(size_t, 0, first.toUpload);
+    ASSERT_ARE_EQUAL(size_t, 1, second.toUpload);
+
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*the block of the second upload*/
+    ASSERT_ARE_EQUAL(size_t, 0, second.toUpload);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+static size_t progress_count;
+static char progress_destinationFileName[32];
+static size_t progress_bytesUploaded;
+static void* progress_context;
+static void FileUpload_Progress_Callback(const char* destinationFileName, size_t bytesUploaded, void* progressContext)
+{
+    (void)strcpy(progress_destinationFileName, destinationFileName);
+    progress_bytesUploaded = bytesUploaded;
+    progress_context = progressContext;
+    progress_count++;
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_051: [ If handle is NULL then IoTHubClient_LL_UploadToBlob_SetProgressCallback shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetProgressCallback_with_NULL_handle_fails)
+{
+    ///arrange
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_SetProgressCallback(NULL, FileUpload_Progress_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_052: [ Otherwise IoTHubClient_LL_UploadToBlob_SetProgressCallback shall save progressCallback and context, replacing any previous ones, and return IOTHUB_CLIENT_OK. A NULL progressCallback stops the notifications. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_053: [ After Azure Storage accepts a block IoTHubClient_LL_UploadToBlob_DoWork shall call the progress callback, if any, with the destinationFileName of the upload, the number of bytes of that upload stored so far and the progress callback context. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_DoWork_reports_progress_after_each_block)
+{
+    ///arrange
+    int progressContext = 1;
+    context.source = (const unsigned char*)"a";
+    context.size = BLOCK_SIZE + 1;
+    context.toUpload = context.size;
+    progress_count = 0;
+
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_SetProgressCallback(h, FileUpload_Progress_Callback, &progressContext);
+    (void)IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(h, "text.txt", FileUpload_GetData_Callback, &context);
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*steps 1 and 2*/
+
+    ///act & assert
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*first block*/
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 1, progress_count);
+    ASSERT_ARE_EQUAL(char_ptr, "text.txt", progress_destinationFileName);
+    ASSERT_ARE_EQUAL(size_t, BLOCK_SIZE, progress_bytesUploaded);
+    ASSERT_ARE_EQUAL(void_ptr, &progressContext, progress_context);
+
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*second block*/
+    ASSERT_ARE_EQUAL(size_t, 2, progress_count);
+    ASSERT_ARE_EQUAL(size_t, BLOCK_SIZE + 1, progress_bytesUploaded);
+
+    (void)IoTHubClient_LL_UploadToBlob_SetProgressCallback(h, NULL, NULL);
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*no more data*/
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*Put Block List and step 3*/
+    ASSERT_ARE_EQUAL(size_t, 2, progress_count);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_053: [ After Azure Storage accepts a block IoTHubClient_LL_UploadToBlob_DoWork shall call the progress callback, if any, with the destinationFileName of the upload, the number of bytes of that upload stored so far and the progress callback context. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_DoWork_does_not_report_progress_for_a_failed_block)
+{
+    ///arrange
+    int progressContext = 1;
+    context.source = (const unsigned char*)"a";
+    context.size = 1;
+    context.toUpload = context.size;
+    progress_count = 0;
+
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    (void)IoTHubClient_LL_UploadToBlob_SetProgressCallback(h, FileUpload_Progress_Callback, &progressContext);
+    (void)IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(h, "text.txt", FileUpload_GetData_Callback, &context);
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*steps 1 and 2*/
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Blob_UploadNextBlock(TEST_BLOB_UPLOAD_HANDLE, IGNORED_PTR_ARG, 1, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_source()
+        .IgnoreArgument_httpStatus()
+        .IgnoreArgument_httpResponse()
+        .SetReturn(BLOB_ERROR);
+
+    ///act
+    IoTHubClient_LL_UploadToBlob_DoWork(h);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 0, progress_count);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, FILE_UPLOAD_ERROR, context.lastResult);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_055: [ If storage answers a block with a server error (5xx), IoTHubClient_LL_UploadToBlob_DoWork shall keep the block and wait, without sleeping, BLOB_BLOCK_UPLOAD_RETRY_INITIAL_DELAY_MS milliseconds before the first retry and twice as long as the previous wait before each next one, but never longer than BLOB_BLOCK_UPLOAD_RETRY_MAX_DELAY_MS milliseconds, at most BLOB_BLOCK_UPLOAD_MAX_RETRIES times per block. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_056: [ Until the wait is over IoTHubClient_LL_UploadToBlob_DoWork shall not send any request for that upload. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_057: [ Once the wait is over IoTHubClient_LL_UploadToBlob_DoWork shall send the same block again with Blob_UploadNextBlock, without calling getDataCallbackEx. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_DoWork_sends_a_block_refused_with_503_again_after_the_delay)
+{
+    ///arrange
+    context.source = (const unsigned char*)"a";
+    context.size = 1;
+    context.toUpload = context.size;
+
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    (void)IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(h, "text.txt", FileUpload_GetData_Callback, &context);
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*steps 1 and 2*/
+    umock_c_reset_all_calls();
+
+    ///act & assert
+    STRICT_EXPECTED_CALL(Blob_UploadNextBlock(TEST_BLOB_UPLOAD_HANDLE, context.source, 1, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_httpResponse()
+        .CopyOutArgumentBuffer_httpStatus(&FiveHundredThree, sizeof(FiveHundredThree));
+    STRICT_EXPECTED_CALL(tickcounter_create());
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*storage is busy*/
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    umock_c_reset_all_calls();
+    g_current_ms = BLOB_BLOCK_UPLOAD_RETRY_INITIAL_DELAY_MS - 1;
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*too early, no request*/
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    umock_c_reset_all_calls();
+    g_current_ms = BLOB_BLOCK_UPLOAD_RETRY_INITIAL_DELAY_MS;
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Blob_UploadNextBlock(TEST_BLOB_UPLOAD_HANDLE, context.source, 1, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_httpResponse()
+        .CopyOutArgumentBuffer_httpStatus(&TwoHundredOne, sizeof(TwoHundredOne));
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*the same block again, getDataCallbackEx is not called*/
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*getDataCallbackEx has no more data*/
+    IoTHubClient_LL_UploadToBlob_DoWork(h); /*Put Block List and step 3*/
+    ASSERT_IS_NULL(context.lastData);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_019: [ If steps 1 and 2 fail then IoTHubClient_LL_UploadToBlob_DoWork shall end the upload with IOTHUB_CLIENT_ERROR without performing step 3. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_DoWork_when_HTTPAPIEX_Create_fails_reports_FILE_UPLOAD_ERROR)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    (void)IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(h, "text.txt", FileUpload_GetData_Callback, &context);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(IGNORED_PTR_ARG))
+        .IgnoreArgument_hostName()
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*destinationFileName*/
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*the pending upload*/
+
+    ///act
+    IoTHubClient_LL_UploadToBlob_DoWork(h);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, FILE_UPLOAD_ERROR, context.lastResult);
+    ASSERT_IS_NULL(context.lastData);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_024: [ IoTHubClient_LL_UploadToBlob_Destroy shall call getDataCallbackEx with FILE_UPLOAD_ERROR, and data and size set to NULL, for every pending upload and free it. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_Destroy_cancels_pending_uploads)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    (void)IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(h, "text.txt", FileUpload_GetData_Callback, &context);
+    umock_c_reset_all_calls();
+
+    ///act
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, FILE_UPLOAD_ERROR, context.lastResult);
+    ASSERT_IS_NULL(context.lastData);
+    ASSERT_IS_NULL(context.lastSize);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_028: [ blob_upload_resumable - value is a pointer to a bool. When true, an upload interrupted by an HTTP error in step 2 is kept for IoTHubClient_LL_UploadToBlob_GetResumeToken instead of being reported to IoTHub. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_blob_upload_resumable_succeeds)
+{
+    ///arrange
+    bool resumable = true;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_RESUMABLE, &resumable);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*runs an upload whose step 2 is interrupted by an HTTP error after Azure Storage stored blocksStored blocks*/
+static IOTHUB_CLIENT_RESULT interrupt_upload(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h, int blocksStored)
+{
+    context.source = TEST_MAPPED_FILE;
+    context.size = 4 * BLOCK_SIZE;
+    context.toUpload = context.size;
+    blocks_stored_before_interruption = blocksStored;
+    umock_c_reset_all_calls();
+    return IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(h, "text.txt", FileUpload_GetData_Callback, &context);
+}
+
+/*step 3 is the only place that builds the relative path of a notification*/
+static int step3_was_performed(void)
+{
+    return strstr(umock_c_get_actual_calls(), "/files/notifications/") != NULL;
+}
+
+static IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE create_resumable_upload_handle(void)
+{
+    bool resumable = true;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    (void)IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_RESUMABLE, &resumable);
+    return h;
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_029: [ If blob_upload_resumable is true and Blob_UploadMultipleBlocksFromSasUri returns BLOB_HTTP_ERROR then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall keep the correlationId, the SAS URI, the number of blocks Azure Storage stored and their size in bytes, skip step 3 and return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl_keeps_an_upload_interrupted_by_an_HTTP_error_when_resumable)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = interrupt_upload(h, 2);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, FILE_UPLOAD_ERROR, context.lastResult);
+    ASSERT_IS_FALSE(step3_was_performed());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_02_084: [ If Blob_UploadMultipleBlocksFromSasUri fails then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl_reports_an_upload_interrupted_by_an_HTTP_error_when_not_resumable)
+{
+    ///arrange
+    char* resumeToken;
+    size_t bytesUploaded;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = interrupt_upload(h, 2);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_IS_TRUE(step3_was_performed());
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, IoTHubClient_LL_UploadToBlob_GetResumeToken(h, &resumeToken, &bytesUploaded));
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_030: [ Only the latest interrupted upload is kept; an interrupted upload kept before shall be reported to IoTHub as failed by performing step 3, unless a resume token was taken for it. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl_reports_the_previous_interrupted_upload_when_keeping_a_new_one)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    (void)interrupt_upload(h, 2);
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = interrupt_upload(h, 2);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_IS_TRUE(step3_was_performed());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_030: [ Only the latest interrupted upload is kept; an interrupted upload kept before shall be reported to IoTHub as failed by performing step 3, unless a resume token was taken for it. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl_does_not_report_the_previous_interrupted_upload_when_its_resume_token_was_taken)
+{
+    ///arrange
+    char* resumeToken;
+    size_t bytesUploaded;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    (void)interrupt_upload(h, 2);
+    (void)IoTHubClient_LL_UploadToBlob_GetResumeToken(h, &resumeToken, &bytesUploaded);
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = interrupt_upload(h, 2);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_IS_FALSE(step3_was_performed());
+
+    ///cleanup
+    free(resumeToken);
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_058: [ If handle, resumeToken or bytesUploaded is NULL then IoTHubClient_LL_UploadToBlob_GetResumeToken shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_GetResumeToken_with_NULL_handle_fails)
+{
+    ///arrange
+    char* resumeToken;
+    size_t bytesUploaded;
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_GetResumeToken(NULL, &resumeToken, &bytesUploaded);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_058: [ If handle, resumeToken or bytesUploaded is NULL then IoTHubClient_LL_UploadToBlob_GetResumeToken shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_GetResumeToken_with_NULL_resumeToken_fails)
+{
+    ///arrange
+    size_t bytesUploaded;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_GetResumeToken(h, NULL, &bytesUploaded);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_058: [ If handle, resumeToken or bytesUploaded is NULL then IoTHubClient_LL_UploadToBlob_GetResumeToken shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_GetResumeToken_with_NULL_bytesUploaded_fails)
+{
+    ///arrange
+    char* resumeToken;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_GetResumeToken(h, &resumeToken, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_059: [ If there is no interrupted upload then IoTHubClient_LL_UploadToBlob_GetResumeToken shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_GetResumeToken_without_an_interrupted_upload_fails)
+{
+    ///arrange
+    char* resumeToken;
+    size_t bytesUploaded;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_GetResumeToken(h, &resumeToken, &bytesUploaded);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_060: [ IoTHubClient_LL_UploadToBlob_GetResumeToken shall serialize to a JSON object the correlationId, the SAS URI, the number of blocks stored by Azure Storage and their size in bytes. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_061: [ IoTHubClient_LL_UploadToBlob_GetResumeToken shall return in resumeToken a copy of the serialized JSON that the caller frees, set bytesUploaded to the size of the stored blocks, remember that a resume token was taken and return IOTHUB_CLIENT_OK. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_GetResumeToken_does_not_count_the_block_whose_upload_was_interrupted)
+{
+    ///arrange
+    char* resumeToken;
+    size_t bytesUploaded;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    (void)interrupt_upload(h, 2); /*blocks 0 and 1 are stored, block 2 is not*/
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(json_value_init_object());
+    STRICT_EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, "correlationId", TEST_DEFAULT_STRING_VALUE));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, "sasUri", TEST_DEFAULT_STRING_VALUE));
+    STRICT_EXPECTED_CALL(json_object_set_number(IGNORED_PTR_ARG, "blockCount", 2.0));
+    STRICT_EXPECTED_CALL(json_object_set_number(IGNORED_PTR_ARG, "bytesUploaded", (double)(2 * BLOCK_SIZE)));
+    STRICT_EXPECTED_CALL(json_serialize_to_string(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_RESUME_TOKEN));
+    STRICT_EXPECTED_CALL(json_free_serialized_string(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_GetResumeToken(h, &resumeToken, &bytesUploaded);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, TEST_RESUME_TOKEN, resumeToken);
+    ASSERT_ARE_EQUAL(size_t, 2 * BLOCK_SIZE, bytesUploaded);
+
+    ///cleanup
+    free(resumeToken);
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_062: [ If any operation fails then IoTHubClient_LL_UploadToBlob_GetResumeToken shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_GetResumeToken_fails_when_json_serialize_to_string_fails)
+{
+    ///arrange
+    char* resumeToken;
+    size_t bytesUploaded;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    (void)interrupt_upload(h, 2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(json_value_init_object());
+    STRICT_EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, "correlationId", TEST_DEFAULT_STRING_VALUE));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, "sasUri", TEST_DEFAULT_STRING_VALUE));
+    STRICT_EXPECTED_CALL(json_object_set_number(IGNORED_PTR_ARG, "blockCount", 2.0));
+    STRICT_EXPECTED_CALL(json_object_set_number(IGNORED_PTR_ARG, "bytesUploaded", (double)(2 * BLOCK_SIZE)));
+    STRICT_EXPECTED_CALL(json_serialize_to_string(IGNORED_PTR_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_GetResumeToken(h, &resumeToken, &bytesUploaded);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_031: [ If handle, resumeToken or getDataCallbackEx is NULL then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl_with_NULL_handle_fails)
+{
+    ///arrange
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl(NULL, TEST_RESUME_TOKEN, FileUpload_GetData_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_031: [ If handle, resumeToken or getDataCallbackEx is NULL then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl_with_NULL_resumeToken_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl(h, NULL, FileUpload_GetData_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_031: [ If handle, resumeToken or getDataCallbackEx is NULL then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl_with_NULL_getDataCallbackEx_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl(h, TEST_RESUME_TOKEN, NULL, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_032: [ If resumeToken cannot be parsed into a correlationId, a SAS URI, a block count no bigger than MAX_BLOCK_COUNT and a size then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl_with_a_resumeToken_that_is_not_JSON_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(json_parse_string("not a token"))
+        .SetReturn(NULL);
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl(h, "not a token", FileUpload_GetData_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, FILE_UPLOAD_ERROR, context.lastResult);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_032: [ If resumeToken cannot be parsed into a correlationId, a SAS URI, a block count no bigger than MAX_BLOCK_COUNT and a size then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl_with_too_many_blocks_in_resumeToken_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    test_token_block_count = (double)MAX_BLOCK_COUNT + 1;
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl(h, TEST_RESUME_TOKEN, FileUpload_GetData_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_IS_NULL(strstr(umock_c_get_actual_calls(), "Blob_ResumeMultipleBlocksFromSasUri("));
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_033: [ IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall call Blob_ResumeMultipleBlocksFromSasUri with the SAS URI of resumeToken and its block count as firstBlockID, so that the first block getDataCallbackEx returns is the one that follows the bytes already uploaded. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_035: [ Otherwise IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall perform step 3 as IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) does, using the correlationId of resumeToken and request HTTP headers built as step 1 builds them, and return the same result. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_037: [ IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall then call getDataCallbackEx with FILE_UPLOAD_OK if it returns IOTHUB_CLIENT_OK and FILE_UPLOAD_ERROR otherwise, and data and size set to NULL. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl_resumes_an_upload_of_a_previous_run_and_notifies_IoTHub)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle(); /*nothing is kept by this handle*/
+    test_token_block_count = 2;
+    test_token_bytes_uploaded = 2 * BLOCK_SIZE;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Blob_ResumeMultipleBlocksFromSasUri(TEST_DEFAULT_STRING_VALUE, 2, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL));
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl(h, TEST_RESUME_TOKEN, FileUpload_GetData_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, FILE_UPLOAD_OK, context.lastResult);
+    ASSERT_IS_NULL(context.lastData);
+    ASSERT_IS_TRUE(step3_was_performed());
+    ASSERT_IS_NOT_NULL(strstr(umock_c_get_actual_calls(), "HTTPHeaders_ReplaceHeaderNameValuePair("));
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_064: [ If the kept interrupted upload has the correlationId of resumeToken then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall forget it without reporting it to IoTHub. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl_forgets_the_kept_upload_it_finished)
+{
+    ///arrange
+    char* resumeToken;
+    size_t bytesUploaded;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    (void)interrupt_upload(h, 2);
+    (void)IoTHubClient_LL_UploadToBlob_GetResumeToken(h, &resumeToken, &bytesUploaded);
+    test_token_block_count = 2;
+    test_token_bytes_uploaded = 2 * BLOCK_SIZE;
+    blocks_stored_before_interruption = -1;
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl(h, resumeToken, FileUpload_GetData_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, IoTHubClient_LL_UploadToBlob_GetResumeToken(h, &resumeToken, &bytesUploaded));
+    umock_c_reset_all_calls();
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+    ASSERT_IS_FALSE(step3_was_performed());
+
+    ///cleanup
+    free(resumeToken);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_034: [ If Blob_ResumeMultipleBlocksFromSasUri returns BLOB_HTTP_ERROR then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall add the blocks stored since resuming to the block count, keep the upload as the interrupted upload, superseding without reporting it a kept upload with the same correlationId, and return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl_keeps_the_progress_when_interrupted_again)
+{
+    ///arrange
+    char* resumeToken;
+    size_t bytesUploaded;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    test_token_block_count = 2;
+    test_token_bytes_uploaded = 2 * BLOCK_SIZE;
+    context.source = TEST_MAPPED_FILE;
+    context.size = 2 * BLOCK_SIZE;
+    context.toUpload = context.size;
+    blocks_stored_before_interruption = 1;
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl(h, TEST_RESUME_TOKEN, FileUpload_GetData_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, FILE_UPLOAD_ERROR, context.lastResult);
+    ASSERT_IS_FALSE(step3_was_performed());
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(json_value_init_object());
+    STRICT_EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, "correlationId", TEST_DEFAULT_STRING_VALUE));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, "sasUri", TEST_DEFAULT_STRING_VALUE));
+    STRICT_EXPECTED_CALL(json_object_set_number(IGNORED_PTR_ARG, "blockCount", 3.0));
+    STRICT_EXPECTED_CALL(json_object_set_number(IGNORED_PTR_ARG, "bytesUploaded", (double)(3 * BLOCK_SIZE)));
+    STRICT_EXPECTED_CALL(json_serialize_to_string(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_RESUME_TOKEN));
+    STRICT_EXPECTED_CALL(json_free_serialized_string(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, IoTHubClient_LL_UploadToBlob_GetResumeToken(h, &resumeToken, &bytesUploaded));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 3 * BLOCK_SIZE, bytesUploaded);
+
+    ///cleanup
+    free(resumeToken);
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_063: [ If Blob_ResumeMultipleBlocksFromSasUri returns BLOB_INVALID_ARG then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall return IOTHUB_CLIENT_INVALID_ARG; resumeToken stays valid. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl_fails_when_Blob_ResumeMultipleBlocksFromSasUri_rejects_the_upload)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Blob_ResumeMultipleBlocksFromSasUri(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(BLOB_INVALID_ARG);
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl(h, TEST_RESUME_TOKEN, FileUpload_GetData_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_IS_FALSE(step3_was_performed());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_036: [ If any other operation fails then IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl shall fail and return IOTHUB_CLIENT_ERROR; resumeToken stays valid. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl_fails_when_BUFFER_new_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(BUFFER_new())
+        .SetReturn(NULL);
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl(h, TEST_RESUME_TOKEN, FileUpload_GetData_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, FILE_UPLOAD_ERROR, context.lastResult);
+    ASSERT_IS_NULL(strstr(umock_c_get_actual_calls(), "Blob_ResumeMultipleBlocksFromSasUri("));
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_038: [ IoTHubClient_LL_UploadToBlob_Destroy shall free a kept interrupted upload, reporting it to IoTHub as failed by performing step 3 unless a resume token was taken for it. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_Destroy_reports_the_interrupted_upload)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    (void)interrupt_upload(h, 2);
+    umock_c_reset_all_calls();
+
+    ///act
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+
+    ///assert
+    ASSERT_IS_TRUE(step3_was_performed());
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_038: [ IoTHubClient_LL_UploadToBlob_Destroy shall free a kept interrupted upload, reporting it to IoTHub as failed by performing step 3 unless a resume token was taken for it. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_Destroy_leaves_an_interrupted_upload_with_a_resume_token_to_the_application)
+{
+    ///arrange
+    char* resumeToken;
+    size_t bytesUploaded;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = create_resumable_upload_handle();
+    (void)interrupt_upload(h, 2);
+    (void)IoTHubClient_LL_UploadToBlob_GetResumeToken(h, &resumeToken, &bytesUploaded);
+    umock_c_reset_all_calls();
+
+    ///act
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+
+    ///assert
+    ASSERT_IS_FALSE(step3_was_performed());
+
+    ///cleanup
+    free(resumeToken);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_041: [ If handle, destinationFileName or localFilePath is NULL then IoTHubClient_LL_UploadFileToBlob_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_Impl_with_NULL_handle_fails)
+{
+    ///arrange
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadFileToBlob_Impl(NULL, "text.txt", "local.txt");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_041: [ If handle, destinationFileName or localFilePath is NULL then IoTHubClient_LL_UploadFileToBlob_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_Impl_with_NULL_destinationFileName_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadFileToBlob_Impl(h, NULL, "local.txt");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_041: [ If handle, destinationFileName or localFilePath is NULL then IoTHubClient_LL_UploadFileToBlob_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_Impl_with_NULL_localFilePath_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadFileToBlob_Impl(h, "text.txt", NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_043: [ If Blob_MapFile fails then IoTHubClient_LL_UploadFileToBlob_Impl shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_Impl_fails_when_Blob_MapFile_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Blob_MapFile("local.txt", IGNORED_PTR_ARG))
+        .SetReturn(NULL);
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadFileToBlob_Impl(h, "text.txt", "local.txt");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+#if SIZE_MAX > UINT32_MAX
+/*Tests_SRS_IOTHUBCLIENT_LL_09_044: [ If the file is bigger than MAX_BLOCK_COUNT * BLOCK_SIZE then IoTHubClient_LL_UploadFileToBlob_Impl shall fail and return IOTHUB_CLIENT_INVALID_ARG without contacting IoT Hub. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_046: [ IoTHubClient_LL_UploadFileToBlob_Impl shall close the file with Blob_UnmapFile before returning. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_Impl_with_file_over_maximum_blob_size_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+    test_mapped_file_size = (size_t)MAX_BLOCK_COUNT * BLOCK_SIZE + 1;
+
+    STRICT_EXPECTED_CALL(Blob_MapFile("local.txt", IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Blob_UnmapFile(TEST_BLOB_FILE_MAPPING_HANDLE));
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadFileToBlob_Impl(h, "text.txt", "local.txt");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+#endif
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_042: [ IoTHubClient_LL_UploadFileToBlob_Impl shall open the file with Blob_MapFile. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_045: [ IoTHubClient_LL_UploadFileToBlob_Impl shall upload the file as IoTHubClient_LL_UploadToBlob does, reading each block with Blob_ReadFileBlock, in blocks of the smallest size that needs at most MAX_BLOCK_COUNT blocks, but not smaller than 1 MiB nor bigger than BLOCK_SIZE. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_046: [ IoTHubClient_LL_UploadFileToBlob_Impl shall close the file with Blob_UnmapFile before returning. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_Impl_uploads_the_file_in_blocks_of_1MiB)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+    test_mapped_file_size = 3 * 1024 * 1024;
+    get_first_block_in_Blob_UploadMultipleBlocksFromSasUri = true;
+
+    STRICT_EXPECTED_CALL(Blob_MapFile("local.txt", IGNORED_PTR_ARG));
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadFileToBlob_Impl(h, "text.txt", "local.txt");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 1024 * 1024, first_block_size);
+    ASSERT_IS_NOT_NULL(strstr(umock_c_get_actual_calls(), "Blob_UploadMultipleBlocksFromSasUri("));
+    ASSERT_IS_NOT_NULL(strstr(umock_c_get_actual_calls(), "Blob_UnmapFile("));
+    ASSERT_IS_TRUE(step3_was_performed());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_045: [ IoTHubClient_LL_UploadFileToBlob_Impl shall upload the file as IoTHubClient_LL_UploadToBlob does, reading each block with Blob_ReadFileBlock, in blocks of the smallest size that needs at most MAX_BLOCK_COUNT blocks, but not smaller than 1 MiB nor bigger than BLOCK_SIZE. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_Impl_uploads_a_small_file_in_one_block)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+    test_mapped_file_size = 10;
+    get_first_block_in_Blob_UploadMultipleBlocksFromSasUri = true;
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadFileToBlob_Impl(h, "text.txt", "local.txt");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 10, first_block_size);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+#if SIZE_MAX > UINT32_MAX
+/*Tests_SRS_IOTHUBCLIENT_LL_09_045: [ IoTHubClient_LL_UploadFileToBlob_Impl shall upload the file as IoTHubClient_LL_UploadToBlob does, reading each block with Blob_ReadFileBlock, in blocks of the smallest size that needs at most MAX_BLOCK_COUNT blocks, but not smaller than 1 MiB nor bigger than BLOCK_SIZE. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_Impl_grows_the_blocks_of_big_files_to_fit_MAX_BLOCK_COUNT)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+    test_mapped_file_size = (size_t)MAX_BLOCK_COUNT * 2 * 1024 * 1024 + 1;
+    get_first_block_in_Blob_UploadMultipleBlocksFromSasUri = true;
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadFileToBlob_Impl(h, "text.txt", "local.txt");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 2 * 1024 * 1024 + 1, first_block_size);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+#endif
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_046: [ IoTHubClient_LL_UploadFileToBlob_Impl shall close the file with Blob_UnmapFile before returning. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_Impl_unmaps_the_file_when_the_upload_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+    test_mapped_file_size = 10;
+
+    STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments()
+        .SetReturn(BLOB_ERROR);
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadFileToBlob_Impl(h, "text.txt", "local.txt");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_IS_NOT_NULL(strstr(umock_c_get_actual_calls(), "Blob_UnmapFile("));
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_045: [ IoTHubClient_LL_UploadFileToBlob_Impl shall upload the file as IoTHubClient_LL_UploadToBlob does, reading each block with Blob_ReadFileBlock, in blocks of the smallest size that needs at most MAX_BLOCK_COUNT blocks, but not smaller than 1 MiB nor bigger than BLOCK_SIZE. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_Impl_reads_the_first_block_from_the_start_of_the_file)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+    test_mapped_file_size = 10;
+    get_first_block_in_Blob_UploadMultipleBlocksFromSasUri = true;
+
+    STRICT_EXPECTED_CALL(Blob_ReadFileBlock(TEST_BLOB_FILE_MAPPING_HANDLE, 0, 10, IGNORED_PTR_ARG));
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadFileToBlob_Impl(h, "text.txt", "local.txt");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_IS_NULL(strstr(umock_c_get_expected_calls(), "Blob_ReadFileBlock("));
+    ASSERT_ARE_EQUAL(size_t, 10, first_block_size);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_068: [ If Blob_ReadFileBlock fails then IoTHubClient_LL_UploadFileToBlob_Impl shall abort the upload. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_Impl_aborts_the_upload_when_Blob_ReadFileBlock_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+    test_mapped_file_size = 10;
+    get_first_block_in_Blob_UploadMultipleBlocksFromSasUri = true;
+    first_block_size = 1;
+
+    STRICT_EXPECTED_CALL(Blob_ReadFileBlock(TEST_BLOB_FILE_MAPPING_HANDLE, 0, 10, IGNORED_PTR_ARG))
+        .SetReturn(__FAILURE__);
+
+    ///act
+    (void)IoTHubClient_LL_UploadFileToBlob_Impl(h, "text.txt", "local.txt");
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 0, first_block_size);
+    ASSERT_IS_NOT_NULL(strstr(umock_c_get_actual_calls(), "Blob_UnmapFile("));
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
 END_TEST_SUITE(iothubclient_ll_uploadtoblob_ut)
 #endif /*DONT_USE_UPLOADTOBLOB*/
@@ -552,6 +552,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_TRANSPORT_PROVIDER, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_DEVICE_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_PRIORITY, int);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_DEVICE_TWIN_STATE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(CONSTBUFFER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_IDENTITY_TYPE, void*);
@@ -570,6 +571,7 @@ TEST_SUITE_INITIALIZE(suite_init)
 
 #ifndef DONT_USE_UPLOADTOBLOB
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_PROGRESS_CALLBACK, void*);
 #endif // DONT_USE_UPLOADTOBLOB
 
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_GetVersionString, "version 1.0");
@@ -617,6 +619,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_CreateFromString, (IOTHUB_MESSAGE_HANDLE)0x44);
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_Clone, (IOTHUB_MESSAGE_HANDLE)0x44);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_Clone, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_GetPriority, IOTHUB_MESSAGE_PRIORITY_NORMAL);
 
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_Diagnostic_AddIfNecessary, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_Diagnostic_AddIfNecessary, 100);
@@ -1791,6 +1794,8 @@ TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_succeeds)
         .IgnoreArgument(1)
         .IgnoreArgument(2);
 
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetPriority(IGNORED_PTR_ARG));
+
     STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreArgument(1)
         .IgnoreArgument(2);
@@ -1806,6 +1811,62 @@ TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_succeeds)
     IoTHubClient_LL_Destroy(handle);
 }
 
+/*Tests_SRS_IOTHUBCLIENT_LL_09_011: [ IoTHubClient_LL_SendEventAsync shall insert the new record in waitingToSend after all records with the same or higher priority, as returned by IoTHubMessage_GetPriority. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_high_priority_goes_ahead_of_normal)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Clone(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Diagnostic_AddIfNecessary(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetPriority(IGNORED_PTR_ARG))
+        .SetReturn(IOTHUB_MESSAGE_PRIORITY_HIGH);
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)3);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_Unregister(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, (void*)3));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, (void*)1));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, (void*)2));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_destroy(IGNORED_PTR_ARG));
+#ifndef DONT_USE_UPLOADTOBLOB
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_Destroy(IGNORED_PTR_ARG));
+#endif
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IoTHubClient_LL_Destroy(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 /*Tests_SRS_IOTHUBCLIENT_LL_02_010: [IoTHubClient_LL_Destroy shall call the underlaying layer's _Destroy function and shall free the resources allocated by IoTHubClient (if any).] */
 /*Tests_SRS_IOTHUBCLIENT_LL_02_033: [Otherwise, IoTHubClient_LL_Destroy shall complete all the event message callbacks that are in the waitingToSend list with the result IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY.] */
 TEST_FUNCTION(IoTHubClient_LL_Destroy_after_sendEvent_succeeds)
@@ -1873,6 +1934,8 @@ TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_fails)
         .IgnoreArgument(1)
         .IgnoreArgument(2);
 
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetPriority(IGNORED_PTR_ARG));
+
     STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreArgument(1)
         .IgnoreArgument(2);
@@ -1880,7 +1943,7 @@ TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_fails)
     umock_c_negative_tests_snapshot();
 
     // act
-    size_t calls_cannot_fail[] = { 4 };
+    size_t calls_cannot_fail[] = { 4, 5 };
     size_t count = umock_c_negative_tests_call_count();
     for (size_t index = 0; index < count; index++)
     {
@@ -2540,6 +2603,7 @@ TEST_FUNCTION(IoTHubClient_LL_DoWork_with_NULL_does_nothing)
 }
 
 /*Tests_SRS_IOTHUBCLIENT_LL_02_021: [Otherwise, IoTHubClient_LL_DoWork shall invoke the underlaying layer's _DoWork function.] */
+/*Tests_SRS_IOTHUBCLIENT_LL_09_025: [ IoTHubClient_LL_DoWork shall then call IoTHubClient_LL_UploadToBlob_DoWork to advance the pending asynchronous uploads. ]*/
 TEST_FUNCTION(IoTHubClient_LL_DoWork_calls_underlying_succeeds)
 {
     //arrange
@@ -2551,6 +2615,9 @@ TEST_FUNCTION(IoTHubClient_LL_DoWork_calls_underlying_succeeds)
 
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, handle))
         .IgnoreArgument(1);
+#ifndef DONT_USE_UPLOADTOBLOB
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_DoWork(IGNORED_PTR_ARG));
+#endif
 
     //act
     IoTHubClient_LL_DoWork(handle);
@@ -3403,6 +3470,10 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_messageTimeout_calls_timeout_callback)
         .IgnoreArgument(1);
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+#ifndef DONT_USE_UPLOADTOBLOB
+    EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_DoWork(IGNORED_PTR_ARG))
+        .IgnoreAllCalls();
+#endif
 
     //act
     IoTHubClient_LL_DoWork(handle);
@@ -3439,6 +3510,10 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_defaults_to_zero)
         .CopyOutArgumentBuffer(2, &twelve, sizeof(twelve));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+#ifndef DONT_USE_UPLOADTOBLOB
+    EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_DoWork(IGNORED_PTR_ARG))
+        .IgnoreAllCalls();
+#endif
 
     //act
     IoTHubClient_LL_DoWork(handle);
@@ -3484,6 +3559,10 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_messageTimeout_only_removes_the_message_
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+#ifndef DONT_USE_UPLOADTOBLOB
+    EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_DoWork(IGNORED_PTR_ARG))
+        .IgnoreAllCalls();
+#endif
 
     //act
     IoTHubClient_LL_DoWork(handle);
@@ -3522,6 +3601,10 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_messageTimeout_when_exactly_on_the_edge_
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+#ifndef DONT_USE_UPLOADTOBLOB
+    EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_DoWork(IGNORED_PTR_ARG))
+        .IgnoreAllCalls();
+#endif
 
     //act
     IoTHubClient_LL_DoWork(handle);
@@ -3576,6 +3659,10 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_2_messages_with_timeouts_at_11_and_12_ca
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+#ifndef DONT_USE_UPLOADTOBLOB
+    EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_DoWork(IGNORED_PTR_ARG))
+        .IgnoreAllCalls();
+#endif
 
     /*because we're at time = 12 in this test, the second message is untouched*/
 
@@ -3635,6 +3722,10 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_2_messages_with_timeouts_at_11_and_12_ca
 
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+#ifndef DONT_USE_UPLOADTOBLOB
+    EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_DoWork(IGNORED_PTR_ARG))
+        .IgnoreAllCalls();
+#endif
 
     timeIsNow = 13; /*13 > 10 (receive time) + 2 (timeout) => timeout!!!*/
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
@@ -3651,6 +3742,10 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_2_messages_with_timeouts_at_11_and_12_ca
 
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+#ifndef DONT_USE_UPLOADTOBLOB
+    EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_DoWork(IGNORED_PTR_ARG))
+        .IgnoreAllCalls();
+#endif
 
 
     /*because we're at time = 13 in this test, the second message times out too*/
@@ -3712,6 +3807,10 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_2_messages_one_with_timeout_one_without_
 
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+#ifndef DONT_USE_UPLOADTOBLOB
+    EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_DoWork(IGNORED_PTR_ARG))
+        .IgnoreAllCalls();
+#endif
 
     {/*this scope happen in the second _DoWork call*/
         tickcounter_ms_t timeIsNow = 999999999UL; /*some very big number*/
@@ -3721,6 +3820,10 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_2_messages_one_with_timeout_one_without_
     }
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+#ifndef DONT_USE_UPLOADTOBLOB
+    EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_DoWork(IGNORED_PTR_ARG))
+        .IgnoreAllCalls();
+#endif
 
     //act
     IoTHubClient_LL_DoWork(handle);
@@ -3764,6 +3867,10 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_messageTimeout_when_tickcounter_fails_in
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+#ifndef DONT_USE_UPLOADTOBLOB
+    EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_DoWork(IGNORED_PTR_ARG))
+        .IgnoreAllCalls();
+#endif
 
     //act
     IoTHubClient_LL_DoWork(handle);
@@ -3928,6 +4035,369 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlobEx_with_NULL_callback_fa
     IoTHubClient_LL_Destroy(h);
 }
 
+/*Tests_SRS_IOTHUBCLIENT_LL_09_026: [ If iotHubClientHandle, destinationFileName or getDataCallbackEx is NULL then IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx_with_NULL_handle_fails)
+{
+    //arrange
+    unsigned int context = 1;
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx(NULL, "irrelevantFileName", my_FileUpload_GetData_CallbackEx, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_026: [ If iotHubClientHandle, destinationFileName or getDataCallbackEx is NULL then IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx_with_NULL_callback_fails)
+{
+    //arrange
+    unsigned int context = 1;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx(h, "irrelevantFileName", NULL, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_027: [ Otherwise IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx shall call IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl and return its result. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx_succeeds)
+{
+    //arrange
+    unsigned int context = 1;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadMultipleBlocksToBlobAsync_Impl(IGNORED_PTR_ARG, "irrelevantFileName", my_FileUpload_GetData_CallbackEx, &context))
+        .IgnoreArgument(1)
+        .SetReturn(IOTHUB_CLIENT_OK);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx(h, "irrelevantFileName", my_FileUpload_GetData_CallbackEx, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+static void my_FileUpload_Progress_Callback(const char* destinationFileName, size_t bytesUploaded, void* context)
+{
+    (void)destinationFileName;
+    (void)bytesUploaded;
+    (void)context;
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_049: [ If iotHubClientHandle is NULL then IoTHubClient_LL_SetFileUploadProgressCallback shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SetFileUploadProgressCallback_with_NULL_handle_fails)
+{
+    //arrange
+    unsigned int context = 1;
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetFileUploadProgressCallback(NULL, my_FileUpload_Progress_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_050: [ Otherwise IoTHubClient_LL_SetFileUploadProgressCallback shall call IoTHubClient_LL_UploadToBlob_SetProgressCallback and return its result. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SetFileUploadProgressCallback_succeeds)
+{
+    //arrange
+    unsigned int context = 1;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_SetProgressCallback(IGNORED_PTR_ARG, my_FileUpload_Progress_Callback, &context))
+        .IgnoreArgument(1)
+        .SetReturn(IOTHUB_CLIENT_OK);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetFileUploadProgressCallback(h, my_FileUpload_Progress_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_050: [ Otherwise IoTHubClient_LL_SetFileUploadProgressCallback shall call IoTHubClient_LL_UploadToBlob_SetProgressCallback and return its result. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SetFileUploadProgressCallback_fails)
+{
+    //arrange
+    unsigned int context = 1;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_SetProgressCallback(IGNORED_PTR_ARG, my_FileUpload_Progress_Callback, &context))
+        .IgnoreArgument(1)
+        .SetReturn(IOTHUB_CLIENT_ERROR);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetFileUploadProgressCallback(h, my_FileUpload_Progress_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+#define TEST_RESUME_TOKEN "{\"correlationId\":\"c\",\"sasUri\":\"s\",\"blockCount\":2,\"bytesUploaded\":8}"
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_065: [ If iotHubClientHandle, resumeToken or bytesUploaded is NULL then IoTHubClient_LL_GetFileUploadResumeToken shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetFileUploadResumeToken_with_NULL_handle_fails)
+{
+    //arrange
+    char* resumeToken;
+    size_t bytesUploaded;
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetFileUploadResumeToken(NULL, &resumeToken, &bytesUploaded);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_065: [ If iotHubClientHandle, resumeToken or bytesUploaded is NULL then IoTHubClient_LL_GetFileUploadResumeToken shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetFileUploadResumeToken_with_NULL_resumeToken_fails)
+{
+    //arrange
+    size_t bytesUploaded;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetFileUploadResumeToken(h, NULL, &bytesUploaded);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_065: [ If iotHubClientHandle, resumeToken or bytesUploaded is NULL then IoTHubClient_LL_GetFileUploadResumeToken shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetFileUploadResumeToken_with_NULL_bytesUploaded_fails)
+{
+    //arrange
+    char* resumeToken;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetFileUploadResumeToken(h, &resumeToken, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_066: [ Otherwise IoTHubClient_LL_GetFileUploadResumeToken shall call IoTHubClient_LL_UploadToBlob_GetResumeToken and return its result. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetFileUploadResumeToken_succeeds)
+{
+    //arrange
+    char* resumeToken;
+    size_t bytesUploaded;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_GetResumeToken(IGNORED_PTR_ARG, &resumeToken, &bytesUploaded))
+        .IgnoreArgument(1)
+        .SetReturn(IOTHUB_CLIENT_OK);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetFileUploadResumeToken(h, &resumeToken, &bytesUploaded);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_066: [ Otherwise IoTHubClient_LL_GetFileUploadResumeToken shall call IoTHubClient_LL_UploadToBlob_GetResumeToken and return its result. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetFileUploadResumeToken_fails_when_IoTHubClient_LL_UploadToBlob_GetResumeToken_fails)
+{
+    //arrange
+    char* resumeToken;
+    size_t bytesUploaded;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_GetResumeToken(IGNORED_PTR_ARG, &resumeToken, &bytesUploaded))
+        .IgnoreArgument(1)
+        .SetReturn(IOTHUB_CLIENT_ERROR);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetFileUploadResumeToken(h, &resumeToken, &bytesUploaded);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_039: [ If iotHubClientHandle, resumeToken or getDataCallbackEx is NULL then IoTHubClient_LL_ResumeMultipleBlocksToBlobEx shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlobEx_with_NULL_handle_fails)
+{
+    //arrange
+    unsigned int context = 1;
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlobEx(NULL, TEST_RESUME_TOKEN, my_FileUpload_GetData_CallbackEx, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_039: [ If iotHubClientHandle, resumeToken or getDataCallbackEx is NULL then IoTHubClient_LL_ResumeMultipleBlocksToBlobEx shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlobEx_with_NULL_resumeToken_fails)
+{
+    //arrange
+    unsigned int context = 1;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlobEx(h, NULL, my_FileUpload_GetData_CallbackEx, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_039: [ If iotHubClientHandle, resumeToken or getDataCallbackEx is NULL then IoTHubClient_LL_ResumeMultipleBlocksToBlobEx shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlobEx_with_NULL_callback_fails)
+{
+    //arrange
+    unsigned int context = 1;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlobEx(h, TEST_RESUME_TOKEN, NULL, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_040: [ Otherwise IoTHubClient_LL_ResumeMultipleBlocksToBlobEx shall call IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl and return its result. ]*/
+TEST_FUNCTION(IoTHubClient_LL_ResumeMultipleBlocksToBlobEx_succeeds)
+{
+    //arrange
+    unsigned int context = 1;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_ResumeMultipleBlocksToBlob_Impl(IGNORED_PTR_ARG, TEST_RESUME_TOKEN, my_FileUpload_GetData_CallbackEx, &context))
+        .IgnoreArgument(1)
+        .SetReturn(IOTHUB_CLIENT_OK);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_ResumeMultipleBlocksToBlobEx(h, TEST_RESUME_TOKEN, my_FileUpload_GetData_CallbackEx, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_047: [ If iotHubClientHandle, destinationFileName or localFilePath is NULL then IoTHubClient_LL_UploadFileToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_with_NULL_handle_fails)
+{
+    //arrange
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadFileToBlob(NULL, "irrelevantFileName", "local.txt");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_047: [ If iotHubClientHandle, destinationFileName or localFilePath is NULL then IoTHubClient_LL_UploadFileToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_with_NULL_localFilePath_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadFileToBlob(h, "irrelevantFileName", NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_048: [ Otherwise IoTHubClient_LL_UploadFileToBlob shall call IoTHubClient_LL_UploadFileToBlob_Impl and return its result. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadFileToBlob_succeeds)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadFileToBlob_Impl(IGNORED_PTR_ARG, "irrelevantFileName", "local.txt"))
+        .IgnoreArgument(1)
+        .SetReturn(IOTHUB_CLIENT_OK);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadFileToBlob(h, "irrelevantFileName", "local.txt");
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
 #endif 
 
 /* Tests_SRS_IOTHUBCLIENT_LL_10_016: [ Otherwise IoTHubClient_LL_SendReportedState shall succeed and return IOTHUB_CLIENT_OK.] */
@@ -4071,6 +4541,9 @@ TEST_FUNCTION(IoTHubClient_LL_DoWork_SendReportedState_succeed)
 
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, h))
         .IgnoreArgument(1);
+#ifndef DONT_USE_UPLOADTOBLOB
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_DoWork(IGNORED_PTR_ARG));
+#endif
 
     //act
     IoTHubClient_LL_DoWork(h);
@@ -4103,6 +4576,9 @@ TEST_FUNCTION(IoTHubClient_LL_DoWork_SendReportedState_continue_processing_succe
 
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, h))
         .IgnoreArgument(1);
+#ifndef DONT_USE_UPLOADTOBLOB
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_DoWork(IGNORED_PTR_ARG));
+#endif
 
     //act
     IoTHubClient_LL_DoWork(h);
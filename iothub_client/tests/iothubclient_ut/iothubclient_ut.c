@@ -111,15 +111,31 @@ static void my_FileUpload_GetData_Callback(IOTHUB_CLIENT_FILE_UPLOAD_RESULT resu
     (void)size;
     (void)context;
     (void)result;
+    g_getDataCallback_count++;
 }
 
+static size_t g_getDataCallback_count;
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT g_getDataCallbackEx_result;
 static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT my_FileUpload_GetData_CallbackEx(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context)
 {
     (void)data;
     (void)size;
     (void)context;
     (void)result;
-    return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
+    g_getDataCallback_count++;
+    return g_getDataCallbackEx_result;
+}
+
+static size_t g_fileUploadProgress_count;
+static char g_fileUploadProgress_destinationFileName[64];
+static size_t g_fileUploadProgress_bytesUploaded;
+static void* g_fileUploadProgress_context;
+static void my_FileUpload_Progress_Callback(const char* destinationFileName, size_t bytesUploaded, void* context)
+{
+    (void)strcpy(g_fileUploadProgress_destinationFileName, destinationFileName);
+    g_fileUploadProgress_bytesUploaded = bytesUploaded;
+    g_fileUploadProgress_context = context;
+    g_fileUploadProgress_count++;
 }
 
 #define ENABLE_MOCKS
@@ -348,6 +364,28 @@ static IOTHUB_CLIENT_RESULT my_IoTHubClient_LL_SetMessageCallback_Ex(IOTHUB_CLIE
     return my_IoTHubClient_LL_SetMessageCallback_Ex_result;
 }
 
+#ifndef DONT_USE_UPLOADTOBLOB
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX g_uploadMultipleBlocksAsyncCallback;
+static void* g_uploadMultipleBlocksAsyncContext;
+static IOTHUB_CLIENT_RESULT my_IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, const char* destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
+{
+    (void)iotHubClientHandle;
+    (void)destinationFileName;
+    g_uploadMultipleBlocksAsyncCallback = getDataCallbackEx;
+    g_uploadMultipleBlocksAsyncContext = context;
+    return IOTHUB_CLIENT_OK;
+}
+
+static IOTHUB_CLIENT_FILE_UPLOAD_PROGRESS_CALLBACK g_fileUploadProgressCallback;
+static IOTHUB_CLIENT_RESULT my_IoTHubClient_LL_SetFileUploadProgressCallback(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_FILE_UPLOAD_PROGRESS_CALLBACK progressCallback, void* userContextCallback)
+{
+    (void)iotHubClientHandle;
+    g_fileUploadProgressCallback = progressCallback;
+    g_userContextCallback = userContextCallback;
+    return IOTHUB_CLIENT_OK;
+}
+#endif
+
 static void my_IoTHubClient_LL_Destroy(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
 {
     (void)iotHubClientHandle;
@@ -425,6 +463,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_PROGRESS_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(THREADAPI_RESULT, int);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
@@ -466,6 +505,8 @@ TEST_SUITE_INITIALIZE(suite_init)
 #ifndef DONT_USE_UPLOADTOBLOB
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_LL_UploadToBlob, IOTHUB_CLIENT_OK);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_LL_UploadToBlob, IOTHUB_CLIENT_ERROR);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx, my_IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_LL_SetFileUploadProgressCallback, my_IoTHubClient_LL_SetFileUploadProgressCallback);
 #endif
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_LL_GetRetryPolicy, IOTHUB_CLIENT_OK);
     REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_LL_Destroy, my_IoTHubClient_LL_Destroy);
@@ -555,6 +596,18 @@ static void reset_test_data()
     g_fail_my_gballoc_malloc = false;
     my_malloc_count = 0;
     memset(my_malloc_items, 0, sizeof(my_malloc_items));
+
+    g_getDataCallback_count = 0;
+    g_getDataCallbackEx_result = IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
+    g_fileUploadProgress_count = 0;
+    g_fileUploadProgress_destinationFileName[0] = '\0';
+    g_fileUploadProgress_bytesUploaded = 0;
+    g_fileUploadProgress_context = NULL;
+#ifndef DONT_USE_UPLOADTOBLOB
+    g_uploadMultipleBlocksAsyncCallback = NULL;
+    g_uploadMultipleBlocksAsyncContext = NULL;
+    g_fileUploadProgressCallback = NULL;
+#endif
 }
 
 TEST_FUNCTION_INITIALIZE(method_init)
@@ -2659,22 +2712,6 @@ TEST_FUNCTION(IoTHubClient_UploadToBlobAsync_succeeds)
     IoTHubClient_Destroy(iothub_handle);
 }
 
-static void set_expected_calls_for_freeUploadToBlobThreadInfo()
-{
-    STRICT_EXPECTED_CALL(Lock_Deinit(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-}
-
-static void set_expected_calls_for_allocateUploadToBlob()
-{
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(Lock_Init());
-}
-
 /*Tests_SRS_IOTHUBCLIENT_99_072: [ If `iotHubClientHandle` is `NULL` then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
 TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_handle_is_NULL)
 {
@@ -2732,6 +2769,20 @@ TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_getDataCal
     IoTHubClient_Destroy(iothub_handle);
 }
 
+static IOTHUB_CLIENT_RESULT call_UploadMultipleBlocksToBlobAsync(bool exCall, IOTHUB_CLIENT_HANDLE iothub_handle, void* context)
+{
+    IOTHUB_CLIENT_RESULT result;
+    if (exCall)
+    {
+        result = IoTHubClient_UploadMultipleBlocksToBlobAsyncEx(iothub_handle, "someFileName.txt", my_FileUpload_GetData_CallbackEx, context);
+    }
+    else
+    {
+        result = IoTHubClient_UploadMultipleBlocksToBlobAsync(iothub_handle, "someFileName.txt", my_FileUpload_GetData_Callback, context);
+    }
+    return result;
+}
+
 static void IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(bool exCall)
 {
     ///arrange
@@ -2739,115 +2790,113 @@ static void IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(bool exCa
     int context = 1;
     umock_c_reset_all_calls();
 
-    set_expected_calls_for_allocateUploadToBlob();
-    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
-
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*this is adding UPLOADTOBLOB_SAVED_DATA to the list of UPLOADTOBLOB_SAVED_DATAs to be cleaned*/
-        .IgnoreArgument(1)
-        .IgnoreArgument(2);
-
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
-
-    /* thread uploading function */
-    if (exCall)
-    {
-        STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadMultipleBlocksToBlobEx(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    }
-    else
-    {
-        STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadMultipleBlocksToBlob(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    }
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx(TEST_IOTHUB_CLIENT_HANDLE, "someFileName.txt", IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Exit(0));
 
     ///act
-    IOTHUB_CLIENT_RESULT result;
-    if (exCall)
-    {
-        result = IoTHubClient_UploadMultipleBlocksToBlobAsyncEx(iothub_handle, "someFileName.txt", my_FileUpload_GetData_CallbackEx, &context);
-    }
-    else
-    {
-        result = IoTHubClient_UploadMultipleBlocksToBlobAsync(iothub_handle, "someFileName.txt", my_FileUpload_GetData_Callback, &context);
-    }
-    g_thread_func(g_thread_func_arg); /*this is the thread uploading function*/
+    IOTHUB_CLIENT_RESULT result = call_UploadMultipleBlocksToBlobAsync(exCall, iothub_handle, &context);
 
     ///assert
     ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(g_uploadMultipleBlocksAsyncCallback);
 
     ///cleanup
-    umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
-
-    EXPECTED_CALL(ThreadAPI_Join(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
-    EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE))
-        .SetReturn(TEST_LIST_HANDLE);
-   
-    setup_gargageCollection(my_malloc_items[2], true);
-    setup_IothubClient_Destroy_after_garbage_collection();
-    
+    (void)g_uploadMultipleBlocksAsyncCallback(FILE_UPLOAD_ERROR, NULL, NULL, g_uploadMultipleBlocksAsyncContext);
     IoTHubClient_Destroy(iothub_handle);
-
 }
 
-/*Tests_SRS_IOTHUBCLIENT_99_075: [ IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex) shall copy the destinationFileName, getDataCallback, context  and iotHubClientHandle into a structure. ]*/
-/*Tests_SRS_IOTHUBCLIENT_99_076: [ IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex) shall spawn a thread passing the structure build in SRS IOTHUBCLIENT 99 075 as thread data.]*/
-/*Tests_SRS_IOTHUBCLIENT_99_078: [ The thread shall call IoTHubClient_LL_UploadMultipleBlocksToBlob or IoTHubClient_LL_UploadMultipleBlocksToBlobEx passing the information packed in the structure. ]*/
-/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure and spawning the thread succeeds, then IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex) shall return IOTHUB_CLIENT_OK. ]*/
+/*Tests_SRS_IOTHUBCLIENT_99_075: [ `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall copy the `getDataCallback` or `getDataCallbackEx` and the `context` into a structure. ]*/
+/*Tests_SRS_IOTHUBCLIENT_99_076: [ `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall start the worker thread if it was not previously started and, under the lock created in `IoTHubClient_Create`, call `IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx` with the structure, so that the upload is carried out by the `IoTHubClient_LL_DoWork` calls of the worker thread. ]*/
+/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure and queuing the upload succeeds, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall return `IOTHUB_CLIENT_OK`. ]*/
 TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds)
 {
     IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(false);
 }
 
-/*Tests_SRS_IOTHUBCLIENT_99_075: [ IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex) shall copy the destinationFileName, getDataCallback, context  and iotHubClientHandle into a structure. ]*/
-/*Tests_SRS_IOTHUBCLIENT_99_076: [ IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex) shall spawn a thread passing the structure build in SRS IOTHUBCLIENT 99 075 as thread data.]*/
-/*Tests_SRS_IOTHUBCLIENT_99_078: [ The thread shall call IoTHubClient_LL_UploadMultipleBlocksToBlob or IoTHubClient_LL_UploadMultipleBlocksToBlobEx passing the information packed in the structure. ]*/
-/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure and spawning the thread succeeds, then IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex) shall return IOTHUB_CLIENT_OK. ]*/
+/*Tests_SRS_IOTHUBCLIENT_99_075: [ `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall copy the `getDataCallback` or `getDataCallbackEx` and the `context` into a structure. ]*/
+/*Tests_SRS_IOTHUBCLIENT_99_076: [ `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall start the worker thread if it was not previously started and, under the lock created in `IoTHubClient_Create`, call `IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx` with the structure, so that the upload is carried out by the `IoTHubClient_LL_DoWork` calls of the worker thread. ]*/
+/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure and queuing the upload succeeds, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall return `IOTHUB_CLIENT_OK`. ]*/
 TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsyncEx_succeeds)
 {
     IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(true);
 }
 
+static void IoTHubClient_UploadMultipleBlocksToBlobAsync_callback_forwards_Impl(bool exCall)
+{
+    ///arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    int context = 1;
+    unsigned char const * data = NULL;
+    size_t size = 0;
+    (void)call_UploadMultipleBlocksToBlobAsync(exCall, iothub_handle, &context);
+    g_getDataCallbackEx_result = IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT;
+    umock_c_reset_all_calls();
 
-static void IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_ThreadAPI_Create_fails_Impl(bool exCall)
+    ///act
+    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT getDataResult = g_uploadMultipleBlocksAsyncCallback(FILE_UPLOAD_OK, &data, &size, g_uploadMultipleBlocksAsyncContext);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, (exCall ? IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT : IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK), getDataResult);
+    ASSERT_ARE_EQUAL(size_t, 1, g_getDataCallback_count);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    (void)g_uploadMultipleBlocksAsyncCallback(FILE_UPLOAD_ERROR, NULL, NULL, g_uploadMultipleBlocksAsyncContext);
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_99_078: [ The callback given to `IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx` shall call `getDataCallback` or `getDataCallbackEx` with the same arguments and the saved `context`, and free the structure after the last call, the one with `data` set to NULL. ]*/
+TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsync_callback_calls_getDataCallback)
+{
+    IoTHubClient_UploadMultipleBlocksToBlobAsync_callback_forwards_Impl(false);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_99_078: [ The callback given to `IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx` shall call `getDataCallback` or `getDataCallbackEx` with the same arguments and the saved `context`, and free the structure after the last call, the one with `data` set to NULL. ]*/
+TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsyncEx_callback_returns_getDataCallbackEx_result)
+{
+    IoTHubClient_UploadMultipleBlocksToBlobAsync_callback_forwards_Impl(true);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_99_078: [ The callback given to `IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx` shall call `getDataCallback` or `getDataCallbackEx` with the same arguments and the saved `context`, and free the structure after the last call, the one with `data` set to NULL. ]*/
+TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsyncEx_last_callback_frees_the_structure)
 {
     ///arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
     int context = 1;
+    (void)call_UploadMultipleBlocksToBlobAsync(true, iothub_handle, &context);
     umock_c_reset_all_calls();
 
-    set_expected_calls_for_allocateUploadToBlob();
-    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(g_uploadMultipleBlocksAsyncContext));
 
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*this is adding UPLOADTOBLOB_SAVED_DATA to the list of UPLOADTOBLOB_SAVED_DATAs to be cleaned*/
-        .IgnoreArgument(1)
-        .IgnoreArgument(2);
-    
+    ///act
+    (void)g_uploadMultipleBlocksAsyncCallback(FILE_UPLOAD_OK, NULL, NULL, g_uploadMultipleBlocksAsyncContext);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_getDataCallback_count);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+static void IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_ThreadAPI_Create_fails_Impl(bool exCall)
+{
+    ///arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    int context = 1;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .SetReturn(THREADAPI_ERROR);
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
-    set_expected_calls_for_freeUploadToBlobThreadInfo();
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     ///act
-    IOTHUB_CLIENT_RESULT result;
-
-    if (exCall)
-    {
-        result = IoTHubClient_UploadMultipleBlocksToBlobAsyncEx(iothub_handle, "someFileName.txt", my_FileUpload_GetData_CallbackEx, &context);
-    }
-    else
-    {
-        result = IoTHubClient_UploadMultipleBlocksToBlobAsync(iothub_handle, "someFileName.txt", my_FileUpload_GetData_Callback, &context);
-    }
+    IOTHUB_CLIENT_RESULT result = call_UploadMultipleBlocksToBlobAsync(exCall, iothub_handle, &context);
 
     ///assert
     ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
@@ -2857,20 +2906,19 @@ static void IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_ThreadAPI_Cr
     IoTHubClient_Destroy(iothub_handle);
 }
 
-
-/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure or spawning the thread fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure, starting the worker thread or queuing the upload fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
 TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_ThreadAPI_Create_fails)
 {
     IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_ThreadAPI_Create_fails_Impl(false);
 }
 
-/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure or spawning the thread fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure, starting the worker thread or queuing the upload fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
 TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsyncEx_fails_when_ThreadAPI_Create_fails)
 {
     IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_ThreadAPI_Create_fails_Impl(true);
 }
 
-static void IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_strcpy_fails_Impl(bool exCall)
+static void IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_LL_fails_Impl(bool exCall)
 {
     ///arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
@@ -2878,22 +2926,16 @@ static void IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_strcpy_fails
     umock_c_reset_all_calls();
 
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .SetReturn(1);
-    set_expected_calls_for_freeUploadToBlobThreadInfo();
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadMultipleBlocksToBlobAsyncEx(TEST_IOTHUB_CLIENT_HANDLE, "someFileName.txt", IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(IOTHUB_CLIENT_ERROR);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
     ///act
-    IOTHUB_CLIENT_RESULT result;
+    IOTHUB_CLIENT_RESULT result = call_UploadMultipleBlocksToBlobAsync(exCall, iothub_handle, &context);
 
-    if (exCall)
-    {
-        result = IoTHubClient_UploadMultipleBlocksToBlobAsyncEx(iothub_handle, "someFileName.txt", my_FileUpload_GetData_CallbackEx, &context);
-    }
-    else
-    {
-        result = IoTHubClient_UploadMultipleBlocksToBlobAsync(iothub_handle, "someFileName.txt", my_FileUpload_GetData_Callback, &context);
-    }
-    
     ///assert
     ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -2902,17 +2944,16 @@ static void IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_strcpy_fails
     IoTHubClient_Destroy(iothub_handle);
 }
 
-
-/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure or spawning the thread fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
-TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_strcpy_fails)
+/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure, starting the worker thread or queuing the upload fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_LL_UploadMultipleBlocksToBlobAsyncEx_fails)
 {
-    IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_strcpy_fails_Impl(false);
+    IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_LL_fails_Impl(false);
 }
 
-/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure or spawning the thread fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
-TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsyncEx_fails_when_strcpy_fails)
+/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure, starting the worker thread or queuing the upload fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsyncEx_fails_when_LL_UploadMultipleBlocksToBlobAsyncEx_fails)
 {
-    IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_strcpy_fails_Impl(true);
+    IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_LL_fails_Impl(true);
 }
 
 static void IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_malloc_fails_Impl(bool exCall)
@@ -2926,16 +2967,7 @@ static void IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_malloc_fails
         .SetReturn(NULL);
 
     ///act
-    IOTHUB_CLIENT_RESULT result;
-
-    if (exCall)
-    {
-        result = IoTHubClient_UploadMultipleBlocksToBlobAsyncEx(iothub_handle, "someFileName.txt", my_FileUpload_GetData_CallbackEx, &context);
-    }
-    else
-    {
-        result = IoTHubClient_UploadMultipleBlocksToBlobAsync(iothub_handle, "someFileName.txt", my_FileUpload_GetData_Callback, &context);
-    }
+    IOTHUB_CLIENT_RESULT result = call_UploadMultipleBlocksToBlobAsync(exCall, iothub_handle, &context);
 
     ///assert
     ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
@@ -2945,18 +2977,142 @@ static void IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_malloc_fails
     IoTHubClient_Destroy(iothub_handle);
 }
 
-
-/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure or spawning the thread fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure, starting the worker thread or queuing the upload fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
 TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_malloc_fails)
 {
     IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_malloc_fails_Impl(false);
 }
 
-/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure or spawning the thread fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+/*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure, starting the worker thread or queuing the upload fails, then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
 TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsyncEx_fails_when_malloc_fails)
 {
     IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_malloc_fails_Impl(true);
 }
+
+/*Tests_SRS_IOTHUBCLIENT_09_010: [ If `iotHubClientHandle` is `NULL` then `IoTHubClient_SetFileUploadProgressCallback` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_SetFileUploadProgressCallback_handle_NULL_fails)
+{
+    ///arrange
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetFileUploadProgressCallback(NULL, my_FileUpload_Progress_Callback, CALLBACK_CONTEXT);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBCLIENT_09_011: [ `IoTHubClient_SetFileUploadProgressCallback` shall start the worker thread if it was not previously started and, under the lock created in `IoTHubClient_Create`, save `progressCallback` and call `IoTHubClient_LL_SetFileUploadProgressCallback` with a callback that queues the notifications and a context holding `userContextCallback`. ]*/
+TEST_FUNCTION(IoTHubClient_SetFileUploadProgressCallback_succeeds)
+{
+    ///arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetFileUploadProgressCallback(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetFileUploadProgressCallback(iothub_handle, my_FileUpload_Progress_Callback, CALLBACK_CONTEXT);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(g_fileUploadProgressCallback);
+
+    ///cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_09_012: [ If any of these operations fails, `IoTHubClient_SetFileUploadProgressCallback` shall return `IOTHUB_CLIENT_ERROR`. ]*/
+TEST_FUNCTION(IoTHubClient_SetFileUploadProgressCallback_LL_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetFileUploadProgressCallback(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(IOTHUB_CLIENT_ERROR);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetFileUploadProgressCallback(iothub_handle, my_FileUpload_Progress_Callback, CALLBACK_CONTEXT);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_09_012: [ If any of these operations fails, `IoTHubClient_SetFileUploadProgressCallback` shall return `IOTHUB_CLIENT_ERROR`. ]*/
+TEST_FUNCTION(IoTHubClient_SetFileUploadProgressCallback_malloc_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetFileUploadProgressCallback(iothub_handle, my_FileUpload_Progress_Callback, CALLBACK_CONTEXT);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_09_013: [ The progress notifications of `IoTHubClient_LL` shall be queued with a copy of `destinationFileName` and delivered to `progressCallback` by the worker thread without holding the lock. ]*/
+TEST_FUNCTION(IoTHubClient_SetFileUploadProgressCallback_progress_is_dispatched_by_the_worker_thread)
+{
+    ///arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    (void)IoTHubClient_SetFileUploadProgressCallback(iothub_handle, my_FileUpload_Progress_Callback, CALLBACK_CONTEXT);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "someFileName.txt"));
+    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
+        .IgnoreArgument_elements();
+
+    g_fileUploadProgressCallback("someFileName.txt", 42, g_userContextCallback);
+
+    g_how_thread_loops = 1;
+    set_expected_calls_first_ScheduleWork_Thread_loop(1);
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
+    set_expected_calls_final_ScheduleWork_Thread_loop();
+
+    ///act
+    ASSERT_IS_NOT_NULL(g_thread_func);
+    g_thread_func(g_thread_func_arg);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, g_fileUploadProgress_count);
+    ASSERT_ARE_EQUAL(char_ptr, "someFileName.txt", g_fileUploadProgress_destinationFileName);
+    ASSERT_ARE_EQUAL(size_t, 42, g_fileUploadProgress_bytesUploaded);
+    ASSERT_ARE_EQUAL(void_ptr, CALLBACK_CONTEXT, g_fileUploadProgress_context);
+
+    ///cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
 #endif
 
 /* SYNC DEVICE METHOD */
@@ -855,6 +855,7 @@ static void set_expected_calls_for_message_receiver_destroy()
 static void set_expected_calls_for_telemetry_messenger_send_async()
 {
     EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetPriority(IGNORED_PTR_ARG));
     EXPECTED_CALL(singlylinkedlist_add(TEST_IN_PROGRESS_LIST, IGNORED_PTR_ARG));
 }
 
@@ -1670,6 +1671,7 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(fields, void*);
     REGISTER_UMOCK_ALIAS_TYPE(MESSAGE_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_PRIORITY, int);
     REGISTER_UMOCK_ALIAS_TYPE(ON_MESSAGE_SEND_COMPLETE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(ON_MESSAGE_RECEIVED, void*);
     REGISTER_UMOCK_ALIAS_TYPE(ON_MESSAGE_RECEIVER_STATE_CHANGED, void*);
@@ -1726,6 +1728,8 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_RETURN(singlylinkedlist_add, TEST_LIST_ITEM_HANDLE);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(singlylinkedlist_add, NULL);
 
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_GetPriority, IOTHUB_MESSAGE_PRIORITY_NORMAL);
+
     REGISTER_GLOBAL_MOCK_RETURN(STRING_construct, TEST_STRING_HANDLE);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_construct, NULL);
 
@@ -2708,6 +2712,85 @@ TEST_FUNCTION(telemetry_messenger_do_work_send_events_message_create_from_iothub
     test_send_events(&test_create_message_failure_config);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_190: [The priority of the event shall be obtained with IoTHubMessage_GetPriority() and kept with it in `instance->waiting_to_send`]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_191: [The events shall be taken from `instance->waiting_to_send` in order of priority, and in the order they were added within the same priority]
+TEST_FUNCTION(telemetry_messenger_do_work_sends_higher_priority_events_first)
+{
+    // arrange
+    IOTHUB_MESSAGE_LIST normal_message1;
+    IOTHUB_MESSAGE_LIST normal_message2;
+    IOTHUB_MESSAGE_LIST high_message;
+    memset(&normal_message1, 0, sizeof(normal_message1));
+    memset(&normal_message2, 0, sizeof(normal_message2));
+    memset(&high_message, 0, sizeof(high_message));
+    normal_message1.messageHandle = (IOTHUB_MESSAGE_HANDLE)0x5001;
+    normal_message2.messageHandle = (IOTHUB_MESSAGE_HANDLE)0x5002;
+    high_message.messageHandle = (IOTHUB_MESSAGE_HANDLE)0x5003;
+
+    TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
+    TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger2(config, false);
+
+    umock_c_reset_all_calls();
+    ASSERT_ARE_EQUAL(int, 0, telemetry_messenger_send_async(handle, &normal_message1, TEST_on_event_send_complete, TEST_IOTHUB_CLIENT_HANDLE));
+    ASSERT_ARE_EQUAL(int, 0, telemetry_messenger_send_async(handle, &normal_message2, TEST_on_event_send_complete, TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetPriority(high_message.messageHandle)).SetReturn(IOTHUB_MESSAGE_PRIORITY_HIGH);
+    ASSERT_ARE_EQUAL(int, 0, telemetry_messenger_send_async(handle, &high_message, TEST_on_event_send_complete, TEST_IOTHUB_CLIENT_HANDLE));
+
+    time_t current_time = time(NULL);
+    uint64_t peer_max_message_size = 100 + AMQP_BATCHING_RESERVE_SIZE;
+    TEST_number_test_on_send_complete_data = 0;
+
+    umock_c_reset_all_calls();
+    set_expected_calls_for_process_event_send_timeouts(0, DEFAULT_EVENT_SEND_TIMEOUT_SECS, current_time);
+
+    // The high priority event is found after the two normal ones.
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_WAIT_TO_SEND_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_WAIT_TO_SEND_LIST, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(link_get_peer_max_message_size(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &peer_max_message_size, sizeof(peer_max_message_size));
+    set_expected_calls_for_create_send_pending_events_state();
+    STRICT_EXPECTED_CALL(message_create_uamqp_encoding_from_iothub_message(IGNORED_PTR_ARG, high_message.messageHandle, IGNORED_PTR_ARG)).SetReturn(1);
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+
+    // Then the normal priority events, in the order they were added.
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_WAIT_TO_SEND_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_WAIT_TO_SEND_LIST, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(message_create_uamqp_encoding_from_iothub_message(IGNORED_PTR_ARG, normal_message1.messageHandle, IGNORED_PTR_ARG)).SetReturn(1);
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_WAIT_TO_SEND_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_WAIT_TO_SEND_LIST, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(message_create_uamqp_encoding_from_iothub_message(IGNORED_PTR_ARG, normal_message2.messageHandle, IGNORED_PTR_ARG)).SetReturn(1);
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_WAIT_TO_SEND_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_foreach(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_find(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    set_expected_calls_free_task(0);
+    STRICT_EXPECTED_CALL(message_destroy(IGNORED_PTR_ARG));
+
+    // act
+    telemetry_messenger_do_work(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 3, TEST_number_test_on_send_complete_data);
+    ASSERT_ARE_EQUAL(void_ptr, &high_message, TEST_on_send_complete_data[0].message);
+    ASSERT_ARE_EQUAL(void_ptr, &normal_message1, TEST_on_send_complete_data[1].message);
+    ASSERT_ARE_EQUAL(void_ptr, &normal_message2, TEST_on_send_complete_data[2].message);
+
+    // cleanup
+    telemetry_messenger_destroy(handle);
+}
+
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_31_198: [While processing pending messages, errors shall result in user callback being invoked.]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_161: [If telemetry_messenger_do_work() fail sending events for `instance->event_send_retry_limit` times in a row, it shall invoke `instance->on_state_changed_callback`, if provided, with error code TELEMETRY_MESSENGER_STATE_ERROR]
 TEST_FUNCTION(telemetry_messenger_do_work_send_events_messagesender_send_fails)
@@ -3079,6 +3162,12 @@ TEST_FUNCTION(telemetry_messenger_send_async_failure_checks)
         // arrange
         char error_msg[64];
 
+        if (i == 1)
+        {
+            // IoTHubMessage_GetPriority() cannot fail.
+            continue;
+        }
+
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(i);
 
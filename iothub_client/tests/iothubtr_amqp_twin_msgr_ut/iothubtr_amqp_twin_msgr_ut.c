@@ -51,6 +51,7 @@ void real_free(void* ptr)
 
 #undef ENABLE_MOCKS
 
+#include "iothub_client_hash.h"
 #include "iothubtransport_amqp_twin_messenger.h"
 
 DEFINE_ENUM_STRINGS(AMQP_MESSENGER_SEND_STATUS, AMQP_MESSENGER_SEND_STATUS_VALUES);
@@ -114,6 +115,7 @@ static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 #define TEST_SYMBOL_AMQP_VALUE                               (AMQP_VALUE)0x4490
 #define TEST_MSG_ANNOTATIONS_AMQP_VALUE                      (AMQP_VALUE)0x4491
 #define TEST_PROPERTIES_HANDLE                               (PROPERTIES_HANDLE)0x4492
+#define TEST_INT_AMQP_VALUE                                  (AMQP_VALUE)0x4493
 
 #define INDEFINITE_TIME                                      ((time_t)-1)
 #define DEFAULT_TWIN_SEND_LINK_SOURCE_NAME                   "twin"
@@ -134,6 +136,7 @@ static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 
 #define TEST_ATTACH_PROPERTIES                               (MAP_HANDLE)0x4444
 #define UNIQUE_ID_BUFFER_SIZE                                37
+#define DEFAULT_TWIN_OPERATIONS_INDEX_SIZE                   8
 
 static const char* TWIN_OPERATION_PATCH = "PATCH";
 static const char* TWIN_OPERATION_GET = "GET";
@@ -193,7 +196,7 @@ int STRING_sprintf(STRING_HANDLE handle, const char* format, ...)
 
 
 static int saved_malloc_returns_count = 0;
-static void* saved_malloc_returns[20];
+static void* saved_malloc_returns[64];
 
 static void* TEST_malloc(size_t size)
 {
@@ -243,6 +246,17 @@ static AMQP_MESSENGER_HANDLE TEST_amqp_messenger_create(const AMQP_MESSENGER_CON
     return TEST_amqp_messenger_create_return;
 }
 
+static ON_AMQP_MESSENGER_MESSAGE_RECEIVED TEST_amqp_messenger_subscribe_for_messages_on_message_received_callback;
+static void* TEST_amqp_messenger_subscribe_for_messages_context;
+static int TEST_amqp_messenger_subscribe_for_messages(AMQP_MESSENGER_HANDLE messenger_handle, ON_AMQP_MESSENGER_MESSAGE_RECEIVED on_message_received_callback, void* context)
+{
+    (void)messenger_handle;
+    TEST_amqp_messenger_subscribe_for_messages_on_message_received_callback = on_message_received_callback;
+    TEST_amqp_messenger_subscribe_for_messages_context = context;
+
+    return 0;
+}
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -269,6 +283,17 @@ extern "C"
 }
 #endif
 
+// Content of the last buffer created by the TWIN messenger (e.g., the data of a merged PATCH request).
+static char TEST_CONSTBUFFER_Create_content[256];
+static CONSTBUFFER_HANDLE TEST_CONSTBUFFER_Create(const unsigned char* source, size_t size)
+{
+    size_t length = (size < sizeof(TEST_CONSTBUFFER_Create_content) ? size : sizeof(TEST_CONSTBUFFER_Create_content) - 1);
+    (void)memcpy(TEST_CONSTBUFFER_Create_content, source, length);
+    TEST_CONSTBUFFER_Create_content[length] = '\0';
+
+    return real_CONSTBUFFER_Create(source, size);
+}
+
 
 static time_t add_seconds(time_t base_time, int seconds)
 {
@@ -427,6 +452,7 @@ static void set_expected_calls_for_twin_messenger_create(TWIN_MESSENGER_CONFIG*
         .CopyOutArgumentBuffer(1, &config->iothub_host_fqdn, sizeof(config->iothub_host_fqdn));
     STRICT_EXPECTED_CALL(singlylinkedlist_create());
     STRICT_EXPECTED_CALL(singlylinkedlist_create());
+    STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG)); // operations index
 
     set_create_link_attach_properties_expected_calls(config);
 
@@ -658,6 +684,17 @@ static void send_one_report_patch(TWIN_MESSENGER_HANDLE handle, time_t current_t
     real_CONSTBUFFER_Destroy(report);
 }
 
+static void report_one_patch(TWIN_MESSENGER_HANDLE handle, const char* patch, const void* context)
+{
+    CONSTBUFFER_HANDLE report = real_CONSTBUFFER_Create((const unsigned char*)patch, strlen(patch));
+
+    umock_c_reset_all_calls();
+    set_twin_messenger_report_state_async_expected_calls(report, g_initial_time);
+    (void)twin_messenger_report_state_async(handle, report, TEST_on_report_state_complete_callback, context);
+
+    real_CONSTBUFFER_Destroy(report);
+}
+
 static void crank_twin_messenger_do_work(TWIN_MESSENGER_HANDLE handle, TWIN_MESSENGER_CONFIG* config, DOWORK_TEST_PROFILE* dwtp)
 {
     (void)config;
@@ -668,6 +705,171 @@ static void crank_twin_messenger_do_work(TWIN_MESSENGER_HANDLE handle, TWIN_MESS
 
 }
 
+static void set_send_one_report_patch_request_expected_calls(const char* unique_id, size_t number_of_pending_operations, bool grows_operations_index)
+{
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(UniqueId_Generate(IGNORED_PTR_ARG, UNIQUE_ID_BUFFER_SIZE))
+        .CopyOutArgumentBuffer(1, unique_id, strlen(unique_id) + 1);
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    if (grows_operations_index)
+    {
+        STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+    }
+
+    set_send_twin_operation_request_expected_calls(g_initial_time);
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+    set_process_timeouts_expected_calls(g_initial_time, 0, 0, number_of_pending_operations, 0);
+    STRICT_EXPECTED_CALL(amqp_messenger_do_work(TEST_AMQP_MESSENGER_HANDLE));
+}
+
+static void set_parse_twin_patch_expected_calls()
+{
+    STRICT_EXPECTED_CALL(CONSTBUFFER_GetContent(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+}
+
+static void set_send_merged_report_patch_request_expected_calls(const char* unique_id, size_t number_of_merged_patches, size_t number_of_pending_operations)
+{
+    size_t i;
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    set_parse_twin_patch_expected_calls();
+
+    for (i = 1; i < number_of_merged_patches; i++)
+    {
+        set_parse_twin_patch_expected_calls();
+        STRICT_EXPECTED_CALL(CONSTBUFFER_Destroy(IGNORED_PTR_ARG));
+    }
+
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(UniqueId_Generate(IGNORED_PTR_ARG, UNIQUE_ID_BUFFER_SIZE))
+        .CopyOutArgumentBuffer(1, unique_id, strlen(unique_id) + 1);
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    set_send_twin_operation_request_expected_calls(g_initial_time);
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Destroy(IGNORED_PTR_ARG)); // merged data
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Destroy(IGNORED_PTR_ARG)); // data of the first PATCH
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+    set_process_timeouts_expected_calls(g_initial_time, 0, 0, number_of_pending_operations, 0);
+    STRICT_EXPECTED_CALL(amqp_messenger_do_work(TEST_AMQP_MESSENGER_HANDLE));
+}
+
+// Reports one PATCH and sends it on do_work as a request whose correlation-id is `unique_id`.
+static void send_one_report_patch_request(TWIN_MESSENGER_HANDLE handle, const char* unique_id, const void* context, size_t number_of_pending_operations, bool grows_operations_index)
+{
+    CONSTBUFFER_HANDLE report = real_CONSTBUFFER_Create(TWIN_REPORTED_PROPERTIES, TWIN_REPORTED_PROPERTIES_LENGTH);
+
+    umock_c_reset_all_calls();
+    set_twin_messenger_report_state_async_expected_calls(report, g_initial_time);
+    (void)twin_messenger_report_state_async(handle, report, TEST_on_report_state_complete_callback, context);
+
+    real_CONSTBUFFER_Destroy(report);
+
+    umock_c_reset_all_calls();
+    set_send_one_report_patch_request_expected_calls(unique_id, number_of_pending_operations, grows_operations_index);
+    twin_messenger_do_work(handle);
+}
+
+static void set_on_amqp_message_received_expected_calls(const char** correlation_id, int* status_code, bool is_request_pending, size_t number_of_batched_patches)
+{
+    PROPERTIES_HANDLE properties = TEST_PROPERTIES_HANDLE;
+    AMQP_VALUE correlation_id_value = TEST_STRING_AMQP_VALUE;
+    annotations message_annotations = TEST_MSG_ANNOTATIONS_AMQP_VALUE;
+    uint32_t pair_count = 1;
+    AMQP_VALUE map_key = TEST_SYMBOL_AMQP_VALUE;
+    AMQP_VALUE map_value = TEST_INT_AMQP_VALUE;
+    const char* map_key_name = TWIN_MESSAGE_PROPERTY_STATUS;
+    MESSAGE_BODY_TYPE body_type = MESSAGE_BODY_TYPE_NONE;
+
+    STRICT_EXPECTED_CALL(amqp_messenger_destroy_disposition_info(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(message_get_properties(TEST_MESSAGE_HANDLE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &properties, sizeof(properties));
+    STRICT_EXPECTED_CALL(properties_get_correlation_id(TEST_PROPERTIES_HANDLE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &correlation_id_value, sizeof(correlation_id_value));
+    STRICT_EXPECTED_CALL(amqpvalue_get_string(TEST_STRING_AMQP_VALUE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, correlation_id, sizeof(*correlation_id));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, *correlation_id))
+        .CopyOutArgumentBuffer(1, correlation_id, sizeof(*correlation_id));
+    STRICT_EXPECTED_CALL(properties_destroy(TEST_PROPERTIES_HANDLE));
+    STRICT_EXPECTED_CALL(message_get_message_annotations(TEST_MESSAGE_HANDLE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &message_annotations, sizeof(message_annotations));
+    STRICT_EXPECTED_CALL(amqpvalue_get_map_pair_count(TEST_MSG_ANNOTATIONS_AMQP_VALUE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &pair_count, sizeof(pair_count));
+    STRICT_EXPECTED_CALL(amqpvalue_get_map_key_value_pair(TEST_MSG_ANNOTATIONS_AMQP_VALUE, 0, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(3, &map_key, sizeof(map_key))
+        .CopyOutArgumentBuffer(4, &map_value, sizeof(map_value));
+    STRICT_EXPECTED_CALL(amqpvalue_get_symbol(TEST_SYMBOL_AMQP_VALUE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &map_key_name, sizeof(map_key_name));
+    STRICT_EXPECTED_CALL(amqpvalue_get_type(TEST_INT_AMQP_VALUE))
+        .SetReturn(AMQP_TYPE_INT);
+    STRICT_EXPECTED_CALL(amqpvalue_get_int(TEST_INT_AMQP_VALUE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, status_code, sizeof(*status_code));
+    STRICT_EXPECTED_CALL(amqpvalue_destroy(TEST_INT_AMQP_VALUE));
+    STRICT_EXPECTED_CALL(amqpvalue_destroy(TEST_SYMBOL_AMQP_VALUE));
+    STRICT_EXPECTED_CALL(amqpvalue_destroy(TEST_MSG_ANNOTATIONS_AMQP_VALUE));
+    STRICT_EXPECTED_CALL(message_get_body_type(TEST_MESSAGE_HANDLE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &body_type, sizeof(body_type));
+
+    if (is_request_pending)
+    {
+        size_t i;
+
+        for (i = 0; i < number_of_batched_patches; i++)
+        {
+            STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG)); // PATCH merged into the request
+        }
+
+        STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG)); // correlation id
+        STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG)); // request context
+        STRICT_EXPECTED_CALL(singlylinkedlist_remove(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    }
+
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG)); // correlation id received
+}
+
+// Delivers to the TWIN messenger a response with `status_code` to the request identified by `correlation_id`.
+static void receive_twin_response(const char* correlation_id, int status_code, bool is_request_pending)
+{
+    umock_c_reset_all_calls();
+    set_on_amqp_message_received_expected_calls(&correlation_id, &status_code, is_request_pending, 0);
+
+    (void)TEST_amqp_messenger_subscribe_for_messages_on_message_received_callback(TEST_MESSAGE_HANDLE, NULL, TEST_amqp_messenger_subscribe_for_messages_context);
+}
+
+// Finds `count` unique ids whose hashes share the lowest 8 bits, so they fall in the same bucket of any index of up to 256 buckets.
+static void get_colliding_unique_ids(char unique_ids[][UNIQUE_ID_BUFFER_SIZE], size_t count)
+{
+    size_t found = 0;
+    unsigned int candidate = 0;
+    uint32_t bucket = 0;
+
+    while (found < count)
+    {
+        char unique_id[UNIQUE_ID_BUFFER_SIZE];
+        uint32_t hash;
+
+        (void)sprintf(unique_id, "unique-id-%u", candidate++);
+        hash = iothub_client_hash_string(unique_id);
+
+        if (found == 0)
+        {
+            bucket = hash & 0xFF;
+        }
+
+        if ((hash & 0xFF) == bucket)
+        {
+            (void)strcpy(unique_ids[found++], unique_id);
+        }
+    }
+}
+
 static TWIN_MESSENGER_HANDLE create_and_start_twin_messenger(TWIN_MESSENGER_CONFIG* config)
 {
     TWIN_MESSENGER_HANDLE handle = create_twin_messenger(config);
@@ -696,6 +898,8 @@ static void register_global_mock_hooks()
     REGISTER_GLOBAL_MOCK_HOOK(malloc, TEST_malloc);
     REGISTER_GLOBAL_MOCK_HOOK(free, TEST_free);
     REGISTER_GLOBAL_MOCK_HOOK(amqp_messenger_create, TEST_amqp_messenger_create);
+    REGISTER_GLOBAL_MOCK_HOOK(amqp_messenger_subscribe_for_messages, TEST_amqp_messenger_subscribe_for_messages);
+    REGISTER_GLOBAL_MOCK_HOOK(CONSTBUFFER_Create, TEST_CONSTBUFFER_Create);
     REGISTER_GLOBAL_MOCK_HOOK(CONSTBUFFER_Clone, real_CONSTBUFFER_Clone);
     REGISTER_GLOBAL_MOCK_HOOK(CONSTBUFFER_Destroy, real_CONSTBUFFER_Destroy);
     REGISTER_GLOBAL_MOCK_HOOK(CONSTBUFFER_GetContent, real_CONSTBUFFER_GetContent);
@@ -719,6 +923,7 @@ static void register_global_mock_aliases()
     REGISTER_UMOCK_ALIAS_TYPE(role, bool);
     REGISTER_UMOCK_ALIAS_TYPE(MESSAGE_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(AMQP_VALUE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(AMQP_TYPE, int);
     REGISTER_UMOCK_ALIAS_TYPE(message_annotations, void*);
     REGISTER_UMOCK_ALIAS_TYPE(PROPERTIES_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(BINARY_DATA, void*);
@@ -844,6 +1049,11 @@ static void reset_test_data()
     memset(&TEST_amqp_messenger_create_config, 0, sizeof(TEST_amqp_messenger_create_config));
     TEST_amqp_messenger_create_return = TEST_AMQP_MESSENGER_HANDLE;
 
+    TEST_amqp_messenger_subscribe_for_messages_on_message_received_callback = NULL;
+    TEST_amqp_messenger_subscribe_for_messages_context = NULL;
+
+    TEST_CONSTBUFFER_Create_content[0] = '\0';
+
     TEST_on_report_state_complete_callback_result = TWIN_REPORT_STATE_RESULT_SUCCESS;
     TEST_on_report_state_complete_callback_reason = TWIN_REPORT_STATE_REASON_NONE;
     TEST_on_report_state_complete_callback_status_code = 0;
@@ -959,6 +1169,7 @@ TEST_FUNCTION(twin_msgr_create_NULL_device_id)
 // Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_005: [twin_messenger_create() shall save a copy of `messenger_config` info into `twin_msgr`]  
 // Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_007: [`twin_msgr->pending_patches` shall be set using singlylinkedlist_create()]  
 // Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_009: [`twin_msgr->operations` shall be set using singlylinkedlist_create()]  
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_112: [`twin_msgr->operations_index` shall be allocated with DEFAULT_TWIN_OPERATIONS_INDEX_SIZE empty buckets]
 // Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_011: [`twin_msgr->amqp_msgr` shall be set using amqp_messenger_create(), passing a AMQP_MESSENGER_CONFIG instance `amqp_msgr_config`]
 // Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_012: [`amqp_msgr_config->client_version` shall be set with `twin_msgr->client_version`]
 // Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_013: [`amqp_msgr_config->device_id` shall be set with `twin_msgr->device_id`]
@@ -1000,6 +1211,7 @@ TEST_FUNCTION(twin_msgr_create_success)
 // Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_006: [If any `messenger_config` info fails to be copied, twin_messenger_create() shall fail and return NULL]  
 // Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_008: [If singlylinkedlist_create() fails, twin_messenger_create() shall fail and return NULL]  
 // Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_010: [If singlylinkedlist_create() fails, twin_messenger_create() shall fail and return NULL]  
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_113: [If malloc() fails, twin_messenger_create() shall fail and return NULL]
 // Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_018: [If amqp_messenger_create() fails, twin_messenger_create() shall fail and return NULL]  
 // Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_020: [If amqp_messenger_subscribe_for_messages() fails, twin_messenger_create() shall fail and return NULL] 
 TEST_FUNCTION(twin_msgr_create_failure_checks)
@@ -1017,7 +1229,7 @@ TEST_FUNCTION(twin_msgr_create_failure_checks)
     size_t i;
     for (i = 0; i < umock_c_negative_tests_call_count(); i++)
     {
-        if (i == 10 || i == 14 || i == 17)
+        if (i == 11 || i == 15 || i == 18)
         {
             // These expected calls do not cause the API to fail.
             continue;
@@ -1588,7 +1800,379 @@ TEST_FUNCTION(twin_msgr_do_work_started_with_EXPIRED_in_progress_patches_success
     twin_messenger_destroy(handle);
 }
 
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_109: [The PATCHES in `twin_msgr->pending_patches` shall be merged, in order, into a single PATCH request while they are JSON objects whose merge is equivalent to applying them one after the other]
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_110: [The callbacks of all the PATCHES merged into the request shall be saved in the PATCH request context]
+TEST_FUNCTION(twin_msgr_do_work_started_merges_pending_patches_into_one_request)
+{
+    // arrange
+    TWIN_MESSENGER_CONFIG* config = get_twin_messenger_config();
+    TWIN_MESSENGER_HANDLE handle = create_and_start_twin_messenger(config);
+
+    send_one_report_patch(handle, g_initial_time);
+    send_one_report_patch(handle, g_initial_time);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    // parsing both patches
+    STRICT_EXPECTED_CALL(CONSTBUFFER_GetContent(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_GetContent(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Destroy(IGNORED_PTR_ARG));
+    // sending the merged patch
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    set_create_twin_operation_context_expected_calls();
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    set_send_twin_operation_request_expected_calls(g_initial_time);
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+    set_process_timeouts_expected_calls(g_initial_time, 0, 0, 1, 0);
+    STRICT_EXPECTED_CALL(amqp_messenger_do_work(TEST_AMQP_MESSENGER_HANDLE));
+
+    // act
+    twin_messenger_do_work(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    twin_messenger_destroy(handle);
+
+    // The single request in progress is reported to the callbacks of both patches.
+    ASSERT_ARE_EQUAL(size_t, 2, TEST_on_report_state_complete_callback_result_CANCELLED_count);
+    ASSERT_ARE_EQUAL(size_t, 2, TEST_on_report_state_complete_callback_reason_MESSENGER_DESTROYED_count);
+}
+
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_109: [The PATCHES in `twin_msgr->pending_patches` shall be merged, in order, into a single PATCH request while they are JSON objects whose merge is equivalent to applying them one after the other]
+TEST_FUNCTION(twin_msgr_do_work_merges_patches_with_different_properties)
+{
+    // arrange
+    TWIN_MESSENGER_CONFIG* config = get_twin_messenger_config();
+    TWIN_MESSENGER_HANDLE handle = create_and_start_twin_messenger(config);
+
+    report_one_patch(handle, "{ \"temperature\": 21 }", (const void*)0x1001);
+    report_one_patch(handle, "{ \"firmware\": { \"version\": \"1.2\" } }", (const void*)0x1002);
+
+    umock_c_reset_all_calls();
+    set_send_merged_report_patch_request_expected_calls("unique-id-a", 2, 1);
+
+    // act
+    twin_messenger_do_work(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, "{\"temperature\":21,\"firmware\":{\"version\":\"1.2\"}}", TEST_CONSTBUFFER_Create_content);
+
+    // cleanup
+    twin_messenger_destroy(handle);
+}
+
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_109: [The PATCHES in `twin_msgr->pending_patches` shall be merged, in order, into a single PATCH request while they are JSON objects whose merge is equivalent to applying them one after the other]
+TEST_FUNCTION(twin_msgr_do_work_merges_patches_keeping_the_latest_value_of_each_property)
+{
+    // arrange
+    TWIN_MESSENGER_CONFIG* config = get_twin_messenger_config();
+    TWIN_MESSENGER_HANDLE handle = create_and_start_twin_messenger(config);
+
+    report_one_patch(handle, "{ \"temperature\": 21, \"firmware\": { \"version\": \"1.2\", \"status\": \"current\" } }", (const void*)0x1001);
+    report_one_patch(handle, "{ \"temperature\": 23, \"firmware\": { \"version\": \"1.3\" } }", (const void*)0x1002);
+    report_one_patch(handle, "{ \"firmware\": { \"status\": null } }", (const void*)0x1003);
+
+    umock_c_reset_all_calls();
+    set_send_merged_report_patch_request_expected_calls("unique-id-a", 3, 1);
+
+    // act
+    twin_messenger_do_work(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, "{\"temperature\":23,\"firmware\":{\"version\":\"1.3\",\"status\":null}}", TEST_CONSTBUFFER_Create_content);
+
+    // cleanup
+    twin_messenger_destroy(handle);
+}
+
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_109: [The PATCHES in `twin_msgr->pending_patches` shall be merged, in order, into a single PATCH request while they are JSON objects whose merge is equivalent to applying them one after the other]
+TEST_FUNCTION(twin_msgr_do_work_does_not_merge_patch_replacing_property_with_object)
+{
+    // arrange
+    TWIN_MESSENGER_CONFIG* config = get_twin_messenger_config();
+    TWIN_MESSENGER_HANDLE handle = create_and_start_twin_messenger(config);
+
+    // Merged, the object would be merged into "firmware" instead of replacing it.
+    report_one_patch(handle, "{ \"firmware\": \"1.2\" }", (const void*)0x1001);
+    report_one_patch(handle, "{ \"firmware\": { \"version\": \"1.3\" } }", (const void*)0x1002);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    set_parse_twin_patch_expected_calls();
+    set_parse_twin_patch_expected_calls();
+    STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(UniqueId_Generate(IGNORED_PTR_ARG, UNIQUE_ID_BUFFER_SIZE))
+        .CopyOutArgumentBuffer(1, "unique-id-a", sizeof("unique-id-a"));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    set_send_twin_operation_request_expected_calls(g_initial_time);
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+    set_process_timeouts_expected_calls(g_initial_time, 1, 0, 1, 0);
+    STRICT_EXPECTED_CALL(amqp_messenger_do_work(TEST_AMQP_MESSENGER_HANDLE));
+
+    // act
+    twin_messenger_do_work(handle);
+
+    // assert
+    // The first PATCH is sent as reported, and the second remains pending.
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, "", TEST_CONSTBUFFER_Create_content);
+
+    umock_c_reset_all_calls();
+    set_send_one_report_patch_request_expected_calls("unique-id-b", 2, false);
+    twin_messenger_do_work(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // Each request is reported only to the callback of its own PATCH.
+    receive_twin_response("unique-id-a", 200, true);
+    ASSERT_ARE_EQUAL(size_t, 1, TEST_on_report_state_complete_callback_result_SUCCESS_count);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x1001, (void*)TEST_on_report_state_complete_callback_context);
+
+    receive_twin_response("unique-id-b", 200, true);
+    ASSERT_ARE_EQUAL(size_t, 2, TEST_on_report_state_complete_callback_result_SUCCESS_count);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x1002, (void*)TEST_on_report_state_complete_callback_context);
+
+    // cleanup
+    twin_messenger_destroy(handle);
+}
+
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_111: [The response for a batched PATCH request shall be reported to the `on_report_state_complete_callback` of each of the PATCHES merged into it]
+TEST_FUNCTION(twin_msgr_on_amqp_message_received_reports_response_to_each_merged_patch)
+{
+    // arrange
+    const char* correlation_id = "unique-id-a";
+    int status_code = 204;
+
+    TWIN_MESSENGER_CONFIG* config = get_twin_messenger_config();
+    TWIN_MESSENGER_HANDLE handle = create_and_start_twin_messenger(config);
+
+    report_one_patch(handle, "{ \"temperature\": 21 }", (const void*)0x1001);
+    report_one_patch(handle, "{ \"humidity\": 40 }", (const void*)0x1002);
+
+    umock_c_reset_all_calls();
+    set_send_merged_report_patch_request_expected_calls(correlation_id, 2, 1);
+    twin_messenger_do_work(handle);
+
+    umock_c_reset_all_calls();
+    set_on_amqp_message_received_expected_calls(&correlation_id, &status_code, true, 1);
+
+    // act
+    (void)TEST_amqp_messenger_subscribe_for_messages_on_message_received_callback(TEST_MESSAGE_HANDLE, NULL, TEST_amqp_messenger_subscribe_for_messages_context);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 2, TEST_on_report_state_complete_callback_result_SUCCESS_count);
+    ASSERT_ARE_EQUAL(size_t, 2, TEST_on_report_state_complete_callback_reason_NONE_count);
+    ASSERT_ARE_EQUAL(int, 204, TEST_on_report_state_complete_callback_status_code);
+    // The PATCH merged last is reported last.
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x1002, (void*)TEST_on_report_state_complete_callback_context);
+
+    // cleanup
+    twin_messenger_destroy(handle);
+
+    ASSERT_ARE_EQUAL(size_t, 0, TEST_on_report_state_complete_callback_result_CANCELLED_count);
+}
+
 // Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_082: [If any failure occurs while verifying/removing timed-out items `twin_msgr->state` shall be set to TWIN_MESSENGER_STATE_ERROR and user informed]  
 
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_085: [If `message` is a success response for a PATCH request, the `on_report_state_complete_callback` shall be invoked if provided passing RESULT_SUCCESS and the status_code received]
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_092: [The corresponding TWIN request shall be removed from `twin_msgr->operations` and destroyed]
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_116: [The TWIN request `message` responds to shall be looked up in `twin_msgr->operations_index` by its correlation-id]
+TEST_FUNCTION(twin_msgr_on_amqp_message_received_completes_request_by_correlation_id)
+{
+    // arrange
+    TWIN_MESSENGER_CONFIG* config = get_twin_messenger_config();
+    TWIN_MESSENGER_HANDLE handle = create_and_start_twin_messenger(config);
+
+    send_one_report_patch_request(handle, "unique-id-a", (const void*)0x1001, 1, false);
+    send_one_report_patch_request(handle, "unique-id-b", (const void*)0x1002, 2, false);
+
+    // act
+    receive_twin_response("unique-id-b", 200, true);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, TEST_on_report_state_complete_callback_result_SUCCESS_count);
+    ASSERT_ARE_EQUAL(int, 200, TEST_on_report_state_complete_callback_status_code);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x1002, (void*)TEST_on_report_state_complete_callback_context);
+
+    // A request is completed only once.
+    receive_twin_response("unique-id-b", 200, false);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, TEST_on_report_state_complete_callback_result_SUCCESS_count);
+
+    receive_twin_response("unique-id-a", 204, true);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 2, TEST_on_report_state_complete_callback_result_SUCCESS_count);
+    ASSERT_ARE_EQUAL(int, 204, TEST_on_report_state_complete_callback_status_code);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x1001, (void*)TEST_on_report_state_complete_callback_context);
+
+    // cleanup
+    twin_messenger_destroy(handle);
+
+    // Nothing was left in `twin_msgr->operations` to be cancelled.
+    ASSERT_ARE_EQUAL(size_t, 0, TEST_on_report_state_complete_callback_result_CANCELLED_count);
+}
+
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_092: [The corresponding TWIN request shall be removed from `twin_msgr->operations` and destroyed]
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_116: [The TWIN request `message` responds to shall be looked up in `twin_msgr->operations_index` by its correlation-id]
+TEST_FUNCTION(twin_msgr_on_amqp_message_received_completes_requests_in_the_same_index_bucket)
+{
+    // arrange
+    char unique_ids[3][UNIQUE_ID_BUFFER_SIZE];
+    get_colliding_unique_ids(unique_ids, 3);
+
+    TWIN_MESSENGER_CONFIG* config = get_twin_messenger_config();
+    TWIN_MESSENGER_HANDLE handle = create_and_start_twin_messenger(config);
+
+    // The bucket chains the requests as [2] -> [1] -> [0].
+    send_one_report_patch_request(handle, unique_ids[0], (const void*)0x1000, 1, false);
+    send_one_report_patch_request(handle, unique_ids[1], (const void*)0x1001, 2, false);
+    send_one_report_patch_request(handle, unique_ids[2], (const void*)0x1002, 3, false);
+
+    // act
+    // Middle of the chain.
+    receive_twin_response(unique_ids[1], 200, true);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, TEST_on_report_state_complete_callback_result_SUCCESS_count);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x1001, (void*)TEST_on_report_state_complete_callback_context);
+
+    // Tail of the chain.
+    receive_twin_response(unique_ids[0], 200, true);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 2, TEST_on_report_state_complete_callback_result_SUCCESS_count);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x1000, (void*)TEST_on_report_state_complete_callback_context);
+
+    // Removed requests are no longer found, even though they share the bucket with a pending one.
+    receive_twin_response(unique_ids[1], 200, false);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 2, TEST_on_report_state_complete_callback_result_SUCCESS_count);
+
+    // Head of the chain.
+    receive_twin_response(unique_ids[2], 200, true);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 3, TEST_on_report_state_complete_callback_result_SUCCESS_count);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x1002, (void*)TEST_on_report_state_complete_callback_context);
+
+    // cleanup
+    twin_messenger_destroy(handle);
+
+    ASSERT_ARE_EQUAL(size_t, 0, TEST_on_report_state_complete_callback_result_CANCELLED_count);
+}
+
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_114: [When the number of TWIN requests in `twin_msgr->operations` exceeds the number of buckets of `twin_msgr->operations_index`, the index shall be rebuilt with twice as many buckets]
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_116: [The TWIN request `message` responds to shall be looked up in `twin_msgr->operations_index` by its correlation-id]
+TEST_FUNCTION(twin_msgr_do_work_grows_operations_index_with_pending_requests)
+{
+    // arrange
+    char unique_ids[2 * DEFAULT_TWIN_OPERATIONS_INDEX_SIZE + 1][UNIQUE_ID_BUFFER_SIZE];
+    size_t number_of_requests = sizeof(unique_ids) / sizeof(unique_ids[0]);
+    size_t i;
+
+    TWIN_MESSENGER_CONFIG* config = get_twin_messenger_config();
+    TWIN_MESSENGER_HANDLE handle = create_and_start_twin_messenger(config);
+
+    // act
+    for (i = 0; i < number_of_requests; i++)
+    {
+        // The index grows from 8 to 16 buckets on the 9th request, and to 32 on the 17th.
+        bool grows_operations_index = (i == DEFAULT_TWIN_OPERATIONS_INDEX_SIZE || i == 2 * DEFAULT_TWIN_OPERATIONS_INDEX_SIZE);
+
+        (void)sprintf(unique_ids[i], "unique-id-%lu", (unsigned long)i);
+        send_one_report_patch_request(handle, unique_ids[i], (const void*)(0x1000 + i), i + 1, grows_operations_index);
+
+        // assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    // Every request is still found after the index was rebuilt.
+    for (i = number_of_requests; i > 0; i--)
+    {
+        receive_twin_response(unique_ids[i - 1], 200, true);
+
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, number_of_requests - i + 1, TEST_on_report_state_complete_callback_result_SUCCESS_count);
+        ASSERT_ARE_EQUAL(void_ptr, (void*)(0x1000 + i - 1), (void*)TEST_on_report_state_complete_callback_context);
+    }
+
+    // cleanup
+    twin_messenger_destroy(handle);
+
+    ASSERT_ARE_EQUAL(size_t, 0, TEST_on_report_state_complete_callback_result_CANCELLED_count);
+}
+
+// Tests_IOTHUBTRANSPORT_AMQP_TWIN_MESSENGER_09_115: [If rebuilding `twin_msgr->operations_index` fails, the TWIN request shall be added to the current buckets]
+TEST_FUNCTION(twin_msgr_do_work_keeps_operations_index_if_growing_fails)
+{
+    // arrange
+    char unique_ids[DEFAULT_TWIN_OPERATIONS_INDEX_SIZE + 1][UNIQUE_ID_BUFFER_SIZE];
+    size_t number_of_requests = sizeof(unique_ids) / sizeof(unique_ids[0]);
+    size_t i;
+
+    TWIN_MESSENGER_CONFIG* config = get_twin_messenger_config();
+    TWIN_MESSENGER_HANDLE handle = create_and_start_twin_messenger(config);
+
+    for (i = 0; i < number_of_requests - 1; i++)
+    {
+        (void)sprintf(unique_ids[i], "unique-id-%lu", (unsigned long)i);
+        send_one_report_patch_request(handle, unique_ids[i], (const void*)(0x1000 + i), i + 1, false);
+    }
+
+    (void)sprintf(unique_ids[i], "unique-id-%lu", (unsigned long)i);
+    CONSTBUFFER_HANDLE report = real_CONSTBUFFER_Create(TWIN_REPORTED_PROPERTIES, TWIN_REPORTED_PROPERTIES_LENGTH);
+    umock_c_reset_all_calls();
+    set_twin_messenger_report_state_async_expected_calls(report, g_initial_time);
+    (void)twin_messenger_report_state_async(handle, report, TEST_on_report_state_complete_callback, (const void*)(0x1000 + i));
+    real_CONSTBUFFER_Destroy(report);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(UniqueId_Generate(IGNORED_PTR_ARG, UNIQUE_ID_BUFFER_SIZE))
+        .CopyOutArgumentBuffer(1, unique_ids[i], strlen(unique_ids[i]) + 1);
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    set_send_twin_operation_request_expected_calls(g_initial_time);
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+    set_process_timeouts_expected_calls(g_initial_time, 0, 0, number_of_requests, 0);
+    STRICT_EXPECTED_CALL(amqp_messenger_do_work(TEST_AMQP_MESSENGER_HANDLE));
+
+    // act
+    twin_messenger_do_work(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, TEST_on_report_state_complete_callback_result_ERROR_count);
+
+    for (i = number_of_requests; i > 0; i--)
+    {
+        receive_twin_response(unique_ids[i - 1], 200, true);
+
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(void_ptr, (void*)(0x1000 + i - 1), (void*)TEST_on_report_state_complete_callback_context);
+    }
+
+    ASSERT_ARE_EQUAL(size_t, number_of_requests, TEST_on_report_state_complete_callback_result_SUCCESS_count);
+
+    // cleanup
+    twin_messenger_destroy(handle);
+}
+
 
 END_TEST_SUITE(iothubtr_amqp_twin_msgr_ut)
@@ -81,6 +81,7 @@ static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 #define DEFAULT_CBS_REQUEST_TIMEOUT_SECS                  UINT32_MAX
 #define DEFAULT_SAS_TOKEN_LIFETIME_SECS                   3600
 #define DEFAULT_SAS_TOKEN_REFRESH_TIME_SECS               1800
+#define DEFAULT_SAS_TOKEN_REFRESH_JITTER_SECS             300
 #define INDEFINITE_TIME                                   ((time_t)(-1))
 #define TEST_GENERIC_CHAR_PTR                             "generic char* string"
 #define TEST_DEVICE_ID                                    "my_device"
@@ -335,16 +336,51 @@ static time_t add_seconds(time_t base_time, unsigned int seconds)
     return new_time;
 }
 
+// Mirrors the jitter cbs_auth derives from the device id and the put time of the SAS token.
+static size_t get_sas_token_refresh_jitter(const char* device_id, time_t put_time, size_t max_jitter_secs)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*device_id != '\0')
+    {
+        hash = (hash ^ (uint8_t)*device_id++) * 16777619u;
+    }
+
+    hash = (hash ^ (uint32_t)put_time) * 16777619u;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+
+    return (size_t)(hash % ((uint32_t)max_jitter_secs + 1));
+}
+
+// Finds a put time, starting at `base_time`, for which the jitter of TEST_DEVICE_ID is at least `min_jitter_secs`.
+static time_t find_put_time_for_sas_token_refresh_jitter(time_t base_time, size_t max_jitter_secs, size_t min_jitter_secs, size_t* jitter_secs)
+{
+    time_t put_time = base_time;
+
+    while ((*jitter_secs = get_sas_token_refresh_jitter(TEST_DEVICE_ID, put_time, max_jitter_secs)) < min_jitter_secs)
+    {
+        put_time = add_seconds(put_time, 1);
+    }
+
+    return put_time;
+}
+
 static void set_expected_calls_for_authentication_create(AUTHENTICATION_CONFIG* config)
 {
     (void)config;
     EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_DeviceId(TEST_AUTHORIZATION_MODULE_HANDLE));
     STRICT_EXPECTED_CALL(STRING_construct(TEST_IOTHUB_HOST_FQDN)).SetReturn(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE);
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE));
 }
 
 static void set_expected_calls_for_authentication_destroy(AUTHENTICATION_HANDLE handle)
 {
+    STRICT_EXPECTED_CALL(STRING_delete(TEST_DEVICES_PATH_STRING_HANDLE));
     STRICT_EXPECTED_CALL(STRING_delete(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE));
     STRICT_EXPECTED_CALL(free(handle));
 }
@@ -388,9 +424,7 @@ static void set_expected_calls_for_create_and_put_sas_token(AUTHENTICATION_HANDL
         .SetReturn(current_time);
     STRICT_EXPECTED_CALL(get_difftime(current_time, (time_t)0))
         .SetReturn(difftime(current_time, (time_t)0));
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE));
     set_expected_calls_for_put_SAS_token_to_cbs(handle, current_time, TEST_GENERATED_SAS_TOKEN_STRING_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_DEVICES_PATH_STRING_HANDLE));
 }
 
 static void set_expected_calls_for_authentication_do_work(AUTHENTICATION_CONFIG* config, AUTHENTICATION_HANDLE handle, time_t current_time, AUTHENTICATION_DO_WORK_EXPECTED_STATE* exp_context)
@@ -412,10 +446,8 @@ static void set_expected_calls_for_authentication_do_work(AUTHENTICATION_CONFIG*
     }
     else if (exp_context->current_state == AUTHENTICATION_STATE_STARTING)
     {
-        STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE));
         set_expected_calls_for_put_SAS_token_to_cbs(handle, current_time, exp_context->sas_token_to_use);
         STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(TEST_DEVICES_PATH_STRING_HANDLE));
     }
     else if (exp_context->current_state == AUTHENTICATION_STATE_STARTED)
     {
@@ -1177,7 +1209,7 @@ TEST_FUNCTION(authentication_do_work_SAS_TOKEN_next_calls_no_op)
 
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_039: [If `instance->state` is AUTHENTICATION_STATE_STARTED and device keys were used, authentication_do_work() shall only verify the SAS token refresh time]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_023: [authentication_create() shall set `instance->sas_token_refresh_time_secs` with the default value of 30 minutes]
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_065: [The SAS token shall be refreshed if the current time minus `instance->current_sas_token_put_time` equals or exceeds `instance->sas_token_refresh_time_secs`]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_065: [The SAS token shall be refreshed if the current time minus `instance->current_sas_token_put_time` equals or exceeds `instance->sas_token_refresh_time_secs` minus `instance->current_sas_token_refresh_jitter_secs`]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_066: [If SAS token does not need to be refreshed, authentication_do_work() shall return]
 TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_sas_token_refresh_check)
 {
@@ -1185,6 +1217,9 @@ TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_sas_token_refresh_check)
     AUTHENTICATION_CONFIG* config = get_auth_config(USE_DEVICE_KEYS);
     AUTHENTICATION_HANDLE handle = create_and_start_authentication(config);
 
+    size_t jitter_option_secs = 0;
+    ASSERT_ARE_EQUAL(int, 0, authentication_set_option(handle, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, &jitter_option_secs));
+
     time_t current_time = time(NULL);
     time_t next_time = add_seconds(current_time, DEFAULT_SAS_TOKEN_REFRESH_TIME_SECS - 1);
     ASSERT_IS_TRUE_WITH_MSG(INDEFINITE_TIME != next_time, "failed to computer 'next_time'");
@@ -1266,6 +1301,150 @@ TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_sas_token_refresh)
     authentication_destroy(handle);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_129: [If cbs_put_token_async() succeeds, authentication_do_work() shall set `instance->current_sas_token_refresh_jitter_secs` with a value from 0 to `instance->sas_token_refresh_jitter_secs`, limited to `instance->sas_token_refresh_time_secs` minus 1, derived from a hash of `instance->device_id` and `instance->current_sas_token_put_time`]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_065: [The SAS token shall be refreshed if the current time minus `instance->current_sas_token_put_time` equals or exceeds `instance->sas_token_refresh_time_secs` minus `instance->current_sas_token_refresh_jitter_secs`]
+TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_sas_token_refresh_jitter_shortens_the_refresh)
+{
+    // arrange
+    AUTHENTICATION_CONFIG* config = get_auth_config(USE_DEVICE_KEYS);
+    AUTHENTICATION_HANDLE handle = create_and_start_authentication(config);
+
+    size_t refresh_time_secs = 10;
+    size_t jitter_option_secs = 100; // Limited to refresh_time_secs - 1.
+    size_t jitter_secs;
+    time_t current_time = find_put_time_for_sas_token_refresh_jitter(time(NULL), refresh_time_secs - 1, 1, &jitter_secs);
+    ASSERT_ARE_EQUAL(int, 0, authentication_set_option(handle, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_TIME_SECS, &refresh_time_secs));
+    ASSERT_ARE_EQUAL(int, 0, authentication_set_option(handle, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, &jitter_option_secs));
+
+    time_t not_yet_time = add_seconds(current_time, (unsigned int)(refresh_time_secs - jitter_secs - 1));
+    time_t next_time = add_seconds(current_time, (unsigned int)(refresh_time_secs - jitter_secs));
+    ASSERT_IS_TRUE_WITH_MSG(INDEFINITE_TIME != next_time, "failed to computer 'next_time'");
+
+    AUTHENTICATION_DO_WORK_EXPECTED_STATE *exp_state = get_do_work_expected_state_struct();
+    exp_state->current_state = AUTHENTICATION_STATE_STARTING;
+    exp_state->sas_token_to_use = TEST_PRIMARY_DEVICE_KEY_STRING_HANDLE;
+    exp_state->sastoken_expiration_time = (size_t)(difftime(current_time, (time_t)0) + DEFAULT_SAS_TOKEN_LIFETIME_SECS);
+
+    crank_authentication_do_work(config, handle, current_time, exp_state);
+    saved_cbs_put_token_on_operation_complete(saved_cbs_put_token_context, CBS_OPERATION_RESULT_OK, 0, "all good");
+
+    // One second before the jittered refresh time nothing is done.
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG)).SetReturn(IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY);
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(not_yet_time);
+    STRICT_EXPECTED_CALL(get_difftime(not_yet_time, current_time)).SetReturn(difftime(not_yet_time, current_time));
+    authentication_do_work(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG)).SetReturn(IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY);
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(next_time);
+    STRICT_EXPECTED_CALL(get_difftime(next_time, current_time)).SetReturn(difftime(next_time, current_time));
+    set_expected_calls_for_put_SAS_token_to_cbs(handle, next_time, TEST_PRIMARY_DEVICE_KEY_STRING_HANDLE);
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+
+    // act
+    authentication_do_work(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    authentication_destroy(handle);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_130: [authentication_create() shall set `instance->sas_token_refresh_jitter_secs` with the default value of 5 minutes]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_065: [The SAS token shall be refreshed if the current time minus `instance->current_sas_token_put_time` equals or exceeds `instance->sas_token_refresh_time_secs` minus `instance->current_sas_token_refresh_jitter_secs`]
+TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_default_sas_token_refresh_jitter_is_applied)
+{
+    // arrange
+    AUTHENTICATION_CONFIG* config = get_auth_config(USE_DEVICE_KEYS);
+    AUTHENTICATION_HANDLE handle = create_and_start_authentication(config);
+
+    size_t refresh_time_secs = DEFAULT_SAS_TOKEN_REFRESH_TIME_SECS;
+    size_t jitter_secs;
+    time_t current_time = find_put_time_for_sas_token_refresh_jitter(time(NULL), DEFAULT_SAS_TOKEN_REFRESH_JITTER_SECS, 1, &jitter_secs);
+
+    time_t not_yet_time = add_seconds(current_time, (unsigned int)(refresh_time_secs - jitter_secs - 1));
+    time_t next_time = add_seconds(current_time, (unsigned int)(refresh_time_secs - jitter_secs));
+    ASSERT_IS_TRUE_WITH_MSG(INDEFINITE_TIME != next_time, "failed to computer 'next_time'");
+
+    AUTHENTICATION_DO_WORK_EXPECTED_STATE *exp_state = get_do_work_expected_state_struct();
+    exp_state->current_state = AUTHENTICATION_STATE_STARTING;
+    exp_state->sas_token_to_use = TEST_PRIMARY_DEVICE_KEY_STRING_HANDLE;
+    exp_state->sastoken_expiration_time = (size_t)(difftime(current_time, (time_t)0) + DEFAULT_SAS_TOKEN_LIFETIME_SECS);
+
+    crank_authentication_do_work(config, handle, current_time, exp_state);
+    saved_cbs_put_token_on_operation_complete(saved_cbs_put_token_context, CBS_OPERATION_RESULT_OK, 0, "all good");
+
+    // One second before the jittered refresh time nothing is done.
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG)).SetReturn(IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY);
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(not_yet_time);
+    STRICT_EXPECTED_CALL(get_difftime(not_yet_time, current_time)).SetReturn(difftime(not_yet_time, current_time));
+    authentication_do_work(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG)).SetReturn(IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY);
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(next_time);
+    STRICT_EXPECTED_CALL(get_difftime(next_time, current_time)).SetReturn(difftime(next_time, current_time));
+    set_expected_calls_for_put_SAS_token_to_cbs(handle, next_time, TEST_PRIMARY_DEVICE_KEY_STRING_HANDLE);
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+
+    // act
+    authentication_do_work(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    authentication_destroy(handle);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_065: [The SAS token shall be refreshed if the current time minus `instance->current_sas_token_put_time` equals or exceeds `instance->sas_token_refresh_time_secs` minus `instance->current_sas_token_refresh_jitter_secs`]
+TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_refresh_time_reduced_below_the_jitter_refreshes)
+{
+    // arrange
+    AUTHENTICATION_CONFIG* config = get_auth_config(USE_DEVICE_KEYS);
+    AUTHENTICATION_HANDLE handle = create_and_start_authentication(config);
+
+    size_t refresh_time_secs = 10;
+    size_t jitter_option_secs = 100;
+    size_t jitter_secs;
+    time_t current_time = find_put_time_for_sas_token_refresh_jitter(time(NULL), refresh_time_secs - 1, 2, &jitter_secs);
+    ASSERT_ARE_EQUAL(int, 0, authentication_set_option(handle, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_TIME_SECS, &refresh_time_secs));
+    ASSERT_ARE_EQUAL(int, 0, authentication_set_option(handle, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, &jitter_option_secs));
+
+    AUTHENTICATION_DO_WORK_EXPECTED_STATE *exp_state = get_do_work_expected_state_struct();
+    exp_state->current_state = AUTHENTICATION_STATE_STARTING;
+    exp_state->sas_token_to_use = TEST_PRIMARY_DEVICE_KEY_STRING_HANDLE;
+    exp_state->sastoken_expiration_time = (size_t)(difftime(current_time, (time_t)0) + DEFAULT_SAS_TOKEN_LIFETIME_SECS);
+
+    crank_authentication_do_work(config, handle, current_time, exp_state);
+    saved_cbs_put_token_on_operation_complete(saved_cbs_put_token_context, CBS_OPERATION_RESULT_OK, 0, "all good");
+
+    // The jitter drawn (>= 2) is now larger than the refresh time.
+    refresh_time_secs = 1;
+    ASSERT_ARE_EQUAL(int, 0, authentication_set_option(handle, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_TIME_SECS, &refresh_time_secs));
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG)).SetReturn(IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY);
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(current_time);
+    STRICT_EXPECTED_CALL(get_difftime(current_time, current_time)).SetReturn(0.0);
+    set_expected_calls_for_put_SAS_token_to_cbs(handle, current_time, TEST_PRIMARY_DEVICE_KEY_STRING_HANDLE);
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+
+    // act
+    authentication_do_work(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    authentication_destroy(handle);
+}
+
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_021: [authentication_create() shall set `instance->cbs_request_timeout_secs` with the default value of UINT32_MAX]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_038: [If `instance->is_cbs_put_token_in_progress` is TRUE, authentication_do_work() shall only verify the authentication timeout]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_043: [authentication_do_work() shall set `instance->is_cbs_put_token_in_progress` to TRUE]
@@ -1410,6 +1589,28 @@ TEST_FUNCTION(authentication_set_option_NULL_value)
     authentication_destroy(handle);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_131: [If name matches AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, `value` shall be saved on `instance->sas_token_refresh_jitter_secs`]
+TEST_FUNCTION(authentication_set_option_sas_token_refresh_jitter_succeeds)
+{
+    // arrange
+    AUTHENTICATION_CONFIG* config = get_auth_config(USE_DEVICE_KEYS);
+    AUTHENTICATION_HANDLE handle = create_and_start_authentication(config);
+
+    umock_c_reset_all_calls();
+
+    size_t value = 300;
+
+    // act
+    int result = authentication_set_option(handle, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    // cleanup
+    authentication_destroy(handle);
+}
+
 // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_128: [If name does not match any supported option, authentication_set_option shall fail and return a non-zero value]
 TEST_FUNCTION(authentication_set_option_name_not_supported)
 {
@@ -1538,6 +1739,9 @@ TEST_FUNCTION(authentication_retrieve_options_succeeds)
     STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, AUTHENTICATION_OPTION_SAS_TOKEN_LIFETIME_SECS, IGNORED_PTR_ARG))
         .IgnoreArgument(3)
         .SetReturn(OPTIONHANDLER_OK);
+    STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, IGNORED_PTR_ARG))
+        .IgnoreArgument(3)
+        .SetReturn(OPTIONHANDLER_OK);
 
     // act
     OPTIONHANDLER_HANDLE result = authentication_retrieve_options(handle);
@@ -1575,6 +1779,9 @@ TEST_FUNCTION(authentication_retrieve_options_failure_checks)
     STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, AUTHENTICATION_OPTION_SAS_TOKEN_LIFETIME_SECS, IGNORED_PTR_ARG))
         .IgnoreArgument(3)
         .SetReturn(OPTIONHANDLER_OK);
+    STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, IGNORED_PTR_ARG))
+        .IgnoreArgument(3)
+        .SetReturn(OPTIONHANDLER_OK);
     umock_c_negative_tests_snapshot();
 
     // act
@@ -86,7 +86,6 @@ extern "C"
 
 #define ENABLE_MOCKS
 #include "azure_c_shared_utility/gballoc.h"
-#include "azure_c_shared_utility/singlylinkedlist.h"
 #include "azure_c_shared_utility/doublylinkedlist.h"
 #include "azure_c_shared_utility/platform.h"
 #include "azure_c_shared_utility/strings.h"
@@ -154,114 +153,6 @@ extern "C"
     }
 
 
-    // singlylinkedlist
-    static int saved_registered_devices_list_count;
-    static const void* saved_registered_devices_list[20];
-
-    static bool TEST_singlylinkedlist_add_fail_return = false;
-    static LIST_ITEM_HANDLE TEST_singlylinkedlist_add(SINGLYLINKEDLIST_HANDLE list, const void* item)
-    {
-        (void)list;
-        saved_registered_devices_list[saved_registered_devices_list_count++] = item;
-
-        return TEST_singlylinkedlist_add_fail_return ? NULL : (LIST_ITEM_HANDLE)item;
-    }
-
-    static int TEST_singlylinkedlist_remove_return = 0;
-    static int TEST_singlylinkedlist_remove(SINGLYLINKEDLIST_HANDLE list, LIST_ITEM_HANDLE item)
-    {
-        (void)list;
-        const void** TEST_list = NULL;
-        int* TEST_list_count = NULL;
-
-        TEST_list = saved_registered_devices_list;
-        TEST_list_count = &saved_registered_devices_list_count;
-
-        int i;
-        int item_found = 0;
-        for (i = 0; i < *TEST_list_count; i++)
-        {
-            if (item_found)
-            {
-                TEST_list[i - 1] = TEST_list[i];
-            }
-            else if (TEST_list[i] == item)
-            {
-                item_found = 1;
-            }
-        }
-
-        if (item_found)
-        {
-            (*TEST_list_count)--;
-        }
-
-        return item_found == 1 ? 0 : 1;
-    }
-
-    static LIST_ITEM_HANDLE TEST_singlylinkedlist_find(SINGLYLINKEDLIST_HANDLE list, LIST_MATCH_FUNCTION match_function, const void* match_context)
-    {
-        (void)list;
-        (void)match_function;
-        return (LIST_ITEM_HANDLE)match_context;
-    }
-
-    static SINGLYLINKEDLIST_HANDLE TEST_singlylinkedlist_foreach_list;
-    static LIST_ACTION_FUNCTION TEST_singlylinkedlist_foreach_action_function;
-    static const void* TEST_singlylinkedlist_foreach_context;
-    static int TEST_singlylinkedlist_foreach(SINGLYLINKEDLIST_HANDLE list, LIST_ACTION_FUNCTION action_function, const void* action_context)
-    {
-        TEST_singlylinkedlist_foreach_list = list;
-        TEST_singlylinkedlist_foreach_action_function = action_function;
-        TEST_singlylinkedlist_foreach_context = action_context;
-        return 0;
-    }
-
-    static const void* TEST_singlylinkedlist_item_get_value(LIST_ITEM_HANDLE item_handle)
-    {
-        return (const void*)item_handle;
-    }
-
-    static LIST_ITEM_HANDLE TEST_singlylinkedlist_get_head_item(SINGLYLINKEDLIST_HANDLE list)
-    {
-        (void)list;
-        LIST_ITEM_HANDLE list_item;
-
-        if (saved_registered_devices_list_count <= 0)
-        {
-            list_item = NULL;
-        }
-        else
-        {
-            list_item = (LIST_ITEM_HANDLE)saved_registered_devices_list[0];
-        }
-
-        return list_item;
-    }
-
-    static LIST_ITEM_HANDLE TEST_singlylinkedlist_get_next_item(LIST_ITEM_HANDLE item_handle)
-    {
-        LIST_ITEM_HANDLE next_item = NULL;
-
-        int i;
-        int item_found = 0;
-        for (i = 0; i < saved_registered_devices_list_count; i++)
-        {
-            if (item_found)
-            {
-                next_item = (LIST_ITEM_HANDLE)saved_registered_devices_list[i];
-                break;
-            }
-            else if (saved_registered_devices_list[i] == (void*)item_handle)
-            {
-                item_found = 1;
-            }
-        }
-
-        return next_item;
-    }
-
-
     static int g_STRING_sprintf_call_count;
     static int g_STRING_sprintf_fail_on_count;
     static STRING_HANDLE saved_STRING_sprintf_handle;
@@ -389,15 +280,14 @@ static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 #define TEST_AMQP_VALUE                            ((AMQP_VALUE)0x4260)
 
 #define TEST_UNDERLYING_IO_TRANSPORT               ((XIO_HANDLE)0x4261)
+#define TEST_UNDERLYING_IO_TRANSPORT_2             ((XIO_HANDLE)0x4262)
 #define TEST_TRANSPORT_PROVIDER                    ((TRANSPORT_PROVIDER*)0x4263)
 #define TEST_IOTHUB_HOST_FQDN_CHAR_PTR             "servername.domainname"
 #define TEST_IOTHUB_HOST_FQDN_STRING_HANDLE        (STRING_HANDLE)0x4264
 #define TEST_IOTHUB_HOST_FQDN_CLONE_STRING_HANDLE  (STRING_HANDLE)0x4265
 #define TEST_PROTOCOL_PROVIDER                     (IOTHUB_CLIENT_TRANSPORT_PROVIDER)0x4266
-#define TEST_REGISTERED_DEVICES_LIST               (SINGLYLINKEDLIST_HANDLE)0x4267
 #define TEST_DEVICE_ID_STRING_HANDLE               (STRING_HANDLE)0x4268
 #define TEST_DEVICE_HANDLE                         (AMQP_DEVICE_HANDLE)0x4269
-#define TEST_LIST_ITEM_HANDLE                      (LIST_ITEM_HANDLE)0x4270
 #define TEST_AMQP_CONNECTION_HANDLE                (AMQP_CONNECTION_HANDLE)0x4271
 #define TEST_IOTHUB_MESSAGE_LIST_HANDLE            (IOTHUB_MESSAGE_LIST*)0x4272
 #define TEST_IOTHUB_DEVICE_HANDLE                  (IOTHUB_DEVICE_HANDLE)0x4273
@@ -428,8 +318,6 @@ static void set_expected_calls_for_Create(IOTHUBTRANSPORT_CONFIG* transport_conf
 {
     EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
 
-    STRICT_EXPECTED_CALL(retry_control_create(DEFAULT_RETRY_POLICY, DEFAULT_MAX_RETRY_TIME_IN_SECS));
-
     if (transport_config->upperConfig->protocolGatewayHostName != NULL)
     {
         STRICT_EXPECTED_CALL(STRING_construct(transport_config->upperConfig->protocolGatewayHostName))
@@ -440,8 +328,7 @@ static void set_expected_calls_for_Create(IOTHUBTRANSPORT_CONFIG* transport_conf
         STRING_construct_sprintf_result = TEST_IOTHUB_HOST_FQDN_STRING_HANDLE;
     }
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_create())
-        .SetReturn(TEST_REGISTERED_DEVICES_LIST);
+    EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
 }
 
 static void set_expected_calls_for_GetSendStatus(DEVICE_SEND_STATUS send_status)
@@ -457,14 +344,16 @@ static void set_expected_calls_for_GetHostname()
     STRICT_EXPECTED_CALL(STRING_clone(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE)).SetReturn(TEST_IOTHUB_HOST_FQDN_CLONE_STRING_HANDLE);
 }
 
-static void set_expected_calls_for_is_device_registered_ex(IOTHUB_DEVICE_CONFIG* device_config, IOTHUB_DEVICE_HANDLE registered_device)
+// @remarks
+//     The registry only compares the ids of devices whose id hash matches the one being looked up,
+//     so the id of `registered_device` is only retrieved if it is registered with TEST_DEVICE_ID_CHAR_PTR.
+static void set_expected_calls_for_find_registered_device(IOTHUB_DEVICE_HANDLE registered_device)
 {
-    (void)device_config;
-
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2)
-        .IgnoreArgument(3)
-        .SetReturn((LIST_ITEM_HANDLE)registered_device);
+    if (registered_device != NULL)
+    {
+        STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
+            .SetReturn(TEST_DEVICE_ID_CHAR_PTR);
+    }
 }
 
 static MESSAGE_DISPOSITION_CONTEXT* TRANSPORT_CONTEXT_DATA_create2(IOTHUB_DEVICE_HANDLE device_handle)
@@ -531,16 +420,16 @@ static void set_expected_calls_for_SendMessageDisposition(IOTHUBMESSAGE_DISPOSIT
 //     or NULL if the intent is to return "not registered".
 static void set_expected_calls_for_is_device_registered(IOTHUB_DEVICE_CONFIG* device_config, IOTHUB_DEVICE_HANDLE registered_device)
 {
+    (void)device_config;
+
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
         .SetReturn(TEST_DEVICE_ID_CHAR_PTR);
 
-    set_expected_calls_for_is_device_registered_ex(device_config, registered_device);
+    set_expected_calls_for_find_registered_device(registered_device);
 }
 
 static void set_expected_calls_for_Register(IOTHUB_DEVICE_CONFIG* device_config, bool is_using_cbs)
 {
-    set_expected_calls_for_is_device_registered_ex(device_config, NULL);
-
     // is_device_credential_acceptable
     // Nothing to expect.
 
@@ -553,8 +442,6 @@ static void set_expected_calls_for_Register(IOTHUB_DEVICE_CONFIG* device_config,
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE))
         .SetReturn(TEST_IOTHUB_HOST_FQDN_CHAR_PTR);
     EXPECTED_CALL(device_create(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST))
-        .SetReturn(NULL);
 
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE)).SetReturn(TEST_IOTHUB_HOST_FQDN_CHAR_PTR);
     EXPECTED_CALL(iothubtransportamqp_methods_create(TEST_IOTHUB_HOST_FQDN_CHAR_PTR, device_config->deviceId));
@@ -571,10 +458,10 @@ static void set_expected_calls_for_Register(IOTHUB_DEVICE_CONFIG* device_config,
             .IgnoreArgument(3);
         STRICT_EXPECTED_CALL(device_set_option(TEST_DEVICE_HANDLE, DEVICE_OPTION_SAS_TOKEN_REFRESH_TIME_SECS, IGNORED_PTR_ARG))
             .IgnoreArgument(3);
+        STRICT_EXPECTED_CALL(device_set_option(TEST_DEVICE_HANDLE, DEVICE_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, IGNORED_PTR_ARG))
+            .IgnoreArgument(3);
     }
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG))
-        .IgnoreArgument(2);
     STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
 }
 
@@ -583,13 +470,7 @@ static void set_expected_calls_for_Unregister(IOTHUB_DEVICE_HANDLE iothub_device
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
         .SetReturn(TEST_DEVICE_ID_CHAR_PTR);
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2)
-        .IgnoreArgument(3)
-        .SetReturn((LIST_ITEM_HANDLE)iothub_device_handle);
-
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG))
-        .IgnoreArgument(2);
+    set_expected_calls_for_find_registered_device(iothub_device_handle);
 
     STRICT_EXPECTED_CALL(iothubtransportamqp_methods_destroy(TEST_IOTHUBTRANSPORTAMQP_METHODS));
 
@@ -598,6 +479,18 @@ static void set_expected_calls_for_Unregister(IOTHUB_DEVICE_HANDLE iothub_device
     EXPECTED_CALL(free(IGNORED_PTR_ARG));
 }
 
+static void set_expected_calls_for_Unregister2(const char* device_id)
+{
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
+        .SetReturn(device_id);
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
+        .SetReturn(device_id);
+    STRICT_EXPECTED_CALL(iothubtransportamqp_methods_destroy(TEST_IOTHUBTRANSPORTAMQP_METHODS));
+    STRICT_EXPECTED_CALL(device_destroy(TEST_DEVICE_HANDLE));
+    STRICT_EXPECTED_CALL(STRING_delete(TEST_DEVICE_ID_STRING_HANDLE));
+    EXPECTED_CALL(free(IGNORED_PTR_ARG));
+}
+
 static void set_expected_calls_for_establish_amqp_connection()
 {
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE))
@@ -703,8 +596,6 @@ static void set_expected_calls_for_get_new_underlying_io_transport(bool feed_opt
 
 static void set_expected_calls_for_DoWork2(PDLIST_ENTRY wts, int wts_length, DEVICE_STATE current_device_state, bool is_tls_io_acquired, bool feed_options, bool is_using_cbs, bool is_connection_created, bool is_connection_open, int number_of_registered_devices, time_t current_time, bool subscribe_for_methods)
 {
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
-
     if (!is_tls_io_acquired)
     {
         set_expected_calls_for_get_new_underlying_io_transport(feed_options);
@@ -722,9 +613,7 @@ static void set_expected_calls_for_DoWork2(PDLIST_ENTRY wts, int wts_length, DEV
         int i;
         for (i = 0; i < number_of_registered_devices; i++)
         {
-            EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
             set_expected_calls_for_Device_DoWork(wts, wts_length, current_device_state, is_using_cbs, current_time, subscribe_for_methods);
-            EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
         }
     }
 
@@ -741,20 +630,16 @@ static void set_expected_calls_for_DoWork(PDLIST_ENTRY wts, int wts_length, DEVI
 
 static void set_expected_calls_for_Destroy(int number_of_registered_devices, IOTHUB_DEVICE_HANDLE* registered_devices)
 {
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
-
+    // Devices are unregistered from the last to the first registered.
     int i;
-    for (i = 0; i < number_of_registered_devices; i++)
+    for (i = number_of_registered_devices - 1; i >= 0; i--)
     {
-        EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-        EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
         set_expected_calls_for_Unregister(registered_devices[i]);
     }
     
-    STRICT_EXPECTED_CALL(singlylinkedlist_destroy(TEST_REGISTERED_DEVICES_LIST));
+    EXPECTED_CALL(free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(amqp_connection_destroy(TEST_AMQP_CONNECTION_HANDLE));
     STRICT_EXPECTED_CALL(xio_destroy(TEST_UNDERLYING_IO_TRANSPORT));
-    STRICT_EXPECTED_CALL(retry_control_destroy(TEST_RETRY_CONTROL_HANDLE));
     STRICT_EXPECTED_CALL(STRING_delete(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE));
     EXPECTED_CALL(free(IGNORED_PTR_ARG));
 }
@@ -785,23 +670,21 @@ static void set_expected_calls_for_prepare_device_for_connection_retry(DEVICE_ST
     }
 }
 
+// @remarks    Expects the first failure of the connection, so its retry control gets created.
 static void set_expected_calls_for_prepare_for_connection_retry(int number_of_registered_devices, DEVICE_STATE current_device_state)
 {
     RETRY_ACTION retry_action = RETRY_ACTION_RETRY_NOW;
+    STRICT_EXPECTED_CALL(retry_control_create(DEFAULT_RETRY_POLICY, DEFAULT_MAX_RETRY_TIME_IN_SECS));
     STRICT_EXPECTED_CALL(retry_control_should_retry(TEST_RETRY_CONTROL_HANDLE, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer_retry_action(&retry_action, sizeof(RETRY_ACTION));
 
     STRICT_EXPECTED_CALL(xio_retrieveoptions(TEST_UNDERLYING_IO_TRANSPORT))
         .SetReturn(TEST_OPTIONHANDLER_HANDLE);
 
-    EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_PTR_ARG));
-
     int i;
     for (i = 0; i < number_of_registered_devices; i++)
     {
-        EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
         set_expected_calls_for_prepare_device_for_connection_retry(current_device_state);
-        EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
     }
 
     STRICT_EXPECTED_CALL(amqp_connection_destroy(TEST_AMQP_CONNECTION_HANDLE));
@@ -1017,7 +900,6 @@ static void crank_transport_ready_after_create(void* handle, PDLIST_ENTRY wts, i
     crank_transport(handle, wts, wts_length, DEVICE_STATE_STOPPED, true, is_using_cbs, true, true, number_of_registered_devices, current_time, false);
 
     STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(TEST_current_time);
-    STRICT_EXPECTED_CALL(retry_control_reset(TEST_RETRY_CONTROL_HANDLE));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_ConnectionStatusCallBack(TEST_IOTHUB_CLIENT_LL_HANDLE, IOTHUB_CLIENT_CONNECTION_AUTHENTICATED, IOTHUB_CLIENT_CONNECTION_OK));
 
     TEST_device_create_saved_on_state_changed_callback(TEST_device_create_saved_on_state_changed_context,
@@ -1033,6 +915,36 @@ static IOTHUB_DEVICE_HANDLE register_device(TRANSPORT_LL_HANDLE handle, IOTHUB_D
     return IoTHubTransport_AMQP_Common_Register(handle, device_config, TEST_IOTHUB_CLIENT_LL_HANDLE, wts);
 }
 
+// With 2 connections TEST_DEVICE_ID_CHAR_PTR is assigned to the first connection and TEST_DEVICE_ID_2_CHAR_PTR to the second.
+static TRANSPORT_LL_HANDLE create_transport_with_two_connections(IOTHUB_DEVICE_HANDLE* device_handle, IOTHUB_DEVICE_HANDLE* device_handle_2)
+{
+    size_t number_of_connections = 2;
+    bool value = true;
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    *device_handle = register_device(handle, create_device_config(TEST_DEVICE_ID_CHAR_PTR, true), &TEST_waitingToSend, true);
+    *device_handle_2 = register_device(handle, create_device_config(TEST_DEVICE_ID_2_CHAR_PTR, true), &TEST_waitingToSend, true);
+
+    umock_c_reset_all_calls();
+    (void)IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_AMQP_CONNECTION_COUNT, &number_of_connections);
+
+    // Creates the TLS I/O of the first connection only.
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE))
+        .SetReturn(TEST_IOTHUB_HOST_FQDN_CHAR_PTR);
+    STRICT_EXPECTED_CALL(xio_setoption(TEST_UNDERLYING_IO_TRANSPORT, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2)
+        .IgnoreArgument(3)
+        .SetReturn(0);
+    STRICT_EXPECTED_CALL(xio_retrieveoptions(TEST_UNDERLYING_IO_TRANSPORT))
+        .SetReturn(TEST_OPTIONHANDLER_HANDLE);
+    (void)IoTHubTransport_AMQP_Common_SetOption(handle, "Some XIO option name", &value);
+
+    TEST_amqp_get_io_transport_result = TEST_UNDERLYING_IO_TRANSPORT_2;
+
+    return handle;
+}
+
 static void destroy_transport(TRANSPORT_LL_HANDLE handle, IOTHUB_DEVICE_HANDLE registered_device0, IOTHUB_DEVICE_HANDLE registered_device1)
 {
     int number_of_registered_devices = (registered_device1 != NULL ? 2 : (registered_device0 != NULL ? 1 : 0));
@@ -1072,8 +984,6 @@ static void register_umock_alias_types()
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUBMESSAGE_CONTENT_TYPE, int);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUBMESSAGE_DISPOSITION_RESULT, int);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUBTRANSPORT_AMQP_METHOD_HANDLE, void*);
-    REGISTER_UMOCK_ALIAS_TYPE(LIST_ACTION_FUNCTION, void*);
-    REGISTER_UMOCK_ALIAS_TYPE(LIST_MATCH_FUNCTION, void*);
     REGISTER_UMOCK_ALIAS_TYPE(MAP_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(MAP_RESULT, int);
     REGISTER_UMOCK_ALIAS_TYPE(METHOD_HANDLE, void*);
@@ -1098,7 +1008,6 @@ static void register_umock_alias_types()
     REGISTER_UMOCK_ALIAS_TYPE(RETRY_CONTROL_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(SESSION_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(SINGLYLINKEDLIST_HANDLE, void*);
-    REGISTER_UMOCK_ALIAS_TYPE(LIST_ITEM_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(time_t, int);
     REGISTER_UMOCK_ALIAS_TYPE(XIO_HANDLE, void*);
@@ -1117,14 +1026,6 @@ static void register_global_mock_hooks()
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
     REGISTER_GLOBAL_MOCK_HOOK(iothubtransportamqp_methods_subscribe, my_iothubtransportamqp_methods_subscribe);
 
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_add, TEST_singlylinkedlist_add);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_remove, TEST_singlylinkedlist_remove);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_get_head_item, TEST_singlylinkedlist_get_head_item);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_get_next_item, TEST_singlylinkedlist_get_next_item);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_find, TEST_singlylinkedlist_find);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_foreach, TEST_singlylinkedlist_foreach);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_item_get_value, TEST_singlylinkedlist_item_get_value);
-
     REGISTER_GLOBAL_MOCK_HOOK(DList_RemoveEntryList, my_DList_RemoveEntryList);
     REGISTER_GLOBAL_MOCK_HOOK(DList_InsertTailList, my_DList_InsertTailList);
     REGISTER_GLOBAL_MOCK_HOOK(DList_IsListEmpty, my_DList_IsListEmpty);
@@ -1157,8 +1058,6 @@ static void register_global_mock_returns()
     REGISTER_GLOBAL_MOCK_RETURN(amqpvalue_create_symbol, TEST_AMQP_VALUE);
     REGISTER_GLOBAL_MOCK_RETURN(amqpvalue_create_string, TEST_AMQP_VALUE);
 
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(singlylinkedlist_create, NULL);
-
     REGISTER_GLOBAL_MOCK_RETURN(device_start_async, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(device_start_async, 1);
 
@@ -1211,8 +1110,6 @@ static void reset_test_data()
     TEST_device_create_saved_on_state_changed_context = NULL;
     TEST_device_create_return = TEST_DEVICE_HANDLE;
 
-    saved_registered_devices_list_count = 0;
-
     TEST_device_subscribe_message_saved_callback = NULL;
     TEST_device_subscribe_message_saved_context = NULL;
     TEST_device_subscribe_message_return = 0;
@@ -1220,9 +1117,6 @@ static void reset_test_data()
     TEST_MESSAGE_ID = 1234;
     TEST_mallocAndStrcpy_s_return = 0;
 
-    TEST_singlylinkedlist_foreach_list = NULL;
-    TEST_singlylinkedlist_foreach_action_function = NULL;
-    TEST_singlylinkedlist_foreach_context = NULL;
     
     memset(&TEST_waitingToSend, 0, sizeof(TEST_waitingToSend));
 
@@ -1303,7 +1197,7 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_Register_creates_a_new_methods_handler
 
     handle = create_transport();
 
-    device_config.deviceId = "blah";
+    device_config.deviceId = TEST_DEVICE_ID_CHAR_PTR;
     device_config.deviceKey = "cucu";
     device_config.deviceSasToken = NULL;
 
@@ -1334,7 +1228,7 @@ TEST_FUNCTION(when_creating_the_methods_handler_fails_then_IoTHubTransport_AMQP_
 
     handle = create_transport();
 
-    device_config.deviceId = "blah";
+    device_config.deviceId = TEST_DEVICE_ID_CHAR_PTR;
     device_config.deviceKey = "cucu";
     device_config.deviceSasToken = NULL;
 
@@ -1347,7 +1241,7 @@ TEST_FUNCTION(when_creating_the_methods_handler_fails_then_IoTHubTransport_AMQP_
     size_t n = umock_c_negative_tests_call_count();
     for (i = 0; i < n; i++)
     {
-        if (i == 0 || i == 2 || i == 3 || i == 4 || i == 6 || i == 8 || i == 9 || i == 16)
+        if (i == 1 || i == 2 || i == 3 || i == 5 || i == 7 || i == 14)
         {
             // These expected calls do not cause the API to fail.
             continue;
@@ -1384,7 +1278,7 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_Unregister_destroys_the_methods_handle
 
     handle = create_transport();
 
-    device_config.deviceId = "blah";
+    device_config.deviceId = TEST_DEVICE_ID_CHAR_PTR;
     device_config.deviceKey = "cucu";
     device_config.deviceSasToken = NULL;
 
@@ -1435,7 +1329,7 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_Subscribe_DeviceMethod_with_valid_hand
 
     handle = create_transport();
 
-    device_config.deviceId = "blah";
+    device_config.deviceId = TEST_DEVICE_ID_CHAR_PTR;
     device_config.deviceKey = "cucu";
     device_config.deviceSasToken = NULL;
 
@@ -1469,7 +1363,7 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_Subscribe_DeviceMethod_After_Subscribe
 
     handle = create_transport();
 
-    device_config.deviceId = "blah";
+    device_config.deviceId = TEST_DEVICE_ID_CHAR_PTR;
     device_config.deviceKey = "cucu";
     device_config.deviceSasToken = NULL;
 
@@ -1504,7 +1398,7 @@ TEST_FUNCTION(on_methods_unsubscribed_CALLS_iothubtransportamqp_methods_unsubscr
 
     handle = create_transport();
 
-    device_config.deviceId = "blah";
+    device_config.deviceId = TEST_DEVICE_ID_CHAR_PTR;
     device_config.deviceKey = "cucu";
     device_config.deviceSasToken = NULL;
 
@@ -1542,7 +1436,7 @@ TEST_FUNCTION(on_methods_unsubscribed_re_subscribes)
 
     handle = create_transport();
 
-    device_config.deviceId = "blah";
+    device_config.deviceId = TEST_DEVICE_ID_CHAR_PTR;
     device_config.deviceKey = "cucu";
     device_config.deviceSasToken = NULL;
 
@@ -1592,7 +1486,7 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_Unsubscribe_unsubscribes_from_receivin
 
     handle = create_transport();
 
-    device_config.deviceId = "blah";
+    device_config.deviceId = TEST_DEVICE_ID_CHAR_PTR;
     device_config.deviceKey = "cucu";
     device_config.deviceSasToken = NULL;
 
@@ -1626,7 +1520,7 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_Unsubscribe_without_subscribe_does_not
 
     handle = create_transport();
 
-    device_config.deviceId = "blah";
+    device_config.deviceId = TEST_DEVICE_ID_CHAR_PTR;
     device_config.deviceKey = "cucu";
     device_config.deviceSasToken = NULL;
 
@@ -1663,7 +1557,7 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_DoWork_does_not_subscribe_if_SubScribe
 
     handle = create_transport();
 
-    device_config.deviceId = "blah";
+    device_config.deviceId = TEST_DEVICE_ID_CHAR_PTR;
     device_config.deviceKey = "cucu";
     device_config.deviceSasToken = NULL;
 
@@ -1696,7 +1590,7 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_DoWork_does_not_subscribe_if_already_s
 
     handle = create_transport();
 
-    device_config.deviceId = "blah";
+    device_config.deviceId = TEST_DEVICE_ID_CHAR_PTR;
     device_config.deviceKey = "cucu";
     device_config.deviceSasToken = NULL;
 
@@ -1743,7 +1637,7 @@ TEST_FUNCTION(on_methods_request_received_responds_to_the_method_request)
 
     handle = create_transport();
 
-    device_config.deviceId = "blah";
+    device_config.deviceId = TEST_DEVICE_ID_CHAR_PTR;
     device_config.deviceKey = "cucu";
     device_config.deviceSasToken = NULL;
 
@@ -1835,7 +1729,7 @@ TEST_FUNCTION(on_methods_error_does_nothing)
 
     handle = create_transport();
 
-    device_config.deviceId = "blah";
+    device_config.deviceId = TEST_DEVICE_ID_CHAR_PTR;
     device_config.deviceKey = "cucu";
     device_config.deviceSasToken = NULL;
 
@@ -1965,10 +1859,10 @@ TEST_FUNCTION(GetHostName_success)
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_003: [Memory shall be allocated for the transport's internal state structure (`instance`)]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_005: [If `config->upperConfig->protocolGatewayHostName` is NULL, `instance->iothub_target_fqdn` shall be set as `config->upperConfig->iotHubName` + "." + `config->upperConfig->iotHubSuffix`]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_006: [If `config->upperConfig->protocolGatewayHostName` is not NULL, `instance->iothub_target_fqdn` shall be set with a copy of it]
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_008: [`instance->registered_devices` shall be set using singlylinkedlist_create()]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_008: [`instance->registered_devices` shall be allocated using malloc() with an initial capacity of DEFAULT_REGISTERED_DEVICES_CAPACITY devices]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_010: [`get_io_transport` shall be saved on `instance->underlying_io_transport_provider`]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_012: [If IoTHubTransport_AMQP_Common_Create succeeds it shall return a pointer to `instance`.]
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_124: [`instance->connection_retry_control` shall be set using retry_control_create(), passing defaults EXPONENTIAL_BACKOFF_WITH_JITTER and 0]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_171: [`instance->retry_policy` and `instance->retry_timeout_limit_in_secs` shall be set with the defaults EXPONENTIAL_BACKOFF_WITH_JITTER and 0]
 TEST_FUNCTION(Create_success)
 {
     // arrange
@@ -1992,9 +1886,8 @@ TEST_FUNCTION(Create_success)
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_002: [IoTHubTransport_AMQP_Common_Create shall fail and return NULL if `config->upperConfig->protocol` is NULL]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_004: [If malloc() fails, IoTHubTransport_AMQP_Common_Create shall fail and return NULL]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_007: [If `instance->iothub_target_fqdn` fails to be set, IoTHubTransport_AMQP_Common_Create shall fail and return NULL]
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_009: [If singlylinkedlist_create() fails, IoTHubTransport_AMQP_Common_Create shall fail and return NULL]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_009: [If malloc() fails allocating `instance->registered_devices`, IoTHubTransport_AMQP_Common_Create shall fail and return NULL]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_011: [If IoTHubTransport_AMQP_Common_Create fails it shall free any memory it allocated]
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_125: [If retry_control_create() fails, IoTHubTransport_AMQP_Common_Create shall fail and return NULL]
 TEST_FUNCTION(Create_failure_checks)
 {
     // arrange
@@ -2168,20 +2061,22 @@ TEST_FUNCTION(Register_device_already_registered)
     TRANSPORT_LL_HANDLE handle = create_transport();
 
     IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE registered_device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG, device_config->deviceId))
-        .IgnoreArgument(2)
-        .SetReturn(TEST_LIST_ITEM_HANDLE);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
+        .SetReturn(TEST_DEVICE_ID_CHAR_PTR);
 
     // act
     IOTHUB_DEVICE_HANDLE device_handle = IoTHubTransport_AMQP_Common_Register(handle, device_config, TEST_IOTHUB_CLIENT_LL_HANDLE, &TEST_waitingToSend);
 
     // assert
+    ASSERT_IS_NOT_NULL(registered_device_handle);
     ASSERT_IS_NULL(device_handle);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
-    destroy_transport(handle, device_handle, NULL);
+    destroy_transport(handle, registered_device_handle, NULL);
 }
 
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_065: [IoTHubTransport_AMQP_Common_Register shall fail and return NULL if the device is not using an authentication mode compatible with the currently used by the transport.]
@@ -2200,10 +2095,6 @@ TEST_FUNCTION(Register_CBS_transport_X509_credentials)
 
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG, device_config2->deviceId))
-        .IgnoreArgument(2)
-        .SetReturn(NULL);
-
     // act
     IOTHUB_DEVICE_HANDLE device_handle2 = IoTHubTransport_AMQP_Common_Register(handle, device_config2, TEST_IOTHUB_CLIENT_LL_HANDLE, &TEST_waitingToSend);
 
@@ -2232,10 +2123,6 @@ TEST_FUNCTION(Register_X509_transport_CBS_credentials)
 
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG, device_config2->deviceId))
-        .IgnoreArgument(2)
-        .SetReturn(NULL);
-
     // act
     IOTHUB_DEVICE_HANDLE device_handle2 = IoTHubTransport_AMQP_Common_Register(handle, device_config2, TEST_IOTHUB_CLIENT_LL_HANDLE, &TEST_waitingToSend);
 
@@ -2271,7 +2158,7 @@ TEST_FUNCTION(Register_failure_checks)
     size_t i, n = umock_c_negative_tests_call_count();
     for (i = 0; i < n; i++)
     {
-        if (i == 0 || i == 2 || i == 3 || i == 4 || i >= 6)
+        if (i == 1 || i == 2 || i == 3 || i >= 5)
         {
             // These expected calls do not cause the API to fail.
             continue;
@@ -2356,7 +2243,8 @@ TEST_FUNCTION(Subscribe_device_not_registered)
     IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
 
     umock_c_reset_all_calls();
-    set_expected_calls_for_is_device_registered(device_config, NULL);
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
+        .SetReturn(TEST_DEVICE_ID_2_CHAR_PTR);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
         .SetReturn(TEST_DEVICE_ID_CHAR_PTR);
 
@@ -2470,7 +2358,8 @@ TEST_FUNCTION(Unsubscribe_messages_device_not_registered)
     IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
 
     umock_c_reset_all_calls();
-    set_expected_calls_for_is_device_registered(device_config, NULL);
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
+        .SetReturn(TEST_DEVICE_ID_2_CHAR_PTR);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
         .SetReturn(TEST_DEVICE_ID_CHAR_PTR);
 
@@ -2735,8 +2624,6 @@ TEST_FUNCTION(SetOption_device_specific_failure_check)
     size_t value = 10;
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
-    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG)).SetReturn(device_handle);
     STRICT_EXPECTED_CALL(device_set_option(TEST_DEVICE_HANDLE, DEVICE_OPTION_EVENT_SEND_TIMEOUT_SECS, &value))
         .SetReturn(1);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
@@ -2936,6 +2823,79 @@ TEST_FUNCTION(SetOption_xio_option_fails)
     destroy_transport(handle, device_handle, NULL);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_167: [If xio_retrieveoptions() fails, IoTHubTransport_AMQP_Common_SetOption shall fail and return IOTHUB_CLIENT_ERROR]
+TEST_FUNCTION(SetOption_xio_option_retrieveoptions_fails)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    bool value = true;
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE))
+        .SetReturn(TEST_IOTHUB_HOST_FQDN_CHAR_PTR);
+    STRICT_EXPECTED_CALL(xio_setoption(TEST_UNDERLYING_IO_TRANSPORT, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2)
+        .IgnoreArgument(3)
+        .SetReturn(0);
+    STRICT_EXPECTED_CALL(xio_retrieveoptions(TEST_UNDERLYING_IO_TRANSPORT))
+        .SetReturn(NULL);
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_SetOption(handle, "Some XIO option name", &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_166: [After the option is applied, the options of the TLS I/O shall be saved in `instance->saved_tls_options` using xio_retrieveoptions(), so the TLS I/O of every connection established later is set with them]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_025: [When `instance->tls_io` is created, it shall be set with `instance->saved_tls_options` using OptionHandler_FeedOptions()]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_162: [Each of the `instance->number_of_connections` connections that has registered devices assigned shall be established independently]
+TEST_FUNCTION(SetOption_xio_option_reaches_the_TLS_IO_of_the_second_connection)
+{
+    // arrange
+    initialize_test_variables();
+    IOTHUB_DEVICE_HANDLE device_handle;
+    IOTHUB_DEVICE_HANDLE device_handle_2;
+    TRANSPORT_LL_HANDLE handle = create_transport_with_two_connections(&device_handle, &device_handle_2);
+    ASSERT_IS_NOT_NULL(device_handle);
+    ASSERT_IS_NOT_NULL(device_handle_2);
+
+    umock_c_reset_all_calls();
+    // First connection, whose TLS I/O was created by SetOption.
+    set_expected_calls_for_establish_amqp_connection();
+    // Second connection.
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE))
+        .SetReturn(TEST_IOTHUB_HOST_FQDN_CHAR_PTR);
+    STRICT_EXPECTED_CALL(OptionHandler_FeedOptions(TEST_OPTIONHANDLER_HANDLE, TEST_UNDERLYING_IO_TRANSPORT_2))
+        .SetReturn(OPTIONHANDLER_OK);
+    set_expected_calls_for_establish_amqp_connection();
+    STRICT_EXPECTED_CALL(amqp_connection_do_work(TEST_AMQP_CONNECTION_HANDLE));
+    STRICT_EXPECTED_CALL(amqp_connection_do_work(TEST_AMQP_CONNECTION_HANDLE));
+
+    // act
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    umock_c_reset_all_calls();
+    set_expected_calls_for_Unregister2(TEST_DEVICE_ID_2_CHAR_PTR);
+    IoTHubTransport_AMQP_Common_Unregister(device_handle_2);
+    destroy_transport(handle, device_handle, NULL);
+}
+
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_99_002: [If `OPTION_AMQP_REMOTE_IDLE_TIMEOUT_RATIO` value is 0, the test will fail]
 TEST_FUNCTION(SetOption_cl2svc_keep_alive_send_ratio_fail_for_zero)
 {
@@ -3020,6 +2980,90 @@ TEST_FUNCTION(SetOption_cl2svc_keep_alive_send_ratio_success_for_0875)
     destroy_transport(handle, device_handle, NULL);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_163: [If `option` is `amqp_connection_count` and `value` is zero or greater than MAX_NUMBER_OF_AMQP_CONNECTIONS, IoTHubTransport_AMQP_Common_SetOption shall fail and return IOTHUB_CLIENT_INVALID_ARG]
+TEST_FUNCTION(SetOption_amqp_connection_count_fail_for_zero)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    // This creates the amqp_connection_handle
+    crank_transport_ready_after_create(handle, &TEST_waitingToSend, 0, false, true, 1, TEST_current_time, false);
+
+    umock_c_reset_all_calls();
+    size_t value = 0;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_AMQP_CONNECTION_COUNT, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_163: [If `option` is `amqp_connection_count` and `value` is zero or greater than MAX_NUMBER_OF_AMQP_CONNECTIONS, IoTHubTransport_AMQP_Common_SetOption shall fail and return IOTHUB_CLIENT_INVALID_ARG]
+TEST_FUNCTION(SetOption_amqp_connection_count_fail_for_more_than_the_maximum)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    // This creates the amqp_connection_handle
+    crank_transport_ready_after_create(handle, &TEST_waitingToSend, 0, false, true, 1, TEST_current_time, false);
+
+    umock_c_reset_all_calls();
+    size_t value = 17;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_AMQP_CONNECTION_COUNT, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_164: [If `option` is `amqp_connection_count`, the registered devices shall be re-assigned to the new number of connections, stopping only the devices whose connection changes]
+TEST_FUNCTION(SetOption_amqp_connection_count_same_count_does_not_stop_devices)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    // This creates the amqp_connection_handle
+    crank_transport_ready_after_create(handle, &TEST_waitingToSend, 0, false, true, 1, TEST_current_time, false);
+
+    umock_c_reset_all_calls();
+    size_t value = 1;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_AMQP_CONNECTION_COUNT, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
 /* Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_01_032: [ If `option` is `proxy_data`, `value` shall be used as an `HTTP_PROXY_OPTIONS*`. ]*/
 /* Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_01_033: [ The fields `host_address`, `port`, `username` and `password` shall be saved for later used (needed when creating the underlying IO to be used by the transport). ]*/
 /* Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_01_039: [ If setting the `proxy_data` option succeeds, `IoTHubTransport_AMQP_Common_SetOption` shall return `IOTHUB_CLIENT_OK` ]*/
@@ -3767,15 +3811,9 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_Destroy_frees_proxy_options)
     (void)IoTHubTransport_AMQP_Common_SetOption(handle, "proxy_data", &http_proxy_options);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
-
-    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
-
     set_expected_calls_for_Unregister(device_handle);
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_destroy(TEST_REGISTERED_DEVICES_LIST));
-    STRICT_EXPECTED_CALL(retry_control_destroy(TEST_RETRY_CONTROL_HANDLE));
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(STRING_delete(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE));
     STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
@@ -3817,8 +3855,7 @@ TEST_FUNCTION(Unregister_device_not_registered)
 
     umock_c_reset_all_calls();
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
-        .SetReturn(TEST_DEVICE_ID_CHAR_PTR);
-    set_expected_calls_for_is_device_registered_ex(device_config, NULL);
+        .SetReturn(TEST_DEVICE_ID_2_CHAR_PTR);
 
     // act
     IoTHubTransport_AMQP_Common_Unregister(device_handle);
@@ -3856,7 +3893,106 @@ TEST_FUNCTION(Unregister_succeeds)
     destroy_transport(handle, device_handle, NULL);
 }
 
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_089: [IoTHubClient_LL_MessageCallback() shall be invoked passing the client and the incoming message handles as parameters]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_168: [If no other registered device is assigned to the connection of `device_instance`, its amqp_connection and TLS I/O shall be destroyed, unless the transport is being destroyed]
+TEST_FUNCTION(Unregister_last_device_of_a_connection_destroys_the_connection)
+{
+    // arrange
+    initialize_test_variables();
+    IOTHUB_DEVICE_HANDLE device_handle;
+    IOTHUB_DEVICE_HANDLE device_handle_2;
+    TRANSPORT_LL_HANDLE handle = create_transport_with_two_connections(&device_handle, &device_handle_2);
+
+    umock_c_reset_all_calls();
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    umock_c_reset_all_calls();
+    set_expected_calls_for_Unregister2(TEST_DEVICE_ID_2_CHAR_PTR);
+    STRICT_EXPECTED_CALL(amqp_connection_destroy(TEST_AMQP_CONNECTION_HANDLE));
+    STRICT_EXPECTED_CALL(xio_destroy(TEST_UNDERLYING_IO_TRANSPORT_2));
+
+    // act
+    IoTHubTransport_AMQP_Common_Unregister(device_handle_2);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_168: [If no other registered device is assigned to the connection of `device_instance`, its amqp_connection and TLS I/O shall be destroyed, unless the transport is being destroyed]
+TEST_FUNCTION(Unregister_device_of_a_connection_still_in_use_does_not_destroy_the_connection)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, create_device_config(TEST_DEVICE_ID_CHAR_PTR, true), &TEST_waitingToSend, true);
+    IOTHUB_DEVICE_HANDLE device_handle_2 = register_device(handle, create_device_config(TEST_DEVICE_ID_2_CHAR_PTR, true), &TEST_waitingToSend, true);
+
+    umock_c_reset_all_calls();
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    umock_c_reset_all_calls();
+    set_expected_calls_for_Unregister2(TEST_DEVICE_ID_2_CHAR_PTR);
+
+    // act
+    IoTHubTransport_AMQP_Common_Unregister(device_handle_2);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_074: [IoTHubTransport_AMQP_Common_Register shall add the `amqp_device_instance` to `instance->registered_devices`]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_082: [`device_instance` shall be removed from `instance->registered_devices`]
+TEST_FUNCTION(Register_and_Unregister_more_devices_than_the_initial_registry_capacity_succeeds)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    const char* device_ids[] = { "device0", "device1", "device2", "device3", "device4", "device5", "device6", "device7", "device8", "device9" };
+    IOTHUB_DEVICE_HANDLE device_handles[10];
+    size_t i;
+
+    for (i = 0; i < 10; i++)
+    {
+        IOTHUB_DEVICE_CONFIG* device_config = create_device_config(device_ids[i], true);
+        device_handles[i] = register_device(handle, device_config, &TEST_waitingToSend, true);
+        ASSERT_IS_NOT_NULL(device_handles[i]);
+    }
+
+    umock_c_reset_all_calls();
+
+    for (i = 0; i < 10; i++)
+    {
+        STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
+            .SetReturn(device_ids[i]);
+        STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
+            .SetReturn(device_ids[i]);
+        STRICT_EXPECTED_CALL(iothubtransportamqp_methods_destroy(TEST_IOTHUBTRANSPORTAMQP_METHODS));
+        STRICT_EXPECTED_CALL(device_destroy(TEST_DEVICE_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_delete(TEST_DEVICE_ID_STRING_HANDLE));
+        EXPECTED_CALL(free(IGNORED_PTR_ARG));
+    }
+
+    // act
+    for (i = 0; i < 10; i++)
+    {
+        IoTHubTransport_AMQP_Common_Unregister(device_handles[i]);
+    }
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, NULL, NULL);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_089:[IoTHubClient_LL_MessageCallback() shall be invoked passing the client and the incoming message handles as parameters]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_091: [If IoTHubClient_LL_MessageCallback() succeeds, on_message_received_callback shall return DEVICE_MESSAGE_DISPOSITION_RESULT_NONE]
 TEST_FUNCTION(on_message_received_succeeds)
 {
@@ -3959,7 +4095,6 @@ TEST_FUNCTION(on_message_received_fails)
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_062: [If `new_state` shall be saved into the `registered_device` instance]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_063: [If `registered_device->time_of_last_state_change` shall be set using get_time()]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_120: [If `new_state` is DEVICE_STATE_STARTED, IoTHubClient_LL_ConnectionStatusCallBack shall be invoked with IOTHUB_CLIENT_CONNECTION_AUTHENTICATED and IOTHUB_CLIENT_CONNECTION_OK]
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_127: [If `new_state` is DEVICE_STATE_STARTED, retry_control_reset() shall be invoked passing `instance->connection_retry_control`]
 TEST_FUNCTION(DoWork_success)
 {
     // arrange
@@ -3990,7 +4125,6 @@ TEST_FUNCTION(DoWork_success)
     ASSERT_IS_NOT_NULL(TEST_device_create_saved_on_state_changed_callback);
 
     STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(TEST_current_time);
-    STRICT_EXPECTED_CALL(retry_control_reset(TEST_RETRY_CONTROL_HANDLE));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_ConnectionStatusCallBack(TEST_IOTHUB_CLIENT_LL_HANDLE, IOTHUB_CLIENT_CONNECTION_AUTHENTICATED, IOTHUB_CLIENT_CONNECTION_OK));
 
     TEST_device_create_saved_on_state_changed_callback(TEST_device_create_saved_on_state_changed_context,
@@ -4009,6 +4143,7 @@ TEST_FUNCTION(DoWork_success)
 }
 
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_115: [If the AMQP connection is closed by the service side, the connection retry logic shall be triggered]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_124: [If the connection does not have a retry control yet, it shall be created using retry_control_create(), passing `instance->retry_policy` and `instance->retry_timeout_limit_in_secs`]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_126: [The connection retry shall be attempted only if retry_control_should_retry() returns RETRY_ACTION_NOW, or if it fails]
 TEST_FUNCTION(on_amqp_connection_state_changed_CLOSED_unexpectedly)
 {
@@ -4050,6 +4185,138 @@ TEST_FUNCTION(on_amqp_connection_state_changed_CLOSED_unexpectedly)
     destroy_transport(handle, device_handle, NULL);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_125: [If retry_control_create() fails, the connection retry shall be attempted immediately]
+TEST_FUNCTION(DoWork_retry_control_create_fails_retries_connection_immediately)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    crank_transport_ready_after_create(handle, &TEST_waitingToSend, 0, false, true, 1, TEST_current_time, false);
+
+    TEST_amqp_connection_create_saved_on_state_changed_callback(
+        TEST_amqp_connection_create_saved_on_state_changed_context,
+        AMQP_CONNECTION_STATE_OPENED, AMQP_CONNECTION_STATE_ERROR);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(retry_control_create(DEFAULT_RETRY_POLICY, DEFAULT_MAX_RETRY_TIME_IN_SECS))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(xio_retrieveoptions(TEST_UNDERLYING_IO_TRANSPORT))
+        .SetReturn(TEST_OPTIONHANDLER_HANDLE);
+    set_expected_calls_for_prepare_device_for_connection_retry(DEVICE_STATE_STARTED);
+    STRICT_EXPECTED_CALL(amqp_connection_destroy(TEST_AMQP_CONNECTION_HANDLE));
+    STRICT_EXPECTED_CALL(xio_destroy(TEST_UNDERLYING_IO_TRANSPORT));
+
+    // act
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_127: [If `new_state` is DEVICE_STATE_STARTED and the connection of the device has a retry control, retry_control_reset() shall be invoked passing it]
+TEST_FUNCTION(on_device_state_changed_STARTED_after_connection_retry_resets_retry_control)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    crank_transport(handle, &TEST_waitingToSend, 0, DEVICE_STATE_STOPPED, false, true, false, false, 1, TEST_current_time, false);
+
+    TEST_amqp_connection_create_saved_on_state_changed_callback(
+        TEST_amqp_connection_create_saved_on_state_changed_context,
+        AMQP_CONNECTION_STATE_CLOSED, AMQP_CONNECTION_STATE_OPENED);
+
+    TEST_amqp_connection_create_saved_on_state_changed_callback(
+        TEST_amqp_connection_create_saved_on_state_changed_context,
+        AMQP_CONNECTION_STATE_OPENED, AMQP_CONNECTION_STATE_CLOSED);
+
+    umock_c_reset_all_calls();
+    set_expected_calls_for_prepare_for_connection_retry(1, DEVICE_STATE_STOPPED);
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    umock_c_reset_all_calls();
+    set_expected_calls_for_DoWork2(&TEST_waitingToSend, 0, DEVICE_STATE_STOPPED, false, true, true, false, false, 1, TEST_current_time, false);
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    TEST_amqp_connection_create_saved_on_state_changed_callback(
+        TEST_amqp_connection_create_saved_on_state_changed_context,
+        AMQP_CONNECTION_STATE_CLOSED, AMQP_CONNECTION_STATE_OPENED);
+
+    crank_transport(handle, &TEST_waitingToSend, 0, DEVICE_STATE_STOPPED, true, true, true, true, 1, TEST_current_time, false);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(TEST_current_time);
+    STRICT_EXPECTED_CALL(retry_control_reset(TEST_RETRY_CONTROL_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_ConnectionStatusCallBack(TEST_IOTHUB_CLIENT_LL_HANDLE, IOTHUB_CLIENT_CONNECTION_AUTHENTICATED, IOTHUB_CLIENT_CONNECTION_OK));
+
+    // act
+    TEST_device_create_saved_on_state_changed_callback(TEST_device_create_saved_on_state_changed_context,
+        DEVICE_STATE_STOPPED, DEVICE_STATE_STARTED);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_017: [If a connection is in state `RECONNECTION_REQUIRED`, IoTHubTransport_AMQP_Common_DoWork shall attempt to trigger the connection-retry logic of that connection only]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_034: [The options of the `tls_io` of the connection shall be saved on `instance->saved_tls_options` using xio_retrieveoptions()]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_170: [Only the registered devices assigned to the connection being retried shall be prepared for the connection retry]
+TEST_FUNCTION(DoWork_connection_error_retries_only_that_connection)
+{
+    // arrange
+    initialize_test_variables();
+    IOTHUB_DEVICE_HANDLE device_handle;
+    IOTHUB_DEVICE_HANDLE device_handle_2;
+    TRANSPORT_LL_HANDLE handle = create_transport_with_two_connections(&device_handle, &device_handle_2);
+
+    umock_c_reset_all_calls();
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    // The second connection was the last one established.
+    TEST_amqp_connection_create_saved_on_state_changed_callback(
+        TEST_amqp_connection_create_saved_on_state_changed_context,
+        AMQP_CONNECTION_STATE_OPENED, AMQP_CONNECTION_STATE_ERROR);
+
+    umock_c_reset_all_calls();
+    RETRY_ACTION retry_action = RETRY_ACTION_RETRY_NOW;
+    STRICT_EXPECTED_CALL(retry_control_create(DEFAULT_RETRY_POLICY, DEFAULT_MAX_RETRY_TIME_IN_SECS));
+    STRICT_EXPECTED_CALL(retry_control_should_retry(TEST_RETRY_CONTROL_HANDLE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_retry_action(&retry_action, sizeof(RETRY_ACTION));
+    STRICT_EXPECTED_CALL(xio_retrieveoptions(TEST_UNDERLYING_IO_TRANSPORT_2))
+        .SetReturn(TEST_OPTIONHANDLER_HANDLE);
+    set_expected_calls_for_prepare_device_for_connection_retry(DEVICE_STATE_STOPPED);
+    STRICT_EXPECTED_CALL(amqp_connection_destroy(TEST_AMQP_CONNECTION_HANDLE));
+    STRICT_EXPECTED_CALL(xio_destroy(TEST_UNDERLYING_IO_TRANSPORT_2));
+    // The first connection keeps running.
+    STRICT_EXPECTED_CALL(amqp_connection_do_work(TEST_AMQP_CONNECTION_HANDLE));
+
+    // act
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    umock_c_reset_all_calls();
+    set_expected_calls_for_Unregister2(TEST_DEVICE_ID_2_CHAR_PTR);
+    IoTHubTransport_AMQP_Common_Unregister(device_handle_2);
+    destroy_transport(handle, device_handle, NULL);
+}
+
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_016: [If `handle` is NULL, IoTHubTransport_AMQP_Common_DoWork shall return without doing any work]
 TEST_FUNCTION(DoWork_NULL_handle)
 {
@@ -4078,7 +4345,6 @@ TEST_FUNCTION(DoWork_get_underlying_io_transport_provider_fails)
     ASSERT_IS_NOT_NULL(device_handle);
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE))
         .SetReturn(TEST_IOTHUB_HOST_FQDN_CHAR_PTR);
     TEST_amqp_get_io_transport_result = NULL;
@@ -4381,11 +4647,10 @@ TEST_FUNCTION(ConnectionStatusCallBack_UNAUTH_retry_expired)
     umock_c_reset_all_calls();
     
     RETRY_ACTION retry_action = RETRY_ACTION_STOP_RETRYING;
+    STRICT_EXPECTED_CALL(retry_control_create(IOTHUB_CLIENT_RETRY_IMMEDIATE, 1));
     STRICT_EXPECTED_CALL(retry_control_should_retry(TEST_RETRY_CONTROL_HANDLE, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer_retry_action(&retry_action, sizeof(RETRY_ACTION));
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_foreach(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    
     STRICT_EXPECTED_CALL(IoTHubClient_LL_ConnectionStatusCallBack(TEST_IOTHUB_CLIENT_LL_HANDLE, IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED, IOTHUB_CLIENT_CONNECTION_RETRY_EXPIRED));
 
     // act
@@ -4395,12 +4660,6 @@ TEST_FUNCTION(ConnectionStatusCallBack_UNAUTH_retry_expired)
     
     (void)IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
 
-    bool continue_processing;
-    TEST_singlylinkedlist_foreach_action_function(
-        saved_registered_devices_list[saved_registered_devices_list_count - 1], 
-        TEST_singlylinkedlist_foreach_context, 
-        &continue_processing);
-
     // assert
     ASSERT_ARE_EQUAL(int, 0, result_set_retry_policy);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -4749,48 +5008,73 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_SetRetryPolicy_NULL_handle)
     // cleanup
 }
 
+// Flags the connection of the device for retry and runs DoWork, so the connection gets its retry control.
+static void fail_connection_once(TRANSPORT_LL_HANDLE handle)
+{
+    TEST_amqp_connection_create_saved_on_state_changed_callback(
+        TEST_amqp_connection_create_saved_on_state_changed_context,
+        AMQP_CONNECTION_STATE_OPENED, AMQP_CONNECTION_STATE_ERROR);
+
+    umock_c_reset_all_calls();
+    set_expected_calls_for_prepare_for_connection_retry(1, DEVICE_STATE_STARTED);
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+}
+
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_130: [If retry_control_create() fails, `IoTHubTransport_AMQP_Common_SetRetryPolicy` shall fail and return non-zero.]
 TEST_FUNCTION(IoTHubTransport_AMQP_Common_SetRetryPolicy_failure_checks)
 {
     // arrange
-    ASSERT_ARE_EQUAL(int, 0, umock_c_negative_tests_init());
     initialize_test_variables();
     TRANSPORT_LL_HANDLE handle = create_transport();
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, create_device_config(TEST_DEVICE_ID_CHAR_PTR, true), &TEST_waitingToSend, true);
+    crank_transport_ready_after_create(handle, &TEST_waitingToSend, 0, false, true, 1, TEST_current_time, false);
+    fail_connection_once(handle);
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(retry_control_create(IOTHUB_CLIENT_RETRY_IMMEDIATE, 1600));
-    umock_c_negative_tests_snapshot();
+    STRICT_EXPECTED_CALL(retry_control_create(IOTHUB_CLIENT_RETRY_IMMEDIATE, 1600))
+        .SetReturn(NULL);
 
     // act
-    size_t i;
-    for (i = 0; i < umock_c_negative_tests_call_count(); i++)
-    {
-        // arrange
-        char error_msg[64];
+    int result = IoTHubTransport_AMQP_Common_SetRetryPolicy(handle, IOTHUB_CLIENT_RETRY_IMMEDIATE, 1600);
 
-        umock_c_negative_tests_reset();
-        umock_c_negative_tests_fail_call(i);
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
 
-        // act
-        int result = IoTHubTransport_AMQP_Common_SetRetryPolicy(handle, IOTHUB_CLIENT_RETRY_IMMEDIATE, 1600);
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
 
-        // assert
-        sprintf(error_msg, "On failed call %zu", i);
-        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, 0, result, error_msg);
-    }
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_172: [`retryPolicy` and `retryTimeoutLimitInSeconds` shall be saved in `transport_instance`, and used for retry controls of connections that fail later]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_128: [If no errors occur, `IoTHubTransport_AMQP_Common_SetRetryPolicy` shall return zero.]
+TEST_FUNCTION(IoTHubTransport_AMQP_Common_SetRetryPolicy_success)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    umock_c_reset_all_calls();
+
+    // act
+    int result = IoTHubTransport_AMQP_Common_SetRetryPolicy(handle, IOTHUB_CLIENT_RETRY_IMMEDIATE, 1600);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
 
     // cleanup
-    umock_c_negative_tests_deinit();
     destroy_transport(handle, NULL, NULL);
 }
 
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_129: [`transport_instance->connection_retry_control` shall be set using retry_control_create(), passing `retryPolicy` and `retryTimeoutLimitInSeconds`.]
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_128: [If no errors occur, `IoTHubTransport_AMQP_Common_SetRetryPolicy` shall return zero.]
-TEST_FUNCTION(IoTHubTransport_AMQP_Common_SetRetryPolicy_success)
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_129: [Each connection that has a retry control shall get a new one created using retry_control_create(), passing `retryPolicy` and `retryTimeoutLimitInSeconds`.]
+TEST_FUNCTION(IoTHubTransport_AMQP_Common_SetRetryPolicy_replaces_retry_control_of_failed_connection)
 {
     // arrange
     initialize_test_variables();
     TRANSPORT_LL_HANDLE handle = create_transport();
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, create_device_config(TEST_DEVICE_ID_CHAR_PTR, true), &TEST_waitingToSend, true);
+    crank_transport_ready_after_create(handle, &TEST_waitingToSend, 0, false, true, 1, TEST_current_time, false);
+    fail_connection_once(handle);
 
     umock_c_reset_all_calls();
     STRICT_EXPECTED_CALL(retry_control_create(IOTHUB_CLIENT_RETRY_IMMEDIATE, 1600));
@@ -4804,7 +5088,7 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_SetRetryPolicy_success)
     ASSERT_ARE_EQUAL(int, 0, result);
 
     // cleanup
-    destroy_transport(handle, NULL, NULL);
+    destroy_transport(handle, device_handle, NULL);
 }
 
 END_TEST_SUITE(iothubtransport_amqp_common_ut)
@@ -627,7 +627,8 @@ static void set_expected_calls_for_device_set_option(AMQP_DEVICE_HANDLE handle,
     {
         if (strcmp(DEVICE_OPTION_CBS_REQUEST_TIMEOUT_SECS, option_name) == 0 ||
             strcmp(DEVICE_OPTION_SAS_TOKEN_REFRESH_TIME_SECS, option_name) == 0 ||
-            strcmp(DEVICE_OPTION_SAS_TOKEN_LIFETIME_SECS, option_name) == 0)
+            strcmp(DEVICE_OPTION_SAS_TOKEN_LIFETIME_SECS, option_name) == 0 ||
+            strcmp(DEVICE_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, option_name) == 0)
         {
             STRICT_EXPECTED_CALL(authentication_set_option(TEST_AUTHENTICATION_HANDLE, option_name, option_value));
         }
@@ -460,7 +460,7 @@ static void setup_subscribe_expected_calls(void)
     STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE));
 }
 
-static void setup_message_received_calls(void)
+static void setup_message_received_calls_with_tracked_handles(bool tracked_handles_array_is_full)
 {
     AMQP_VALUE correlation_id = (AMQP_VALUE)0x5000;
     AMQP_VALUE application_properties = (AMQP_VALUE)0x5001;
@@ -480,7 +480,10 @@ static void setup_message_received_calls(void)
     STRICT_EXPECTED_CALL(properties_get_correlation_id(test_properties_handle, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer(2, &correlation_id, sizeof(correlation_id));
     EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    if (tracked_handles_array_is_full)
+    {
+        EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    }
     STRICT_EXPECTED_CALL(amqpvalue_get_uuid(correlation_id, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer(2, &correlation_id_uuid, sizeof(correlation_id_uuid));
     STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(TEST_UAMQP_MESSAGE, 0, IGNORED_PTR_ARG))
@@ -505,6 +508,11 @@ static void setup_message_received_calls(void)
     STRICT_EXPECTED_CALL(properties_destroy(test_properties_handle));
 }
 
+static void setup_message_received_calls(void)
+{
+    setup_message_received_calls_with_tracked_handles(true);
+}
+
 static void setup_method_respond_calls(void)
 {
     static const unsigned char response_payload[] = { 0x43 };
@@ -577,7 +585,6 @@ static void setup_respond_calls(int status)
         .IgnoreArgument_on_message_send_complete()
         .IgnoreArgument_callback_context();
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(amqpvalue_destroy(status_property_value));
     STRICT_EXPECTED_CALL(amqpvalue_destroy(status_property_key));
     STRICT_EXPECTED_CALL(amqpvalue_destroy(response_properties_map));
@@ -795,7 +802,7 @@ TEST_FUNCTION(iothubtransportamqp_methods_destroy_frees_2_tracked_handles)
     umock_c_reset_all_calls();
     setup_message_received_calls();
     g_on_message_received(amqp_methods_handle, TEST_UAMQP_MESSAGE);
-    setup_message_received_calls();
+    setup_message_received_calls_with_tracked_handles(false);
     g_on_message_received(amqp_methods_handle, TEST_UAMQP_MESSAGE);
     iothubtransportamqp_methods_unsubscribe(amqp_methods_handle);
     umock_c_reset_all_calls();
@@ -1389,6 +1396,44 @@ TEST_FUNCTION(when_a_message_is_received_a_new_method_request_is_indicated)
     iothubtransportamqp_methods_destroy(amqp_methods_handle);
 }
 
+/* Tests_SRS_IOTHUBTRANSPORT_AMQP_METHODS_01_155: [ The array of tracked handles shall only be resized when all its slots are in use, doubling its capacity (starting with 4 slots). ]*/
+TEST_FUNCTION(when_all_tracked_handle_slots_are_in_use_the_tracked_handles_array_is_resized)
+{
+    /// arrange
+    IOTHUBTRANSPORT_AMQP_METHODS_HANDLE amqp_methods_handle = iothubtransportamqp_methods_create("testhost", "testdevice");
+    AMQP_VALUE result;
+    size_t i;
+    umock_c_reset_all_calls();
+    setup_subscribe_expected_calls();
+    (void)iothubtransportamqp_methods_subscribe(amqp_methods_handle, TEST_SESSION_HANDLE, test_on_methods_error, (void*)0x4242, test_on_method_request_received, (void*)0x4243, test_on_methods_unsubscribed, (void*)0x4344);
+    umock_c_reset_all_calls();
+
+    setup_message_received_calls();
+    for (i = 0; i < 3; i++)
+    {
+        setup_message_received_calls_with_tracked_handles(false);
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        (void)g_on_message_received(amqp_methods_handle, TEST_UAMQP_MESSAGE);
+    }
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    umock_c_reset_all_calls();
+
+    setup_message_received_calls_with_tracked_handles(true);
+
+    /// act
+    result = g_on_message_received(amqp_methods_handle, TEST_UAMQP_MESSAGE);
+
+    /// assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, TEST_DELIVERY_ACCEPTED, result);
+
+    /// cleanup
+    iothubtransportamqp_methods_destroy(amqp_methods_handle);
+}
+
 /* Tests_SRS_IOTHUBTRANSPORT_AMQP_METHODS_01_041: [ If `message` is NULL, the RELEASED outcome shall be returned and an error shall be indicated. ]*/
 /* Tests_SRS_IOTHUBTRANSPORT_AMQP_METHODS_01_129: [ The released outcome shall be created by calling `messaging_delivery_released`. ]*/
 /* Tests_SRS_IOTHUBTRANSPORT_AMQP_METHODS_01_128: [ When the RELEASED outcome is returned, an error shall be indicated by calling the `on_methods_error` callback passed to `iothubtransportamqp_methods_subscribe`. ]*/
@@ -2210,7 +2255,6 @@ TEST_FUNCTION(iothubtransportamqp_methods_respond_sends_the_uAMQP_message)
         .IgnoreArgument_on_message_send_complete()
         .IgnoreArgument_callback_context();
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(amqpvalue_destroy(status_property_value));
     STRICT_EXPECTED_CALL(amqpvalue_destroy(status_property_key));
     STRICT_EXPECTED_CALL(amqpvalue_destroy(response_properties_map));
@@ -2425,7 +2469,6 @@ TEST_FUNCTION(iothubtransportamqp_methods_respond_can_be_called_from_the_method_
         .IgnoreArgument_on_message_send_complete()
         .IgnoreArgument_callback_context();
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(amqpvalue_destroy(status_property_value));
     STRICT_EXPECTED_CALL(amqpvalue_destroy(status_property_key));
     STRICT_EXPECTED_CALL(amqpvalue_destroy(response_properties_map));
@@ -2479,7 +2522,7 @@ TEST_FUNCTION(iothubtransportamqp_methods_respond_to_the_second_method_succeeds)
     g_on_message_received(amqp_methods_handle, TEST_UAMQP_MESSAGE);
     g_first_method_handle = g_method_handle;
     /* setup second request */
-    setup_message_received_calls();
+    setup_message_received_calls_with_tracked_handles(false);
     g_on_message_received(amqp_methods_handle, TEST_UAMQP_MESSAGE);
     g_second_method_handle = g_method_handle;
     umock_c_reset_all_calls();
@@ -2504,7 +2547,6 @@ TEST_FUNCTION(iothubtransportamqp_methods_respond_to_the_second_method_succeeds)
     STRICT_EXPECTED_CALL(messagesender_send_async(TEST_MESSAGE_SENDER, TEST_RESPONSE_UAMQP_MESSAGE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
         .IgnoreArgument_on_message_send_complete()
         .IgnoreArgument_callback_context();
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(amqpvalue_destroy(status_property_value));
     STRICT_EXPECTED_CALL(amqpvalue_destroy(status_property_key));
@@ -2543,7 +2585,7 @@ TEST_FUNCTION(iothubtransportamqp_methods_respond_removes_the_handle_from_the_tr
     g_on_message_received(amqp_methods_handle, TEST_UAMQP_MESSAGE);
     g_first_method_handle = g_method_handle;
     /* setup second request */
-    setup_message_received_calls();
+    setup_message_received_calls_with_tracked_handles(false);
     g_on_message_received(amqp_methods_handle, TEST_UAMQP_MESSAGE);
     g_second_method_handle = g_method_handle;
     umock_c_reset_all_calls();
@@ -2587,7 +2629,7 @@ TEST_FUNCTION(iothubtransportamqp_methods_respond_after_a_handle_has_been_remove
     umock_c_reset_all_calls();
 
     /* setup second request */
-    setup_message_received_calls();
+    setup_message_received_calls_with_tracked_handles(false);
 
     /// act
     g_on_message_received(amqp_methods_handle, TEST_UAMQP_MESSAGE);
@@ -2599,6 +2641,51 @@ TEST_FUNCTION(iothubtransportamqp_methods_respond_after_a_handle_has_been_remove
     iothubtransportamqp_methods_destroy(amqp_methods_handle);
 }
 
+/* Tests_SRS_IOTHUBTRANSPORT_AMQP_METHODS_01_114: [ The handle `method_handle` shall be removed from the array used to track the method handles. ]*/
+/* Tests_SRS_IOTHUBTRANSPORT_AMQP_METHODS_01_156: [ The slot of `method_handle` shall be filled with the last tracked handle, without resizing the array used to track the method handles. ]*/
+TEST_FUNCTION(iothubtransportamqp_methods_respond_to_the_first_method_keeps_tracking_the_other_handles)
+{
+    /// arrange
+    int result;
+    IOTHUBTRANSPORT_AMQP_METHODS_HANDLE amqp_methods_handle = iothubtransportamqp_methods_create("testhost", "testdevice");
+    const unsigned char response_payload[] = { 0x43 };
+    IOTHUBTRANSPORT_AMQP_METHOD_HANDLE g_first_method_handle;
+    IOTHUBTRANSPORT_AMQP_METHOD_HANDLE g_second_method_handle;
+    IOTHUBTRANSPORT_AMQP_METHOD_HANDLE g_third_method_handle;
+
+    umock_c_reset_all_calls();
+    setup_subscribe_expected_calls();
+    (void)iothubtransportamqp_methods_subscribe(amqp_methods_handle, TEST_SESSION_HANDLE, test_on_methods_error, (void*)0x4242, test_on_method_request_received, (void*)0x4243, test_on_methods_unsubscribed, (void*)0x4344);
+    umock_c_reset_all_calls();
+    setup_message_received_calls();
+    g_on_message_received(amqp_methods_handle, TEST_UAMQP_MESSAGE);
+    g_first_method_handle = g_method_handle;
+    setup_message_received_calls_with_tracked_handles(false);
+    g_on_message_received(amqp_methods_handle, TEST_UAMQP_MESSAGE);
+    g_second_method_handle = g_method_handle;
+    setup_message_received_calls_with_tracked_handles(false);
+    g_on_message_received(amqp_methods_handle, TEST_UAMQP_MESSAGE);
+    g_third_method_handle = g_method_handle;
+    umock_c_reset_all_calls();
+    setup_respond_calls(242);
+    (void)iothubtransportamqp_methods_respond(g_first_method_handle, response_payload, sizeof(response_payload), 242);
+    umock_c_reset_all_calls();
+
+    setup_respond_calls(242);
+    setup_respond_calls(242);
+
+    /// act
+    result = iothubtransportamqp_methods_respond(g_third_method_handle, response_payload, sizeof(response_payload), 242);
+    result |= iothubtransportamqp_methods_respond(g_second_method_handle, response_payload, sizeof(response_payload), 242);
+
+    /// assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    /// cleanup
+    iothubtransportamqp_methods_destroy(amqp_methods_handle);
+}
+
 /* on_message_receiver_state_changed */
 
 /* Tests_SRS_IOTHUBTRANSPORT_AMQP_METHODS_01_119: [ When `on_message_receiver_state_changed` if called with the `new_state` being `MESSAGE_RECEIVER_STATE_ERROR`, an error shall be indicated by calling the `on_methods_error` callback passed to `iothubtransportamqp_methods_subscribe`. ]*/
@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef CBORDECODER_H
+#define CBORDECODER_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "multitree.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+/*CBOR_DECODER turns a CBOR (RFC 7049) map or array into the MultiTree JSONDecoder_JSON_To_MultiTree produces for the same data: every
+leaf value is the JSON text of the value as a '\0' terminated char*, so that it can be given to CreateAgentDataType_From_String.*/
+
+#define CBOR_DECODER_RESULT_VALUES          \
+CBOR_DECODER_OK,                            \
+CBOR_DECODER_INVALID_ARG,                   \
+CBOR_DECODER_PARSE_ERROR,                   \
+CBOR_DECODER_MULTITREE_FAILED,              \
+CBOR_DECODER_ERROR
+
+DEFINE_ENUM(CBOR_DECODER_RESULT, CBOR_DECODER_RESULT_VALUES);
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+MOCKABLE_FUNCTION(, CBOR_DECODER_RESULT, CBORDecoder_CBOR_To_MultiTree, const unsigned char*, cbor, size_t, size, MULTITREE_HANDLE*, multiTreeHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CBORDECODER_H */
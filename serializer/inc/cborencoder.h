@@ -0,0 +1,40 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef CBORENCODER_H
+#define CBORENCODER_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "multitree.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+/*CBOR_ENCODER writes a MultiTree whose leaves are AGENT_DATA_TYPE* as CBOR (RFC 7049) into a single growing buffer. The layout is the one
+JSONEncoder_EncodeTree produces: every node is a map from the names of its children to their values. Numbers, booleans and binary data are
+written in their binary form instead of as text.*/
+
+#define CBOR_ENCODER_CONTENT_TYPE "application/cbor"
+
+#define CBOR_ENCODER_RESULT_VALUES          \
+CBOR_ENCODER_OK,                            \
+CBOR_ENCODER_INVALID_ARG,                   \
+CBOR_ENCODER_MULTITREE_ERROR,               \
+CBOR_ENCODER_AGENT_DATA_TYPES_ERROR,        \
+CBOR_ENCODER_ERROR
+
+DEFINE_ENUM(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+MOCKABLE_FUNCTION(, CBOR_ENCODER_RESULT, CBOREncoder_EncodeTree, MULTITREE_HANDLE, treeHandle, size_t, initialCapacity, unsigned char**, destination, size_t*, destinationSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CBORENCODER_H */
@@ -171,6 +171,8 @@ MOCKABLE_FUNCTION(, EXECUTE_COMMAND_RESULT, CodeFirst_InvokeAction, DEVICE_HANDL
 MOCKABLE_FUNCTION(, METHODRETURN_HANDLE, CodeFirst_InvokeMethod, DEVICE_HANDLE, deviceHandle, void*, callbackUserContext, const char*, relativeMethodPath, const char*, methodName, size_t, parameterCount, const AGENT_DATA_TYPE*, parameterValues);
 
 MOCKABLE_FUNCTION(, EXECUTE_COMMAND_RESULT, CodeFirst_ExecuteCommand, void*, device, const char*, command);
+MOCKABLE_FUNCTION(, EXECUTE_COMMAND_RESULT, CodeFirst_ExecuteCommandCBOR, void*, device, const unsigned char*, command, size_t, size);
+MOCKABLE_FUNCTION(, const DATA_MARSHALLER_ENCODER*, CodeFirst_GetEncoder, void*, device);
 
 MOCKABLE_FUNCTION(, METHODRETURN_HANDLE, CodeFirst_ExecuteMethod, void*, device, const char*, methodName, const char*, methodPayload);
 
@@ -180,6 +182,10 @@ MOCKABLE_FUNCTION(, void, CodeFirst_DestroyDevice, void*, device);
 extern CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destinationSize, size_t numProperties, ...);
 extern CODEFIRST_RESULT CodeFirst_SendAsyncReported(unsigned char** destination, size_t* destinationSize, size_t numReportedProperties, ...);
 
+MOCKABLE_FUNCTION(, CODEFIRST_RESULT, CodeFirst_SendAsyncReportedDiff, unsigned char**, destination, size_t*, destinationSize, void*, device, size_t*, reportToken);
+MOCKABLE_FUNCTION(, CODEFIRST_RESULT, CodeFirst_AcknowledgeReportedProperties, void*, device, size_t, reportToken);
+MOCKABLE_FUNCTION(, CODEFIRST_RESULT, CodeFirst_NackReportedProperties, void*, device, size_t, reportToken);
+
 MOCKABLE_FUNCTION(, CODEFIRST_RESULT, CodeFirst_IngestDesiredProperties, void*, device, const char*, jsonPayload, bool, parseDesiredNode);
 
 MOCKABLE_FUNCTION(, AGENT_DATA_TYPE_TYPE, CodeFirst_GetPrimitiveType, const char*, typeName);
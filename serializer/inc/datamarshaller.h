@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include "agenttypesystem.h"
 #include "schema.h"
+#include "multitree.h"
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/vector.h"
 #ifdef __cplusplus
@@ -25,7 +26,8 @@ DATA_MARSHALLER_JSON_ENCODER_ERROR,             \
 DATA_MARSHALLER_ERROR,                          \
 DATA_MARSHALLER_AGENT_DATA_TYPES_ERROR,         \
 DATA_MARSHALLER_MULTITREE_ERROR,                \
-DATA_MARSHALLER_ONLY_ONE_VALUE_ALLOWED          \
+DATA_MARSHALLER_ONLY_ONE_VALUE_ALLOWED,         \
+DATA_MARSHALLER_CBOR_ENCODER_ERROR              \
 
 DEFINE_ENUM(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_RESULT_VALUES);
 
@@ -36,6 +38,20 @@ typedef struct DATA_MARSHALLER_VALUE_TAG
 } DATA_MARSHALLER_VALUE;
 
 typedef struct DATA_MARSHALLER_HANDLE_DATA_TAG* DATA_MARSHALLER_HANDLE;
+
+/*encodes the MultiTree built by DataMarshaller_SendData, whose leaves are const AGENT_DATA_TYPE*. capacityHint is the size of the previous
+payload of the same DataMarshaller instance. The content is handed over in *destination and *destinationSize and is freed by the caller with free.*/
+typedef DATA_MARSHALLER_RESULT(*DATA_MARSHALLER_ENCODE_TREE_FUNC)(MULTITREE_HANDLE treeHandle, size_t capacityHint, unsigned char** destination, size_t* destinationSize);
+
+/*an output format of DataMarshaller_SendData. contentType and contentEncoding are the values for IoTHubMessage_SetContentTypeSystemProperty
+and IoTHubMessage_SetContentEncodingSystemProperty of the messages that carry the content; contentEncoding is NULL for binary formats.*/
+typedef struct DATA_MARSHALLER_ENCODER_TAG
+{
+    const char* contentType;
+    const char* contentEncoding;
+    DATA_MARSHALLER_ENCODE_TREE_FUNC encodeTree;
+} DATA_MARSHALLER_ENCODER;
+
 #include "azure_c_shared_utility/umock_c_prod.h"
 
 MOCKABLE_FUNCTION(,DATA_MARSHALLER_HANDLE, DataMarshaller_Create, SCHEMA_MODEL_TYPE_HANDLE, modelHandle, bool, includePropertyPath);
@@ -44,6 +60,12 @@ MOCKABLE_FUNCTION(,DATA_MARSHALLER_RESULT, DataMarshaller_SendData, DATA_MARSHAL
 
 MOCKABLE_FUNCTION(, DATA_MARSHALLER_RESULT, DataMarshaller_SendData_ReportedProperties, DATA_MARSHALLER_HANDLE, dataMarshallerHandle, VECTOR_HANDLE, values, unsigned char**, destination, size_t*, destinationSize);
 
+MOCKABLE_FUNCTION(, const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetJSONEncoder);
+MOCKABLE_FUNCTION(, const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetCBOREncoder);
+MOCKABLE_FUNCTION(, void, DataMarshaller_SetDefaultEncoder, const DATA_MARSHALLER_ENCODER*, encoder);
+MOCKABLE_FUNCTION(, const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetDefaultEncoder);
+MOCKABLE_FUNCTION(, const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetEncoder, DATA_MARSHALLER_HANDLE, dataMarshallerHandle);
+
 #ifdef __cplusplus
 }
 #endif
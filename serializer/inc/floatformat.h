@@ -0,0 +1,29 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef FLOATFORMAT_H
+#define FLOATFORMAT_H
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+/*FLOAT_FORMAT writes the shortest (Grisu2) decimal text that parses back (strtod/strtof) to exactly the same double/float.
+The text does not depend on the current locale. Only finite values are formatted; NaN and infinities are left to the caller.*/
+
+/*large enough for any text produced by FloatFormat_Double or FloatFormat_Single, including the terminating '\0'*/
+#define FLOAT_FORMAT_BUFFER_SIZE 32
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+MOCKABLE_FUNCTION(, size_t, FloatFormat_Double, double, value, char*, destination, size_t, destinationSize);
+MOCKABLE_FUNCTION(, size_t, FloatFormat_Single, float, value, char*, destination, size_t, destinationSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLOATFORMAT_H */
@@ -0,0 +1,28 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef FNVHASH_H
+#define FNVHASH_H
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+/*FNV-1a hashes of a run of characters. FnvHash_Compute32 indexes the hash tables of schema and multitree,
+FnvHash_Compute64 detects changes of the reported property values in codefirst.*/
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+MOCKABLE_FUNCTION(, uint32_t, FnvHash_Compute32, const char*, text, size_t, length);
+MOCKABLE_FUNCTION(, uint64_t, FnvHash_Compute64, const char*, text, size_t, length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FNVHASH_H */
@@ -47,7 +47,9 @@ MOCKABLE_FUNCTION(, DEVICE_RESULT, Device_CommitTransaction_ReportedProperties,
 MOCKABLE_FUNCTION(, void, Device_DestroyTransaction_ReportedProperties, REPORTED_PROPERTIES_TRANSACTION_HANDLE, transactionHandle);
 
 MOCKABLE_FUNCTION(, EXECUTE_COMMAND_RESULT, Device_ExecuteCommand, DEVICE_HANDLE, deviceHandle, const char*, command);
+MOCKABLE_FUNCTION(, EXECUTE_COMMAND_RESULT, Device_ExecuteCommandCBOR, DEVICE_HANDLE, deviceHandle, const unsigned char*, command, size_t, size);
 MOCKABLE_FUNCTION(, METHODRETURN_HANDLE, Device_ExecuteMethod, DEVICE_HANDLE, deviceHandle, const char*, methodName, const char*, methodPayload);
+MOCKABLE_FUNCTION(, const DATA_MARSHALLER_ENCODER*, Device_GetEncoder, DEVICE_HANDLE, deviceHandle);
 
 MOCKABLE_FUNCTION(, DEVICE_RESULT, Device_IngestDesiredProperties, void*, startAddress, DEVICE_HANDLE, deviceHandle, const char*, jsonPayload, bool, parseDesiredNode);
 #ifdef __cplusplus
@@ -22,8 +22,20 @@ typedef enum JSON_DECODER_RESULT_TAG
     JSON_DECODER_ERROR
 } JSON_DECODER_RESULT;
 
+/*callbacks of JSONDecoder_JSON_To_Events. name is NULL (and nameLength 0) for the outermost object or array and for array elements.
+Names and values point into the JSON text and are not '\0' terminated. A callback returns 0 to continue parsing, anything else to stop it.*/
+typedef struct JSON_DECODER_EVENTS_TAG
+{
+    int (*onBeginObject)(void* context, const char* name, size_t nameLength);
+    int (*onEndObject)(void* context);
+    int (*onBeginArray)(void* context, const char* name, size_t nameLength);
+    int (*onEndArray)(void* context);
+    int (*onValue)(void* context, const char* name, size_t nameLength, const char* value, size_t valueLength);
+} JSON_DECODER_EVENTS;
+
 #include "azure_c_shared_utility/umock_c_prod.h"
 MOCKABLE_FUNCTION(, JSON_DECODER_RESULT, JSONDecoder_JSON_To_MultiTree, char*, json, MULTITREE_HANDLE*, multiTreeHandle);
+MOCKABLE_FUNCTION(, JSON_DECODER_RESULT, JSONDecoder_JSON_To_Events, const char*, json, const JSON_DECODER_EVENTS*, events, void*, context);
 
 #ifdef __cplusplus
 }
@@ -15,6 +15,7 @@ extern "C" {
 #endif
 
 #include "multitree.h"
+#include "jsonwriter.h"
 
 #define JSON_ENCODER_RESULT_VALUES           \
 JSON_ENCODER_OK,                             \
@@ -39,6 +40,7 @@ typedef JSON_ENCODER_TOSTRING_RESULT(*JSON_ENCODER_TOSTRING_FUNC)(STRING_HANDLE,
 
 MOCKABLE_FUNCTION(, JSON_ENCODER_TOSTRING_RESULT, JSONEncoder_CharPtr_ToString, STRING_HANDLE, destination, const void*, value);
 MOCKABLE_FUNCTION(, JSON_ENCODER_RESULT, JSONEncoder_EncodeTree, MULTITREE_HANDLE, treeHandle, STRING_HANDLE, destination, JSON_ENCODER_TOSTRING_FUNC, toStringFunc);
+MOCKABLE_FUNCTION(, JSON_ENCODER_RESULT, JSONEncoder_EncodeTreeToWriter, MULTITREE_HANDLE, treeHandle, JSON_WRITER_HANDLE, writer, JSON_ENCODER_TOSTRING_FUNC, toStringFunc);
 
 #ifdef __cplusplus
 }
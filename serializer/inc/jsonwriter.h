@@ -0,0 +1,49 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#endif
+
+/*JSON_WRITER appends JSON text directly into a single growing buffer. It is used by the writers that DECLARE_STRUCT and DECLARE_MODEL emit
+and produces the same text as AgentDataTypes_ToString/JSONEncoder_EncodeTree for the same values.*/
+typedef struct JSON_WRITER_HANDLE_DATA_TAG* JSON_WRITER_HANDLE;
+
+#define JSON_WRITER_RESULT_VALUES           \
+JSON_WRITER_OK,                             \
+JSON_WRITER_INVALID_ARG,                    \
+JSON_WRITER_ERROR
+
+DEFINE_ENUM(JSON_WRITER_RESULT, JSON_WRITER_RESULT_VALUES);
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+MOCKABLE_FUNCTION(, JSON_WRITER_HANDLE, JSONWriter_Create, size_t, initialCapacity);
+MOCKABLE_FUNCTION(, void, JSONWriter_Destroy, JSON_WRITER_HANDLE, handle);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_BeginObject, JSON_WRITER_HANDLE, handle);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_EndObject, JSON_WRITER_HANDLE, handle);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendName, JSON_WRITER_HANDLE, handle, const char*, name);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendRaw, JSON_WRITER_HANDLE, handle, const char*, value, size_t, length);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendString, JSON_WRITER_HANDLE, handle, const char*, value);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendInt64, JSON_WRITER_HANDLE, handle, int64_t, value);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendBool, JSON_WRITER_HANDLE, handle, bool, value);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendDouble, JSON_WRITER_HANDLE, handle, double, value);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendFloat, JSON_WRITER_HANDLE, handle, float, value);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_Release, JSON_WRITER_HANDLE, handle, unsigned char**, destination, size_t*, destinationSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JSONWRITER_H */
@@ -39,7 +39,8 @@ DEFINE_ENUM(SERIALIZER_RESULT, SERIALIZER_RESULT_VALUES);
 
 #define SERIALIZER_CONFIG_VALUES  \
     CommandPollingInterval,     \
-    SerializeDelayedBufferMaxSize
+    SerializeDelayedBufferMaxSize, \
+    SerializeEncoder
 
 /** @brief Enumeration specifying the option to set on the serializer when  
  * calling ::serializer_setconfig.
@@ -57,6 +57,7 @@
 #include "codefirst.h"
 #include "agenttypesystem.h"
 #include "schema.h"
+#include "jsonwriter.h"
 
 
 
@@ -107,6 +108,8 @@ extern "C"
     /* Codes_SRS_SERIALIZER_99_082:[ DECLARE_STRUCT's field<n>Name argument shall uniquely name a field within the struct.] */ \
     FOR_EACH_2_KEEP_1(REFLECTED_FIELD, name, __VA_ARGS__) \
     TO_AGENT_DATA_TYPE(name, __VA_ARGS__) \
+    /*Codes_SRS_SERIALIZER_H_09_001: [ DECLARE_STRUCT shall declare a function ToJSON_name that writes a struct value as a JSON object straight from its fields. ]*/ \
+    TO_JSON(C2(ToJSON_, name), name, __VA_ARGS__) \
     /*Codes_SRS_SERIALIZER_99_042:[ The parameter types are either predefined parameter types (specs SRS_SERIALIZER_99_004-SRS_SERIALIZER_99_014) or a type introduced by DECLARE_STRUCT.]*/ \
     static AGENT_DATA_TYPES_RESULT FromAGENT_DATA_TYPE_##name(const AGENT_DATA_TYPE* source, name* destination) \
     { \
@@ -175,6 +178,9 @@ extern "C"
     typedef struct name { int :1; FOR_EACH_1(BUILD_MODEL_STRUCT, __VA_ARGS__) } name;        \
     FOR_EACH_1_KEEP_1(CREATE_MODEL_ELEMENT, name, __VA_ARGS__)                               \
     TO_AGENT_DATA_TYPE(name, DROP_FIRST_COMMA_FROM_ARGS(EXPAND_MODEL_ARGS(__VA_ARGS__)))     \
+    TO_JSON(C2(ToJSON_, name), name, DROP_FIRST_COMMA_FROM_ARGS(EXPAND_MODEL_ARGS(__VA_ARGS__))) \
+    TO_JSON(C2(ToJSONData_, name), name, DROP_FIRST_COMMA_FROM_ARGS(EXPAND_MODEL_DATA_ARGS(__VA_ARGS__))) \
+    SERIALIZE_MODEL_FUNCTION(name)                                                           \
     int FromAGENT_DATA_TYPE_##name(const AGENT_DATA_TYPE* source, void* destination)         \
     {                                                                                        \
         (void)source;                                                                        \
@@ -307,12 +313,73 @@ extern "C"
 /*Codes_SRS_SERIALIZER_99_114:[ If CodeFirst_SendAsync fails, SEND shall return IOT_AGENT_SERIALIZE_FAILED.] */
 #define SERIALIZE(destination, destinationSize,...) CodeFirst_SendAsync(destination, destinationSize, COUNT_ARG(__VA_ARGS__) FOR_EACH_1(ADDRESS_MACRO, __VA_ARGS__))
 
+/**
+ * @def      SERIALIZE_MODEL(modelName, destination, destinationSize, modelInstance)
+ * This macro produces the same JSON as SERIALIZE(destination, destinationSize, modelInstance)
+ * for a complete model instance, but writes every WITH_DATA property straight from the
+ * struct into a single output buffer instead of going through CodeFirst, the
+ * AGENT_DATA_TYPE conversions and the MultiTree. The property path is always included,
+ * as if the instance had been created with serializerIncludePropertyPath set to true.
+ *
+ * @param   modelName                    The model name used in DECLARE_MODEL.
+ * @param   destination                  Pointer to an @c unsigned @c char* that
+ *                                       will receive the serialized data.
+ * @param   destinationSize              Pointer to a @c size_t that gets
+ *                                       written with the size in bytes of the
+ *                                       serialized data
+ * @param   modelInstance                The model instance (not a pointer to it).
+ */
+/*Codes_SRS_SERIALIZER_H_09_002: [ SERIALIZE_MODEL shall call the SerializeModel_modelName function declared by DECLARE_MODEL, passing destination, destinationSize and the address of modelInstance. ]*/
+#define SERIALIZE_MODEL(modelName, destination, destinationSize, modelInstance) C2(SerializeModel_, modelName)(destination, destinationSize, &(modelInstance))
+
 #define SERIALIZE_REPORTED_PROPERTIES(destination, destinationSize,...) CodeFirst_SendAsyncReported(destination, destinationSize, COUNT_ARG(__VA_ARGS__) FOR_EACH_1(ADDRESS_MACRO, __VA_ARGS__))
 
 
 #define IDENTITY_MACRO(x) ,x
 #define SERIALIZE_REPORTED_PROPERTIES_FROM_POINTERS(destination, destinationSize, ...) CodeFirst_SendAsyncReported(destination, destinationSize, COUNT_ARG(__VA_ARGS__) FOR_EACH_1(IDENTITY_MACRO, __VA_ARGS__))
 
+/**
+ * @def   SERIALIZE_REPORTED_PROPERTIES_DIFF(destination, destinationSize, device, reportToken)
+ * Serializes only the reported properties of @p device whose value differs from the
+ * one in the newest report that included them and was not rejected with
+ * NACK_REPORTED_PROPERTIES. The first call for a device serializes all of them. When
+ * nothing changed, *destination is set to NULL, *destinationSize and *reportToken to 0
+ * and there is nothing to send.
+ *
+ * Otherwise *reportToken identifies the report until it is passed to
+ * ACKNOWLEDGE_REPORTED_PROPERTIES or NACK_REPORTED_PROPERTIES, which must happen for
+ * every report (typically from the reported state callback of
+ * IoTHubClient_SendReportedState). Several reports can be pending at the same time.
+ *
+ * @param   destination                  Pointer to an @c unsigned @c char* that
+ *                                       will receive the serialized data.
+ * @param   destinationSize              Pointer to a @c size_t that gets
+ *                                       written with the size in bytes of the
+ *                                       serialized data
+ * @param   device                       The model instance (not a pointer to it).
+ * @param   reportToken                  Pointer to a @c size_t that gets written
+ *                                       with the token of the report.
+ */
+/*Codes_SRS_SERIALIZER_H_09_008: [ SERIALIZE_REPORTED_PROPERTIES_DIFF shall call CodeFirst_SendAsyncReportedDiff, passing destination, destinationSize, the address of device and reportToken. ]*/
+#define SERIALIZE_REPORTED_PROPERTIES_DIFF(destination, destinationSize, device, reportToken) CodeFirst_SendAsyncReportedDiff(destination, destinationSize, &(device), reportToken)
+
+/**
+ * @def   ACKNOWLEDGE_REPORTED_PROPERTIES(device, reportToken)
+ * Records that the report produced by SERIALIZE_REPORTED_PROPERTIES_DIFF for
+ * @p device with @p reportToken was accepted by the service (status code 2xx).
+ */
+/*Codes_SRS_SERIALIZER_H_09_009: [ ACKNOWLEDGE_REPORTED_PROPERTIES shall call CodeFirst_AcknowledgeReportedProperties, passing the address of device and reportToken. ]*/
+#define ACKNOWLEDGE_REPORTED_PROPERTIES(device, reportToken) CodeFirst_AcknowledgeReportedProperties(&(device), reportToken)
+
+/**
+ * @def   NACK_REPORTED_PROPERTIES(device, reportToken)
+ * Records that the report produced by SERIALIZE_REPORTED_PROPERTIES_DIFF for
+ * @p device with @p reportToken was not accepted by the service, so the values it
+ * carried are sent again by the next SERIALIZE_REPORTED_PROPERTIES_DIFF.
+ */
+/*Codes_SRS_SERIALIZER_H_09_011: [ NACK_REPORTED_PROPERTIES shall call CodeFirst_NackReportedProperties, passing the address of device and reportToken. ]*/
+#define NACK_REPORTED_PROPERTIES(device, reportToken) CodeFirst_NackReportedProperties(&(device), reportToken)
+
 /**
  * @def   EXECUTE_COMMAND(device, command)
  * Any action that is declared in a model must also have an implementation as
@@ -325,6 +392,18 @@ extern "C"
 /*Codes_SRS_SERIALIZER_02_018: [EXECUTE_COMMAND macro shall call CodeFirst_ExecuteCommand passing device, commandBuffer and commandBufferSize.]*/
 #define EXECUTE_COMMAND(device, command) (CodeFirst_ExecuteCommand(device, command))
 
+/**
+ * @def   EXECUTE_COMMAND_CBOR(device, command, size)
+ * Same as EXECUTE_COMMAND, for commands sent as CBOR (content type
+ * "application/cbor") instead of JSON.
+ *
+ * @param   device      Pointer to device data.
+ * @param   command     The CBOR encoded command.
+ * @param   size        The size of the CBOR encoded command in bytes.
+ */
+/*Codes_SRS_SERIALIZER_H_09_010: [ EXECUTE_COMMAND_CBOR macro shall call CodeFirst_ExecuteCommandCBOR passing device, command and size. ]*/
+#define EXECUTE_COMMAND_CBOR(device, command, size) (CodeFirst_ExecuteCommandCBOR(device, command, size))
+
 /**
 * @def   EXECUTE_METHOD(device, methodName, methodPayload)
 * Any method that is declared in a model must also have an implementation as
@@ -435,6 +514,85 @@ Actions are discarded, since no marshalling will be done for those when sending
         return result; \
     }
 
+/* These macros expand the arguments of DECLARE_MODEL to the type, name pairs of the WITH_DATA elements only.
+This is what SERIALIZE sends for a complete model instance */
+#define TO_JSON_EXPAND_MODEL_PROPERTY(x, y) ,x,y
+
+#define TO_JSON_EXPAND_MODEL_REPORTED_PROPERTY(x, y)
+
+#define TO_JSON_EXPAND_MODEL_DESIRED_PROPERTY(x, y, ...)
+
+#define TO_JSON_EXPAND_MODEL_ACTION(...)
+
+#define TO_JSON_EXPAND_MODEL_METHOD(...)
+
+#define TO_JSON_EXPAND_ELEMENT_ARGS(N, ...) TO_JSON_EXPAND_##__VA_ARGS__
+
+#define EXPAND_MODEL_DATA_ARGS(...) \
+    FOR_EACH_1_COUNTED(TO_JSON_EXPAND_ELEMENT_ARGS, __VA_ARGS__)
+
+/*Codes_SRS_SERIALIZER_H_09_003: [ Each field shall be written as "name": followed by the value produced by ToJSON_type, which formats the value the same way AgentDataTypes_ToString does. ]*/
+#define TO_JSON_FIELD(type, name) \
+    if (result == JSON_WRITER_OK) \
+    { \
+        result = JSONWriter_AppendName(writer, TOSTRING(name)); \
+        if (result == JSON_WRITER_OK) \
+        { \
+            result = C2(ToJSON_, type)(writer, &(value->name)); \
+        } \
+    }
+
+#define TO_JSON(functionName, name, ...) \
+    static JSON_WRITER_RESULT functionName(JSON_WRITER_HANDLE writer, const name* value) \
+    { \
+        JSON_WRITER_RESULT result = JSONWriter_BeginObject(writer); \
+        DEFINITION_THAT_CAN_SUSTAIN_A_COMMA_STEAL(phantomName, 5); \
+        (void)value; \
+        FOR_EACH_2(TO_JSON_FIELD, EXPAND_TWICE(__VA_ARGS__)) \
+        if (result == JSON_WRITER_OK) \
+        { \
+            result = JSONWriter_EndObject(writer); \
+        } \
+        return result; \
+    }
+
+/*Codes_SRS_SERIALIZER_H_09_004: [ DECLARE_MODEL shall declare a function SerializeModel_name(unsigned char** destination, size_t* destinationSize, const name* value) that writes all the WITH_DATA properties of value as a JSON object. ]*/
+#define SERIALIZE_MODEL_FUNCTION(name) \
+    static CODEFIRST_RESULT C2(SerializeModel_, name)(unsigned char** destination, size_t* destinationSize, const name* value) \
+    { \
+        CODEFIRST_RESULT result; \
+        JSON_WRITER_HANDLE writer; \
+        if ((destination == NULL) || (destinationSize == NULL) || (value == NULL)) \
+        { \
+            /*Codes_SRS_SERIALIZER_H_09_005: [ If destination, destinationSize or value are NULL, SerializeModel_name shall return CODEFIRST_INVALID_ARG. ]*/ \
+            result = CODEFIRST_INVALID_ARG; \
+            LogError("invalid arg unsigned char** destination=%p, size_t* destinationSize=%p, const " TOSTRING(name) "* value=%p", destination, destinationSize, value); \
+        } \
+        else if ((writer = JSONWriter_Create(0)) == NULL) \
+        { \
+            /*Codes_SRS_SERIALIZER_H_09_006: [ If any failure occurs, SerializeModel_name shall return CODEFIRST_ERROR. ]*/ \
+            result = CODEFIRST_ERROR; \
+            LogError("failure in JSONWriter_Create"); \
+        } \
+        else \
+        { \
+            /*Codes_SRS_SERIALIZER_H_09_007: [ On success SerializeModel_name shall hand the written buffer to the caller in *destination and *destinationSize and return CODEFIRST_OK. ]*/ \
+            if ((C2(ToJSONData_, name)(writer, value) != JSON_WRITER_OK) || \
+                (JSONWriter_Release(writer, destination, destinationSize) != JSON_WRITER_OK)) \
+            { \
+                /*Codes_SRS_SERIALIZER_H_09_006: [ If any failure occurs, SerializeModel_name shall return CODEFIRST_ERROR. ]*/ \
+                result = CODEFIRST_ERROR; \
+                LogError("failure writing " TOSTRING(name) " as JSON"); \
+            } \
+            else \
+            { \
+                result = CODEFIRST_OK; \
+            } \
+            JSONWriter_Destroy(writer); \
+        } \
+        return result; \
+    }
+
 #define FIELD_AS_STRING(x,y) memberNames[iMember++] = #y; 
 
 #define REFLECTED_LIST_HEAD(name) \
@@ -1349,6 +1507,127 @@ static void C2(GlobalDeinitialize_, EDM_BINARY)(void* dest)
     }
 }
 
+/*the following functions write a value of a WITH_DATA type to a JSON_WRITER. They produce the same text as
+ToAGENT_DATA_TYPE_type followed by AgentDataTypes_ToString, without creating the AGENT_DATA_TYPE*/
+static JSON_WRITER_RESULT C2(ToJSON_, double)(JSON_WRITER_HANDLE writer, const double* value)
+{
+    return JSONWriter_AppendDouble(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, float)(JSON_WRITER_HANDLE writer, const float* value)
+{
+    return JSONWriter_AppendFloat(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, int)(JSON_WRITER_HANDLE writer, const int* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, long)(JSON_WRITER_HANDLE writer, const long* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, int8_t)(JSON_WRITER_HANDLE writer, const int8_t* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, uint8_t)(JSON_WRITER_HANDLE writer, const uint8_t* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, int16_t)(JSON_WRITER_HANDLE writer, const int16_t* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, int32_t)(JSON_WRITER_HANDLE writer, const int32_t* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, int64_t)(JSON_WRITER_HANDLE writer, const int64_t* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, bool)(JSON_WRITER_HANDLE writer, const bool* value)
+{
+    return JSONWriter_AppendBool(writer, *value == true);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, ascii_char_ptr)(JSON_WRITER_HANDLE writer, const ascii_char_ptr* value)
+{
+    return JSONWriter_AppendString(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, ascii_char_ptr_no_quotes)(JSON_WRITER_HANDLE writer, const ascii_char_ptr_no_quotes* value)
+{
+    JSON_WRITER_RESULT result;
+    if (*value == NULL)
+    {
+        result = JSON_WRITER_INVALID_ARG;
+    }
+    else
+    {
+        result = JSONWriter_AppendRaw(writer, *value, strlen(*value));
+    }
+    return result;
+}
+
+/*EDM_DATE_TIME_OFFSET, EDM_GUID and EDM_BINARY are not frequent enough in telemetry to justify a second formatter, they go through AgentDataTypes_ToString*/
+static JSON_WRITER_RESULT ToJSON_from_AGENT_DATA_TYPE(JSON_WRITER_HANDLE writer, AGENT_DATA_TYPES_RESULT createResult, AGENT_DATA_TYPE* agentData)
+{
+    JSON_WRITER_RESULT result;
+    if (createResult != AGENT_DATA_TYPES_OK)
+    {
+        result = JSON_WRITER_ERROR;
+    }
+    else
+    {
+        STRING_HANDLE temp = STRING_new();
+        if (temp == NULL)
+        {
+            result = JSON_WRITER_ERROR;
+        }
+        else
+        {
+            if (AgentDataTypes_ToString(temp, agentData) != AGENT_DATA_TYPES_OK)
+            {
+                result = JSON_WRITER_ERROR;
+            }
+            else
+            {
+                result = JSONWriter_AppendRaw(writer, STRING_c_str(temp), STRING_length(temp));
+            }
+            STRING_delete(temp);
+        }
+        Destroy_AGENT_DATA_TYPE(agentData);
+    }
+    return result;
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, EDM_DATE_TIME_OFFSET)(JSON_WRITER_HANDLE writer, const EDM_DATE_TIME_OFFSET* value)
+{
+    AGENT_DATA_TYPE agentData;
+    return ToJSON_from_AGENT_DATA_TYPE(writer, C2(ToAGENT_DATA_TYPE_, EDM_DATE_TIME_OFFSET)(&agentData, *value), &agentData);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, EDM_GUID)(JSON_WRITER_HANDLE writer, const EDM_GUID* value)
+{
+    AGENT_DATA_TYPE agentData;
+    return ToJSON_from_AGENT_DATA_TYPE(writer, C2(ToAGENT_DATA_TYPE_, EDM_GUID)(&agentData, *value), &agentData);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, EDM_BINARY)(JSON_WRITER_HANDLE writer, const EDM_BINARY* value)
+{
+    AGENT_DATA_TYPE agentData;
+    return ToJSON_from_AGENT_DATA_TYPE(writer, C2(ToAGENT_DATA_TYPE_, EDM_BINARY)(&agentData, *value), &agentData);
+}
+
 static void C2(destroyLocalParameter, EDM_BINARY)(EDM_BINARY* value)
 {
     if (value != NULL)
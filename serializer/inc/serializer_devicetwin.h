@@ -13,6 +13,7 @@
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/vector.h"
 #include "methodreturn.h"
+#include "datamarshaller.h"
 
 static void serializer_ingest(DEVICE_TWIN_UPDATE_STATE update_state, const unsigned char* payLoad, size_t size, void* userContextCallback)
 {
@@ -431,6 +432,45 @@ static IOTHUB_CLIENT_RESULT IoTHubDeviceTwin_SendReportedState_Impl(void* model,
     return result;
 }
 
+/*the below function sets the content type and content encoding of a message built from the output of SERIALIZE of model to the ones of the
+encoder model serializes with, that is the encoder selected with serializer_setconfig(SerializeEncoder, ...) when model was created,
+so that the service can tell JSON from CBOR payloads*/
+static IOTHUB_MESSAGE_RESULT serializer_setmessagecontenttype(void* model, IOTHUB_MESSAGE_HANDLE messageHandle)
+{
+    IOTHUB_MESSAGE_RESULT result;
+    const DATA_MARSHALLER_ENCODER* encoder;
+
+    /*Codes_SRS_SERIALIZERDEVICETWIN_09_001: [ If model or messageHandle is NULL then serializer_setmessagecontenttype shall fail and return IOTHUB_MESSAGE_INVALID_ARG. ]*/
+    if ((model == NULL) || (messageHandle == NULL))
+    {
+        LogError("invalid argument void* model=%p, IOTHUB_MESSAGE_HANDLE messageHandle=%p", model, messageHandle);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    /*Codes_SRS_SERIALIZERDEVICETWIN_09_005: [ If CodeFirst_GetEncoder returns NULL then serializer_setmessagecontenttype shall fail and return IOTHUB_MESSAGE_INVALID_ARG. ]*/
+    else if ((encoder = CodeFirst_GetEncoder(model)) == NULL)
+    {
+        LogError("model %p is not a model instance", model);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    /*Codes_SRS_SERIALIZERDEVICETWIN_09_002: [ serializer_setmessagecontenttype shall call IoTHubMessage_SetContentTypeSystemProperty with the contentType of the encoder returned by CodeFirst_GetEncoder for model, which is the encoder of the DataMarshaller instance of model. ]*/
+    else if ((result = IoTHubMessage_SetContentTypeSystemProperty(messageHandle, encoder->contentType)) != IOTHUB_MESSAGE_OK)
+    {
+        LogError("failure in IoTHubMessage_SetContentTypeSystemProperty");
+    }
+    /*Codes_SRS_SERIALIZERDEVICETWIN_09_003: [ If the contentEncoding of the encoder is not NULL then serializer_setmessagecontenttype shall call IoTHubMessage_SetContentEncodingSystemProperty with it. ]*/
+    else if ((encoder->contentEncoding != NULL) &&
+        ((result = IoTHubMessage_SetContentEncodingSystemProperty(messageHandle, encoder->contentEncoding)) != IOTHUB_MESSAGE_OK))
+    {
+        LogError("failure in IoTHubMessage_SetContentEncodingSystemProperty");
+    }
+    else
+    {
+        /*Codes_SRS_SERIALIZERDEVICETWIN_09_004: [ If any of the above calls fails then serializer_setmessagecontenttype shall return the error of the call, otherwise it shall return IOTHUB_MESSAGE_OK. ]*/
+        result = IOTHUB_MESSAGE_OK;
+    }
+    return result;
+}
+
 #define DECLARE_DEVICETWIN_MODEL(name, ...)    \
     DECLARE_MODEL(name, __VA_ARGS__)           \
     static name* C2(IoTHubDeviceTwin_Create, name)(IOTHUB_CLIENT_HANDLE iotHubClientHandle)                                                                                         \
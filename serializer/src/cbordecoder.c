@@ -0,0 +1,575 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "cbordecoder.h"
+#include "agenttypesystem.h"
+#include "floatformat.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+DEFINE_ENUM_STRINGS(CBOR_DECODER_RESULT, CBOR_DECODER_RESULT_VALUES);
+
+/*maps, arrays and tags nested deeper than this are rejected, so that a command cannot exhaust the stack*/
+#define CBOR_DECODER_MAX_DEPTH 32
+
+#define CBOR_MAJOR_TYPE_UNSIGNED_INTEGER    0
+#define CBOR_MAJOR_TYPE_NEGATIVE_INTEGER    1
+#define CBOR_MAJOR_TYPE_BYTE_STRING         2
+#define CBOR_MAJOR_TYPE_TEXT_STRING         3
+#define CBOR_MAJOR_TYPE_ARRAY               4
+#define CBOR_MAJOR_TYPE_MAP                 5
+#define CBOR_MAJOR_TYPE_TAG                 6
+#define CBOR_MAJOR_TYPE_SIMPLE              7
+
+#define CBOR_SIMPLE_FALSE                   20
+#define CBOR_SIMPLE_TRUE                    21
+#define CBOR_SIMPLE_NULL                    22
+#define CBOR_HALF_FLOAT                     25
+#define CBOR_SINGLE_FLOAT                   26
+#define CBOR_DOUBLE_FLOAT                   27
+
+#define CBOR_TAG_UUID                       37
+
+/*the longest uint64_t is "18446744073709551615"*/
+#define MAX_UINT64_STRING_LENGTH 20
+
+typedef struct CBOR_DECODER_STATE_TAG
+{
+    const unsigned char* position;
+    const unsigned char* end;
+    STRING_HANDLE valueText; /*created on first use, for the values that are formatted by AgentDataTypes_ToString*/
+} CBOR_DECODER_STATE;
+
+typedef struct CBOR_HEAD_TAG
+{
+    unsigned char majorType;
+    unsigned char additionalInformation;
+    uint64_t argument;
+} CBOR_HEAD;
+
+static CBOR_DECODER_RESULT decodeItem(CBOR_DECODER_STATE* state, MULTITREE_HANDLE node, size_t depth);
+
+/*the texts are allocated by the decoder and handed over to the tree*/
+static int NoCloneFunction(void** destination, const void* source)
+{
+    *destination = (void*)source;
+    return 0;
+}
+
+static void FreeFunction(void* value)
+{
+    free(value);
+}
+
+static CBOR_DECODER_RESULT readHead(CBOR_DECODER_STATE* state, CBOR_HEAD* head)
+{
+    CBOR_DECODER_RESULT result;
+
+    if (state->position >= state->end)
+    {
+        result = CBOR_DECODER_PARSE_ERROR;
+        LogError("unexpected end of CBOR data");
+    }
+    else
+    {
+        size_t argumentSize;
+
+        head->majorType = (unsigned char)(*state->position >> 5);
+        head->additionalInformation = (unsigned char)(*state->position & 0x1F);
+        state->position++;
+
+        switch (head->additionalInformation)
+        {
+            case 24: argumentSize = 1; break;
+            case 25: argumentSize = 2; break;
+            case 26: argumentSize = 4; break;
+            case 27: argumentSize = 8; break;
+            default: argumentSize = 0; break;
+        }
+
+        /*Codes_SRS_CBOR_DECODER_09_006: [ Indefinite length items and the reserved additional information values 28 to 30 are not supported; CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_PARSE_ERROR for them. ]*/
+        if (head->additionalInformation > 27)
+        {
+            result = CBOR_DECODER_PARSE_ERROR;
+            LogError("unsupported CBOR additional information %u", (unsigned int)head->additionalInformation);
+        }
+        else if ((size_t)(state->end - state->position) < argumentSize)
+        {
+            result = CBOR_DECODER_PARSE_ERROR;
+            LogError("unexpected end of CBOR data");
+        }
+        else
+        {
+            size_t i;
+            head->argument = (argumentSize == 0) ? head->additionalInformation : 0;
+            for (i = 0; i < argumentSize; i++)
+            {
+                head->argument = (head->argument << 8) | *state->position++;
+            }
+            result = CBOR_DECODER_OK;
+        }
+    }
+
+    return result;
+}
+
+/*writes value in decimal at the end of a buffer of MAX_UINT64_STRING_LENGTH + 1 chars and returns where the text starts*/
+static char* uint64ToString(uint64_t value, char* buffer)
+{
+    char* result = buffer + MAX_UINT64_STRING_LENGTH;
+    *result = '\0';
+    do
+    {
+        *--result = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+    return result;
+}
+
+/*checks that the string of length bytes that follows is all there and contains no '\0'*/
+static CBOR_DECODER_RESULT checkString(CBOR_DECODER_STATE* state, uint64_t length, int mayContainZero)
+{
+    CBOR_DECODER_RESULT result;
+    if ((uint64_t)(state->end - state->position) < length)
+    {
+        result = CBOR_DECODER_PARSE_ERROR;
+        LogError("unexpected end of CBOR data");
+    }
+    else if ((!mayContainZero) && (memchr(state->position, '\0', (size_t)length) != NULL))
+    {
+        result = CBOR_DECODER_PARSE_ERROR;
+        LogError("CBOR text strings cannot contain '\\0'");
+    }
+    else
+    {
+        result = CBOR_DECODER_OK;
+    }
+    return result;
+}
+
+/*hands text over to node; text is freed when that fails*/
+static CBOR_DECODER_RESULT setNodeText(MULTITREE_HANDLE node, char* text)
+{
+    CBOR_DECODER_RESULT result;
+    if (text == NULL)
+    {
+        result = CBOR_DECODER_ERROR;
+        LogError("unable to allocate the text of a value");
+    }
+    else if (MultiTree_SetValue(node, text) != MULTITREE_OK)
+    {
+        /*Codes_SRS_CBOR_DECODER_09_016: [ If any MultiTree API fails, CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_MULTITREE_FAILED. ]*/
+        result = CBOR_DECODER_MULTITREE_FAILED;
+        LogError("(result = %s)", ENUM_TO_STRING(CBOR_DECODER_RESULT, result));
+        free(text);
+    }
+    else
+    {
+        result = CBOR_DECODER_OK;
+    }
+    return result;
+}
+
+static CBOR_DECODER_RESULT setNodeCopy(MULTITREE_HANDLE node, const char* text)
+{
+    char* copy;
+    if (mallocAndStrcpy_s(&copy, text) != 0)
+    {
+        copy = NULL;
+    }
+    return setNodeText(node, copy);
+}
+
+/*formats the value with AgentDataTypes_ToString, which is the text CreateAgentDataType_From_String reads back*/
+static CBOR_DECODER_RESULT setNodeAgentDataType(CBOR_DECODER_STATE* state, MULTITREE_HANDLE node, const AGENT_DATA_TYPE* value)
+{
+    CBOR_DECODER_RESULT result;
+    if ((state->valueText == NULL) && ((state->valueText = STRING_new()) == NULL))
+    {
+        result = CBOR_DECODER_ERROR;
+        LogError("failure in STRING_new");
+    }
+    else if ((STRING_empty(state->valueText) != 0) ||
+        (AgentDataTypes_ToString(state->valueText, value) != AGENT_DATA_TYPES_OK))
+    {
+        result = CBOR_DECODER_ERROR;
+        LogError("failure formatting a value with AgentDataTypes_ToString");
+    }
+    else
+    {
+        result = setNodeCopy(node, STRING_c_str(state->valueText));
+    }
+    return result;
+}
+
+#ifndef NO_FLOATS
+static double halfToDouble(uint16_t half)
+{
+    double result;
+    int exponent = (half >> 10) & 0x1F;
+    int mantissa = half & 0x3FF;
+
+    if (exponent == 0)
+    {
+        result = ldexp(mantissa, -24);
+    }
+    else if (exponent != 31)
+    {
+        result = ldexp(mantissa + 1024, exponent - 25);
+    }
+    else
+    {
+        result = (mantissa == 0) ? INFINITY : NAN;
+    }
+    return (half & 0x8000) ? -result : result;
+}
+
+static CBOR_DECODER_RESULT setNodeDouble(MULTITREE_HANDLE node, double value)
+{
+    CBOR_DECODER_RESULT result;
+
+    /*Codes_SRS_CBOR_DECODER_09_020: [ NaN, INF and -INF shall be decoded as "NaN", "INF" and "-INF" between quotes, like CreateAgentDataType_From_String expects them. ]*/
+    if (isnan(value))
+    {
+        result = setNodeCopy(node, "\"NaN\"");
+    }
+    else if (isinf(value))
+    {
+        result = setNodeCopy(node, (value > 0) ? "\"INF\"" : "\"-INF\"");
+    }
+    else
+    {
+        char text[FLOAT_FORMAT_BUFFER_SIZE];
+        if (FloatFormat_Double(value, text, sizeof(text)) == 0)
+        {
+            result = CBOR_DECODER_ERROR;
+            LogError("failure in FloatFormat_Double");
+        }
+        else
+        {
+            result = setNodeCopy(node, text);
+        }
+    }
+    return result;
+}
+#endif
+
+static CBOR_DECODER_RESULT decodeMap(CBOR_DECODER_STATE* state, MULTITREE_HANDLE node, uint64_t count, size_t depth)
+{
+    CBOR_DECODER_RESULT result = CBOR_DECODER_OK;
+    uint64_t i;
+
+    for (i = 0; (i < count) && (result == CBOR_DECODER_OK); i++)
+    {
+        CBOR_HEAD keyHead;
+        if ((result = readHead(state, &keyHead)) != CBOR_DECODER_OK)
+        {
+            /*result is already set*/
+        }
+        else if (keyHead.majorType != CBOR_MAJOR_TYPE_TEXT_STRING)
+        {
+            /*Codes_SRS_CBOR_DECODER_09_004: [ The keys of maps shall be text strings; any other key shall make CBORDecoder_CBOR_To_MultiTree return CBOR_DECODER_PARSE_ERROR. ]*/
+            result = CBOR_DECODER_PARSE_ERROR;
+            LogError("CBOR map keys must be text strings");
+        }
+        else if ((result = checkString(state, keyHead.argument, 0)) != CBOR_DECODER_OK)
+        {
+            /*result is already set*/
+        }
+        else
+        {
+            char* name = (char*)malloc((size_t)keyHead.argument + 1);
+            if (name == NULL)
+            {
+                result = CBOR_DECODER_ERROR;
+                LogError("unable to allocate a map key of %lu bytes", (unsigned long)keyHead.argument);
+            }
+            else
+            {
+                MULTITREE_HANDLE childNode;
+                (void)memcpy(name, state->position, (size_t)keyHead.argument);
+                name[keyHead.argument] = '\0';
+                state->position += keyHead.argument;
+
+                /*Codes_SRS_CBOR_DECODER_09_003: [ Every entry of a map shall be added as a child of the node, named after the key. ]*/
+                if (MultiTree_AddChild(node, name, &childNode) != MULTITREE_OK)
+                {
+                    /*Codes_SRS_CBOR_DECODER_09_016: [ If any MultiTree API fails, CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_MULTITREE_FAILED. ]*/
+                    result = CBOR_DECODER_MULTITREE_FAILED;
+                    LogError("(result = %s)", ENUM_TO_STRING(CBOR_DECODER_RESULT, result));
+                }
+                else
+                {
+                    result = decodeItem(state, childNode, depth + 1);
+                }
+                free(name);
+            }
+        }
+    }
+
+    return result;
+}
+
+static CBOR_DECODER_RESULT decodeArray(CBOR_DECODER_STATE* state, MULTITREE_HANDLE node, uint64_t count, size_t depth)
+{
+    CBOR_DECODER_RESULT result = CBOR_DECODER_OK;
+    uint64_t i;
+
+    for (i = 0; (i < count) && (result == CBOR_DECODER_OK); i++)
+    {
+        char indexBuffer[MAX_UINT64_STRING_LENGTH + 1];
+        MULTITREE_HANDLE childNode;
+
+        /*Codes_SRS_CBOR_DECODER_09_005: [ Every element of an array shall be added as a child of the node, named after its index, like JSONDecoder_JSON_To_MultiTree does. ]*/
+        if (MultiTree_AddChild(node, uint64ToString(i, indexBuffer), &childNode) != MULTITREE_OK)
+        {
+            /*Codes_SRS_CBOR_DECODER_09_016: [ If any MultiTree API fails, CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_MULTITREE_FAILED. ]*/
+            result = CBOR_DECODER_MULTITREE_FAILED;
+            LogError("(result = %s)", ENUM_TO_STRING(CBOR_DECODER_RESULT, result));
+        }
+        else
+        {
+            result = decodeItem(state, childNode, depth + 1);
+        }
+    }
+
+    return result;
+}
+
+static CBOR_DECODER_RESULT decodeItem(CBOR_DECODER_STATE* state, MULTITREE_HANDLE node, size_t depth)
+{
+    CBOR_DECODER_RESULT result;
+    CBOR_HEAD head;
+
+    if (depth > CBOR_DECODER_MAX_DEPTH)
+    {
+        /*Codes_SRS_CBOR_DECODER_09_007: [ If maps, arrays and tags are nested more than CBOR_DECODER_MAX_DEPTH levels deep, CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_PARSE_ERROR. ]*/
+        result = CBOR_DECODER_PARSE_ERROR;
+        LogError("CBOR data is nested too deep");
+    }
+    else if ((result = readHead(state, &head)) != CBOR_DECODER_OK)
+    {
+        /*result is already set*/
+    }
+    else
+    {
+        switch (head.majorType)
+        {
+            /*Codes_SRS_CBOR_DECODER_09_008: [ Unsigned and negative integers shall be decoded as their decimal text. ]*/
+            case CBOR_MAJOR_TYPE_UNSIGNED_INTEGER:
+            {
+                char buffer[MAX_UINT64_STRING_LENGTH + 1];
+                result = setNodeCopy(node, uint64ToString(head.argument, buffer));
+                break;
+            }
+            case CBOR_MAJOR_TYPE_NEGATIVE_INTEGER:
+            {
+                if (head.argument == UINT64_MAX)
+                {
+                    /*-1 - UINT64_MAX does not fit any integer type of the serializer*/
+                    result = CBOR_DECODER_PARSE_ERROR;
+                    LogError("CBOR negative integer out of range");
+                }
+                else
+                {
+                    char buffer[MAX_UINT64_STRING_LENGTH + 2];
+                    char* text = uint64ToString(head.argument + 1, buffer + 1);
+                    *--text = '-';
+                    result = setNodeCopy(node, text);
+                }
+                break;
+            }
+            /*Codes_SRS_CBOR_DECODER_09_009: [ Byte strings shall be decoded as the base64 text, between quotes, that AgentDataTypes_ToString produces for EDM_BINARY. ]*/
+            case CBOR_MAJOR_TYPE_BYTE_STRING:
+            {
+                if ((result = checkString(state, head.argument, 1)) == CBOR_DECODER_OK)
+                {
+                    AGENT_DATA_TYPE binary;
+                    binary.type = EDM_BINARY_TYPE;
+                    binary.value.edmBinary.data = (unsigned char*)state->position;
+                    binary.value.edmBinary.size = (size_t)head.argument;
+                    state->position += head.argument;
+                    result = setNodeAgentDataType(state, node, &binary);
+                }
+                break;
+            }
+            /*Codes_SRS_CBOR_DECODER_09_010: [ Text strings shall be decoded as their characters between quotes, without any escaping, so that the value reaches the action unchanged. ]*/
+            case CBOR_MAJOR_TYPE_TEXT_STRING:
+            {
+                if ((result = checkString(state, head.argument, 0)) == CBOR_DECODER_OK)
+                {
+                    char* text = (char*)malloc((size_t)head.argument + 3);
+                    if (text != NULL)
+                    {
+                        text[0] = '"';
+                        (void)memcpy(text + 1, state->position, (size_t)head.argument);
+                        text[head.argument + 1] = '"';
+                        text[head.argument + 2] = '\0';
+                    }
+                    state->position += head.argument;
+                    result = setNodeText(node, text);
+                }
+                break;
+            }
+            case CBOR_MAJOR_TYPE_ARRAY:
+                result = decodeArray(state, node, head.argument, depth);
+                break;
+            case CBOR_MAJOR_TYPE_MAP:
+                result = decodeMap(state, node, head.argument, depth);
+                break;
+            case CBOR_MAJOR_TYPE_TAG:
+            {
+                CBOR_HEAD guidHead;
+                const unsigned char* tagged = state->position;
+
+                /*Codes_SRS_CBOR_DECODER_09_012: [ Tag 37 followed by a byte string of 16 bytes shall be decoded as the GUID text, between quotes, that AgentDataTypes_ToString produces for EDM_GUID. ]*/
+                if ((head.argument == CBOR_TAG_UUID) &&
+                    (readHead(state, &guidHead) == CBOR_DECODER_OK) &&
+                    (guidHead.majorType == CBOR_MAJOR_TYPE_BYTE_STRING) &&
+                    (guidHead.argument == 16) &&
+                    (checkString(state, guidHead.argument, 1) == CBOR_DECODER_OK))
+                {
+                    AGENT_DATA_TYPE guid;
+                    guid.type = EDM_GUID_TYPE;
+                    (void)memcpy(guid.value.edmGuid.GUID, state->position, 16);
+                    state->position += 16;
+                    result = setNodeAgentDataType(state, node, &guid);
+                }
+                else
+                {
+                    /*Codes_SRS_CBOR_DECODER_09_013: [ Any other tag shall be ignored and the tagged item decoded as if it was not tagged. ]*/
+                    state->position = tagged;
+                    result = decodeItem(state, node, depth + 1);
+                }
+                break;
+            }
+            case CBOR_MAJOR_TYPE_SIMPLE:
+            {
+                switch (head.additionalInformation)
+                {
+                    /*Codes_SRS_CBOR_DECODER_09_014: [ false, true and null shall be decoded as false, true and null. ]*/
+                    case CBOR_SIMPLE_FALSE:
+                        result = setNodeCopy(node, "false");
+                        break;
+                    case CBOR_SIMPLE_TRUE:
+                        result = setNodeCopy(node, "true");
+                        break;
+                    case CBOR_SIMPLE_NULL:
+                        result = setNodeCopy(node, "null");
+                        break;
+#ifndef NO_FLOATS
+                    /*Codes_SRS_CBOR_DECODER_09_011: [ Half, single and double precision floats shall be decoded as the text FloatFormat_Double produces for their value. ]*/
+                    case CBOR_HALF_FLOAT:
+                        result = setNodeDouble(node, halfToDouble((uint16_t)head.argument));
+                        break;
+                    case CBOR_SINGLE_FLOAT:
+                    {
+                        uint32_t bits = (uint32_t)head.argument;
+                        float single;
+                        (void)memcpy(&single, &bits, sizeof(single));
+                        result = setNodeDouble(node, single);
+                        break;
+                    }
+                    case CBOR_DOUBLE_FLOAT:
+                    {
+                        double value;
+                        (void)memcpy(&value, &head.argument, sizeof(value));
+                        result = setNodeDouble(node, value);
+                        break;
+                    }
+#endif
+                    default:
+                        /*Codes_SRS_CBOR_DECODER_09_015: [ Any other simple value shall make CBORDecoder_CBOR_To_MultiTree return CBOR_DECODER_PARSE_ERROR. ]*/
+                        result = CBOR_DECODER_PARSE_ERROR;
+                        LogError("unsupported CBOR simple value %u", (unsigned int)head.additionalInformation);
+                        break;
+                }
+                break;
+            }
+            default:
+                /*all 8 major types are handled above*/
+                result = CBOR_DECODER_PARSE_ERROR;
+                break;
+        }
+    }
+
+    return result;
+}
+
+CBOR_DECODER_RESULT CBORDecoder_CBOR_To_MultiTree(const unsigned char* cbor, size_t size, MULTITREE_HANDLE* multiTreeHandle)
+{
+    CBOR_DECODER_RESULT result;
+
+    /*Codes_SRS_CBOR_DECODER_09_001: [ If cbor or multiTreeHandle are NULL, or size is 0, CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_INVALID_ARG. ]*/
+    if ((cbor == NULL) ||
+        (size == 0) ||
+        (multiTreeHandle == NULL))
+    {
+        result = CBOR_DECODER_INVALID_ARG;
+        LogError("invalid arg const unsigned char* cbor=%p, size_t size=%lu, MULTITREE_HANDLE* multiTreeHandle=%p", cbor, (unsigned long)size, multiTreeHandle);
+    }
+    else
+    {
+        CBOR_DECODER_STATE state;
+        CBOR_HEAD head;
+
+        state.position = cbor;
+        state.end = cbor + size;
+        state.valueText = NULL;
+
+        if ((result = readHead(&state, &head)) != CBOR_DECODER_OK)
+        {
+            /*result is already set*/
+        }
+        /*Codes_SRS_CBOR_DECODER_09_002: [ The outermost item shall be a map or an array; anything else shall make CBORDecoder_CBOR_To_MultiTree return CBOR_DECODER_PARSE_ERROR. ]*/
+        else if ((head.majorType != CBOR_MAJOR_TYPE_MAP) && (head.majorType != CBOR_MAJOR_TYPE_ARRAY))
+        {
+            result = CBOR_DECODER_PARSE_ERROR;
+            LogError("CBOR data shall be a map or an array");
+        }
+        else if ((*multiTreeHandle = MultiTree_Create(NoCloneFunction, FreeFunction)) == NULL)
+        {
+            /*Codes_SRS_CBOR_DECODER_09_016: [ If any MultiTree API fails, CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_MULTITREE_FAILED. ]*/
+            result = CBOR_DECODER_MULTITREE_FAILED;
+            LogError("(result = %s)", ENUM_TO_STRING(CBOR_DECODER_RESULT, result));
+        }
+        else
+        {
+            result = (head.majorType == CBOR_MAJOR_TYPE_MAP) ?
+                decodeMap(&state, *multiTreeHandle, head.argument, 1) :
+                decodeArray(&state, *multiTreeHandle, head.argument, 1);
+
+            if ((result == CBOR_DECODER_OK) && (state.position != state.end))
+            {
+                /*Codes_SRS_CBOR_DECODER_09_017: [ If there are bytes after the outermost item, CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_PARSE_ERROR. ]*/
+                result = CBOR_DECODER_PARSE_ERROR;
+                LogError("unexpected bytes after the CBOR data");
+            }
+
+            if (result != CBOR_DECODER_OK)
+            {
+                /*Codes_SRS_CBOR_DECODER_09_018: [ On failure the MultiTree shall be destroyed. ]*/
+                MultiTree_Destroy(*multiTreeHandle);
+            }
+            else
+            {
+                /*Codes_SRS_CBOR_DECODER_09_019: [ On success CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_OK and the MultiTree in *multiTreeHandle; the values of the tree are freed by MultiTree_Destroy. ]*/
+            }
+        }
+
+        if (state.valueText != NULL)
+        {
+            STRING_delete(state.valueText);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,491 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+#include "cborencoder.h"
+#include "agenttypesystem.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+DEFINE_ENUM_STRINGS(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+
+#define CBOR_ENCODER_DEFAULT_CAPACITY 256
+
+/*the major type is stored in the 3 most significant bits of the initial byte of every data item*/
+#define CBOR_MAJOR_TYPE_UNSIGNED_INTEGER    0x00
+#define CBOR_MAJOR_TYPE_NEGATIVE_INTEGER    0x20
+#define CBOR_MAJOR_TYPE_BYTE_STRING         0x40
+#define CBOR_MAJOR_TYPE_TEXT_STRING         0x60
+#define CBOR_MAJOR_TYPE_MAP                 0xA0
+#define CBOR_MAJOR_TYPE_TAG                 0xC0
+
+#define CBOR_FALSE                          0xF4
+#define CBOR_TRUE                           0xF5
+#define CBOR_NULL                           0xF6
+#define CBOR_HALF_FLOAT                     0xF9
+#define CBOR_SINGLE_FLOAT                   0xFA
+#define CBOR_DOUBLE_FLOAT                   0xFB
+
+#define CBOR_TAG_DATE_TIME_STRING           0
+#define CBOR_TAG_UUID                       37
+
+/*initial byte and at most 8 bytes of argument*/
+#define CBOR_MAX_HEAD_SIZE 9
+
+typedef struct CBOR_BUFFER_TAG
+{
+    unsigned char* bytes;
+    size_t size;
+    size_t capacity;
+} CBOR_BUFFER;
+
+static int ensureCapacity(CBOR_BUFFER* buffer, size_t extra)
+{
+    int result;
+    if (buffer->size + extra <= buffer->capacity)
+    {
+        result = 0;
+    }
+    else
+    {
+        /*Codes_SRS_CBOR_ENCODER_09_004: [ When the buffer is too small, it shall grow to at least twice its current capacity. ]*/
+        size_t newCapacity = (buffer->capacity == 0) ? CBOR_ENCODER_DEFAULT_CAPACITY : buffer->capacity * 2;
+        unsigned char* newBytes;
+        if (newCapacity < buffer->size + extra)
+        {
+            newCapacity = buffer->size + extra;
+        }
+
+        if ((newBytes = (unsigned char*)realloc(buffer->bytes, newCapacity)) == NULL)
+        {
+            LogError("unable to realloc CBOR buffer to %lu bytes", (unsigned long)newCapacity);
+            result = __FAILURE__;
+        }
+        else
+        {
+            buffer->bytes = newBytes;
+            buffer->capacity = newCapacity;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+static int appendBytes(CBOR_BUFFER* buffer, const unsigned char* bytes, size_t length)
+{
+    int result;
+    if (ensureCapacity(buffer, length) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        if (length > 0)
+        {
+            (void)memcpy(buffer->bytes + buffer->size, bytes, length);
+            buffer->size += length;
+        }
+        result = 0;
+    }
+    return result;
+}
+
+/*writes the initial byte of a data item of majorType followed by argument in the shortest form, big endian*/
+static int appendHead(CBOR_BUFFER* buffer, unsigned char majorType, uint64_t argument)
+{
+    unsigned char head[CBOR_MAX_HEAD_SIZE];
+    size_t argumentSize;
+    size_t i;
+
+    if (argument < 24)
+    {
+        head[0] = (unsigned char)(majorType | (unsigned char)argument);
+        argumentSize = 0;
+    }
+    else if (argument <= UINT8_MAX)
+    {
+        head[0] = (unsigned char)(majorType | 24);
+        argumentSize = 1;
+    }
+    else if (argument <= UINT16_MAX)
+    {
+        head[0] = (unsigned char)(majorType | 25);
+        argumentSize = 2;
+    }
+    else if (argument <= UINT32_MAX)
+    {
+        head[0] = (unsigned char)(majorType | 26);
+        argumentSize = 4;
+    }
+    else
+    {
+        head[0] = (unsigned char)(majorType | 27);
+        argumentSize = 8;
+    }
+
+    for (i = 0; i < argumentSize; i++)
+    {
+        head[argumentSize - i] = (unsigned char)(argument >> (8 * i));
+    }
+
+    return appendBytes(buffer, head, argumentSize + 1);
+}
+
+static int appendSignedInteger(CBOR_BUFFER* buffer, int64_t value)
+{
+    /*a negative integer n is written as -1 - n, which never overflows*/
+    return (value >= 0) ?
+        appendHead(buffer, CBOR_MAJOR_TYPE_UNSIGNED_INTEGER, (uint64_t)value) :
+        appendHead(buffer, CBOR_MAJOR_TYPE_NEGATIVE_INTEGER, (uint64_t)(-1 - value));
+}
+
+static int appendTextString(CBOR_BUFFER* buffer, const char* chars, size_t length)
+{
+    int result;
+    if (appendHead(buffer, CBOR_MAJOR_TYPE_TEXT_STRING, length) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = appendBytes(buffer, (const unsigned char*)chars, length);
+    }
+    return result;
+}
+
+#ifndef NO_FLOATS
+/*NaN and the infinities are written as half floats, everything else as a single float when that keeps the exact value*/
+static int appendDouble(CBOR_BUFFER* buffer, double value)
+{
+    int result;
+    unsigned char encoded[9];
+    size_t encodedSize;
+
+    if (isnan(value))
+    {
+        encoded[0] = CBOR_HALF_FLOAT;
+        encoded[1] = 0x7E;
+        encoded[2] = 0x00;
+        encodedSize = 3;
+    }
+    else if (isinf(value))
+    {
+        encoded[0] = CBOR_HALF_FLOAT;
+        encoded[1] = (value > 0) ? 0x7C : 0xFC;
+        encoded[2] = 0x00;
+        encodedSize = 3;
+    }
+    else if ((value >= -FLT_MAX) && (value <= FLT_MAX) && ((double)(float)value == value))
+    {
+        float single = (float)value;
+        uint32_t bits;
+        size_t i;
+        (void)memcpy(&bits, &single, sizeof(bits));
+        encoded[0] = CBOR_SINGLE_FLOAT;
+        for (i = 0; i < 4; i++)
+        {
+            encoded[4 - i] = (unsigned char)(bits >> (8 * i));
+        }
+        encodedSize = 5;
+    }
+    else
+    {
+        uint64_t bits;
+        size_t i;
+        (void)memcpy(&bits, &value, sizeof(bits));
+        encoded[0] = CBOR_DOUBLE_FLOAT;
+        for (i = 0; i < 8; i++)
+        {
+            encoded[8 - i] = (unsigned char)(bits >> (8 * i));
+        }
+        encodedSize = 9;
+    }
+
+    if (appendBytes(buffer, encoded, encodedSize) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+#endif
+
+/*writes the text produced by AgentDataTypes_ToString as a text string, without the quotes that surround it in JSON*/
+static CBOR_ENCODER_RESULT appendAgentDataTypeText(CBOR_BUFFER* buffer, const AGENT_DATA_TYPE* value, STRING_HANDLE valueText)
+{
+    CBOR_ENCODER_RESULT result;
+
+    if ((STRING_empty(valueText) != 0) ||
+        (AgentDataTypes_ToString(valueText, value) != AGENT_DATA_TYPES_OK))
+    {
+        result = CBOR_ENCODER_AGENT_DATA_TYPES_ERROR;
+        LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+    }
+    else
+    {
+        const char* text = STRING_c_str(valueText);
+        size_t length = STRING_length(valueText);
+
+        if ((length >= 2) && (text[0] == '"') && (text[length - 1] == '"'))
+        {
+            text++;
+            length -= 2;
+        }
+
+        if (appendTextString(buffer, text, length) != 0)
+        {
+            result = CBOR_ENCODER_ERROR;
+            LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+        }
+        else
+        {
+            result = CBOR_ENCODER_OK;
+        }
+    }
+
+    return result;
+}
+
+static CBOR_ENCODER_RESULT encodeValue(CBOR_BUFFER* buffer, const AGENT_DATA_TYPE* value, STRING_HANDLE valueText)
+{
+    CBOR_ENCODER_RESULT result;
+    int appendResult;
+
+    if (value == NULL)
+    {
+        result = CBOR_ENCODER_AGENT_DATA_TYPES_ERROR;
+        LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+    }
+    else
+    {
+        result = CBOR_ENCODER_OK;
+        switch (value->type)
+        {
+            case EDM_NULL_TYPE:
+            {
+                /*Codes_SRS_CBOR_ENCODER_09_008: [ EDM_NULL shall be written as null and EDM_BOOLEAN as false or true. ]*/
+                unsigned char simpleValue = CBOR_NULL;
+                appendResult = appendBytes(buffer, &simpleValue, 1);
+                break;
+            }
+            case EDM_BOOLEAN_TYPE:
+            {
+                unsigned char simpleValue = (value->value.edmBoolean.value == EDM_TRUE) ? CBOR_TRUE : CBOR_FALSE;
+                appendResult = appendBytes(buffer, &simpleValue, 1);
+                break;
+            }
+            /*Codes_SRS_CBOR_ENCODER_09_009: [ EDM_BYTE, EDM_SBYTE, EDM_INT16, EDM_INT32 and EDM_INT64 shall be written as unsigned or negative integers in their shortest form. ]*/
+            case EDM_BYTE_TYPE:
+                appendResult = appendHead(buffer, CBOR_MAJOR_TYPE_UNSIGNED_INTEGER, value->value.edmByte.value);
+                break;
+            case EDM_SBYTE_TYPE:
+                appendResult = appendSignedInteger(buffer, value->value.edmSbyte.value);
+                break;
+            case EDM_INT16_TYPE:
+                appendResult = appendSignedInteger(buffer, value->value.edmInt16.value);
+                break;
+            case EDM_INT32_TYPE:
+                appendResult = appendSignedInteger(buffer, value->value.edmInt32.value);
+                break;
+            case EDM_INT64_TYPE:
+                appendResult = appendSignedInteger(buffer, value->value.edmInt64.value);
+                break;
+#ifndef NO_FLOATS
+            /*Codes_SRS_CBOR_ENCODER_09_010: [ EDM_DOUBLE and EDM_SINGLE shall be written as a single precision float when that keeps the exact value and as a double precision float otherwise; NaN, INF and -INF shall be written as half precision floats. ]*/
+            case EDM_DOUBLE_TYPE:
+                appendResult = appendDouble(buffer, value->value.edmDouble.value);
+                break;
+            case EDM_SINGLE_TYPE:
+                appendResult = appendDouble(buffer, value->value.edmSingle.value);
+                break;
+#endif
+            /*Codes_SRS_CBOR_ENCODER_09_011: [ EDM_STRING and EDM_STRING_NO_QUOTES shall be written as text strings, without quotes or escapes. ]*/
+            case EDM_STRING_TYPE:
+                appendResult = appendTextString(buffer, value->value.edmString.chars, value->value.edmString.length);
+                break;
+            case EDM_STRING_NO_QUOTES_TYPE:
+                appendResult = appendTextString(buffer, value->value.edmStringNoQuotes.chars, value->value.edmStringNoQuotes.length);
+                break;
+            /*Codes_SRS_CBOR_ENCODER_09_012: [ EDM_BINARY shall be written as a byte string. ]*/
+            case EDM_BINARY_TYPE:
+                appendResult = ((appendHead(buffer, CBOR_MAJOR_TYPE_BYTE_STRING, value->value.edmBinary.size) != 0) ||
+                    (appendBytes(buffer, value->value.edmBinary.data, value->value.edmBinary.size) != 0)) ? __FAILURE__ : 0;
+                break;
+            /*Codes_SRS_CBOR_ENCODER_09_013: [ EDM_GUID shall be written as tag 37 followed by a byte string with the 16 bytes of the GUID. ]*/
+            case EDM_GUID_TYPE:
+                appendResult = ((appendHead(buffer, CBOR_MAJOR_TYPE_TAG, CBOR_TAG_UUID) != 0) ||
+                    (appendHead(buffer, CBOR_MAJOR_TYPE_BYTE_STRING, sizeof(value->value.edmGuid.GUID)) != 0) ||
+                    (appendBytes(buffer, value->value.edmGuid.GUID, sizeof(value->value.edmGuid.GUID)) != 0)) ? __FAILURE__ : 0;
+                break;
+            /*Codes_SRS_CBOR_ENCODER_09_014: [ EDM_COMPLEX_TYPE shall be written as a map from the name of every field to its value. ]*/
+            case EDM_COMPLEX_TYPE_TYPE:
+            {
+                size_t i;
+                appendResult = appendHead(buffer, CBOR_MAJOR_TYPE_MAP, value->value.edmComplexType.nMembers);
+                for (i = 0; (appendResult == 0) && (result == CBOR_ENCODER_OK) && (i < value->value.edmComplexType.nMembers); i++)
+                {
+                    const char* fieldName = value->value.edmComplexType.fields[i].fieldName;
+                    appendResult = appendTextString(buffer, fieldName, strlen(fieldName));
+                    if (appendResult == 0)
+                    {
+                        result = encodeValue(buffer, value->value.edmComplexType.fields[i].value, valueText);
+                    }
+                }
+                break;
+            }
+            /*Codes_SRS_CBOR_ENCODER_09_015: [ EDM_DATE_TIME_OFFSET shall be written as tag 0 followed by the text AgentDataTypes_ToString produces for it, without quotes. ]*/
+            case EDM_DATE_TIME_OFFSET_TYPE:
+                if (appendHead(buffer, CBOR_MAJOR_TYPE_TAG, CBOR_TAG_DATE_TIME_STRING) != 0)
+                {
+                    appendResult = __FAILURE__;
+                }
+                else
+                {
+                    result = appendAgentDataTypeText(buffer, value, valueText);
+                    appendResult = 0;
+                }
+                break;
+            /*Codes_SRS_CBOR_ENCODER_09_016: [ Any other type shall be written as a text string with the text AgentDataTypes_ToString produces for it, without quotes. ]*/
+            default:
+                result = appendAgentDataTypeText(buffer, value, valueText);
+                appendResult = 0;
+                break;
+        }
+
+        if ((result == CBOR_ENCODER_OK) && (appendResult != 0))
+        {
+            result = CBOR_ENCODER_ERROR;
+            LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+        }
+    }
+
+    return result;
+}
+
+static CBOR_ENCODER_RESULT encodeNode(CBOR_BUFFER* buffer, MULTITREE_HANDLE treeHandle, STRING_HANDLE valueText)
+{
+    CBOR_ENCODER_RESULT result;
+    size_t childCount;
+
+    if (MultiTree_GetChildCount(treeHandle, &childCount) != MULTITREE_OK)
+    {
+        /*Codes_SRS_CBOR_ENCODER_09_017: [ If any MultiTree function call fails CBOREncoder_EncodeTree shall return CBOR_ENCODER_MULTITREE_ERROR. ]*/
+        result = CBOR_ENCODER_MULTITREE_ERROR;
+        LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+    }
+    /*Codes_SRS_CBOR_ENCODER_09_005: [ Every node shall be written as a map with as many entries as the node has children; every entry shall be the name of the child as a text string followed by the child's value. ]*/
+    else if (appendHead(buffer, CBOR_MAJOR_TYPE_MAP, childCount) != 0)
+    {
+        result = CBOR_ENCODER_ERROR;
+        LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+    }
+    else
+    {
+        size_t i;
+        result = CBOR_ENCODER_OK;
+        for (i = 0; (i < childCount) && (result == CBOR_ENCODER_OK); i++)
+        {
+            MULTITREE_HANDLE childTreeHandle;
+            const char* name;
+            size_t innerChildCount;
+
+            if ((MultiTree_GetChild(treeHandle, i, &childTreeHandle) != MULTITREE_OK) ||
+                (MultiTree_GetNamePtr(childTreeHandle, &name) != MULTITREE_OK) ||
+                (MultiTree_GetChildCount(childTreeHandle, &innerChildCount) != MULTITREE_OK))
+            {
+                result = CBOR_ENCODER_MULTITREE_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+            }
+            else if (appendTextString(buffer, name, strlen(name)) != 0)
+            {
+                result = CBOR_ENCODER_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+            }
+            else if (innerChildCount > 0)
+            {
+                /*Codes_SRS_CBOR_ENCODER_09_006: [ A child that has children shall be written as a nested map. ]*/
+                result = encodeNode(buffer, childTreeHandle, valueText);
+            }
+            else
+            {
+                /*Codes_SRS_CBOR_ENCODER_09_007: [ A child with zero children shall be written from its value, which is an AGENT_DATA_TYPE*. ]*/
+                const void* value;
+                if (MultiTree_GetValue(childTreeHandle, &value) != MULTITREE_OK)
+                {
+                    result = CBOR_ENCODER_MULTITREE_ERROR;
+                    LogError("(result = %s)", ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+                }
+                else
+                {
+                    result = encodeValue(buffer, (const AGENT_DATA_TYPE*)value, valueText);
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+CBOR_ENCODER_RESULT CBOREncoder_EncodeTree(MULTITREE_HANDLE treeHandle, size_t initialCapacity, unsigned char** destination, size_t* destinationSize)
+{
+    CBOR_ENCODER_RESULT result;
+
+    /*Codes_SRS_CBOR_ENCODER_09_001: [ If treeHandle, destination or destinationSize are NULL, CBOREncoder_EncodeTree shall fail and return CBOR_ENCODER_INVALID_ARG. ]*/
+    if ((treeHandle == NULL) ||
+        (destination == NULL) ||
+        (destinationSize == NULL))
+    {
+        result = CBOR_ENCODER_INVALID_ARG;
+        LogError("invalid arg MULTITREE_HANDLE treeHandle=%p, unsigned char** destination=%p, size_t* destinationSize=%p", treeHandle, destination, destinationSize);
+    }
+    else
+    {
+        /*Codes_SRS_CBOR_ENCODER_09_002: [ CBOREncoder_EncodeTree shall write into a buffer of initialCapacity bytes (a default capacity when initialCapacity is 0). ]*/
+        CBOR_BUFFER buffer;
+        STRING_HANDLE valueText;
+
+        buffer.size = 0;
+        buffer.capacity = (initialCapacity == 0) ? CBOR_ENCODER_DEFAULT_CAPACITY : initialCapacity;
+        if ((buffer.bytes = (unsigned char*)malloc(buffer.capacity)) == NULL)
+        {
+            /*Codes_SRS_CBOR_ENCODER_09_018: [ If any other failure occurs CBOREncoder_EncodeTree shall return CBOR_ENCODER_ERROR. ]*/
+            result = CBOR_ENCODER_ERROR;
+            LogError("unable to malloc %lu bytes", (unsigned long)buffer.capacity);
+        }
+        /*the types that are written as their text share one STRING*/
+        else if ((valueText = STRING_new()) == NULL)
+        {
+            /*Codes_SRS_CBOR_ENCODER_09_018: [ If any other failure occurs CBOREncoder_EncodeTree shall return CBOR_ENCODER_ERROR. ]*/
+            result = CBOR_ENCODER_ERROR;
+            LogError("failure in STRING_new");
+            free(buffer.bytes);
+        }
+        else
+        {
+            result = encodeNode(&buffer, treeHandle, valueText);
+            if (result == CBOR_ENCODER_OK)
+            {
+                /*Codes_SRS_CBOR_ENCODER_09_003: [ On success CBOREncoder_EncodeTree shall hand the buffer over to the caller in *destination and *destinationSize without copying it and return CBOR_ENCODER_OK; the caller frees it with free. ]*/
+                *destination = buffer.bytes;
+                *destinationSize = buffer.size;
+            }
+            else
+            {
+                free(buffer.bytes);
+            }
+            STRING_delete(valueText);
+        }
+    }
+
+    return result;
+}
@@ -3,6 +3,7 @@
 
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include "azure_c_shared_utility/gballoc.h"
 
 #include "codefirst.h"
@@ -12,6 +13,7 @@
 #include <stddef.h>
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "iotdevice.h"
+#include "fnvhash.h"
 
 DEFINE_ENUM_STRINGS(CODEFIRST_RESULT, CODEFIRST_RESULT_VALUES)
 DEFINE_ENUM_STRINGS(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_RESULT_VALUES)
@@ -19,6 +21,59 @@ DEFINE_ENUM_STRINGS(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_RESULT_VALUES)
 #define LOG_CODEFIRST_ERROR \
     LogError("(result = %s)", ENUM_TO_STRING(CODEFIRST_RESULT, result))
 
+/*an OFFSET_TABLE lists every property (or reported property) of a device model, including the ones of its child models,
+by its offset from the beginning of the device data. Entries are sorted by offset and then by depth, so that the outermost
+property that starts at an address comes first. path is the full property path ("ChildModel/InnerProperty")*/
+typedef struct OFFSET_TABLE_ENTRY_TAG
+{
+    size_t offset;
+    size_t depth;
+    size_t index;
+    const REFLECTED_SOMETHING* something;
+    char* path;
+} OFFSET_TABLE_ENTRY;
+
+typedef struct OFFSET_TABLE_TAG
+{
+    OFFSET_TABLE_ENTRY* entries;
+    size_t count;
+    size_t capacity;
+} OFFSET_TABLE;
+
+/*the tables are built once per device model and shared by all the devices created from the same model and reflected data*/
+typedef struct MODEL_OFFSET_TABLES_TAG
+{
+    size_t refCount;
+    OFFSET_TABLE properties;
+    OFFSET_TABLE reportedProperties;
+} MODEL_OFFSET_TABLES;
+
+/*what CodeFirst_SendAsyncReportedDiff remembers about one reported property (one entry of the reported properties offset table).
+Reports are identified by a token (never 0, growing with each report), so 0 means "none"*/
+typedef struct REPORTED_PROPERTY_SHADOW_TAG
+{
+    uint64_t acknowledgedHash;  /*hash of the value in the newest acknowledged report that included the property*/
+    size_t acknowledgedToken;   /*token of that report*/
+    uint64_t sentHash;          /*hash of the value in the newest report including the property that is acknowledged or still pending*/
+    size_t sentToken;           /*token of that report*/
+} REPORTED_PROPERTY_SHADOW;
+
+/*one reported property sent in a report*/
+typedef struct REPORTED_PROPERTY_SENT_TAG
+{
+    size_t index;               /*index of the reported property in the reported properties offset table*/
+    uint64_t hash;
+} REPORTED_PROPERTY_SENT;
+
+/*a report produced by CodeFirst_SendAsyncReportedDiff that is neither acknowledged nor rejected yet*/
+typedef struct PENDING_REPORT_TAG
+{
+    size_t token;
+    size_t count;
+    REPORTED_PROPERTY_SENT* sent;
+    struct PENDING_REPORT_TAG* next; /*older report*/
+} PENDING_REPORT;
+
 typedef struct DEVICE_HEADER_DATA_TAG
 {
     DEVICE_HANDLE DeviceHandle;
@@ -26,6 +81,10 @@ typedef struct DEVICE_HEADER_DATA_TAG
     SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
     size_t DataSize;
     unsigned char* data;
+    MODEL_OFFSET_TABLES* offsetTables;
+    REPORTED_PROPERTY_SHADOW* reportedPropertiesShadow; /*NULL until the first CodeFirst_SendAsyncReportedDiff*/
+    PENDING_REPORT* pendingReports; /*newest first*/
+    size_t lastReportToken;
 } DEVICE_HEADER_DATA;
 
 #define COUNT_OF(A) (sizeof(A) / sizeof((A)[0]))
@@ -153,12 +212,277 @@ static void deinitializeDesiredProperties(SCHEMA_MODEL_TYPE_HANDLE model, void*
     }
 }
 
+static void DestroyOffsetTable(OFFSET_TABLE* table)
+{
+    size_t i;
+
+    for (i = 0; i < table->count; i++)
+    {
+        free(table->entries[i].path);
+    }
+
+    free(table->entries);
+    table->entries = NULL;
+    table->count = 0;
+    table->capacity = 0;
+}
+
+static void ReleaseOffsetTables(MODEL_OFFSET_TABLES* offsetTables)
+{
+    if (offsetTables != NULL)
+    {
+        offsetTables->refCount--;
+        if (offsetTables->refCount == 0)
+        {
+            DestroyOffsetTable(&offsetTables->properties);
+            DestroyOffsetTable(&offsetTables->reportedProperties);
+            free(offsetTables);
+        }
+    }
+}
+
+/*REFLECTION_PROPERTY and REFLECTION_REPORTED_PROPERTY have the same layout related fields, this gives a common view of them*/
+typedef struct PROPERTY_LAYOUT_TAG
+{
+    const char* name;
+    const char* type;
+    const char* modelName;
+    size_t offset;
+} PROPERTY_LAYOUT;
+
+static bool GetPropertyLayout(const REFLECTED_SOMETHING* something, REFLECTION_TYPE type, PROPERTY_LAYOUT* layout)
+{
+    bool result;
+
+    if (something->type != type)
+    {
+        result = false;
+    }
+    else if (type == REFLECTION_PROPERTY_TYPE)
+    {
+        layout->name = something->what.property.name;
+        layout->type = something->what.property.type;
+        layout->modelName = something->what.property.modelName;
+        layout->offset = something->what.property.offset;
+        result = true;
+    }
+    else
+    {
+        layout->name = something->what.reportedProperty.name;
+        layout->type = something->what.reportedProperty.type;
+        layout->modelName = something->what.reportedProperty.modelName;
+        layout->offset = something->what.reportedProperty.offset;
+        result = true;
+    }
+
+    return result;
+}
+
+static char* CreatePropertyPath(const char* parentPath, const char* name)
+{
+    char* result;
+    size_t nameLength = strlen(name);
+
+    if (parentPath == NULL)
+    {
+        if ((result = (char*)malloc(nameLength + 1)) != NULL)
+        {
+            (void)memcpy(result, name, nameLength + 1);
+        }
+    }
+    else
+    {
+        size_t parentPathLength = strlen(parentPath);
+        if ((result = (char*)malloc(parentPathLength + 1 + nameLength + 1)) != NULL)
+        {
+            (void)memcpy(result, parentPath, parentPathLength);
+            result[parentPathLength] = '/';
+            (void)memcpy(result + parentPathLength + 1, name, nameLength + 1);
+        }
+    }
+
+    return result;
+}
+
+/*appends to table all the properties of type "type" that belong to modelName, followed each by the properties of its child model (if it is a model)*/
+static int AddOffsetTableEntries(OFFSET_TABLE* table, const REFLECTED_DATA_FROM_DATAPROVIDER* reflectedData, REFLECTION_TYPE type, const char* modelName, size_t startOffset, size_t depth, const char* parentPath)
+{
+    int result = 0;
+    const REFLECTED_SOMETHING* something;
+
+    for (something = reflectedData->reflectedData; something != NULL; something = something->next)
+    {
+        PROPERTY_LAYOUT layout;
+        if (GetPropertyLayout(something, type, &layout) &&
+            (strcmp(layout.modelName, modelName) == 0))
+        {
+            OFFSET_TABLE_ENTRY* entry;
+
+            if (table->count == table->capacity)
+            {
+                size_t newCapacity = (table->capacity == 0) ? 8 : (table->capacity * 2);
+                OFFSET_TABLE_ENTRY* newEntries = (OFFSET_TABLE_ENTRY*)realloc(table->entries, newCapacity * sizeof(OFFSET_TABLE_ENTRY));
+                if (newEntries == NULL)
+                {
+                    LogError("unable to grow the offset table of model %s", modelName);
+                    result = __FAILURE__;
+                    break;
+                }
+
+                table->entries = newEntries;
+                table->capacity = newCapacity;
+            }
+
+            entry = &table->entries[table->count];
+            if ((entry->path = CreatePropertyPath(parentPath, layout.name)) == NULL)
+            {
+                LogError("unable to build the path of property %s", layout.name);
+                result = __FAILURE__;
+                break;
+            }
+            else
+            {
+                /*the entry can move when the table grows, so the recursion below uses copies of offset and path*/
+                size_t offset = startOffset + layout.offset;
+                const char* path = entry->path;
+
+                entry->offset = offset;
+                entry->depth = depth;
+                entry->index = table->count;
+                entry->something = something;
+                table->count++;
+
+                /* Codes_SRS_CODEFIRST_99_133:[CodeFirst_SendAsync shall allow sending of properties that are part of a child model.] */
+                if (AddOffsetTableEntries(table, reflectedData, type, layout.type, offset, depth + 1, path) != 0)
+                {
+                    result = __FAILURE__;
+                    break;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+static int CompareOffsetTableEntries(const void* left, const void* right)
+{
+    const OFFSET_TABLE_ENTRY* leftEntry = (const OFFSET_TABLE_ENTRY*)left;
+    const OFFSET_TABLE_ENTRY* rightEntry = (const OFFSET_TABLE_ENTRY*)right;
+    int result;
+
+    if (leftEntry->offset != rightEntry->offset)
+    {
+        result = (leftEntry->offset < rightEntry->offset) ? -1 : 1;
+    }
+    else if (leftEntry->depth != rightEntry->depth)
+    {
+        result = (leftEntry->depth < rightEntry->depth) ? -1 : 1;
+    }
+    else
+    {
+        result = (leftEntry->index < rightEntry->index) ? -1 : ((leftEntry->index > rightEntry->index) ? 1 : 0);
+    }
+
+    return result;
+}
+
+static MODEL_OFFSET_TABLES* CreateOffsetTables(const REFLECTED_DATA_FROM_DATAPROVIDER* reflectedData, const char* modelName)
+{
+    MODEL_OFFSET_TABLES* result;
+
+    if ((result = (MODEL_OFFSET_TABLES*)malloc(sizeof(MODEL_OFFSET_TABLES))) == NULL)
+    {
+        LogError("unable to allocate the offset tables of model %s", modelName);
+    }
+    else
+    {
+        result->refCount = 1;
+        result->properties.entries = NULL;
+        result->properties.count = 0;
+        result->properties.capacity = 0;
+        result->reportedProperties.entries = NULL;
+        result->reportedProperties.count = 0;
+        result->reportedProperties.capacity = 0;
+
+        if ((AddOffsetTableEntries(&result->properties, reflectedData, REFLECTION_PROPERTY_TYPE, modelName, 0, 0, NULL) != 0) ||
+            (AddOffsetTableEntries(&result->reportedProperties, reflectedData, REFLECTION_REPORTED_PROPERTY_TYPE, modelName, 0, 0, NULL) != 0))
+        {
+            LogError("unable to build the offset tables of model %s", modelName);
+            DestroyOffsetTable(&result->properties);
+            DestroyOffsetTable(&result->reportedProperties);
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            if (result->properties.count > 1)
+            {
+                qsort(result->properties.entries, result->properties.count, sizeof(OFFSET_TABLE_ENTRY), CompareOffsetTableEntries);
+            }
+
+            if (result->reportedProperties.count > 1)
+            {
+                qsort(result->reportedProperties.entries, result->reportedProperties.count, sizeof(OFFSET_TABLE_ENTRY), CompareOffsetTableEntries);
+            }
+        }
+    }
+
+    return result;
+}
+
+/*returns the outermost property that starts at valueOffset, or NULL when no property starts there*/
+static const OFFSET_TABLE_ENTRY* FindOffsetTableEntry(const OFFSET_TABLE* table, size_t valueOffset)
+{
+    const OFFSET_TABLE_ENTRY* result;
+    size_t low = 0;
+    size_t high = table->count;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (table->entries[middle].offset < valueOffset)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if ((low < table->count) && (table->entries[low].offset == valueOffset))
+    {
+        result = &table->entries[low];
+    }
+    else
+    {
+        result = NULL;
+    }
+
+    return result;
+}
+
+static void DestroyPendingReport(PENDING_REPORT* report)
+{
+    free(report->sent);
+    free(report);
+}
+
 static void DestroyDevice(DEVICE_HEADER_DATA* deviceHeader)
 {
     /* Codes_SRS_CODEFIRST_99_085:[CodeFirst_DestroyDevice shall free all resources associated with a device.] */
     /* Codes_SRS_CODEFIRST_99_087:[In order to release the device handle, CodeFirst_DestroyDevice shall call Device_Destroy.] */
     
     Device_Destroy(deviceHeader->DeviceHandle);
+    ReleaseOffsetTables(deviceHeader->offsetTables);
+    free(deviceHeader->reportedPropertiesShadow);
+    while (deviceHeader->pendingReports != NULL)
+    {
+        PENDING_REPORT* report = deviceHeader->pendingReports;
+        deviceHeader->pendingReports = report->next;
+        DestroyPendingReport(report);
+    }
     free(deviceHeader->data);
     free(deviceHeader);
 }
@@ -876,6 +1200,63 @@ static void initializeDesiredProperties(SCHEMA_MODEL_TYPE_HANDLE model, void* de
     }
 }
 
+/*g_Devices is sorted by the address of the device data. Returns how many devices have their data starting at or before address,
+that is, the index where a device starting at address would be inserted*/
+static size_t CountDevicesStartingAtOrBefore(const unsigned char* address)
+{
+    size_t low = 0;
+    size_t high = g_DeviceCount;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (g_Devices[middle]->data <= address)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/*Codes_SRS_CODEFIRST_09_001: [ CodeFirst_CreateDevice shall build, for the model of the device, a table of all its properties and a table of all its reported properties (including the ones of the child models) sorted by offset, each entry holding the full path of the property. ]*/
+/*Codes_SRS_CODEFIRST_09_002: [ Devices created from the same model and reflected data shall share the same tables. ]*/
+static MODEL_OFFSET_TABLES* GetOffsetTables(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DATA_FROM_DATAPROVIDER* reflectedData)
+{
+    MODEL_OFFSET_TABLES* result = NULL;
+    size_t i;
+
+    for (i = 0; i < g_DeviceCount; i++)
+    {
+        if ((g_Devices[i]->ModelHandle == model) &&
+            (g_Devices[i]->ReflectedData == reflectedData))
+        {
+            result = g_Devices[i]->offsetTables;
+            result->refCount++;
+            break;
+        }
+    }
+
+    if (result == NULL)
+    {
+        const char* modelName;
+        if ((modelName = Schema_GetModelName(model)) == NULL)
+        {
+            LogError("unable to get the name of the model");
+        }
+        else
+        {
+            result = CreateOffsetTables(reflectedData, modelName);
+        }
+    }
+
+    return result;
+}
+
 /* Codes_SRS_CODEFIRST_99_079:[CodeFirst_CreateDevice shall create a device and allocate a memory block that should hold the device data.] */
 void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DATA_FROM_DATAPROVIDER* metadata, size_t dataSize, bool includePropertyPath)
 {
@@ -939,9 +1320,16 @@ void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DAT
                 else
                 {
                     SCHEMA_RESULT schemaResult;
+
+                    /*the old block might have been freed by realloc, so the new one is kept even if the device is not added*/
+                    g_Devices = newDevices;
+
                     deviceHeader->ReflectedData = metadata;
                     deviceHeader->DataSize = dataSize;
                     deviceHeader->ModelHandle = model;
+                    deviceHeader->reportedPropertiesShadow = NULL;
+                    deviceHeader->pendingReports = NULL;
+                    deviceHeader->lastReportToken = 0;
                     schemaResult = Schema_AddDeviceRef(model);
                     if (schemaResult != SCHEMA_OK)
                     {
@@ -952,10 +1340,22 @@ void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DAT
                         /* Codes_SRS_CODEFIRST_99_102:[On any other errors, Device_Create shall return NULL.] */
                         result = NULL;
                     }
+                    else if ((deviceHeader->offsetTables = GetOffsetTables(model, metadata)) == NULL)
+                    {
+                        /*Codes_SRS_CODEFIRST_09_003: [ If building the offset tables fails, CodeFirst_CreateDevice shall fail and return NULL. ]*/
+                        (void)Schema_ReleaseDeviceRef(model);
+                        Device_Destroy(deviceHeader->DeviceHandle);
+                        free(deviceHeader->data);
+                        free(deviceHeader);
+                        result = NULL;
+                        LogError(" %s ", ENUM_TO_STRING(CODEFIRST_RESULT, CODEFIRST_ERROR));
+                    }
                     else
                     {
-                        g_Devices = newDevices;
-                        g_Devices[g_DeviceCount] = deviceHeader;
+                        /*Codes_SRS_CODEFIRST_09_004: [ CodeFirst_CreateDevice shall keep the devices sorted by the address of their data. ]*/
+                        size_t index = CountDevicesStartingAtOrBefore(deviceHeader->data);
+                        (void)memmove(&g_Devices[index + 1], &g_Devices[index], (g_DeviceCount - index) * sizeof(DEVICE_HEADER_DATA*));
+                        g_Devices[index] = deviceHeader;
                         g_DeviceCount++;
 
                         /* Codes_SRS_CODEFIRST_99_101:[On success, CodeFirst_CreateDevice shall return a non NULL pointer to the device data.] */
@@ -975,23 +1375,21 @@ void CodeFirst_DestroyDevice(void* device)
     /* Codes_SRS_CODEFIRST_99_086:[If the argument is NULL, CodeFirst_DestroyDevice shall do nothing.] */
     if (device != NULL)
     {
-        size_t i;
+        size_t index = CountDevicesStartingAtOrBefore((const unsigned char*)device);
 
-        for (i = 0; i < g_DeviceCount; i++)
+        if ((index > 0) && (g_Devices[index - 1]->data == device))
         {
-            if (g_Devices[i]->data == device)
-            {
-                deinitializeDesiredProperties(g_Devices[i]->ModelHandle, g_Devices[i]->data);
-                Schema_ReleaseDeviceRef(g_Devices[i]->ModelHandle);
+            DEVICE_HEADER_DATA* deviceHeader = g_Devices[index - 1];
 
-                // Delete the Created Schema if all the devices are unassociated
-                Schema_DestroyIfUnused(g_Devices[i]->ModelHandle);
+            deinitializeDesiredProperties(deviceHeader->ModelHandle, deviceHeader->data);
+            Schema_ReleaseDeviceRef(deviceHeader->ModelHandle);
 
-                DestroyDevice(g_Devices[i]);
-                (void)memcpy(&g_Devices[i], &g_Devices[i + 1], (g_DeviceCount - i - 1) * sizeof(DEVICE_HEADER_DATA*));
-                g_DeviceCount--;
-                break;
-            }
+            // Delete the Created Schema if all the devices are unassociated
+            Schema_DestroyIfUnused(deviceHeader->ModelHandle);
+
+            DestroyDevice(deviceHeader);
+            (void)memmove(&g_Devices[index - 1], &g_Devices[index], (g_DeviceCount - index) * sizeof(DEVICE_HEADER_DATA*));
+            g_DeviceCount--;
         }
 
         /*Codes_SRS_CODEFIRST_02_039: [ If the current device count is zero then CodeFirst_DestroyDevice shall deallocate all other used resources. ]*/
@@ -1004,99 +1402,20 @@ void CodeFirst_DestroyDevice(void* device)
     }
 }
 
+/*Codes_SRS_CODEFIRST_09_005: [ The device that a value belongs to shall be found by a binary search over the devices sorted by address. ]*/
 static DEVICE_HEADER_DATA* FindDevice(void* value)
 {
-    size_t i;
-    DEVICE_HEADER_DATA* result = NULL;
-
-    for (i = 0; i < g_DeviceCount; i++)
-    {
-        if ((g_Devices[i]->data <= (unsigned char*)value) &&
-            (g_Devices[i]->data + g_Devices[i]->DataSize > (unsigned char*)value))
-        {
-            result = g_Devices[i];
-            break;
-        }
-    }
-
-    return result;
-}
-
-static const REFLECTED_SOMETHING* FindValue(DEVICE_HEADER_DATA* deviceHeader, void* value, const char* modelName, size_t startOffset, STRING_HANDLE valuePath)
-{
-    const REFLECTED_SOMETHING* result;
-    size_t valueOffset = (size_t)((unsigned char*)value - (unsigned char*)deviceHeader->data) - startOffset;
-
-    for (result = deviceHeader->ReflectedData->reflectedData; result != NULL; result = result->next)
-    {
-        if (result->type == REFLECTION_PROPERTY_TYPE &&
-            (strcmp(result->what.property.modelName, modelName) == 0) &&
-            (result->what.property.offset <= valueOffset) &&
-            (result->what.property.offset + result->what.property.size > valueOffset))
-        {
-            if (startOffset != 0)
-            {
-                STRING_concat(valuePath, "/");
-            }
-
-            STRING_concat(valuePath, result->what.property.name);
-            break;
-        }
-    }
-
-    if (result != NULL)
-    {
-        /* Codes_SRS_CODEFIRST_99_133:[CodeFirst_SendAsync shall allow sending of properties that are part of a child model.] */
-        if (result->what.property.offset < valueOffset)
-        {
-            /* find recursively the property in the inner model, if there is one */
-            result = FindValue(deviceHeader, value, result->what.property.type, startOffset + result->what.property.offset, valuePath);
-        }
-    }
-
-    return result;
-}
-
-static const REFLECTED_SOMETHING* FindReportedProperty(DEVICE_HEADER_DATA* deviceHeader, void* value, const char* modelName, size_t startOffset, STRING_HANDLE valuePath)
-{
-    const REFLECTED_SOMETHING* result;
-    size_t valueOffset = (size_t)((unsigned char*)value - (unsigned char*)deviceHeader->data) - startOffset;
+    DEVICE_HEADER_DATA* result;
+    size_t index = CountDevicesStartingAtOrBefore((const unsigned char*)value);
 
-    for (result = deviceHeader->ReflectedData->reflectedData; result != NULL; result = result->next)
+    if ((index > 0) &&
+        (g_Devices[index - 1]->data + g_Devices[index - 1]->DataSize > (unsigned char*)value))
     {
-        if (result->type == REFLECTION_REPORTED_PROPERTY_TYPE &&
-            (strcmp(result->what.reportedProperty.modelName, modelName) == 0) &&
-            (result->what.reportedProperty.offset <= valueOffset) &&
-            (result->what.reportedProperty.offset + result->what.reportedProperty.size > valueOffset))
-        {
-            if (startOffset != 0)
-            {
-                if (STRING_concat(valuePath, "/") != 0)
-                {
-                    LogError("unable to STRING_concat");
-                    result = NULL;
-                    break;
-                }
-            }
-
-            if (STRING_concat(valuePath, result->what.reportedProperty.name) != 0)
-            {
-                LogError("unable to STRING_concat");
-                result = NULL;
-                break;
-            }
-            break;
-        }
+        result = g_Devices[index - 1];
     }
-
-    if (result != NULL)
+    else
     {
-        /* Codes_SRS_CODEFIRST_99_133:[CodeFirst_SendAsync shall allow sending of properties that are part of a child model.] */
-        if (result->what.reportedProperty.offset < valueOffset)
-        {
-            /* find recursively the property in the inner model, if there is one */
-            result = FindReportedProperty(deviceHeader, value, result->what.reportedProperty.type, startOffset + result->what.reportedProperty.offset, valuePath);
-        }
+        result = NULL;
     }
 
     return result;
@@ -1265,70 +1584,43 @@ CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destin
                 }
                 else
                 {
-                    const REFLECTED_SOMETHING* propertyReflectedData;
-                    const char* modelName;
-                    STRING_HANDLE valuePath;
-
-                    if ((valuePath = STRING_new()) == NULL)
+                    /* Codes_SRS_CODEFIRST_09_006: [ CodeFirst_SendAsync shall find the property and its full path by a binary search in the properties offset table of the device, without allocating memory. ] */
+                    const OFFSET_TABLE_ENTRY* entry = FindOffsetTableEntry(&deviceHeader->offsetTables->properties, (size_t)((unsigned char*)value - deviceHeader->data));
+                    if (entry == NULL)
                     {
-                        /* Codes_SRS_CODEFIRST_99_134:[If CodeFirst_Notify fails for any other reason it shall return CODEFIRST_ERROR.] */
-                        result = CODEFIRST_ERROR;
+                        /* Codes_SRS_CODEFIRST_99_104:[If a property cannot be associated with a device, CodeFirst_SendAsync shall return CODEFIRST_INVALID_ARG.] */
+                        result = CODEFIRST_INVALID_ARG;
                         LOG_CODEFIRST_ERROR;
                         break;
                     }
                     else
                     {
-                        if ((modelName = Schema_GetModelName(deviceHeader->ModelHandle)) == NULL)
-                        {
-                            /* Codes_SRS_CODEFIRST_99_134:[If CodeFirst_Notify fails for any other reason it shall return CODEFIRST_ERROR.] */
-                            result = CODEFIRST_ERROR;
-                            LOG_CODEFIRST_ERROR;
-                            STRING_delete(valuePath);
-                            break;
-                        }
-                        else if ((propertyReflectedData = FindValue(deviceHeader, value, modelName, 0, valuePath)) == NULL)
+                        AGENT_DATA_TYPE agentDataType;
+
+                        /* Codes_SRS_CODEFIRST_99_097:[For each value marshalling to AGENT_DATA_TYPE shall be performed.] */
+                        /* Codes_SRS_CODEFIRST_99_098:[The marshalling shall be done by calling the Create_AGENT_DATA_TYPE_from_Ptr function associated with the property.] */
+                        if (entry->something->what.property.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
                         {
-                            /* Codes_SRS_CODEFIRST_99_104:[If a property cannot be associated with a device, CodeFirst_SendAsync shall return CODEFIRST_INVALID_ARG.] */
-                            result = CODEFIRST_INVALID_ARG;
+                            /* Codes_SRS_CODEFIRST_99_099:[If Create_AGENT_DATA_TYPE_from_Ptr fails, CodeFirst_SendAsync shall return CODEFIRST_AGENT_DATA_TYPE_ERROR.] */
+                            result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
                             LOG_CODEFIRST_ERROR;
-                            STRING_delete(valuePath);
                             break;
                         }
                         else
                         {
-                            AGENT_DATA_TYPE agentDataType;
-
-                            /* Codes_SRS_CODEFIRST_99_097:[For each value marshalling to AGENT_DATA_TYPE shall be performed.] */
-                            /* Codes_SRS_CODEFIRST_99_098:[The marshalling shall be done by calling the Create_AGENT_DATA_TYPE_from_Ptr function associated with the property.] */
-                            if (propertyReflectedData->what.property.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
+                            /* Codes_SRS_CODEFIRST_99_092:[CodeFirst shall publish each value by using Device_PublishTransacted.] */
+                            /* Codes_SRS_CODEFIRST_99_136:[CodeFirst_SendAsync shall build the full path for each property and then pass it to Device_PublishTransacted.] */
+                            if (Device_PublishTransacted(transaction, entry->path, &agentDataType) != DEVICE_OK)
                             {
-                                /* Codes_SRS_CODEFIRST_99_099:[If Create_AGENT_DATA_TYPE_from_Ptr fails, CodeFirst_SendAsync shall return CODEFIRST_AGENT_DATA_TYPE_ERROR.] */
-                                result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+                                Destroy_AGENT_DATA_TYPE(&agentDataType);
+
+                                /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
+                                result = CODEFIRST_DEVICE_PUBLISH_FAILED;
                                 LOG_CODEFIRST_ERROR;
-                                STRING_delete(valuePath);
                                 break;
                             }
-                            else
-                            {
-                                /* Codes_SRS_CODEFIRST_99_092:[CodeFirst shall publish each value by using Device_PublishTransacted.] */
-                                /* Codes_SRS_CODEFIRST_99_136:[CodeFirst_SendAsync shall build the full path for each property and then pass it to Device_PublishTransacted.] */
-                                if (Device_PublishTransacted(transaction, STRING_c_str(valuePath), &agentDataType) != DEVICE_OK)
-                                {
-                                    Destroy_AGENT_DATA_TYPE(&agentDataType);
 
-                                    /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
-                                    result = CODEFIRST_DEVICE_PUBLISH_FAILED;
-                                    LOG_CODEFIRST_ERROR;
-                                    STRING_delete(valuePath);
-                                    break;
-                                }
-                                else
-                                {
-                                    STRING_delete(valuePath); /*anyway*/
-                                }
-
-                                Destroy_AGENT_DATA_TYPE(&agentDataType);
-                            }
+                            Destroy_AGENT_DATA_TYPE(&agentDataType);
                         }
                     }
                 }
@@ -1435,56 +1727,36 @@ CODEFIRST_RESULT CodeFirst_SendAsyncReported(unsigned char** destination, size_t
                     else
                     {
                         /*Codes_SRS_CODEFIRST_02_020: [ If values passed through va_args are not all of type REFLECTED_REPORTED_PROPERTY then CodeFirst_SendAsyncReported shall fail and return CODEFIRST_INVALID_ARG. ]*/
-                        const REFLECTED_SOMETHING* propertyReflectedData;
-                        const char* modelName;
-
-                        STRING_HANDLE valuePath;
-                        if ((valuePath = STRING_new()) == NULL)
+                        /*Codes_SRS_CODEFIRST_02_025: [ CodeFirst_SendAsyncReported shall compute for every AGENT_DATA_TYPE the valuePath. ]*/
+                        /*Codes_SRS_CODEFIRST_09_007: [ CodeFirst_SendAsyncReported shall find the reported property and its full path by a binary search in the reported properties offset table of the device, without allocating memory. ]*/
+                        const OFFSET_TABLE_ENTRY* entry = FindOffsetTableEntry(&deviceHeader->offsetTables->reportedProperties, (size_t)((unsigned char*)value - deviceHeader->data));
+                        if (entry == NULL)
                         {
-                            result = CODEFIRST_ERROR;
+                            result = CODEFIRST_INVALID_ARG;
                             LOG_CODEFIRST_ERROR;
                             break;
                         }
                         else
                         {
-                            modelName = Schema_GetModelName(deviceHeader->ModelHandle);
-
-                            /*Codes_SRS_CODEFIRST_02_025: [ CodeFirst_SendAsyncReported shall compute for every AGENT_DATA_TYPE the valuePath. ]*/
-                            if ((propertyReflectedData = FindReportedProperty(deviceHeader, value, modelName, 0, valuePath)) == NULL)
+                            AGENT_DATA_TYPE agentDataType;
+                            /*Codes_SRS_CODEFIRST_02_023: [ CodeFirst_SendAsyncReported shall convert all REPORTED_PROPERTY model components to AGENT_DATA_TYPE. ]*/
+                            if (entry->something->what.reportedProperty.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
                             {
-                                result = CODEFIRST_INVALID_ARG;
+                                result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
                                 LOG_CODEFIRST_ERROR;
-                                STRING_delete(valuePath);
                                 break;
                             }
                             else
                             {
-                                AGENT_DATA_TYPE agentDataType;
-                                /*Codes_SRS_CODEFIRST_02_023: [ CodeFirst_SendAsyncReported shall convert all REPORTED_PROPERTY model components to AGENT_DATA_TYPE. ]*/
-                                if (propertyReflectedData->what.reportedProperty.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
+                                /*Codes_SRS_CODEFIRST_02_024: [ CodeFirst_SendAsyncReported shall call Device_PublishTransacted_ReportedProperty for every AGENT_DATA_TYPE converted from REPORTED_PROPERTY. ]*/
+                                if (Device_PublishTransacted_ReportedProperty(transaction, entry->path, &agentDataType) != DEVICE_OK)
                                 {
-                                    result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+                                    Destroy_AGENT_DATA_TYPE(&agentDataType);
+                                    result = CODEFIRST_DEVICE_PUBLISH_FAILED;
                                     LOG_CODEFIRST_ERROR;
-                                    STRING_delete(valuePath);
                                     break;
                                 }
-                                else
-                                {
-                                    /*Codes_SRS_CODEFIRST_02_024: [ CodeFirst_SendAsyncReported shall call Device_PublishTransacted_ReportedProperty for every AGENT_DATA_TYPE converted from REPORTED_PROPERTY. ]*/
-                                    if (Device_PublishTransacted_ReportedProperty(transaction, STRING_c_str(valuePath), &agentDataType) != DEVICE_OK)
-                                    {
-                                        Destroy_AGENT_DATA_TYPE(&agentDataType);
-                                        result = CODEFIRST_DEVICE_PUBLISH_FAILED;
-                                        LOG_CODEFIRST_ERROR;
-                                        STRING_delete(valuePath);
-                                        break;
-                                    }
-                                    else
-                                    {
-                                        STRING_delete(valuePath);
-                                    }
-                                    Destroy_AGENT_DATA_TYPE(&agentDataType);
-                                }
+                                Destroy_AGENT_DATA_TYPE(&agentDataType);
                             }
                         }
                     }
@@ -1523,6 +1795,346 @@ CODEFIRST_RESULT CodeFirst_SendAsyncReported(unsigned char** destination, size_t
     return result;
 }
 
+/*returns the device whose data starts at device, or NULL*/
+static DEVICE_HEADER_DATA* FindDeviceByData(void* device)
+{
+    DEVICE_HEADER_DATA* result = FindDevice(device);
+    if ((result != NULL) && (result->data != (unsigned char*)device))
+    {
+        result = NULL;
+    }
+    return result;
+}
+
+/*removes the pending report having token from the device and returns it, or NULL*/
+static PENDING_REPORT* RemovePendingReport(DEVICE_HEADER_DATA* deviceHeader, size_t token)
+{
+    PENDING_REPORT** link = &deviceHeader->pendingReports;
+    PENDING_REPORT* result;
+
+    while (((result = *link) != NULL) && (result->token != token))
+    {
+        link = &result->next;
+    }
+
+    if (result != NULL)
+    {
+        *link = result->next;
+        result->next = NULL;
+    }
+
+    return result;
+}
+
+CODEFIRST_RESULT CodeFirst_SendAsyncReportedDiff(unsigned char** destination, size_t* destinationSize, void* device, size_t* reportToken)
+{
+    CODEFIRST_RESULT result;
+    DEVICE_HEADER_DATA* deviceHeader;
+
+    if ((destination == NULL) || (destinationSize == NULL) || (device == NULL) || (reportToken == NULL))
+    {
+        /*Codes_SRS_CODEFIRST_09_008: [ If destination, destinationSize, device or reportToken is NULL then CodeFirst_SendAsyncReportedDiff shall fail and return CODEFIRST_INVALID_ARG. ]*/
+        LogError("invalid argument unsigned char** destination=%p, size_t* destinationSize=%p, void* device=%p, size_t* reportToken=%p", destination, destinationSize, device, reportToken);
+        result = CODEFIRST_INVALID_ARG;
+    }
+    else if ((deviceHeader = FindDeviceByData(device)) == NULL)
+    {
+        /*Codes_SRS_CODEFIRST_09_009: [ If device is not the address of a device created by CodeFirst_CreateDevice then CodeFirst_SendAsyncReportedDiff shall fail and return CODEFIRST_INVALID_ARG. ]*/
+        LogError("unable to find a device having this memory address %p", device);
+        result = CODEFIRST_INVALID_ARG;
+    }
+    else
+    {
+        const OFFSET_TABLE* table = &deviceHeader->offsetTables->reportedProperties;
+        STRING_HANDLE valueText;
+        PENDING_REPORT* report;
+
+        /*Codes_SRS_CODEFIRST_09_010: [ On the first call for a device, CodeFirst_SendAsyncReportedDiff shall allocate the shadow of the device, with one entry per reported property and no value sent nor acknowledged. ]*/
+        if ((deviceHeader->reportedPropertiesShadow == NULL) &&
+            (table->count > 0) &&
+            ((deviceHeader->reportedPropertiesShadow = (REPORTED_PROPERTY_SHADOW*)malloc(table->count * sizeof(REPORTED_PROPERTY_SHADOW))) != NULL))
+        {
+            (void)memset(deviceHeader->reportedPropertiesShadow, 0, table->count * sizeof(REPORTED_PROPERTY_SHADOW));
+        }
+
+        if ((table->count > 0) && (deviceHeader->reportedPropertiesShadow == NULL))
+        {
+            /*Codes_SRS_CODEFIRST_09_015: [ If any error occurs, CodeFirst_SendAsyncReportedDiff shall fail, leave the shadow unchanged and return CODEFIRST_ERROR, CODEFIRST_AGENT_DATA_TYPE_ERROR or CODEFIRST_DEVICE_PUBLISH_FAILED. ]*/
+            result = CODEFIRST_ERROR;
+            LOG_CODEFIRST_ERROR;
+        }
+        else if ((report = (PENDING_REPORT*)malloc(sizeof(PENDING_REPORT))) == NULL)
+        {
+            /*Codes_SRS_CODEFIRST_09_015: [ If any error occurs, CodeFirst_SendAsyncReportedDiff shall fail, leave the shadow unchanged and return CODEFIRST_ERROR, CODEFIRST_AGENT_DATA_TYPE_ERROR or CODEFIRST_DEVICE_PUBLISH_FAILED. ]*/
+            result = CODEFIRST_ERROR;
+            LOG_CODEFIRST_ERROR;
+        }
+        else if ((table->count > 0) && ((report->sent = (REPORTED_PROPERTY_SENT*)malloc(table->count * sizeof(REPORTED_PROPERTY_SENT))) == NULL))
+        {
+            /*Codes_SRS_CODEFIRST_09_015: [ If any error occurs, CodeFirst_SendAsyncReportedDiff shall fail, leave the shadow unchanged and return CODEFIRST_ERROR, CODEFIRST_AGENT_DATA_TYPE_ERROR or CODEFIRST_DEVICE_PUBLISH_FAILED. ]*/
+            free(report);
+            result = CODEFIRST_ERROR;
+            LOG_CODEFIRST_ERROR;
+        }
+        else if ((valueText = STRING_new()) == NULL)
+        {
+            /*Codes_SRS_CODEFIRST_09_015: [ If any error occurs, CodeFirst_SendAsyncReportedDiff shall fail, leave the shadow unchanged and return CODEFIRST_ERROR, CODEFIRST_AGENT_DATA_TYPE_ERROR or CODEFIRST_DEVICE_PUBLISH_FAILED. ]*/
+            if (table->count > 0)
+            {
+                free(report->sent);
+            }
+            free(report);
+            result = CODEFIRST_ERROR;
+            LOG_CODEFIRST_ERROR;
+        }
+        else
+        {
+            REPORTED_PROPERTIES_TRANSACTION_HANDLE transaction = NULL;
+            size_t i;
+
+            if (table->count == 0)
+            {
+                report->sent = NULL;
+            }
+            report->count = 0;
+            report->next = NULL;
+            result = CODEFIRST_OK;
+
+            for (i = 0; i < table->count; i++)
+            {
+                const OFFSET_TABLE_ENTRY* entry = &table->entries[i];
+
+                /*Codes_SRS_CODEFIRST_09_011: [ CodeFirst_SendAsyncReportedDiff shall compare the reported properties that have no reported properties of their own, including the ones of child models, with the shadow by a hash of their JSON text as produced by AgentDataTypes_ToString. ]*/
+                /*the entries of a child model follow their parent at a greater depth, so an entry is a leaf when the next one is not deeper*/
+                if ((i + 1 == table->count) || (table->entries[i + 1].depth <= entry->depth))
+                {
+                    AGENT_DATA_TYPE agentDataType;
+                    const REPORTED_PROPERTY_SHADOW* shadow = &deviceHeader->reportedPropertiesShadow[i];
+
+                    if (entry->something->what.reportedProperty.Create_AGENT_DATA_TYPE_from_Ptr(deviceHeader->data + entry->offset, &agentDataType) != AGENT_DATA_TYPES_OK)
+                    {
+                        result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+                        LOG_CODEFIRST_ERROR;
+                        break;
+                    }
+                    else
+                    {
+                        const char* text;
+                        uint64_t hash;
+
+                        if ((STRING_empty(valueText) != 0) ||
+                            (AgentDataTypes_ToString(valueText, &agentDataType) != AGENT_DATA_TYPES_OK))
+                        {
+                            Destroy_AGENT_DATA_TYPE(&agentDataType);
+                            result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+                            LOG_CODEFIRST_ERROR;
+                            break;
+                        }
+
+                        text = STRING_c_str(valueText);
+                        hash = FnvHash_Compute64(text, STRING_length(valueText));
+
+                        /*Codes_SRS_CODEFIRST_09_012: [ CodeFirst_SendAsyncReportedDiff shall publish by Device_PublishTransacted_ReportedProperty only the reported properties that were never sent or whose value differs from the one in the newest report that included them and is acknowledged or still pending, starting the transaction with the first one. ]*/
+                        if ((shadow->sentToken == 0) || (shadow->sentHash != hash))
+                        {
+                            if ((transaction == NULL) &&
+                                ((transaction = Device_CreateTransaction_ReportedProperties(deviceHeader->DeviceHandle)) == NULL))
+                            {
+                                Destroy_AGENT_DATA_TYPE(&agentDataType);
+                                result = CODEFIRST_DEVICE_PUBLISH_FAILED;
+                                LOG_CODEFIRST_ERROR;
+                                break;
+                            }
+                            else if (Device_PublishTransacted_ReportedProperty(transaction, entry->path, &agentDataType) != DEVICE_OK)
+                            {
+                                Destroy_AGENT_DATA_TYPE(&agentDataType);
+                                result = CODEFIRST_DEVICE_PUBLISH_FAILED;
+                                LOG_CODEFIRST_ERROR;
+                                break;
+                            }
+                            else
+                            {
+                                report->sent[report->count].index = i;
+                                report->sent[report->count].hash = hash;
+                                report->count++;
+                            }
+                        }
+
+                        Destroy_AGENT_DATA_TYPE(&agentDataType);
+                    }
+                }
+            }
+
+            if (result == CODEFIRST_OK)
+            {
+                if (transaction == NULL)
+                {
+                    /*Codes_SRS_CODEFIRST_09_013: [ If no reported property changed, CodeFirst_SendAsyncReportedDiff shall set *destination to NULL, *destinationSize to 0 and *reportToken to 0 and return CODEFIRST_OK. ]*/
+                    *destination = NULL;
+                    *destinationSize = 0;
+                    *reportToken = 0;
+                    DestroyPendingReport(report);
+                }
+                /*Codes_SRS_CODEFIRST_09_014: [ Otherwise CodeFirst_SendAsyncReportedDiff shall commit the transaction by calling Device_CommitTransaction_ReportedProperties and destroy it. ]*/
+                else if (Device_CommitTransaction_ReportedProperties(transaction, destination, destinationSize) != DEVICE_OK)
+                {
+                    DestroyPendingReport(report);
+                    result = CODEFIRST_DEVICE_PUBLISH_FAILED;
+                    LOG_CODEFIRST_ERROR;
+                }
+                else
+                {
+                    /*Codes_SRS_CODEFIRST_09_021: [ CodeFirst_SendAsyncReportedDiff shall keep the published values as a pending report, identified by a new non-zero token returned in *reportToken, until the token is passed to CodeFirst_AcknowledgeReportedProperties or CodeFirst_NackReportedProperties, and return CODEFIRST_OK. ]*/
+                    if (++deviceHeader->lastReportToken == 0)
+                    {
+                        deviceHeader->lastReportToken = 1;
+                    }
+                    report->token = deviceHeader->lastReportToken;
+                    report->next = deviceHeader->pendingReports;
+                    deviceHeader->pendingReports = report;
+
+                    for (i = 0; i < report->count; i++)
+                    {
+                        REPORTED_PROPERTY_SHADOW* shadow = &deviceHeader->reportedPropertiesShadow[report->sent[i].index];
+                        shadow->sentHash = report->sent[i].hash;
+                        shadow->sentToken = report->token;
+                    }
+
+                    *reportToken = report->token;
+                }
+            }
+            else
+            {
+                DestroyPendingReport(report);
+            }
+
+            if (transaction != NULL)
+            {
+                Device_DestroyTransaction_ReportedProperties(transaction);
+            }
+
+            STRING_delete(valueText);
+        }
+    }
+
+    return result;
+}
+
+CODEFIRST_RESULT CodeFirst_AcknowledgeReportedProperties(void* device, size_t reportToken)
+{
+    CODEFIRST_RESULT result;
+    DEVICE_HEADER_DATA* deviceHeader;
+    PENDING_REPORT* report;
+
+    if (device == NULL)
+    {
+        /*Codes_SRS_CODEFIRST_09_016: [ If device is NULL or is not the address of a device created by CodeFirst_CreateDevice then CodeFirst_AcknowledgeReportedProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+        LogError("invalid argument void* device=%p", device);
+        result = CODEFIRST_INVALID_ARG;
+    }
+    else if ((deviceHeader = FindDeviceByData(device)) == NULL)
+    {
+        /*Codes_SRS_CODEFIRST_09_016: [ If device is NULL or is not the address of a device created by CodeFirst_CreateDevice then CodeFirst_AcknowledgeReportedProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+        LogError("unable to find a device having this memory address %p", device);
+        result = CODEFIRST_INVALID_ARG;
+    }
+    else if ((report = RemovePendingReport(deviceHeader, reportToken)) == NULL)
+    {
+        /*Codes_SRS_CODEFIRST_09_022: [ If reportToken does not identify a pending report of the device then CodeFirst_AcknowledgeReportedProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+        LogError("no pending report has the token %lu", (unsigned long)reportToken);
+        result = CODEFIRST_INVALID_ARG;
+    }
+    else
+    {
+        size_t i;
+
+        /*Codes_SRS_CODEFIRST_09_017: [ CodeFirst_AcknowledgeReportedProperties shall record the values sent in the report as acknowledged, except for the reported properties for which a newer report is already acknowledged, forget the report and return CODEFIRST_OK. ]*/
+        for (i = 0; i < report->count; i++)
+        {
+            REPORTED_PROPERTY_SHADOW* shadow = &deviceHeader->reportedPropertiesShadow[report->sent[i].index];
+            if (shadow->acknowledgedToken < report->token)
+            {
+                shadow->acknowledgedHash = report->sent[i].hash;
+                shadow->acknowledgedToken = report->token;
+            }
+        }
+
+        DestroyPendingReport(report);
+        result = CODEFIRST_OK;
+    }
+
+    return result;
+}
+
+CODEFIRST_RESULT CodeFirst_NackReportedProperties(void* device, size_t reportToken)
+{
+    CODEFIRST_RESULT result;
+    DEVICE_HEADER_DATA* deviceHeader;
+    PENDING_REPORT* report;
+
+    if (device == NULL)
+    {
+        /*Codes_SRS_CODEFIRST_09_023: [ If device is NULL or is not the address of a device created by CodeFirst_CreateDevice then CodeFirst_NackReportedProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+        LogError("invalid argument void* device=%p", device);
+        result = CODEFIRST_INVALID_ARG;
+    }
+    else if ((deviceHeader = FindDeviceByData(device)) == NULL)
+    {
+        /*Codes_SRS_CODEFIRST_09_023: [ If device is NULL or is not the address of a device created by CodeFirst_CreateDevice then CodeFirst_NackReportedProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+        LogError("unable to find a device having this memory address %p", device);
+        result = CODEFIRST_INVALID_ARG;
+    }
+    else if ((report = RemovePendingReport(deviceHeader, reportToken)) == NULL)
+    {
+        /*Codes_SRS_CODEFIRST_09_024: [ If reportToken does not identify a pending report of the device then CodeFirst_NackReportedProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+        LogError("no pending report has the token %lu", (unsigned long)reportToken);
+        result = CODEFIRST_INVALID_ARG;
+    }
+    else
+    {
+        size_t i;
+
+        /*Codes_SRS_CODEFIRST_09_025: [ CodeFirst_NackReportedProperties shall forget the report, so the next CodeFirst_SendAsyncReportedDiff compares the reported properties it included with the newest other pending report that included them, or else with the acknowledged values, and return CODEFIRST_OK. ]*/
+        for (i = 0; i < report->count; i++)
+        {
+            size_t index = report->sent[i].index;
+            REPORTED_PROPERTY_SHADOW* shadow = &deviceHeader->reportedPropertiesShadow[index];
+
+            if (shadow->sentToken == report->token)
+            {
+                const PENDING_REPORT* other;
+
+                shadow->sentHash = shadow->acknowledgedHash;
+                shadow->sentToken = shadow->acknowledgedToken;
+
+                /*the pending reports are kept newest first, so the first one including the property is the newest*/
+                for (other = deviceHeader->pendingReports; other != NULL; other = other->next)
+                {
+                    size_t j;
+                    for (j = 0; (j < other->count) && (other->sent[j].index != index); j++)
+                    {
+                    }
+
+                    if (j < other->count)
+                    {
+                        if (other->token > shadow->acknowledgedToken)
+                        {
+                            shadow->sentHash = other->sent[j].hash;
+                            shadow->sentToken = other->token;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+
+        DestroyPendingReport(report);
+        result = CODEFIRST_OK;
+    }
+
+    return result;
+}
+
 EXECUTE_COMMAND_RESULT CodeFirst_ExecuteCommand(void* device, const char* command)
 {
     EXECUTE_COMMAND_RESULT result;
@@ -1554,6 +2166,59 @@ EXECUTE_COMMAND_RESULT CodeFirst_ExecuteCommand(void* device, const char* comman
     return result;
 }
 
+EXECUTE_COMMAND_RESULT CodeFirst_ExecuteCommandCBOR(void* device, const unsigned char* command, size_t size)
+{
+    EXECUTE_COMMAND_RESULT result;
+    /*Codes_SRS_CODEFIRST_09_018: [ If parameter device or command is NULL then CodeFirst_ExecuteCommandCBOR shall return EXECUTE_COMMAND_ERROR. ]*/
+    if (
+        (device == NULL) ||
+        (command == NULL)
+        )
+    {
+        result = EXECUTE_COMMAND_ERROR;
+        LogError("invalid argument (NULL) passed to CodeFirst_ExecuteCommandCBOR void* device = %p, const unsigned char* command = %p", device, command);
+    }
+    else
+    {
+        DEVICE_HEADER_DATA* deviceHeader = FindDevice(device);
+        if (deviceHeader == NULL)
+        {
+            /*Codes_SRS_CODEFIRST_09_019: [ If finding the device fails, then CodeFirst_ExecuteCommandCBOR shall return EXECUTE_COMMAND_ERROR. ]*/
+            result = EXECUTE_COMMAND_ERROR;
+            LogError("unable to find the device given by address %p", device);
+        }
+        else
+        {
+            /*Codes_SRS_CODEFIRST_09_020: [ Otherwise CodeFirst_ExecuteCommandCBOR shall call Device_ExecuteCommandCBOR and return what Device_ExecuteCommandCBOR is returning. ]*/
+            result = Device_ExecuteCommandCBOR(deviceHeader->DeviceHandle, command, size);
+        }
+    }
+    return result;
+}
+
+const DATA_MARSHALLER_ENCODER* CodeFirst_GetEncoder(void* device)
+{
+    const DATA_MARSHALLER_ENCODER* result;
+    DEVICE_HEADER_DATA* deviceHeader;
+    /*Codes_SRS_CODEFIRST_09_026: [ If device is NULL or is not the address of a device created by CodeFirst_CreateDevice then CodeFirst_GetEncoder shall return NULL. ]*/
+    if (device == NULL)
+    {
+        result = NULL;
+        LogError("invalid argument (NULL) passed to CodeFirst_GetEncoder void* device = %p", device);
+    }
+    else if ((deviceHeader = FindDeviceByData(device)) == NULL)
+    {
+        result = NULL;
+        LogError("unable to find the device given by address %p", device);
+    }
+    else
+    {
+        /*Codes_SRS_CODEFIRST_09_027: [ Otherwise CodeFirst_GetEncoder shall call Device_GetEncoder and return what Device_GetEncoder is returning. ]*/
+        result = Device_GetEncoder(deviceHeader->DeviceHandle);
+    }
+    return result;
+}
+
 METHODRETURN_HANDLE CodeFirst_ExecuteMethod(void* device, const char* methodName, const char* methodPayload)
 {
     METHODRETURN_HANDLE result;
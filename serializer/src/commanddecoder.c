@@ -6,6 +6,7 @@
 #include "azure_c_shared_utility/gballoc.h"
 
 #include <stddef.h>
+#include <string.h>
 
 #include "commanddecoder.h"
 #include "multitree.h"
@@ -14,6 +15,7 @@
 #include "schema.h"
 #include "codefirst.h"
 #include "jsondecoder.h"
+#include "cbordecoder.h"
 
 DEFINE_ENUM_STRINGS(COMMANDDECODER_RESULT, COMMANDDECODER_RESULT_VALUES);
 
@@ -688,6 +690,48 @@ EXECUTE_COMMAND_RESULT CommandDecoder_ExecuteCommand(COMMAND_DECODER_HANDLE hand
     return result;
 }
 
+EXECUTE_COMMAND_RESULT CommandDecoder_ExecuteCommandCBOR(COMMAND_DECODER_HANDLE handle, const unsigned char* command, size_t size)
+{
+    EXECUTE_COMMAND_RESULT result;
+    COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance = (COMMAND_DECODER_HANDLE_DATA*)handle;
+    /*Codes_SRS_COMMAND_DECODER_09_006: [ If handle or command is NULL, CommandDecoder_ExecuteCommandCBOR shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    if (
+        (command == NULL) ||
+        (commandDecoderInstance == NULL)
+        )
+    {
+        LogError("Invalid argument, COMMAND_DECODER_HANDLE handle=%p, const unsigned char* command=%p", handle, command);
+        result = EXECUTE_COMMAND_ERROR;
+    }
+    /*Codes_SRS_COMMAND_DECODER_09_007: [ If size is 0, CommandDecoder_ExecuteCommandCBOR shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    else if (size == 0)
+    {
+        LogError("Failed because command size is zero");
+        result = EXECUTE_COMMAND_ERROR;
+    }
+    else
+    {
+        MULTITREE_HANDLE commandsTree;
+
+        /*Codes_SRS_COMMAND_DECODER_09_008: [ CommandDecoder_ExecuteCommandCBOR shall decode the command to a multi-tree by using CBORDecoder_CBOR_To_MultiTree. ]*/
+        if (CBORDecoder_CBOR_To_MultiTree(command, size, &commandsTree) != CBOR_DECODER_OK)
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_009: [ If CBORDecoder_CBOR_To_MultiTree fails, CommandDecoder_ExecuteCommandCBOR shall return EXECUTE_COMMAND_ERROR. ]*/
+            LogError("Decoding CBOR to a multi tree failed");
+            result = EXECUTE_COMMAND_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_010: [ Otherwise CommandDecoder_ExecuteCommandCBOR shall dispatch the command the same way CommandDecoder_ExecuteCommand does, and shall return what the action callback returns. ]*/
+            result = DecodeCommand(commandDecoderInstance, commandsTree);
+
+            /*Codes_SRS_COMMAND_DECODER_09_011: [ CommandDecoder_ExecuteCommandCBOR shall free the multi-tree after the command is executed. ]*/
+            MultiTree_Destroy(commandsTree);
+        }
+    }
+    return result;
+}
+
 METHODRETURN_HANDLE CommandDecoder_ExecuteMethod(COMMAND_DECODER_HANDLE handle, const char* fullMethodName, const char* methodPayload)
 {
     METHODRETURN_HANDLE result;
@@ -795,188 +839,699 @@ void CommandDecoder_Destroy(COMMAND_DECODER_HANDLE commandDecoderHandle)
 
 DEFINE_ENUM_STRINGS(AGENT_DATA_TYPE_TYPE, AGENT_DATA_TYPE_TYPE_VALUES);
 
-/*validates that the multitree (coming from a JSON) is actually a serialization of the model (complete or incomplete)*/
-/*if the serialization contains more than the model, then it fails.*/
-/*if the serialization does not contain mandatory items from the model, it fails*/
-static bool validateModel_vs_Multitree(void* startAddress, SCHEMA_MODEL_TYPE_HANDLE modelHandle, MULTITREE_HANDLE desiredPropertiesTree, size_t offset)
+/*desired properties are ingested straight from the JSON text: JSONDecoder_JSON_To_Events reports every member and the model decides what
+happens to it. No MULTITREE and no copy of the JSON are made; besides a copy of the current name or value, only the frames below are held in
+memory, one per model in model or struct value being ingested, so memory depends on the shape of the model and not on the size of the JSON.*/
+typedef enum INGEST_FRAME_TYPE_TAG
 {
-    
-    bool result;
-    size_t nChildren;
-    size_t nProcessedChildren = 0;
-    (void)MultiTree_GetChildCount(desiredPropertiesTree, &nChildren);
-    for (size_t i = 0;i < nChildren;i++)
+    INGEST_FRAME_TWIN,      /*the full twin; only its "desired" member is ingested*/
+    INGEST_FRAME_MODEL,     /*the root model or a model in model*/
+    INGEST_FRAME_STRUCT     /*the value of a desired property (or of a struct member) of a struct type*/
+} INGEST_FRAME_TYPE;
+
+typedef struct INGEST_FRAME_TAG
+{
+    INGEST_FRAME_TYPE frameType;
+    /*model frames: the model. struct frames: the model that has the desired property*/
+    SCHEMA_MODEL_TYPE_HANDLE modelHandle;
+    /*model frames: offset of the model from startAddress. struct frames: offset of the model that has the desired property*/
+    size_t offset;
+
+    /*model in model frames: called with startAddress + parentOffset when the model ends*/
+    pfOnDesiredProperty onDesiredProperty;
+    size_t parentOffset;
+
+    /*struct frames*/
+    const char* structTypeName;
+    SCHEMA_STRUCT_TYPE_HANDLE structTypeHandle;
+    size_t memberCount;
+    size_t decodedMemberCount;
+    const char** memberNames;
+    AGENT_DATA_TYPE* memberValues;
+    bool* isMemberDecoded;
+    /*where the value goes once complete: the desired property, or (when NULL) member memberIndex of the struct in the frame below*/
+    SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle;
+    size_t memberIndex;
+} INGEST_FRAME;
+
+typedef struct INGEST_STATE_TAG
+{
+    void* startAddress;
+    SCHEMA_MODEL_TYPE_HANDLE modelHandle;
+    bool parseDesiredNode;
+    bool desiredNodeFound;
+    INGEST_FRAME* frames;
+    size_t frameCount;
+    size_t frameCapacity;
+    /*non-zero while inside an object or array that is not ingested*/
+    size_t skipDepth;
+    /*'\0' terminated copy of the name or value being looked at*/
+    char* token;
+    size_t tokenCapacity;
+} INGEST_STATE;
+
+static const char* IngestToken(INGEST_STATE* state, const char* text, size_t length)
+{
+    const char* result;
+    if (length >= state->tokenCapacity)
     {
-        MULTITREE_HANDLE child;
-        if (MultiTree_GetChild(desiredPropertiesTree, i, &child) != MULTITREE_OK)
+        size_t newCapacity = (state->tokenCapacity == 0) ? 32 : state->tokenCapacity;
+        char* newToken;
+        while (newCapacity <= length)
+        {
+            newCapacity *= 2;
+        }
+
+        newToken = (char*)realloc(state->token, newCapacity);
+        if (newToken == NULL)
         {
-            LogError("failure in MultiTree_GetChild");
-            i = nChildren;
+            LogError("failure in realloc");
+            result = NULL;
         }
         else
         {
-            STRING_HANDLE childName = STRING_new();
-            if (childName == NULL)
+            state->token = newToken;
+            state->tokenCapacity = newCapacity;
+        }
+    }
+
+    if (length >= state->tokenCapacity)
+    {
+        result = NULL;
+    }
+    else
+    {
+        (void)memcpy(state->token, text, length);
+        state->token[length] = '\0';
+        result = state->token;
+    }
+    return result;
+}
+
+/*returns the new frame; the frames are reallocated, so pointers to older frames are not valid after this call*/
+static INGEST_FRAME* IngestPushFrame(INGEST_STATE* state, INGEST_FRAME_TYPE frameType, SCHEMA_MODEL_TYPE_HANDLE modelHandle, size_t offset)
+{
+    INGEST_FRAME* result;
+    if (state->frameCount == state->frameCapacity)
+    {
+        size_t newCapacity = (state->frameCapacity == 0) ? 4 : (state->frameCapacity * 2);
+        INGEST_FRAME* newFrames = (INGEST_FRAME*)realloc(state->frames, newCapacity * sizeof(INGEST_FRAME));
+        if (newFrames == NULL)
+        {
+            LogError("failure in realloc");
+        }
+        else
+        {
+            state->frames = newFrames;
+            state->frameCapacity = newCapacity;
+        }
+    }
+
+    if (state->frameCount == state->frameCapacity)
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = &state->frames[state->frameCount++];
+        (void)memset(result, 0, sizeof(INGEST_FRAME));
+        result->frameType = frameType;
+        result->modelHandle = modelHandle;
+        result->offset = offset;
+    }
+    return result;
+}
+
+static void IngestDestroyStructFrame(INGEST_FRAME* frame)
+{
+    size_t i;
+    for (i = 0; i < frame->memberCount; i++)
+    {
+        if (frame->isMemberDecoded[i])
+        {
+            Destroy_AGENT_DATA_TYPE(&frame->memberValues[i]);
+        }
+    }
+    free(frame->isMemberDecoded);
+    free(frame->memberValues);
+    free((void*)frame->memberNames);
+}
+
+/*pushes the frame that collects the members of a value of type structTypeName*/
+static int IngestPushStructFrame(INGEST_STATE* state, SCHEMA_MODEL_TYPE_HANDLE modelHandle, size_t offset, const char* structTypeName, SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle, size_t memberIndex)
+{
+    int result;
+    SCHEMA_STRUCT_TYPE_HANDLE structTypeHandle;
+    size_t memberCount;
+
+    /*Codes_SRS_COMMAND_DECODER_09_004: [ The members of a struct value shall be matched by name against the members of the struct type in the schema; members that the struct type does not have shall be skipped. ]*/
+    if (((structTypeHandle = Schema_GetStructTypeByName(Schema_GetSchemaForModelType(modelHandle), structTypeName)) == NULL) ||
+        (Schema_GetStructTypePropertyCount(structTypeHandle, &memberCount) != SCHEMA_OK))
+    {
+        LogError("Getting Struct information failed.");
+        result = __FAILURE__;
+    }
+    else if (memberCount == 0)
+    {
+        LogError("Struct type with 0 members is not allowed");
+        result = __FAILURE__;
+    }
+    else
+    {
+        INGEST_FRAME* frame = IngestPushFrame(state, INGEST_FRAME_STRUCT, modelHandle, offset);
+        if (frame == NULL)
+        {
+            LogError("failure in IngestPushFrame");
+            result = __FAILURE__;
+        }
+        else
+        {
+            frame->structTypeName = structTypeName;
+            frame->structTypeHandle = structTypeHandle;
+            frame->desiredPropertyHandle = desiredPropertyHandle;
+            frame->memberIndex = memberIndex;
+            if (((frame->memberNames = (const char**)malloc(sizeof(const char*) * memberCount)) == NULL) ||
+                ((frame->memberValues = (AGENT_DATA_TYPE*)malloc(sizeof(AGENT_DATA_TYPE) * memberCount)) == NULL) ||
+                ((frame->isMemberDecoded = (bool*)malloc(sizeof(bool) * memberCount)) == NULL))
             {
-                LogError("failure to STRING_new");
-                i = nChildren;
+                LogError("Failed allocating the members of a struct value");
+                result = __FAILURE__;
             }
             else
             {
-                if (MultiTree_GetName(child, childName) != MULTITREE_OK)
+                size_t i;
+                (void)memset(frame->isMemberDecoded, 0, sizeof(bool) * memberCount);
+                frame->memberCount = memberCount;
+                for (i = 0; i < memberCount; i++)
                 {
-                    LogError("failure to MultiTree_GetName");
-                    i = nChildren;
+                    SCHEMA_PROPERTY_HANDLE propertyHandle = Schema_GetStructTypePropertyByIndex(structTypeHandle, i);
+                    if ((propertyHandle == NULL) ||
+                        ((frame->memberNames[i] = Schema_GetPropertyName(propertyHandle)) == NULL))
+                    {
+                        LogError("Getting the struct member information failed.");
+                        break;
+                    }
+                }
+                result = (i == memberCount) ? 0 : __FAILURE__;
+            }
+        }
+    }
+    return result;
+}
+
+static bool IngestFindStructMember(const INGEST_FRAME* frame, const char* name, size_t nameLength, size_t* memberIndex)
+{
+    bool result = false;
+    size_t i;
+    for (i = 0; i < frame->memberCount; i++)
+    {
+        if ((strncmp(frame->memberNames[i], name, nameLength) == 0) &&
+            (frame->memberNames[i][nameLength] == '\0'))
+        {
+            *memberIndex = i;
+            result = true;
+            break;
+        }
+    }
+    return result;
+}
+
+/*takes over value*/
+static void IngestSetStructMember(INGEST_FRAME* frame, size_t memberIndex, AGENT_DATA_TYPE* value)
+{
+    if (frame->isMemberDecoded[memberIndex])
+    {
+        Destroy_AGENT_DATA_TYPE(&frame->memberValues[memberIndex]);
+    }
+    else
+    {
+        frame->isMemberDecoded[memberIndex] = true;
+        frame->decodedMemberCount++;
+    }
+    frame->memberValues[memberIndex] = *value;
+}
+
+/*takes over value*/
+static int IngestDesiredPropertyValue(INGEST_STATE* state, size_t modelOffset, SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle, AGENT_DATA_TYPE* value)
+{
+    int result;
+    /*Codes_SRS_COMMAND_DECODER_02_008: [ The desired property shall be constructed in memory by calling pfDesiredPropertyFromAGENT_DATA_TYPE. ]*/
+    pfDesiredPropertyFromAGENT_DATA_TYPE leFunction = Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(desiredPropertyHandle);
+    if (leFunction(value, (char*)state->startAddress + modelOffset + Schema_GetModelDesiredProperty_offset(desiredPropertyHandle)) != 0)
+    {
+        LogError("failure in a function that converts from AGENT_DATA_TYPE to C data");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /*Codes_SRS_COMMAND_DECODER_02_013: [ If the desired property has a non-NULL pfOnDesiredProperty then it shall be called. ]*/
+        pfOnDesiredProperty onDesiredProperty = Schema_GetModelDesiredProperty_pfOnDesiredProperty(desiredPropertyHandle);
+        if (onDesiredProperty != NULL)
+        {
+            onDesiredProperty((char*)state->startAddress + modelOffset);
+        }
+        result = 0;
+    }
+    Destroy_AGENT_DATA_TYPE(value);
+    return result;
+}
+
+/*the outermost object of the desired properties has a "$version" that is not part of the model*/
+static bool IngestIsVersion(const INGEST_STATE* state, const char* name, size_t nameLength)
+{
+    /*Codes_SRS_COMMAND_DECODER_02_015: [ Remove '$version' string from node, if it is present.  It not being present is not an error ]*/
+    return (state->frameCount == (state->parseDesiredNode ? 2U : 1U)) &&
+        (nameLength == 8) &&
+        (strncmp(name, "$version", 8) == 0);
+}
+
+/*looks up the name of a member of a model; the name is then in state->token*/
+static SCHEMA_MODEL_ELEMENT IngestGetModelElement(INGEST_STATE* state, SCHEMA_MODEL_TYPE_HANDLE modelHandle, const char* name, size_t nameLength)
+{
+    SCHEMA_MODEL_ELEMENT result;
+    const char* elementName = IngestToken(state, name, nameLength);
+    if (elementName == NULL)
+    {
+        result.elementType = SCHEMA_SEARCH_INVALID_ARG;
+    }
+    else
+    {
+        result = Schema_GetModelElementByName(modelHandle, elementName);
+        switch (result.elementType)
+        {
+            default:
+            {
+                /*Codes_SRS_COMMAND_DECODER_09_003: [ If a member of a model is not a desired property or a model in model of the model then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+                LogError("cannot ingest name %s, it is not a desired property or a model in model", elementName);
+                break;
+            }
+            case (SCHEMA_PROPERTY):
+            {
+                LogError("cannot ingest name (WITH_DATA instead of WITH_DESIRED_PROPERTY): %s", elementName);
+                break;
+            }
+            case (SCHEMA_REPORTED_PROPERTY):
+            {
+                LogError("cannot ingest name (WITH_REPORTED_PROPERTY instead of WITH_DESIRED_PROPERTY): %s", elementName);
+                break;
+            }
+            case (SCHEMA_DESIRED_PROPERTY):
+            case (SCHEMA_MODEL_IN_MODEL):
+            {
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+static int IngestOnBeginObject(void* context, const char* name, size_t nameLength)
+{
+    int result;
+    INGEST_STATE* state = (INGEST_STATE*)context;
+
+    if (state->skipDepth > 0)
+    {
+        state->skipDepth++;
+        result = 0;
+    }
+    else if (state->frameCount == 0)
+    {
+        /*Codes_SRS_COMMAND_DECODER_02_014: [ If parseDesiredNode is TRUE, parse only the `desired` part of JSON tree ]*/
+        if (IngestPushFrame(state, state->parseDesiredNode ? INGEST_FRAME_TWIN : INGEST_FRAME_MODEL, state->modelHandle, 0) == NULL)
+        {
+            LogError("failure in IngestPushFrame");
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    else
+    {
+        INGEST_FRAME* top = &state->frames[state->frameCount - 1];
+        switch (top->frameType)
+        {
+            default:
+            {
+                LogError("INTERNAL ERROR: unexpected frame type");
+                result = __FAILURE__;
+                break;
+            }
+            case INGEST_FRAME_TWIN:
+            {
+                if ((nameLength == 7) && (strncmp(name, "desired", 7) == 0))
+                {
+                    state->desiredNodeFound = true;
+                    if (IngestPushFrame(state, INGEST_FRAME_MODEL, state->modelHandle, 0) == NULL)
+                    {
+                        LogError("failure in IngestPushFrame");
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        result = 0;
+                    }
                 }
                 else
                 {
-                    const char *childName_str = STRING_c_str(childName);
-                    SCHEMA_MODEL_ELEMENT elementType = Schema_GetModelElementByName(modelHandle, childName_str);
-                    switch (elementType.elementType)
+                    state->skipDepth = 1;
+                    result = 0;
+                }
+                break;
+            }
+            case INGEST_FRAME_MODEL:
+            {
+                SCHEMA_MODEL_ELEMENT element;
+                if (IngestIsVersion(state, name, nameLength))
+                {
+                    state->skipDepth = 1;
+                    result = 0;
+                }
+                else if ((element = IngestGetModelElement(state, top->modelHandle, name, nameLength)).elementType == SCHEMA_MODEL_IN_MODEL)
+                {
+                    /*Codes_SRS_COMMAND_DECODER_02_009: [ If the child name corresponds to a model in model then the members of the child object shall be ingested into the model in model. ]*/
+                    SCHEMA_MODEL_TYPE_HANDLE parentModelHandle = top->modelHandle;
+                    size_t parentOffset = top->offset;
+                    size_t modelOffset = parentOffset + Schema_GetModelModelByName_Offset(parentModelHandle, state->token);
+                    pfOnDesiredProperty onDesiredProperty = Schema_GetModelModelByName_OnDesiredProperty(parentModelHandle, state->token);
+                    INGEST_FRAME* frame = IngestPushFrame(state, INGEST_FRAME_MODEL, element.elementHandle.modelHandle, modelOffset);
+                    if (frame == NULL)
                     {
-                        default:
-                        {
-                            LogError("INTERNAL ERROR: unexpected function return");
-                            i = nChildren;
-                            break;
-                        }
-                        case (SCHEMA_PROPERTY):
-                        {
-                            LogError("cannot ingest name (WITH_DATA instead of WITH_DESIRED_PROPERTY): %s", STRING_c_str);
-                            i = nChildren;
-                            break;
-                        }
-                        case (SCHEMA_REPORTED_PROPERTY):
-                        {
-                            LogError("cannot ingest name (WITH_REPORTED_PROPERTY instead of WITH_DESIRED_PROPERTY): %s", STRING_c_str);
-                            i = nChildren;
-                            break;
-                        }
-                        case (SCHEMA_DESIRED_PROPERTY):
+                        LogError("failure in IngestPushFrame");
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        frame->onDesiredProperty = onDesiredProperty;
+                        frame->parentOffset = parentOffset;
+                        result = 0;
+                    }
+                }
+                else if (element.elementType == SCHEMA_DESIRED_PROPERTY)
+                {
+                    const char* desiredPropertyType = Schema_GetModelDesiredPropertyType(element.elementHandle.desiredPropertyHandle);
+                    if (CodeFirst_GetPrimitiveType(desiredPropertyType) != EDM_NO_TYPE)
+                    {
+                        LogError("desired property %s of type %s cannot be ingested from an object", state->token, desiredPropertyType);
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        /*Codes_SRS_COMMAND_DECODER_02_007: [ If the child name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the JSON value. ]*/
+                        result = IngestPushStructFrame(state, top->modelHandle, top->offset, desiredPropertyType, element.elementHandle.desiredPropertyHandle, 0);
+                    }
+                }
+                else
+                {
+                    result = __FAILURE__;
+                }
+                break;
+            }
+            case INGEST_FRAME_STRUCT:
+            {
+                size_t memberIndex;
+                if (!IngestFindStructMember(top, name, nameLength, &memberIndex))
+                {
+                    state->skipDepth = 1;
+                    result = 0;
+                }
+                else
+                {
+                    const char* memberType = Schema_GetPropertyType(Schema_GetStructTypePropertyByIndex(top->structTypeHandle, memberIndex));
+                    if ((memberType == NULL) ||
+                        (CodeFirst_GetPrimitiveType(memberType) != EDM_NO_TYPE))
+                    {
+                        LogError("struct member %s cannot be ingested from an object", top->memberNames[memberIndex]);
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        /*Codes_SRS_COMMAND_DECODER_99_032:[ Nesting shall be supported for complex type.] */
+                        result = IngestPushStructFrame(state, top->modelHandle, top->offset, memberType, NULL, memberIndex);
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+static int IngestOnEndObject(void* context)
+{
+    int result;
+    INGEST_STATE* state = (INGEST_STATE*)context;
+
+    if (state->skipDepth > 0)
+    {
+        state->skipDepth--;
+        result = 0;
+    }
+    else
+    {
+        INGEST_FRAME* top = &state->frames[state->frameCount - 1];
+        switch (top->frameType)
+        {
+            default:
+            {
+                LogError("INTERNAL ERROR: unexpected frame type");
+                result = __FAILURE__;
+                break;
+            }
+            case INGEST_FRAME_TWIN:
+            {
+                state->frameCount--;
+                result = 0;
+                break;
+            }
+            case INGEST_FRAME_MODEL:
+            {
+                /*Codes_SRS_COMMAND_DECODER_02_012: [ If the child model in model has a non-NULL pfOnDesiredProperty then pfOnDesiredProperty shall be called. ]*/
+                if (top->onDesiredProperty != NULL)
+                {
+                    top->onDesiredProperty((char*)state->startAddress + top->parentOffset);
+                }
+                state->frameCount--;
+                result = 0;
+                break;
+            }
+            case INGEST_FRAME_STRUCT:
+            {
+                if (top->decodedMemberCount != top->memberCount)
+                {
+                    /*Codes_SRS_COMMAND_DECODER_09_005: [ If a struct value does not have all the members of its struct type then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+                    LogError("a value of struct type %s does not have all the members", top->structTypeName);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    AGENT_DATA_TYPE value;
+                    /* Codes_SRS_COMMAND_DECODER_99_031:[ The complex type value that aggregates the children shall be built by using the Create_AGENT_DATA_TYPE_from_Members.] */
+                    if (Create_AGENT_DATA_TYPE_from_Members(&value, top->structTypeName, top->memberCount, (const char* const*)top->memberNames, top->memberValues) != AGENT_DATA_TYPES_OK)
+                    {
+                        LogError("Creating the agent data type from members failed.");
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle = top->desiredPropertyHandle;
+                        size_t modelOffset = top->offset;
+                        size_t memberIndex = top->memberIndex;
+
+                        IngestDestroyStructFrame(top);
+                        state->frameCount--;
+
+                        if (desiredPropertyHandle != NULL)
                         {
-                            /*Codes_SRS_COMMAND_DECODER_02_007: [ If the child name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the MULTITREE node. ]*/
-                            SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle = elementType.elementHandle.desiredPropertyHandle;
-                            
-                            const char* desiredPropertyType = Schema_GetModelDesiredPropertyType(desiredPropertyHandle);
-                            AGENT_DATA_TYPE output;
-                            if (DecodeValueFromNode(Schema_GetSchemaForModelType(modelHandle), &output, child, desiredPropertyType) != 0)
-                            {
-                                LogError("failure in DecodeValueFromNode");
-                                i = nChildren;
-                            }
-                            else
-                            {
-                                /*Codes_SRS_COMMAND_DECODER_02_008: [ The desired property shall be constructed in memory by calling pfDesiredPropertyFromAGENT_DATA_TYPE. ]*/
-                                pfDesiredPropertyFromAGENT_DATA_TYPE leFunction = Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(desiredPropertyHandle);
-                                if (leFunction(&output, (char*)startAddress + offset + Schema_GetModelDesiredProperty_offset(desiredPropertyHandle)) != 0)
-                                {
-                                    LogError("failure in a function that converts from AGENT_DATA_TYPE to C data");
-                                }
-                                else
-                                {
-                                    /*Codes_SRS_COMMAND_DECODER_02_013: [ If the desired property has a non-NULL pfOnDesiredProperty then it shall be called. ]*/
-                                    pfOnDesiredProperty onDesiredProperty = Schema_GetModelDesiredProperty_pfOnDesiredProperty(desiredPropertyHandle);
-                                    if (onDesiredProperty != NULL)
-                                    {
-                                        onDesiredProperty((char*)startAddress + offset);
-                                    }
-                                    nProcessedChildren++;
-                                }
-                                Destroy_AGENT_DATA_TYPE(&output);
-                            }
-                            
-                            break;
+                            result = IngestDesiredPropertyValue(state, modelOffset, desiredPropertyHandle, &value);
                         }
-                        case(SCHEMA_MODEL_IN_MODEL):
+                        else
                         {
-                            SCHEMA_MODEL_TYPE_HANDLE modelModel = elementType.elementHandle.modelHandle;
-                            
-                            /*Codes_SRS_COMMAND_DECODER_02_009: [ If the child name corresponds to a model in model then the function shall call itself recursively. ]*/
-                            if (!validateModel_vs_Multitree(startAddress, modelModel, child, offset + Schema_GetModelModelByName_Offset(modelHandle, childName_str)))
-                            {
-                                LogError("failure in validateModel_vs_Multitree");
-                                i = nChildren;
-                            }
-                            else
-                            {
-                                /*if the model in model so happened to be a WITH_DESIRED_PROPERTY... (only those has non_NULL pfOnDesiredProperty) */
-                                /*Codes_SRS_COMMAND_DECODER_02_012: [ If the child model in model has a non-NULL pfOnDesiredProperty then pfOnDesiredProperty shall be called. ]*/
-                                pfOnDesiredProperty onDesiredProperty = Schema_GetModelModelByName_OnDesiredProperty(modelHandle, childName_str);
-                                if (onDesiredProperty != NULL)
-                                {
-                                    onDesiredProperty((char*)startAddress + offset);
-                                }
-                                
-                                nProcessedChildren++;
-                            }
-                            
-                            break;
+                            IngestSetStructMember(&state->frames[state->frameCount - 1], memberIndex, &value);
+                            result = 0;
                         }
-
-                    } /*switch*/
+                    }
                 }
-                STRING_delete(childName);
+                break;
             }
         }
     }
 
-    if(nProcessedChildren == nChildren)
+    return result;
+}
+
+static int IngestOnBeginArray(void* context, const char* name, size_t nameLength)
+{
+    int result;
+    INGEST_STATE* state = (INGEST_STATE*)context;
+    size_t memberIndex;
+
+    if (state->skipDepth > 0)
+    {
+        state->skipDepth++;
+        result = 0;
+    }
+    else if (
+        (state->frameCount > 0) &&
+        (
+            (state->frames[state->frameCount - 1].frameType == INGEST_FRAME_TWIN) ||
+            ((state->frames[state->frameCount - 1].frameType == INGEST_FRAME_MODEL) && IngestIsVersion(state, name, nameLength)) ||
+            ((state->frames[state->frameCount - 1].frameType == INGEST_FRAME_STRUCT) && !IngestFindStructMember(&state->frames[state->frameCount - 1], name, nameLength, &memberIndex))
+        )
+        )
     {
-        /*Codes_SRS_COMMAND_DECODER_02_010: [ If the complete MULTITREE has been parsed then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
-        result = true;
+        /*Codes_SRS_COMMAND_DECODER_09_013: [ Arrays outside of desired, a $version array and arrays that are members of a struct value that the struct type does not have shall be skipped; any other array shall make CommandDecoder_IngestDesiredProperties fail and return EXECUTE_COMMAND_FAILED. ]*/
+        state->skipDepth = 1;
+        result = 0;
     }
     else
     {
-        /*Codes_SRS_COMMAND_DECODER_02_011: [ Otherwise CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
-        LogError("not all constituents of the JSON have been ingested");
-        result = false;
+        /*Codes_SRS_COMMAND_DECODER_09_013: [ Arrays outside of desired, a $version array and arrays that are members of a struct value that the struct type does not have shall be skipped; any other array shall make CommandDecoder_IngestDesiredProperties fail and return EXECUTE_COMMAND_FAILED. ]*/
+        /*neither models nor struct types have arrays*/
+        LogError("cannot ingest an array");
+        result = __FAILURE__;
     }
-    return result;
-}
 
-static EXECUTE_COMMAND_RESULT DecodeDesiredProperties(void* startAddress, COMMAND_DECODER_HANDLE_DATA* handle, MULTITREE_HANDLE desiredPropertiesTree)
-{
-    /*Codes_SRS_COMMAND_DECODER_02_006: [ CommandDecoder_IngestDesiredProperties shall parse the MULTITREEE recursively. ]*/
-    return validateModel_vs_Multitree(startAddress, handle->ModelHandle, desiredPropertiesTree, 0 )?EXECUTE_COMMAND_SUCCESS:EXECUTE_COMMAND_FAILED;
+    return result;
 }
 
-/* Raw JSON has properties we don't need; potentially nodes other than "desired" for full TWIN as well as a $version we don't pass to callees */
-static bool RemoveUnneededTwinProperties(MULTITREE_HANDLE initialParsedTree, bool parseDesiredNode, MULTITREE_HANDLE *desiredPropertiesTree)
+static int IngestOnEndArray(void* context)
 {
-    MULTITREE_HANDLE updateTree;
-    bool result;
+    int result;
+    INGEST_STATE* state = (INGEST_STATE*)context;
 
-    if (parseDesiredNode)
+    /*arrays are only ever skipped*/
+    if (state->skipDepth > 0)
     {
-        /*Codes_SRS_COMMAND_DECODER_02_014: [ If parseDesiredNode is TRUE, parse only the `desired` part of JSON tree ]*/
-        if (MultiTree_GetChildByName(initialParsedTree, "desired", &updateTree) != MULTITREE_OK)
-        {
-            LogError("Unable to find 'desired' in tree");
-            return false;
-        }
+        state->skipDepth--;
+        result = 0;
     }
     else
     {
-        // Tree already starts on node we want so just use it.
-        updateTree = initialParsedTree;
+        LogError("INTERNAL ERROR: end of an array that was not skipped");
+        result = __FAILURE__;
     }
 
-    /*Codes_COMMAND_DECODER_02_015: [ Remove '$version' string from node, if it is present.  It not being present is not an error ]*/
-    MULTITREE_RESULT deleteChildResult = MultiTree_DeleteChild(updateTree, "$version");
-    if ((deleteChildResult == MULTITREE_OK) || (deleteChildResult == MULTITREE_CHILD_NOT_FOUND))
+    return result;
+}
+
+static int IngestOnValue(void* context, const char* name, size_t nameLength, const char* value, size_t valueLength)
+{
+    int result;
+    INGEST_STATE* state = (INGEST_STATE*)context;
+
+    if ((state->skipDepth > 0) ||
+        (state->frames[state->frameCount - 1].frameType == INGEST_FRAME_TWIN))
     {
-        *desiredPropertiesTree = updateTree;
-        result = true;
+        result = 0;
     }
     else
     {
-        *desiredPropertiesTree = NULL;
-        result = false;
+        INGEST_FRAME* top = &state->frames[state->frameCount - 1];
+        if (top->frameType == INGEST_FRAME_MODEL)
+        {
+            SCHEMA_MODEL_ELEMENT element;
+            if (IngestIsVersion(state, name, nameLength))
+            {
+                result = 0;
+            }
+            else if ((element = IngestGetModelElement(state, top->modelHandle, name, nameLength)).elementType == SCHEMA_DESIRED_PROPERTY)
+            {
+                /*Codes_SRS_COMMAND_DECODER_02_007: [ If the child name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the JSON value. ]*/
+                const char* desiredPropertyType = Schema_GetModelDesiredPropertyType(element.elementHandle.desiredPropertyHandle);
+                AGENT_DATA_TYPE_TYPE primitiveType = CodeFirst_GetPrimitiveType(desiredPropertyType);
+                const char* valueText;
+                AGENT_DATA_TYPE output;
+                if (primitiveType == EDM_NO_TYPE)
+                {
+                    LogError("desired property %s of type %s can only be ingested from an object", state->token, desiredPropertyType);
+                    result = __FAILURE__;
+                }
+                else if ((valueText = IngestToken(state, value, valueLength)) == NULL)
+                {
+                    LogError("failure in IngestToken");
+                    result = __FAILURE__;
+                }
+                /*Codes_SRS_COMMAND_DECODER_09_002: [ Every value shall be converted by CreateAgentDataType_From_String and written into the model by pfDesiredPropertyFromAGENT_DATA_TYPE as soon as it is parsed. ]*/
+                else if (CreateAgentDataType_From_String(valueText, primitiveType, &output) != AGENT_DATA_TYPES_OK)
+                {
+                    LogError("Failed parsing value %s.", valueText);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    result = IngestDesiredPropertyValue(state, top->offset, element.elementHandle.desiredPropertyHandle, &output);
+                }
+            }
+            else if (element.elementType == SCHEMA_MODEL_IN_MODEL)
+            {
+                /*a model in model that is not an object (like null) has no desired properties to ingest*/
+                pfOnDesiredProperty onDesiredProperty = Schema_GetModelModelByName_OnDesiredProperty(top->modelHandle, state->token);
+                if (onDesiredProperty != NULL)
+                {
+                    onDesiredProperty((char*)state->startAddress + top->offset);
+                }
+                result = 0;
+            }
+            else
+            {
+                result = __FAILURE__;
+            }
+        }
+        else
+        {
+            size_t memberIndex;
+            if (!IngestFindStructMember(top, name, nameLength, &memberIndex))
+            {
+                result = 0;
+            }
+            else
+            {
+                const char* memberType = Schema_GetPropertyType(Schema_GetStructTypePropertyByIndex(top->structTypeHandle, memberIndex));
+                AGENT_DATA_TYPE_TYPE primitiveType;
+                const char* valueText;
+                AGENT_DATA_TYPE output;
+                if ((memberType == NULL) ||
+                    ((primitiveType = CodeFirst_GetPrimitiveType(memberType)) == EDM_NO_TYPE))
+                {
+                    LogError("struct member %s can only be ingested from an object", top->memberNames[memberIndex]);
+                    result = __FAILURE__;
+                }
+                else if ((valueText = IngestToken(state, value, valueLength)) == NULL)
+                {
+                    LogError("failure in IngestToken");
+                    result = __FAILURE__;
+                }
+                /* Codes_SRS_COMMAND_DECODER_99_027:[ The value for an argument of primitive type shall be decoded by using the CreateAgentDataType_From_String API.] */
+                else if (CreateAgentDataType_From_String(valueText, primitiveType, &output) != AGENT_DATA_TYPES_OK)
+                {
+                    LogError("Failed parsing value %s.", valueText);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    IngestSetStructMember(top, memberIndex, &output);
+                    result = 0;
+                }
+            }
+        }
     }
 
     return result;
 }
 
+static const JSON_DECODER_EVENTS ingestEvents =
+{
+    IngestOnBeginObject,
+    IngestOnEndObject,
+    IngestOnBeginArray,
+    IngestOnEndArray,
+    IngestOnValue
+};
+
 EXECUTE_COMMAND_RESULT CommandDecoder_IngestDesiredProperties(void* startAddress, COMMAND_DECODER_HANDLE handle, const char* jsonPayload, bool parseDesiredNode)
 {
     EXECUTE_COMMAND_RESULT result;
@@ -995,44 +1550,56 @@ EXECUTE_COMMAND_RESULT CommandDecoder_IngestDesiredProperties(void* startAddress
     }
     else
     {
-        /*Codes_SRS_COMMAND_DECODER_02_004: [ CommandDecoder_IngestDesiredProperties shall clone desiredProperties. ]*/
-        char* copy;
-        if (mallocAndStrcpy_s(&copy, jsonPayload) != 0)
+        /*Codes_SRS_COMMAND_DECODER_09_001: [ CommandDecoder_IngestDesiredProperties shall parse jsonPayload in one pass with JSONDecoder_JSON_To_Events, without copying it and without building a MULTITREE. ]*/
+        JSON_DECODER_RESULT decoderResult;
+        INGEST_STATE state;
+        size_t i;
+
+        state.startAddress = startAddress;
+        state.modelHandle = ((COMMAND_DECODER_HANDLE_DATA*)handle)->ModelHandle;
+        state.parseDesiredNode = parseDesiredNode;
+        state.desiredNodeFound = false;
+        state.frames = NULL;
+        state.frameCount = 0;
+        state.frameCapacity = 0;
+        state.skipDepth = 0;
+        state.token = NULL;
+        state.tokenCapacity = 0;
+
+        decoderResult = JSONDecoder_JSON_To_Events(jsonPayload, &ingestEvents, &state);
+        if (decoderResult == JSON_DECODER_ERROR)
         {
-            LogError("failure in mallocAndStrcpy_s");
+            /*Codes_SRS_COMMAND_DECODER_02_011: [ Otherwise CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+            LogError("not all constituents of the JSON have been ingested");
             result = EXECUTE_COMMAND_FAILED;
         }
+        else if (decoderResult != JSON_DECODER_OK)
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_012: [ If jsonPayload is malformed then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR; the desired properties that precede the error in jsonPayload have already been written and stay written. ]*/
+            LogError("Decoding JSON failed");
+            result = EXECUTE_COMMAND_ERROR;
+        }
+        else if (parseDesiredNode && !state.desiredNodeFound)
+        {
+            LogError("Unable to find 'desired' in JSON");
+            result = EXECUTE_COMMAND_ERROR;
+        }
         else
         {
-            /*Codes_SRS_COMMAND_DECODER_02_005: [ CommandDecoder_IngestDesiredProperties shall create a MULTITREE_HANDLE ouf of the clone of desiredProperties. ]*/
-            MULTITREE_HANDLE initialParsedTree;
-            MULTITREE_HANDLE desiredPropertiesTree;
+            /*Codes_SRS_COMMAND_DECODER_02_010: [ If the complete jsonPayload has been parsed then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
+            result = EXECUTE_COMMAND_SUCCESS;
+        }
 
-            if (JSONDecoder_JSON_To_MultiTree(copy, &initialParsedTree) != JSON_DECODER_OK)
-            {
-                LogError("Decoding JSON to a multi tree failed");
-                result = EXECUTE_COMMAND_ERROR;
-            }
-            else
+        /*struct values that were not complete when parsing stopped*/
+        for (i = 0; i < state.frameCount; i++)
+        {
+            if (state.frames[i].frameType == INGEST_FRAME_STRUCT)
             {
-                if (RemoveUnneededTwinProperties(initialParsedTree, parseDesiredNode, &desiredPropertiesTree) == false)
-                {
-                    LogError("Removing unneeded twin properties failed");
-                    result = EXECUTE_COMMAND_ERROR;
-                }
-                else
-                {
-                    COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance = (COMMAND_DECODER_HANDLE_DATA*)handle;
-
-                    /*Codes_SRS_COMMAND_DECODER_02_006: [ CommandDecoder_IngestDesiredProperties shall parse the MULTITREEE recursively. ]*/
-                    result = DecodeDesiredProperties(startAddress, commandDecoderInstance, desiredPropertiesTree);
-
-                    // Do NOT free desiredPropertiesTree.  It is only a pointer into initialParsedTree.
-                    MultiTree_Destroy(initialParsedTree);
-                }
+                IngestDestroyStructFrame(&state.frames[i]);
             }
-            free(copy);
         }
+        free(state.frames);
+        free(state.token);
     }
     return result;
 }
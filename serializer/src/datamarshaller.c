@@ -9,6 +9,8 @@
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "schema.h"
 #include "jsonencoder.h"
+#include "jsonwriter.h"
+#include "cborencoder.h"
 #include "agenttypesystem.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "parson.h"
@@ -23,6 +25,8 @@ typedef struct DATA_MARSHALLER_HANDLE_DATA_TAG
 {
     SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
     bool IncludePropertyPath;
+    size_t LastPayloadSize; /*capacity hint for the next encoding, so that steady telemetry is written without growing the buffer*/
+    const DATA_MARSHALLER_ENCODER* Encoder;
 } DATA_MARSHALLER_HANDLE_DATA;
 
 static int NoCloneFunction(void** destination, const void* source)
@@ -36,6 +40,104 @@ static void NoFreeFunction(void* value)
     (void)value;
 }
 
+static DATA_MARSHALLER_RESULT EncodeTreeAsJSON(MULTITREE_HANDLE treeHandle, size_t capacityHint, unsigned char** destination, size_t* destinationSize)
+{
+    DATA_MARSHALLER_RESULT result;
+    /*Codes_SRS_DATAMARSHALLER_09_001: [ DataMarshaller_SendData shall create a JSON_WRITER whose initial capacity is the size of the previous payload produced by this DataMarshaller instance. ]*/
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(capacityHint);
+    if (writer == NULL)
+    {
+        result = DATA_MARSHALLER_ERROR;
+        LOG_DATA_MARSHALLER_ERROR
+    }
+    else
+    {
+        /*Codes_SRS_DATAMARSHALLER_09_002: [ DataMarshaller_SendData shall encode the MultiTree by calling JSONEncoder_EncodeTreeToWriter. ]*/
+        if (JSONEncoder_EncodeTreeToWriter(treeHandle, writer, (JSON_ENCODER_TOSTRING_FUNC)AgentDataTypes_ToString) != JSON_ENCODER_OK)
+        {
+            /* Codes_SRS_DATA_MARSHALLER_99_027:[ DATA_MARSHALLER_JSON_ENCODER_ERROR shall be returned when JSONEncoder returns an error code.] */
+            result = DATA_MARSHALLER_JSON_ENCODER_ERROR;
+            LOG_DATA_MARSHALLER_ERROR
+        }
+        /*Codes_SRS_DATAMARSHALLER_09_003: [ The content shall be handed over by JSONWriter_Release, without copying it. ]*/
+        else if (JSONWriter_Release(writer, destination, destinationSize) != JSON_WRITER_OK)
+        {
+            /*Codes_SRS_DATA_MARSHALLER_99_015:[ DATA_MARSHALLER_ERROR shall be returned in all the other error cases not explicitly defined here.]*/
+            result = DATA_MARSHALLER_ERROR;
+            LOG_DATA_MARSHALLER_ERROR;
+        }
+        else
+        {
+            result = DATA_MARSHALLER_OK;
+        }
+        JSONWriter_Destroy(writer);
+    }
+    return result;
+}
+
+static DATA_MARSHALLER_RESULT EncodeTreeAsCBOR(MULTITREE_HANDLE treeHandle, size_t capacityHint, unsigned char** destination, size_t* destinationSize)
+{
+    DATA_MARSHALLER_RESULT result;
+    /*Codes_SRS_DATAMARSHALLER_09_010: [ The CBOR encoder shall encode the MultiTree by calling CBOREncoder_EncodeTree with the capacity hint as initial capacity. ]*/
+    if (CBOREncoder_EncodeTree(treeHandle, capacityHint, destination, destinationSize) != CBOR_ENCODER_OK)
+    {
+        /*Codes_SRS_DATAMARSHALLER_09_011: [ If CBOREncoder_EncodeTree fails, DataMarshaller_SendData shall return DATA_MARSHALLER_CBOR_ENCODER_ERROR. ]*/
+        result = DATA_MARSHALLER_CBOR_ENCODER_ERROR;
+        LOG_DATA_MARSHALLER_ERROR
+    }
+    else
+    {
+        result = DATA_MARSHALLER_OK;
+    }
+    return result;
+}
+
+/*Codes_SRS_DATAMARSHALLER_09_006: [ The JSON encoder shall have the content type "application/json" and the content encoding "utf-8". ]*/
+static const DATA_MARSHALLER_ENCODER jsonEncoder = { "application/json", "utf-8", EncodeTreeAsJSON };
+/*Codes_SRS_DATAMARSHALLER_09_007: [ The CBOR encoder shall have the content type "application/cbor" and no content encoding. ]*/
+static const DATA_MARSHALLER_ENCODER cborEncoder = { CBOR_ENCODER_CONTENT_TYPE, NULL, EncodeTreeAsCBOR };
+
+/*Codes_SRS_DATAMARSHALLER_09_008: [ Before any call to DataMarshaller_SetDefaultEncoder, the default encoder shall be the JSON encoder. ]*/
+static const DATA_MARSHALLER_ENCODER* defaultEncoder = &jsonEncoder;
+
+const DATA_MARSHALLER_ENCODER* DataMarshaller_GetJSONEncoder(void)
+{
+    return &jsonEncoder;
+}
+
+const DATA_MARSHALLER_ENCODER* DataMarshaller_GetCBOREncoder(void)
+{
+    return &cborEncoder;
+}
+
+void DataMarshaller_SetDefaultEncoder(const DATA_MARSHALLER_ENCODER* encoder)
+{
+    /*Codes_SRS_DATAMARSHALLER_09_009: [ DataMarshaller_SetDefaultEncoder shall set the encoder of the DataMarshaller instances created afterwards; a NULL encoder, or one without encodeTree, shall restore the JSON encoder. ]*/
+    defaultEncoder = ((encoder == NULL) || (encoder->encodeTree == NULL)) ? &jsonEncoder : encoder;
+}
+
+const DATA_MARSHALLER_ENCODER* DataMarshaller_GetDefaultEncoder(void)
+{
+    return defaultEncoder;
+}
+
+const DATA_MARSHALLER_ENCODER* DataMarshaller_GetEncoder(DATA_MARSHALLER_HANDLE dataMarshallerHandle)
+{
+    const DATA_MARSHALLER_ENCODER* result;
+    if (dataMarshallerHandle == NULL)
+    {
+        /*Codes_SRS_DATAMARSHALLER_09_012: [ If dataMarshallerHandle is NULL, DataMarshaller_GetEncoder shall return NULL. ]*/
+        result = NULL;
+        LogError("invalid argument DATA_MARSHALLER_HANDLE dataMarshallerHandle=%p", dataMarshallerHandle);
+    }
+    else
+    {
+        /*Codes_SRS_DATAMARSHALLER_09_013: [ DataMarshaller_GetEncoder shall return the encoder the instance was created with. ]*/
+        result = ((DATA_MARSHALLER_HANDLE_DATA*)dataMarshallerHandle)->Encoder;
+    }
+    return result;
+}
+
 DATA_MARSHALLER_HANDLE DataMarshaller_Create(SCHEMA_MODEL_TYPE_HANDLE modelHandle, bool includePropertyPath)
 {
     DATA_MARSHALLER_HANDLE_DATA* result;
@@ -58,6 +160,9 @@ DATA_MARSHALLER_HANDLE DataMarshaller_Create(SCHEMA_MODEL_TYPE_HANDLE modelHandl
         /*Codes_SRS_DATA_MARSHALLER_99_018:[ DataMarshaller_Create shall create a new DataMarshaller instance and on success it shall return a non NULL handle.]*/
         result->ModelHandle = modelHandle;
         result->IncludePropertyPath = includePropertyPath;
+        result->LastPayloadSize = 0;
+        /*Codes_SRS_DATAMARSHALLER_09_004: [ DataMarshaller_Create shall capture the default encoder set by DataMarshaller_SetDefaultEncoder. ]*/
+        result->Encoder = defaultEncoder;
     }
     return result;
 }
@@ -172,40 +277,16 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarsha
 
                 if (j == valueCount)
                 {
-                    STRING_HANDLE payload = STRING_new();
-                    if (payload == NULL)
+                    /*Codes_SRS_DATAMARSHALLER_09_005: [ DataMarshaller_SendData shall encode the MultiTree by calling the encodeTree function of the encoder of the instance, passing the size of the previous payload produced by this DataMarshaller instance as capacity hint. ]*/
+                    /*Codes_SRS_DATAMARSHALLER_02_007: [DataMarshaller_SendData shall copy in the output parameters *destination, *destinationSize the content and the content length of the encoded JSON tree.] */
+                    result = dataMarshallerInstance->Encoder->encodeTree(treeHandle, dataMarshallerInstance->LastPayloadSize, destination, destinationSize);
+                    if (result != DATA_MARSHALLER_OK)
                     {
-                        result = DATA_MARSHALLER_ERROR;
                         LOG_DATA_MARSHALLER_ERROR
                     }
                     else
                     {
-                        if (JSONEncoder_EncodeTree(treeHandle, payload, (JSON_ENCODER_TOSTRING_FUNC)AgentDataTypes_ToString) != JSON_ENCODER_OK)
-                        {
-                            /* Codes_SRS_DATA_MARSHALLER_99_027:[ DATA_MARSHALLER_JSON_ENCODER_ERROR shall be returned when JSONEncoder returns an error code.] */
-                            result = DATA_MARSHALLER_JSON_ENCODER_ERROR;
-                            LOG_DATA_MARSHALLER_ERROR
-                        }
-                        else
-                        {
-                            /*Codes_SRS_DATAMARSHALLER_02_007: [DataMarshaller_SendData shall copy in the output parameters *destination, *destinationSize the content and the content length of the encoded JSON tree.] */
-                            size_t resultSize = STRING_length(payload);
-                            unsigned char* temp = malloc(resultSize);
-                            if (temp == NULL)
-                            {
-                                /*Codes_SRS_DATA_MARSHALLER_99_015:[ DATA_MARSHALLER_ERROR shall be returned in all the other error cases not explicitly defined here.]*/
-                                result = DATA_MARSHALLER_ERROR;
-                                LOG_DATA_MARSHALLER_ERROR;
-                            }
-                            else
-                            {
-                                (void)memcpy(temp, STRING_c_str(payload), resultSize);
-                                *destination = temp;
-                                *destinationSize = resultSize;
-                                result = DATA_MARSHALLER_OK;
-                            }
-                        }
-                        STRING_delete(payload);
+                        dataMarshallerInstance->LastPayloadSize = *destinationSize;
                     }
                 } /* if (j==valueCount)*/
                 MultiTree_Destroy(treeHandle);
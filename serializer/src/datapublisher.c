@@ -329,6 +329,23 @@ size_t DataPublisher_GetMaxBufferSize(void)
     return maxBufferSize_;
 }
 
+const DATA_MARSHALLER_ENCODER* DataPublisher_GetEncoder(DATA_PUBLISHER_HANDLE dataPublisherHandle)
+{
+    const DATA_MARSHALLER_ENCODER* result;
+    if (dataPublisherHandle == NULL)
+    {
+        /*Codes_SRS_DATA_PUBLISHER_09_001: [ If dataPublisherHandle is NULL, DataPublisher_GetEncoder shall return NULL. ]*/
+        result = NULL;
+        LogError("invalid argument DATA_PUBLISHER_HANDLE dataPublisherHandle=%p", dataPublisherHandle);
+    }
+    else
+    {
+        /*Codes_SRS_DATA_PUBLISHER_09_002: [ Otherwise DataPublisher_GetEncoder shall return what DataMarshaller_GetEncoder returns for the DataMarshaller instance of dataPublisherHandle. ]*/
+        result = DataMarshaller_GetEncoder(((DATA_PUBLISHER_HANDLE_DATA*)dataPublisherHandle)->DataMarshallerHandle);
+    }
+    return result;
+}
+
 REPORTED_PROPERTIES_TRANSACTION_HANDLE DataPublisher_CreateTransaction_ReportedProperties(DATA_PUBLISHER_HANDLE dataPublisherHandle)
 {
     REPORTED_PROPERTIES_TRANSACTION_HANDLE_DATA* result;
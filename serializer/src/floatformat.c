@@ -0,0 +1,448 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "floatformat.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+/*the digits are produced with Florian Loitsch's Grisu2 algorithm ("Printing Floating-Point Numbers Quickly and Accurately with Integers", PLDI 2010).
+Grisu2 only ever produces digits that lie strictly inside the rounding interval of the value, so they always parse back to the very same value.
+The output is the shortest possible in all but a tiny fraction of the inputs (where it is one digit longer). Doubles and floats are assumed to be
+IEEE 754 binary64 and binary32.*/
+
+/*a "do it yourself" floating point number: f * 2^e*/
+typedef struct DIY_FP_TAG
+{
+    uint64_t f;
+    int e;
+} DIY_FP;
+
+typedef struct CACHED_POWER_TAG
+{
+    uint64_t f;
+    int16_t e;
+} CACHED_POWER;
+
+/*normalized 64 bit approximations of 10^-348, 10^-340, ... 10^340*/
+#define CACHED_POWERS_MIN_DECIMAL_EXPONENT (-348)
+static const CACHED_POWER cachedPowers[] =
+{
+    { 0xFA8FD5A0081C0288, -1220 }, { 0xBAAEE17FA23EBF76, -1193 }, { 0x8B16FB203055AC76, -1166 },
+    { 0xCF42894A5DCE35EA, -1140 }, { 0x9A6BB0AA55653B2D, -1113 }, { 0xE61ACF033D1A45DF, -1087 },
+    { 0xAB70FE17C79AC6CA, -1060 }, { 0xFF77B1FCBEBCDC4F, -1034 }, { 0xBE5691EF416BD60C, -1007 },
+    { 0x8DD01FAD907FFC3C,  -980 }, { 0xD3515C2831559A83,  -954 }, { 0x9D71AC8FADA6C9B5,  -927 },
+    { 0xEA9C227723EE8BCB,  -901 }, { 0xAECC49914078536D,  -874 }, { 0x823C12795DB6CE57,  -847 },
+    { 0xC21094364DFB5637,  -821 }, { 0x9096EA6F3848984F,  -794 }, { 0xD77485CB25823AC7,  -768 },
+    { 0xA086CFCD97BF97F4,  -741 }, { 0xEF340A98172AACE5,  -715 }, { 0xB23867FB2A35B28E,  -688 },
+    { 0x84C8D4DFD2C63F3B,  -661 }, { 0xC5DD44271AD3CDBA,  -635 }, { 0x936B9FCEBB25C996,  -608 },
+    { 0xDBAC6C247D62A584,  -582 }, { 0xA3AB66580D5FDAF6,  -555 }, { 0xF3E2F893DEC3F126,  -529 },
+    { 0xB5B5ADA8AAFF80B8,  -502 }, { 0x87625F056C7C4A8B,  -475 }, { 0xC9BCFF6034C13053,  -449 },
+    { 0x964E858C91BA2655,  -422 }, { 0xDFF9772470297EBD,  -396 }, { 0xA6DFBD9FB8E5B88F,  -369 },
+    { 0xF8A95FCF88747D94,  -343 }, { 0xB94470938FA89BCF,  -316 }, { 0x8A08F0F8BF0F156B,  -289 },
+    { 0xCDB02555653131B6,  -263 }, { 0x993FE2C6D07B7FAC,  -236 }, { 0xE45C10C42A2B3B06,  -210 },
+    { 0xAA242499697392D3,  -183 }, { 0xFD87B5F28300CA0E,  -157 }, { 0xBCE5086492111AEB,  -130 },
+    { 0x8CBCCC096F5088CC,  -103 }, { 0xD1B71758E219652C,   -77 }, { 0x9C40000000000000,   -50 },
+    { 0xE8D4A51000000000,   -24 }, { 0xAD78EBC5AC620000,     3 }, { 0x813F3978F8940984,    30 },
+    { 0xC097CE7BC90715B3,    56 }, { 0x8F7E32CE7BEA5C70,    83 }, { 0xD5D238A4ABE98068,   109 },
+    { 0x9F4F2726179A2245,   136 }, { 0xED63A231D4C4FB27,   162 }, { 0xB0DE65388CC8ADA8,   189 },
+    { 0x83C7088E1AAB65DB,   216 }, { 0xC45D1DF942711D9A,   242 }, { 0x924D692CA61BE758,   269 },
+    { 0xDA01EE641A708DEA,   295 }, { 0xA26DA3999AEF774A,   322 }, { 0xF209787BB47D6B85,   348 },
+    { 0xB454E4A179DD1877,   375 }, { 0x865B86925B9BC5C2,   402 }, { 0xC83553C5C8965D3D,   428 },
+    { 0x952AB45CFA97A0B3,   455 }, { 0xDE469FBD99A05FE3,   481 }, { 0xA59BC234DB398C25,   508 },
+    { 0xF6C69A72A3989F5C,   534 }, { 0xB7DCBF5354E9BECE,   561 }, { 0x88FCF317F22241E2,   588 },
+    { 0xCC20CE9BD35C78A5,   614 }, { 0x98165AF37B2153DF,   641 }, { 0xE2A0B5DC971F303A,   667 },
+    { 0xA8D9D1535CE3B396,   694 }, { 0xFB9B7CD9A4A7443C,   720 }, { 0xBB764C4CA7A44410,   747 },
+    { 0x8BAB8EEFB6409C1A,   774 }, { 0xD01FEF10A657842C,   800 }, { 0x9B10A4E5E9913129,   827 },
+    { 0xE7109BFBA19C0C9D,   853 }, { 0xAC2820D9623BF429,   880 }, { 0x80444B5E7AA7CF85,   907 },
+    { 0xBF21E44003ACDD2D,   933 }, { 0x8E679C2F5E44FF8F,   960 }, { 0xD433179D9C8CB841,   986 },
+    { 0x9E19DB92B4E31BA9,  1013 }, { 0xEB96BF6EBADF77D9,  1039 }, { 0xAF87023B9BF0EE6B,  1066 }
+};
+
+static const uint64_t powersOf10[20] =
+{
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+    10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+/*a digit string longer than this is never needed: 17 digits round trip any double*/
+#define MAX_DIGITS 18
+
+/*plain decimal notation is used while the decimal point position n (value = 0.d1d2... * 10^n) is in (-6, 21], like ECMAScript's Number.prototype.toString*/
+#define MIN_DECIMAL_POINT_POSITION (-6)
+#define MAX_DECIMAL_POINT_POSITION 21
+
+static DIY_FP diyFpNormalize(DIY_FP x)
+{
+    while ((x.f & 0x8000000000000000ULL) == 0)
+    {
+        x.f <<= 1;
+        x.e--;
+    }
+    return x;
+}
+
+/*rounded upper 64 bits of the 128 bit product*/
+static DIY_FP diyFpMultiply(DIY_FP x, DIY_FP y)
+{
+    DIY_FP result;
+    const uint64_t mask32 = 0xFFFFFFFFULL;
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & mask32;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & mask32;
+    uint64_t ac = a * c;
+    uint64_t bc = b * c;
+    uint64_t ad = a * d;
+    uint64_t bd = b * d;
+    uint64_t middle = (bd >> 32) + (ad & mask32) + (bc & mask32) + (1ULL << 31);
+    result.f = ac + (ad >> 32) + (bc >> 32) + (middle >> 32);
+    result.e = x.e + y.e + 64;
+    return result;
+}
+
+/*returns 10^-K such that multiplying a normalized DIY_FP of binary exponent e by it gives a binary exponent in [-60, -32]*/
+static DIY_FP getCachedPower(int e, int* K)
+{
+    DIY_FP result;
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = (int)dk;
+    size_t index;
+    if (dk - k > 0.0)
+    {
+        k++;
+    }
+    index = (size_t)((k >> 3) + 1);
+    *K = -(CACHED_POWERS_MIN_DECIMAL_EXPONENT + (int)(index << 3));
+    result.f = cachedPowers[index].f;
+    result.e = cachedPowers[index].e;
+    return result;
+}
+
+static int countDecimalDigits(uint32_t n)
+{
+    int result = 1;
+    while ((result < 10) && (n >= powersOf10[result]))
+    {
+        result++;
+    }
+    return result;
+}
+
+/*moves the last digit towards w while the shorter candidate stays inside the rounding interval*/
+static void grisuRound(char* digits, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t wpMinusW)
+{
+    while ((rest < wpMinusW) &&
+        (delta - rest >= tenKappa) &&
+        ((rest + tenKappa < wpMinusW) || (wpMinusW - rest > rest + tenKappa - wpMinusW)))
+    {
+        digits[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+static void generateDigits(DIY_FP W, DIY_FP Mp, uint64_t delta, char* digits, int* length, int* K)
+{
+    DIY_FP one;
+    uint64_t wpMinusW = Mp.f - W.f;
+    uint32_t p1;
+    uint64_t p2;
+    int kappa;
+
+    one.f = 1ULL << -Mp.e;
+    one.e = Mp.e;
+    p1 = (uint32_t)(Mp.f >> -one.e);
+    p2 = Mp.f & (one.f - 1);
+    kappa = countDecimalDigits(p1);
+    *length = 0;
+
+    /*integral part*/
+    while (kappa > 0)
+    {
+        uint32_t d = (uint32_t)(p1 / powersOf10[kappa - 1]);
+        uint64_t rest;
+        p1 = (uint32_t)(p1 % powersOf10[kappa - 1]);
+        if ((d != 0) || (*length != 0))
+        {
+            digits[(*length)++] = (char)('0' + d);
+        }
+        kappa--;
+        rest = ((uint64_t)p1 << -one.e) + p2;
+        if (rest <= delta)
+        {
+            *K += kappa;
+            grisuRound(digits, *length, delta, rest, powersOf10[kappa] << -one.e, wpMinusW);
+            return;
+        }
+    }
+
+    /*fractional part*/
+    for (;;)
+    {
+        char d;
+        p2 *= 10;
+        delta *= 10;
+        d = (char)(p2 >> -one.e);
+        if ((d != 0) || (*length != 0))
+        {
+            digits[(*length)++] = (char)('0' + d);
+        }
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta)
+        {
+            *K += kappa;
+            grisuRound(digits, *length, delta, p2, one.f, wpMinusW * ((-kappa < 20) ? powersOf10[-kappa] : 0));
+            return;
+        }
+    }
+}
+
+/*value = significand * 2^exponent, significand != 0. On return value ~= digits * 10^K*/
+static void grisu2(uint64_t significand, int exponent, bool lowerBoundaryIsCloser, char* digits, int* length, int* K)
+{
+    DIY_FP v;
+    DIY_FP plus;
+    DIY_FP minus;
+    DIY_FP cachedPower;
+    DIY_FP W;
+    DIY_FP Wp;
+    DIY_FP Wm;
+
+    /*the rounding interval of the value is (minus, plus); plus and the normalized value share the same exponent*/
+    plus.f = (significand << 1) + 1;
+    plus.e = exponent - 1;
+    plus = diyFpNormalize(plus);
+    if (lowerBoundaryIsCloser)
+    {
+        minus.f = (significand << 2) - 1;
+        minus.e = exponent - 2;
+    }
+    else
+    {
+        minus.f = (significand << 1) - 1;
+        minus.e = exponent - 1;
+    }
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+    v.f = significand;
+    v.e = exponent;
+    v = diyFpNormalize(v);
+
+    cachedPower = getCachedPower(plus.e, K);
+    W = diyFpMultiply(v, cachedPower);
+    Wp = diyFpMultiply(plus, cachedPower);
+    Wm = diyFpMultiply(minus, cachedPower);
+    /*stay strictly inside the interval, whatever the rounding of the multiplications was*/
+    Wm.f++;
+    Wp.f--;
+    generateDigits(W, Wp, Wp.f - Wm.f, digits, length, K);
+}
+
+static size_t writeExponent(int exponent, char* destination)
+{
+    size_t result = 0;
+    destination[result++] = 'e';
+    if (exponent < 0)
+    {
+        destination[result++] = '-';
+        exponent = -exponent;
+    }
+    else
+    {
+        destination[result++] = '+';
+    }
+
+    if (exponent >= 100)
+    {
+        destination[result++] = (char)('0' + exponent / 100);
+        exponent %= 100;
+        destination[result++] = (char)('0' + exponent / 10);
+    }
+    else if (exponent >= 10)
+    {
+        destination[result++] = (char)('0' + exponent / 10);
+    }
+    destination[result++] = (char)('0' + exponent % 10);
+    return result;
+}
+
+/*lays out digits * 10^K the way ECMAScript's Number.prototype.toString does, always with '.' as decimal separator*/
+static size_t layoutDigits(bool isNegative, const char* digits, int length, int K, char* destination)
+{
+    size_t result = 0;
+    int decimalPointPosition = length + K;
+
+    if (isNegative)
+    {
+        destination[result++] = '-';
+    }
+
+    if ((length <= decimalPointPosition) && (decimalPointPosition <= MAX_DECIMAL_POINT_POSITION))
+    {
+        /*integer: 1234e2 -> 123400*/
+        (void)memcpy(destination + result, digits, length);
+        result += length;
+        (void)memset(destination + result, '0', decimalPointPosition - length);
+        result += decimalPointPosition - length;
+    }
+    else if ((0 < decimalPointPosition) && (decimalPointPosition <= MAX_DECIMAL_POINT_POSITION))
+    {
+        /*1234e-2 -> 12.34*/
+        (void)memcpy(destination + result, digits, decimalPointPosition);
+        result += decimalPointPosition;
+        destination[result++] = '.';
+        (void)memcpy(destination + result, digits + decimalPointPosition, length - decimalPointPosition);
+        result += length - decimalPointPosition;
+    }
+    else if ((MIN_DECIMAL_POINT_POSITION < decimalPointPosition) && (decimalPointPosition <= 0))
+    {
+        /*1234e-6 -> 0.001234*/
+        destination[result++] = '0';
+        destination[result++] = '.';
+        (void)memset(destination + result, '0', -decimalPointPosition);
+        result += -decimalPointPosition;
+        (void)memcpy(destination + result, digits, length);
+        result += length;
+    }
+    else
+    {
+        /*1234e30 -> 1.234e+33, 1e-7 -> 1e-7*/
+        destination[result++] = digits[0];
+        if (length > 1)
+        {
+            destination[result++] = '.';
+            (void)memcpy(destination + result, digits + 1, length - 1);
+            result += length - 1;
+        }
+        result += writeExponent(decimalPointPosition - 1, destination + result);
+    }
+    return result;
+}
+
+static size_t formatFloatingPoint(bool isNegative, uint64_t significand, int exponent, bool lowerBoundaryIsCloser, char* destination, size_t destinationSize)
+{
+    size_t result;
+    char text[FLOAT_FORMAT_BUFFER_SIZE];
+    size_t textLength;
+
+    if (significand == 0)
+    {
+        /*-0 keeps its sign so that it parses back to -0*/
+        textLength = 0;
+        if (isNegative)
+        {
+            text[textLength++] = '-';
+        }
+        text[textLength++] = '0';
+    }
+    else
+    {
+        char digits[MAX_DIGITS];
+        int length;
+        int K;
+        grisu2(significand, exponent, lowerBoundaryIsCloser, digits, &length, &K);
+        textLength = layoutDigits(isNegative, digits, length, K, text);
+    }
+
+    if (textLength + 1 > destinationSize)
+    {
+        /*Codes_SRS_FLOATFORMAT_09_002: [ If destinationSize is too small for the text and its terminating '\0', the function shall fail and return 0. ]*/
+        result = 0;
+        LogError("destination too small, needs %zu bytes, has %zu", textLength + 1, destinationSize);
+    }
+    else
+    {
+        (void)memcpy(destination, text, textLength);
+        destination[textLength] = '\0';
+        result = textLength;
+    }
+    return result;
+}
+
+size_t FloatFormat_Double(double value, char* destination, size_t destinationSize)
+{
+    size_t result;
+    uint64_t bits;
+    int biasedExponent;
+
+    (void)memcpy(&bits, &value, sizeof(bits));
+    biasedExponent = (int)((bits >> 52) & 0x7FF);
+
+    if (destination == NULL)
+    {
+        /*Codes_SRS_FLOATFORMAT_09_001: [ If destination is NULL or value is NaN or an infinity, the function shall fail and return 0. ]*/
+        result = 0;
+        LogError("invalid arg char* destination=%p", destination);
+    }
+    else if (biasedExponent == 0x7FF)
+    {
+        /*Codes_SRS_FLOATFORMAT_09_001: [ If destination is NULL or value is NaN or an infinity, the function shall fail and return 0. ]*/
+        result = 0;
+        LogError("NaN and infinities are not formatted by FloatFormat_Double");
+    }
+    else
+    {
+        uint64_t fraction = bits & 0x000FFFFFFFFFFFFFULL;
+        bool isNegative = (bits >> 63) != 0;
+        /*Codes_SRS_FLOATFORMAT_09_003: [ FloatFormat_Double shall write the shortest (Grisu2: in all but rare cases) decimal text of at most 17 significant digits that strtod parses back to exactly value, followed by '\0', and return the number of characters written, not counting the '\0'. ]*/
+        /*Codes_SRS_FLOATFORMAT_09_004: [ The text shall not depend on the current locale: the decimal separator is always '.'. ]*/
+        /*Codes_SRS_FLOATFORMAT_09_005: [ Values whose decimal exponent is in [-6, 20] shall be written in plain decimal notation (0.000001, 1.5, 100000000000000000000), all other values shall be written as d[.ddd]e+x or d[.ddd]e-x (1e+21, 1.5e-7). ]*/
+        /*Codes_SRS_FLOATFORMAT_09_006: [ 0 and -0 shall be written as 0 and -0. ]*/
+        if (biasedExponent == 0)
+        {
+            /*zero and subnormals*/
+            result = formatFloatingPoint(isNegative, fraction, 1 - 1075, false, destination, destinationSize);
+        }
+        else
+        {
+            /*the interval below a power of 2 is half the one above it*/
+            result = formatFloatingPoint(isNegative, fraction | 0x0010000000000000ULL, biasedExponent - 1075, (fraction == 0) && (biasedExponent > 1), destination, destinationSize);
+        }
+    }
+    return result;
+}
+
+size_t FloatFormat_Single(float value, char* destination, size_t destinationSize)
+{
+    size_t result;
+    uint32_t bits;
+    int biasedExponent;
+
+    (void)memcpy(&bits, &value, sizeof(bits));
+    biasedExponent = (int)((bits >> 23) & 0xFF);
+
+    if (destination == NULL)
+    {
+        /*Codes_SRS_FLOATFORMAT_09_001: [ If destination is NULL or value is NaN or an infinity, the function shall fail and return 0. ]*/
+        result = 0;
+        LogError("invalid arg char* destination=%p", destination);
+    }
+    else if (biasedExponent == 0xFF)
+    {
+        /*Codes_SRS_FLOATFORMAT_09_001: [ If destination is NULL or value is NaN or an infinity, the function shall fail and return 0. ]*/
+        result = 0;
+        LogError("NaN and infinities are not formatted by FloatFormat_Single");
+    }
+    else
+    {
+        uint32_t fraction = bits & 0x007FFFFF;
+        bool isNegative = (bits >> 31) != 0;
+        /*Codes_SRS_FLOATFORMAT_09_007: [ FloatFormat_Single shall format value like FloatFormat_Double does, except that the text shall have at most 9 significant digits and shall parse back to exactly value with strtof. ]*/
+        if (biasedExponent == 0)
+        {
+            result = formatFloatingPoint(isNegative, fraction, 1 - 150, false, destination, destinationSize);
+        }
+        else
+        {
+            result = formatFloatingPoint(isNegative, fraction | 0x00800000, biasedExponent - 150, (fraction == 0) && (biasedExponent > 1), destination, destinationSize);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,40 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "fnvhash.h"
+
+#define FNV_32_OFFSET_BASIS 2166136261U
+#define FNV_32_PRIME 16777619U
+#define FNV_64_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_64_PRIME 1099511628211ULL
+
+uint32_t FnvHash_Compute32(const char* text, size_t length)
+{
+    /*Codes_SRS_FNVHASH_09_001: [ FnvHash_Compute32 shall return the 32 bit FNV-1a hash of the first length characters of text. ]*/
+    /*Codes_SRS_FNVHASH_09_003: [ If length is 0 then the hash shall be the offset basis and text shall not be accessed. ]*/
+    uint32_t result = FNV_32_OFFSET_BASIS;
+    size_t i;
+    for (i = 0; i < length; i++)
+    {
+        result ^= (unsigned char)text[i];
+        result *= FNV_32_PRIME;
+    }
+    return result;
+}
+
+uint64_t FnvHash_Compute64(const char* text, size_t length)
+{
+    /*Codes_SRS_FNVHASH_09_002: [ FnvHash_Compute64 shall return the 64 bit FNV-1a hash of the first length characters of text. ]*/
+    /*Codes_SRS_FNVHASH_09_003: [ If length is 0 then the hash shall be the offset basis and text shall not be accessed. ]*/
+    uint64_t result = FNV_64_OFFSET_BASIS;
+    size_t i;
+    for (i = 0; i < length; i++)
+    {
+        result ^= (unsigned char)text[i];
+        result *= FNV_64_PRIME;
+    }
+    return result;
+}
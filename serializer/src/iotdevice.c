@@ -281,6 +281,45 @@ EXECUTE_COMMAND_RESULT Device_ExecuteCommand(DEVICE_HANDLE deviceHandle, const c
     return result;
 }
 
+EXECUTE_COMMAND_RESULT Device_ExecuteCommandCBOR(DEVICE_HANDLE deviceHandle, const unsigned char* command, size_t size)
+{
+    EXECUTE_COMMAND_RESULT result;
+    /*Codes_SRS_DEVICE_09_001: [ If deviceHandle or command is NULL, then Device_ExecuteCommandCBOR shall return EXECUTE_COMMAND_ERROR. ]*/
+    if (
+        (deviceHandle == NULL) ||
+        (command == NULL)
+        )
+    {
+        result = EXECUTE_COMMAND_ERROR;
+        LogError("invalid parameter (NULL passed to Device_ExecuteCommandCBOR DEVICE_HANDLE deviceHandle=%p, const unsigned char* command=%p", deviceHandle, command);
+    }
+    else
+    {
+        /*Codes_SRS_DEVICE_09_002: [ Otherwise, Device_ExecuteCommandCBOR shall call CommandDecoder_ExecuteCommandCBOR and return what CommandDecoder_ExecuteCommandCBOR is returning. ]*/
+        DEVICE_HANDLE_DATA* device = (DEVICE_HANDLE_DATA*)deviceHandle;
+        result = CommandDecoder_ExecuteCommandCBOR(device->commandDecoderHandle, command, size);
+    }
+    return result;
+}
+
+const DATA_MARSHALLER_ENCODER* Device_GetEncoder(DEVICE_HANDLE deviceHandle)
+{
+    const DATA_MARSHALLER_ENCODER* result;
+    /*Codes_SRS_DEVICE_09_003: [ If deviceHandle is NULL, then Device_GetEncoder shall return NULL. ]*/
+    if (deviceHandle == NULL)
+    {
+        result = NULL;
+        LogError("invalid parameter (NULL passed to Device_GetEncoder DEVICE_HANDLE deviceHandle=%p", deviceHandle);
+    }
+    else
+    {
+        /*Codes_SRS_DEVICE_09_004: [ Otherwise, Device_GetEncoder shall call DataPublisher_GetEncoder and return what DataPublisher_GetEncoder is returning. ]*/
+        DEVICE_HANDLE_DATA* device = (DEVICE_HANDLE_DATA*)deviceHandle;
+        result = DataPublisher_GetEncoder(device->dataPublisherHandle);
+    }
+    return result;
+}
+
 METHODRETURN_HANDLE Device_ExecuteMethod(DEVICE_HANDLE deviceHandle, const char* methodName, const char* methodPayload)
 {
     METHODRETURN_HANDLE result;
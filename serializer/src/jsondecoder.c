@@ -1,24 +1,36 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
+#include <stdlib.h>
+#include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 
 #include "jsondecoder.h"
-#include <stdio.h>
 #include <string.h>
 #include <ctype.h>
 #include <stddef.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define JSON_DECODER_USE_SSE2
+#define SCAN_BLOCK_SIZE 16
+#endif
+
 #define IsWhiteSpace(A) (((A) == 0x20) || ((A) == 0x09) || ((A) == 0x0A) || ((A) == 0x0D))
 
 typedef struct PARSER_STATE_TAG
 {
     char* json;
+    /*the terminating '\0' of the JSON text. The decoder only writes behind json, so there is no other '\0' between json and end*/
+    const char* end;
 } PARSER_STATE;
 
-static JSON_DECODER_RESULT ParseArray(PARSER_STATE* parserState, MULTITREE_HANDLE currentNode);
-static JSON_DECODER_RESULT ParseObject(PARSER_STATE* parserState, MULTITREE_HANDLE currentNode);
+/*there is one parser: it reports what it finds through JSON_DECODER_EVENTS. JSONDecoder_JSON_To_MultiTree builds the tree from these events.
+The scanning functions take a char* because the multi tree is built in place; none of them writes into the text*/
+static JSON_DECODER_RESULT ParseArray(PARSER_STATE* parserState, const JSON_DECODER_EVENTS* events, void* context, const char* name, size_t nameLength);
+static JSON_DECODER_RESULT ParseObject(PARSER_STATE* parserState, const JSON_DECODER_EVENTS* events, void* context, const char* name, size_t nameLength);
+
 
 /* Codes_SRS_JSON_DECODER_99_049:[ JSONDecoder shall not allocate new string values for the leafs, but rather point to strings in the original JSON.] */
 static void NoFreeFunction(void* value)
@@ -32,11 +44,89 @@ static int NOPCloneFunction(void** destination, const void* source)
     return 0;
 }
 
+#ifdef JSON_DECODER_USE_SSE2
+static size_t firstSetBit(int mask)
+{
+    size_t result;
+#if defined(__GNUC__)
+    result = (size_t)__builtin_ctz((unsigned int)mask);
+#else
+    result = 0;
+    while ((mask & 1) == 0)
+    {
+        mask >>= 1;
+        result++;
+    }
+#endif
+    return result;
+}
+#endif
+
+/* Codes_SRS_JSON_DECODER_09_001: [ JSONDecoder_JSON_To_MultiTree shall scan runs of white space and the characters of strings a block of 16 bytes at a time when the compiler targets SSE2, and a byte at a time otherwise.] */
+static char* skipWhiteSpaceRun(char* position, const char* end)
+{
+#ifdef JSON_DECODER_USE_SSE2
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i tab = _mm_set1_epi8(0x09);
+    const __m128i lineFeed = _mm_set1_epi8(0x0A);
+    const __m128i carriageReturn = _mm_set1_epi8(0x0D);
+
+    while ((size_t)(end - position) >= SCAN_BLOCK_SIZE)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)position);
+        __m128i isWhiteSpace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(block, lineFeed), _mm_cmpeq_epi8(block, carriageReturn)));
+        int notWhiteSpaceMask = ~_mm_movemask_epi8(isWhiteSpace) & 0xFFFF;
+        if (notWhiteSpaceMask != 0)
+        {
+            /*the byte loop below stops right away*/
+            position += firstSetBit(notWhiteSpaceMask);
+            break;
+        }
+        position += SCAN_BLOCK_SIZE;
+    }
+#endif
+    while ((position < end) && IsWhiteSpace(*position))
+    {
+        position++;
+    }
+    return position;
+}
+
+/* Codes_SRS_JSON_DECODER_09_001: [ JSONDecoder_JSON_To_MultiTree shall scan runs of white space and the characters of strings a block of 16 bytes at a time when the compiler targets SSE2, and a byte at a time otherwise.] */
+static char* findQuoteOrBackslash(char* position, const char* end)
+{
+#ifdef JSON_DECODER_USE_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+
+    while ((size_t)(end - position) >= SCAN_BLOCK_SIZE)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)position);
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)));
+        if (mask != 0)
+        {
+            /*the byte loop below stops right away*/
+            position += firstSetBit(mask);
+            break;
+        }
+        position += SCAN_BLOCK_SIZE;
+    }
+#endif
+    while ((position < end) && (*position != '"') && (*position != '\\'))
+    {
+        position++;
+    }
+    return position;
+}
+
 void SkipWhiteSpaces(PARSER_STATE* parserState)
 {
-    while ((*(parserState->json) != '\0') && IsWhiteSpace(*(parserState->json)))
+    /* most tokens are not preceded by white space, so only start a scan when there is some */
+    if (IsWhiteSpace(*(parserState->json)))
     {
-        parserState->json++;
+        parserState->json = skipWhiteSpaceRun(parserState->json + 1, parserState->end);
     }
 }
 
@@ -53,44 +143,37 @@ static JSON_DECODER_RESULT ParseString(PARSER_STATE* parserState, char** stringB
     }
     else
     {
-        parserState->json++;
-        while ((*(parserState->json) != '"') && (*(parserState->json) != '\0'))
+        parserState->json = findQuoteOrBackslash(parserState->json + 1, parserState->end);
+        while (*(parserState->json) == '\\')
         {
             /* Codes_SRS_JSON_DECODER_99_030:[ Any character may be escaped.]  */
             /* Codes_SRS_JSON_DECODER_99_033:[ Alternatively, there are two-character sequence escape  representations of some popular characters.  So, for example, a string containing only a single reverse solidus character may be represented more compactly as "\\".] */
-            if (*(parserState->json) == '\\')
+            parserState->json++;
+            if (
+                /* Codes_SRS_JSON_DECODER_99_051:[ %x5C /          ; \    reverse solidus U+005C] */
+                (*parserState->json == '\\') ||
+                /* Codes_SRS_JSON_DECODER_99_050:[ %x22 /          ; "    quotation mark  U+0022] */
+                (*parserState->json == '"') ||
+                /* Codes_SRS_JSON_DECODER_99_052:[ %x2F /          ; /    solidus         U+002F] */
+                (*parserState->json == '/') ||
+                /* Codes_SRS_JSON_DECODER_99_053:[ %x62 /          ; b    backspace       U+0008] */
+                (*parserState->json == 'b') ||
+                /* Codes_SRS_JSON_DECODER_99_054:[ %x66 /          ; f    form feed       U+000C] */
+                (*parserState->json == 'f') ||
+                /* Codes_SRS_JSON_DECODER_99_055:[ %x6E /          ; n    line feed       U+000A] */
+                (*parserState->json == 'n') ||
+                /* Codes_SRS_JSON_DECODER_99_056:[ %x72 /          ; r    carriage return U+000D] */
+                (*parserState->json == 'r') ||
+                /* Codes_SRS_JSON_DECODER_99_057:[ %x74 /          ; t    tab             U+0009] */
+                (*parserState->json == 't'))
             {
-                parserState->json++;
-                if (
-                    /* Codes_SRS_JSON_DECODER_99_051:[ %x5C /          ; \    reverse solidus U+005C] */
-                    (*parserState->json == '\\') ||
-                    /* Codes_SRS_JSON_DECODER_99_050:[ %x22 /          ; "    quotation mark  U+0022] */
-                    (*parserState->json == '"') ||
-                    /* Codes_SRS_JSON_DECODER_99_052:[ %x2F /          ; /    solidus         U+002F] */
-                    (*parserState->json == '/') ||
-                    /* Codes_SRS_JSON_DECODER_99_053:[ %x62 /          ; b    backspace       U+0008] */
-                    (*parserState->json == 'b') ||
-                    /* Codes_SRS_JSON_DECODER_99_054:[ %x66 /          ; f    form feed       U+000C] */
-                    (*parserState->json == 'f') ||
-                    /* Codes_SRS_JSON_DECODER_99_055:[ %x6E /          ; n    line feed       U+000A] */
-                    (*parserState->json == 'n') ||
-                    /* Codes_SRS_JSON_DECODER_99_056:[ %x72 /          ; r    carriage return U+000D] */
-                    (*parserState->json == 'r') ||
-                    /* Codes_SRS_JSON_DECODER_99_057:[ %x74 /          ; t    tab             U+0009] */
-                    (*parserState->json == 't'))
-                {
-                    parserState->json++;
-                }
-                else
-                {
-                    /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
-                    result = JSON_DECODER_PARSE_ERROR;
-                    break;
-                }
+                parserState->json = findQuoteOrBackslash(parserState->json + 1, parserState->end);
             }
             else
             {
-                parserState->json++;
+                /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+                result = JSON_DECODER_PARSE_ERROR;
+                break;
             }
         }
 
@@ -216,55 +299,40 @@ static JSON_DECODER_RESULT ParseNumber(PARSER_STATE* parserState)
     return result;
 }
 
-static JSON_DECODER_RESULT ParseValue(PARSER_STATE* parserState, MULTITREE_HANDLE currentNode, char** stringBegin)
+/*parses a string, number or literal name, leaving parserState->json right behind it*/
+static JSON_DECODER_RESULT ParseScalar(PARSER_STATE* parserState)
 {
     JSON_DECODER_RESULT result;
-
-    SkipWhiteSpaces(parserState);
+    char* stringBegin;
 
     if (*(parserState->json) == '"')
     {
-        result = ParseString(parserState, stringBegin);
+        result = ParseString(parserState, &stringBegin);
     }
     /* Codes_SRS_JSON_DECODER_99_018:[ A JSON value MUST be an object, array, number, or string, or one of the following three literal names: false null true] */
     /* Codes_SRS_JSON_DECODER_99_019:[ The literal names MUST be lowercase.] */
     /* Codes_SRS_JSON_DECODER_99_020:[ No other literal names are allowed.] */
-    else if (strncmp(parserState->json, "false", 5) == 0)
+    else if ((*(parserState->json) == 'f') && (strncmp(parserState->json, "false", 5) == 0))
     {
-        *stringBegin = parserState->json;
         parserState->json += 5;
         result = JSON_DECODER_OK;
     }
-    else if (strncmp(parserState->json, "true", 4) == 0)
+    else if ((*(parserState->json) == 't') && (strncmp(parserState->json, "true", 4) == 0))
     {
-        *stringBegin = parserState->json;
         parserState->json += 4;
         result = JSON_DECODER_OK;
     }
-    else if (strncmp(parserState->json, "null", 4) == 0)
+    else if ((*(parserState->json) == 'n') && (strncmp(parserState->json, "null", 4) == 0))
     {
-        *stringBegin = parserState->json;
         parserState->json += 4;
         result = JSON_DECODER_OK;
     }
-    /* Tests_SRS_JSON_DECODER_99_018:[ A JSON value MUST be an object, array, number, or string, or one of the following three literal names: false null true] */
-    else if (*(parserState->json) == '[')
-    {
-        result = ParseArray(parserState, currentNode);
-        *stringBegin = NULL;
-    }
-    else if (*(parserState->json) == '{')
-    {
-        result = ParseObject(parserState, currentNode);
-        *stringBegin = NULL;
-    }
     else if (
         (
             ISDIGIT(*(parserState->json))
         )
         || (*(parserState->json) == '-'))
     {
-        *stringBegin = parserState->json;
         result = ParseNumber(parserState);
     }
     else
@@ -317,46 +385,31 @@ static JSON_DECODER_RESULT ParseOpenCurly(PARSER_STATE* parserState)
     return result;
 }
 
-static JSON_DECODER_RESULT ParseNameValuePair(PARSER_STATE* parserState, MULTITREE_HANDLE currentNode)
+static JSON_DECODER_RESULT ParseValue(PARSER_STATE* parserState, const JSON_DECODER_EVENTS* events, void* context, const char* name, size_t nameLength)
 {
     JSON_DECODER_RESULT result;
-    char* memberNameBegin;
 
     SkipWhiteSpaces(parserState);
 
-    /* Codes_SRS_JSON_DECODER_99_022:[ A name is a string.] */
-    result = ParseString(parserState, &memberNameBegin);
-    if (result == JSON_DECODER_OK)
+    if (*(parserState->json) == '[')
     {
-        char* valueBegin;
-        MULTITREE_HANDLE childNode;
-        *(parserState->json - 1) = 0;
-
-        result = ParseColon(parserState);
+        result = ParseArray(parserState, events, context, name, nameLength);
+    }
+    else if (*(parserState->json) == '{')
+    {
+        result = ParseObject(parserState, events, context, name, nameLength);
+    }
+    else
+    {
+        const char* valueBegin = parserState->json;
+        result = ParseScalar(parserState);
         if (result == JSON_DECODER_OK)
         {
-            /* Codes_SRS_JSON_DECODER_99_025:[ The names within an object SHOULD be unique.] */
-            /* Multi Tree takes care of not having 2 children with the same name */
-            /* Codes_SRS_JSON_DECODER_99_002:[ JSONDecoder_JSON_To_MultiTree shall use the MultiTree APIs to create the multi tree and add leafs to the multi tree.] */
-            /* Codes_SRS_JSON_DECODER_99_003:[ When a JSON element is decoded from the JSON object then a leaf shall be added to the MultiTree.] */
-            /* Codes_SRS_JSON_DECODER_99_004:[ The leaf node name in the multi tree shall be the JSON element name.] */
-            if (MultiTree_AddChild(currentNode, memberNameBegin + 1, &childNode) != MULTITREE_OK)
-            {
-                /* Codes_SRS_JSON_DECODER_99_038:[ If any MultiTree API fails, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_MULTITREE_FAILED.] */
-                result = JSON_DECODER_MULTITREE_FAILED;
-            }
-            else
+            /* Codes_SRS_JSON_DECODER_09_005: [ For every string, number and literal name JSONDecoder_JSON_To_Events shall call onValue with the name of the value and with the text of the value as it appears in json, including the quotes of strings. ]*/
+            if (events->onValue(context, name, nameLength, valueBegin, (size_t)(parserState->json - valueBegin)) != 0)
             {
-                result = ParseValue(parserState, childNode, &valueBegin);
-                if ((result == JSON_DECODER_OK) && (valueBegin != NULL))
-                {
-                    /* Codes_SRS_JSON_DECODER_99_005:[ The leaf node added in the multi tree shall have the value the string value of the JSON element as parsed from the JSON object.] */
-                    if (MultiTree_SetValue(childNode, valueBegin) != MULTITREE_OK)
-                    {
-                        /* Codes_SRS_JSON_DECODER_99_038:[ If any MultiTree API fails, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_MULTITREE_FAILED.] */
-                        result = JSON_DECODER_MULTITREE_FAILED;
-                    }
-                }
+                /* Codes_SRS_JSON_DECODER_09_007: [ If any callback returns a non-zero value then JSONDecoder_JSON_To_Events shall stop parsing and return JSON_DECODER_ERROR. ]*/
+                result = JSON_DECODER_ERROR;
             }
         }
     }
@@ -364,55 +417,84 @@ static JSON_DECODER_RESULT ParseNameValuePair(PARSER_STATE* parserState, MULTITR
     return result;
 }
 
-static JSON_DECODER_RESULT ParseObject(PARSER_STATE* parserState, MULTITREE_HANDLE currentNode)
+static JSON_DECODER_RESULT ParseObject(PARSER_STATE* parserState, const JSON_DECODER_EVENTS* events, void* context, const char* name, size_t nameLength)
 {
     JSON_DECODER_RESULT result = ParseOpenCurly(parserState);
     if (result == JSON_DECODER_OK)
     {
-        char jsonChar;
-
-        SkipWhiteSpaces(parserState);
-
-        jsonChar = *(parserState->json);
-        while ((jsonChar != '}') && (jsonChar != '\0'))
+        /* Codes_SRS_JSON_DECODER_09_004: [ For every object and array JSONDecoder_JSON_To_Events shall call onBeginObject/onBeginArray with the name of the object or array and onEndObject/onEndArray after its last member or element. ]*/
+        if (events->onBeginObject(context, name, nameLength) != 0)
         {
-            char* valueEnd;
+            /* Codes_SRS_JSON_DECODER_09_007: [ If any callback returns a non-zero value then JSONDecoder_JSON_To_Events shall stop parsing and return JSON_DECODER_ERROR. ]*/
+            result = JSON_DECODER_ERROR;
+        }
+        else
+        {
+            char jsonChar;
 
-            /* decode each value */
-            result = ParseNameValuePair(parserState, currentNode);
-            if (result != JSON_DECODER_OK)
+            SkipWhiteSpaces(parserState);
+
+            jsonChar = *(parserState->json);
+            while ((jsonChar != '}') && (jsonChar != '\0'))
             {
-                break;
-            }
+                char* memberNameBegin;
 
-            valueEnd = parserState->json;
+                SkipWhiteSpaces(parserState);
 
-            SkipWhiteSpaces(parserState);
-            jsonChar = *(parserState->json);
-            *valueEnd = 0;
+                /* Codes_SRS_JSON_DECODER_99_022:[ A name is a string.] */
+                result = ParseString(parserState, &memberNameBegin);
+                if (result == JSON_DECODER_OK)
+                {
+                    /* Codes_SRS_JSON_DECODER_09_006: [ Names shall be passed as the characters between the quotes, not unescaped and not '\0' terminated, together with their length. ]*/
+                    size_t memberNameLength = (size_t)(parserState->json - memberNameBegin) - 2;
 
-            /* Codes_SRS_JSON_DECODER_99_024:[ A single comma separates a value from a following name.] */
-            if (jsonChar == ',')
-            {
-                parserState->json++;
-                /* get the next name/value pair */
+                    result = ParseColon(parserState);
+                    if (result == JSON_DECODER_OK)
+                    {
+                        result = ParseValue(parserState, events, context, memberNameBegin + 1, memberNameLength);
+                    }
+                }
+
+                if (result != JSON_DECODER_OK)
+                {
+                    break;
+                }
+
+                SkipWhiteSpaces(parserState);
+                jsonChar = *(parserState->json);
+
+                /* Codes_SRS_JSON_DECODER_99_024:[ A single comma separates a value from a following name.] */
+                if (jsonChar == ',')
+                {
+                    parserState->json++;
+                    /* get the next name/value pair */
+                }
+                else if (jsonChar != '}')
+                {
+                    /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+                    /* Codes_SRS_JSON_DECODER_09_008: [ If json is malformed, JSONDecoder_JSON_To_Events shall return JSON_DECODER_PARSE_ERROR; the callbacks made until the error was found are not undone. ]*/
+                    result = JSON_DECODER_PARSE_ERROR;
+                    break;
+                }
             }
-        }
 
-        if (result != JSON_DECODER_OK)
-        {
-            /* already have error */
-        }
-        else
-        {
-            if (jsonChar != '}')
+            if (result != JSON_DECODER_OK)
             {
-                /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+                /* already have error */
+            }
+            else if (jsonChar != '}')
+            {
+                /* Codes_SRS_JSON_DECODER_09_008: [ If json is malformed, JSONDecoder_JSON_To_Events shall return JSON_DECODER_PARSE_ERROR; the callbacks made until the error was found are not undone. ]*/
                 result = JSON_DECODER_PARSE_ERROR;
             }
             else
             {
                 parserState->json++;
+                if (events->onEndObject(context) != 0)
+                {
+                    /* Codes_SRS_JSON_DECODER_09_007: [ If any callback returns a non-zero value then JSONDecoder_JSON_To_Events shall stop parsing and return JSON_DECODER_ERROR. ]*/
+                    result = JSON_DECODER_ERROR;
+                }
             }
         }
     }
@@ -420,23 +502,27 @@ static JSON_DECODER_RESULT ParseObject(PARSER_STATE* parserState, MULTITREE_HAND
     return result;
 }
 
-static JSON_DECODER_RESULT ParseArray(PARSER_STATE* parserState, MULTITREE_HANDLE currentNode)
+static JSON_DECODER_RESULT ParseArray(PARSER_STATE* parserState, const JSON_DECODER_EVENTS* events, void* context, const char* name, size_t nameLength)
 {
-    JSON_DECODER_RESULT result = JSON_DECODER_OK;
+    JSON_DECODER_RESULT result;
 
     SkipWhiteSpaces(parserState);
 
     /* Codes_SRS_JSON_DECODER_99_026:[ An array structure is represented as square brackets surrounding zero or more values (or elements).] */
     if (*(parserState->json) != '[')
     {
-        /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+        /* Codes_SRS_JSON_DECODER_09_008: [ If json is malformed, JSONDecoder_JSON_To_Events shall return JSON_DECODER_PARSE_ERROR; the callbacks made until the error was found are not undone. ]*/
         result = JSON_DECODER_PARSE_ERROR;
     }
+    /* Codes_SRS_JSON_DECODER_09_004: [ For every object and array JSONDecoder_JSON_To_Events shall call onBeginObject/onBeginArray with the name of the object or array and onEndObject/onEndArray after its last member or element. ]*/
+    else if (events->onBeginArray(context, name, nameLength) != 0)
+    {
+        /* Codes_SRS_JSON_DECODER_09_007: [ If any callback returns a non-zero value then JSONDecoder_JSON_To_Events shall stop parsing and return JSON_DECODER_ERROR. ]*/
+        result = JSON_DECODER_ERROR;
+    }
     else
     {
-        char* stringBegin;
         char jsonChar;
-        int arrayIndex = 0;
         result = JSON_DECODER_OK;
 
         parserState->json++;
@@ -446,65 +532,31 @@ static JSON_DECODER_RESULT ParseArray(PARSER_STATE* parserState, MULTITREE_HANDL
         jsonChar = *parserState->json;
         while ((jsonChar != ']') && (jsonChar != '\0'))
         {
-            char arrayIndexStr[22];
-            MULTITREE_HANDLE childNode;
-
-            /* Codes_SRS_JSON_DECODER_99_039:[ For array elements the multi tree node name shall be the string representation of the array index.] */
-            if (sprintf(arrayIndexStr, "%d", arrayIndex++) < 0)
+            /* array elements have no name */
+            result = ParseValue(parserState, events, context, NULL, 0);
+            if (result != JSON_DECODER_OK)
             {
-                result = JSON_DECODER_ERROR;
                 break;
             }
-            /* Codes_SRS_JSON_DECODER_99_003:[ When a JSON element is decoded from the JSON object then a leaf shall be added to the MultiTree.] */
-            else if (MultiTree_AddChild(currentNode, arrayIndexStr, &childNode) != MULTITREE_OK)
+
+            SkipWhiteSpaces(parserState);
+            jsonChar = *(parserState->json);
+
+            /* Codes_SRS_JSON_DECODER_99_027:[ Elements are separated by commas.] */
+            if (jsonChar == ',')
+            {
+                parserState->json++;
+                /* get the next value */
+            }
+            else if (jsonChar == ']')
             {
-                /* Codes_SRS_JSON_DECODER_99_038:[ If any MultiTree API fails, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_MULTITREE_FAILED.] */
-                result = JSON_DECODER_MULTITREE_FAILED;
+                break;
             }
             else
             {
-                char* valueEnd;
-
-                /* decode each value */
-                result = ParseValue(parserState, childNode, &stringBegin);
-                if (result != JSON_DECODER_OK)
-                {
-                    break;
-                }
-
-                if (stringBegin != NULL)
-                {
-                    /* Codes_SRS_JSON_DECODER_99_005:[ The leaf node added in the multi tree shall have the value the string value of the JSON element as parsed from the JSON object.] */
-                    if (MultiTree_SetValue(childNode, stringBegin) != MULTITREE_OK)
-                    {
-                        /* Codes_SRS_JSON_DECODER_99_038:[ If any MultiTree API fails, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_MULTITREE_FAILED.] */
-                        result = JSON_DECODER_MULTITREE_FAILED;
-                        break;
-                    }
-                }
-
-                valueEnd = parserState->json;
-
-                SkipWhiteSpaces(parserState);
-                jsonChar = *(parserState->json);
-                *valueEnd = 0;
-
-                /* Codes_SRS_JSON_DECODER_99_027:[ Elements are separated by commas.] */
-                if (jsonChar == ',')
-                {
-                    parserState->json++;
-                    /* get the next value pair */
-                }
-                else if (jsonChar == ']')
-                {
-                    break;
-                }
-                else
-                {
-                    /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
-                    result = JSON_DECODER_PARSE_ERROR;
-                    break;
-                }
+                /* Codes_SRS_JSON_DECODER_09_008: [ If json is malformed, JSONDecoder_JSON_To_Events shall return JSON_DECODER_PARSE_ERROR; the callbacks made until the error was found are not undone. ]*/
+                result = JSON_DECODER_PARSE_ERROR;
+                break;
             }
         }
 
@@ -512,17 +564,19 @@ static JSON_DECODER_RESULT ParseArray(PARSER_STATE* parserState, MULTITREE_HANDL
         {
             /* already have error */
         }
+        else if (jsonChar != ']')
+        {
+            /* Codes_SRS_JSON_DECODER_09_008: [ If json is malformed, JSONDecoder_JSON_To_Events shall return JSON_DECODER_PARSE_ERROR; the callbacks made until the error was found are not undone. ]*/
+            result = JSON_DECODER_PARSE_ERROR;
+        }
         else
         {
-            if (jsonChar != ']')
-            {
-                /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
-                result = JSON_DECODER_PARSE_ERROR;
-            }
-            else
+            parserState->json++;
+            SkipWhiteSpaces(parserState);
+            if (events->onEndArray(context) != 0)
             {
-                parserState->json++;
-                SkipWhiteSpaces(parserState);
+                /* Codes_SRS_JSON_DECODER_09_007: [ If any callback returns a non-zero value then JSONDecoder_JSON_To_Events shall stop parsing and return JSON_DECODER_ERROR. ]*/
+                result = JSON_DECODER_ERROR;
             }
         }
     }
@@ -530,26 +584,46 @@ static JSON_DECODER_RESULT ParseArray(PARSER_STATE* parserState, MULTITREE_HANDL
     return result;
 }
 
+/*destination has room for the 20 digits of the largest size_t and the '\0'*/
+static void ArrayIndexToString(size_t arrayIndex, char* destination)
+{
+    char digits[21];
+    size_t digitCount = 0;
+
+    do
+    {
+        digits[digitCount++] = (char)('0' + (arrayIndex % 10));
+        arrayIndex /= 10;
+    } while (arrayIndex != 0);
+
+    while (digitCount > 0)
+    {
+        *destination++ = digits[--digitCount];
+    }
+    *destination = '\0';
+}
+
 /* Codes_SRS_JSON_DECODER_99_012:[ A JSON text is a serialized object or array.] */
-static JSON_DECODER_RESULT ParseObjectOrArray(PARSER_STATE* parserState, MULTITREE_HANDLE currentNode)
+static JSON_DECODER_RESULT ParseJSON(PARSER_STATE* parserState, const JSON_DECODER_EVENTS* events, void* context)
 {
-    JSON_DECODER_RESULT result = JSON_DECODER_PARSE_ERROR;
+    JSON_DECODER_RESULT result;
 
     SkipWhiteSpaces(parserState);
 
+    /* Codes_SRS_JSON_DECODER_09_004: [ For every object and array JSONDecoder_JSON_To_Events shall call onBeginObject/onBeginArray with the name of the object or array and onEndObject/onEndArray after its last member or element. ]*/
     if (*(parserState->json) == '{')
     {
-        result = ParseObject(parserState, currentNode);
+        result = ParseObject(parserState, events, context, NULL, 0);
         SkipWhiteSpaces(parserState);
     }
     else if (*(parserState->json) == '[')
     {
-        result = ParseArray(parserState, currentNode);
-        SkipWhiteSpaces(parserState);
+        result = ParseArray(parserState, events, context, NULL, 0);
     }
     else
     {
         /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+        /* Codes_SRS_JSON_DECODER_09_008: [ If json is malformed, JSONDecoder_JSON_To_Events shall return JSON_DECODER_PARSE_ERROR; the callbacks made until the error was found are not undone. ]*/
         result = JSON_DECODER_PARSE_ERROR;
     }
 
@@ -557,20 +631,190 @@ static JSON_DECODER_RESULT ParseObjectOrArray(PARSER_STATE* parserState, MULTITR
         (*(parserState->json) != '\0'))
     {
         /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+        /* Codes_SRS_JSON_DECODER_09_008: [ If json is malformed, JSONDecoder_JSON_To_Events shall return JSON_DECODER_PARSE_ERROR; the callbacks made until the error was found are not undone. ]*/
         result = JSON_DECODER_PARSE_ERROR;
     }
 
     return result;
 }
 
-static JSON_DECODER_RESULT ParseJSON(char* json, MULTITREE_HANDLE currentNode)
+/*JSONDecoder_JSON_To_MultiTree builds the multi tree from the events of the parser. There is one frame for every object or array that is open*/
+typedef struct MULTITREE_BUILDER_FRAME_TAG
+{
+    MULTITREE_HANDLE node;
+    int isArray;
+    size_t arrayIndex;
+} MULTITREE_BUILDER_FRAME;
+
+typedef struct MULTITREE_BUILDER_TAG
 {
-    /* Codes_SRS_JSON_DECODER_99_009:[ On success, JSONDecoder_JSON_To_MultiTree shall return a handle to the multi tree it created in the multiTreeHandle argument and it shall return JSON_DECODER_OK.] */
-    PARSER_STATE parseState;
-    parseState.json = json;
-    return ParseObjectOrArray(&parseState, currentNode);
+    MULTITREE_HANDLE root;
+    MULTITREE_BUILDER_FRAME* frames;
+    size_t frameCount;
+    size_t frameCapacity;
+    /*the character right behind the last value. onValue is called before the parser looks at it, so it is set to '\0' by the next callback*/
+    char* valueEnd;
+    /*what JSONDecoder_JSON_To_MultiTree returns when a callback fails*/
+    JSON_DECODER_RESULT failure;
+} MULTITREE_BUILDER;
+
+/* Codes_SRS_JSON_DECODER_99_049:[ JSONDecoder shall not allocate new string values for the leafs, but rather point to strings in the original JSON.] */
+/*the text given to JSONDecoder_JSON_To_MultiTree is writable, the names and values are '\0' terminated in place once the parser is past them*/
+static void BuilderTerminateValue(MULTITREE_BUILDER* builder)
+{
+    if (builder->valueEnd != NULL)
+    {
+        *(builder->valueEnd) = '\0';
+        builder->valueEnd = NULL;
+    }
 }
 
+static int BuilderAddChild(MULTITREE_BUILDER* builder, const char* name, size_t nameLength, MULTITREE_HANDLE* childNode)
+{
+    int result;
+    MULTITREE_BUILDER_FRAME* parent = &builder->frames[builder->frameCount - 1];
+    char arrayIndexStr[22];
+    const char* childName;
+
+    BuilderTerminateValue(builder);
+
+    if (parent->isArray)
+    {
+        /* Codes_SRS_JSON_DECODER_99_039:[ For array elements the multi tree node name shall be the string representation of the array index.] */
+        ArrayIndexToString(parent->arrayIndex++, arrayIndexStr);
+        childName = arrayIndexStr;
+    }
+    else
+    {
+        /*the closing quote of the name*/
+        ((char*)name)[nameLength] = '\0';
+        childName = name;
+    }
+
+    /* Codes_SRS_JSON_DECODER_99_025:[ The names within an object SHOULD be unique.] */
+    /* Multi Tree takes care of not having 2 children with the same name */
+    /* Codes_SRS_JSON_DECODER_99_002:[ JSONDecoder_JSON_To_MultiTree shall use the MultiTree APIs to create the multi tree and add leafs to the multi tree.] */
+    /* Codes_SRS_JSON_DECODER_99_003:[ When a JSON element is decoded from the JSON object then a leaf shall be added to the MultiTree.] */
+    /* Codes_SRS_JSON_DECODER_99_004:[ The leaf node name in the multi tree shall be the JSON element name.] */
+    if (MultiTree_AddChild(parent->node, childName, childNode) != MULTITREE_OK)
+    {
+        /* Codes_SRS_JSON_DECODER_99_038:[ If any MultiTree API fails, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_MULTITREE_FAILED.] */
+        builder->failure = JSON_DECODER_MULTITREE_FAILED;
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+static int BuilderOnBegin(MULTITREE_BUILDER* builder, const char* name, size_t nameLength, int isArray)
+{
+    int result;
+    MULTITREE_HANDLE node;
+
+    if (builder->frameCount == 0)
+    {
+        /*the outermost object or array is the root of the tree*/
+        node = builder->root;
+        result = 0;
+    }
+    else
+    {
+        result = BuilderAddChild(builder, name, nameLength, &node);
+    }
+
+    if (result != 0)
+    {
+        /*already have error*/
+    }
+    else
+    {
+        if (builder->frameCount == builder->frameCapacity)
+        {
+            size_t newCapacity = (builder->frameCapacity == 0) ? 4 : (builder->frameCapacity * 2);
+            MULTITREE_BUILDER_FRAME* newFrames = (MULTITREE_BUILDER_FRAME*)realloc(builder->frames, newCapacity * sizeof(MULTITREE_BUILDER_FRAME));
+            if (newFrames != NULL)
+            {
+                builder->frames = newFrames;
+                builder->frameCapacity = newCapacity;
+            }
+        }
+
+        if (builder->frameCount == builder->frameCapacity)
+        {
+            /* Codes_SRS_JSON_DECODER_09_010: [ If JSONDecoder_JSON_To_MultiTree fails allocating memory it shall return JSON_DECODER_ERROR. ]*/
+            builder->failure = JSON_DECODER_ERROR;
+            result = __FAILURE__;
+        }
+        else
+        {
+            builder->frames[builder->frameCount].node = node;
+            builder->frames[builder->frameCount].isArray = isArray;
+            builder->frames[builder->frameCount].arrayIndex = 0;
+            builder->frameCount++;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static int BuilderOnBeginObject(void* context, const char* name, size_t nameLength)
+{
+    return BuilderOnBegin((MULTITREE_BUILDER*)context, name, nameLength, 0);
+}
+
+static int BuilderOnBeginArray(void* context, const char* name, size_t nameLength)
+{
+    return BuilderOnBegin((MULTITREE_BUILDER*)context, name, nameLength, 1);
+}
+
+static int BuilderOnEnd(void* context)
+{
+    MULTITREE_BUILDER* builder = (MULTITREE_BUILDER*)context;
+    BuilderTerminateValue(builder);
+    builder->frameCount--;
+    return 0;
+}
+
+static int BuilderOnValue(void* context, const char* name, size_t nameLength, const char* value, size_t valueLength)
+{
+    int result;
+    MULTITREE_BUILDER* builder = (MULTITREE_BUILDER*)context;
+    MULTITREE_HANDLE childNode;
+
+    if (BuilderAddChild(builder, name, nameLength, &childNode) != 0)
+    {
+        result = __FAILURE__;
+    }
+    /* Codes_SRS_JSON_DECODER_99_005:[ The leaf node added in the multi tree shall have the value the string value of the JSON element as parsed from the JSON object.] */
+    else if (MultiTree_SetValue(childNode, (void*)value) != MULTITREE_OK)
+    {
+        /* Codes_SRS_JSON_DECODER_99_038:[ If any MultiTree API fails, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_MULTITREE_FAILED.] */
+        builder->failure = JSON_DECODER_MULTITREE_FAILED;
+        result = __FAILURE__;
+    }
+    else
+    {
+        builder->valueEnd = (char*)value + valueLength;
+        result = 0;
+    }
+
+    return result;
+}
+
+static const JSON_DECODER_EVENTS multiTreeBuilderEvents =
+{
+    BuilderOnBeginObject,
+    BuilderOnEnd,
+    BuilderOnBeginArray,
+    BuilderOnEnd,
+    BuilderOnValue
+};
+
 JSON_DECODER_RESULT JSONDecoder_JSON_To_MultiTree(char* json, MULTITREE_HANDLE* multiTreeHandle)
 {
     JSON_DECODER_RESULT result;
@@ -599,13 +843,62 @@ JSON_DECODER_RESULT JSONDecoder_JSON_To_MultiTree(char* json, MULTITREE_HANDLE*
         }
         else
         {
-            result = ParseJSON(json, *multiTreeHandle);
+            MULTITREE_BUILDER builder;
+            PARSER_STATE parserState;
+
+            builder.root = *multiTreeHandle;
+            builder.frames = NULL;
+            builder.frameCount = 0;
+            builder.frameCapacity = 0;
+            builder.valueEnd = NULL;
+            builder.failure = JSON_DECODER_ERROR;
+
+            parserState.json = json;
+            parserState.end = json + strlen(json);
+
+            result = ParseJSON(&parserState, &multiTreeBuilderEvents, &builder);
+            if (result == JSON_DECODER_ERROR)
+            {
+                result = builder.failure;
+            }
+
             if (result != JSON_DECODER_OK)
             {
                 MultiTree_Destroy(*multiTreeHandle);
             }
+
+            free(builder.frames);
         }
     }
 
     return result;
 }
+
+JSON_DECODER_RESULT JSONDecoder_JSON_To_Events(const char* json, const JSON_DECODER_EVENTS* events, void* context)
+{
+    JSON_DECODER_RESULT result;
+
+    /* Codes_SRS_JSON_DECODER_09_002: [ If json or events is NULL, or any of the callbacks in events is NULL, JSONDecoder_JSON_To_Events shall return JSON_DECODER_INVALID_ARG. ]*/
+    if ((json == NULL) ||
+        (events == NULL) ||
+        (events->onBeginObject == NULL) ||
+        (events->onEndObject == NULL) ||
+        (events->onBeginArray == NULL) ||
+        (events->onEndArray == NULL) ||
+        (events->onValue == NULL))
+    {
+        result = JSON_DECODER_INVALID_ARG;
+    }
+    else
+    {
+        /* Codes_SRS_JSON_DECODER_09_003: [ JSONDecoder_JSON_To_Events shall parse json in one pass without writing into it and without allocating memory. ]*/
+        PARSER_STATE parserState;
+        parserState.json = (char*)json;
+        parserState.end = json + strlen(json);
+
+        /* Codes_SRS_JSON_DECODER_09_009: [ Otherwise JSONDecoder_JSON_To_Events shall return JSON_DECODER_OK. ]*/
+        result = ParseJSON(&parserState, events, context);
+    }
+
+    return result;
+}
@@ -7,6 +7,7 @@
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/strings.h"
+#include "jsonwriter.h"
 
 #ifdef _MSC_VER
 #pragma warning(disable: 4701) /* potentially uninitialized local variable 'result' used */ /* the scanner cannot track variable "i" and link it to childCount*/
@@ -190,6 +191,131 @@ JSON_ENCODER_RESULT JSONEncoder_EncodeTree(MULTITREE_HANDLE treeHandle, STRING_H
 #endif
 }
 
+static JSON_ENCODER_RESULT encodeTreeToWriter(MULTITREE_HANDLE treeHandle, JSON_WRITER_HANDLE writer, JSON_ENCODER_TOSTRING_FUNC toStringFunc, STRING_HANDLE valueText)
+{
+    JSON_ENCODER_RESULT result;
+    size_t childCount;
+
+    if (MultiTree_GetChildCount(treeHandle, &childCount) != MULTITREE_OK)
+    {
+        /*Codes_SRS_JSON_ENCODER_09_003: [ If any MultiTree function call fails JSONEncoder_EncodeTreeToWriter shall return JSON_ENCODER_MULTITREE_ERROR. ]*/
+        result = JSON_ENCODER_MULTITREE_ERROR;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+    }
+    /*Codes_SRS_JSON_ENCODER_09_005: [ For every node JSONEncoder_EncodeTreeToWriter shall call JSONWriter_BeginObject, then JSONWriter_AppendName with the name of every child as returned by MultiTree_GetNamePtr, followed by the child's value, then JSONWriter_EndObject. ]*/
+    else if (JSONWriter_BeginObject(writer) != JSON_WRITER_OK)
+    {
+        /*Codes_SRS_JSON_ENCODER_09_009: [ If any JSONWriter or STRING function call fails JSONEncoder_EncodeTreeToWriter shall return JSON_ENCODER_ERROR. ]*/
+        result = JSON_ENCODER_ERROR;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+    }
+    else
+    {
+        size_t i;
+        result = JSON_ENCODER_OK;
+        for (i = 0; (i < childCount) && (result == JSON_ENCODER_OK); i++)
+        {
+            MULTITREE_HANDLE childTreeHandle;
+            const char* name;
+            size_t innerChildCount;
+
+            if ((MultiTree_GetChild(treeHandle, i, &childTreeHandle) != MULTITREE_OK) ||
+                (MultiTree_GetNamePtr(childTreeHandle, &name) != MULTITREE_OK))
+            {
+                result = JSON_ENCODER_MULTITREE_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+            }
+            else if (JSONWriter_AppendName(writer, name) != JSON_WRITER_OK)
+            {
+                result = JSON_ENCODER_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+            }
+            else if (MultiTree_GetChildCount(childTreeHandle, &innerChildCount) != MULTITREE_OK)
+            {
+                result = JSON_ENCODER_MULTITREE_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+            }
+            else if (innerChildCount > 0)
+            {
+                /*Codes_SRS_JSON_ENCODER_09_006: [ A child that has children shall be written as a nested object into the same writer. ]*/
+                result = encodeTreeToWriter(childTreeHandle, writer, toStringFunc, valueText);
+            }
+            else
+            {
+                const void* value;
+                if (MultiTree_GetValue(childTreeHandle, &value) != MULTITREE_OK)
+                {
+                    result = JSON_ENCODER_MULTITREE_ERROR;
+                    LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+                }
+                /*Codes_SRS_JSON_ENCODER_09_007: [ For a child with zero children the STRING shared by all the children shall be emptied with STRING_empty, toStringFunc shall be called with that STRING and the value of the child, and the content of the STRING shall be written with JSONWriter_AppendRaw. ]*/
+                else if (STRING_empty(valueText) != 0)
+                {
+                    /*Codes_SRS_JSON_ENCODER_09_009: [ If any JSONWriter or STRING function call fails JSONEncoder_EncodeTreeToWriter shall return JSON_ENCODER_ERROR. ]*/
+                    result = JSON_ENCODER_ERROR;
+                    LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+                }
+                else if (toStringFunc(valueText, value) != JSON_ENCODER_TOSTRING_OK)
+                {
+                    /*Codes_SRS_JSON_ENCODER_09_008: [ If toStringFunc fails JSONEncoder_EncodeTreeToWriter shall return JSON_ENCODER_TOSTRING_FUNCTION_ERROR. ]*/
+                    result = JSON_ENCODER_TOSTRING_FUNCTION_ERROR;
+                    LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+                }
+                else if (JSONWriter_AppendRaw(writer, STRING_c_str(valueText), STRING_length(valueText)) != JSON_WRITER_OK)
+                {
+                    result = JSON_ENCODER_ERROR;
+                    LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+                }
+                else
+                {
+                    /*do nothing, result = JSON_ENCODER_OK is set above at the beginning of the FOR loop*/
+                }
+            }
+        }
+
+        if ((result == JSON_ENCODER_OK) &&
+            (JSONWriter_EndObject(writer) != JSON_WRITER_OK))
+        {
+            result = JSON_ENCODER_ERROR;
+            LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+        }
+    }
+
+    return result;
+}
+
+JSON_ENCODER_RESULT JSONEncoder_EncodeTreeToWriter(MULTITREE_HANDLE treeHandle, JSON_WRITER_HANDLE writer, JSON_ENCODER_TOSTRING_FUNC toStringFunc)
+{
+    JSON_ENCODER_RESULT result;
+
+    /*Codes_SRS_JSON_ENCODER_09_001: [ If any of the arguments passed to JSONEncoder_EncodeTreeToWriter is NULL then JSON_ENCODER_INVALID_ARG shall be returned. ]*/
+    if ((treeHandle == NULL) ||
+        (writer == NULL) ||
+        (toStringFunc == NULL))
+    {
+        result = JSON_ENCODER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+    }
+    else
+    {
+        /*Codes_SRS_JSON_ENCODER_09_004: [ JSONEncoder_EncodeTreeToWriter shall create a single STRING that is used for formatting all the values of the tree. ]*/
+        STRING_HANDLE valueText = STRING_new();
+        if (valueText == NULL)
+        {
+            result = JSON_ENCODER_ERROR;
+            LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+        }
+        else
+        {
+            /*Codes_SRS_JSON_ENCODER_09_002: [ On success, JSONEncoder_EncodeTreeToWriter shall have appended the JSON object for the tree to writer and return JSON_ENCODER_OK. ]*/
+            result = encodeTreeToWriter(treeHandle, writer, toStringFunc, valueText);
+            STRING_delete(valueText);
+        }
+    }
+
+    return result;
+}
+
 JSON_ENCODER_TOSTRING_RESULT JSONEncoder_CharPtr_ToString(STRING_HANDLE destination, const void* value)
 {
     JSON_ENCODER_TOSTRING_RESULT result;
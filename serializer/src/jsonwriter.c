@@ -0,0 +1,483 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include <string.h>
+#include <math.h>
+
+#include "jsonwriter.h"
+#include "floatformat.h"
+#include "agenttypesystem.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+DEFINE_ENUM_STRINGS(JSON_WRITER_RESULT, JSON_WRITER_RESULT_VALUES);
+
+#define JSON_WRITER_DEFAULT_CAPACITY 256
+
+#define NaN_STRING "NaN"
+#define MINUSINF_STRING "-INF"
+#define PLUSINF_STRING "INF"
+
+/*the longest int64_t is "-9223372036854775808"*/
+#define MAX_INT64_STRING_LENGTH 20
+
+typedef struct JSON_WRITER_HANDLE_DATA_TAG
+{
+    unsigned char* buffer;
+    size_t size;
+    size_t capacity;
+    bool needsComma;
+} JSON_WRITER_HANDLE_DATA;
+
+static const char hexDigits[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+
+static int ensureCapacity(JSON_WRITER_HANDLE_DATA* writer, size_t extra)
+{
+    int result;
+    if (writer->size + extra <= writer->capacity)
+    {
+        result = 0;
+    }
+    else
+    {
+        /*Codes_SRS_JSONWRITER_09_005: [ When the buffer is too small, it shall grow to at least twice its current capacity so that appending is amortized constant time. ]*/
+        size_t newCapacity = (writer->capacity == 0) ? JSON_WRITER_DEFAULT_CAPACITY : writer->capacity * 2;
+        unsigned char* newBuffer;
+        if (newCapacity < writer->size + extra)
+        {
+            newCapacity = writer->size + extra;
+        }
+
+        if ((newBuffer = (unsigned char*)realloc(writer->buffer, newCapacity)) == NULL)
+        {
+            LogError("unable to realloc JSON writer buffer to %lu bytes", (unsigned long)newCapacity);
+            result = __FAILURE__;
+        }
+        else
+        {
+            writer->buffer = newBuffer;
+            writer->capacity = newCapacity;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+static JSON_WRITER_RESULT appendBytes(JSON_WRITER_HANDLE_DATA* writer, const char* bytes, size_t length)
+{
+    JSON_WRITER_RESULT result;
+    if (ensureCapacity(writer, length) != 0)
+    {
+        result = JSON_WRITER_ERROR;
+    }
+    else
+    {
+        (void)memcpy(writer->buffer + writer->size, bytes, length);
+        writer->size += length;
+        result = JSON_WRITER_OK;
+    }
+    return result;
+}
+
+JSON_WRITER_HANDLE JSONWriter_Create(size_t initialCapacity)
+{
+    JSON_WRITER_HANDLE_DATA* result;
+    if ((result = (JSON_WRITER_HANDLE_DATA*)malloc(sizeof(JSON_WRITER_HANDLE_DATA))) == NULL)
+    {
+        /*Codes_SRS_JSONWRITER_09_002: [ If any failure occurs, JSONWriter_Create shall fail and return NULL. ]*/
+        LogError("unable to malloc JSON writer");
+    }
+    else
+    {
+        /*Codes_SRS_JSONWRITER_09_001: [ JSONWriter_Create shall allocate a writer with a buffer of initialCapacity bytes (a default capacity when initialCapacity is 0) and return a non-NULL handle. ]*/
+        result->capacity = (initialCapacity == 0) ? JSON_WRITER_DEFAULT_CAPACITY : initialCapacity;
+        result->size = 0;
+        result->needsComma = false;
+        if ((result->buffer = (unsigned char*)malloc(result->capacity)) == NULL)
+        {
+            /*Codes_SRS_JSONWRITER_09_002: [ If any failure occurs, JSONWriter_Create shall fail and return NULL. ]*/
+            LogError("unable to malloc JSON writer buffer");
+            free(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+void JSONWriter_Destroy(JSON_WRITER_HANDLE handle)
+{
+    /*Codes_SRS_JSONWRITER_09_003: [ If handle is NULL, JSONWriter_Destroy shall return. ]*/
+    if (handle != NULL)
+    {
+        /*Codes_SRS_JSONWRITER_09_004: [ JSONWriter_Destroy shall free the buffer and the writer. ]*/
+        free(handle->buffer);
+        free(handle);
+    }
+}
+
+JSON_WRITER_RESULT JSONWriter_BeginObject(JSON_WRITER_HANDLE handle)
+{
+    JSON_WRITER_RESULT result;
+    if (handle == NULL)
+    {
+        /*Codes_SRS_JSONWRITER_09_006: [ If handle is NULL, all the JSONWriter_Append and JSONWriter_BeginObject/EndObject functions shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+    }
+    /*Codes_SRS_JSONWRITER_09_007: [ JSONWriter_BeginObject shall append "{" and the next name appended shall not be preceded by a separator. ]*/
+    else if ((result = appendBytes(handle, "{", 1)) != JSON_WRITER_OK)
+    {
+        /*Codes_SRS_JSONWRITER_09_008: [ If growing the buffer fails, the appending function shall return JSON_WRITER_ERROR. ]*/
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+    }
+    else
+    {
+        handle->needsComma = false;
+    }
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_EndObject(JSON_WRITER_HANDLE handle)
+{
+    JSON_WRITER_RESULT result;
+    if (handle == NULL)
+    {
+        /*Codes_SRS_JSONWRITER_09_006: [ If handle is NULL, all the JSONWriter_Append and JSONWriter_BeginObject/EndObject functions shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+    }
+    /*Codes_SRS_JSONWRITER_09_009: [ JSONWriter_EndObject shall append "}"; the object just closed counts as a value of the enclosing object. ]*/
+    else if ((result = appendBytes(handle, "}", 1)) != JSON_WRITER_OK)
+    {
+        /*Codes_SRS_JSONWRITER_09_008: [ If growing the buffer fails, the appending function shall return JSON_WRITER_ERROR. ]*/
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+    }
+    else
+    {
+        handle->needsComma = true;
+    }
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_AppendName(JSON_WRITER_HANDLE handle, const char* name)
+{
+    JSON_WRITER_RESULT result;
+    if ((handle == NULL) || (name == NULL))
+    {
+        /*Codes_SRS_JSONWRITER_09_006: [ If handle is NULL, all the JSONWriter_Append and JSONWriter_BeginObject/EndObject functions shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+        /*Codes_SRS_JSONWRITER_09_010: [ If name is NULL, JSONWriter_AppendName shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("invalid arg JSON_WRITER_HANDLE handle=%p, const char* name=%p", handle, name);
+    }
+    else
+    {
+        size_t nameLength = strlen(name);
+        size_t separatorLength = handle->needsComma ? 2 : 0;
+        /*Codes_SRS_JSONWRITER_09_011: [ JSONWriter_AppendName shall append ", " if a member was already written in the current object, followed by "\"", name and "\":". ]*/
+        if (ensureCapacity(handle, separatorLength + 1 + nameLength + 2) != 0)
+        {
+            /*Codes_SRS_JSONWRITER_09_008: [ If growing the buffer fails, the appending function shall return JSON_WRITER_ERROR. ]*/
+            result = JSON_WRITER_ERROR;
+            LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+        }
+        else
+        {
+            unsigned char* position = handle->buffer + handle->size;
+            if (handle->needsComma)
+            {
+                *position++ = ',';
+                *position++ = ' ';
+            }
+            *position++ = '"';
+            (void)memcpy(position, name, nameLength);
+            position += nameLength;
+            *position++ = '"';
+            *position++ = ':';
+            handle->size = (size_t)(position - handle->buffer);
+            handle->needsComma = true;
+            result = JSON_WRITER_OK;
+        }
+    }
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_AppendRaw(JSON_WRITER_HANDLE handle, const char* value, size_t length)
+{
+    JSON_WRITER_RESULT result;
+    if ((handle == NULL) || (value == NULL))
+    {
+        /*Codes_SRS_JSONWRITER_09_006: [ If handle is NULL, all the JSONWriter_Append and JSONWriter_BeginObject/EndObject functions shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+        /*Codes_SRS_JSONWRITER_09_012: [ If value is NULL, JSONWriter_AppendRaw shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("invalid arg JSON_WRITER_HANDLE handle=%p, const char* value=%p", handle, value);
+    }
+    /*Codes_SRS_JSONWRITER_09_013: [ JSONWriter_AppendRaw shall append the first length characters of value as they are. ]*/
+    else if ((result = appendBytes(handle, value, length)) != JSON_WRITER_OK)
+    {
+        /*Codes_SRS_JSONWRITER_09_008: [ If growing the buffer fails, the appending function shall return JSON_WRITER_ERROR. ]*/
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+    }
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_AppendString(JSON_WRITER_HANDLE handle, const char* value)
+{
+    JSON_WRITER_RESULT result;
+    if ((handle == NULL) || (value == NULL))
+    {
+        /*Codes_SRS_JSONWRITER_09_006: [ If handle is NULL, all the JSONWriter_Append and JSONWriter_BeginObject/EndObject functions shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+        /*Codes_SRS_JSONWRITER_09_014: [ If value is NULL, JSONWriter_AppendString shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("invalid arg JSON_WRITER_HANDLE handle=%p, const char* value=%p", handle, value);
+    }
+    else
+    {
+        size_t i;
+        size_t encodedLength = 2; /*the quotes*/
+
+        for (i = 0; value[i] != '\0'; i++)
+        {
+            unsigned char c = (unsigned char)value[i];
+            if (c >= 128)
+            {
+                break;
+            }
+            else if (c <= 0x1F)
+            {
+                encodedLength += 6;
+            }
+            else if ((c == '"') || (c == '\\') || (c == '/'))
+            {
+                encodedLength += 2;
+            }
+            else
+            {
+                encodedLength++;
+            }
+        }
+
+        if (value[i] != '\0')
+        {
+            /*Codes_SRS_JSONWRITER_09_015: [ If value contains characters above 127, JSONWriter_AppendString shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+            result = JSON_WRITER_INVALID_ARG;
+            LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+        }
+        else if (ensureCapacity(handle, encodedLength) != 0)
+        {
+            /*Codes_SRS_JSONWRITER_09_008: [ If growing the buffer fails, the appending function shall return JSON_WRITER_ERROR. ]*/
+            result = JSON_WRITER_ERROR;
+            LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+        }
+        else
+        {
+            /*Codes_SRS_JSONWRITER_09_016: [ JSONWriter_AppendString shall append value between quotes, escaping '"', '\\' and '/' with a backslash and control characters as \u00XX, exactly like AgentDataTypes_ToString does for EDM_STRING. ]*/
+            unsigned char* position = handle->buffer + handle->size;
+            *position++ = '"';
+            for (i = 0; value[i] != '\0'; i++)
+            {
+                unsigned char c = (unsigned char)value[i];
+                if (c <= 0x1F)
+                {
+                    *position++ = '\\';
+                    *position++ = 'u';
+                    *position++ = '0';
+                    *position++ = '0';
+                    *position++ = hexDigits[(c & 0xF0) >> 4];
+                    *position++ = hexDigits[c & 0x0F];
+                }
+                else if ((c == '"') || (c == '\\') || (c == '/'))
+                {
+                    *position++ = '\\';
+                    *position++ = c;
+                }
+                else
+                {
+                    *position++ = c;
+                }
+            }
+            *position++ = '"';
+            handle->size += encodedLength;
+            result = JSON_WRITER_OK;
+        }
+    }
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_AppendInt64(JSON_WRITER_HANDLE handle, int64_t value)
+{
+    JSON_WRITER_RESULT result;
+    if (handle == NULL)
+    {
+        /*Codes_SRS_JSONWRITER_09_006: [ If handle is NULL, all the JSONWriter_Append and JSONWriter_BeginObject/EndObject functions shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+    }
+    else
+    {
+        /*Codes_SRS_JSONWRITER_09_017: [ JSONWriter_AppendInt64 shall append the decimal representation of value, preceded by '-' for negative values. ]*/
+        char digits[MAX_INT64_STRING_LENGTH];
+        size_t pos = sizeof(digits);
+        /*work with the magnitude as unsigned so that INT64_MIN does not overflow*/
+        uint64_t magnitude = (value < 0) ? ((uint64_t)0 - (uint64_t)value) : (uint64_t)value;
+        do
+        {
+            digits[--pos] = (char)('0' + (magnitude % 10));
+            magnitude /= 10;
+        } while (magnitude != 0);
+
+        if (value < 0)
+        {
+            digits[--pos] = '-';
+        }
+
+        if ((result = appendBytes(handle, digits + pos, sizeof(digits) - pos)) != JSON_WRITER_OK)
+        {
+            /*Codes_SRS_JSONWRITER_09_008: [ If growing the buffer fails, the appending function shall return JSON_WRITER_ERROR. ]*/
+            LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+        }
+    }
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_AppendBool(JSON_WRITER_HANDLE handle, bool value)
+{
+    JSON_WRITER_RESULT result;
+    if (handle == NULL)
+    {
+        /*Codes_SRS_JSONWRITER_09_006: [ If handle is NULL, all the JSONWriter_Append and JSONWriter_BeginObject/EndObject functions shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+    }
+    /*Codes_SRS_JSONWRITER_09_018: [ JSONWriter_AppendBool shall append true or false. ]*/
+    else if ((result = (value ? appendBytes(handle, "true", 4) : appendBytes(handle, "false", 5))) != JSON_WRITER_OK)
+    {
+        /*Codes_SRS_JSONWRITER_09_008: [ If growing the buffer fails, the appending function shall return JSON_WRITER_ERROR. ]*/
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+    }
+    return result;
+}
+
+#ifndef NO_FLOATS
+static bool appendNonFinite(JSON_WRITER_HANDLE_DATA* writer, double value, JSON_WRITER_RESULT* result)
+{
+    bool isNonFinite = true;
+    /*Codes_SRS_JSONWRITER_09_020: [ NaN, -INF and INF shall be appended as NaN, -INF and INF, like AgentDataTypes_ToString does. ]*/
+    if (ISNAN(value))
+    {
+        *result = appendBytes(writer, NaN_STRING, sizeof(NaN_STRING) - 1);
+    }
+    else if (ISNEGATIVEINFINITY(value))
+    {
+        *result = appendBytes(writer, MINUSINF_STRING, sizeof(MINUSINF_STRING) - 1);
+    }
+    else if (ISPOSITIVEINFINITY(value))
+    {
+        *result = appendBytes(writer, PLUSINF_STRING, sizeof(PLUSINF_STRING) - 1);
+    }
+    else
+    {
+        isNonFinite = false;
+    }
+    return isNonFinite;
+}
+#endif
+
+JSON_WRITER_RESULT JSONWriter_AppendDouble(JSON_WRITER_HANDLE handle, double value)
+{
+    JSON_WRITER_RESULT result;
+    if (handle == NULL)
+    {
+        /*Codes_SRS_JSONWRITER_09_006: [ If handle is NULL, all the JSONWriter_Append and JSONWriter_BeginObject/EndObject functions shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+    }
+    else
+    {
+#ifndef NO_FLOATS
+        if (!appendNonFinite(handle, value, &result))
+        {
+            /*Codes_SRS_JSONWRITER_09_019: [ JSONWriter_AppendDouble shall append value formatted by FloatFormat_Double. ]*/
+            char temp[FLOAT_FORMAT_BUFFER_SIZE];
+            size_t length = FloatFormat_Double(value, temp, sizeof(temp));
+            result = (length == 0) ? JSON_WRITER_ERROR : appendBytes(handle, temp, length);
+        }
+
+        if (result != JSON_WRITER_OK)
+        {
+            LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+        }
+#else
+        (void)value;
+        result = JSON_WRITER_ERROR;
+        LogError("floating point support is disabled (NO_FLOATS)");
+#endif
+    }
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_AppendFloat(JSON_WRITER_HANDLE handle, float value)
+{
+    JSON_WRITER_RESULT result;
+    if (handle == NULL)
+    {
+        /*Codes_SRS_JSONWRITER_09_006: [ If handle is NULL, all the JSONWriter_Append and JSONWriter_BeginObject/EndObject functions shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+    }
+    else
+    {
+#ifndef NO_FLOATS
+        if (!appendNonFinite(handle, (double)value, &result))
+        {
+            /*Codes_SRS_JSONWRITER_09_021: [ JSONWriter_AppendFloat shall append value formatted by FloatFormat_Single. ]*/
+            char temp[FLOAT_FORMAT_BUFFER_SIZE];
+            size_t length = FloatFormat_Single(value, temp, sizeof(temp));
+            result = (length == 0) ? JSON_WRITER_ERROR : appendBytes(handle, temp, length);
+        }
+
+        if (result != JSON_WRITER_OK)
+        {
+            LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+        }
+#else
+        (void)value;
+        result = JSON_WRITER_ERROR;
+        LogError("floating point support is disabled (NO_FLOATS)");
+#endif
+    }
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_Release(JSON_WRITER_HANDLE handle, unsigned char** destination, size_t* destinationSize)
+{
+    JSON_WRITER_RESULT result;
+    if ((handle == NULL) || (destination == NULL) || (destinationSize == NULL))
+    {
+        /*Codes_SRS_JSONWRITER_09_022: [ If handle, destination or destinationSize are NULL, JSONWriter_Release shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("invalid arg JSON_WRITER_HANDLE handle=%p, unsigned char** destination=%p, size_t* destinationSize=%p", handle, destination, destinationSize);
+    }
+    else if (handle->size == 0)
+    {
+        /*Codes_SRS_JSONWRITER_09_023: [ If nothing was appended, JSONWriter_Release shall fail and return JSON_WRITER_ERROR. ]*/
+        result = JSON_WRITER_ERROR;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_WRITER_RESULT, result));
+    }
+    else
+    {
+        /*Codes_SRS_JSONWRITER_09_024: [ JSONWriter_Release shall hand the buffer over to the caller in *destination and *destinationSize without copying it; the caller frees it with free. ]*/
+        *destination = handle->buffer;
+        *destinationSize = handle->size;
+
+        /*Codes_SRS_JSONWRITER_09_025: [ After JSONWriter_Release the writer shall be empty and can be reused. ]*/
+        handle->buffer = NULL;
+        handle->capacity = 0;
+        handle->size = 0;
+        handle->needsComma = false;
+        result = JSON_WRITER_OK;
+    }
+    return result;
+}
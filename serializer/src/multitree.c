@@ -5,7 +5,9 @@
 #include "azure_c_shared_utility/gballoc.h"
 
 #include "multitree.h"
+#include "fnvhash.h"
 #include <string.h>
+#include <stdbool.h>
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/macro_utils.h"
@@ -14,6 +16,9 @@
 /*assume a name cannot be longer than 100 characters*/
 #define INNER_NODE_NAME_SIZE 128
 
+/*nodes with at least this many children find them through a hash index, smaller nodes just scan their children*/
+#define CHILD_INDEX_THRESHOLD 8
+
 DEFINE_ENUM_STRINGS(MULTITREE_RESULT, MULTITREE_RESULT_VALUES);
 
 typedef struct MULTITREE_HANDLE_DATA_TAG
@@ -24,6 +29,8 @@ typedef struct MULTITREE_HANDLE_DATA_TAG
     MULTITREE_FREE_FUNCTION freeFunction;
     size_t nChildren;
     struct MULTITREE_HANDLE_DATA_TAG** children; /*an array of nChildren count of MULTITREE_HANDLE_DATA*   */
+    size_t* childIndex; /*open addressing hash table of childIndexSize slots: 0 for an empty slot, otherwise 1 + the position of the child in children. NULL while the node has few children*/
+    size_t childIndexSize; /*a power of 2, at least twice nChildren*/
 }MULTITREE_HANDLE_DATA;
 
 
@@ -52,6 +59,8 @@ MULTITREE_HANDLE MultiTree_Create(MULTITREE_CLONE_FUNCTION cloneFunction, MULTIT
             result->freeFunction = freeFunction;
             result->nChildren = 0;
             result->children = NULL;
+            result->childIndex = NULL;
+            result->childIndexSize = 0;
         }
         else
         {
@@ -63,21 +72,114 @@ MULTITREE_HANDLE MultiTree_Create(MULTITREE_CLONE_FUNCTION cloneFunction, MULTIT
 }
 
 
-/*return NULL if a child with the name "name" doesn't exists*/
+static bool isChildNamed(const MULTITREE_HANDLE_DATA* child, const char* name, size_t nameLength)
+{
+    return (strncmp(child->name, name, nameLength) == 0) && (child->name[nameLength] == '\0');
+}
+
+/*return NULL if a child with the name given by the first nameLength characters of "name" doesn't exists*/
 /*returns a pointer to the existing child (if any)*/
-static MULTITREE_HANDLE_DATA* getChildByName(MULTITREE_HANDLE_DATA* node, const char* name)
+static MULTITREE_HANDLE_DATA* findChild(MULTITREE_HANDLE_DATA* node, const char* name, size_t nameLength)
 {
     MULTITREE_HANDLE_DATA* result = NULL;
+    if (node->childIndex == NULL)
+    {
+        size_t i;
+        for (i = 0; i < node->nChildren; i++)
+        {
+            if (isChildNamed(node->children[i], name, nameLength))
+            {
+                result = node->children[i];
+                break;
+            }
+        }
+    }
+    else
+    {
+        /*Codes_SRS_MULTITREE_09_004: [ Once a node has CHILD_INDEX_THRESHOLD (8) or more children, its children shall be found by name through an open addressing hash index instead of scanning all of them. ]*/
+        size_t mask = node->childIndexSize - 1;
+        size_t slot = FnvHash_Compute32(name, nameLength) & mask;
+        while (node->childIndex[slot] != 0)
+        {
+            MULTITREE_HANDLE_DATA* child = node->children[node->childIndex[slot] - 1];
+            if (isChildNamed(child, name, nameLength))
+            {
+                result = child;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+    return result;
+}
+
+static MULTITREE_HANDLE_DATA* getChildByName(MULTITREE_HANDLE_DATA* node, const char* name)
+{
+    return findChild(node, name, strlen(name));
+}
+
+static void addToChildIndex(MULTITREE_HANDLE_DATA* node, size_t position)
+{
+    const char* name = node->children[position]->name;
+    size_t mask = node->childIndexSize - 1;
+    size_t slot = FnvHash_Compute32(name, strlen(name)) & mask;
+    while (node->childIndex[slot] != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    node->childIndex[slot] = position + 1;
+}
+
+static void rebuildChildIndex(MULTITREE_HANDLE_DATA* node)
+{
     size_t i;
+    (void)memset(node->childIndex, 0, node->childIndexSize * sizeof(size_t));
     for (i = 0; i < node->nChildren; i++)
     {
-        if (strcmp(node->children[i]->name, name) == 0)
+        addToChildIndex(node, i);
+    }
+}
+
+/*called after a child has been appended to children*/
+static void updateChildIndex(MULTITREE_HANDLE_DATA* node)
+{
+    if (node->nChildren >= CHILD_INDEX_THRESHOLD)
+    {
+        if ((node->childIndex != NULL) && (node->nChildren * 2 <= node->childIndexSize))
         {
-            result = node->children[i];
-            break;
+            addToChildIndex(node, node->nChildren - 1);
+        }
+        else
+        {
+            /*keep the index at most half full so that probe sequences stay short*/
+            size_t newSize = CHILD_INDEX_THRESHOLD * 2;
+            size_t* newIndex;
+            while (newSize < node->nChildren * 2)
+            {
+                newSize *= 2;
+            }
+
+            newIndex = (size_t*)malloc(newSize * sizeof(size_t));
+            if (node->childIndex != NULL)
+            {
+                free(node->childIndex);
+            }
+
+            if (newIndex == NULL)
+            {
+                /*Codes_SRS_MULTITREE_09_005: [ If the index cannot be allocated, children shall be found by scanning them and adding the child shall still succeed. ]*/
+                node->childIndex = NULL;
+                node->childIndexSize = 0;
+                LogError("unable to allocate the child index, children will be scanned");
+            }
+            else
+            {
+                node->childIndex = newIndex;
+                node->childIndexSize = newSize;
+                rebuildChildIndex(node);
+            }
         }
     }
-    return result;
 }
 
 /*helper function to create a child immediately under this node*/
@@ -136,6 +238,8 @@ static CREATELEAF_RESULT createLeaf(MULTITREE_HANDLE_DATA* node, const char*name
         {
             newNode->nChildren = 0;
             newNode->children = NULL;
+            newNode->childIndex = NULL;
+            newNode->childIndexSize = 0;
             if (mallocAndStrcpy_s(&(newNode->name), name) != 0)
             {
                 /*not nice*/
@@ -186,9 +290,11 @@ static CREATELEAF_RESULT createLeaf(MULTITREE_HANDLE_DATA* node, const char*name
                 }
                 else
                 {
+                    /*Codes_SRS_MULTITREE_09_006: [ Children shall be kept in the order in which they were added, which is the order used by MultiTree_GetChild. ]*/
                     node->children = newChildren;
                     node->children[node->nChildren] = newNode;
                     node->nChildren++;
+                    updateChildIndex(node);
                     if (childNode != NULL)
                     {
                         *childNode = newNode;
@@ -302,7 +408,8 @@ MULTITREE_RESULT MultiTree_AddLeaf(MULTITREE_HANDLE treeHandle, const char* dest
                 {
                     /*Codes_SRS_MULTITREE_99_022:[ If a child along the path does not exist, it shall be created.] */
                     /*Codes_SRS_MULTITREE_99_023:[ The newly created children along the path shall have a NULL value by default.]*/
-                    CREATELEAF_RESULT res = createLeaf(node, firstInnerNodeName, NULL, NULL);
+                    MULTITREE_HANDLE_DATA *createdChild;
+                    CREATELEAF_RESULT res = createLeaf(node, firstInnerNodeName, NULL, &createdChild);
                     switch (res)
                     {
                         default:
@@ -320,7 +427,6 @@ MULTITREE_RESULT MultiTree_AddLeaf(MULTITREE_HANDLE treeHandle, const char* dest
                         }
                         case(CREATELEAF_OK):
                         {
-                            MULTITREE_HANDLE_DATA *createdChild = getChildByName(node, firstInnerNodeName);
                             result = MultiTree_AddLeaf(createdChild, whereIsDelimiter, value);
                             break;
                         }
@@ -492,6 +598,36 @@ MULTITREE_RESULT MultiTree_GetName(MULTITREE_HANDLE treeHandle, STRING_HANDLE de
     return result;
 }
 
+MULTITREE_RESULT MultiTree_GetNamePtr(MULTITREE_HANDLE treeHandle, const char** destination)
+{
+    MULTITREE_RESULT result;
+    /*Codes_SRS_MULTITREE_09_001: [ If treeHandle or destination is NULL, MultiTree_GetNamePtr shall return MULTITREE_INVALID_ARG. ]*/
+    if ((treeHandle == NULL) ||
+        (destination == NULL))
+    {
+        result = MULTITREE_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(MULTITREE_RESULT, result));
+    }
+    else
+    {
+        MULTITREE_HANDLE_DATA *node = (MULTITREE_HANDLE_DATA*)treeHandle;
+        /*Codes_SRS_MULTITREE_09_002: [ MultiTree_GetNamePtr shall return MULTITREE_EMPTY_CHILD_NAME when used with the root of the tree. ]*/
+        if (node->name == NULL)
+        {
+            result = MULTITREE_EMPTY_CHILD_NAME;
+            LogError("(result = %s)", ENUM_TO_STRING(MULTITREE_RESULT, result));
+        }
+        else
+        {
+            /*Codes_SRS_MULTITREE_09_003: [ Otherwise MultiTree_GetNamePtr shall set *destination to the name stored in the node, without copying it, and return MULTITREE_OK. ]*/
+            *destination = node->name;
+            result = MULTITREE_OK;
+        }
+    }
+
+    return result;
+}
+
 /* Codes_SRS_MULTITREE_99_063:[ MultiTree_GetChildByName shall retrieve the handle of the child node childName from the treeNode node.] */
 MULTITREE_RESULT MultiTree_GetChildByName(MULTITREE_HANDLE treeHandle, const char* childName, MULTITREE_HANDLE *childHandle)
 {
@@ -507,18 +643,9 @@ MULTITREE_RESULT MultiTree_GetChildByName(MULTITREE_HANDLE treeHandle, const cha
     }
     else
     {
-        MULTITREE_HANDLE_DATA * node = (MULTITREE_HANDLE_DATA *)treeHandle;
-        size_t i;
+        MULTITREE_HANDLE_DATA * child = getChildByName((MULTITREE_HANDLE_DATA *)treeHandle, childName);
 
-        for (i = 0; i < node->nChildren; i++)
-        {
-            if (strcmp(node->children[i]->name, childName) == 0)
-            {
-                break;
-            }
-        }
-
-        if (i == node->nChildren)
+        if (child == NULL)
         {
             /* Codes_SRS_MULTITREE_99_068:[ If the specified child is not found, MultiTree_GetChildByName shall return MULTITREE_CHILD_NOT_FOUND.] */
             result = MULTITREE_CHILD_NOT_FOUND;
@@ -527,7 +654,7 @@ MULTITREE_RESULT MultiTree_GetChildByName(MULTITREE_HANDLE treeHandle, const cha
         else
         {
             /* Codes_SRS_MULTITREE_99_067:[ The child node handle shall be returned in the childHandle argument.] */
-            *childHandle = node->children[i];
+            *childHandle = child;
 
             /* Codes_SRS_MULTITREE_99_064:[ On success, MultiTree_GetChildByName shall return MULTITREE_OK.] */
             result = MULTITREE_OK;
@@ -627,6 +754,13 @@ void MultiTree_Destroy(MULTITREE_HANDLE treeHandle)
             node->children = NULL;
         }
 
+        /*Codes_SRS_MULTITREE_99_047:[ This function frees any system resource used by the tree designated by parameter treeHandle]*/
+        if (node->childIndex != NULL)
+        {
+            free(node->childIndex);
+            node->childIndex = NULL;
+        }
+
         /*Codes_SRS_MULTITREE_99_047:[ This function frees any system resource used by the tree designated by parameter treeHandle]*/
         if (node->name != NULL)
         {
@@ -692,7 +826,6 @@ MULTITREE_RESULT MultiTree_GetLeafValue(MULTITREE_HANDLE treeHandle, const char*
             /* Codes_SRS_MULTITREE_99_058:[ The last child designates the child that will receive the value.] */
             while (*pos != '\0')
             {
-                size_t i;
                 size_t childCount = node->nChildren;
 
                 whereIsDelimiter = pos;
@@ -718,17 +851,11 @@ MULTITREE_RESULT MultiTree_GetLeafValue(MULTITREE_HANDLE treeHandle, const char*
                 }
                 else
                 {
-                    for (i = 0; i < childCount; i++)
-                    {
-                        if (strncmp(node->children[i]->name, pos, whereIsDelimiter - pos) == 0)
-                        {
-                            /* Codes_SRS_MULTITREE_99_057:[ Subsequent names designate hierarchical children in the tree.] */
-                            node = node->children[i];
-                            break;
-                        }
-                    }
+                    /* Codes_SRS_MULTITREE_99_057:[ Subsequent names designate hierarchical children in the tree.] */
+                    /*Codes_SRS_MULTITREE_09_007: [ Each name in leafPath shall match a child name exactly, not just be a prefix of it. ]*/
+                    MULTITREE_HANDLE_DATA* child = findChild(node, pos, whereIsDelimiter - pos);
 
-                    if (i == childCount)
+                    if (child == NULL)
                     {
                         /* Codes_SRS_MULTITREE_99_071:[ When the child node is not found, MultiTree_GetLeafValue shall return MULTITREE_CHILD_NOT_FOUND.] */
                         result = MULTITREE_CHILD_NOT_FOUND;
@@ -737,6 +864,7 @@ MULTITREE_RESULT MultiTree_GetLeafValue(MULTITREE_HANDLE treeHandle, const char*
                     }
                     else
                     {
+                        node = child;
                         if (*whereIsDelimiter == '/')
                         {
                             pos = whereIsDelimiter + 1;
@@ -819,6 +947,21 @@ MULTITREE_RESULT MultiTree_DeleteChild(MULTITREE_HANDLE treeHandle, const char*
             treeHandle->children[treeHandle->nChildren - 1] = NULL;
             treeHandle->nChildren = treeHandle->nChildren - 1;
 
+            /*Codes_SRS_MULTITREE_09_008: [ MultiTree_DeleteChild shall keep the hash index consistent with the remaining children, dropping it when fewer than CHILD_INDEX_THRESHOLD children are left. ]*/
+            if (treeHandle->childIndex != NULL)
+            {
+                if (treeHandle->nChildren < CHILD_INDEX_THRESHOLD)
+                {
+                    free(treeHandle->childIndex);
+                    treeHandle->childIndex = NULL;
+                    treeHandle->childIndexSize = 0;
+                }
+                else
+                {
+                    rebuildChildIndex(treeHandle);
+                }
+            }
+
             result = MULTITREE_OK;
         }
     }
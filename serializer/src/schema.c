@@ -5,6 +5,7 @@
 #include "azure_c_shared_utility/gballoc.h"
 
 #include "schema.h"
+#include "fnvhash.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/vector.h"
@@ -68,6 +69,38 @@ typedef struct MODEL_IN_MODEL_TAG
     SCHEMA_MODEL_TYPE_HANDLE modelHandle;
 } MODEL_IN_MODEL;
 
+/*the names of the elements of a model (properties, reported and desired properties, actions, methods and models in model) and of a
+schema (model types and struct types) are indexed by an open addressing hash table that is filled as the elements are added. Resolving
+a name then costs one hash and, nearly always, one string comparison instead of a scan of every element of the model*/
+typedef enum SCHEMA_SYMBOL_KIND_TAG
+{
+    SCHEMA_SYMBOL_PROPERTY,
+    SCHEMA_SYMBOL_REPORTED_PROPERTY,
+    SCHEMA_SYMBOL_DESIRED_PROPERTY,
+    SCHEMA_SYMBOL_ACTION,
+    SCHEMA_SYMBOL_METHOD,
+    SCHEMA_SYMBOL_MODEL_IN_MODEL,
+    SCHEMA_SYMBOL_MODEL_TYPE,
+    SCHEMA_SYMBOL_STRUCT_TYPE
+} SCHEMA_SYMBOL_KIND;
+
+typedef struct SCHEMA_SYMBOL_TAG
+{
+    const char* name; /*NULL for a free slot. Points to the name owned by the element, the table does not copy it*/
+    size_t nameLength;
+    size_t hash;
+    SCHEMA_SYMBOL_KIND kind;
+    void* element; /*handle of the element, NULL for a model in model*/
+    size_t index; /*index of a model in model in the models VECTOR, which moves its elements when it grows*/
+} SCHEMA_SYMBOL;
+
+typedef struct SCHEMA_SYMBOL_TABLE_TAG
+{
+    SCHEMA_SYMBOL* symbols;
+    size_t capacity; /*always a power of 2*/
+    size_t count;
+} SCHEMA_SYMBOL_TABLE;
+
 typedef struct SCHEMA_MODEL_TYPE_HANDLE_DATA_TAG
 {
     VECTOR_HANDLE methods; /*holds SCHEMA_METHOD_HANDLE*/
@@ -81,6 +114,7 @@ typedef struct SCHEMA_MODEL_TYPE_HANDLE_DATA_TAG
     size_t ActionCount;
     VECTOR_HANDLE models;
     size_t DeviceCount;
+    SCHEMA_SYMBOL_TABLE symbols;
 } SCHEMA_MODEL_TYPE_HANDLE_DATA;
 
 typedef struct SCHEMA_STRUCT_TYPE_HANDLE_DATA_TAG
@@ -98,10 +132,149 @@ typedef struct SCHEMA_HANDLE_DATA_TAG
     size_t ModelTypeCount;
     SCHEMA_STRUCT_TYPE_HANDLE* StructTypes;
     size_t StructTypeCount;
+    SCHEMA_SYMBOL_TABLE symbols;
 } SCHEMA_HANDLE_DATA;
 
 static VECTOR_HANDLE g_schemas = NULL;
 
+#define SYMBOL_TABLE_INITIAL_CAPACITY 16
+
+static SCHEMA_SYMBOL* AllocateSymbols(size_t capacity)
+{
+    SCHEMA_SYMBOL* result = (SCHEMA_SYMBOL*)malloc(sizeof(SCHEMA_SYMBOL) * capacity);
+    if (result == NULL)
+    {
+        LogError("unable to malloc %zu symbols", capacity);
+    }
+    else
+    {
+        size_t i;
+        for (i = 0; i < capacity; i++)
+        {
+            result[i].name = NULL;
+        }
+    }
+    return result;
+}
+
+static int SymbolTable_Init(SCHEMA_SYMBOL_TABLE* table)
+{
+    int result;
+    if ((table->symbols = AllocateSymbols(SYMBOL_TABLE_INITIAL_CAPACITY)) == NULL)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        table->capacity = SYMBOL_TABLE_INITIAL_CAPACITY;
+        table->count = 0;
+        result = 0;
+    }
+    return result;
+}
+
+static void SymbolTable_Deinit(SCHEMA_SYMBOL_TABLE* table)
+{
+    free(table->symbols);
+    table->symbols = NULL;
+    table->capacity = 0;
+    table->count = 0;
+}
+
+static void PlaceSymbol(SCHEMA_SYMBOL* symbols, size_t capacity, const SCHEMA_SYMBOL* symbol)
+{
+    size_t slot = symbol->hash & (capacity - 1);
+    while (symbols[slot].name != NULL)
+    {
+        slot = (slot + 1) & (capacity - 1);
+    }
+    symbols[slot] = *symbol;
+}
+
+/*makes room for one more symbol so that the table stays at most 3/4 full. This is the only step of adding a symbol that can fail, so
+the callers do it before they allocate the element*/
+static int SymbolTable_Reserve(SCHEMA_SYMBOL_TABLE* table)
+{
+    int result;
+    if ((table->count + 1) * 4 <= table->capacity * 3)
+    {
+        result = 0;
+    }
+    else
+    {
+        size_t newCapacity = table->capacity * 2;
+        SCHEMA_SYMBOL* newSymbols = AllocateSymbols(newCapacity);
+        if (newSymbols == NULL)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t i;
+            for (i = 0; i < table->capacity; i++)
+            {
+                if (table->symbols[i].name != NULL)
+                {
+                    PlaceSymbol(newSymbols, newCapacity, &table->symbols[i]);
+                }
+            }
+            free(table->symbols);
+            table->symbols = newSymbols;
+            table->capacity = newCapacity;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+/*name is the copy owned by the element. SymbolTable_Reserve shall have succeeded before*/
+static void SymbolTable_Add(SCHEMA_SYMBOL_TABLE* table, SCHEMA_SYMBOL_KIND kind, const char* name, void* element, size_t index)
+{
+    SCHEMA_SYMBOL symbol;
+    symbol.name = name;
+    symbol.nameLength = strlen(name);
+    symbol.hash = FnvHash_Compute32(name, symbol.nameLength);
+    symbol.kind = kind;
+    symbol.element = element;
+    symbol.index = index;
+    PlaceSymbol(table->symbols, table->capacity, &symbol);
+    table->count++;
+}
+
+/*name does not need to be '\0' terminated, which lets the path lookups hash every segment of the path once, in place*/
+static const SCHEMA_SYMBOL* SymbolTable_Find(const SCHEMA_SYMBOL_TABLE* table, SCHEMA_SYMBOL_KIND kind, const char* name, size_t nameLength, size_t hash)
+{
+    const SCHEMA_SYMBOL* result = NULL;
+    size_t slot = hash & (table->capacity - 1);
+    while (table->symbols[slot].name != NULL)
+    {
+        const SCHEMA_SYMBOL* symbol = &table->symbols[slot];
+        if ((symbol->hash == hash) &&
+            (symbol->kind == kind) &&
+            (symbol->nameLength == nameLength) &&
+            (memcmp(symbol->name, name, nameLength) == 0))
+        {
+            result = symbol;
+            break;
+        }
+        slot = (slot + 1) & (table->capacity - 1);
+    }
+    return result;
+}
+
+static void* FindElementByName(const SCHEMA_SYMBOL_TABLE* table, SCHEMA_SYMBOL_KIND kind, const char* name)
+{
+    size_t nameLength = strlen(name);
+    const SCHEMA_SYMBOL* symbol = SymbolTable_Find(table, kind, name, nameLength, FnvHash_Compute32(name, nameLength));
+    return (symbol == NULL) ? NULL : symbol->element;
+}
+
+static MODEL_IN_MODEL* FindModelInModel(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* name, size_t nameLength, size_t hash)
+{
+    const SCHEMA_SYMBOL* symbol = SymbolTable_Find(&modelType->symbols, SCHEMA_SYMBOL_MODEL_IN_MODEL, name, nameLength, hash);
+    return (symbol == NULL) ? NULL : (MODEL_IN_MODEL*)VECTOR_element(modelType->models, symbol->index);
+}
+
 static void DestroyProperty(SCHEMA_PROPERTY_HANDLE propertyHandle)
 {
     SCHEMA_PROPERTY_HANDLE_DATA* propertyType = (SCHEMA_PROPERTY_HANDLE_DATA*)propertyHandle;
@@ -243,6 +416,7 @@ static void DestroyModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
     VECTOR_clear(modelType->models);
     VECTOR_destroy(modelType->models);
 
+    SymbolTable_Deinit(&modelType->symbols);
     free(modelType->Actions);
     free(modelType);
 }
@@ -261,21 +435,17 @@ static SCHEMA_RESULT AddModelProperty(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType,
     }
     else
     {
-        size_t i;
-
         /* Codes_SRS_SCHEMA_99_015:[The property name shall be unique per model, if the same property name is added twice to a model, SCHEMA_DUPLICATE_ELEMENT shall be returned.] */
-        for (i = 0; i < modelType->PropertyCount; i++)
+        if (FindElementByName(&modelType->symbols, SCHEMA_SYMBOL_PROPERTY, name) != NULL)
         {
-            SCHEMA_PROPERTY_HANDLE_DATA* property = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
-            if (strcmp(property->PropertyName, name) == 0)
-            {
-                break;
-            }
+            result = SCHEMA_DUPLICATE_ELEMENT;
+            LogError("(result = %s)", ENUM_TO_STRING(SCHEMA_RESULT, result));
         }
-
-        if (i < modelType->PropertyCount)
+        /*Codes_SRS_SCHEMA_09_001: [ Every element added to a model or to a schema shall be indexed by name in a hash table of the model or of the schema. ]*/
+        else if (SymbolTable_Reserve(&modelType->symbols) != 0)
         {
-            result = SCHEMA_DUPLICATE_ELEMENT;
+            /* Codes_SRS_SCHEMA_99_014:[On any other error, Schema_AddModelProperty shall return SCHEMA_ERROR.] */
+            result = SCHEMA_ERROR;
             LogError("(result = %s)", ENUM_TO_STRING(SCHEMA_RESULT, result));
         }
         else
@@ -319,6 +489,7 @@ static SCHEMA_RESULT AddModelProperty(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType,
                     {
                         modelType->Properties[modelType->PropertyCount] = (SCHEMA_PROPERTY_HANDLE)newProperty;
                         modelType->PropertyCount++;
+                        SymbolTable_Add(&modelType->symbols, SCHEMA_SYMBOL_PROPERTY, newProperty->PropertyName, newProperty, 0);
 
                         /* Codes_SRS_SCHEMA_99_012:[On success, Schema_AddModelProperty shall return SCHEMA_OK.] */
                         result = SCHEMA_OK;
@@ -392,8 +563,17 @@ SCHEMA_HANDLE Schema_Create(const char* schemaNamespace, void* metadata)
             result = NULL;
             LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ERROR));
         }
+        else if (SymbolTable_Init(&result->symbols) != 0)
+        {
+            /* Codes_SRS_SCHEMA_99_003:[On failure, NULL shall be returned.] */
+            free((void*)result->Namespace);
+            free(result);
+            result = NULL;
+            LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ERROR));
+        }
         else if (VECTOR_push_back(g_schemas, &result, 1) != 0)
         {
+            SymbolTable_Deinit(&result->symbols);
             free((void*)result->Namespace);
             free(result);
             result = NULL;
@@ -481,6 +661,7 @@ void Schema_Destroy(SCHEMA_HANDLE schemaHandle)
         }
 
         free(schema->StructTypes);
+        SymbolTable_Deinit(&schema->symbols);
         free((void*)schema->Namespace);
         free(schema);
 
@@ -605,23 +786,18 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_CreateModelType(SCHEMA_HANDLE schemaHandle, cons
         SCHEMA_HANDLE_DATA* schema = (SCHEMA_HANDLE_DATA*)schemaHandle;
 
         /* Codes_SRS_SCHEMA_99_100: [Schema_CreateModelType shall return SCHEMA_DUPLICATE_ELEMENT if modelName already exists.] */
-        size_t i;
-        for (i = 0; i < schema->ModelTypeCount; i++)
+        if (FindElementByName(&schema->symbols, SCHEMA_SYMBOL_MODEL_TYPE, modelName) != NULL)
         {
-            SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)(schema->ModelTypes[i]);
-            if (strcmp(model->Name, modelName) == 0)
-            {
-                break;
-            }
+            /* Codes_SRS_SCHEMA_99_009:[On failure, Schema_CreateModelType shall return NULL.] */
+            result = NULL;
+            LogError("%s Model Name already exists", modelName);
         }
-
-        if (i < schema->ModelTypeCount)
+        else if (SymbolTable_Reserve(&schema->symbols) != 0)
         {
             /* Codes_SRS_SCHEMA_99_009:[On failure, Schema_CreateModelType shall return NULL.] */
             result = NULL;
-            LogError("%s Model Name already exists", modelName);
+            LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ERROR));
         }
-
         else
         {
             SCHEMA_MODEL_TYPE_HANDLE* newModelTypes = (SCHEMA_MODEL_TYPE_HANDLE*)realloc(schema->ModelTypes, sizeof(SCHEMA_MODEL_TYPE_HANDLE) * (schema->ModelTypeCount + 1));
@@ -697,6 +873,18 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_CreateModelType(SCHEMA_HANDLE schemaHandle, cons
                                     free((void*)modelType);
                                     result = NULL;
                                 }
+                                /*Codes_SRS_SCHEMA_09_002: [ Schema_CreateModelType shall create the hash table that indexes the elements of the model by name. ]*/
+                                else if (SymbolTable_Init(&modelType->symbols) != 0)
+                                {
+                                    LogError("failure in SymbolTable_Init");
+                                    VECTOR_destroy(modelType->methods);
+                                    VECTOR_destroy(modelType->desiredProperties);
+                                    VECTOR_destroy(modelType->reportedProperties);
+                                    VECTOR_destroy(modelType->models);
+                                    free((void*)modelType->Name);
+                                    free((void*)modelType);
+                                    result = NULL;
+                                }
                                 else
                                 {
                                     modelType->PropertyCount = 0;
@@ -708,6 +896,7 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_CreateModelType(SCHEMA_HANDLE schemaHandle, cons
 
                                     schema->ModelTypes[schema->ModelTypeCount] = modelType;
                                     schema->ModelTypeCount++;
+                                    SymbolTable_Add(&schema->symbols, SCHEMA_SYMBOL_MODEL_TYPE, modelType->Name, modelType, 0);
                                     /* Codes_SRS_SCHEMA_99_008:[On success, a non-NULL handle shall be returned.] */
                                     result = (SCHEMA_MODEL_TYPE_HANDLE)modelType;
                                 }
@@ -760,12 +949,6 @@ SCHEMA_RESULT Schema_AddModelProperty(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
     return AddModelProperty((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, propertyName, propertyType);
 }
 
-static bool reportedPropertyExists(const void* element, const void* value)
-{
-    SCHEMA_REPORTED_PROPERTY_HANDLE_DATA* reportedProperty = *(SCHEMA_REPORTED_PROPERTY_HANDLE_DATA**)element;
-    return (strcmp(reportedProperty->reportedPropertyName, value) == 0);
-}
-
 SCHEMA_RESULT Schema_AddModelReportedProperty(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* reportedPropertyName, const char* reportedPropertyType)
 {
     SCHEMA_RESULT result;
@@ -785,11 +968,17 @@ SCHEMA_RESULT Schema_AddModelReportedProperty(SCHEMA_MODEL_TYPE_HANDLE modelType
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_02_004: [ If reportedPropertyName has already been added then Schema_AddModelReportedProperty shall fail and return SCHEMA_PROPERTY_ELEMENT_EXISTS. ]*/
-        if (VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyName) != NULL)
+        if (FindElementByName(&modelType->symbols, SCHEMA_SYMBOL_REPORTED_PROPERTY, reportedPropertyName) != NULL)
         {
             LogError("unable to add reportedProperty %s because it already exists", reportedPropertyName);
             result = SCHEMA_DUPLICATE_ELEMENT;
         }
+        else if (SymbolTable_Reserve(&modelType->symbols) != 0)
+        {
+            /*Codes_SRS_SCHEMA_02_006: [ If any error occurs then Schema_AddModelReportedProperty shall fail and return SCHEMA_ERROR. ]*/
+            LogError("unable to SymbolTable_Reserve");
+            result = SCHEMA_ERROR;
+        }
         else
         {
             /*Codes_SRS_SCHEMA_02_005: [ Schema_AddModelReportedProperty shall record reportedPropertyName and reportedPropertyType. ]*/
@@ -832,6 +1021,7 @@ SCHEMA_RESULT Schema_AddModelReportedProperty(SCHEMA_MODEL_TYPE_HANDLE modelType
                         }
                         else
                         {
+                            SymbolTable_Add(&modelType->symbols, SCHEMA_SYMBOL_REPORTED_PROPERTY, reportedProperty->reportedPropertyName, reportedProperty, 0);
                             /*Codes_SRS_SCHEMA_02_007: [ Otherwise Schema_AddModelReportedProperty shall succeed and return SCHEMA_OK. ]*/
                             result = SCHEMA_OK;
                         }
@@ -857,22 +1047,18 @@ SCHEMA_ACTION_HANDLE Schema_CreateModelAction(SCHEMA_MODEL_TYPE_HANDLE modelType
     else
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        size_t i;
 
         /* Codes_SRS_SCHEMA_99_105: [The action name shall be unique per model, if the same action name is added twice to a model, Schema_CreateModelAction shall return NULL.] */
-        for (i = 0; i < modelType->ActionCount; i++)
+        if (FindElementByName(&modelType->symbols, SCHEMA_SYMBOL_ACTION, actionName) != NULL)
         {
-            SCHEMA_ACTION_HANDLE_DATA* action = (SCHEMA_ACTION_HANDLE_DATA*)modelType->Actions[i];
-            if (strcmp(action->ActionName, actionName) == 0)
-            {
-                break;
-            }
+            result = NULL;
+            LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_DUPLICATE_ELEMENT));
         }
-
-        if (i < modelType->ActionCount)
+        else if (SymbolTable_Reserve(&modelType->symbols) != 0)
         {
+            /* Codes_SRS_SCHEMA_99_106: [On any other error, Schema_CreateModelAction shall return NULL.]*/
             result = NULL;
-            LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_DUPLICATE_ELEMENT));
+            LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ERROR));
         }
         else
         {
@@ -912,6 +1098,7 @@ SCHEMA_ACTION_HANDLE Schema_CreateModelAction(SCHEMA_MODEL_TYPE_HANDLE modelType
 
                         modelType->Actions[modelType->ActionCount] = newAction;
                         modelType->ActionCount++;
+                        SymbolTable_Add(&modelType->symbols, SCHEMA_SYMBOL_ACTION, newAction->ActionName, newAction, 0);
                         result = (SCHEMA_ACTION_HANDLE)(newAction);
                     }
 
@@ -936,13 +1123,6 @@ SCHEMA_ACTION_HANDLE Schema_CreateModelAction(SCHEMA_MODEL_TYPE_HANDLE modelType
 }
 
 
-static bool methodExists(const void* element, const void* value)
-{
-    const SCHEMA_METHOD_HANDLE* method = (const SCHEMA_METHOD_HANDLE*)element;
-    return (strcmp((*method)->methodName, value) == 0);
-}
-
-
 SCHEMA_METHOD_HANDLE Schema_CreateModelMethod(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* methodName)
 {
     SCHEMA_METHOD_HANDLE result;
@@ -958,11 +1138,17 @@ SCHEMA_METHOD_HANDLE Schema_CreateModelMethod(SCHEMA_MODEL_TYPE_HANDLE modelType
     else
     {
         /*Codes_SRS_SCHEMA_02_103: [ If methodName already exists, then Schema_CreateModelMethod shall fail and return NULL. ]*/
-        if (VECTOR_find_if(modelTypeHandle->methods, methodExists, methodName) != NULL)
+        if (FindElementByName(&modelTypeHandle->symbols, SCHEMA_SYMBOL_METHOD, methodName) != NULL)
         {
             LogError("method %s already exists", methodName);
             result = NULL;
         }
+        else if (SymbolTable_Reserve(&modelTypeHandle->symbols) != 0)
+        {
+            /*Codes_SRS_SCHEMA_02_102: [ If any of the above fails, then Schema_CreateModelMethod shall fail and return NULL. ]*/
+            LogError("failure in SymbolTable_Reserve");
+            result = NULL;
+        }
         else
         {
             /*Codes_SRS_SCHEMA_02_098: [ Schema_CreateModelMethod shall allocate the space for the method. ]*/
@@ -1009,6 +1195,7 @@ SCHEMA_METHOD_HANDLE Schema_CreateModelMethod(SCHEMA_MODEL_TYPE_HANDLE modelType
                         }
                         else
                         {
+                            SymbolTable_Add(&modelTypeHandle->symbols, SCHEMA_SYMBOL_METHOD, result->methodName, result, 0);
                             /*Codes_SRS_SCHEMA_02_104: [ Otherwise, Schema_CreateModelMethod shall succeed and return a non-NULL SCHEMA_METHOD_HANDLE. ]*/
                             /*return as is*/
                         }
@@ -1219,29 +1406,15 @@ SCHEMA_PROPERTY_HANDLE Schema_GetModelPropertyByName(SCHEMA_MODEL_TYPE_HANDLE mo
     }
     else
     {
-        size_t i;
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
         /* Codes_SRS_SCHEMA_99_036:[Schema_GetModelPropertyByName shall return a non-NULL SCHEMA_PROPERTY_HANDLE corresponding to the model type identified by modelTypeHandle and matching the propertyName argument value.] */
-        for (i = 0; i < modelType->PropertyCount; i++)
-        {
-            SCHEMA_PROPERTY_HANDLE_DATA* modelProperty = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
-            if (strcmp(modelProperty->PropertyName, propertyName) == 0)
-            {
-                break;
-            }
-        }
-
-        if (i == modelType->PropertyCount)
+        result = (SCHEMA_PROPERTY_HANDLE)FindElementByName(&modelType->symbols, SCHEMA_SYMBOL_PROPERTY, propertyName);
+        if (result == NULL)
         {
             /* Codes_SRS_SCHEMA_99_038:[Schema_GetModelPropertyByName shall return NULL if unable to find a matching property or if any of the arguments are NULL.] */
-            result = NULL;
             LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
         }
-        else
-        {
-            result = (SCHEMA_PROPERTY_HANDLE)(modelType->Properties[i]);
-        }
     }
 
     return result;
@@ -1313,7 +1486,7 @@ SCHEMA_REPORTED_PROPERTY_HANDLE Schema_GetModelReportedPropertyByName(SCHEMA_MOD
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_02_013: [ If reported property by the name reportedPropertyName exists then Schema_GetModelReportedPropertyByName shall succeed and return a non-NULL value. ]*/
         /*Codes_SRS_SCHEMA_02_014: [ Otherwise Schema_GetModelReportedPropertyByName shall fail and return NULL. ]*/
-        if((result = VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyName))==NULL)
+        if((result = (SCHEMA_REPORTED_PROPERTY_HANDLE)FindElementByName(&modelType->symbols, SCHEMA_SYMBOL_REPORTED_PROPERTY, reportedPropertyName))==NULL)
         {
             LogError("a reported property with name \"%s\" does not exist", reportedPropertyName);
         }
@@ -1387,42 +1560,20 @@ SCHEMA_ACTION_HANDLE Schema_GetModelActionByName(SCHEMA_MODEL_TYPE_HANDLE modelT
     }
     else
     {
-        size_t i;
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
         /* Codes_SRS_SCHEMA_99_040:[Schema_GetModelActionByName shall return a non-NULL SCHEMA_ACTION_HANDLE corresponding to the model type identified by modelTypeHandle and matching the actionName argument value.] */
-        for (i = 0; i < modelType->ActionCount; i++)
-        {
-            SCHEMA_ACTION_HANDLE_DATA* modelAction = (SCHEMA_ACTION_HANDLE_DATA*)modelType->Actions[i];
-            if (strcmp(modelAction->ActionName, actionName) == 0)
-            {
-                break;
-            }
-        }
-
-        if (i == modelType->ActionCount)
+        result = (SCHEMA_ACTION_HANDLE)FindElementByName(&modelType->symbols, SCHEMA_SYMBOL_ACTION, actionName);
+        if (result == NULL)
         {
             /* Codes_SRS_SCHEMA_99_041:[Schema_GetModelActionByName shall return NULL if unable to find a matching action, if any of the arguments are NULL.] */
-            result = NULL;
             LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
         }
-        else
-        {
-            result = modelType->Actions[i];
-        }
     }
 
     return result;
 }
 
-static bool matchModelMethod(const void* element, const void* value)
-{
-    /*element is a pointer to SCHEMA_METHOD_HANDLE_DATA*/
-    const SCHEMA_METHOD_HANDLE* decodedElement = (const SCHEMA_METHOD_HANDLE* )element;
-    const char* name = (const char*)value;
-    return (strcmp((*decodedElement)->methodName, name) == 0);
-}
-
 SCHEMA_METHOD_HANDLE Schema_GetModelMethodByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* methodName)
 {
     SCHEMA_METHOD_HANDLE result;
@@ -1438,16 +1589,11 @@ SCHEMA_METHOD_HANDLE Schema_GetModelMethodByName(SCHEMA_MODEL_TYPE_HANDLE modelT
     else
     {
         /*Codes_SRS_SCHEMA_02_117: [ If a method with the name methodName exists then Schema_GetModelMethodByName shall succeed and returns its handle. ]*/
-        SCHEMA_METHOD_HANDLE* found = VECTOR_find_if(modelTypeHandle->methods, matchModelMethod, methodName);
-        if (found == NULL)
+        result = (SCHEMA_METHOD_HANDLE)FindElementByName(&modelTypeHandle->symbols, SCHEMA_SYMBOL_METHOD, methodName);
+        if (result == NULL)
         {
             /*Codes_SRS_SCHEMA_02_118: [ Otherwise, Schema_GetModelMethodByName shall fail and return NULL. ]*/
             LogError("no such method by name = %s", methodName);
-            result = NULL;
-        }
-        else
-        {
-            result = *found;
         }
     }
 
@@ -1750,22 +1896,18 @@ SCHEMA_STRUCT_TYPE_HANDLE Schema_CreateStructType(SCHEMA_HANDLE schemaHandle, co
     else
     {
         SCHEMA_STRUCT_TYPE_HANDLE_DATA* structType;
-        size_t i;
 
         /* Codes_SRS_SCHEMA_99_061:[If a struct type with the same name already exists, Schema_CreateStructType shall return NULL.] */
-        for (i = 0; i < schema->StructTypeCount; i++)
+        if (FindElementByName(&schema->symbols, SCHEMA_SYMBOL_STRUCT_TYPE, typeName) != NULL)
         {
-            structType = (SCHEMA_STRUCT_TYPE_HANDLE_DATA*)schema->StructTypes[i];
-            if (strcmp(structType->Name, typeName) == 0)
-            {
-                break;
-            }
+            result = NULL;
+            LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_DUPLICATE_ELEMENT));
         }
-
-        if (i < schema->StructTypeCount)
+        else if (SymbolTable_Reserve(&schema->symbols) != 0)
         {
+            /* Codes_SRS_SCHEMA_99_066:[On any other error, Schema_CreateStructType shall return NULL.] */
             result = NULL;
-            LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_DUPLICATE_ELEMENT));
+            LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ERROR));
         }
         else
         {
@@ -1799,6 +1941,7 @@ SCHEMA_STRUCT_TYPE_HANDLE Schema_CreateStructType(SCHEMA_HANDLE schemaHandle, co
                     schema->StructTypeCount++;
                     structType->PropertyCount = 0;
                     structType->Properties = NULL;
+                    SymbolTable_Add(&schema->symbols, SCHEMA_SYMBOL_STRUCT_TYPE, structType->Name, structType, 0);
 
                     /* Codes_SRS_SCHEMA_99_058:[On success, a non-NULL handle shall be returned.] */
                     result = (SCHEMA_STRUCT_TYPE_HANDLE)structType;
@@ -1882,28 +2025,14 @@ SCHEMA_STRUCT_TYPE_HANDLE Schema_GetStructTypeByName(SCHEMA_HANDLE schemaHandle,
     }
     else
     {
-        size_t i;
-
         /* Codes_SRS_SCHEMA_99_068:[Schema_GetStructTypeByName shall return a non-NULL handle corresponding to the struct type identified by the structTypeName in the schemaHandle schema.] */
-        for (i = 0; i < schema->StructTypeCount; i++)
-        {
-            SCHEMA_STRUCT_TYPE_HANDLE_DATA* structType = (SCHEMA_STRUCT_TYPE_HANDLE_DATA*)schema->StructTypes[i];
-            if (strcmp(structType->Name, name) == 0)
-            {
-                break;
-            }
-        }
-
-        if (i == schema->StructTypeCount)
+        /*Codes_SRS_SCHEMA_09_003: [ The functions that find an element by name shall look it up in the hash table of the model or of the schema instead of comparing name with the name of every element. ]*/
+        result = (SCHEMA_STRUCT_TYPE_HANDLE)FindElementByName(&schema->symbols, SCHEMA_SYMBOL_STRUCT_TYPE, name);
+        if (result == NULL)
         {
             /* Codes_SRS_SCHEMA_99_069:[Schema_GetStructTypeByName shall return NULL if unable to find a matching struct or if any of the arguments are NULL.] */
-            result = NULL;
             LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
         }
-        else
-        {
-            result = schema->StructTypes[i];
-        }
     }
 
     return result;
@@ -2196,25 +2325,9 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelByName(SCHEMA_HANDLE schemaHandle, const
     else
     {
         /* Codes_SRS_SCHEMA_99_124: [Schema_GetModelByName shall return a non-NULL SCHEMA_MODEL_TYPE_HANDLE corresponding to the model identified by schemaHandle and matching the modelName argument value.] */
+        /* Codes_SRS_SCHEMA_99_125: [Schema_GetModelByName shall return NULL if unable to find a matching model, or if any of the arguments are NULL.] */
         SCHEMA_HANDLE_DATA* schema = (SCHEMA_HANDLE_DATA*)schemaHandle;
-        size_t i;
-        for (i = 0; i < schema->ModelTypeCount; i++)
-        {
-            SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[i];
-            if (strcmp(modelName, modelType->Name)==0)
-            {
-                break;
-            }
-        }
-        if (i == schema->ModelTypeCount)
-        {
-            /* Codes_SRS_SCHEMA_99_125: [Schema_GetModelByName shall return NULL if unable to find a matching model, or if any of the arguments are NULL.] */
-            result = NULL;
-        }
-        else
-        {
-            result = schema->ModelTypes[i];
-        }
+        result = (SCHEMA_MODEL_TYPE_HANDLE)FindElementByName(&schema->symbols, SCHEMA_SYMBOL_MODEL_TYPE, modelName);
     }
     return result;
 }
@@ -2279,7 +2392,13 @@ SCHEMA_RESULT Schema_AddModelModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, con
         temp.modelHandle = modelType;
         temp.offset = offset;
         temp.onDesiredProperty = onDesiredProperty;
-        if (mallocAndStrcpy_s((char**)&(temp.propertyName), propertyName) != 0)
+        if (SymbolTable_Reserve(&parentModel->symbols) != 0)
+        {
+            /*Codes_SRS_SCHEMA_99_174: [The function shall return SCHEMA_ERROR if any other error occurs.]*/
+            result = SCHEMA_ERROR;
+            LogError("(Error code: %s)", ENUM_TO_STRING(SCHEMA_RESULT, result));
+        }
+        else if (mallocAndStrcpy_s((char**)&(temp.propertyName), propertyName) != 0)
         {
             result = SCHEMA_ERROR;
             LogError("(Error code: %s)", ENUM_TO_STRING(SCHEMA_RESULT, result));
@@ -2293,8 +2412,14 @@ SCHEMA_RESULT Schema_AddModelModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, con
         }
         else
         {
+            /*the first model in model added with a given name is the one found by name, as it was before the names were indexed*/
+            size_t nameLength = strlen(temp.propertyName);
+            if (FindModelInModel(parentModel, temp.propertyName, nameLength, FnvHash_Compute32(temp.propertyName, nameLength)) == NULL)
+            {
+                SymbolTable_Add(&parentModel->symbols, SCHEMA_SYMBOL_MODEL_IN_MODEL, temp.propertyName, NULL, VECTOR_size(parentModel->models) - 1);
+            }
+
             /*Codes_SRS_SCHEMA_99_164: [If the function succeeds, then the return value shall be SCHEMA_OK.]*/
-            
             result = SCHEMA_OK;
         }
     }
@@ -2325,11 +2450,10 @@ SCHEMA_RESULT Schema_GetModelModelCount(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle
     return result;
 }
 
-static bool matchModelName(const void* element, const void* value)
+static MODEL_IN_MODEL* FindModelInModelByName(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* name)
 {
-    MODEL_IN_MODEL* decodedElement = (MODEL_IN_MODEL*)element;
-    const char* name = (const char*)value;
-    return (strcmp(decodedElement->propertyName, name) == 0);
+    size_t nameLength = strlen(name);
+    return FindModelInModel(modelType, name, nameLength, FnvHash_Compute32(name, nameLength));
 }
 
 SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelModelByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* propertyName)
@@ -2349,7 +2473,7 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelModelByName(SCHEMA_MODEL_TYPE_HANDLE mod
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_99_170: [Schema_GetModelModelByName shall return a handle to the model identified by the property with the name propertyName in the model identified by the handle modelTypeHandle.]*/
         /*Codes_SRS_SCHEMA_99_171: [If Schema_GetModelModelByName is unable to provide the handle it shall return NULL.]*/
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        MODEL_IN_MODEL* temp = FindModelInModelByName(model, propertyName);
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2357,7 +2481,7 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelModelByName(SCHEMA_MODEL_TYPE_HANDLE mod
         }
         else
         {
-            result = ((MODEL_IN_MODEL*)temp)->modelHandle;
+            result = temp->modelHandle;
         }
     }
     return result;
@@ -2381,7 +2505,7 @@ size_t Schema_GetModelModelByName_Offset(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandl
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_02_056: [ If propertyName is not a model then Schema_GetModelModelByName_Offset shall fail and return 0. ]*/
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        MODEL_IN_MODEL* temp = FindModelInModelByName(model, propertyName);
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2390,7 +2514,7 @@ size_t Schema_GetModelModelByName_Offset(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandl
         else
         {
             /*Codes_SRS_SCHEMA_02_055: [ Otherwise Schema_GetModelModelByName_Offset shall succeed and return the offset. ]*/
-            result = ((MODEL_IN_MODEL*)temp)->offset;
+            result = temp->offset;
         }
     }
     return result;
@@ -2412,7 +2536,7 @@ pfOnDesiredProperty Schema_GetModelModelByName_OnDesiredProperty(SCHEMA_MODEL_TY
     else
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        MODEL_IN_MODEL* temp = FindModelInModelByName(model, propertyName);
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2421,7 +2545,7 @@ pfOnDesiredProperty Schema_GetModelModelByName_OnDesiredProperty(SCHEMA_MODEL_TY
         else
         {
             /*Codes_SRS_SCHEMA_02_089: [ Otherwise Schema_GetModelModelByName_OnDesiredProperty shall return the desired property callback. ]*/
-            result = ((MODEL_IN_MODEL*)temp)->onDesiredProperty;
+            result = temp->onDesiredProperty;
         }
     }
     return result;
@@ -2538,8 +2662,9 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
         do
         {
             const char* endPos;
-            size_t i;
-            size_t modelCount;
+            size_t segmentLength;
+            size_t segmentHash;
+            MODEL_IN_MODEL* childModel;
             SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
             /* Codes_SRS_SCHEMA_99_179: [The propertyPath shall be assumed to be in the format model1/model2/.../propertyName.] */
@@ -2550,22 +2675,17 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
                 endPos = &propertyPath[strlen(propertyPath)];
             }
 
+            /*Codes_SRS_SCHEMA_09_004: [ Each segment of the path shall be hashed once, in place, and the hash shall be used both to find a model in model and a property by that name. ]*/
+            segmentLength = (size_t)(endPos - propertyPath);
+            segmentHash = FnvHash_Compute32(propertyPath, segmentLength);
+
             /* get the child-model */
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
+            childModel = FindModelInModel(modelType, propertyPath, segmentLength, segmentHash);
+            if (childModel != NULL)
             {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if ((strncmp(childModel->propertyName, propertyPath, endPos - propertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - propertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
+                /* found */
+                modelTypeHandle = childModel->modelHandle;
 
-            if (i < modelCount)
-            {
                 /* model found, check if there is more in the path */
                 if (slashPos == NULL)
                 {
@@ -2583,19 +2703,8 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
             {
                 /* no model found, let's see if this is a property */
                 /* Codes_SRS_SCHEMA_99_178: [The argument propertyPath shall be used to find the leaf property.] */
-                for (i = 0; i < modelType->PropertyCount; i++)
-                {
-                    SCHEMA_PROPERTY_HANDLE_DATA* property = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
-                    if ((strncmp(property->PropertyName, propertyPath, endPos - propertyPath) == 0) &&
-                        (strlen(property->PropertyName) == (size_t)(endPos - propertyPath)))
-                    {
-                        /* found property */
-                        /* Codes_SRS_SCHEMA_99_177: [Schema_ModelPropertyByPathExists shall return true if a leaf property exists in the model modelTypeHandle.] */
-                        result = true;
-                        break;
-                    }
-                }
-
+                /* Codes_SRS_SCHEMA_99_177: [Schema_ModelPropertyByPathExists shall return true if a leaf property exists in the model modelTypeHandle.] */
+                result = (SymbolTable_Find(&modelType->symbols, SCHEMA_SYMBOL_PROPERTY, propertyPath, segmentLength, segmentHash) != NULL);
                 break;
             }
         } while (slashPos != NULL);
@@ -2632,8 +2741,9 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
         do
         {
             const char* endPos;
-            size_t i;
-            size_t modelCount;
+            size_t segmentLength;
+            size_t segmentHash;
+            MODEL_IN_MODEL* childModel;
             SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
             slashPos = strchr(reportedPropertyPath, '/');
@@ -2643,21 +2753,15 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
                 endPos = &reportedPropertyPath[strlen(reportedPropertyPath)];
             }
 
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
-            {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if ((strncmp(childModel->propertyName, reportedPropertyPath, endPos - reportedPropertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - reportedPropertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
+            segmentLength = (size_t)(endPos - reportedPropertyPath);
+            segmentHash = FnvHash_Compute32(reportedPropertyPath, segmentLength);
 
-            if (i < modelCount)
+            childModel = FindModelInModel(modelType, reportedPropertyPath, segmentLength, segmentHash);
+            if (childModel != NULL)
             {
+                /* found */
+                modelTypeHandle = childModel->modelHandle;
+
                 /* model found, check if there is more in the path */
                 if (slashPos == NULL)
                 {
@@ -2675,7 +2779,8 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
             else
             {
                 /* no model found, let's see if this is a property */
-                result = (VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyPath) != NULL);
+                /*a reported property is the last segment of the path, a name that is followed by more segments and is not a model cannot be one*/
+                result = (slashPos == NULL) && (SymbolTable_Find(&modelType->symbols, SCHEMA_SYMBOL_REPORTED_PROPERTY, reportedPropertyPath, segmentLength, segmentHash) != NULL);
                 if (!result)
                 {
                     LogError("no such reported property \"%s\"", reportedPropertyPath);
@@ -2688,12 +2793,6 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
     return result;
 }
 
-static bool desiredPropertyExists(const void* element, const void* value)
-{
-    SCHEMA_DESIRED_PROPERTY_HANDLE_DATA* desiredProperty = *(SCHEMA_DESIRED_PROPERTY_HANDLE_DATA**)element;
-    return (strcmp(desiredProperty->desiredPropertyName, value) == 0);
-}
-
 SCHEMA_RESULT Schema_AddModelDesiredProperty(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* desiredPropertyName, const char* desiredPropertyType, pfDesiredPropertyFromAGENT_DATA_TYPE desiredPropertyFromAGENT_DATA_TYPE, pfDesiredPropertyInitialize desiredPropertyInitialize, pfDesiredPropertyDeinitialize desiredPropertyDeinitialize, size_t offset, pfOnDesiredProperty onDesiredProperty)
 {
     SCHEMA_RESULT result;
@@ -2720,12 +2819,18 @@ SCHEMA_RESULT Schema_AddModelDesiredProperty(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* handleData = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_02_027: [ Schema_AddModelDesiredProperty shall add the desired property given by the name desiredPropertyName and the type desiredPropertyType to the collection of existing desired properties. ]*/
-        if (VECTOR_find_if(handleData->desiredProperties, desiredPropertyExists, desiredPropertyName) != NULL)
+        if (FindElementByName(&handleData->symbols, SCHEMA_SYMBOL_DESIRED_PROPERTY, desiredPropertyName) != NULL)
         {
             /*Codes_SRS_SCHEMA_02_047: [ If the desired property already exists, then Schema_AddModelDesiredProperty shall fail and return SCHEMA_DUPLICATE_ELEMENT. ]*/
             LogError("unable to Schema_AddModelDesiredProperty because a desired property with the same name (%s) already exists", desiredPropertyName);
             result = SCHEMA_DUPLICATE_ELEMENT;
         }
+        else if (SymbolTable_Reserve(&handleData->symbols) != 0)
+        {
+            /*Codes_SRS_SCHEMA_02_028: [ If any failure occurs then Schema_AddModelDesiredProperty shall fail and return SCHEMA_ERROR. ]*/
+            LogError("failure in SymbolTable_Reserve");
+            result = SCHEMA_ERROR;
+        }
         else
         {
             SCHEMA_DESIRED_PROPERTY_HANDLE_DATA* desiredProperty = (SCHEMA_DESIRED_PROPERTY_HANDLE_DATA*)malloc(sizeof(SCHEMA_DESIRED_PROPERTY_HANDLE_DATA));
@@ -2773,6 +2878,7 @@ SCHEMA_RESULT Schema_AddModelDesiredProperty(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
                             desiredProperty->desiredPropertDeinitialize = desiredPropertyDeinitialize;
                             desiredProperty->onDesiredProperty = onDesiredProperty; /*NULL is a perfectly fine value*/
                             desiredProperty->offset = offset;
+                            SymbolTable_Add(&handleData->symbols, SCHEMA_SYMBOL_DESIRED_PROPERTY, desiredProperty->desiredPropertyName, desiredProperty, 0);
                             result = SCHEMA_OK;
                         }
                     }
@@ -2825,15 +2931,10 @@ SCHEMA_DESIRED_PROPERTY_HANDLE Schema_GetModelDesiredPropertyByName(SCHEMA_MODEL
         /*Codes_SRS_SCHEMA_02_036: [ If a desired property having the name desiredPropertyName exists then Schema_GetModelDesiredPropertyByName shall succeed and return a non-NULL value. ]*/
         /*Codes_SRS_SCHEMA_02_037: [ Otherwise, Schema_GetModelDesiredPropertyByName shall fail and return NULL. ]*/
         SCHEMA_MODEL_TYPE_HANDLE_DATA* handleData = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        SCHEMA_DESIRED_PROPERTY_HANDLE* temp = VECTOR_find_if(handleData->desiredProperties, desiredPropertyExists, desiredPropertyName);
-        if (temp == NULL)
+        result = (SCHEMA_DESIRED_PROPERTY_HANDLE)FindElementByName(&handleData->symbols, SCHEMA_SYMBOL_DESIRED_PROPERTY, desiredPropertyName);
+        if (result == NULL)
         {
             LogError("no such desired property by name %s", desiredPropertyName);
-            result = NULL;
-        }
-        else
-        {
-            result = *temp;
         }
     }
     return result;
@@ -2896,8 +2997,9 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
         do
         {
             const char* endPos;
-            size_t i;
-            size_t modelCount;
+            size_t segmentLength;
+            size_t segmentHash;
+            MODEL_IN_MODEL* childModel;
             SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
             slashPos = strchr(desiredPropertyPath, '/');
@@ -2907,21 +3009,15 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
                 endPos = &desiredPropertyPath[strlen(desiredPropertyPath)];
             }
 
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
-            {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if ((strncmp(childModel->propertyName, desiredPropertyPath, endPos - desiredPropertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - desiredPropertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
+            segmentLength = (size_t)(endPos - desiredPropertyPath);
+            segmentHash = FnvHash_Compute32(desiredPropertyPath, segmentLength);
 
-            if (i < modelCount)
+            childModel = FindModelInModel(modelType, desiredPropertyPath, segmentLength, segmentHash);
+            if (childModel != NULL)
             {
+                /* found */
+                modelTypeHandle = childModel->modelHandle;
+
                 /* model found, check if there is more in the path */
                 if (slashPos == NULL)
                 {
@@ -2939,7 +3035,8 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
             else
             {
                 /* no model found, let's see if this is a property */
-                result = (VECTOR_find_if(modelType->desiredProperties, desiredPropertyExists, desiredPropertyPath) != NULL);
+                /*a desired property is the last segment of the path, a name that is followed by more segments and is not a model cannot be one*/
+                result = (slashPos == NULL) && (SymbolTable_Find(&modelType->symbols, SCHEMA_SYMBOL_DESIRED_PROPERTY, desiredPropertyPath, segmentLength, segmentHash) != NULL);
                 if (!result)
                 {
                     LogError("no such desired property \"%s\"", desiredPropertyPath);
@@ -3021,12 +3118,6 @@ size_t Schema_GetModelDesiredProperty_offset(SCHEMA_DESIRED_PROPERTY_HANDLE desi
     return result;
 }
 
-static bool modelInModelExists(const void* element, const void* value)
-{
-    MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)element;
-    return (strcmp(modelInModel->propertyName, value) == 0);
-}
-
 SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* elementName)
 {
     SCHEMA_MODEL_ELEMENT result;
@@ -3043,88 +3134,46 @@ SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE model
     else
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* handleData = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
+        /*Codes_SRS_SCHEMA_09_005: [ Schema_GetModelElementByName shall hash elementName once and use the hash to look it up as every kind of element, in the order desired property, property, reported property, action, model in model. ]*/
+        size_t nameLength = strlen(elementName);
+        size_t nameHash = FnvHash_Compute32(elementName, nameLength);
+        const SCHEMA_SYMBOL* symbol;
+        MODEL_IN_MODEL* modelInModel;
 
-        SCHEMA_DESIRED_PROPERTY_HANDLE* desiredPropertyHandle = VECTOR_find_if(handleData->desiredProperties, desiredPropertyExists, elementName);
-        if (desiredPropertyHandle != NULL)
+        if ((symbol = SymbolTable_Find(&handleData->symbols, SCHEMA_SYMBOL_DESIRED_PROPERTY, elementName, nameLength, nameHash)) != NULL)
         {
             /*Codes_SRS_SCHEMA_02_080: [ If elementName is a desired property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_DESIRED_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.desiredPropertyHandle to the handle of the desired property. ]*/
             result.elementType = SCHEMA_DESIRED_PROPERTY;
-            result.elementHandle.desiredPropertyHandle = *desiredPropertyHandle;
+            result.elementHandle.desiredPropertyHandle = (SCHEMA_DESIRED_PROPERTY_HANDLE)symbol->element;
+        }
+        else if ((symbol = SymbolTable_Find(&handleData->symbols, SCHEMA_SYMBOL_PROPERTY, elementName, nameLength, nameHash)) != NULL)
+        {
+            /*Codes_SRS_SCHEMA_02_078: [ If elementName is a property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.propertyHandle to the handle of the property. ]*/
+            result.elementType = SCHEMA_PROPERTY;
+            result.elementHandle.propertyHandle = (SCHEMA_PROPERTY_HANDLE)symbol->element;
+        }
+        else if ((symbol = SymbolTable_Find(&handleData->symbols, SCHEMA_SYMBOL_REPORTED_PROPERTY, elementName, nameLength, nameHash)) != NULL)
+        {
+            /*Codes_SRS_SCHEMA_02_079: [ If elementName is a reported property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_REPORTED_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.reportedPropertyHandle to the handle of the reported property. ]*/
+            result.elementType = SCHEMA_REPORTED_PROPERTY;
+            result.elementHandle.reportedPropertyHandle = (SCHEMA_REPORTED_PROPERTY_HANDLE)symbol->element;
+        }
+        else if ((symbol = SymbolTable_Find(&handleData->symbols, SCHEMA_SYMBOL_ACTION, elementName, nameLength, nameHash)) != NULL)
+        {
+            /*Codes_SRS_SCHEMA_02_081: [ If elementName is a model action then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_ACTION and SCHEMA_MODEL_ELEMENT.elementHandle.actionHandle to the handle of the action. ]*/
+            result.elementType = SCHEMA_MODEL_ACTION;
+            result.elementHandle.actionHandle = (SCHEMA_ACTION_HANDLE)symbol->element;
+        }
+        else if ((modelInModel = FindModelInModel(handleData, elementName, nameLength, nameHash)) != NULL)
+        {
+            /*Codes_SRS_SCHEMA_02_082: [ If elementName is a model in model then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_IN_MODEL and SCHEMA_MODEL_ELEMENT.elementHandle.modelHandle to the handle of the model. ]*/
+            result.elementType = SCHEMA_MODEL_IN_MODEL;
+            result.elementHandle.modelHandle = modelInModel->modelHandle;
         }
         else
         {
-            size_t nProcessedProperties = 0;
-            SCHEMA_PROPERTY_HANDLE_DATA* property = NULL;
-            for (size_t i = 0; i < handleData->PropertyCount;i++)
-            {
-                property = (SCHEMA_PROPERTY_HANDLE_DATA*)(handleData->Properties[i]);
-                if (strcmp(property->PropertyName, elementName) == 0)
-                {
-                    i = handleData->PropertyCount; /*found it*/
-                }
-                else
-                {
-                    nProcessedProperties++;
-                }
-            }
-
-            if (nProcessedProperties < handleData->PropertyCount)
-            {
-                /*Codes_SRS_SCHEMA_02_078: [ If elementName is a property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.propertyHandle to the handle of the property. ]*/
-                result.elementType = SCHEMA_PROPERTY;
-                result.elementHandle.propertyHandle = property;
-            }
-            else
-            {
-
-                SCHEMA_REPORTED_PROPERTY_HANDLE* reportedPropertyHandle = VECTOR_find_if(handleData->reportedProperties, reportedPropertyExists, elementName);
-                if (reportedPropertyHandle != NULL)
-                {
-                    /*Codes_SRS_SCHEMA_02_079: [ If elementName is a reported property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_REPORTED_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.reportedPropertyHandle to the handle of the reported property. ]*/
-                    result.elementType = SCHEMA_REPORTED_PROPERTY;
-                    result.elementHandle.reportedPropertyHandle = *reportedPropertyHandle;
-                }
-                else
-                {
-
-                    size_t nProcessedActions = 0;
-                    SCHEMA_ACTION_HANDLE_DATA* actionHandleData = NULL;
-                    for (size_t i = 0;i < handleData->ActionCount; i++)
-                    {
-                        actionHandleData = (SCHEMA_ACTION_HANDLE_DATA*)(handleData->Actions[i]);
-                        if (strcmp(actionHandleData->ActionName, elementName) == 0)
-                        {
-                            i = handleData->ActionCount; /*get out quickly*/
-                        }
-                        else
-                        {
-                            nProcessedActions++;
-                        }
-                    }
-
-                    if (nProcessedActions < handleData->ActionCount)
-                    {
-                        /*Codes_SRS_SCHEMA_02_081: [ If elementName is a model action then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_ACTION and SCHEMA_MODEL_ELEMENT.elementHandle.actionHandle to the handle of the action. ]*/
-                        result.elementType = SCHEMA_MODEL_ACTION;
-                        result.elementHandle.actionHandle = actionHandleData;
-                    }
-                    else
-                    {
-                        MODEL_IN_MODEL* modelInModel = VECTOR_find_if(handleData->models, modelInModelExists, elementName);
-                        if (modelInModel != NULL)
-                        {
-                            /*Codes_SRS_SCHEMA_02_082: [ If elementName is a model in model then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_IN_MODEL and SCHEMA_MODEL_ELEMENT.elementHandle.modelHandle to the handle of the model. ]*/
-                            result.elementType = SCHEMA_MODEL_IN_MODEL;
-                            result.elementHandle.modelHandle = modelInModel->modelHandle;
-                        }
-                        else
-                        {
-                            /*Codes_SRS_SCHEMA_02_083: [ Otherwise Schema_GetModelElementByName shall fail and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_NOT_FOUND. ]*/
-                            result.elementType = SCHEMA_NOT_FOUND;
-                        }
-                    }
-                }
-            }
+            /*Codes_SRS_SCHEMA_02_083: [ Otherwise Schema_GetModelElementByName shall fail and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_NOT_FOUND. ]*/
+            result.elementType = SCHEMA_NOT_FOUND;
         }
     }
     return result;
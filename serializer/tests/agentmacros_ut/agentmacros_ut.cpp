@@ -161,6 +161,8 @@ public:
     MOCK_METHOD_END(SCHEMA_HANDLE, TEST_SCHEMA_HANDLE)
     MOCK_STATIC_METHOD_2(, EXECUTE_COMMAND_RESULT, CodeFirst_ExecuteCommand, void*, device, const char*, command)
     MOCK_METHOD_END(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS)
+    MOCK_STATIC_METHOD_3(, EXECUTE_COMMAND_RESULT, CodeFirst_ExecuteCommandCBOR, void*, device, const unsigned char*, command, size_t, size)
+    MOCK_METHOD_END(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS)
     MOCK_STATIC_METHOD_4(, void*, CodeFirst_CreateDevice, SCHEMA_MODEL_TYPE_HANDLE, model, const REFLECTED_DATA_FROM_DATAPROVIDER*, metadata, size_t, dataSize, bool, includePropertyPath)
     MOCK_METHOD_END(void*, (void*)&TEST_DEVICE_DATA)
     MOCK_STATIC_METHOD_1(, void, CodeFirst_DestroyDevice, void*, device)
@@ -262,6 +264,7 @@ DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , SCHEMA_HANDLE, CodeFirst_Registe
 DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , SCHEMA_MODEL_TYPE_HANDLE, Schema_GetModelByName, SCHEMA_HANDLE, schemaHandle, const char*, modelName);
 DECLARE_GLOBAL_MOCK_METHOD_4(AgentMacroMocks, , void*, CodeFirst_CreateDevice, SCHEMA_MODEL_TYPE_HANDLE, model, const REFLECTED_DATA_FROM_DATAPROVIDER*, metadata, size_t, dataSize, bool, includePropertyPath);
 DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , EXECUTE_COMMAND_RESULT, CodeFirst_ExecuteCommand, void*, device, const char*, command)
+DECLARE_GLOBAL_MOCK_METHOD_3(AgentMacroMocks, , EXECUTE_COMMAND_RESULT, CodeFirst_ExecuteCommandCBOR, void*, device, const unsigned char*, command, size_t, size)
 DECLARE_GLOBAL_MOCK_METHOD_1(AgentMacroMocks, , void, CodeFirst_DestroyDevice, void*, device);
 
 DECLARE_GLOBAL_MOCK_METHOD_0(AgentMacroMocks, , STRING_HANDLE, STRING_new);
@@ -1090,4 +1093,27 @@ BEGIN_TEST_SUITE(AgentMacros_ut)
         DESTROY_MODEL_INSTANCE(jukebox);
     }
 
+    /*Tests_SRS_SERIALIZER_H_09_010: [ EXECUTE_COMMAND_CBOR macro shall call CodeFirst_ExecuteCommandCBOR passing device, command and size. ]*/
+    TEST_FUNCTION(EXECUTE_COMMAND_CBOR_calls_CodeFirst_ExecuteCommandCBOR)
+    {
+        /// arrange
+        static const unsigned char command[] = { 0xA1, 0x64, 'N', 'a', 'm', 'e', 0x67, 'S', 'h', 'u', 'f', 'f', 'l', 'e' };
+        AgentMacroMocks macroMocks;
+        JukeBox* jukebox = CREATE_MODEL_INSTANCE(JukeBoxes, JukeBox);
+        macroMocks.ResetAllCalls();
+
+        STRICT_EXPECTED_CALL(macroMocks, CodeFirst_ExecuteCommandCBOR(jukebox, command, sizeof(command)))
+            .SetReturn(EXECUTE_COMMAND_FAILED);
+
+        /// act
+        auto result = EXECUTE_COMMAND_CBOR(jukebox, command, sizeof(command));
+
+        /// assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result);
+        macroMocks.AssertActualAndExpectedCalls();
+
+        /// cleanup
+        DESTROY_MODEL_INSTANCE(jukebox);
+    }
+
 END_TEST_SUITE(AgentMacros_ut)
@@ -0,0 +1,534 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdbool.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+
+#include "real_strings.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "agenttypesystem.h"
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    int real_mallocAndStrcpy_s(char** destination, const char* source);
+#ifdef __cplusplus
+}
+#endif
+#undef ENABLE_MOCKS
+
+#include "multitree.h"
+#include "cbordecoder.h"
+
+TEST_DEFINE_ENUM_TYPE(CBOR_DECODER_RESULT, CBOR_DECODER_RESULT_VALUES);
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+#define TEST_AGENT_DATA_TYPE_TEXT "\"AgentDataTypes_ToString text\""
+
+static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
+{
+    (void)value;
+    (void)real_STRING_concat(destination, TEST_AGENT_DATA_TYPE_TEXT);
+    return AGENT_DATA_TYPES_OK;
+}
+
+/*decodes cbor, which has to succeed, into a MultiTree that the caller destroys*/
+static MULTITREE_HANDLE decode_successfully(const unsigned char* cbor, size_t size)
+{
+    MULTITREE_HANDLE result;
+    ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_OK, CBORDecoder_CBOR_To_MultiTree(cbor, size, &result));
+    ASSERT_IS_NOT_NULL(result);
+    return result;
+}
+
+static void assert_leaf_value(MULTITREE_HANDLE tree, const char* path, const char* expected)
+{
+    const void* value;
+    ASSERT_ARE_EQUAL(int, (int)MULTITREE_OK, (int)MultiTree_GetLeafValue(tree, path, &value));
+    ASSERT_ARE_EQUAL(char_ptr, expected, (const char*)value);
+}
+
+static void assert_child_count(MULTITREE_HANDLE tree, size_t expected)
+{
+    size_t count;
+    ASSERT_ARE_EQUAL(int, (int)MULTITREE_OK, (int)MultiTree_GetChildCount(tree, &count));
+    ASSERT_ARE_EQUAL(size_t, expected, count);
+}
+
+static void assert_decode_fails(const unsigned char* cbor, size_t size, CBOR_DECODER_RESULT expected)
+{
+    MULTITREE_HANDLE tree;
+    ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, expected, CBORDecoder_CBOR_To_MultiTree(cbor, size, &tree));
+}
+
+BEGIN_TEST_SUITE(cbordecoder_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+    (void)umocktypes_charptr_register_types();
+    (void)umocktypes_stdint_register_types();
+
+    REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(AGENT_DATA_TYPES_RESULT, int);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_STRING_GLOBAL_MOCK_HOOK;
+
+    REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, real_mallocAndStrcpy_s);
+    REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_ToString, my_AgentDataTypes_ToString);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_001: [ If cbor or multiTreeHandle are NULL, or size is 0, CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_INVALID_ARG. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_NULL_cbor_fails)
+{
+    ///arrange
+    MULTITREE_HANDLE tree;
+
+    ///act
+    CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(NULL, 1, &tree);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_CBOR_DECODER_09_001: [ If cbor or multiTreeHandle are NULL, or size is 0, CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_INVALID_ARG. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_size_0_fails)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA0 };
+    MULTITREE_HANDLE tree;
+
+    ///act
+    CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, 0, &tree);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_CBOR_DECODER_09_001: [ If cbor or multiTreeHandle are NULL, or size is 0, CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_INVALID_ARG. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_NULL_multiTreeHandle_fails)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA0 };
+
+    ///act
+    CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_CBOR_DECODER_09_002: [ The outermost item shall be a map or an array; anything else shall make CBORDecoder_CBOR_To_MultiTree return CBOR_DECODER_PARSE_ERROR. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_an_integer_as_outermost_item_fails)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0x01 };
+
+    ///act & assert
+    assert_decode_fails(cbor, sizeof(cbor), CBOR_DECODER_PARSE_ERROR);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_019: [ On success CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_OK and the MultiTree in *multiTreeHandle; the values of the tree are freed by MultiTree_Destroy. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_an_empty_map_succeeds)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA0 };
+
+    ///act
+    MULTITREE_HANDLE tree = decode_successfully(cbor, sizeof(cbor));
+
+    ///assert
+    assert_child_count(tree, 0);
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_003: [ Every entry of a map shall be added as a child of the node, named after the key. ]*/
+/*Tests_SRS_CBOR_DECODER_09_008: [ Unsigned and negative integers shall be decoded as their decimal text. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_decodes_integers_as_their_decimal_text)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA4,
+        0x61, 'a', 0x18, 0xC8,
+        0x61, 'b', 0x39, 0x01, 0xF3,
+        0x61, 'c', 0x1B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0x61, 'd', 0x3B, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+    ///act
+    MULTITREE_HANDLE tree = decode_successfully(cbor, sizeof(cbor));
+
+    ///assert
+    assert_child_count(tree, 4);
+    assert_leaf_value(tree, "a", "200");
+    assert_leaf_value(tree, "b", "-500");
+    assert_leaf_value(tree, "c", "18446744073709551615");
+    assert_leaf_value(tree, "d", "-9223372036854775808");
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_010: [ Text strings shall be decoded as their characters between quotes, without any escaping, so that the value reaches the action unchanged. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_decodes_text_strings_between_quotes)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA2,
+        0x61, 'a', 0x62, 'h', 'i',
+        0x61, 'b', 0x60 };
+
+    ///act
+    MULTITREE_HANDLE tree = decode_successfully(cbor, sizeof(cbor));
+
+    ///assert
+    assert_leaf_value(tree, "a", "\"hi\"");
+    assert_leaf_value(tree, "b", "\"\"");
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_014: [ false, true and null shall be decoded as false, true and null. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_decodes_false_true_and_null)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA3, 0x61, 'a', 0xF4, 0x61, 'b', 0xF5, 0x61, 'c', 0xF6 };
+
+    ///act
+    MULTITREE_HANDLE tree = decode_successfully(cbor, sizeof(cbor));
+
+    ///assert
+    assert_leaf_value(tree, "a", "false");
+    assert_leaf_value(tree, "b", "true");
+    assert_leaf_value(tree, "c", "null");
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_011: [ Half, single and double precision floats shall be decoded as the text FloatFormat_Double produces for their value. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_decodes_floats_as_their_text)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA3,
+        0x61, 'a', 0xF9, 0x3E, 0x00,
+        0x61, 'b', 0xFA, 0x41, 0x28, 0x00, 0x00,
+        0x61, 'c', 0xFB, 0x3F, 0xB9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A };
+
+    ///act
+    MULTITREE_HANDLE tree = decode_successfully(cbor, sizeof(cbor));
+
+    ///assert
+    assert_leaf_value(tree, "a", "1.5");
+    assert_leaf_value(tree, "b", "10.5");
+    assert_leaf_value(tree, "c", "0.1");
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_020: [ NaN, INF and -INF shall be decoded as "NaN", "INF" and "-INF" between quotes, like CreateAgentDataType_From_String expects them. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_decodes_NaN_and_infinities_between_quotes)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA3,
+        0x61, 'a', 0xF9, 0x7E, 0x00,
+        0x61, 'b', 0xF9, 0x7C, 0x00,
+        0x61, 'c', 0xF9, 0xFC, 0x00 };
+
+    ///act
+    MULTITREE_HANDLE tree = decode_successfully(cbor, sizeof(cbor));
+
+    ///assert
+    assert_leaf_value(tree, "a", "\"NaN\"");
+    assert_leaf_value(tree, "b", "\"INF\"");
+    assert_leaf_value(tree, "c", "\"-INF\"");
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_009: [ Byte strings shall be decoded as the base64 text, between quotes, that AgentDataTypes_ToString produces for EDM_BINARY. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_decodes_byte_strings_with_AgentDataTypes_ToString)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA1, 0x61, 'a', 0x43, 0x01, 0x02, 0x03 };
+    MULTITREE_HANDLE tree;
+
+    STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+
+    ///act
+    tree = decode_successfully(cbor, sizeof(cbor));
+
+    ///assert
+    assert_leaf_value(tree, "a", TEST_AGENT_DATA_TYPE_TEXT);
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_012: [ Tag 37 followed by a byte string of 16 bytes shall be decoded as the GUID text, between quotes, that AgentDataTypes_ToString produces for EDM_GUID. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_decodes_a_GUID_with_AgentDataTypes_ToString)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA1, 0x61, 'a', 0xD8, 0x25, 0x50,
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F };
+    MULTITREE_HANDLE tree;
+
+    STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+
+    ///act
+    tree = decode_successfully(cbor, sizeof(cbor));
+
+    ///assert
+    assert_leaf_value(tree, "a", TEST_AGENT_DATA_TYPE_TEXT);
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_013: [ Any other tag shall be ignored and the tagged item decoded as if it was not tagged. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_ignores_other_tags)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA2,
+        0x61, 'a', 0xC1, 0x1A, 0x5A, 0x00, 0x00, 0x00,
+        0x61, 'b', 0xD8, 0x25, 0x61, 'x' };
+
+    ///act
+    MULTITREE_HANDLE tree = decode_successfully(cbor, sizeof(cbor));
+
+    ///assert
+    assert_leaf_value(tree, "a", "1509949440");
+    assert_leaf_value(tree, "b", "\"x\"");
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_003: [ Every entry of a map shall be added as a child of the node, named after the key. ]*/
+/*Tests_SRS_CBOR_DECODER_09_005: [ Every element of an array shall be added as a child of the node, named after its index, like JSONDecoder_JSON_To_MultiTree does. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_decodes_nested_maps_and_arrays)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA1, 0x61, 'a', 0x82, 0x01, 0xA1, 0x61, 'b', 0x02 };
+
+    ///act
+    MULTITREE_HANDLE tree = decode_successfully(cbor, sizeof(cbor));
+
+    ///assert
+    assert_leaf_value(tree, "a/0", "1");
+    assert_leaf_value(tree, "a/1/b", "2");
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_005: [ Every element of an array shall be added as a child of the node, named after its index, like JSONDecoder_JSON_To_MultiTree does. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_an_array_as_outermost_item_succeeds)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0x82, 0x01, 0xF6 };
+
+    ///act
+    MULTITREE_HANDLE tree = decode_successfully(cbor, sizeof(cbor));
+
+    ///assert
+    assert_child_count(tree, 2);
+    assert_leaf_value(tree, "0", "1");
+    assert_leaf_value(tree, "1", "null");
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_004: [ The keys of maps shall be text strings; any other key shall make CBORDecoder_CBOR_To_MultiTree return CBOR_DECODER_PARSE_ERROR. ]*/
+/*Tests_SRS_CBOR_DECODER_09_018: [ On failure the MultiTree shall be destroyed. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_an_integer_key_fails)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA2, 0x61, 'a', 0x01, 0x01, 0x61, 'b' };
+
+    ///act & assert
+    assert_decode_fails(cbor, sizeof(cbor), CBOR_DECODER_PARSE_ERROR);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_006: [ Indefinite length items and the reserved additional information values 28 to 30 are not supported; CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_PARSE_ERROR for them. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_indefinite_length_items_fails)
+{
+    ///arrange
+    static const unsigned char indefiniteMap[] = { 0xBF, 0x61, 'a', 0x01, 0xFF };
+    static const unsigned char indefiniteArray[] = { 0xA1, 0x61, 'a', 0x9F, 0x01, 0xFF };
+    static const unsigned char indefiniteText[] = { 0xA1, 0x61, 'a', 0x7F, 0x61, 'x', 0xFF };
+    static const unsigned char reserved[] = { 0xA1, 0x61, 'a', 0x1C };
+
+    ///act & assert
+    assert_decode_fails(indefiniteMap, sizeof(indefiniteMap), CBOR_DECODER_PARSE_ERROR);
+    assert_decode_fails(indefiniteArray, sizeof(indefiniteArray), CBOR_DECODER_PARSE_ERROR);
+    assert_decode_fails(indefiniteText, sizeof(indefiniteText), CBOR_DECODER_PARSE_ERROR);
+    assert_decode_fails(reserved, sizeof(reserved), CBOR_DECODER_PARSE_ERROR);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_007: [ If maps, arrays and tags are nested more than CBOR_DECODER_MAX_DEPTH levels deep, CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_PARSE_ERROR. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_31_nested_arrays_succeeds)
+{
+    ///arrange
+    unsigned char cbor[32];
+    MULTITREE_HANDLE tree;
+    (void)memset(cbor, 0x81, 31);
+    cbor[31] = 0x01;
+
+    ///act
+    tree = decode_successfully(cbor, sizeof(cbor));
+
+    ///assert
+    assert_child_count(tree, 1);
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_007: [ If maps, arrays and tags are nested more than CBOR_DECODER_MAX_DEPTH levels deep, CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_PARSE_ERROR. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_32_nested_arrays_fails)
+{
+    ///arrange
+    unsigned char cbor[33];
+    (void)memset(cbor, 0x81, 32);
+    cbor[32] = 0x01;
+
+    ///act & assert
+    assert_decode_fails(cbor, sizeof(cbor), CBOR_DECODER_PARSE_ERROR);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_015: [ Any other simple value shall make CBORDecoder_CBOR_To_MultiTree return CBOR_DECODER_PARSE_ERROR. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_undefined_fails)
+{
+    ///arrange
+    static const unsigned char undefinedValue[] = { 0xA1, 0x61, 'a', 0xF7 };
+    static const unsigned char simpleValue[] = { 0xA1, 0x61, 'a', 0xF8, 0x20 };
+
+    ///act & assert
+    assert_decode_fails(undefinedValue, sizeof(undefinedValue), CBOR_DECODER_PARSE_ERROR);
+    assert_decode_fails(simpleValue, sizeof(simpleValue), CBOR_DECODER_PARSE_ERROR);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_017: [ If there are bytes after the outermost item, CBORDecoder_CBOR_To_MultiTree shall return CBOR_DECODER_PARSE_ERROR. ]*/
+/*Tests_SRS_CBOR_DECODER_09_018: [ On failure the MultiTree shall be destroyed. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_bytes_after_the_outermost_item_fails)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA1, 0x61, 'a', 0x01, 0xFF };
+
+    ///act & assert
+    assert_decode_fails(cbor, sizeof(cbor), CBOR_DECODER_PARSE_ERROR);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_018: [ On failure the MultiTree shall be destroyed. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_with_truncated_data_fails)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA2, 0x61, 'a', 0x62, 'h', 'i', 0x61, 'b', 0x1A, 0x00 };
+
+    ///act & assert
+    assert_decode_fails(cbor, sizeof(cbor), CBOR_DECODER_PARSE_ERROR);
+}
+
+/*Tests_SRS_CBOR_DECODER_09_018: [ On failure the MultiTree shall be destroyed. ]*/
+TEST_FUNCTION(CBORDecoder_CBOR_To_MultiTree_fails_when_copying_a_value_fails)
+{
+    ///arrange
+    static const unsigned char cbor[] = { 0xA2, 0x61, 'a', 0x01, 0x61, 'b', 0xF5 };
+    MULTITREE_HANDLE tree;
+
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "1"))
+        .IgnoreArgument_destination();
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "true"))
+        .IgnoreArgument_destination()
+        .SetReturn(__LINE__);
+
+    ///act
+    CBOR_DECODER_RESULT result = CBORDecoder_CBOR_To_MultiTree(cbor, sizeof(cbor), &tree);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_DECODER_RESULT, CBOR_DECODER_ERROR, result);
+}
+
+END_TEST_SUITE(cbordecoder_ut)
@@ -0,0 +1,554 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+
+#include "real_strings.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "agenttypesystem.h"
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    int real_mallocAndStrcpy_s(char** destination, const char* source);
+#ifdef __cplusplus
+}
+#endif
+#undef ENABLE_MOCKS
+
+#include "multitree.h"
+#include "cborencoder.h"
+
+TEST_DEFINE_ENUM_TYPE(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+#define TEST_DATE_TIME_TEXT "2017-04-05T08:00:00Z"
+
+/*AgentDataTypes_ToString is only called for the types that are written as their text*/
+static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
+{
+    (void)value;
+    (void)real_STRING_concat(destination, "\"" TEST_DATE_TIME_TEXT "\"");
+    return AGENT_DATA_TYPES_OK;
+}
+
+/*the leaves of the trees are AGENT_DATA_TYPE* owned by the test, as in DataMarshaller*/
+static int NoCloneFunction(void** destination, const void* source)
+{
+    *destination = (void*)source;
+    return 0;
+}
+
+static void NoFreeFunction(void* value)
+{
+    (void)value;
+}
+
+static MULTITREE_HANDLE createTreeWithOneLeaf(const char* path, const AGENT_DATA_TYPE* value)
+{
+    MULTITREE_HANDLE result = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(int, (int)MULTITREE_OK, (int)MultiTree_AddLeaf(result, path, value));
+    return result;
+}
+
+/*encodes the tree and compares the output with expected*/
+static void assert_encoded_tree(MULTITREE_HANDLE tree, size_t initialCapacity, const unsigned char* expected, size_t expectedSize)
+{
+    unsigned char* destination;
+    size_t destinationSize;
+
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, CBOREncoder_EncodeTree(tree, initialCapacity, &destination, &destinationSize));
+    ASSERT_ARE_EQUAL(size_t, expectedSize, destinationSize);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(expected, destination, destinationSize));
+
+    my_gballoc_free(destination);
+}
+
+static void assert_encoded_leaf(const AGENT_DATA_TYPE* value, const unsigned char* expected, size_t expectedSize)
+{
+    MULTITREE_HANDLE tree = createTreeWithOneLeaf("a", value);
+    assert_encoded_tree(tree, 0, expected, expectedSize);
+    MultiTree_Destroy(tree);
+}
+
+BEGIN_TEST_SUITE(cborencoder_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+    (void)umocktypes_charptr_register_types();
+    (void)umocktypes_stdint_register_types();
+
+    REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(AGENT_DATA_TYPES_RESULT, int);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_STRING_GLOBAL_MOCK_HOOK;
+
+    REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, real_mallocAndStrcpy_s);
+    REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_ToString, my_AgentDataTypes_ToString);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_001: [ If treeHandle, destination or destinationSize are NULL, CBOREncoder_EncodeTree shall fail and return CBOR_ENCODER_INVALID_ARG. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_with_NULL_treeHandle_fails)
+{
+    ///arrange
+    unsigned char* destination;
+    size_t destinationSize;
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(NULL, 0, &destination, &destinationSize);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_001: [ If treeHandle, destination or destinationSize are NULL, CBOREncoder_EncodeTree shall fail and return CBOR_ENCODER_INVALID_ARG. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_with_NULL_destination_fails)
+{
+    ///arrange
+    size_t destinationSize;
+    MULTITREE_HANDLE tree = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+    umock_c_reset_all_calls();
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(tree, 0, NULL, &destinationSize);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_001: [ If treeHandle, destination or destinationSize are NULL, CBOREncoder_EncodeTree shall fail and return CBOR_ENCODER_INVALID_ARG. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_with_NULL_destinationSize_fails)
+{
+    ///arrange
+    unsigned char* destination;
+    MULTITREE_HANDLE tree = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+    umock_c_reset_all_calls();
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(tree, 0, &destination, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_002: [ CBOREncoder_EncodeTree shall write into a buffer of initialCapacity bytes (a default capacity when initialCapacity is 0). ]*/
+/*Tests_SRS_CBOR_ENCODER_09_003: [ On success CBOREncoder_EncodeTree shall hand the buffer over to the caller in *destination and *destinationSize without copying it and return CBOR_ENCODER_OK; the caller frees it with free. ]*/
+/*Tests_SRS_CBOR_ENCODER_09_005: [ Every node shall be written as a map with as many entries as the node has children; every entry shall be the name of the child as a text string followed by the child's value. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_with_an_empty_tree_writes_an_empty_map)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xA0 };
+    unsigned char* destination;
+    size_t destinationSize;
+    MULTITREE_HANDLE tree = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(42));
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(tree, 42, &destination, &destinationSize);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(expected), destinationSize);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(expected, destination, destinationSize));
+
+    ///cleanup
+    my_gballoc_free(destination);
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_006: [ A child that has children shall be written as a nested map. ]*/
+/*Tests_SRS_CBOR_ENCODER_09_007: [ A child with zero children shall be written from its value, which is an AGENT_DATA_TYPE*. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_writes_nested_nodes_as_nested_maps)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xA2, 0x61, 'a', 0xA1, 0x61, 'b', 0x01, 0x61, 'c', 0x02 };
+    AGENT_DATA_TYPE one;
+    AGENT_DATA_TYPE two;
+    MULTITREE_HANDLE tree;
+    one.type = EDM_INT32_TYPE;
+    one.value.edmInt32.value = 1;
+    two.type = EDM_INT32_TYPE;
+    two.value.edmInt32.value = 2;
+    tree = createTreeWithOneLeaf("a/b", &one);
+    ASSERT_ARE_EQUAL(int, (int)MULTITREE_OK, (int)MultiTree_AddLeaf(tree, "c", &two));
+
+    ///act & assert
+    assert_encoded_tree(tree, 0, expected, sizeof(expected));
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_008: [ EDM_NULL shall be written as null and EDM_BOOLEAN as false or true. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_writes_null_and_booleans_as_simple_values)
+{
+    ///arrange
+    static const unsigned char expectedNull[] = { 0xA1, 0x61, 'a', 0xF6 };
+    static const unsigned char expectedFalse[] = { 0xA1, 0x61, 'a', 0xF4 };
+    static const unsigned char expectedTrue[] = { 0xA1, 0x61, 'a', 0xF5 };
+    AGENT_DATA_TYPE value;
+
+    ///act & assert
+    value.type = EDM_NULL_TYPE;
+    assert_encoded_leaf(&value, expectedNull, sizeof(expectedNull));
+    value.type = EDM_BOOLEAN_TYPE;
+    value.value.edmBoolean.value = EDM_FALSE;
+    assert_encoded_leaf(&value, expectedFalse, sizeof(expectedFalse));
+    value.value.edmBoolean.value = EDM_TRUE;
+    assert_encoded_leaf(&value, expectedTrue, sizeof(expectedTrue));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_009: [ EDM_BYTE, EDM_SBYTE, EDM_INT16, EDM_INT32 and EDM_INT64 shall be written as unsigned or negative integers in their shortest form. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_writes_integers_in_their_shortest_form)
+{
+    ///arrange
+    static const unsigned char expectedByte[] = { 0xA1, 0x61, 'a', 0x18, 0xC8 };
+    static const unsigned char expectedSbyte[] = { 0xA1, 0x61, 'a', 0x20 };
+    static const unsigned char expectedInt16[] = { 0xA1, 0x61, 'a', 0x39, 0x01, 0xF3 };
+    static const unsigned char expectedInt32[] = { 0xA1, 0x61, 'a', 0x1A, 0x00, 0x01, 0x86, 0xA0 };
+    static const unsigned char expectedInt64[] = { 0xA1, 0x61, 'a', 0x3B, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    AGENT_DATA_TYPE value;
+
+    ///act & assert
+    value.type = EDM_BYTE_TYPE;
+    value.value.edmByte.value = 200;
+    assert_encoded_leaf(&value, expectedByte, sizeof(expectedByte));
+    value.type = EDM_SBYTE_TYPE;
+    value.value.edmSbyte.value = -1;
+    assert_encoded_leaf(&value, expectedSbyte, sizeof(expectedSbyte));
+    value.type = EDM_INT16_TYPE;
+    value.value.edmInt16.value = -500;
+    assert_encoded_leaf(&value, expectedInt16, sizeof(expectedInt16));
+    value.type = EDM_INT32_TYPE;
+    value.value.edmInt32.value = 100000;
+    assert_encoded_leaf(&value, expectedInt32, sizeof(expectedInt32));
+    value.type = EDM_INT64_TYPE;
+    value.value.edmInt64.value = INT64_MIN;
+    assert_encoded_leaf(&value, expectedInt64, sizeof(expectedInt64));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_010: [ EDM_DOUBLE and EDM_SINGLE shall be written as a single precision float when that keeps the exact value and as a double precision float otherwise; NaN, INF and -INF shall be written as half precision floats. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_writes_floating_point_values_in_the_shortest_exact_form)
+{
+    ///arrange
+    static const unsigned char expectedSingle[] = { 0xA1, 0x61, 'a', 0xFA, 0x41, 0x28, 0x00, 0x00 };
+    static const unsigned char expectedDoubleAsSingle[] = { 0xA1, 0x61, 'a', 0xFA, 0x3F, 0xC0, 0x00, 0x00 };
+    static const unsigned char expectedDouble[] = { 0xA1, 0x61, 'a', 0xFB, 0x3F, 0xB9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A };
+    static const unsigned char expectedNaN[] = { 0xA1, 0x61, 'a', 0xF9, 0x7E, 0x00 };
+    static const unsigned char expectedINF[] = { 0xA1, 0x61, 'a', 0xF9, 0x7C, 0x00 };
+    static const unsigned char expectedMinusINF[] = { 0xA1, 0x61, 'a', 0xF9, 0xFC, 0x00 };
+    AGENT_DATA_TYPE value;
+
+    ///act & assert
+    value.type = EDM_SINGLE_TYPE;
+    value.value.edmSingle.value = 10.5f;
+    assert_encoded_leaf(&value, expectedSingle, sizeof(expectedSingle));
+    value.type = EDM_DOUBLE_TYPE;
+    value.value.edmDouble.value = 1.5;
+    assert_encoded_leaf(&value, expectedDoubleAsSingle, sizeof(expectedDoubleAsSingle));
+    value.value.edmDouble.value = 0.1;
+    assert_encoded_leaf(&value, expectedDouble, sizeof(expectedDouble));
+    value.value.edmDouble.value = NAN;
+    assert_encoded_leaf(&value, expectedNaN, sizeof(expectedNaN));
+    value.value.edmDouble.value = INFINITY;
+    assert_encoded_leaf(&value, expectedINF, sizeof(expectedINF));
+    value.value.edmDouble.value = -INFINITY;
+    assert_encoded_leaf(&value, expectedMinusINF, sizeof(expectedMinusINF));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_011: [ EDM_STRING and EDM_STRING_NO_QUOTES shall be written as text strings, without quotes or escapes. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_writes_strings_as_text_strings_without_escapes)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xA1, 0x61, 'a', 0x64, 'a', '"', '\\', 'b' };
+    static const char chars[] = "a\"\\b";
+    AGENT_DATA_TYPE value;
+
+    ///act & assert
+    value.type = EDM_STRING_TYPE;
+    value.value.edmString.chars = (char*)chars;
+    value.value.edmString.length = sizeof(chars) - 1;
+    assert_encoded_leaf(&value, expected, sizeof(expected));
+    value.type = EDM_STRING_NO_QUOTES_TYPE;
+    value.value.edmStringNoQuotes.chars = (char*)chars;
+    value.value.edmStringNoQuotes.length = sizeof(chars) - 1;
+    assert_encoded_leaf(&value, expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_012: [ EDM_BINARY shall be written as a byte string. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_writes_binary_as_a_byte_string)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xA1, 0x61, 'a', 0x43, 0x01, 0x02, 0x03 };
+    static unsigned char data[] = { 0x01, 0x02, 0x03 };
+    AGENT_DATA_TYPE value;
+
+    ///act & assert
+    value.type = EDM_BINARY_TYPE;
+    value.value.edmBinary.data = data;
+    value.value.edmBinary.size = sizeof(data);
+    assert_encoded_leaf(&value, expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_013: [ EDM_GUID shall be written as tag 37 followed by a byte string with the 16 bytes of the GUID. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_writes_a_GUID_as_a_tagged_byte_string)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xA1, 0x61, 'a', 0xD8, 0x25, 0x50,
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF };
+    AGENT_DATA_TYPE value;
+
+    ///act & assert
+    value.type = EDM_GUID_TYPE;
+    (void)memcpy(value.value.edmGuid.GUID, expected + 6, 16);
+    assert_encoded_leaf(&value, expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_014: [ EDM_COMPLEX_TYPE shall be written as a map from the name of every field to its value. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_writes_a_struct_as_a_map)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xA1, 0x61, 'a', 0xA2, 0x61, 'x', 0x0A, 0x61, 'y', 0xF5 };
+    AGENT_DATA_TYPE x;
+    AGENT_DATA_TYPE y;
+    COMPLEX_TYPE_FIELD_TYPE fields[2];
+    AGENT_DATA_TYPE value;
+    x.type = EDM_INT32_TYPE;
+    x.value.edmInt32.value = 10;
+    y.type = EDM_BOOLEAN_TYPE;
+    y.value.edmBoolean.value = EDM_TRUE;
+    fields[0].fieldName = "x";
+    fields[0].value = &x;
+    fields[1].fieldName = "y";
+    fields[1].value = &y;
+
+    ///act & assert
+    value.type = EDM_COMPLEX_TYPE_TYPE;
+    value.value.edmComplexType.nMembers = 2;
+    value.value.edmComplexType.fields = fields;
+    assert_encoded_leaf(&value, expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_015: [ EDM_DATE_TIME_OFFSET shall be written as tag 0 followed by the text AgentDataTypes_ToString produces for it, without quotes. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_writes_a_date_time_offset_as_a_tagged_text_string)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xA1, 0x61, 'a', 0xC0, 0x74,
+        '2', '0', '1', '7', '-', '0', '4', '-', '0', '5', 'T', '0', '8', ':', '0', '0', ':', '0', '0', 'Z' };
+    AGENT_DATA_TYPE value;
+    MULTITREE_HANDLE tree;
+    value.type = EDM_DATE_TIME_OFFSET_TYPE;
+    tree = createTreeWithOneLeaf("a", &value);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, &value))
+        .IgnoreArgument_destination();
+
+    ///act & assert
+    assert_encoded_tree(tree, 0, expected, sizeof(expected));
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_016: [ Any other type shall be written as a text string with the text AgentDataTypes_ToString produces for it, without quotes. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_writes_other_types_as_their_text)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xA1, 0x61, 'a', 0x74,
+        '2', '0', '1', '7', '-', '0', '4', '-', '0', '5', 'T', '0', '8', ':', '0', '0', ':', '0', '0', 'Z' };
+    AGENT_DATA_TYPE value;
+
+    ///act & assert
+    value.type = EDM_DECIMAL_TYPE;
+    assert_encoded_leaf(&value, expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_004: [ When the buffer is too small, it shall grow to at least twice its current capacity. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_grows_the_buffer)
+{
+    ///arrange
+    unsigned char expected[3 + 3 + 300];
+    char chars[300];
+    AGENT_DATA_TYPE value;
+    MULTITREE_HANDLE tree;
+    (void)memset(chars, 'x', sizeof(chars));
+    value.type = EDM_STRING_TYPE;
+    value.value.edmString.chars = chars;
+    value.value.edmString.length = sizeof(chars);
+    tree = createTreeWithOneLeaf("a", &value);
+    expected[0] = 0xA1;
+    expected[1] = 0x61;
+    expected[2] = 'a';
+    expected[3] = 0x79;
+    expected[4] = 0x01;
+    expected[5] = 0x2C;
+    (void)memset(expected + 6, 'x', sizeof(chars));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(1));
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 2))
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 4))
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 8))
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 306))
+        .IgnoreArgument_ptr();
+
+    ///act & assert
+    assert_encoded_tree(tree, 1, expected, sizeof(expected));
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_018: [ If any other failure occurs CBOREncoder_EncodeTree shall return CBOR_ENCODER_ERROR. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_fails_when_allocating_the_buffer_fails)
+{
+    ///arrange
+    unsigned char* destination;
+    size_t destinationSize;
+    MULTITREE_HANDLE tree = MultiTree_Create(NoCloneFunction, NoFreeFunction);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument_size()
+        .SetReturn(NULL);
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(tree, 0, &destination, &destinationSize);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_ERROR, result);
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_018: [ If any other failure occurs CBOREncoder_EncodeTree shall return CBOR_ENCODER_ERROR. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_fails_and_frees_the_buffer_when_growing_it_fails)
+{
+    ///arrange
+    unsigned char* destination;
+    size_t destinationSize;
+    char chars[300];
+    AGENT_DATA_TYPE value;
+    MULTITREE_HANDLE tree;
+    (void)memset(chars, 'x', sizeof(chars));
+    value.type = EDM_STRING_TYPE;
+    value.value.edmString.chars = chars;
+    value.value.edmString.length = sizeof(chars);
+    tree = createTreeWithOneLeaf("a", &value);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+        .IgnoreAllArguments()
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument_ptr();
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(tree, 0, &destination, &destinationSize);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_ERROR, result);
+
+    ///cleanup
+    MultiTree_Destroy(tree);
+}
+
+END_TEST_SUITE(cborencoder_ut)
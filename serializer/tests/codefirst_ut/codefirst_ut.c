@@ -501,6 +501,16 @@ static AGENT_DATA_TYPES_RESULT my_Create_AGENT_DATA_TYPE_from_SINT32(AGENT_DATA_
     return AGENT_DATA_TYPES_OK;
 }
 
+/*AgentDataTypes_ToString appends the scripted texts in turn, one per call (for SimpleDevice_Model: new_reported_this_is_int, then new_reported_this_is_double)*/
+static const char* AgentDataTypes_ToString_texts[2];
+static size_t AgentDataTypes_ToString_count;
+static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
+{
+    (void)value;
+    (void)real_STRING_concat(destination, AgentDataTypes_ToString_texts[AgentDataTypes_ToString_count++ % (sizeof(AgentDataTypes_ToString_texts) / sizeof(AgentDataTypes_ToString_texts[0]))]);
+    return AGENT_DATA_TYPES_OK;
+}
+
 static void* toBeCleaned = NULL; /*this variable exists because bad semantics in _CancelTransaction/EndTransaction.*/
 static TRANSACTION_HANDLE my_Device_StartTransaction(DEVICE_HANDLE deviceHandle)
 {
@@ -736,6 +746,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_MODEL_TYPE_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(pfDeviceActionCallback, void*);
         REGISTER_UMOCK_ALIAS_TYPE(DEVICE_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(const DATA_MARSHALLER_ENCODER*, void*);
         REGISTER_UMOCK_ALIAS_TYPE(TRANSACTION_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_STRUCT_TYPE_HANDLE, void*);
@@ -804,6 +815,9 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
 
         REGISTER_GLOBAL_MOCK_HOOK(Device_DestroyTransaction_ReportedProperties, my_Device_DestroyTransaction_ReportedProperties);
         
+        REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_ToString, my_AgentDataTypes_ToString);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(AgentDataTypes_ToString, AGENT_DATA_TYPES_ERROR);
+
         REGISTER_GLOBAL_MOCK_HOOK(Schema_GetModelDesiredPropertyCount, my_Schema_GetModelDesiredPropertyCount);
         REGISTER_GLOBAL_MOCK_HOOK(Schema_GetModelModelCount, my_Schema_GetModelModelCount);
         
@@ -1819,6 +1833,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         
         STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
 
         // act
         void* result = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, 1, false);
@@ -1848,6 +1863,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
             .IgnoreArgument_callbackUserContext();
         STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
 
         // act
         void* result = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, 1, false);
@@ -1878,6 +1894,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
             .IgnoreArgument_callbackUserContext();
         STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
 
         // act
         void* result = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, 1, true);
@@ -1912,6 +1929,71 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         CodeFirst_Deinit();
     }
 
+    /*Tests_SRS_CODEFIRST_09_003: [ If building the offset tables fails, CodeFirst_CreateDevice shall fail and return NULL. ]*/
+    TEST_FUNCTION(When_Schema_GetModelName_Fails_Then_CodeFirst_CreateDevice_Fails)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        size_t zero = 0;
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyCount(TEST_MODEL_HANDLE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_desiredPropertyCount(&zero, sizeof(zero));
+        STRICT_EXPECTED_CALL(Schema_GetModelModelCount(TEST_MODEL_HANDLE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_modelCount(&zero, sizeof(zero));
+        STRICT_EXPECTED_CALL(Device_Create(TEST_MODEL_HANDLE, CodeFirst_InvokeAction, TEST_CALLBACK_CONTEXT, CodeFirst_InvokeMethod, TEST_CALLBACK_CONTEXT, false, IGNORED_PTR_ARG))
+            .IgnoreArgument_deviceHandle()
+            .IgnoreArgument_methodCallbackContext()
+            .IgnoreArgument_callbackUserContext();
+        STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE))
+            .SetReturn(NULL);
+        STRICT_EXPECTED_CALL(Schema_ReleaseDeviceRef(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(Device_Destroy(TEST_DEVICE_HANDLE));
+
+        // act
+        void* result = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, 1, false);
+
+        // assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_002: [ Devices created from the same model and reflected data shall share the same tables. ]*/
+    TEST_FUNCTION(CodeFirst_CreateDevice_For_A_Model_That_Already_Has_A_Device_Reuses_Its_Offset_Tables)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device1 = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        umock_c_reset_all_calls();
+
+        size_t zero = 0;
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyCount(TEST_MODEL_HANDLE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_desiredPropertyCount(&zero, sizeof(zero));
+        STRICT_EXPECTED_CALL(Schema_GetModelModelCount(TEST_MODEL_HANDLE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_modelCount(&zero, sizeof(zero));
+        STRICT_EXPECTED_CALL(Device_Create(TEST_MODEL_HANDLE, CodeFirst_InvokeAction, TEST_CALLBACK_CONTEXT, CodeFirst_InvokeMethod, TEST_CALLBACK_CONTEXT, false, IGNORED_PTR_ARG))
+            .IgnoreArgument_deviceHandle()
+            .IgnoreArgument_methodCallbackContext()
+            .IgnoreArgument_callbackUserContext();
+        STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+
+        // act
+        SimpleDevice_Model* device2 = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+
+        // assert
+        ASSERT_IS_NOT_NULL(device2);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device1);
+        CodeFirst_DestroyDevice(device2);
+        CodeFirst_Deinit();
+    }
+
     /* Tests_SRS_CODEFIRST_99_106:[If CodeFirst_CreateDevice is called when the modules is not initialized is shall return NULL.] */
     TEST_FUNCTION(CodeFirst_CreateDevice_When_The_Module_Is_Not_Initialized_Fails)
     {
@@ -2015,19 +2097,10 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2047,6 +2120,50 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         CodeFirst_Deinit();
     }
 
+    /*Tests_SRS_CODEFIRST_09_005: [ The device that a value belongs to shall be found by a binary search over the devices sorted by address. ]*/
+    /*Tests_SRS_CODEFIRST_09_006: [ CodeFirst_SendAsync shall find the property and its full path by a binary search in the properties offset table of the device, without allocating memory. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsync_With_One_Property_Of_One_Of_Many_Devices_Succeeds)
+    {
+        // arrange
+        SimpleDevice_Model* devices[5];
+        size_t i;
+        (void)CodeFirst_Init(NULL);
+        for (i = 0; i < sizeof(devices) / sizeof(devices[0]); i++)
+        {
+            devices[i] = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        }
+        CodeFirst_DestroyDevice(devices[1]);
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0));
+        STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(3);
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(2)
+            .IgnoreArgument(3);
+        devices[3]->this_is_int_Property = 3;
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsync(&destination, &destinationSize, 1, &devices[3]->this_is_int_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        CodeFirst_DestroyDevice(devices[0]);
+        CodeFirst_DestroyDevice(devices[2]);
+        CodeFirst_DestroyDevice(devices[3]);
+        CodeFirst_DestroyDevice(devices[4]);
+        CodeFirst_Deinit();
+    }
+
     /* Tests_SRS_CODEFIRST_99_088:[CodeFirst_SendAsync shall send to the Device module a set of properties.] */
     /* Tests_SRS_CODEFIRST_99_105:[The properties are passed as pointers to the memory locations where the data exists in the device block allocated by CodeFirst_CreateDevice.] */
     /* Tests_SRS_CODEFIRST_99_089:[The numProperties argument shall indicate how many properties are to be sent.] */
@@ -2066,33 +2183,15 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2150,20 +2249,11 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3).SetReturn(DEVICE_ERROR);
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2191,34 +2281,16 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3).SetReturn(DEVICE_ERROR);
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2247,19 +2319,10 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2315,10 +2378,6 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2347,15 +2406,8 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0))
             .SetReturn(AGENT_DATA_TYPES_ERROR);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2384,29 +2436,13 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0))
             .SetReturn(AGENT_DATA_TYPES_ERROR);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2435,19 +2471,10 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
@@ -2488,20 +2515,11 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
 
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2543,33 +2561,15 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, (double)(IGNORED_NUM_ARG)));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, (int32_t)(IGNORED_NUM_ARG)));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2785,29 +2785,15 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
     {
         // arrange
         (void)CodeFirst_Init(NULL);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
         OuterType* device = (OuterType*)CodeFirst_CreateDevice(TEST_OUTERTYPE_MODEL_HANDLE, &ALL_REFLECTED(testModelInModelReflected), sizeof(OuterType), false);
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, (double)(IGNORED_NUM_ARG)));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "Inner/this_is_double2", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2835,29 +2821,15 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
     {
         // arrange
         (void)CodeFirst_Init(NULL);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
         OuterType* device = (OuterType*)CodeFirst_CreateDevice(TEST_OUTERTYPE_MODEL_HANDLE, &ALL_REFLECTED(testModelInModelReflected), sizeof(OuterType), false);
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, (int32_t)(IGNORED_NUM_ARG)));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "Inner/this_is_int2", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2931,19 +2903,10 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         unsigned char* destination;
         size_t destinationSize;
@@ -3310,6 +3273,127 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         CodeFirst_Deinit();
     }
 
+    /*Tests_SRS_CODEFIRST_09_018: [ If parameter device or command is NULL then CodeFirst_ExecuteCommandCBOR shall return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CodeFirst_ExecuteCommandCBOR_With_NULL_device_fails)
+    {
+        ///arrange
+        static const unsigned char command[] = { 0xA0 };
+        (void)CodeFirst_Init(NULL);
+        umock_c_reset_all_calls();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CodeFirst_ExecuteCommandCBOR(NULL, command, sizeof(command));
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_019: [ If finding the device fails, then CodeFirst_ExecuteCommandCBOR shall return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CodeFirst_ExecuteCommandCBOR_fails_when_it_does_not_find_the_device)
+    {
+        ///arrange
+        static const unsigned char command[] = { 0xA0 };
+        (void)CodeFirst_Init(NULL);
+        umock_c_reset_all_calls();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CodeFirst_ExecuteCommandCBOR((unsigned char*)NULL + 1, command, sizeof(command));
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_020: [ Otherwise CodeFirst_ExecuteCommandCBOR shall call Device_ExecuteCommandCBOR and return what Device_ExecuteCommandCBOR is returning. ]*/
+    TEST_FUNCTION(CodeFirst_ExecuteCommandCBOR_calls_Device_ExecuteCommandCBOR)
+    {
+        ///arrange
+        static const unsigned char command[] = { 0xA0 };
+        (void)CodeFirst_Init(NULL);
+        void* device = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, sizeof(TruckType), false);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Device_ExecuteCommandCBOR(IGNORED_PTR_ARG, command, sizeof(command)))
+            .IgnoreArgument(1)
+            .SetReturn(EXECUTE_COMMAND_FAILED);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CodeFirst_ExecuteCommandCBOR(device, command, sizeof(command));
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_026: [ If device is NULL or is not the address of a device created by CodeFirst_CreateDevice then CodeFirst_GetEncoder shall return NULL. ]*/
+    TEST_FUNCTION(CodeFirst_GetEncoder_with_NULL_device_returns_NULL)
+    {
+        ///arrange
+
+        ///act
+        const DATA_MARSHALLER_ENCODER* result = CodeFirst_GetEncoder(NULL);
+
+        ///assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CODEFIRST_09_026: [ If device is NULL or is not the address of a device created by CodeFirst_CreateDevice then CodeFirst_GetEncoder shall return NULL. ]*/
+    TEST_FUNCTION(CodeFirst_GetEncoder_with_an_address_inside_a_device_returns_NULL)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        unsigned char* device = (unsigned char*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, sizeof(TruckType), false);
+        umock_c_reset_all_calls();
+
+        ///act
+        const DATA_MARSHALLER_ENCODER* result = CodeFirst_GetEncoder(device + 1);
+
+        ///assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_027: [ Otherwise CodeFirst_GetEncoder shall call Device_GetEncoder and return what Device_GetEncoder is returning. ]*/
+    TEST_FUNCTION(CodeFirst_GetEncoder_returns_what_Device_GetEncoder_returns)
+    {
+        ///arrange
+        static const DATA_MARSHALLER_ENCODER testEncoder = { "application/cbor", NULL, NULL };
+        (void)CodeFirst_Init(NULL);
+        void* device = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, sizeof(TruckType), false);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Device_GetEncoder(IGNORED_PTR_ARG))
+            .IgnoreArgument(1)
+            .SetReturn(&testEncoder);
+
+        ///act
+        const DATA_MARSHALLER_ENCODER* result = CodeFirst_GetEncoder(device);
+
+        ///assert
+        ASSERT_ARE_EQUAL(void_ptr, (void*)&testEncoder, (void*)result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
     /*Tests_SRS_CODEFIRST_02_017: [Otherwise CodeFirst_ExecuteCommand shall call Device_ExecuteCommand and return what Device_ExecuteCommand is returning.] */
     TEST_FUNCTION(CodeFirst_ExecuteCommand_calls_Device_ExecuteCommand)
     {
@@ -3478,6 +3562,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         size_t destinationSize = 1000;
         unsigned char *destination = (unsigned char*)my_gballoc_malloc(destinationSize);
         
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE)).SetReturn("TruckType");
         TruckType* device1 = (TruckType*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, sizeof(TruckType), false);
         TruckType* device2 = (TruckType*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, sizeof(TruckType), false);
         device1->reported_this_is_int = 1;
@@ -3486,22 +3571,12 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
 
         STRICT_EXPECTED_CALL(Device_CreateTransaction_ReportedProperties(IGNORED_PTR_ARG))
             .IgnoreArgument_deviceHandle();
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(IGNORED_PTR_ARG))
-            .IgnoreArgument_modelTypeHandle()
-            .SetReturn("TruckType");
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "reported_this_is_int"))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
             .IgnoreArgument_agentData()
             .IgnoreArgument_v();
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted_ReportedProperty(IGNORED_PTR_ARG, "reported_this_is_int", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument_data();
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
             .IgnoreArgument_agentData();
         STRICT_EXPECTED_CALL(Device_DestroyTransaction_ReportedProperties(IGNORED_PTR_ARG))
@@ -3528,17 +3603,13 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         (void)CodeFirst_Init(NULL);
         size_t destinationSize = 1000;
         unsigned char *destination = (unsigned char*)my_gballoc_malloc(destinationSize);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE)).SetReturn("TruckType");
         TruckType* device = (TruckType*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, sizeof(TruckType), false);
         device->reported_this_is_int = 3;
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_CreateTransaction_ReportedProperties(IGNORED_PTR_ARG))
             .IgnoreArgument_deviceHandle();
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(IGNORED_PTR_ARG))
-            .IgnoreArgument_modelTypeHandle();
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_DestroyTransaction_ReportedProperties(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
 
@@ -3699,21 +3770,12 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
 
     static void CodeFirst_SendReportedAsync_one_inert_path(void)
     {
-
         STRICT_EXPECTED_CALL(Device_CreateTransaction_ReportedProperties(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "new_reported_this_is_double"))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 5.5))
             .IgnoreArgument_agentData();
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted_ReportedProperty(IGNORED_PTR_ARG, "new_reported_this_is_double", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument_data();
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
             .IgnoreArgument_agentData();
         STRICT_EXPECTED_CALL(Device_CommitTransaction_ReportedProperties(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
@@ -3776,11 +3838,8 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
 
         size_t calls_that_cannot_fail[] =
         {
-            2,/*Schema_GetModelName*/
-            5,/*STRING_c_str*/
-            7,/*STRING_delete*/
-            8,/*Destroy_AGENT_DATA_TYPE*/
-            10, /*Device_DestroyTransaction_ReportedProperties*/
+            3,/*Destroy_AGENT_DATA_TYPE*/
+            5, /*Device_DestroyTransaction_ReportedProperties*/
         };
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -3820,29 +3879,15 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         (void)CodeFirst_Init(NULL);
         size_t destinationSize = 1000;
         unsigned char *destination = (unsigned char*)my_gballoc_malloc(destinationSize);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
         OuterType* device = (OuterType*)CodeFirst_CreateDevice(TEST_OUTERTYPE_MODEL_HANDLE, &ALL_REFLECTED(testModelInModelReflected), sizeof(OuterType), false);
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, (int32_t)(IGNORED_NUM_ARG)));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "Inner/this_is_int2", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -3863,26 +3908,557 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         CodeFirst_Deinit();
     }
 
-    /*Tests_SRS_CODEFIRST_02_030: [ If argument device is NULL then CodeFirst_IngestDesiredProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
-    TEST_FUNCTION(CodeFirst_IngestDesiredProperties_with_NULL_device_fails)
+    /*Tests_SRS_CODEFIRST_09_008: [ If destination, destinationSize, device or reportToken is NULL then CodeFirst_SendAsyncReportedDiff shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDiff_with_NULL_destination_fails)
     {
         ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t destinationSize = 10;
+        size_t reportToken;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        umock_c_reset_all_calls();
 
         ///act
-        CODEFIRST_RESULT result = CodeFirst_IngestDesiredProperties(NULL, "{\"a\":3}", false);
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDiff(NULL, &destinationSize, device, &reportToken);
 
         ///assert
         ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-        ///clean
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
     }
 
-    /*Tests_SRS_CODEFIRST_02_031: [ If argument jsonProperties is NULL then CodeFirst_IngestDesiredProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
-    TEST_FUNCTION(CodeFirst_IngestDesiredProperties_with_NULL_desiredProperties_fails)
+    /*Tests_SRS_CODEFIRST_09_008: [ If destination, destinationSize, device or reportToken is NULL then CodeFirst_SendAsyncReportedDiff shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDiff_with_NULL_destinationSize_fails)
     {
         ///arrange
         (void)CodeFirst_Init(NULL);
-        OuterType* device = (OuterType*)CodeFirst_CreateDevice(TEST_OUTERTYPE_MODEL_HANDLE, &ALL_REFLECTED(testModelInModelReflected), sizeof(OuterType), false);
+        unsigned char* destination = NULL;
+        size_t reportToken;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDiff(&destination, NULL, device, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_008: [ If destination, destinationSize, device or reportToken is NULL then CodeFirst_SendAsyncReportedDiff shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDiff_with_NULL_device_fails)
+    {
+        ///arrange
+        unsigned char* destination = NULL;
+        size_t destinationSize = 0;
+        size_t reportToken;
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, NULL, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CODEFIRST_09_008: [ If destination, destinationSize, device or reportToken is NULL then CodeFirst_SendAsyncReportedDiff shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDiff_with_NULL_reportToken_fails)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        unsigned char* destination = NULL;
+        size_t destinationSize = 0;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, device, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_009: [ If device is not the address of a device created by CodeFirst_CreateDevice then CodeFirst_SendAsyncReportedDiff shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDiff_with_a_reportedProperty_instead_of_the_device_fails)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        unsigned char* destination = NULL;
+        size_t destinationSize = 0;
+        size_t reportToken;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, &(device->new_reported_this_is_int), &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*sets the expectations of one CodeFirst_SendAsyncReportedDiff over SimpleDevice_Model; intText and doubleText are what AgentDataTypes_ToString produces for the 2 reported properties*/
+    static void CodeFirst_SendAsyncReportedDiff_inert_path(const char* intText, bool intIsPublished, const char* doubleText, bool doubleIsPublished)
+    {
+        AgentDataTypes_ToString_texts[0] = intText;
+        AgentDataTypes_ToString_texts[1] = doubleText;
+        AgentDataTypes_ToString_count = 0;
+
+        STRICT_EXPECTED_CALL(STRING_new());
+
+        STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, -5))
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(STRING_empty(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG));
+        if (intIsPublished)
+        {
+            STRICT_EXPECTED_CALL(Device_CreateTransaction_ReportedProperties(TEST_DEVICE_HANDLE));
+            STRICT_EXPECTED_CALL(Device_PublishTransacted_ReportedProperty(IGNORED_PTR_ARG, "new_reported_this_is_int", IGNORED_PTR_ARG))
+                .IgnoreArgument_transactionHandle()
+                .IgnoreArgument_data();
+        }
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+
+        STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 5.5))
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(STRING_empty(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG));
+        if (doubleIsPublished)
+        {
+            if (!intIsPublished)
+            {
+                STRICT_EXPECTED_CALL(Device_CreateTransaction_ReportedProperties(TEST_DEVICE_HANDLE));
+            }
+            STRICT_EXPECTED_CALL(Device_PublishTransacted_ReportedProperty(IGNORED_PTR_ARG, "new_reported_this_is_double", IGNORED_PTR_ARG))
+                .IgnoreArgument_transactionHandle()
+                .IgnoreArgument_data();
+        }
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+
+        if (intIsPublished || doubleIsPublished)
+        {
+            STRICT_EXPECTED_CALL(Device_CommitTransaction_ReportedProperties(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .IgnoreArgument_transactionHandle()
+                .IgnoreArgument(2)
+                .IgnoreArgument(3);
+            STRICT_EXPECTED_CALL(Device_DestroyTransaction_ReportedProperties(IGNORED_PTR_ARG));
+        }
+
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    }
+
+    /*creates a SimpleDevice_Model device and sends its first report, returning the report token in firstReportToken*/
+    static SimpleDevice_Model* CodeFirst_SendAsyncReportedDiff_create_device_and_send_first_report(size_t* firstReportToken)
+    {
+        unsigned char* destination = NULL;
+        size_t destinationSize = 0;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        device->new_reported_this_is_int = -5;
+        device->new_reported_this_is_double = 5.5;
+        umock_c_reset_all_calls();
+        CodeFirst_SendAsyncReportedDiff_inert_path("-5", true, "5.500000000000000", true);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, device, firstReportToken));
+        ASSERT_ARE_NOT_EQUAL(size_t, 0, *firstReportToken);
+        umock_c_reset_all_calls();
+        return device;
+    }
+
+    /*Tests_SRS_CODEFIRST_09_010: [ On the first call for a device, CodeFirst_SendAsyncReportedDiff shall allocate the shadow of the device, with one entry per reported property and no value sent nor acknowledged. ]*/
+    /*Tests_SRS_CODEFIRST_09_011: [ CodeFirst_SendAsyncReportedDiff shall compare the reported properties that have no reported properties of their own, including the ones of child models, with the shadow by a hash of their JSON text as produced by AgentDataTypes_ToString. ]*/
+    /*Tests_SRS_CODEFIRST_09_012: [ CodeFirst_SendAsyncReportedDiff shall publish by Device_PublishTransacted_ReportedProperty only the reported properties that were never sent or whose value differs from the one in the newest report that included them and is acknowledged or still pending, starting the transaction with the first one. ]*/
+    /*Tests_SRS_CODEFIRST_09_014: [ Otherwise CodeFirst_SendAsyncReportedDiff shall commit the transaction by calling Device_CommitTransaction_ReportedProperties and destroy it. ]*/
+    /*Tests_SRS_CODEFIRST_09_021: [ CodeFirst_SendAsyncReportedDiff shall keep the published values as a pending report, identified by a new non-zero token returned in *reportToken, until the token is passed to CodeFirst_AcknowledgeReportedProperties or CodeFirst_NackReportedProperties, and return CODEFIRST_OK. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDiff_the_first_time_publishes_all_reportedProperties)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        unsigned char* destination = NULL;
+        size_t destinationSize = 0;
+        size_t reportToken = 0;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        device->new_reported_this_is_int = -5;
+        device->new_reported_this_is_double = 5.5;
+        umock_c_reset_all_calls();
+
+        CodeFirst_SendAsyncReportedDiff_inert_path("-5", true, "5.500000000000000", true);
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, device, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_NOT_EQUAL(size_t, 0, reportToken);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_013: [ If no reported property changed, CodeFirst_SendAsyncReportedDiff shall set *destination to NULL, *destinationSize to 0 and *reportToken to 0 and return CODEFIRST_OK. ]*/
+    /*Tests_SRS_CODEFIRST_09_017: [ CodeFirst_AcknowledgeReportedProperties shall record the values sent in the report as acknowledged, except for the reported properties for which a newer report is already acknowledged, forget the report and return CODEFIRST_OK. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDiff_after_acknowledge_and_no_change_publishes_nothing)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        unsigned char* destination = (unsigned char*)0x1;
+        size_t destinationSize = 1;
+        size_t firstReportToken;
+        size_t reportToken = 1;
+        SimpleDevice_Model* device = CodeFirst_SendAsyncReportedDiff_create_device_and_send_first_report(&firstReportToken);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_AcknowledgeReportedProperties(device, firstReportToken));
+        umock_c_reset_all_calls();
+
+        CodeFirst_SendAsyncReportedDiff_inert_path("-5", false, "5.500000000000000", false);
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, device, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_IS_NULL(destination);
+        ASSERT_ARE_EQUAL(size_t, 0, destinationSize);
+        ASSERT_ARE_EQUAL(size_t, 0, reportToken);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_012: [ CodeFirst_SendAsyncReportedDiff shall publish by Device_PublishTransacted_ReportedProperty only the reported properties that were never sent or whose value differs from the one in the newest report that included them and is acknowledged or still pending, starting the transaction with the first one. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDiff_after_acknowledge_publishes_only_the_changed_reportedProperty)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        unsigned char* destination = NULL;
+        size_t destinationSize = 0;
+        size_t firstReportToken;
+        size_t reportToken;
+        SimpleDevice_Model* device = CodeFirst_SendAsyncReportedDiff_create_device_and_send_first_report(&firstReportToken);
+        (void)CodeFirst_AcknowledgeReportedProperties(device, firstReportToken);
+        umock_c_reset_all_calls();
+
+        CodeFirst_SendAsyncReportedDiff_inert_path("-5", false, "6.500000000000000", true); /*the mock of Create_AGENT_DATA_TYPE_from_DOUBLE only checks 5.5, the text is what changes*/
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, device, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_NOT_EQUAL(size_t, 0, reportToken);
+        ASSERT_ARE_NOT_EQUAL(size_t, firstReportToken, reportToken);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_012: [ CodeFirst_SendAsyncReportedDiff shall publish by Device_PublishTransacted_ReportedProperty only the reported properties that were never sent or whose value differs from the one in the newest report that included them and is acknowledged or still pending, starting the transaction with the first one. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDiff_while_the_report_is_pending_publishes_only_newer_changes)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        unsigned char* destination = NULL;
+        size_t destinationSize = 0;
+        size_t firstReportToken;
+        size_t reportToken;
+        SimpleDevice_Model* device = CodeFirst_SendAsyncReportedDiff_create_device_and_send_first_report(&firstReportToken);
+
+        CodeFirst_SendAsyncReportedDiff_inert_path("-5", false, "6.500000000000000", true);
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, device, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_025: [ CodeFirst_NackReportedProperties shall forget the report, so the next CodeFirst_SendAsyncReportedDiff compares the reported properties it included with the newest other pending report that included them, or else with the acknowledged values, and return CODEFIRST_OK. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDiff_after_nack_publishes_again)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        unsigned char* destination = NULL;
+        size_t destinationSize = 0;
+        size_t firstReportToken;
+        size_t reportToken;
+        SimpleDevice_Model* device = CodeFirst_SendAsyncReportedDiff_create_device_and_send_first_report(&firstReportToken);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_NackReportedProperties(device, firstReportToken));
+        umock_c_reset_all_calls();
+
+        CodeFirst_SendAsyncReportedDiff_inert_path("-5", true, "5.500000000000000", true);
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, device, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_NOT_EQUAL(size_t, 0, reportToken);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_017: [ CodeFirst_AcknowledgeReportedProperties shall record the values sent in the report as acknowledged, except for the reported properties for which a newer report is already acknowledged, forget the report and return CODEFIRST_OK. ]*/
+    /*Diff, Diff, then the acknowledgements arrive newest first: the late acknowledgement of the first report does not bring back its older value*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDiff_interleaved_with_acknowledgements_out_of_order_publishes_nothing_more)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        unsigned char* destination = NULL;
+        size_t destinationSize = 0;
+        size_t firstReportToken;
+        size_t secondReportToken;
+        size_t reportToken = 1;
+        SimpleDevice_Model* device = CodeFirst_SendAsyncReportedDiff_create_device_and_send_first_report(&firstReportToken);
+
+        CodeFirst_SendAsyncReportedDiff_inert_path("-5", false, "6.500000000000000", true);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, device, &secondReportToken));
+        ASSERT_ARE_NOT_EQUAL(size_t, firstReportToken, secondReportToken);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_AcknowledgeReportedProperties(device, secondReportToken));
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_AcknowledgeReportedProperties(device, firstReportToken));
+        umock_c_reset_all_calls();
+
+        CodeFirst_SendAsyncReportedDiff_inert_path("-5", false, "6.500000000000000", false);
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, device, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(size_t, 0, reportToken);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_025: [ CodeFirst_NackReportedProperties shall forget the report, so the next CodeFirst_SendAsyncReportedDiff compares the reported properties it included with the newest other pending report that included them, or else with the acknowledged values, and return CODEFIRST_OK. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDiff_after_nack_of_the_newer_report_compares_with_the_older_pending_report)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        unsigned char* destination = NULL;
+        size_t destinationSize = 0;
+        size_t firstReportToken;
+        size_t secondReportToken;
+        size_t reportToken;
+        SimpleDevice_Model* device = CodeFirst_SendAsyncReportedDiff_create_device_and_send_first_report(&firstReportToken);
+
+        CodeFirst_SendAsyncReportedDiff_inert_path("-5", false, "6.500000000000000", true);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, device, &secondReportToken));
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_NackReportedProperties(device, secondReportToken));
+        umock_c_reset_all_calls();
+
+        /*the first report, still pending, carried 5.5*/
+        CodeFirst_SendAsyncReportedDiff_inert_path("-5", false, "6.500000000000000", true);
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, device, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_015: [ If any error occurs, CodeFirst_SendAsyncReportedDiff shall fail, leave the shadow unchanged and return CODEFIRST_ERROR, CODEFIRST_AGENT_DATA_TYPE_ERROR or CODEFIRST_DEVICE_PUBLISH_FAILED. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDiff_unhappy_path)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        unsigned char* destination = NULL;
+        size_t destinationSize = 0;
+        size_t reportToken;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        device->new_reported_this_is_int = -5;
+        device->new_reported_this_is_double = 5.5;
+        (void)umock_c_negative_tests_init();
+        umock_c_reset_all_calls();
+
+        CodeFirst_SendAsyncReportedDiff_inert_path("-5", true, "5.500000000000000", true);
+        umock_c_negative_tests_snapshot();
+
+        size_t calls_that_cannot_fail[] =
+        {
+            4, /*STRING_c_str*/
+            5, /*STRING_length*/
+            8, /*Destroy_AGENT_DATA_TYPE*/
+            12, /*STRING_c_str*/
+            13, /*STRING_length*/
+            15, /*Destroy_AGENT_DATA_TYPE*/
+            17, /*Device_DestroyTransaction_ReportedProperties*/
+            18, /*STRING_delete*/
+        };
+
+        for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
+        {
+            size_t j;
+            for (j = 0; j < sizeof(calls_that_cannot_fail) / sizeof(calls_that_cannot_fail[0]); j++) /*not running the tests that cannot fail*/
+            {
+                if (calls_that_cannot_fail[j] == i)
+                    break;
+            }
+
+            if (j == sizeof(calls_that_cannot_fail) / sizeof(calls_that_cannot_fail[0]))
+            {
+                umock_c_negative_tests_reset();
+                umock_c_negative_tests_fail_call(i);
+                AgentDataTypes_ToString_count = 0;
+                char temp_str[128];
+                sprintf(temp_str, "On failed call %zu", i);
+
+                ///act
+                CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDiff(&destination, &destinationSize, device, &reportToken);
+
+                ///assert
+                ASSERT_ARE_NOT_EQUAL_WITH_MSG(CODEFIRST_RESULT, CODEFIRST_OK, result, temp_str);
+            }
+        }
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        umock_c_negative_tests_deinit();
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_016: [ If device is NULL or is not the address of a device created by CodeFirst_CreateDevice then CodeFirst_AcknowledgeReportedProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_AcknowledgeReportedProperties_with_NULL_device_fails)
+    {
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_AcknowledgeReportedProperties(NULL, 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_CODEFIRST_09_022: [ If reportToken does not identify a pending report of the device then CodeFirst_AcknowledgeReportedProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_AcknowledgeReportedProperties_before_any_diff_fails)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_AcknowledgeReportedProperties(device, 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_022: [ If reportToken does not identify a pending report of the device then CodeFirst_AcknowledgeReportedProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_AcknowledgeReportedProperties_twice_with_the_same_token_fails)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t firstReportToken;
+        SimpleDevice_Model* device = CodeFirst_SendAsyncReportedDiff_create_device_and_send_first_report(&firstReportToken);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_AcknowledgeReportedProperties(device, firstReportToken));
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_AcknowledgeReportedProperties(device, firstReportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_023: [ If device is NULL or is not the address of a device created by CodeFirst_CreateDevice then CodeFirst_NackReportedProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_NackReportedProperties_with_NULL_device_fails)
+    {
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_NackReportedProperties(NULL, 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_CODEFIRST_09_024: [ If reportToken does not identify a pending report of the device then CodeFirst_NackReportedProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_NackReportedProperties_with_an_acknowledged_token_fails)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t firstReportToken;
+        SimpleDevice_Model* device = CodeFirst_SendAsyncReportedDiff_create_device_and_send_first_report(&firstReportToken);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_AcknowledgeReportedProperties(device, firstReportToken));
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_NackReportedProperties(device, firstReportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_02_030: [ If argument device is NULL then CodeFirst_IngestDesiredProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_IngestDesiredProperties_with_NULL_device_fails)
+    {
+        ///arrange
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_IngestDesiredProperties(NULL, "{\"a\":3}", false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+
+        ///clean
+    }
+
+    /*Tests_SRS_CODEFIRST_02_031: [ If argument jsonProperties is NULL then CodeFirst_IngestDesiredProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_IngestDesiredProperties_with_NULL_desiredProperties_fails)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        OuterType* device = (OuterType*)CodeFirst_CreateDevice(TEST_OUTERTYPE_MODEL_HANDLE, &ALL_REFLECTED(testModelInModelReflected), sizeof(OuterType), false);
         umock_c_reset_all_calls();
 
         ///act
@@ -4027,6 +4603,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
             .IgnoreArgument_callbackUserContext();
         STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
 
         // act
         void* result = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, 1, false);
@@ -4076,19 +4653,10 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
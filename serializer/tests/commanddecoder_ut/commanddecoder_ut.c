@@ -14,6 +14,11 @@ void* my_gballoc_malloc(size_t t)
     return malloc(t);
 }
 
+void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
 void my_gballoc_free(void * t)
 {
     free(t);
@@ -53,6 +58,7 @@ MOCKABLE_FUNCTION(, void, onDesiredPropertyModelInModel, void*, v);
 #define ENABLE_MOCKS
 #include "codefirst.h" 
 #include "jsondecoder.h"
+#include "cbordecoder.h"
 
 MOCKABLE_FUNCTION(, EXECUTE_COMMAND_RESULT, ActionCallbackMock, void*, actionCallbackContext, const char*, relativeActionPath, const char*, actionName, size_t, parameterCount, const AGENT_DATA_TYPE*, parameterValues);
 MOCKABLE_FUNCTION(, METHODRETURN_HANDLE, methodCallbackMock, void*, methodCallbackContext, const char*, relativeMethodPath, const char*, mthodName, size_t, parameterCount, const AGENT_DATA_TYPE*, parameterValues);
@@ -137,6 +143,9 @@ DEFINE_ENUM_STRINGS(SCHEMA_ELEMENT_TYPE, SCHEMA_ELEMENT_TYPE_VALUES);
 #define TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD (SCHEMA_DESIRED_PROPERTY_HANDLE)0x4
 #define TEST_SCHEMA (SCHEMA_HANDLE)0x5
 #define SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL (SCHEMA_MODEL_TYPE_HANDLE)0x6
+#define TEST_DESIRED_PROPERTY_HANDLE_GEO (SCHEMA_DESIRED_PROPERTY_HANDLE)0x7
+#define TEST_DESIRED_PROPERTY_HANDLE_LOCATED (SCHEMA_DESIRED_PROPERTY_HANDLE)0x8
+#define TEST_ALT_PROPERTY_HANDLE (SCHEMA_PROPERTY_HANDLE)0x9
 
 static const SCHEMA_MODEL_TYPE_HANDLE TEST_MODEL_HANDLE = (SCHEMA_MODEL_TYPE_HANDLE)0x4301;
 static void* TEST_CALLBACK_CONTEXT_VALUE = (void*)0x4242;
@@ -194,6 +203,223 @@ static JSON_DECODER_RESULT my_JSONDecoder_JSON_To_MultiTree(char* json, MULTITRE
     return JSON_DECODER_OK;
 }
 
+/*{"Name":"SetACState"} in CBOR, the content is never looked at because CBORDecoder_CBOR_To_MultiTree is mocked*/
+static const unsigned char TEST_CBOR_COMMAND[] = { 0xA1, 0x64, 'N', 'a', 'm', 'e', 0x6A, 'S', 'e', 't', 'A', 'C', 'S', 't', 'a', 't', 'e' };
+
+static CBOR_DECODER_RESULT my_CBORDecoder_CBOR_To_MultiTree(const unsigned char* cbor, size_t size, MULTITREE_HANDLE* multiTreeHandle)
+{
+    (void)cbor;
+    (void)size;
+    *multiTreeHandle = TEST_COMMANDS_ROOT_NODE;
+    return CBOR_DECODER_OK;
+}
+
+/*the events that my_JSONDecoder_JSON_To_Events replays for the JSON of a test*/
+typedef enum TEST_JSON_EVENT_TYPE_TAG
+{
+    TEST_JSON_BEGIN_OBJECT,
+    TEST_JSON_END_OBJECT,
+    TEST_JSON_BEGIN_ARRAY,
+    TEST_JSON_END_ARRAY,
+    TEST_JSON_VALUE
+} TEST_JSON_EVENT_TYPE;
+
+typedef struct TEST_JSON_EVENT_TAG
+{
+    TEST_JSON_EVENT_TYPE eventType;
+    const char* name;
+    const char* value;
+} TEST_JSON_EVENT;
+
+static const TEST_JSON_EVENT* testJsonEvents;
+static size_t testJsonEventCount;
+/*what my_JSONDecoder_JSON_To_Events returns once all the events are replayed, so a malformed JSON can be reported after some events*/
+static JSON_DECODER_RESULT testJsonEventsResult;
+
+#define SET_TEST_JSON_EVENTS(events) (testJsonEvents = (events), testJsonEventCount = sizeof(events) / sizeof((events)[0]))
+
+static const TEST_JSON_EVENT simpleDesiredPropertyEvents[] = /*{"int_field":3}*/
+{
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_VALUE, "int_field", "3" },
+    { TEST_JSON_END_OBJECT, NULL, NULL }
+};
+
+static const TEST_JSON_EVENT simpleDesiredPropertyWithVersionEvents[] = /*{"int_field":3,"$version":4}*/
+{
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_VALUE, "int_field", "3" },
+    { TEST_JSON_VALUE, "$version", "4" },
+    { TEST_JSON_END_OBJECT, NULL, NULL }
+};
+
+static const TEST_JSON_EVENT simpleDesiredPropertyInTwinEvents[] = /*{"desired":{"int_field":3,"$version":4},"reported":{"a":1}}*/
+{
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_BEGIN_OBJECT, "desired", NULL },
+    { TEST_JSON_VALUE, "int_field", "3" },
+    { TEST_JSON_VALUE, "$version", "4" },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_BEGIN_OBJECT, "reported", NULL },
+    { TEST_JSON_VALUE, "a", "1" },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_END_OBJECT, NULL, NULL }
+};
+
+static const TEST_JSON_EVENT twinWithoutDesiredEvents[] = /*{"reported":{"a":1}}*/
+{
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_BEGIN_OBJECT, "reported", NULL },
+    { TEST_JSON_VALUE, "a", "1" },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_END_OBJECT, NULL, NULL }
+};
+
+static const TEST_JSON_EVENT unknownDesiredPropertyEvents[] = /*{"unknown":3}*/
+{
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_VALUE, "unknown", "3" },
+    { TEST_JSON_END_OBJECT, NULL, NULL }
+};
+
+static const TEST_JSON_EVENT modelInModelDesiredPropertyEvents[] = /*{"modelInModel":{"int_field":3}}*/
+{
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_BEGIN_OBJECT, "modelInModel", NULL },
+    { TEST_JSON_VALUE, "int_field", "3" },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_END_OBJECT, NULL, NULL }
+};
+
+static const TEST_JSON_EVENT truncatedDesiredPropertiesEvents[] = /*{"int_field":3,"int_fi*/
+{
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_VALUE, "int_field", "3" }
+};
+
+static const TEST_JSON_EVENT arraysOutsideOfDesiredEvents[] = /*{"desired":{"int_field":3},"reported":{"a":[1,[2]]},"tags":[{"b":1}]}*/
+{
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_BEGIN_OBJECT, "desired", NULL },
+    { TEST_JSON_VALUE, "int_field", "3" },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_BEGIN_OBJECT, "reported", NULL },
+    { TEST_JSON_BEGIN_ARRAY, "a", NULL },
+    { TEST_JSON_VALUE, NULL, "1" },
+    { TEST_JSON_BEGIN_ARRAY, NULL, NULL },
+    { TEST_JSON_VALUE, NULL, "2" },
+    { TEST_JSON_END_ARRAY, NULL, NULL },
+    { TEST_JSON_END_ARRAY, NULL, NULL },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_BEGIN_ARRAY, "tags", NULL },
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_VALUE, "b", "1" },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_END_ARRAY, NULL, NULL },
+    { TEST_JSON_END_OBJECT, NULL, NULL }
+};
+
+static const TEST_JSON_EVENT arrayDesiredPropertyEvents[] = /*{"int_field":[3]}*/
+{
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_BEGIN_ARRAY, "int_field", NULL },
+    { TEST_JSON_VALUE, NULL, "3" },
+    { TEST_JSON_END_ARRAY, NULL, NULL },
+    { TEST_JSON_END_OBJECT, NULL, NULL }
+};
+
+static const TEST_JSON_EVENT structDesiredPropertyEvents[] = /*{"geo":{"Lat":1.5,"Long":2.5}}*/
+{
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_BEGIN_OBJECT, "geo", NULL },
+    { TEST_JSON_VALUE, "Lat", "1.5" },
+    { TEST_JSON_VALUE, "Long", "2.5" },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_END_OBJECT, NULL, NULL }
+};
+
+static const TEST_JSON_EVENT structDesiredPropertyWithUnknownMembersEvents[] = /*{"geo":{"Lat":1.5,"alt":7,"extra":{"x":[1]},"tags":[1,{"y":2}],"Long":2.5}}*/
+{
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_BEGIN_OBJECT, "geo", NULL },
+    { TEST_JSON_VALUE, "Lat", "1.5" },
+    { TEST_JSON_VALUE, "alt", "7" },
+    { TEST_JSON_BEGIN_OBJECT, "extra", NULL },
+    { TEST_JSON_BEGIN_ARRAY, "x", NULL },
+    { TEST_JSON_VALUE, NULL, "1" },
+    { TEST_JSON_END_ARRAY, NULL, NULL },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_BEGIN_ARRAY, "tags", NULL },
+    { TEST_JSON_VALUE, NULL, "1" },
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_VALUE, "y", "2" },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_END_ARRAY, NULL, NULL },
+    { TEST_JSON_VALUE, "Long", "2.5" },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_END_OBJECT, NULL, NULL }
+};
+
+static const TEST_JSON_EVENT structDesiredPropertyWithMissingMemberEvents[] = /*{"geo":{"Lat":1.5}}*/
+{
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_BEGIN_OBJECT, "geo", NULL },
+    { TEST_JSON_VALUE, "Lat", "1.5" },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_END_OBJECT, NULL, NULL }
+};
+
+static const TEST_JSON_EVENT nestedStructDesiredPropertyEvents[] = /*{"located":{"pos":{"Lat":1.5,"Long":2.5},"alt":3}}*/
+{
+    { TEST_JSON_BEGIN_OBJECT, NULL, NULL },
+    { TEST_JSON_BEGIN_OBJECT, "located", NULL },
+    { TEST_JSON_BEGIN_OBJECT, "pos", NULL },
+    { TEST_JSON_VALUE, "Lat", "1.5" },
+    { TEST_JSON_VALUE, "Long", "2.5" },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_VALUE, "alt", "3" },
+    { TEST_JSON_END_OBJECT, NULL, NULL },
+    { TEST_JSON_END_OBJECT, NULL, NULL }
+};
+
+static JSON_DECODER_RESULT my_JSONDecoder_JSON_To_Events(const char* json, const JSON_DECODER_EVENTS* events, void* context)
+{
+    JSON_DECODER_RESULT result = testJsonEventsResult;
+    size_t i;
+    (void)json;
+    for (i = 0; i < testJsonEventCount; i++)
+    {
+        const TEST_JSON_EVENT* event = &testJsonEvents[i];
+        size_t nameLength = (event->name == NULL) ? 0 : strlen(event->name);
+        int callbackResult;
+        switch (event->eventType)
+        {
+            case TEST_JSON_BEGIN_OBJECT:
+                callbackResult = events->onBeginObject(context, event->name, nameLength);
+                break;
+            case TEST_JSON_END_OBJECT:
+                callbackResult = events->onEndObject(context);
+                break;
+            case TEST_JSON_BEGIN_ARRAY:
+                callbackResult = events->onBeginArray(context, event->name, nameLength);
+                break;
+            case TEST_JSON_END_ARRAY:
+                callbackResult = events->onEndArray(context);
+                break;
+            default:
+                callbackResult = events->onValue(context, event->name, nameLength, event->value, strlen(event->value));
+                break;
+        }
+
+        if (callbackResult != 0)
+        {
+            result = JSON_DECODER_ERROR;
+            break;
+        }
+    }
+    return result;
+}
+
 static void my_MultiTree_Destroy(MULTITREE_HANDLE treeHandle)
 {
     (void)(treeHandle);
@@ -217,6 +443,8 @@ static SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName_notFound;
 static SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName_desiredProperty_int_field;
 
 static SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName_modelInModel;
+static SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName_desiredProperty_geo;
+static SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName_desiredProperty_located;
 
 
 char* umockvalue_stringify_SCHEMA_MODEL_ELEMENT(const SCHEMA_MODEL_ELEMENT* value)
@@ -289,6 +517,10 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         Schema_GetModelElementByName_desiredProperty_int_field.elementHandle.desiredPropertyHandle = TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD;
         Schema_GetModelElementByName_modelInModel.elementType = SCHEMA_MODEL_IN_MODEL;
         Schema_GetModelElementByName_modelInModel.elementHandle.modelHandle = SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL;
+        Schema_GetModelElementByName_desiredProperty_geo.elementType = SCHEMA_DESIRED_PROPERTY;
+        Schema_GetModelElementByName_desiredProperty_geo.elementHandle.desiredPropertyHandle = TEST_DESIRED_PROPERTY_HANDLE_GEO;
+        Schema_GetModelElementByName_desiredProperty_located.elementType = SCHEMA_DESIRED_PROPERTY;
+        Schema_GetModelElementByName_desiredProperty_located.elementHandle.desiredPropertyHandle = TEST_DESIRED_PROPERTY_HANDLE_LOCATED;
 
         g_testByTest = TEST_MUTEX_CREATE();
         ASSERT_IS_NOT_NULL(g_testByTest);
@@ -305,6 +537,8 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
         
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_MODEL_TYPE_HANDLE, void*);
@@ -323,6 +557,8 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         
         
         REGISTER_UMOCK_ALIAS_TYPE(JSON_DECODER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(CBOR_DECODER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(const JSON_DECODER_EVENTS*, void*);
         REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(AGENT_DATA_TYPE_TYPE, int);
@@ -339,6 +575,10 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
         REGISTER_GLOBAL_MOCK_HOOK(JSONDecoder_JSON_To_MultiTree, my_JSONDecoder_JSON_To_MultiTree);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(JSONDecoder_JSON_To_MultiTree, JSON_DECODER_ERROR);
+        REGISTER_GLOBAL_MOCK_HOOK(CBORDecoder_CBOR_To_MultiTree, my_CBORDecoder_CBOR_To_MultiTree);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(CBORDecoder_CBOR_To_MultiTree, CBOR_DECODER_ERROR);
+        REGISTER_GLOBAL_MOCK_HOOK(JSONDecoder_JSON_To_Events, my_JSONDecoder_JSON_To_Events);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(JSONDecoder_JSON_To_Events, JSON_DECODER_PARSE_ERROR);
         REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Destroy, my_MultiTree_Destroy);
         
         REGISTER_GLOBAL_MOCK_HOOK(Create_AGENT_DATA_TYPE_from_Members, my_Create_AGENT_DATA_TYPE_from_Members);
@@ -405,6 +645,9 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
         nCall = 0;
         memset(lastMemberNames, 0, sizeof(lastMemberNames));
+        testJsonEvents = NULL;
+        testJsonEventCount = 0;
+        testJsonEventsResult = JSON_DECODER_OK;
 
         StateAgentDataType.type = EDM_BOOLEAN_TYPE;
         StateAgentDataType.value.edmBoolean.value = EDM_TRUE;
@@ -655,6 +898,101 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
+    /* Tests_SRS_COMMAND_DECODER_09_006: [ If handle or command is NULL, CommandDecoder_ExecuteCommandCBOR shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteCommandCBOR_with_NULL_handle_fails)
+    {
+        /// arrange
+
+        /// act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_ExecuteCommandCBOR(NULL, TEST_CBOR_COMMAND, sizeof(TEST_CBOR_COMMAND));
+
+        /// assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_COMMAND_DECODER_09_006: [ If handle or command is NULL, CommandDecoder_ExecuteCommandCBOR shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteCommandCBOR_with_NULL_command_fails)
+    {
+        /// arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+
+        /// act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_ExecuteCommandCBOR(commandDecoderHandle, NULL, sizeof(TEST_CBOR_COMMAND));
+
+        /// assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        /// cleanup
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /* Tests_SRS_COMMAND_DECODER_09_007: [ If size is 0, CommandDecoder_ExecuteCommandCBOR shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteCommandCBOR_with_zero_size_fails)
+    {
+        /// arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+
+        /// act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_ExecuteCommandCBOR(commandDecoderHandle, TEST_CBOR_COMMAND, 0);
+
+        /// assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        /// cleanup
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /* Tests_SRS_COMMAND_DECODER_09_008: [ CommandDecoder_ExecuteCommandCBOR shall decode the command to a multi-tree by using CBORDecoder_CBOR_To_MultiTree. ]*/
+    /* Tests_SRS_COMMAND_DECODER_09_009: [ If CBORDecoder_CBOR_To_MultiTree fails, CommandDecoder_ExecuteCommandCBOR shall return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteCommandCBOR_when_decoding_the_CBOR_fails_no_command_is_dispatched)
+    {
+        /// arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(CBORDecoder_CBOR_To_MultiTree(TEST_CBOR_COMMAND, sizeof(TEST_CBOR_COMMAND), IGNORED_PTR_ARG))
+            .SetReturn(CBOR_DECODER_PARSE_ERROR);
+
+        /// act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_ExecuteCommandCBOR(commandDecoderHandle, TEST_CBOR_COMMAND, sizeof(TEST_CBOR_COMMAND));
+
+        /// assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        /// cleanup
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /* Tests_SRS_COMMAND_DECODER_09_010: [ Otherwise CommandDecoder_ExecuteCommandCBOR shall dispatch the command the same way CommandDecoder_ExecuteCommand does, and shall return what the action callback returns. ]*/
+    /* Tests_SRS_COMMAND_DECODER_09_011: [ CommandDecoder_ExecuteCommandCBOR shall free the multi-tree after the command is executed. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteCommandCBOR_decodes_the_command_from_the_tree_and_destroys_the_tree)
+    {
+        /// arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(CBORDecoder_CBOR_To_MultiTree(TEST_CBOR_COMMAND, sizeof(TEST_CBOR_COMMAND), IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE))
+            .SetReturn((SCHEMA_HANDLE)NULL);
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(TEST_COMMANDS_ROOT_NODE));
+
+        /// act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_ExecuteCommandCBOR(commandDecoderHandle, TEST_CBOR_COMMAND, sizeof(TEST_CBOR_COMMAND));
+
+        /// assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        /// cleanup
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
     /* Tests_SRS_COMMAND_DECODER_01_015: [If any MultiTree API call fails then the processing shall stop and the command shall not be dispatched and it shall return EXECUTE_COMMAND_ERROR.] */
     TEST_FUNCTION(When_Getting_The_Schema_For_The_Model_Fails_Then_No_Command_Is_Dispatched)
     {
@@ -2991,34 +3329,17 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
-    void CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, const char* three, size_t one, MULTITREE_HANDLE childHandle, bool desiredPropertyHasCallback)
+    void CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, bool desiredPropertyHasCallback)
     {
-        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
-            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_Events(desiredPropertiesJSON, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_events()
+            .IgnoreArgument_context();
 
-        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_json()
-            .IgnoreArgument_multiTreeHandle();
-
-        STRICT_EXPECTED_CALL(MultiTree_DeleteChild(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_childName();
-
-        STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*2*/
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_count(&one, sizeof(one));
-
-        STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
-
-        STRICT_EXPECTED_CALL(STRING_new())
-            .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
-
-        STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME)); /*this fills in TEST_STRING_HANDLE_CHILD_NAME with "int_field"*/
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*the frames*/
+            .IgnoreArgument_size();
 
-        STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME)) /*6*/
-            .SetReturn("int_field");
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*the copy of the name*/
+            .IgnoreArgument_size();
 
         STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "int_field"))
             .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
@@ -3026,20 +3347,10 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
             .SetReturn("int");
 
-        STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE))
-            .SetReturn(TEST_SCHEMA);
-
-        /*this is DecodeValueFromNode expected calls*/
-
         STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
             .SetReturn(EDM_INT32_TYPE);
 
-        STRICT_EXPECTED_CALL(MultiTree_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_destination(&three, sizeof(three));
-
-        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(IGNORED_PTR_ARG, EDM_INT32_TYPE, IGNORED_PTR_ARG))
-            .IgnoreArgument_source()
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("3", EDM_INT32_TYPE, IGNORED_PTR_ARG))
             .IgnoreArgument_agentData()
             .SetReturn(AGENT_DATA_TYPES_OK);
 
@@ -3065,21 +3376,20 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
             .IgnoreArgument_agentData();
 
-        STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the frames*/
+            .IgnoreArgument_ptr();
 
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the copy of the name*/
             .IgnoreArgument_ptr();
     }
 
     /*case1: a simple property (non-recursive) is ingested*/
     /*the property is called "int_field" and shall have the value 3*/
-    /*Tests_SRS_COMMAND_DECODER_02_005: [ CommandDecoder_IngestDesiredProperties shall create a MULTITREE_HANDLE ouf of the clone of desiredProperties. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_007: [ If the child name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the MULTITREE node. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_001: [ CommandDecoder_IngestDesiredProperties shall parse jsonPayload in one pass with JSONDecoder_JSON_To_Events, without copying it and without building a MULTITREE. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_007: [ If the child name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the JSON value. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_008: [ The desired property shall be constructed in memory by calling pfDesiredPropertyFromAGENT_DATA_TYPE. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_010: [ If the complete MULTITREE has been parsed then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_002: [ Every value shall be converted by CreateAgentDataType_From_String and written into the model by pfDesiredPropertyFromAGENT_DATA_TYPE as soon as it is parsed. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_010: [ If the complete jsonPayload has been parsed then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
     TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_happy_path)
     {
         ///arrange
@@ -3087,11 +3397,9 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         umock_c_reset_all_calls();
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"int_field\":3}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+        SET_TEST_JSON_EVENTS(simpleDesiredPropertyEvents);
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, false);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3112,33 +3420,24 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"int_field\":3}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+        SET_TEST_JSON_EVENTS(simpleDesiredPropertyEvents);
         (void)umock_c_negative_tests_init();
         umock_c_reset_all_calls();
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, false);
 
         umock_c_negative_tests_snapshot();
 
         size_t calls_that_cannot_fail[] =
         {
-            2, /*MultiTree_DeleteChild*/
-        
-            3,/*MultiTree_GetChildCount*/
-            7, /*STRING_c_str*/
-
-            9, /*Schema_GetModelDesiredPropertyType*/
-            10, /*Schema_GetSchemaForModelType*/
-            11, /*CodeFirst_GetPrimitiveType*/
-            14, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
-            15, /*Schema_GetModelDesiredProperty_offset*/
-            17, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
-            18, /*Destroy_AGENT_DATA_TYPE*/
-            19, /*STRING_delete*/
-            20, /*MultiTree_Destroy*/
-            21 /*gballoc_free*/
+            4, /*Schema_GetModelDesiredPropertyType*/
+            5, /*CodeFirst_GetPrimitiveType*/
+            7, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
+            8, /*Schema_GetModelDesiredProperty_offset*/
+            10, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
+            11, /*Destroy_AGENT_DATA_TYPE*/
+            12, /*gballoc_free*/
+            13 /*gballoc_free*/
         };
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -3173,129 +3472,526 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
-    void CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, const char* three, size_t one, MULTITREE_HANDLE childHandle, bool desiredPropertiesHaveCallbacks)
+    /*Tests_SRS_COMMAND_DECODER_02_015: [ Remove '$version' string from node, if it is present.  It not being present is not an error ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_skips_version)
     {
-        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
-            .IgnoreArgument_destination();
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\":3,\"$version\":4}";
+        SET_TEST_JSON_EVENTS(simpleDesiredPropertyWithVersionEvents);
 
-        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_json()
-            .IgnoreArgument_multiTreeHandle();
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, false);
 
-        STRICT_EXPECTED_CALL(MultiTree_DeleteChild(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_childName();
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
 
-        STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*2*/
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_count(&one, sizeof(one));
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
 
-        STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
 
-        STRICT_EXPECTED_CALL(STRING_new())
-            .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
+    /*Tests_SRS_COMMAND_DECODER_02_014: [ If parseDesiredNode is TRUE, parse only the `desired` part of JSON tree ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_parseDesiredNode_ingests_only_desired)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* twinJSON = "{\"desired\":{\"int_field\":3,\"$version\":4},\"reported\":{\"a\":1}}";
+        SET_TEST_JSON_EVENTS(simpleDesiredPropertyInTwinEvents);
 
-        STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME)); /*this fills in TEST_STRING_HANDLE_CHILD_NAME with "modelInModel"*/
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, twinJSON, false);
 
-        STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME)) /*6*/
-            .SetReturn("modelInModel");
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, twinJSON, true);
 
-        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "modelInModel"))
-            .SetReturn(Schema_GetModelElementByName_modelInModel);
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
 
-        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_Offset(TEST_MODEL_HANDLE, "modelInModel")) /*9*/
-            .SetReturn(10);
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
 
-        /*here recursion happens*/
+    /*Tests_SRS_COMMAND_DECODER_02_014: [ If parseDesiredNode is TRUE, parse only the `desired` part of JSON tree ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_parseDesiredNode_and_no_desired_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* twinJSON = "{\"reported\":{\"a\":1}}";
+        SET_TEST_JSON_EVENTS(twinWithoutDesiredEvents);
 
-        {
-            STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*10*/
-                .IgnoreArgument_treeHandle()
-                .CopyOutArgumentBuffer_count(&one, sizeof(one));
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_Events(twinJSON, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_events()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+            .IgnoreArgument_size();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(gballoc_free(NULL));
 
-            STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
-                .IgnoreArgument_treeHandle()
-                .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, twinJSON, true);
 
-            STRICT_EXPECTED_CALL(STRING_new())
-                .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
 
-            STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME)); /*13*/ /*this fills in TEST_STRING_HANDLE_CHILD_NAME with "int_field"*/
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
 
-            STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME)) /*14*/
-                .SetReturn("int_field");
+    /*Tests_SRS_COMMAND_DECODER_09_003: [ If a member of a model is not a desired property or a model in model of the model then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_unknown_name_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"unknown\":3}";
+        SET_TEST_JSON_EVENTS(unknownDesiredPropertyEvents);
 
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_Events(desiredPropertiesJSON, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_events()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+            .IgnoreArgument_size();
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+            .IgnoreArgument_size();
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "unknown"))
+            .SetReturn(Schema_GetModelElementByName_notFound);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_invalid_JSON_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\":";
+
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_Events(desiredPropertiesJSON, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_events()
+            .IgnoreArgument_context()
+            .SetReturn(JSON_DECODER_PARSE_ERROR);
+        STRICT_EXPECTED_CALL(gballoc_free(NULL));
+        STRICT_EXPECTED_CALL(gballoc_free(NULL));
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*the desired properties that precede the malformed part of the JSON are written*/
+    /*Tests_SRS_COMMAND_DECODER_09_012: [ If jsonPayload is malformed then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR; the desired properties that precede the error in jsonPayload have already been written and stay written. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_truncated_JSON_writes_the_preceding_desired_properties_and_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\":3,\"int_fi";
+        SET_TEST_JSON_EVENTS(truncatedDesiredPropertiesEvents);
+        testJsonEventsResult = JSON_DECODER_PARSE_ERROR;
+
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, false);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_013: [ Arrays outside of desired, a $version array and arrays that are members of a struct value that the struct type does not have shall be skipped; any other array shall make CommandDecoder_IngestDesiredProperties fail and return EXECUTE_COMMAND_FAILED. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_parseDesiredNode_skips_arrays_outside_of_desired)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* twinJSON = "{\"desired\":{\"int_field\":3},\"reported\":{\"a\":[1,[2]]},\"tags\":[{\"b\":1}]}";
+        SET_TEST_JSON_EVENTS(arraysOutsideOfDesiredEvents);
+
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, twinJSON, false);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, twinJSON, true);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_013: [ Arrays outside of desired, a $version array and arrays that are members of a struct value that the struct type does not have shall be skipped; any other array shall make CommandDecoder_IngestDesiredProperties fail and return EXECUTE_COMMAND_FAILED. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_array_desired_property_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\":[3]}";
+        SET_TEST_JSON_EVENTS(arrayDesiredPropertyEvents);
+
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_Events(desiredPropertiesJSON, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_events()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*the frames*/
+            .IgnoreArgument_size();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the frames*/
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(gballoc_free(NULL)); /*no name was copied*/
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    static void CommandDecoder_IngestDesiredProperties_struct_frame_inert_path(SCHEMA_STRUCT_TYPE_HANDLE structTypeHandle, const char* structTypeName, SCHEMA_PROPERTY_HANDLE member1, const char* member1Name, SCHEMA_PROPERTY_HANDLE member2, const char* member2Name)
+    {
+        static size_t memberCount = 2;
+        STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(Schema_GetStructTypeByName(TEST_SCHEMA_HANDLE, structTypeName))
+            .SetReturn(structTypeHandle);
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyCount(structTypeHandle, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(2, &memberCount, sizeof(memberCount));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the member names*/
+            .IgnoreArgument_size();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*the member values*/
+            .IgnoreArgument_size();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*which members have been decoded*/
+            .IgnoreArgument_size();
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyByIndex(structTypeHandle, 0))
+            .SetReturn(member1);
+        STRICT_EXPECTED_CALL(Schema_GetPropertyName(member1))
+            .SetReturn(member1Name);
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyByIndex(structTypeHandle, 1))
+            .SetReturn(member2);
+        STRICT_EXPECTED_CALL(Schema_GetPropertyName(member2))
+            .SetReturn(member2Name);
+    }
+
+    static void CommandDecoder_IngestDesiredProperties_struct_member_value_inert_path(SCHEMA_STRUCT_TYPE_HANDLE structTypeHandle, size_t memberIndex, SCHEMA_PROPERTY_HANDLE member, const char* memberType, AGENT_DATA_TYPE_TYPE primitiveType, const char* value)
+    {
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyByIndex(structTypeHandle, memberIndex))
+            .SetReturn(member);
+        STRICT_EXPECTED_CALL(Schema_GetPropertyType(member))
+            .SetReturn(memberType);
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType(memberType))
+            .SetReturn(primitiveType);
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(value, primitiveType, IGNORED_PTR_ARG))
+            .IgnoreArgument_agentData()
+            .SetReturn(AGENT_DATA_TYPES_OK);
+    }
+
+    static void CommandDecoder_IngestDesiredProperties_struct_end_inert_path(const char* structTypeName)
+    {
+        STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_Members(IGNORED_PTR_ARG, structTypeName, 2, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_agentData()
+            .IgnoreArgument_memberNames()
+            .IgnoreArgument_memberValues();
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG)) /*the first member*/
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG)) /*the second member*/
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+    }
+
+    static void CommandDecoder_IngestDesiredProperties_struct_desired_property_begin_inert_path(const char* desiredPropertiesJSON, SCHEMA_MODEL_ELEMENT element, const char* name, const char* structTypeName)
+    {
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_Events(desiredPropertiesJSON, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_events()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*the frames*/
+            .IgnoreArgument_size();
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*the copy of the name*/
+            .IgnoreArgument_size();
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, name))
+            .SetReturn(element);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(element.elementHandle.desiredPropertyHandle))
+            .SetReturn(structTypeName);
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType(structTypeName))
+            .SetReturn(EDM_NO_TYPE);
+    }
+
+    static void CommandDecoder_IngestDesiredProperties_struct_desired_property_end_inert_path(unsigned char* deviceMemoryArea, SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle)
+    {
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(desiredPropertyHandle))
+            .SetReturn(int_pfDesiredPropertyFromAGENT_DATA_TYPE);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(desiredPropertyHandle))
+            .SetReturn(4);
+        STRICT_EXPECTED_CALL(int_pfDesiredPropertyFromAGENT_DATA_TYPE(IGNORED_PTR_ARG, (unsigned char*)deviceMemoryArea + 4))
+            .IgnoreArgument_source();
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(desiredPropertyHandle))
+            .SetReturn(NULL);
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the frames*/
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the copy of the name*/
+            .IgnoreArgument_ptr();
+    }
+
+    static void CommandDecoder_IngestDesiredProperties_with_struct_desired_property_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON)
+    {
+        CommandDecoder_IngestDesiredProperties_struct_desired_property_begin_inert_path(desiredPropertiesJSON, Schema_GetModelElementByName_desiredProperty_geo, "geo", "GeoLocation");
+        CommandDecoder_IngestDesiredProperties_struct_frame_inert_path(TEST_STRUCT_1_HANDLE, "GeoLocation", memberProperty1, "Lat", memberProperty2, "Long");
+        CommandDecoder_IngestDesiredProperties_struct_member_value_inert_path(TEST_STRUCT_1_HANDLE, 0, memberProperty1, "double", EDM_DOUBLE_TYPE, "1.5");
+        CommandDecoder_IngestDesiredProperties_struct_member_value_inert_path(TEST_STRUCT_1_HANDLE, 1, memberProperty2, "double", EDM_DOUBLE_TYPE, "2.5");
+        CommandDecoder_IngestDesiredProperties_struct_end_inert_path("GeoLocation");
+        CommandDecoder_IngestDesiredProperties_struct_desired_property_end_inert_path(deviceMemoryArea, TEST_DESIRED_PROPERTY_HANDLE_GEO);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_004: [ The members of a struct value shall be matched by name against the members of the struct type in the schema; members that the struct type does not have shall be skipped. ]*/
+    /*Tests_SRS_COMMAND_DECODER_99_031:[ The complex type value that aggregates the children shall be built by using the Create_AGENT_DATA_TYPE_from_Members.] */
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_struct_desired_property_happy_path)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"geo\":{\"Lat\":1.5,\"Long\":2.5}}";
+        SET_TEST_JSON_EVENTS(structDesiredPropertyEvents);
+
+        CommandDecoder_IngestDesiredProperties_with_struct_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+        ASSERT_ARE_EQUAL(char_ptr, "Lat", lastMemberNames[0][0]);
+        ASSERT_ARE_EQUAL(char_ptr, "Long", lastMemberNames[0][1]);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_004: [ The members of a struct value shall be matched by name against the members of the struct type in the schema; members that the struct type does not have shall be skipped. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_013: [ Arrays outside of desired, a $version array and arrays that are members of a struct value that the struct type does not have shall be skipped; any other array shall make CommandDecoder_IngestDesiredProperties fail and return EXECUTE_COMMAND_FAILED. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_struct_desired_property_skips_unknown_members)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"geo\":{\"Lat\":1.5,\"alt\":7,\"extra\":{\"x\":[1]},\"tags\":[1,{\"y\":2}],\"Long\":2.5}}";
+        SET_TEST_JSON_EVENTS(structDesiredPropertyWithUnknownMembersEvents);
+
+        /*the skipped members do not reach the schema*/
+        CommandDecoder_IngestDesiredProperties_with_struct_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_005: [ If a struct value does not have all the members of its struct type then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_struct_desired_property_missing_a_member_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"geo\":{\"Lat\":1.5}}";
+        SET_TEST_JSON_EVENTS(structDesiredPropertyWithMissingMemberEvents);
+
+        CommandDecoder_IngestDesiredProperties_struct_desired_property_begin_inert_path(desiredPropertiesJSON, Schema_GetModelElementByName_desiredProperty_geo, "geo", "GeoLocation");
+        CommandDecoder_IngestDesiredProperties_struct_frame_inert_path(TEST_STRUCT_1_HANDLE, "GeoLocation", memberProperty1, "Lat", memberProperty2, "Long");
+        CommandDecoder_IngestDesiredProperties_struct_member_value_inert_path(TEST_STRUCT_1_HANDLE, 0, memberProperty1, "double", EDM_DOUBLE_TYPE, "1.5");
+
+        /*the incomplete struct value is destroyed*/
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG)) /*Lat*/
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the frames*/
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the copy of the name*/
+            .IgnoreArgument_ptr();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_99_032:[ Nesting shall be supported for complex type.] */
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_nested_struct_desired_property_happy_path)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"located\":{\"pos\":{\"Lat\":1.5,\"Long\":2.5},\"alt\":3}}";
+        SET_TEST_JSON_EVENTS(nestedStructDesiredPropertyEvents);
+
+        CommandDecoder_IngestDesiredProperties_struct_desired_property_begin_inert_path(desiredPropertiesJSON, Schema_GetModelElementByName_desiredProperty_located, "located", "Located");
+        CommandDecoder_IngestDesiredProperties_struct_frame_inert_path(TEST_STRUCT_2_HANDLE, "Located", memberNestedComplexTypeProperty, "pos", TEST_ALT_PROPERTY_HANDLE, "alt");
+
+        /*"pos" is a GeoLocation*/
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyByIndex(TEST_STRUCT_2_HANDLE, 0))
+            .SetReturn(memberNestedComplexTypeProperty);
+        STRICT_EXPECTED_CALL(Schema_GetPropertyType(memberNestedComplexTypeProperty))
+            .SetReturn("GeoLocation");
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("GeoLocation"))
+            .SetReturn(EDM_NO_TYPE);
+        CommandDecoder_IngestDesiredProperties_struct_frame_inert_path(TEST_STRUCT_1_HANDLE, "GeoLocation", memberProperty1, "Lat", memberProperty2, "Long");
+        CommandDecoder_IngestDesiredProperties_struct_member_value_inert_path(TEST_STRUCT_1_HANDLE, 0, memberProperty1, "double", EDM_DOUBLE_TYPE, "1.5");
+        CommandDecoder_IngestDesiredProperties_struct_member_value_inert_path(TEST_STRUCT_1_HANDLE, 1, memberProperty2, "double", EDM_DOUBLE_TYPE, "2.5");
+        CommandDecoder_IngestDesiredProperties_struct_end_inert_path("GeoLocation");
+
+        CommandDecoder_IngestDesiredProperties_struct_member_value_inert_path(TEST_STRUCT_2_HANDLE, 1, TEST_ALT_PROPERTY_HANDLE, "int", EDM_INT32_TYPE, "3");
+        CommandDecoder_IngestDesiredProperties_struct_end_inert_path("Located");
+        CommandDecoder_IngestDesiredProperties_struct_desired_property_end_inert_path(deviceMemoryArea, TEST_DESIRED_PROPERTY_HANDLE_LOCATED);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+        ASSERT_ARE_EQUAL(char_ptr, "Lat", lastMemberNames[0][0]);
+        ASSERT_ARE_EQUAL(char_ptr, "Long", lastMemberNames[0][1]);
+        ASSERT_ARE_EQUAL(char_ptr, "pos", lastMemberNames[1][0]);
+        ASSERT_ARE_EQUAL(char_ptr, "alt", lastMemberNames[1][1]);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    void CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, bool desiredPropertiesHaveCallbacks)
+    {
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_Events(desiredPropertiesJSON, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_events()
+            .IgnoreArgument_context();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*the frames*/
+            .IgnoreArgument_size();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*the copy of the name*/
+            .IgnoreArgument_size();
+
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "modelInModel"))
+            .SetReturn(Schema_GetModelElementByName_modelInModel);
+
+        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_Offset(TEST_MODEL_HANDLE, "modelInModel"))
+            .SetReturn(10);
+
+        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_OnDesiredProperty(TEST_MODEL_HANDLE, "modelInModel"))
+            .SetReturn(desiredPropertiesHaveCallbacks ? onDesiredPropertyModelInModel : NULL);
+
+        /*here the model in model is ingested*/
+        {
             STRICT_EXPECTED_CALL(Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL, "int_field"))
                 .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
 
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*17*/
+            STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
                 .SetReturn("int");
 
-            STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL)) /*18*/
-                .SetReturn(TEST_SCHEMA);
-
-            /*this is DecodeValueFromNodea expected calls*/
-
-            STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int")) /*19*/
+            STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
                 .SetReturn(EDM_INT32_TYPE);
 
-            STRICT_EXPECTED_CALL(MultiTree_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument_treeHandle()
-                .CopyOutArgumentBuffer_destination(&three, sizeof(three));
-
-            STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(IGNORED_PTR_ARG, EDM_INT32_TYPE, IGNORED_PTR_ARG))
-                .IgnoreArgument_source()
+            STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("3", EDM_INT32_TYPE, IGNORED_PTR_ARG))
                 .IgnoreArgument_agentData()
                 .SetReturn(AGENT_DATA_TYPES_OK);
 
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*22*/
+            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
                 .SetReturn(int_pfDesiredPropertyFromAGENT_DATA_TYPE);
 
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*23*/
+            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
                 .SetReturn(2);
 
             STRICT_EXPECTED_CALL(int_pfDesiredPropertyFromAGENT_DATA_TYPE(IGNORED_PTR_ARG, (unsigned char*)deviceMemoryArea + 12))  /*notice here the new offset (2+10)*/
                 .IgnoreArgument_source();
 
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(IGNORED_PTR_ARG)) /*24*/
+            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(IGNORED_PTR_ARG))
                 .IgnoreArgument_desiredPropertyHandle()
                 .SetReturn(desiredPropertiesHaveCallbacks ? onDesiredPropertySimpleProperty : NULL);
 
             if (desiredPropertiesHaveCallbacks)
             {
-                STRICT_EXPECTED_CALL(onDesiredPropertySimpleProperty(IGNORED_PTR_ARG))
-                    .IgnoreArgument_v();
+                STRICT_EXPECTED_CALL(onDesiredPropertySimpleProperty((unsigned char*)deviceMemoryArea + 10));
             }
 
-
             STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
                 .IgnoreArgument_agentData();
-
-            STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
         }
 
-        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_OnDesiredProperty(IGNORED_PTR_ARG, "modelInModel")) /*27*/
-            .IgnoreArgument_modelTypeHandle()
-            .SetReturn(desiredPropertiesHaveCallbacks ? onDesiredPropertyModelInModel : NULL);
-
         if (desiredPropertiesHaveCallbacks)
         {
-            STRICT_EXPECTED_CALL(onDesiredPropertyModelInModel(IGNORED_PTR_ARG))
-                .IgnoreArgument_v();
+            STRICT_EXPECTED_CALL(onDesiredPropertyModelInModel(deviceMemoryArea));
         }
 
-        STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the frames*/
+            .IgnoreArgument_ptr();
 
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*the copy of the name*/
             .IgnoreArgument_ptr();
     }
 
-    /*Tests_SRS_COMMAND_DECODER_02_009: [ If the child name corresponds to a model in model then the function shall call itself recursively. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_009: [ If the child name corresponds to a model in model then the members of the child object shall be ingested into the model in model. ]*/
     TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_happy_path)
     {
         ///arrange
@@ -3303,11 +3999,9 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         umock_c_reset_all_calls();
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"modelInModel\":{\"int_field\":3}}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+        SET_TEST_JSON_EVENTS(modelInModelDesiredPropertyEvents);
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, false);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3328,37 +4022,26 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"modelInModel\":{\"int_field\":3}}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+        SET_TEST_JSON_EVENTS(modelInModelDesiredPropertyEvents);
         (void)umock_c_negative_tests_init();
         umock_c_reset_all_calls();
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, false);
 
         umock_c_negative_tests_snapshot();
 
         size_t calls_that_cannot_fail[] =
         {
-            2, /*MultiTree_DeleteChild*/
-            3, /*MultiTree_GetChildCount*/
-            7, /*STRING_c_str*/
-            9, /*Schema_GetModelModelByName_Offset*/
-            10, /*MultiTree_GetChildCount*/
-            13, /*MultiTree_GetName*/
-            14, /*STRING_c_str*/
-            16, /*Schema_GetModelDesiredPropertyType*/
-            17, /*Schema_GetSchemaForModelType*/
-            18, /*CodeFirst_GetPrimitiveType*/
-            21, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
-            22, /*Schema_GetModelDesiredProperty_offset*/
-            24, /*Destroy_AGENT_DATA_TYPE*/
-            25, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
-            26, /*STRING_delete*/
-            27, /*STRING_delete*/
-            28, /*Schema_GetModelModelByName_OnDesiredProperty*/
-            29, /*MultiTree_Destroy*/
-            30, /*gballoc_free*/
+            4, /*Schema_GetModelModelByName_Offset*/
+            5, /*Schema_GetModelModelByName_OnDesiredProperty*/
+            7, /*Schema_GetModelDesiredPropertyType*/
+            8, /*CodeFirst_GetPrimitiveType*/
+            10, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
+            11, /*Schema_GetModelDesiredProperty_offset*/
+            13, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
+            14, /*Destroy_AGENT_DATA_TYPE*/
+            15, /*gballoc_free*/
+            16, /*gballoc_free*/
         };
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -3402,11 +4085,9 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         umock_c_reset_all_calls();
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"int_field\":3}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+        SET_TEST_JSON_EVENTS(simpleDesiredPropertyEvents);
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, true);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, true);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3429,11 +4110,9 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         umock_c_reset_all_calls();
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"modelInModel\":{\"int_field\":3}}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+        SET_TEST_JSON_EVENTS(modelInModelDesiredPropertyEvents);
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, true);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, true);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
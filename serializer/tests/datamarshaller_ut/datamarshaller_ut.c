@@ -30,6 +30,8 @@ static void my_gballoc_free(void* s)
 
 #define ENABLE_MOCKS
 #include "jsonencoder.h"
+#include "jsonwriter.h"
+#include "cborencoder.h"
 #include "multitree.h"
 #include "schema.h"
 #include "azure_c_shared_utility/optimize_size.h"
@@ -132,6 +134,12 @@ IMPLEMENT_UMOCK_C_ENUM_TYPE(MULTITREE_RESULT, MULTITREE_RESULT_VALUES);
 TEST_DEFINE_ENUM_TYPE(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT_VALUES);
 
+TEST_DEFINE_ENUM_TYPE(JSON_WRITER_RESULT, JSON_WRITER_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(JSON_WRITER_RESULT, JSON_WRITER_RESULT_VALUES);
+
+TEST_DEFINE_ENUM_TYPE(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+
 #define DEFAULT_PROPERTY_NAME_2 "blahBlah"
 
 static MULTITREE_HANDLE my_MultiTree_Create(MULTITREE_CLONE_FUNCTION cloneFunction, MULTITREE_FREE_FUNCTION freeFunction)
@@ -156,6 +164,55 @@ static void my_STRING_delete(STRING_HANDLE handle)
     my_gballoc_free(handle);
 }
 
+#define TEST_JSON_PAYLOAD "Test"
+
+static JSON_WRITER_HANDLE my_JSONWriter_Create(size_t initialCapacity)
+{
+    (void)initialCapacity;
+    return (JSON_WRITER_HANDLE)my_gballoc_malloc(3);
+}
+
+static void my_JSONWriter_Destroy(JSON_WRITER_HANDLE handle)
+{
+    my_gballoc_free(handle);
+}
+
+static JSON_WRITER_RESULT my_JSONWriter_Release(JSON_WRITER_HANDLE handle, unsigned char** destination, size_t* destinationSize)
+{
+    (void)handle;
+    *destinationSize = strlen(TEST_JSON_PAYLOAD);
+    *destination = (unsigned char*)my_gballoc_malloc(*destinationSize);
+    (void)memcpy(*destination, TEST_JSON_PAYLOAD, *destinationSize);
+    return JSON_WRITER_OK;
+}
+
+/*{"defaultPropertyName":2.4} in CBOR*/
+static const unsigned char TEST_CBOR_PAYLOAD[] = { 0xA1, 0x73, 'd', 'e', 'f', 'a', 'u', 'l', 't', 'P', 'r', 'o', 'p', 'e', 'r', 't', 'y', 'N', 'a', 'm', 'e', 0xFA, 0x40, 0x19, 0x99, 0x9A };
+
+static CBOR_ENCODER_RESULT my_CBOREncoder_EncodeTree(MULTITREE_HANDLE treeHandle, size_t initialCapacity, unsigned char** destination, size_t* destinationSize)
+{
+    (void)treeHandle;
+    (void)initialCapacity;
+    *destinationSize = sizeof(TEST_CBOR_PAYLOAD);
+    *destination = (unsigned char*)my_gballoc_malloc(*destinationSize);
+    (void)memcpy(*destination, TEST_CBOR_PAYLOAD, *destinationSize);
+    return CBOR_ENCODER_OK;
+}
+
+static MULTITREE_HANDLE customEncoderTree;
+static size_t customEncoderCapacityHint;
+static DATA_MARSHALLER_RESULT customEncoder_encodeTree(MULTITREE_HANDLE treeHandle, size_t capacityHint, unsigned char** destination, size_t* destinationSize)
+{
+    customEncoderTree = treeHandle;
+    customEncoderCapacityHint = capacityHint;
+    *destinationSize = 1;
+    *destination = (unsigned char*)my_gballoc_malloc(*destinationSize);
+    (*destination)[0] = 0xA0;
+    return DATA_MARSHALLER_OK;
+}
+
+static const DATA_MARSHALLER_ENCODER customEncoder = { "application/x-custom", NULL, customEncoder_encodeTree };
+
 static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
 {
     (void)value;
@@ -206,10 +263,20 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(DATA_MARSHALLER_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(JSON_ENCODER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(JSON_WRITER_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(JSON_WRITER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(CBOR_ENCODER_RESULT, int);
             
         REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Create, my_MultiTree_Create);
         REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Destroy, my_MultiTree_Destroy);
 
+        REGISTER_GLOBAL_MOCK_HOOK(JSONWriter_Create, my_JSONWriter_Create);
+        REGISTER_GLOBAL_MOCK_HOOK(JSONWriter_Destroy, my_JSONWriter_Destroy);
+        REGISTER_GLOBAL_MOCK_HOOK(JSONWriter_Release, my_JSONWriter_Release);
+
+        REGISTER_GLOBAL_MOCK_HOOK(CBOREncoder_EncodeTree, my_CBOREncoder_EncodeTree);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(CBOREncoder_EncodeTree, CBOR_ENCODER_ERROR);
+
         REGISTER_STRING_GLOBAL_MOCK_HOOK;
 
         REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_ToString, my_AgentDataTypes_ToString);
@@ -661,14 +728,11 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
 
         STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
             .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc()
+        STRICT_EXPECTED_CALL(JSONWriter_Create(0));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeTreeToWriter(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments()
             .SetReturn(JSON_ENCODER_ERROR);
-
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(JSONWriter_Destroy(IGNORED_PTR_ARG))
             .IgnoreArgument_handle();
 
         STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
@@ -696,7 +760,6 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &structTypeValue } };
-        char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
@@ -704,22 +767,13 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
             .IgnoreArgument_treeHandle();
         STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &structTypeValue))
             .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
-
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
-
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
-
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(JSONWriter_Create(0));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeTreeToWriter(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONWriter_Release(IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(JSONWriter_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle();
 
@@ -729,8 +783,8 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
-        ASSERT_ARE_EQUAL(size_t, strlen(json_payload), destinationSize);
-        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, json_payload, destinationSize));
+        ASSERT_ARE_EQUAL(size_t, strlen(TEST_JSON_PAYLOAD), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, TEST_JSON_PAYLOAD, destinationSize));
             
 
         ///cleanup
@@ -747,7 +801,6 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &structTypeValue } };
-        char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
@@ -755,22 +808,13 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
             .IgnoreArgument_treeHandle();
         STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &structTypeValue))
             .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
-
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
-
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
-
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(JSONWriter_Create(0));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeTreeToWriter(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONWriter_Release(IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(JSONWriter_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle();
 
@@ -795,7 +839,6 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &floatValid } };
-        char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
@@ -803,22 +846,13 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
             .IgnoreArgument_treeHandle();
         STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &floatValid))
             .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
-
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
-
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
-
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(JSONWriter_Create(0));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeTreeToWriter(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONWriter_Release(IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(JSONWriter_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle();
 
@@ -843,28 +877,18 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
-        char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
         STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
             .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
-
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
-
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
-
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(JSONWriter_Create(0));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeTreeToWriter(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONWriter_Release(IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(JSONWriter_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle();
 
@@ -890,7 +914,6 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &structTypeValue2Members };
-        char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
@@ -898,21 +921,13 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
             .IgnoreArgument_treeHandle();
         STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "y", structTypeValue2Members.value.edmComplexType.fields[1].value))
             .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
-
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
-
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(JSONWriter_Create(0));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeTreeToWriter(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONWriter_Release(IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(JSONWriter_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle();
 
@@ -991,7 +1006,7 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
     }
 
     /* Tests_SRS_DATAMARSHALLER_01_003: [DATA_MARSHALLER_ERROR shall be returned for any errors when calling IoTHubMessage APIs.] */
-    TEST_FUNCTION(when_STRING_new_fails_SendData_Fails)
+    TEST_FUNCTION(when_JSONWriter_Create_fails_SendData_Fails)
     {
         ///arrange
         DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, false);
@@ -1004,7 +1019,7 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
 
         STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
             .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new())
+        STRICT_EXPECTED_CALL(JSONWriter_Create(0))
             .SetReturn(NULL);
         STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle();
@@ -1020,6 +1035,268 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         DataMarshaller_Destroy(handle);
     }
 
+    /*Tests_SRS_DATA_MARSHALLER_99_015:[ DATA_MARSHALLER_ERROR shall be returned in all the other error cases not explicitly defined here.]*/
+    TEST_FUNCTION(when_JSONWriter_Release_fails_SendData_Fails)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, false);
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
+
+        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(JSONWriter_Create(0));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeTreeToWriter(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONWriter_Release(IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_handle()
+            .SetReturn(JSON_WRITER_ERROR);
+        STRICT_EXPECTED_CALL(JSONWriter_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle();
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        DataMarshaller_Destroy(handle);
+    }
+
+    /*Tests_SRS_DATAMARSHALLER_09_001: [ DataMarshaller_SendData shall create a JSON_WRITER whose initial capacity is the size of the previous payload produced by this DataMarshaller instance. ]*/
+    /*Tests_SRS_DATAMARSHALLER_09_002: [ DataMarshaller_SendData shall encode the MultiTree by calling JSONEncoder_EncodeTreeToWriter. ]*/
+    /*Tests_SRS_DATAMARSHALLER_09_003: [ The content shall be handed over by JSONWriter_Release, without copying it. ]*/
+    TEST_FUNCTION(SendData_presizes_the_writer_with_the_size_of_the_previous_payload)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
+        (void)DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
+        free(destination);
+        umock_c_reset_all_calls();
+
+        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(JSONWriter_Create(strlen(TEST_JSON_PAYLOAD)));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeTreeToWriter(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONWriter_Release(IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(JSONWriter_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle();
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, strlen(TEST_JSON_PAYLOAD), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, TEST_JSON_PAYLOAD, destinationSize));
+
+        ///cleanup
+        free(destination);
+        DataMarshaller_Destroy(handle);
+    }
+
+    /*Tests_SRS_DATAMARSHALLER_09_006: [ The JSON encoder shall have the content type "application/json" and the content encoding "utf-8". ]*/
+    TEST_FUNCTION(DataMarshaller_GetJSONEncoder_returns_the_JSON_encoder)
+    {
+        ///arrange
+
+        ///act
+        const DATA_MARSHALLER_ENCODER* encoder = DataMarshaller_GetJSONEncoder();
+
+        ///assert
+        ASSERT_IS_NOT_NULL(encoder);
+        ASSERT_ARE_EQUAL(char_ptr, "application/json", encoder->contentType);
+        ASSERT_ARE_EQUAL(char_ptr, "utf-8", encoder->contentEncoding);
+        ASSERT_IS_NOT_NULL(encoder->encodeTree);
+    }
+
+    /*Tests_SRS_DATAMARSHALLER_09_007: [ The CBOR encoder shall have the content type "application/cbor" and no content encoding. ]*/
+    TEST_FUNCTION(DataMarshaller_GetCBOREncoder_returns_the_CBOR_encoder)
+    {
+        ///arrange
+
+        ///act
+        const DATA_MARSHALLER_ENCODER* encoder = DataMarshaller_GetCBOREncoder();
+
+        ///assert
+        ASSERT_IS_NOT_NULL(encoder);
+        ASSERT_ARE_EQUAL(char_ptr, "application/cbor", encoder->contentType);
+        ASSERT_IS_NULL(encoder->contentEncoding);
+        ASSERT_IS_NOT_NULL(encoder->encodeTree);
+    }
+
+    /*Tests_SRS_DATAMARSHALLER_09_008: [ Before any call to DataMarshaller_SetDefaultEncoder, the default encoder shall be the JSON encoder. ]*/
+    /*Tests_SRS_DATAMARSHALLER_09_009: [ DataMarshaller_SetDefaultEncoder shall set the encoder of the DataMarshaller instances created afterwards; a NULL encoder, or one without encodeTree, shall restore the JSON encoder. ]*/
+    TEST_FUNCTION(DataMarshaller_SetDefaultEncoder_with_NULL_restores_the_JSON_encoder)
+    {
+        ///arrange
+        DataMarshaller_SetDefaultEncoder(DataMarshaller_GetCBOREncoder());
+
+        ///act
+        DataMarshaller_SetDefaultEncoder(NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(void_ptr, (void*)DataMarshaller_GetJSONEncoder(), (void*)DataMarshaller_GetDefaultEncoder());
+    }
+
+    /*Tests_SRS_DATAMARSHALLER_09_004: [ DataMarshaller_Create shall capture the default encoder set by DataMarshaller_SetDefaultEncoder. ]*/
+    /*Tests_SRS_DATAMARSHALLER_09_009: [ DataMarshaller_SetDefaultEncoder shall set the encoder of the DataMarshaller instances created afterwards; a NULL encoder, or one without encodeTree, shall restore the JSON encoder. ]*/
+    /*Tests_SRS_DATAMARSHALLER_09_013: [ DataMarshaller_GetEncoder shall return the encoder the instance was created with. ]*/
+    TEST_FUNCTION(DataMarshaller_SetDefaultEncoder_does_not_change_the_encoder_of_existing_instances)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE jsonHandle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        DataMarshaller_SetDefaultEncoder(DataMarshaller_GetCBOREncoder());
+
+        ///act
+        DATA_MARSHALLER_HANDLE cborHandle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+
+        ///assert
+        ASSERT_ARE_EQUAL(void_ptr, (void*)DataMarshaller_GetJSONEncoder(), (void*)DataMarshaller_GetEncoder(jsonHandle));
+        ASSERT_ARE_EQUAL(void_ptr, (void*)DataMarshaller_GetCBOREncoder(), (void*)DataMarshaller_GetEncoder(cborHandle));
+
+        ///cleanup
+        DataMarshaller_SetDefaultEncoder(NULL);
+        DataMarshaller_Destroy(cborHandle);
+        DataMarshaller_Destroy(jsonHandle);
+    }
+
+    /*Tests_SRS_DATAMARSHALLER_09_012: [ If dataMarshallerHandle is NULL, DataMarshaller_GetEncoder shall return NULL. ]*/
+    TEST_FUNCTION(DataMarshaller_GetEncoder_with_NULL_handle_returns_NULL)
+    {
+        ///arrange
+
+        ///act
+        const DATA_MARSHALLER_ENCODER* encoder = DataMarshaller_GetEncoder(NULL);
+
+        ///assert
+        ASSERT_IS_NULL(encoder);
+    }
+
+    /*Tests_SRS_DATAMARSHALLER_09_005: [ DataMarshaller_SendData shall encode the MultiTree by calling the encodeTree function of the encoder of the instance, passing the size of the previous payload produced by this DataMarshaller instance as capacity hint. ]*/
+    /*Tests_SRS_DATAMARSHALLER_09_010: [ The CBOR encoder shall encode the MultiTree by calling CBOREncoder_EncodeTree with the capacity hint as initial capacity. ]*/
+    TEST_FUNCTION(SendData_with_the_CBOR_encoder_encodes_the_tree_with_CBOREncoder_EncodeTree)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle;
+        unsigned char* destination;
+        size_t destinationSize;
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
+        DataMarshaller_SetDefaultEncoder(DataMarshaller_GetCBOREncoder());
+        handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        DataMarshaller_SetDefaultEncoder(NULL);
+        (void)DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
+        free(destination);
+        umock_c_reset_all_calls();
+
+        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(CBOREncoder_EncodeTree(IGNORED_PTR_ARG, sizeof(TEST_CBOR_PAYLOAD), &destination, &destinationSize))
+            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle();
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, sizeof(TEST_CBOR_PAYLOAD), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, TEST_CBOR_PAYLOAD, destinationSize));
+
+        ///cleanup
+        free(destination);
+        DataMarshaller_Destroy(handle);
+    }
+
+    /*Tests_SRS_DATAMARSHALLER_09_011: [ If CBOREncoder_EncodeTree fails, DataMarshaller_SendData shall return DATA_MARSHALLER_CBOR_ENCODER_ERROR. ]*/
+    TEST_FUNCTION(when_CBOREncoder_EncodeTree_fails_SendData_fails)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle;
+        unsigned char* destination;
+        size_t destinationSize;
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
+        DataMarshaller_SetDefaultEncoder(DataMarshaller_GetCBOREncoder());
+        handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        DataMarshaller_SetDefaultEncoder(NULL);
+        umock_c_reset_all_calls();
+
+        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(CBOREncoder_EncodeTree(IGNORED_PTR_ARG, 0, &destination, &destinationSize))
+            .IgnoreArgument_treeHandle()
+            .SetReturn(CBOR_ENCODER_ERROR);
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle();
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_CBOR_ENCODER_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        DataMarshaller_Destroy(handle);
+    }
+
+    /*Tests_SRS_DATAMARSHALLER_09_005: [ DataMarshaller_SendData shall encode the MultiTree by calling the encodeTree function of the encoder of the instance, passing the size of the previous payload produced by this DataMarshaller instance as capacity hint. ]*/
+    TEST_FUNCTION(SendData_with_a_custom_encoder_calls_its_encodeTree)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle;
+        unsigned char* destination;
+        size_t destinationSize;
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
+        DataMarshaller_SetDefaultEncoder(&customEncoder);
+        handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        DataMarshaller_SetDefaultEncoder(NULL);
+        customEncoderTree = NULL;
+        customEncoderCapacityHint = 42;
+        umock_c_reset_all_calls();
+
+        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle();
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_IS_NOT_NULL(customEncoderTree);
+        ASSERT_ARE_EQUAL(size_t, 0, customEncoderCapacityHint);
+        ASSERT_ARE_EQUAL(size_t, 1, destinationSize);
+
+        ///cleanup
+        free(destination);
+        DataMarshaller_Destroy(handle);
+    }
+
     /*Tests_SRS_DATA_MARSHALLER_02_021: [ If argument dataMarshallerHandle is NULL then DataMarshaller_SendData_ReportedProperties shall fail and return DATA_MARSHALLER_INVALID_ARG. ]*/
     TEST_FUNCTION(DataMarshaller_SendData_ReportedProperties_with_NULL_dataMarshallerHandle_fails)
     {
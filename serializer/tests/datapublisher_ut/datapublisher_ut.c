@@ -160,6 +160,7 @@ BEGIN_TEST_SUITE(DataPublisher_ut)
 
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_MODEL_TYPE_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(DATA_MARSHALLER_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(const DATA_MARSHALLER_ENCODER*, void*);
         REGISTER_UMOCK_ALIAS_TYPE(VECTOR_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(PREDICATE_FUNCTION, void*);
         REGISTER_UMOCK_ALIAS_TYPE(const VECTOR_HANDLE, void*);
@@ -1801,4 +1802,42 @@ next_fail:;
         ///clean
         DataPublisher_Destroy(dataPublisherHandle);
     }
+
+    /* DataPublisher_GetEncoder */
+
+    /*Tests_SRS_DATA_PUBLISHER_09_001: [ If dataPublisherHandle is NULL, DataPublisher_GetEncoder shall return NULL. ]*/
+    TEST_FUNCTION(DataPublisher_GetEncoder_with_NULL_dataPublisherHandle_returns_NULL)
+    {
+        ///arrange
+
+        ///act
+        const DATA_MARSHALLER_ENCODER* encoder = DataPublisher_GetEncoder(NULL);
+
+        ///assert
+        ASSERT_IS_NULL(encoder);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_DATA_PUBLISHER_09_002: [ Otherwise DataPublisher_GetEncoder shall return what DataMarshaller_GetEncoder returns for the DataMarshaller instance of dataPublisherHandle. ]*/
+    TEST_FUNCTION(DataPublisher_GetEncoder_returns_the_encoder_of_the_DataMarshaller_instance)
+    {
+        ///arrange
+        static const DATA_MARSHALLER_ENCODER testEncoder = { "application/cbor", NULL, NULL };
+        DATA_PUBLISHER_HANDLE dataPublisherHandle = DataPublisher_Create(TEST_SCHEMA_MODEL_TYPE_HANDLE, true);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(DataMarshaller_GetEncoder(IGNORED_PTR_ARG))
+            .IgnoreArgument_dataMarshallerHandle()
+            .SetReturn(&testEncoder);
+
+        ///act
+        const DATA_MARSHALLER_ENCODER* encoder = DataPublisher_GetEncoder(dataPublisherHandle);
+
+        ///assert
+        ASSERT_ARE_EQUAL(void_ptr, (void*)&testEncoder, (void*)encoder);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        DataPublisher_Destroy(dataPublisherHandle);
+    }
 END_TEST_SUITE(DataPublisher_ut)
@@ -0,0 +1,345 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <cfloat>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#endif
+
+#include "testrunnerswitcher.h"
+
+#include "floatformat.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+/*number of random values checked by the conformance tests*/
+#define RANDOM_VALUES_COUNT 1000000
+
+typedef struct DOUBLE_EXAMPLE_TAG
+{
+    double value;
+    const char* expected;
+} DOUBLE_EXAMPLE;
+
+typedef struct FLOAT_EXAMPLE_TAG
+{
+    float value;
+    const char* expected;
+} FLOAT_EXAMPLE;
+
+static const DOUBLE_EXAMPLE doubleExamples[] =
+{
+    { 0.0, "0" },
+    { 1.0, "1" },
+    { -3.5, "-3.5" },
+    { 10.5, "10.5" },
+    { 0.1, "0.1" },
+    { 0.3, "0.3" },
+    { 2.0 / 3.0, "0.6666666666666666" },
+    { 328647.47547929373980211, "328647.47547929373" },
+    { 100.0, "100" },
+    { 9007199254740993.0, "9007199254740992" },
+    { 1e20, "100000000000000000000" },
+    { 123456789012345678901.0, "123456789012345680000" },
+    { 1e21, "1e+21" },
+    { 1.5e300, "1.5e+300" },
+    { 0.000001, "0.000001" },
+    { 0.0000012345, "0.0000012345" },
+    { 1e-7, "1e-7" },
+    { 1.5e-7, "1.5e-7" },
+    { DBL_MAX, "1.7976931348623157e+308" },
+    { DBL_MIN, "2.2250738585072014e-308" },
+    { 4.9406564584124654e-324, "5e-324" }
+};
+
+static const FLOAT_EXAMPLE floatExamples[] =
+{
+    { 0.0f, "0" },
+    { -3.5f, "-3.5" },
+    { 42.5f, "42.5" },
+    { 42.589123f, "42.589123" },
+    { 0.1f, "0.1" },
+    { 16777216.0f, "16777216" },
+    { FLT_MAX, "3.4028235e+38" },
+    { FLT_MIN, "1.1754944e-38" },
+    { 1.4e-45f, "1e-45" }
+};
+
+/*xorshift64, so that every run checks the same values*/
+static uint64_t nextRandom(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/*counts the significant digits of the text, that is the digits of the mantissa without the leading and trailing zeros*/
+static size_t countSignificantDigits(const char* text)
+{
+    size_t first = 0;
+    size_t last = 0;
+    size_t count = 0;
+    size_t i;
+    for (i = 0; (text[i] != '\0') && (text[i] != 'e'); i++)
+    {
+        if ((text[i] >= '0') && (text[i] <= '9'))
+        {
+            count++;
+            if (text[i] != '0')
+            {
+                if (first == 0)
+                {
+                    first = count;
+                }
+                last = count;
+            }
+        }
+    }
+    return (first == 0) ? 1 : (last - first + 1);
+}
+
+BEGIN_TEST_SUITE(floatformat_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/*Tests_SRS_FLOATFORMAT_09_001: [ If destination is NULL or value is NaN or an infinity, the function shall fail and return 0. ]*/
+TEST_FUNCTION(FloatFormat_Double_with_NULL_destination_fails)
+{
+    ///act
+    size_t result = FloatFormat_Double(1.0, NULL, FLOAT_FORMAT_BUFFER_SIZE);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 0, result);
+}
+
+/*Tests_SRS_FLOATFORMAT_09_001: [ If destination is NULL or value is NaN or an infinity, the function shall fail and return 0. ]*/
+TEST_FUNCTION(FloatFormat_Single_with_NULL_destination_fails)
+{
+    ///act
+    size_t result = FloatFormat_Single(1.0f, NULL, FLOAT_FORMAT_BUFFER_SIZE);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 0, result);
+}
+
+/*Tests_SRS_FLOATFORMAT_09_001: [ If destination is NULL or value is NaN or an infinity, the function shall fail and return 0. ]*/
+TEST_FUNCTION(FloatFormat_Double_with_NaN_and_infinities_fails)
+{
+    ///arrange
+    char destination[FLOAT_FORMAT_BUFFER_SIZE];
+
+    ///act + assert
+    ASSERT_ARE_EQUAL(size_t, 0, FloatFormat_Double(NAN, destination, sizeof(destination)));
+    ASSERT_ARE_EQUAL(size_t, 0, FloatFormat_Double(INFINITY, destination, sizeof(destination)));
+    ASSERT_ARE_EQUAL(size_t, 0, FloatFormat_Double(-INFINITY, destination, sizeof(destination)));
+    ASSERT_ARE_EQUAL(size_t, 0, FloatFormat_Single(NAN, destination, sizeof(destination)));
+    ASSERT_ARE_EQUAL(size_t, 0, FloatFormat_Single(INFINITY, destination, sizeof(destination)));
+    ASSERT_ARE_EQUAL(size_t, 0, FloatFormat_Single(-INFINITY, destination, sizeof(destination)));
+}
+
+/*Tests_SRS_FLOATFORMAT_09_002: [ If destinationSize is too small for the text and its terminating '\0', the function shall fail and return 0. ]*/
+TEST_FUNCTION(FloatFormat_Double_with_too_small_destination_fails)
+{
+    ///arrange
+    char destination[FLOAT_FORMAT_BUFFER_SIZE];
+
+    ///act + assert
+    ASSERT_ARE_EQUAL(size_t, 0, FloatFormat_Double(-3.5, destination, 4));
+    ASSERT_ARE_EQUAL(size_t, 4, FloatFormat_Double(-3.5, destination, 5));
+    ASSERT_ARE_EQUAL(char_ptr, "-3.5", destination);
+}
+
+/*Tests_SRS_FLOATFORMAT_09_002: [ If destinationSize is too small for the text and its terminating '\0', the function shall fail and return 0. ]*/
+TEST_FUNCTION(FloatFormat_Single_with_too_small_destination_fails)
+{
+    ///arrange
+    char destination[FLOAT_FORMAT_BUFFER_SIZE];
+
+    ///act + assert
+    ASSERT_ARE_EQUAL(size_t, 0, FloatFormat_Single(42.5f, destination, 4));
+    ASSERT_ARE_EQUAL(size_t, 4, FloatFormat_Single(42.5f, destination, 5));
+    ASSERT_ARE_EQUAL(char_ptr, "42.5", destination);
+}
+
+/*Tests_SRS_FLOATFORMAT_09_003: [ FloatFormat_Double shall write the shortest (Grisu2: in all but rare cases) decimal text of at most 17 significant digits that strtod parses back to exactly value, followed by '\0', and return the number of characters written, not counting the '\0'. ]*/
+/*Tests_SRS_FLOATFORMAT_09_004: [ The text shall not depend on the current locale: the decimal separator is always '.'. ]*/
+/*Tests_SRS_FLOATFORMAT_09_005: [ Values whose decimal exponent is in [-6, 20] shall be written in plain decimal notation (0.000001, 1.5, 100000000000000000000), all other values shall be written as d[.ddd]e+x or d[.ddd]e-x (1e+21, 1.5e-7). ]*/
+TEST_FUNCTION(FloatFormat_Double_formats_examples)
+{
+    size_t i;
+    for (i = 0; i < sizeof(doubleExamples) / sizeof(doubleExamples[0]); i++)
+    {
+        ///arrange
+        char destination[FLOAT_FORMAT_BUFFER_SIZE];
+
+        ///act
+        size_t result = FloatFormat_Double(doubleExamples[i].value, destination, sizeof(destination));
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, doubleExamples[i].expected, destination);
+        ASSERT_ARE_EQUAL(size_t, strlen(doubleExamples[i].expected), result);
+    }
+}
+
+/*Tests_SRS_FLOATFORMAT_09_006: [ 0 and -0 shall be written as 0 and -0. ]*/
+TEST_FUNCTION(FloatFormat_Double_keeps_the_sign_of_negative_zero)
+{
+    ///arrange
+    char destination[FLOAT_FORMAT_BUFFER_SIZE];
+
+    ///act
+    size_t result = FloatFormat_Double(-0.0, destination, sizeof(destination));
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 2, result);
+    ASSERT_ARE_EQUAL(char_ptr, "-0", destination);
+}
+
+/*Tests_SRS_FLOATFORMAT_09_005: [ Values whose decimal exponent is in [-6, 20] shall be written in plain decimal notation (0.000001, 1.5, 100000000000000000000), all other values shall be written as d[.ddd]e+x or d[.ddd]e-x (1e+21, 1.5e-7). ]*/
+TEST_FUNCTION(FloatFormat_Double_formats_powers_of_10_outside_the_plain_range_in_exponent_notation)
+{
+    int exponent;
+    for (exponent = -307; exponent <= 308; exponent++)
+    {
+        if ((exponent < -6) || (exponent > 20))
+        {
+            ///arrange
+            char destination[FLOAT_FORMAT_BUFFER_SIZE];
+            char text[FLOAT_FORMAT_BUFFER_SIZE];
+            double value;
+            double parsed;
+            (void)sprintf(text, "1e%d", exponent);
+            value = strtod(text, NULL);
+
+            ///act
+            (void)FloatFormat_Double(value, destination, sizeof(destination));
+
+            ///assert
+            ASSERT_IS_NOT_NULL(strchr(destination, 'e'));
+            parsed = strtod(destination, NULL);
+            ASSERT_ARE_EQUAL(int, 0, memcmp(&parsed, &value, sizeof(value)));
+        }
+    }
+}
+
+/*Tests_SRS_FLOATFORMAT_09_003: [ FloatFormat_Double shall write the shortest (Grisu2: in all but rare cases) decimal text of at most 17 significant digits that strtod parses back to exactly value, followed by '\0', and return the number of characters written, not counting the '\0'. ]*/
+TEST_FUNCTION(FloatFormat_Double_random_values_parse_back_bit_exact)
+{
+    ///arrange
+    uint64_t state = 88172645463325252ULL;
+    size_t i;
+
+    for (i = 0; i < RANDOM_VALUES_COUNT; i++)
+    {
+        char destination[FLOAT_FORMAT_BUFFER_SIZE];
+        uint64_t bits = nextRandom(&state);
+        double value;
+        double parsed;
+        size_t result;
+        (void)memcpy(&value, &bits, sizeof(value));
+        if (((bits >> 52) & 0x7FF) == 0x7FF)
+        {
+            /*NaN and infinities are not formatted*/
+            continue;
+        }
+
+        ///act
+        result = FloatFormat_Double(value, destination, sizeof(destination));
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(size_t, 0, result);
+        ASSERT_ARE_EQUAL(size_t, strlen(destination), result);
+        ASSERT_IS_TRUE(countSignificantDigits(destination) <= 17);
+        parsed = strtod(destination, NULL);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(&parsed, &value, sizeof(value)));
+    }
+}
+
+/*Tests_SRS_FLOATFORMAT_09_007: [ FloatFormat_Single shall format value like FloatFormat_Double does, except that the text shall have at most 9 significant digits and shall parse back to exactly value with strtof. ]*/
+TEST_FUNCTION(FloatFormat_Single_formats_examples)
+{
+    size_t i;
+    for (i = 0; i < sizeof(floatExamples) / sizeof(floatExamples[0]); i++)
+    {
+        ///arrange
+        char destination[FLOAT_FORMAT_BUFFER_SIZE];
+
+        ///act
+        size_t result = FloatFormat_Single(floatExamples[i].value, destination, sizeof(destination));
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, floatExamples[i].expected, destination);
+        ASSERT_ARE_EQUAL(size_t, strlen(floatExamples[i].expected), result);
+    }
+}
+
+/*Tests_SRS_FLOATFORMAT_09_007: [ FloatFormat_Single shall format value like FloatFormat_Double does, except that the text shall have at most 9 significant digits and shall parse back to exactly value with strtof. ]*/
+TEST_FUNCTION(FloatFormat_Single_random_values_parse_back_bit_exact)
+{
+    ///arrange
+    uint64_t state = 2463534242ULL;
+    size_t i;
+
+    for (i = 0; i < RANDOM_VALUES_COUNT; i++)
+    {
+        char destination[FLOAT_FORMAT_BUFFER_SIZE];
+        uint32_t bits = (uint32_t)nextRandom(&state);
+        float value;
+        float parsed;
+        size_t result;
+        (void)memcpy(&value, &bits, sizeof(value));
+        if (((bits >> 23) & 0xFF) == 0xFF)
+        {
+            /*NaN and infinities are not formatted*/
+            continue;
+        }
+
+        ///act
+        result = FloatFormat_Single(value, destination, sizeof(destination));
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(size_t, 0, result);
+        ASSERT_IS_TRUE(countSignificantDigits(destination) <= 9);
+        parsed = strtof(destination, NULL);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(&parsed, &value, sizeof(value)));
+    }
+}
+
+END_TEST_SUITE(floatformat_ut)
@@ -0,0 +1,122 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#endif
+
+#include "testrunnerswitcher.h"
+
+#include "fnvhash.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+typedef struct FNVHASH_EXAMPLE_TAG
+{
+    const char* text;
+    uint32_t expected32;
+    uint64_t expected64;
+} FNVHASH_EXAMPLE;
+
+/*the FNV-1a test vectors published by Fowler/Noll/Vo*/
+static const FNVHASH_EXAMPLE examples[] =
+{
+    { "a", 0xe40c292cU, 0xaf63dc4c8601ec8cULL },
+    { "foobar", 0xbf9cf968U, 0x85944171f73967e8ULL },
+    { "deviceId", 0x7c291d9eU, 0x26e60045076ec69eULL }
+};
+
+BEGIN_TEST_SUITE(fnvhash_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/*Tests_SRS_FNVHASH_09_001: [ FnvHash_Compute32 shall return the 32 bit FNV-1a hash of the first length characters of text. ]*/
+TEST_FUNCTION(FnvHash_Compute32_returns_the_FNV_1a_hash)
+{
+    size_t i;
+    for (i = 0; i < sizeof(examples) / sizeof(examples[0]); i++)
+    {
+        ///act
+        uint32_t result = FnvHash_Compute32(examples[i].text, strlen(examples[i].text));
+
+        ///assert
+        ASSERT_ARE_EQUAL_WITH_MSG(uint32_t, examples[i].expected32, result, examples[i].text);
+    }
+}
+
+/*Tests_SRS_FNVHASH_09_002: [ FnvHash_Compute64 shall return the 64 bit FNV-1a hash of the first length characters of text. ]*/
+TEST_FUNCTION(FnvHash_Compute64_returns_the_FNV_1a_hash)
+{
+    size_t i;
+    for (i = 0; i < sizeof(examples) / sizeof(examples[0]); i++)
+    {
+        ///act
+        uint64_t result = FnvHash_Compute64(examples[i].text, strlen(examples[i].text));
+
+        ///assert
+        ASSERT_ARE_EQUAL_WITH_MSG(uint64_t, examples[i].expected64, result, examples[i].text);
+    }
+}
+
+/*Tests_SRS_FNVHASH_09_001: [ FnvHash_Compute32 shall return the 32 bit FNV-1a hash of the first length characters of text. ]*/
+/*Tests_SRS_FNVHASH_09_002: [ FnvHash_Compute64 shall return the 64 bit FNV-1a hash of the first length characters of text. ]*/
+TEST_FUNCTION(FnvHash_hashes_only_the_first_length_characters)
+{
+    ///arrange
+    const char* text = "foobar.baz";
+
+    ///act
+    uint32_t result32 = FnvHash_Compute32(text, 6);
+    uint64_t result64 = FnvHash_Compute64(text, 6);
+
+    ///assert
+    ASSERT_ARE_EQUAL(uint32_t, 0xbf9cf968U, result32);
+    ASSERT_ARE_EQUAL(uint64_t, 0x85944171f73967e8ULL, result64);
+}
+
+/*Tests_SRS_FNVHASH_09_003: [ If length is 0 then the hash shall be the offset basis and text shall not be accessed. ]*/
+TEST_FUNCTION(FnvHash_of_0_characters_is_the_offset_basis)
+{
+    ///act
+    uint32_t result32 = FnvHash_Compute32(NULL, 0);
+    uint64_t result64 = FnvHash_Compute64(NULL, 0);
+
+    ///assert
+    ASSERT_ARE_EQUAL(uint32_t, 0x811c9dc5U, result32);
+    ASSERT_ARE_EQUAL(uint64_t, 0xcbf29ce484222325ULL, result64);
+}
+
+END_TEST_SUITE(fnvhash_ut)
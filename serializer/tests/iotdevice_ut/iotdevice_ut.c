@@ -147,6 +147,7 @@ BEGIN_TEST_SUITE(IoTDevice_ut)
 
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_MODEL_TYPE_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(DATA_PUBLISHER_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(const DATA_MARSHALLER_ENCODER*, void*);
         REGISTER_UMOCK_ALIAS_TYPE(ACTION_CALLBACK_FUNC, void*);
         REGISTER_UMOCK_ALIAS_TYPE(COMMAND_DECODER_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(TRANSACTION_HANDLE, void*);
@@ -171,6 +172,7 @@ BEGIN_TEST_SUITE(IoTDevice_ut)
         REGISTER_GLOBAL_MOCK_HOOK(CommandDecoder_Create, my_CommandDecoder_Create);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(CommandDecoder_Create, NULL);
         REGISTER_GLOBAL_MOCK_RETURNS(CommandDecoder_ExecuteCommand, EXECUTE_COMMAND_SUCCESS, EXECUTE_COMMAND_ERROR);
+        REGISTER_GLOBAL_MOCK_RETURNS(CommandDecoder_ExecuteCommandCBOR, EXECUTE_COMMAND_SUCCESS, EXECUTE_COMMAND_ERROR);
         REGISTER_GLOBAL_MOCK_RETURNS(CommandDecoder_IngestDesiredProperties, EXECUTE_COMMAND_SUCCESS, EXECUTE_COMMAND_ERROR);
         REGISTER_GLOBAL_MOCK_HOOK(CommandDecoder_Destroy, my_CommandDecoder_Destroy);
         
@@ -859,6 +861,104 @@ BEGIN_TEST_SUITE(IoTDevice_ut)
         Device_Destroy(h);
     }
 
+    /*Tests_SRS_DEVICE_09_001: [ If deviceHandle or command is NULL, then Device_ExecuteCommandCBOR shall return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(Device_ExecuteCommandCBOR_with_NULL_handle_returns_EXECUTE_COMMAND_ERROR)
+    {
+        ///arrange
+        static const unsigned char command[] = { 0xA0 };
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = Device_ExecuteCommandCBOR(NULL, command, sizeof(command));
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+    }
+
+    /*Tests_SRS_DEVICE_09_001: [ If deviceHandle or command is NULL, then Device_ExecuteCommandCBOR shall return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(Device_ExecuteCommandCBOR_with_NULL_command_returns_EXECUTE_COMMAND_ERROR)
+    {
+        ///arrange
+        DEVICE_HANDLE h;
+        Device_Create(irrelevantModel, DeviceActionCallback, TEST_CALLBACK_CONTEXT, deviceMethodCallback, TEST_CALLBACK_CONTEXT, false, &h);
+        umock_c_reset_all_calls();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = Device_ExecuteCommandCBOR(h, NULL, 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        Device_Destroy(h);
+    }
+
+    /*Tests_SRS_DEVICE_09_002: [ Otherwise, Device_ExecuteCommandCBOR shall call CommandDecoder_ExecuteCommandCBOR and return what CommandDecoder_ExecuteCommandCBOR is returning. ]*/
+    TEST_FUNCTION(Device_ExecuteCommandCBOR_returns_what_CommandDecoder_ExecuteCommandCBOR_returns)
+    {
+        ///arrange
+        static const unsigned char command[] = { 0xA0 };
+        DEVICE_HANDLE h;
+        Device_Create(irrelevantModel, DeviceActionCallback, TEST_CALLBACK_CONTEXT, deviceMethodCallback, TEST_CALLBACK_CONTEXT, false, &h);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(CommandDecoder_ExecuteCommandCBOR(IGNORED_PTR_ARG, command, sizeof(command)))
+            .IgnoreArgument(1)
+            .SetReturn(EXECUTE_COMMAND_FAILED);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = Device_ExecuteCommandCBOR(h, command, sizeof(command));
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        Device_Destroy(h);
+    }
+
+    /*Tests_SRS_DEVICE_09_003: [ If deviceHandle is NULL, then Device_GetEncoder shall return NULL. ]*/
+    TEST_FUNCTION(Device_GetEncoder_with_NULL_handle_returns_NULL)
+    {
+        ///arrange
+
+        ///act
+        const DATA_MARSHALLER_ENCODER* result = Device_GetEncoder(NULL);
+
+        ///assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+    }
+
+    /*Tests_SRS_DEVICE_09_004: [ Otherwise, Device_GetEncoder shall call DataPublisher_GetEncoder and return what DataPublisher_GetEncoder is returning. ]*/
+    TEST_FUNCTION(Device_GetEncoder_returns_what_DataPublisher_GetEncoder_returns)
+    {
+        ///arrange
+        static const DATA_MARSHALLER_ENCODER testEncoder = { "application/cbor", NULL, NULL };
+        DEVICE_HANDLE h;
+        Device_Create(irrelevantModel, DeviceActionCallback, TEST_CALLBACK_CONTEXT, deviceMethodCallback, TEST_CALLBACK_CONTEXT, false, &h);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(DataPublisher_GetEncoder(IGNORED_PTR_ARG))
+            .IgnoreArgument(1)
+            .SetReturn(&testEncoder);
+
+        ///act
+        const DATA_MARSHALLER_ENCODER* result = Device_GetEncoder(h);
+
+        ///assert
+        ASSERT_ARE_EQUAL(void_ptr, (void*)&testEncoder, (void*)result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        Device_Destroy(h);
+    }
+
     /*Tests_SRS_DEVICE_02_013: [Otherwise, Device_ExecuteCommand shall call CommandDecoder_ExecuteCommand and return what CommandDecoder_ExecuteCommand is returning.]*/
     TEST_FUNCTION(Device_ExecuteCommand_returns_what_CommandDecoder_ExecuteCommand_returns_EXECUTE_COMMAND_SUCCESS)
     {
@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <cstdlib>
+#include <string>
 #include "testrunnerswitcher.h"
 #include "micromock.h"
 #include "micromockcharstararenullterminatedstrings.h"
@@ -37,6 +38,66 @@ DECLARE_GLOBAL_MOCK_METHOD_2(CJSONDecoderMocks, , MULTITREE_RESULT, MultiTree_Se
 
 static const char* emptyJSONobject = "{}";
 
+/*the JSONDecoder_JSON_To_Events callbacks append what they are called with to eventsTrace; eventsToFail makes the n-th callback fail*/
+static std::string eventsTrace;
+static size_t eventsToFail;
+static size_t eventsCount;
+
+static void traceName(const char* name, size_t nameLength)
+{
+    if (name != NULL)
+    {
+        eventsTrace.append(name, nameLength);
+        eventsTrace += "=";
+    }
+}
+
+static int traceResult(void)
+{
+    return (++eventsCount == eventsToFail) ? 1 : 0;
+}
+
+static int testOnBeginObject(void* context, const char* name, size_t nameLength)
+{
+    (void)context;
+    traceName(name, nameLength);
+    eventsTrace += "{";
+    return traceResult();
+}
+
+static int testOnEndObject(void* context)
+{
+    (void)context;
+    eventsTrace += "}";
+    return traceResult();
+}
+
+static int testOnBeginArray(void* context, const char* name, size_t nameLength)
+{
+    (void)context;
+    traceName(name, nameLength);
+    eventsTrace += "[";
+    return traceResult();
+}
+
+static int testOnEndArray(void* context)
+{
+    (void)context;
+    eventsTrace += "]";
+    return traceResult();
+}
+
+static int testOnValue(void* context, const char* name, size_t nameLength, const char* value, size_t valueLength)
+{
+    (void)context;
+    traceName(name, nameLength);
+    eventsTrace.append(value, valueLength);
+    eventsTrace += ";";
+    return traceResult();
+}
+
+static const JSON_DECODER_EVENTS testEvents = { testOnBeginObject, testOnEndObject, testOnBeginArray, testOnEndArray, testOnValue };
+
 MICROMOCK_ENUM_TO_STRING(JSON_DECODER_RESULT_TAG,
     L"JSON_DECODER_OK",
     L"JSON_DECODER_INVALID_ARG",
@@ -65,6 +126,13 @@ TEST_SUITE_CLEANUP(TestClassCleanup)
 
 }
 
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    eventsTrace.clear();
+    eventsToFail = 0;
+    eventsCount = 0;
+}
+
 /* Tests_SRS_JSON_DECODER_99_001:[ If any of the parameters passed to the JSONDecoder_JSON_To_MultiTree function is NULL then the function call shall return JSON_DECODER_INVALID_ARG.] */
 TEST_FUNCTION(JSONDecoder_With_NULL_json_argument_Fails)
 {
@@ -439,8 +507,6 @@ TEST_FUNCTION(JSONDecoder_When_The_JSON_Ends_After_The_Colon_Decoding_Fails)
     char json[] = "{\"m\":";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -460,8 +526,6 @@ TEST_FUNCTION(JSONDecoder_When_The_JSON_Ends_After_The_Begining_Value_Quote_Deco
     char json[] = "{\"member1\":\"";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -481,7 +545,6 @@ TEST_FUNCTION(JSONDecoder_When_The_JSON_Ends_In_The_Middle_Of_A_String_Value_Dec
     char json[] = "{\"member1\":\"a";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, IGNORED_PTR_ARG, IGNORED_PTR_ARG)).CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -600,7 +663,6 @@ TEST_FUNCTION(JSONDecoder_When_The_Starting_Quote_Of_A_String_Value_Is_Missing_D
     char json[] = "{\"member1\":a\"}";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, IGNORED_PTR_ARG, IGNORED_PTR_ARG)).CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -620,7 +682,6 @@ TEST_FUNCTION(JSONDecoder_When_The_Ending_Quote_Of_A_String_Value_Is_Missing_Dec
     char json[] = "{\"member1\":a\"}";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, IGNORED_PTR_ARG, IGNORED_PTR_ARG)).CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -671,6 +732,84 @@ TEST_FUNCTION(JSONDecoder_When_The_AddChild_Fails_Decoding_Fails)
     ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_MULTITREE_FAILED, result);
 }
 
+/* Tests_SRS_JSON_DECODER_99_038:[ If any MultiTree API fails, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_MULTITREE_FAILED.] */
+TEST_FUNCTION(JSONDecoder_When_The_AddChild_For_An_Array_Element_Fails_Decoding_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    MULTITREE_HANDLE multiTree;
+    char json[] = "[1,2]";
+
+    EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
+        .SetReturn(MULTITREE_ERROR);
+    STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_MultiTree(json, &multiTree);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_MULTITREE_FAILED, result);
+}
+
+/* Tests_SRS_JSON_DECODER_99_038:[ If any MultiTree API fails, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_MULTITREE_FAILED.] */
+TEST_FUNCTION(JSONDecoder_When_The_SetValue_Fails_Decoding_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    MULTITREE_HANDLE multiTree;
+    char json[] = "{\"member1\":\"a\"}";
+    void* member1Value = strstr(json, "\"a\"");
+
+    EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "member1", IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_SetValue(TestChildHandle1, member1Value))
+        .SetReturn(MULTITREE_ERROR);
+    STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_MultiTree(json, &multiTree);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_MULTITREE_FAILED, result);
+}
+
+/* Tests_SRS_JSON_DECODER_99_004:[ The leaf node name in the multi tree shall be the JSON element name.] */
+/* Tests_SRS_JSON_DECODER_99_039:[ For array elements the multi tree node name shall be the string representation of the array index.] */
+/* Tests_SRS_JSON_DECODER_99_049:[ JSONDecoder shall not allocate new string values for the leafs, but rather point to strings in the original JSON.] */
+TEST_FUNCTION(JSONDecoder_Terminates_The_Values_In_The_JSON_Text)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    MULTITREE_HANDLE multiTree;
+    char json[] = "{\"a\":1,\"b\":[true,\"x\"]}";
+
+    EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "a", IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_SetValue(TestChildHandle1, json + 5));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "b", IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(3, &TestChildHandle2, sizeof(TestChildHandle2));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestChildHandle2, "0", IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(3, &TestChildHandle3, sizeof(TestChildHandle3));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_SetValue(TestChildHandle3, json + 12));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestChildHandle2, "1", IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(3, &TestChildHandle3, sizeof(TestChildHandle3));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_SetValue(TestChildHandle3, json + 17));
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_MultiTree(json, &multiTree);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, "a", json + 2);
+    ASSERT_ARE_EQUAL(char_ptr, "1", json + 5);
+    ASSERT_ARE_EQUAL(char_ptr, "b", json + 8);
+    ASSERT_ARE_EQUAL(char_ptr, "true", json + 12);
+    ASSERT_ARE_EQUAL(char_ptr, "\"x\"", json + 17);
+}
+
 /* Tests_SRS_JSON_DECODER_99_026:[ An array structure is represented as square brackets surrounding zero or more values (or elements).] */
 TEST_FUNCTION(JSONDecoder_When_The_JSON_Contains_An_Empty_Array_Decoding_Succeeds)
 {
@@ -785,8 +924,6 @@ TEST_FUNCTION(JSONDecoder_When_The_JSON_Ends_After_The_Begginning_Quote_Of_The_A
     char json[] = "[\"";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -806,8 +943,6 @@ TEST_FUNCTION(JSONDecoder_When_The_JSON_Ends_In_The_Middle_Of_The_Array_First_St
     char json[] = "[\"a";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -854,8 +989,6 @@ TEST_FUNCTION(JSONDecoder_When_The_JSON_Ends_After_The_Comma_Of_The_Array_Decodi
     STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     STRICT_EXPECTED_CALL(mocks, MultiTree_SetValue(TestChildHandle1, value1Ptr));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "1", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle2, sizeof(TestChildHandle2));
     STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -938,8 +1071,6 @@ TEST_FUNCTION(JSONDecoder_When_The_JSON_Contains_An_Array_With_A_false_But_Not_A
     char json[] = "[fAlse]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -959,8 +1090,6 @@ TEST_FUNCTION(JSONDecoder_When_The_JSON_Contains_An_Array_With_A_true_But_Not_Al
     char json[] = "[trUe]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -980,8 +1109,6 @@ TEST_FUNCTION(JSONDecoder_When_The_JSON_Contains_An_Array_With_A_null_But_Not_Al
     char json[] = "[Null]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -1001,8 +1128,6 @@ TEST_FUNCTION(JSONDecoder_When_The_JSON_Contains_An_Array_With_A_Literal_Name_Th
     char json[] = "[hagauaga]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -1986,8 +2111,6 @@ TEST_FUNCTION(JSONDecoder_Number_With_2_Minus_Sign_Fails)
     char json[] = "[--4242]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -2029,8 +2152,6 @@ TEST_FUNCTION(JSONDecoder_Fraction_Part_Without_Integer_Fails)
     char json[] = "[.1]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -2050,8 +2171,6 @@ TEST_FUNCTION(JSONDecoder_No_Fraction_Part_Digits_Fails)
     char json[] = "[1.]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -2278,8 +2397,6 @@ TEST_FUNCTION(JSONDecoder_Integer_With_e_With_No_Digits_Fails)
     char json[] = "[1e]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -2300,8 +2417,6 @@ TEST_FUNCTION(JSONDecoder_Integer_With_E_With_No_Digits_Fails)
     char json[] = "[1E]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -2322,8 +2437,6 @@ TEST_FUNCTION(JSONDecoder_Integer_With_e_Sign_And_With_No_Digits_Fails)
     char json[] = "[1e-]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -2344,8 +2457,6 @@ TEST_FUNCTION(JSONDecoder_Integer_With_E_Sign_And_With_No_Digits_Fails)
     char json[] = "[1E-]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -2364,8 +2475,6 @@ TEST_FUNCTION(JSONDecoder_Integer_With_A_Leading_Zero_Fails)
     char json[] = "[01]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -2384,8 +2493,6 @@ TEST_FUNCTION(JSONDecoder_Integer_With_2_Leading_Zero_Fails)
     char json[] = "[001]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -2446,8 +2553,6 @@ TEST_FUNCTION(JSONDecoder_Integer_With_A_Hex_Number_Fails)
     char json[] = "[FF]";
 
     EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
     EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
 
     ///act
@@ -2589,4 +2694,203 @@ TEST_FUNCTION(JSONDecoder_When_String_Has_Several_Escaped_Chars_Decoding_Succeed
     TestSpecialCharacter_Success(json);
 }
 
+/* Tests_SRS_JSON_DECODER_09_001: [ JSONDecoder_JSON_To_MultiTree shall scan runs of white space and the characters of strings a block of 16 bytes at a time when the compiler targets SSE2, and a byte at a time otherwise.] */
+TEST_FUNCTION(JSONDecoder_When_Names_Values_And_White_Space_Span_Several_Blocks_Decoding_Succeeds)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    MULTITREE_HANDLE multiTree;
+    char json[] = "{\r\n                                \t\"aMemberNameLongerThanOneBlock\"                  :\r\n                                \"0123456789abcde\\\"0123456789ab\\\\\\/0123456789abcdefghijklmnopqrs\\t\"\r\n                                }";
+    void* memberValue = strstr(json, "\"0123456789abcde");
+
+    EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "aMemberNameLongerThanOneBlock", IGNORED_PTR_ARG)).CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_SetValue(TestChildHandle1, memberValue));
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_MultiTree(json, &multiTree);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, "\"0123456789abcde\\\"0123456789ab\\\\\\/0123456789abcdefghijklmnopqrs\\t\"", (const char*)memberValue);
+}
+
+/* Tests_SRS_JSON_DECODER_09_001: [ JSONDecoder_JSON_To_MultiTree shall scan runs of white space and the characters of strings a block of 16 bytes at a time when the compiler targets SSE2, and a byte at a time otherwise.] */
+/* Tests_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+TEST_FUNCTION(JSONDecoder_When_A_String_Longer_Than_A_Block_Is_Not_Terminated_Decoding_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    MULTITREE_HANDLE multiTree;
+    char json[] = "{\"member1\":\"0123456789abcdef0123456789abcdef0123456789}";
+
+    EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_MultiTree(json, &multiTree);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_PARSE_ERROR, result);
+}
+
+/* Tests_SRS_JSON_DECODER_09_001: [ JSONDecoder_JSON_To_MultiTree shall scan runs of white space and the characters of strings a block of 16 bytes at a time when the compiler targets SSE2, and a byte at a time otherwise.] */
+/* Tests_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+TEST_FUNCTION(JSONDecoder_When_A_String_Has_An_Invalid_Escape_After_The_First_Block_Decoding_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    MULTITREE_HANDLE multiTree;
+    char json[] = "{\"member1\":\"0123456789abcdef0123\\x456789abcdef\"}";
+
+    EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_MultiTree(json, &multiTree);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_PARSE_ERROR, result);
+}
+
+/* Tests_SRS_JSON_DECODER_99_039:[ For array elements the multi tree node name shall be the string representation of the array index.] */
+TEST_FUNCTION(JSONDecoder_When_An_Array_Has_More_Than_10_Elements_The_Names_Are_The_Decimal_Indexes)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    MULTITREE_HANDLE multiTree;
+    char json[] = "[0,1,2,3,4,5,6,7,8,9,10,11]";
+    static const char* const indexNames[] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11" };
+    size_t i;
+
+    EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    for (i = 0; i < sizeof(indexNames) / sizeof(indexNames[0]); i++)
+    {
+        STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, indexNames[i], IGNORED_PTR_ARG)).CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
+        STRICT_EXPECTED_CALL(mocks, MultiTree_SetValue(TestChildHandle1, IGNORED_PTR_ARG));
+    }
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_MultiTree(json, &multiTree);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, result);
+}
+
+/* Tests_SRS_JSON_DECODER_09_002: [ If json or events is NULL, or any of the callbacks in events is NULL, JSONDecoder_JSON_To_Events shall return JSON_DECODER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONDecoder_JSON_To_Events_With_NULL_json_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Events(NULL, &testEvents, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, result);
+}
+
+/* Tests_SRS_JSON_DECODER_09_002: [ If json or events is NULL, or any of the callbacks in events is NULL, JSONDecoder_JSON_To_Events shall return JSON_DECODER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONDecoder_JSON_To_Events_With_NULL_events_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Events("{}", NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, result);
+}
+
+/* Tests_SRS_JSON_DECODER_09_002: [ If json or events is NULL, or any of the callbacks in events is NULL, JSONDecoder_JSON_To_Events shall return JSON_DECODER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONDecoder_JSON_To_Events_With_A_NULL_callback_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    JSON_DECODER_EVENTS events = testEvents;
+    events.onEndArray = NULL;
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Events("{}", &events, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, result);
+}
+
+/* Tests_SRS_JSON_DECODER_09_003: [ JSONDecoder_JSON_To_Events shall parse json in one pass without writing into it and without allocating memory. ]*/
+/* Tests_SRS_JSON_DECODER_09_004: [ For every object and array JSONDecoder_JSON_To_Events shall call onBeginObject/onBeginArray with the name of the object or array and onEndObject/onEndArray after its last member or element. ]*/
+/* Tests_SRS_JSON_DECODER_09_005: [ For every string, number and literal name JSONDecoder_JSON_To_Events shall call onValue with the name of the value and with the text of the value as it appears in json, including the quotes of strings. ]*/
+/* Tests_SRS_JSON_DECODER_09_009: [ Otherwise JSONDecoder_JSON_To_Events shall return JSON_DECODER_OK. ]*/
+TEST_FUNCTION(JSONDecoder_JSON_To_Events_Reports_Objects_Arrays_And_Values)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    static const char json[] = " { \"desired\" : { \"a\" : 1.5e3, \"b\" : \"x\\\"y\", \"c\" : [ true, null, { } ] }, \"$version\" : 4 } ";
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Events(json, &testEvents, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, "{desired={a=1.5e3;b=\"x\\\"y\";c=[true;null;{}]}$version=4;}", eventsTrace.c_str());
+}
+
+/* Tests_SRS_JSON_DECODER_09_006: [ Names shall be passed as the characters between the quotes, not unescaped and not '\0' terminated, together with their length. ]*/
+TEST_FUNCTION(JSONDecoder_JSON_To_Events_Passes_Names_Without_Unescaping_Them)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    static const char json[] = "{\"a\\/b\":0}";
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Events(json, &testEvents, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, "{a\\/b=0;}", eventsTrace.c_str());
+}
+
+/* Tests_SRS_JSON_DECODER_09_007: [ If any callback returns a non-zero value then JSONDecoder_JSON_To_Events shall stop parsing and return JSON_DECODER_ERROR. ]*/
+TEST_FUNCTION(JSONDecoder_JSON_To_Events_Stops_When_A_Callback_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    static const char json[] = "{\"a\":1,\"b\":[2,3],\"c\":{}}";
+    static const char* const traces[] = { "{", "{a=1;", "{a=1;b=[", "{a=1;b=[2;", "{a=1;b=[2;3;", "{a=1;b=[2;3;]", "{a=1;b=[2;3;]c={", "{a=1;b=[2;3;]c={}", "{a=1;b=[2;3;]c={}}" };
+    size_t i;
+
+    for (i = 0; i < sizeof(traces) / sizeof(traces[0]); i++)
+    {
+        eventsTrace.clear();
+        eventsCount = 0;
+        eventsToFail = i + 1;
+
+        ///act
+        JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Events(json, &testEvents, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, traces[i], eventsTrace.c_str());
+    }
+}
+
+/* Tests_SRS_JSON_DECODER_09_008: [ If json is malformed, JSONDecoder_JSON_To_Events shall return JSON_DECODER_PARSE_ERROR; the callbacks made until the error was found are not undone. ]*/
+TEST_FUNCTION(JSONDecoder_JSON_To_Events_With_Malformed_JSON_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    static const char* const malformedJSONs[] = { "", " ", "1", "{", "{\"a\"}", "{\"a\":}", "{\"a\":1", "[1,]", "{\"a\":1\"b\":2}", "{\"a\":tru}", "{\"a\":\"x}", "{} {}" };
+    size_t i;
+
+    for (i = 0; i < sizeof(malformedJSONs) / sizeof(malformedJSONs[0]); i++)
+    {
+        ///act
+        JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Events(malformedJSONs[i], &testEvents, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_PARSE_ERROR, result);
+    }
+}
+
 END_TEST_SUITE(JSONDecoder_ut)
@@ -9,6 +9,7 @@
 #include "micromock.h"
 #include "micromockcharstararenullterminatedstrings.h"
 #include <stdexcept>
+#include <string>
 #include "multitree.h"
 
 /*this is what we test*/
@@ -474,6 +475,19 @@ public:
     MOCK_METHOD_END(MULTITREE_RESULT, MULTITREE_OK)
 
 
+    MOCK_STATIC_METHOD_2(, MULTITREE_RESULT, MultiTree_GetNamePtr, MULTITREE_HANDLE, treeHandle, const char**, destination)
+    {
+        *destination =
+            (treeHandle == TEST_MULTITREE_HANDLE_CHILD_1) ? "child1" :
+            (treeHandle == TEST_MULTITREE_HANDLE_CHILD_2) ? "child2" :
+            (treeHandle == TEST_MULTITREE_HANDLE_CHILD_3) ? "child3" :
+            (treeHandle == TEST_MULTITREE_HANDLE_5) ? "subtree" :
+            (treeHandle == TEST_MULTITREE_HANDLE_CHILD_4) ? "child4" :
+            (treeHandle == TEST_MULTITREE_HANDLE_CHILD_5) ? "child5" :
+            throw std::runtime_error("unprepared treeHandle");
+    }
+    MOCK_METHOD_END(MULTITREE_RESULT, MULTITREE_OK)
+
     MOCK_STATIC_METHOD_2(, MULTITREE_RESULT, MultiTree_GetValue, MULTITREE_HANDLE, treeHandle, const void**, destination)
     {
         if (treeHandle == TEST_MULTITREE_HANDLE_CHILD_1)
@@ -562,6 +576,12 @@ public:
 
     MOCK_STATIC_METHOD_1(, const char*, STRING_c_str, STRING_HANDLE, s)
     MOCK_METHOD_END(const char*, BASEIMPLEMENTATION::STRING_c_str(s))
+
+    MOCK_STATIC_METHOD_1(, size_t, STRING_length, STRING_HANDLE, s)
+    MOCK_METHOD_END(size_t, BASEIMPLEMENTATION::STRING_length(s))
+
+    MOCK_STATIC_METHOD_1(, int, STRING_empty, STRING_HANDLE, s)
+    MOCK_METHOD_END(int, BASEIMPLEMENTATION::STRING_empty(s))
 };
 
 DECLARE_GLOBAL_MOCK_METHOD_2(CJSONMocks, , MULTITREE_HANDLE, MultiTree_Create, MULTITREE_CLONE_FUNCTION, cloneFunction, MULTITREE_FREE_FUNCTION, freeFunction);
@@ -570,6 +590,7 @@ DECLARE_GLOBAL_MOCK_METHOD_1(CJSONMocks, , void, MultiTree_Destroy, MULTITREE_HA
 DECLARE_GLOBAL_MOCK_METHOD_2(CJSONMocks, , MULTITREE_RESULT, MultiTree_GetChildCount, MULTITREE_HANDLE, treeHandle, size_t*, count);
 DECLARE_GLOBAL_MOCK_METHOD_3(CJSONMocks, , MULTITREE_RESULT, MultiTree_GetChild, MULTITREE_HANDLE, treeHandle, size_t, index, MULTITREE_HANDLE*, childHandle);
 DECLARE_GLOBAL_MOCK_METHOD_2(CJSONMocks, , MULTITREE_RESULT, MultiTree_GetName, MULTITREE_HANDLE, treeHandle, STRING_HANDLE, destination);
+DECLARE_GLOBAL_MOCK_METHOD_2(CJSONMocks, , MULTITREE_RESULT, MultiTree_GetNamePtr, MULTITREE_HANDLE, treeHandle, const char**, destination);
 DECLARE_GLOBAL_MOCK_METHOD_2(CJSONMocks, , MULTITREE_RESULT, MultiTree_GetValue, MULTITREE_HANDLE, treeHandle, const void**, destination);
 DECLARE_GLOBAL_MOCK_METHOD_2(CJSONMocks, , JSON_ENCODER_TOSTRING_RESULT, TestFunc_NodesAreStrings, STRING_HANDLE, destination, const void *, value);
 DECLARE_GLOBAL_MOCK_METHOD_0(CJSONMocks, , STRING_HANDLE, STRING_new);
@@ -577,6 +598,8 @@ DECLARE_GLOBAL_MOCK_METHOD_1(CJSONMocks, , void, STRING_delete, STRING_HANDLE, s
 DECLARE_GLOBAL_MOCK_METHOD_2(CJSONMocks, , int, STRING_concat, STRING_HANDLE, s1, const char*, s2);
 DECLARE_GLOBAL_MOCK_METHOD_2(CJSONMocks, , int, STRING_concat_with_STRING, STRING_HANDLE, s1, STRING_HANDLE, s2);
 DECLARE_GLOBAL_MOCK_METHOD_1(CJSONMocks, , const char*, STRING_c_str, STRING_HANDLE, s);
+DECLARE_GLOBAL_MOCK_METHOD_1(CJSONMocks, , size_t, STRING_length, STRING_HANDLE, s);
+DECLARE_GLOBAL_MOCK_METHOD_1(CJSONMocks, , int, STRING_empty, STRING_HANDLE, s);
 
 /*all (applicable) tests in this file also test this: Tests_SRS_JSON_ENCODER_99_022:[ There is no hierarchy defined in the string. All strings are considered to be "root" level.]
  because they test that the objects created are of type "NUMBER" of "STRING" and not JSON_DATATYPE_OBJECT for example*/
@@ -595,6 +618,19 @@ static void NoFreeFunction(void* value)
     (void)value;
 }
 
+static std::string releaseWriterAsString(JSON_WRITER_HANDLE writer)
+{
+    unsigned char* buffer;
+    size_t bufferSize;
+    std::string result;
+    if (JSONWriter_Release(writer, &buffer, &bufferSize) == JSON_WRITER_OK)
+    {
+        result.assign((const char*)buffer, bufferSize);
+        free(buffer);
+    }
+    return result;
+}
+
 static STRING_HANDLE global_bufferTemp=NULL;
 
 static CJSONMocks* mocks;
@@ -6428,4 +6464,215 @@ BEGIN_TEST_SUITE(JSONEncoder_ut)
             ASSERT_ARE_EQUAL(tchar_ptr, _T(""), mocks->CompareActualAndExpectedCalls().c_str());
         }
 
+        /* JSONEncoder_EncodeTreeToWriter */
+
+        /*Tests_SRS_JSON_ENCODER_09_001: [ If any of the arguments passed to JSONEncoder_EncodeTreeToWriter is NULL then JSON_ENCODER_INVALID_ARG shall be returned. ]*/
+        TEST_FUNCTION(JSONEncoder_EncodeTreeToWriter_with_NULL_treeHandle_fails)
+        {
+            ///arrange
+            JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+
+            ///act
+            auto result = JSONEncoder_EncodeTreeToWriter(NULL, writer, TestFunc_NodesAreStrings);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+            ASSERT_ARE_EQUAL(tchar_ptr, _T(""), mocks->CompareActualAndExpectedCalls().c_str());
+
+            ///cleanup
+            JSONWriter_Destroy(writer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_001: [ If any of the arguments passed to JSONEncoder_EncodeTreeToWriter is NULL then JSON_ENCODER_INVALID_ARG shall be returned. ]*/
+        TEST_FUNCTION(JSONEncoder_EncodeTreeToWriter_with_NULL_writer_fails)
+        {
+            ///arrange
+
+            ///act
+            auto result = JSONEncoder_EncodeTreeToWriter(TEST_MULTITREE_HANDLE_2, NULL, TestFunc_NodesAreStrings);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+            ASSERT_ARE_EQUAL(tchar_ptr, _T(""), mocks->CompareActualAndExpectedCalls().c_str());
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_001: [ If any of the arguments passed to JSONEncoder_EncodeTreeToWriter is NULL then JSON_ENCODER_INVALID_ARG shall be returned. ]*/
+        TEST_FUNCTION(JSONEncoder_EncodeTreeToWriter_with_NULL_toStringFunc_fails)
+        {
+            ///arrange
+            JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+
+            ///act
+            auto result = JSONEncoder_EncodeTreeToWriter(TEST_MULTITREE_HANDLE_2, writer, NULL);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+            ASSERT_ARE_EQUAL(tchar_ptr, _T(""), mocks->CompareActualAndExpectedCalls().c_str());
+
+            ///cleanup
+            JSONWriter_Destroy(writer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_002: [ On success, JSONEncoder_EncodeTreeToWriter shall have appended the JSON object for the tree to writer and return JSON_ENCODER_OK. ]*/
+        /*Tests_SRS_JSON_ENCODER_09_004: [ JSONEncoder_EncodeTreeToWriter shall create a single STRING that is used for formatting all the values of the tree. ]*/
+        /*Tests_SRS_JSON_ENCODER_09_005: [ For every node JSONEncoder_EncodeTreeToWriter shall call JSONWriter_BeginObject, then JSONWriter_AppendName with the name of every child as returned by MultiTree_GetNamePtr, followed by the child's value, then JSONWriter_EndObject. ]*/
+        /*Tests_SRS_JSON_ENCODER_09_007: [ For a child with zero children the STRING shared by all the children shall be emptied with STRING_empty, toStringFunc shall be called with that STRING and the value of the child, and the content of the STRING shall be written with JSONWriter_AppendRaw. ]*/
+        TEST_FUNCTION(JSONEncoder_EncodeTreeToWriter_2_success)
+        {
+            ///arrange
+            JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+
+            EXPECTED_CALL((*mocks), STRING_new());
+            EXPECTED_CALL((*mocks), STRING_delete(IGNORED_PTR_ARG));
+            EXPECTED_CALL((*mocks), STRING_empty(IGNORED_PTR_ARG));
+            EXPECTED_CALL((*mocks), STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+            EXPECTED_CALL((*mocks), STRING_length(IGNORED_PTR_ARG));
+            EXPECTED_CALL((*mocks), STRING_c_str(IGNORED_PTR_ARG));
+
+            STRICT_EXPECTED_CALL((*mocks), MultiTree_GetChildCount(TEST_MULTITREE_HANDLE_2, IGNORED_PTR_ARG))
+                .IgnoreArgument(2);
+            STRICT_EXPECTED_CALL((*mocks), MultiTree_GetChild(TEST_MULTITREE_HANDLE_2, 0, IGNORED_PTR_ARG))
+                .IgnoreArgument(3);
+            STRICT_EXPECTED_CALL((*mocks), MultiTree_GetNamePtr(TEST_MULTITREE_HANDLE_CHILD_1, IGNORED_PTR_ARG))
+                .IgnoreArgument(2);
+            STRICT_EXPECTED_CALL((*mocks), MultiTree_GetChildCount(TEST_MULTITREE_HANDLE_CHILD_1, IGNORED_PTR_ARG))
+                .IgnoreArgument(2);
+            STRICT_EXPECTED_CALL((*mocks), MultiTree_GetValue(TEST_MULTITREE_HANDLE_CHILD_1, IGNORED_PTR_ARG))
+                .IgnoreArgument(2);
+            STRICT_EXPECTED_CALL((*mocks), TestFunc_NodesAreStrings(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .IgnoreAllArguments();
+
+            ///act
+            auto result = JSONEncoder_EncodeTreeToWriter(TEST_MULTITREE_HANDLE_2, writer, TestFunc_NodesAreStrings);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_OK, result);
+            ASSERT_ARE_EQUAL(tchar_ptr, _T(""), mocks->CompareActualAndExpectedCalls().c_str());
+            ASSERT_ARE_EQUAL(char_ptr, "{\"child1\":\"value1\"}", releaseWriterAsString(writer).c_str());
+
+            ///cleanup
+            JSONWriter_Destroy(writer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_004: [ JSONEncoder_EncodeTreeToWriter shall create a single STRING that is used for formatting all the values of the tree. ]*/
+        /*Tests_SRS_JSON_ENCODER_09_006: [ A child that has children shall be written as a nested object into the same writer. ]*/
+        TEST_FUNCTION(JSONEncoder_EncodeTreeToWriter_5_4_2_produces_the_same_JSON_as_EncodeTree)
+        {
+            ///arrange
+            JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+            (void)JSONEncoder_EncodeTree(TEST_MULTITREE_HANDLE_5_4_2, global_bufferTemp, TestFunc_NodesAreStrings);
+            std::string expected = BASEIMPLEMENTATION::STRING_c_str(global_bufferTemp);
+            nSTRING_new_calls = 0;
+            nSTRING_delete_calls = 0;
+
+            ///act
+            auto result = JSONEncoder_EncodeTreeToWriter(TEST_MULTITREE_HANDLE_5_4_2, writer, TestFunc_NodesAreStrings);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_OK, result);
+            ASSERT_ARE_EQUAL(size_t, 1, nSTRING_new_calls);
+            ASSERT_ARE_EQUAL(char_ptr, "{\"child1\":\"value1\", \"subtree\":{\"child4\":\"value4\", \"child5\":\"value5\"}, \"child2\":\"value2\", \"child3\":\"value3\"}", expected.c_str());
+            ASSERT_ARE_EQUAL(char_ptr, expected.c_str(), releaseWriterAsString(writer).c_str());
+
+            ///cleanup
+            JSONWriter_Destroy(writer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_003: [ If any MultiTree function call fails JSONEncoder_EncodeTreeToWriter shall return JSON_ENCODER_MULTITREE_ERROR. ]*/
+        TEST_FUNCTION(JSONEncoder_EncodeTreeToWriter_when_MultiTree_GetNamePtr_fails_fails)
+        {
+            ///arrange
+            JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+
+            STRICT_EXPECTED_CALL((*mocks), MultiTree_GetNamePtr(TEST_MULTITREE_HANDLE_CHILD_1, IGNORED_PTR_ARG))
+                .IgnoreArgument(2)
+                .SetReturn(MULTITREE_ERROR);
+
+            ///act
+            auto result = JSONEncoder_EncodeTreeToWriter(TEST_MULTITREE_HANDLE_2, writer, TestFunc_NodesAreStrings);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_MULTITREE_ERROR, result);
+
+            ///cleanup
+            JSONWriter_Destroy(writer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_003: [ If any MultiTree function call fails JSONEncoder_EncodeTreeToWriter shall return JSON_ENCODER_MULTITREE_ERROR. ]*/
+        TEST_FUNCTION(JSONEncoder_EncodeTreeToWriter_when_MultiTree_GetValue_fails_in_a_subtree_fails)
+        {
+            ///arrange
+            JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+
+            STRICT_EXPECTED_CALL((*mocks), MultiTree_GetValue(TEST_MULTITREE_HANDLE_CHILD_5, IGNORED_PTR_ARG))
+                .IgnoreArgument(2)
+                .SetReturn(MULTITREE_ERROR);
+
+            ///act
+            auto result = JSONEncoder_EncodeTreeToWriter(TEST_MULTITREE_HANDLE_5_4_2, writer, TestFunc_NodesAreStrings);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_MULTITREE_ERROR, result);
+
+            ///cleanup
+            JSONWriter_Destroy(writer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_008: [ If toStringFunc fails JSONEncoder_EncodeTreeToWriter shall return JSON_ENCODER_TOSTRING_FUNCTION_ERROR. ]*/
+        TEST_FUNCTION(JSONEncoder_EncodeTreeToWriter_when_toStringFunc_fails_fails)
+        {
+            ///arrange
+            JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+
+            STRICT_EXPECTED_CALL((*mocks), TestFunc_NodesAreStrings(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .IgnoreAllArguments()
+                .SetReturn(JSON_ENCODER_TOSTRING_ERROR);
+
+            ///act
+            auto result = JSONEncoder_EncodeTreeToWriter(TEST_MULTITREE_HANDLE_2, writer, TestFunc_NodesAreStrings);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_TOSTRING_FUNCTION_ERROR, result);
+
+            ///cleanup
+            JSONWriter_Destroy(writer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_009: [ If any JSONWriter or STRING function call fails JSONEncoder_EncodeTreeToWriter shall return JSON_ENCODER_ERROR. ]*/
+        TEST_FUNCTION(JSONEncoder_EncodeTreeToWriter_when_STRING_empty_fails_fails)
+        {
+            ///arrange
+            JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+
+            STRICT_EXPECTED_CALL((*mocks), STRING_empty(IGNORED_PTR_ARG))
+                .IgnoreArgument(1)
+                .SetReturn(1);
+
+            ///act
+            auto result = JSONEncoder_EncodeTreeToWriter(TEST_MULTITREE_HANDLE_2, writer, TestFunc_NodesAreStrings);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_ERROR, result);
+
+            ///cleanup
+            JSONWriter_Destroy(writer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_009: [ If any JSONWriter or STRING function call fails JSONEncoder_EncodeTreeToWriter shall return JSON_ENCODER_ERROR. ]*/
+        TEST_FUNCTION(JSONEncoder_EncodeTreeToWriter_when_STRING_new_fails_fails)
+        {
+            ///arrange
+            JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+            whenShallSTRING_new_fail = 1;
+
+            ///act
+            auto result = JSONEncoder_EncodeTreeToWriter(TEST_MULTITREE_HANDLE_2, writer, TestFunc_NodesAreStrings);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_ERROR, result);
+
+            ///cleanup
+            JSONWriter_Destroy(writer);
+        }
+
 END_TEST_SUITE(JSONEncoder_ut)
@@ -0,0 +1,471 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#undef ENABLE_MOCKS
+
+#include "jsonwriter.h"
+
+TEST_DEFINE_ENUM_TYPE(JSON_WRITER_RESULT, JSON_WRITER_RESULT_VALUES);
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+/*releases the content of the writer and compares it with expected, the content is not '\0' terminated*/
+static void assert_writer_content(JSON_WRITER_HANDLE writer, const char* expected)
+{
+    unsigned char* destination;
+    size_t destinationSize;
+    char* asString;
+
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_Release(writer, &destination, &destinationSize));
+    asString = (char*)my_gballoc_malloc(destinationSize + 1);
+    ASSERT_IS_NOT_NULL(asString);
+    (void)memcpy(asString, destination, destinationSize);
+    asString[destinationSize] = '\0';
+
+    ASSERT_ARE_EQUAL(char_ptr, expected, asString);
+
+    my_gballoc_free(asString);
+    my_gballoc_free(destination);
+}
+
+BEGIN_TEST_SUITE(jsonwriter_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+    (void)umocktypes_charptr_register_types();
+    (void)umocktypes_stdint_register_types();
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/*Tests_SRS_JSONWRITER_09_001: [ JSONWriter_Create shall allocate a writer with a buffer of initialCapacity bytes (a default capacity when initialCapacity is 0) and return a non-NULL handle. ]*/
+TEST_FUNCTION(JSONWriter_Create_succeeds)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(100));
+
+    ///act
+    writer = JSONWriter_Create(100);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(writer);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    JSONWriter_Destroy(writer);
+}
+
+/*Tests_SRS_JSONWRITER_09_002: [ If any failure occurs, JSONWriter_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(JSONWriter_Create_fails_when_malloc_fails)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    ///act
+    writer = JSONWriter_Create(0);
+
+    ///assert
+    ASSERT_IS_NULL(writer);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_JSONWRITER_09_002: [ If any failure occurs, JSONWriter_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(JSONWriter_Create_fails_when_malloc_of_the_buffer_fails)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    ///act
+    writer = JSONWriter_Create(0);
+
+    ///assert
+    ASSERT_IS_NULL(writer);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_JSONWRITER_09_003: [ If handle is NULL, JSONWriter_Destroy shall return. ]*/
+TEST_FUNCTION(JSONWriter_Destroy_with_NULL_handle_returns)
+{
+    ///act
+    JSONWriter_Destroy(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_JSONWRITER_09_004: [ JSONWriter_Destroy shall free the buffer and the writer. ]*/
+TEST_FUNCTION(JSONWriter_Destroy_frees_the_buffer_and_the_writer)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(writer));
+
+    ///act
+    JSONWriter_Destroy(writer);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_JSONWRITER_09_006: [ If handle is NULL, all the JSONWriter_Append and JSONWriter_BeginObject/EndObject functions shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONWriter_functions_with_NULL_handle_fail)
+{
+    ///act + assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_BeginObject(NULL));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_EndObject(NULL));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_AppendName(NULL, "a"));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_AppendRaw(NULL, "a", 1));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_AppendString(NULL, "a"));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_AppendInt64(NULL, 1));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_AppendBool(NULL, true));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_AppendDouble(NULL, 1.0));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_AppendFloat(NULL, 1.0f));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_JSONWRITER_09_010: [ If name is NULL, JSONWriter_AppendName shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+/*Tests_SRS_JSONWRITER_09_012: [ If value is NULL, JSONWriter_AppendRaw shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+/*Tests_SRS_JSONWRITER_09_014: [ If value is NULL, JSONWriter_AppendString shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONWriter_functions_with_NULL_text_fail)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+    umock_c_reset_all_calls();
+
+    ///act + assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_AppendName(writer, NULL));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_AppendRaw(writer, NULL, 1));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_AppendString(writer, NULL));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    JSONWriter_Destroy(writer);
+}
+
+/*Tests_SRS_JSONWRITER_09_007: [ JSONWriter_BeginObject shall append "{" and the next name appended shall not be preceded by a separator. ]*/
+/*Tests_SRS_JSONWRITER_09_009: [ JSONWriter_EndObject shall append "}"; the object just closed counts as a value of the enclosing object. ]*/
+/*Tests_SRS_JSONWRITER_09_011: [ JSONWriter_AppendName shall append ", " if a member was already written in the current object, followed by "\"", name and "\":". ]*/
+/*Tests_SRS_JSONWRITER_09_017: [ JSONWriter_AppendInt64 shall append the decimal representation of value, preceded by '-' for negative values. ]*/
+/*Tests_SRS_JSONWRITER_09_018: [ JSONWriter_AppendBool shall append true or false. ]*/
+TEST_FUNCTION(JSONWriter_writes_nested_objects_like_JSONEncoder)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+    umock_c_reset_all_calls();
+
+    ///act
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_BeginObject(writer));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendName(writer, "a"));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendInt64(writer, 42));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendName(writer, "b"));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_BeginObject(writer));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendName(writer, "c"));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendBool(writer, true));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendName(writer, "d"));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendBool(writer, false));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_EndObject(writer));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendName(writer, "e"));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendInt64(writer, -7));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_EndObject(writer));
+
+    ///assert
+    assert_writer_content(writer, "{\"a\":42, \"b\":{\"c\":true, \"d\":false}, \"e\":-7}");
+
+    ///cleanup
+    JSONWriter_Destroy(writer);
+}
+
+/*Tests_SRS_JSONWRITER_09_017: [ JSONWriter_AppendInt64 shall append the decimal representation of value, preceded by '-' for negative values. ]*/
+TEST_FUNCTION(JSONWriter_AppendInt64_writes_the_int64_limits)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+    umock_c_reset_all_calls();
+
+    ///act
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendInt64(writer, INT64_MIN));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendRaw(writer, " ", 1));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendInt64(writer, INT64_MAX));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendRaw(writer, " ", 1));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendInt64(writer, 0));
+
+    ///assert
+    assert_writer_content(writer, "-9223372036854775808 9223372036854775807 0");
+
+    ///cleanup
+    JSONWriter_Destroy(writer);
+}
+
+/*Tests_SRS_JSONWRITER_09_016: [ JSONWriter_AppendString shall append value between quotes, escaping '"', '\\' and '/' with a backslash and control characters as \u00XX, exactly like AgentDataTypes_ToString does for EDM_STRING. ]*/
+TEST_FUNCTION(JSONWriter_AppendString_escapes_like_AgentDataTypes_ToString)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+    umock_c_reset_all_calls();
+
+    ///act
+    JSON_WRITER_RESULT result = JSONWriter_AppendString(writer, "a\"b\\c/d\x01\n");
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, result);
+    assert_writer_content(writer, "\"a\\\"b\\\\c\\/d\\u0001\\u000A\"");
+
+    ///cleanup
+    JSONWriter_Destroy(writer);
+}
+
+/*Tests_SRS_JSONWRITER_09_015: [ If value contains characters above 127, JSONWriter_AppendString shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONWriter_AppendString_with_non_ASCII_characters_fails)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+    umock_c_reset_all_calls();
+
+    ///act
+    JSON_WRITER_RESULT result = JSONWriter_AppendString(writer, "a\xC3\xA9");
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    JSONWriter_Destroy(writer);
+}
+
+/*Tests_SRS_JSONWRITER_09_019: [ JSONWriter_AppendDouble shall append value formatted by FloatFormat_Double. ]*/
+/*Tests_SRS_JSONWRITER_09_021: [ JSONWriter_AppendFloat shall append value formatted by FloatFormat_Single. ]*/
+TEST_FUNCTION(JSONWriter_AppendDouble_and_AppendFloat_format_like_AgentDataTypes_ToString)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+    umock_c_reset_all_calls();
+
+    ///act
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendDouble(writer, 1.0));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendRaw(writer, " ", 1));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendFloat(writer, -3.5f));
+
+    ///assert
+    assert_writer_content(writer, "1 -3.5");
+
+    ///cleanup
+    JSONWriter_Destroy(writer);
+}
+
+/*Tests_SRS_JSONWRITER_09_020: [ NaN, -INF and INF shall be appended as NaN, -INF and INF, like AgentDataTypes_ToString does. ]*/
+TEST_FUNCTION(JSONWriter_AppendDouble_writes_NaN_and_infinities)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+    umock_c_reset_all_calls();
+
+    ///act
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendDouble(writer, NAN));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendRaw(writer, " ", 1));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendDouble(writer, -INFINITY));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendRaw(writer, " ", 1));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendFloat(writer, INFINITY));
+
+    ///assert
+    assert_writer_content(writer, "NaN -INF INF");
+
+    ///cleanup
+    JSONWriter_Destroy(writer);
+}
+
+/*Tests_SRS_JSONWRITER_09_005: [ When the buffer is too small, it shall grow to at least twice its current capacity so that appending is amortized constant time. ]*/
+TEST_FUNCTION(JSONWriter_grows_the_buffer_by_doubling)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(4);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 8));
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 16));
+
+    ///act
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendRaw(writer, "0123", 4));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendRaw(writer, "4", 1));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_AppendRaw(writer, "5678", 4));
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    assert_writer_content(writer, "012345678");
+
+    ///cleanup
+    JSONWriter_Destroy(writer);
+}
+
+/*Tests_SRS_JSONWRITER_09_008: [ If growing the buffer fails, the appending function shall return JSON_WRITER_ERROR. ]*/
+TEST_FUNCTION(JSONWriter_AppendName_fails_when_realloc_fails)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    ///act
+    JSON_WRITER_RESULT result = JSONWriter_AppendName(writer, "name");
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    JSONWriter_Destroy(writer);
+}
+
+/*Tests_SRS_JSONWRITER_09_022: [ If handle, destination or destinationSize are NULL, JSONWriter_Release shall fail and return JSON_WRITER_INVALID_ARG. ]*/
+TEST_FUNCTION(JSONWriter_Release_with_NULL_arguments_fails)
+{
+    ///arrange
+    unsigned char* destination;
+    size_t destinationSize;
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+    umock_c_reset_all_calls();
+
+    ///act + assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_Release(NULL, &destination, &destinationSize));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_Release(writer, NULL, &destinationSize));
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, JSONWriter_Release(writer, &destination, NULL));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    JSONWriter_Destroy(writer);
+}
+
+/*Tests_SRS_JSONWRITER_09_023: [ If nothing was appended, JSONWriter_Release shall fail and return JSON_WRITER_ERROR. ]*/
+TEST_FUNCTION(JSONWriter_Release_of_an_empty_writer_fails)
+{
+    ///arrange
+    unsigned char* destination;
+    size_t destinationSize;
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+    umock_c_reset_all_calls();
+
+    ///act
+    JSON_WRITER_RESULT result = JSONWriter_Release(writer, &destination, &destinationSize);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_ERROR, result);
+
+    ///cleanup
+    JSONWriter_Destroy(writer);
+}
+
+/*Tests_SRS_JSONWRITER_09_024: [ JSONWriter_Release shall hand the buffer over to the caller in *destination and *destinationSize without copying it; the caller frees it with free. ]*/
+/*Tests_SRS_JSONWRITER_09_025: [ After JSONWriter_Release the writer shall be empty and can be reused. ]*/
+TEST_FUNCTION(JSONWriter_Release_hands_over_the_buffer_and_the_writer_can_be_reused)
+{
+    ///arrange
+    JSON_WRITER_HANDLE writer = JSONWriter_Create(0);
+    (void)JSONWriter_BeginObject(writer);
+    (void)JSONWriter_AppendName(writer, "a");
+    (void)JSONWriter_AppendInt64(writer, 1);
+    (void)JSONWriter_EndObject(writer);
+    umock_c_reset_all_calls();
+
+    ///act
+    assert_writer_content(writer, "{\"a\":1}");
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    (void)JSONWriter_BeginObject(writer);
+    (void)JSONWriter_AppendName(writer, "b");
+    (void)JSONWriter_AppendInt64(writer, 2);
+    (void)JSONWriter_EndObject(writer);
+
+    ///assert
+    assert_writer_content(writer, "{\"b\":2}");
+
+    ///cleanup
+    JSONWriter_Destroy(writer);
+}
+
+END_TEST_SUITE(jsonwriter_ut)
@@ -1386,6 +1386,218 @@ TEST_FUNCTION(MultiTree_GetName_succeeds)
     mocks.ResetAllCalls();
 }
 
+/*Tests_SRS_MULTITREE_09_001: [ If treeHandle or destination is NULL, MultiTree_GetNamePtr shall return MULTITREE_INVALID_ARG. ]*/
+TEST_FUNCTION(MultiTree_GetNamePtr_with_NULL_handle_fails)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    const char* name;
+
+    ///act
+    auto res = MultiTree_GetNamePtr(NULL, &name);
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_INVALID_ARG, res);
+}
+
+/*Tests_SRS_MULTITREE_09_001: [ If treeHandle or destination is NULL, MultiTree_GetNamePtr shall return MULTITREE_INVALID_ARG. ]*/
+TEST_FUNCTION(MultiTree_GetNamePtr_with_NULL_destination_fails)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    (void)MultiTree_AddLeaf(treeHandle, "child1", (void*)"value1");
+    MULTITREE_HANDLE childHandle;
+    (void)MultiTree_GetChild(treeHandle, 0, &childHandle);
+
+    ///act
+    auto res = MultiTree_GetNamePtr(childHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_INVALID_ARG, res);
+
+    ///cleanup
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/*Tests_SRS_MULTITREE_09_002: [ MultiTree_GetNamePtr shall return MULTITREE_EMPTY_CHILD_NAME when used with the root of the tree. ]*/
+TEST_FUNCTION(MultiTree_GetNamePtr_for_root_returns_EMPTY_NAME)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    const char* name;
+
+    ///act
+    auto res = MultiTree_GetNamePtr(treeHandle, &name);
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_EMPTY_CHILD_NAME, res);
+
+    ///cleanup
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/*Tests_SRS_MULTITREE_09_003: [ Otherwise MultiTree_GetNamePtr shall set *destination to the name stored in the node, without copying it, and return MULTITREE_OK. ]*/
+TEST_FUNCTION(MultiTree_GetNamePtr_succeeds)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    (void)MultiTree_AddLeaf(treeHandle, "child1", (void*)"value1");
+    MULTITREE_HANDLE childHandle;
+    (void)MultiTree_GetChild(treeHandle, 0, &childHandle);
+    const char* name = NULL;
+    mocks.ResetAllCalls();
+
+    ///act
+    auto res = MultiTree_GetNamePtr(childHandle, &name);
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, res);
+    ASSERT_ARE_EQUAL(char_ptr, "child1", name);
+
+    ///cleanup
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/*Tests_SRS_MULTITREE_09_004: [ Once a node has CHILD_INDEX_THRESHOLD (8) or more children, its children shall be found by name through an open addressing hash index instead of scanning all of them. ]*/
+/*Tests_SRS_MULTITREE_09_006: [ Children shall be kept in the order in which they were added, which is the order used by MultiTree_GetChild. ]*/
+TEST_FUNCTION(MultiTree_AddLeaf_with_many_children_finds_every_child_and_keeps_insertion_order)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    MULTITREE_HANDLE parentHandle;
+    char path[32];
+    char name[32];
+    size_t i;
+
+    ///act
+    for (i = 0; i < 200; i++)
+    {
+        (void)sprintf(path, "parent/child%u", (unsigned int)i);
+        ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_AddLeaf(treeHandle, path, (void*)CHILD1VALUE));
+    }
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_ALREADY_HAS_A_VALUE, MultiTree_AddLeaf(treeHandle, "parent/child150", (void*)CHILD1VALUE));
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetChildByName(treeHandle, "parent", &parentHandle));
+    for (i = 0; i < 200; i++)
+    {
+        MULTITREE_HANDLE childHandle;
+        MULTITREE_HANDLE childByNameHandle;
+        const char* childName;
+        const void* value;
+        (void)sprintf(name, "child%u", (unsigned int)i);
+        (void)sprintf(path, "/parent/child%u", (unsigned int)i);
+
+        ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetChild(parentHandle, i, &childHandle));
+        ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetNamePtr(childHandle, &childName));
+        ASSERT_ARE_EQUAL(char_ptr, name, childName);
+        ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetChildByName(parentHandle, name, &childByNameHandle));
+        ASSERT_ARE_EQUAL(void_ptr, (void*)childHandle, (void*)childByNameHandle);
+        ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetLeafValue(treeHandle, path, &value));
+        ASSERT_ARE_EQUAL(char_ptr, CHILD1VALUE, (const char*)value);
+    }
+
+    ///cleanup
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/*Tests_SRS_MULTITREE_09_005: [ If the index cannot be allocated, children shall be found by scanning them and adding the child shall still succeed. ]*/
+TEST_FUNCTION(MultiTree_AddLeaf_when_allocating_the_child_index_fails_still_succeeds)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    char name[32];
+    size_t i;
+    for (i = 0; i < 7; i++)
+    {
+        (void)sprintf(name, "child%u", (unsigned int)i);
+        (void)MultiTree_AddLeaf(treeHandle, name, (void*)CHILD1VALUE);
+    }
+    /*the 8th child allocates the node, its name and its value, then the index*/
+    currentmalloc_call = 0;
+    whenShallmalloc_fail = 4;
+
+    ///act
+    auto res = MultiTree_AddLeaf(treeHandle, "child7", (void*)CHILD1VALUE);
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, res);
+    for (i = 0; i < 8; i++)
+    {
+        MULTITREE_HANDLE childHandle;
+        (void)sprintf(name, "child%u", (unsigned int)i);
+        ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetChildByName(treeHandle, name, &childHandle));
+    }
+
+    ///cleanup
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/*Tests_SRS_MULTITREE_09_008: [ MultiTree_DeleteChild shall keep the hash index consistent with the remaining children, dropping it when fewer than CHILD_INDEX_THRESHOLD children are left. ]*/
+TEST_FUNCTION(MultiTree_DeleteChild_with_many_children_keeps_finding_the_remaining_children)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    char name[32];
+    size_t i;
+    for (i = 0; i < 20; i++)
+    {
+        (void)sprintf(name, "child%u", (unsigned int)i);
+        (void)MultiTree_AddLeaf(treeHandle, name, (void*)CHILD1VALUE);
+    }
+
+    ///act
+    for (i = 0; i < 20; i += 2)
+    {
+        (void)sprintf(name, "child%u", (unsigned int)i);
+        ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_DeleteChild(treeHandle, name));
+    }
+
+    ///assert
+    for (i = 0; i < 20; i++)
+    {
+        MULTITREE_HANDLE childHandle;
+        (void)sprintf(name, "child%u", (unsigned int)i);
+        ASSERT_ARE_EQUAL(MULTITREE_RESULT, (i % 2 == 0) ? MULTITREE_CHILD_NOT_FOUND : MULTITREE_OK, MultiTree_GetChildByName(treeHandle, name, &childHandle));
+    }
+
+    ///cleanup
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/*Tests_SRS_MULTITREE_09_007: [ Each name in leafPath shall match a child name exactly, not just be a prefix of it. ]*/
+TEST_FUNCTION(MultiTree_GetLeafValue_with_a_prefix_of_a_child_name_fails)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    (void)MultiTree_AddLeaf(treeHandle, CHILD11PATH, (void*)CHILD11VALUE);
+    const void* value;
+    mocks.ResetAllCalls();
+
+    ///act
+    auto res = MultiTree_GetLeafValue(treeHandle, "/child1/child1", &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_CHILD_NOT_FOUND, res);
+
+    ///cleanup
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
 /*Tests_SRS_MULTITREE_99_042:[ If treeHandle is NULL, the function shall return MULTITREE_INVALID_ARG.]*/
 TEST_FUNCTION(MultiTree_GetValue_with_NULL_handle_fails)
 {
@@ -499,6 +499,9 @@ BEGIN_TEST_SUITE(Schema_ut)
 
         STRICT_EXPECTED_CALL(VECTOR_create(IGNORED_NUM_ARG)) /*these are methods*/
             .IgnoreArgument_elementSize();
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is the symbol table*/
+            .IgnoreArgument_size();
     }
 
     /* Tests_SRS_SCHEMA_99_007:[Schema_CreateModelType shall create a new model type and return a handle to it.] */
@@ -1389,6 +1392,78 @@ BEGIN_TEST_SUITE(Schema_ut)
         Schema_Destroy(schemaHandle);
     }
 
+    /* Tests_SRS_SCHEMA_09_001: [ Every element added to a model or to a schema shall be indexed by name in a hash table of the model or of the schema. ]*/
+    /* Tests_SRS_SCHEMA_09_003: [ The functions that find an element by name shall look it up in the hash table of the model or of the schema instead of comparing name with the name of every element. ]*/
+    TEST_FUNCTION(Schema_GetModelPropertyByName_With_Many_Properties_Finds_Every_Property)
+    {
+        // arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE modelType = Schema_CreateModelType(schemaHandle, "Model");
+        char propertyName[32];
+        size_t i;
+        for (i = 0; i < 100; i++)
+        {
+            (void)sprintf(propertyName, "Property%lu", (unsigned long)i);
+            ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, Schema_AddModelProperty(modelType, propertyName, "SomeType"));
+            (void)sprintf(propertyName, "Action%lu", (unsigned long)i);
+            ASSERT_IS_NOT_NULL(Schema_CreateModelAction(modelType, propertyName));
+        }
+        umock_c_reset_all_calls();
+
+        // act
+        for (i = 0; i < 100; i++)
+        {
+            SCHEMA_PROPERTY_HANDLE result;
+            (void)sprintf(propertyName, "Property%lu", (unsigned long)i);
+            result = Schema_GetModelPropertyByName(modelType, propertyName);
+
+            // assert
+            ASSERT_IS_NOT_NULL(result);
+            ASSERT_ARE_EQUAL(char_ptr, propertyName, Schema_GetPropertyName(result));
+            ASSERT_ARE_EQUAL(void_ptr, result, Schema_GetModelPropertyByIndex(modelType, i));
+        }
+        ASSERT_IS_NULL(Schema_GetModelPropertyByName(modelType, "Action0"));
+        ASSERT_IS_NULL(Schema_GetModelPropertyByName(modelType, "Property100"));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        Schema_Destroy(schemaHandle);
+    }
+
+    /* Tests_SRS_SCHEMA_99_014:[On any other error, Schema_AddModelProperty shall return SCHEMA_ERROR.] */
+    TEST_FUNCTION(Schema_AddModelProperty_When_Growing_The_Symbol_Table_Fails_Fails)
+    {
+        // arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE modelType = Schema_CreateModelType(schemaHandle, "Model");
+        char propertyName[32];
+        size_t i;
+        for (i = 0; i < 12; i++) /*the symbol table starts with 16 slots and grows before it is more than 3/4 full*/
+        {
+            (void)sprintf(propertyName, "Property%lu", (unsigned long)i);
+            (void)Schema_AddModelProperty(modelType, propertyName, "SomeType");
+        }
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .IgnoreArgument_size()
+            .SetReturn(NULL);
+
+        // act
+        SCHEMA_RESULT result = Schema_AddModelProperty(modelType, "Property12", "SomeType");
+
+        // assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_IS_NULL(Schema_GetModelPropertyByName(modelType, "Property12"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelPropertyByName(modelType, "Property11"));
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, Schema_AddModelProperty(modelType, "Property12", "SomeType"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelPropertyByName(modelType, "Property12"));
+
+        // cleanup
+        Schema_Destroy(schemaHandle);
+    }
+
     /* Schema_GetModelPropertyCount */
     /* Tests_SRS_SCHEMA_99_092: [Schema_GetModelPropertyCount shall return SCHEMA_INVALID_ARG if any of the arguments is NULL.] */
     TEST_FUNCTION(Schema_GetModelPropertyCount_With_NULL_modelTypeHandle_Fails)
@@ -4093,10 +4168,6 @@ BEGIN_TEST_SUITE(Schema_ut)
         
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, reportedPropertyName))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_pred();
-
         ///act
         SCHEMA_RESULT result = Schema_AddModelReportedProperty(modelType, reportedPropertyName, "int"); /*added the second time*/
 
@@ -4110,9 +4181,6 @@ BEGIN_TEST_SUITE(Schema_ut)
 
     void Schema_AddModelReportedProperty_inert_path(const char* reportedPropertyName, const char* reportedPropertyType)
     {
-        STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, reportedPropertyName))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_pred();
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument_size();
         STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, reportedPropertyName))
@@ -4162,35 +4230,19 @@ BEGIN_TEST_SUITE(Schema_ut)
         Schema_AddModelReportedProperty_inert_path(reportedPropertyName, reportedPropertyType);
         umock_c_negative_tests_snapshot();
 
-        size_t calls_that_cannot_fail[] =
-        {
-            0 /*VECTOR_find_if*/
-        };
-
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
         {
-            size_t j;
             umock_c_negative_tests_reset();
 
-            for (j = 0;j<sizeof(calls_that_cannot_fail) / sizeof(calls_that_cannot_fail[0]);j++) /*not running the tests that cannot fail*/
-            {
-                if (calls_that_cannot_fail[j] == i)
-                    break;
-            }
-
-            if (j == sizeof(calls_that_cannot_fail) / sizeof(calls_that_cannot_fail[0]))
-            {
-
-                umock_c_negative_tests_fail_call(i);
-                char temp_str[128];
-                sprintf(temp_str, "On failed call %zu", i);
+            umock_c_negative_tests_fail_call(i);
+            char temp_str[128];
+            sprintf(temp_str, "On failed call %zu", i);
 
-                ///act
-                SCHEMA_RESULT result = Schema_AddModelReportedProperty(modelType, reportedPropertyName, reportedPropertyType);
+            ///act
+            SCHEMA_RESULT result = Schema_AddModelReportedProperty(modelType, reportedPropertyName, reportedPropertyType);
 
-                ///assert
-                ASSERT_ARE_EQUAL_WITH_MSG(SCHEMA_RESULT, SCHEMA_ERROR, result, temp_str);
-            }
+            ///assert
+            ASSERT_ARE_EQUAL_WITH_MSG(SCHEMA_RESULT, SCHEMA_ERROR, result, temp_str);
         }
 
         ///clean
@@ -4320,10 +4372,6 @@ BEGIN_TEST_SUITE(Schema_ut)
         (void)Schema_AddModelReportedProperty(modelType, "a", "b");
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, "a"))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_pred();
-
         ///act
         SCHEMA_REPORTED_PROPERTY_HANDLE result = Schema_GetModelReportedPropertyByName(modelType, "a");
 
@@ -4343,10 +4391,6 @@ BEGIN_TEST_SUITE(Schema_ut)
         (void)Schema_AddModelReportedProperty(modelType, "a", "b");
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, "a"))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_pred();
-
         ///act
         SCHEMA_REPORTED_PROPERTY_HANDLE result = Schema_GetModelReportedPropertyByName(modelType, "it_wasn_t_me");
 
@@ -4688,11 +4732,6 @@ BEGIN_TEST_SUITE(Schema_ut)
 
     static void Schema_AddModelDesiredProperty_inert_path(const char* desiredPropertyName, const char* desiredPropertyType)
     {
-
-        STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, desiredPropertyName))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_pred();
-
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument_size();
 
@@ -4747,35 +4786,19 @@ BEGIN_TEST_SUITE(Schema_ut)
 
         umock_c_negative_tests_snapshot();
 
-        size_t calls_that_cannot_fail[] =
-        {
-            0 /*VECTOR_find_if*/
-        };
-
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
         {
-            size_t j;
             umock_c_negative_tests_reset();
 
-            for (j = 0;j<sizeof(calls_that_cannot_fail) / sizeof(calls_that_cannot_fail[0]);j++) /*not running the tests that cannot fail*/
-            {
-                if (calls_that_cannot_fail[j] == i)
-                    break;
-            }
-
-            if (j == sizeof(calls_that_cannot_fail) / sizeof(calls_that_cannot_fail[0]))
-            {
-
-                umock_c_negative_tests_fail_call(i);
-                char temp_str[128];
-                sprintf(temp_str, "On failed call %zu", i);
+            umock_c_negative_tests_fail_call(i);
+            char temp_str[128];
+            sprintf(temp_str, "On failed call %zu", i);
 
-                ///act
-                SCHEMA_RESULT result = Schema_AddModelDesiredProperty(modelType, desiredPropertyName, desiredPropertyType, g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 0, NULL);
+            ///act
+            SCHEMA_RESULT result = Schema_AddModelDesiredProperty(modelType, desiredPropertyName, desiredPropertyType, g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 0, NULL);
 
-                ///assert
-                ASSERT_ARE_EQUAL_WITH_MSG(SCHEMA_RESULT, SCHEMA_ERROR, result, temp_str);
-            }
+            ///assert
+            ASSERT_ARE_EQUAL_WITH_MSG(SCHEMA_RESULT, SCHEMA_ERROR, result, temp_str);
         }
 
         ///clean
@@ -4795,10 +4818,6 @@ BEGIN_TEST_SUITE(Schema_ut)
         umock_c_reset_all_calls();
 
 
-        STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, name))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_pred();
-
         ///act
         SCHEMA_RESULT result = Schema_AddModelDesiredProperty(modelType, name, type, g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 0, NULL);
 
@@ -4964,10 +4983,6 @@ BEGIN_TEST_SUITE(Schema_ut)
         umock_c_reset_all_calls();
         const char* desiredPropertyName = "a";
 
-        STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, desiredPropertyName))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_pred();
-
         ///act
         SCHEMA_DESIRED_PROPERTY_HANDLE result = Schema_GetModelDesiredPropertyByName(modelType, desiredPropertyName); /*doesn't exist because no desired properties*/
 
@@ -4989,10 +5004,6 @@ BEGIN_TEST_SUITE(Schema_ut)
         umock_c_reset_all_calls();
         const char* desiredPropertyName = "c"; /*only "a" exists*/
 
-        STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, desiredPropertyName))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_pred();
-
         ///act
         SCHEMA_DESIRED_PROPERTY_HANDLE result = Schema_GetModelDesiredPropertyByName(modelType, desiredPropertyName);
 
@@ -5014,10 +5025,6 @@ BEGIN_TEST_SUITE(Schema_ut)
         umock_c_reset_all_calls();
         const char* desiredPropertyName = "a"; /*only "a" exists*/
 
-        STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, desiredPropertyName))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_pred();
-
         ///act
         SCHEMA_DESIRED_PROPERTY_HANDLE result = Schema_GetModelDesiredPropertyByName(modelType, desiredPropertyName);
 
@@ -5953,11 +5960,6 @@ BEGIN_TEST_SUITE(Schema_ut)
         (void)Schema_CreateModelMethod(model, "method");
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_pred()
-            .IgnoreArgument_value();
-
         ///act
         SCHEMA_METHOD_HANDLE methodHandle = Schema_CreateModelMethod(model, "method");
 
@@ -5971,11 +5973,6 @@ BEGIN_TEST_SUITE(Schema_ut)
 
     static void Schema_CreateModelMethod_inert_path(void)
     {
-        STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_pred()
-            .IgnoreArgument_value();
-
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument_size();
 
@@ -6027,19 +6024,14 @@ BEGIN_TEST_SUITE(Schema_ut)
 
         for (size_t i = 0;i < umock_c_negative_tests_call_count(); i++)
         {
-            if (
-                (i != 0)
-                )
-            {
-                umock_c_negative_tests_reset();
-                umock_c_negative_tests_fail_call(i);
+            umock_c_negative_tests_reset();
+            umock_c_negative_tests_fail_call(i);
 
-                ///act
-                SCHEMA_METHOD_HANDLE methodHandle = Schema_CreateModelMethod(model, "method");
+            ///act
+            SCHEMA_METHOD_HANDLE methodHandle = Schema_CreateModelMethod(model, "method");
 
-                ///assert
-                ASSERT_IS_NULL(methodHandle);
-            }
+            ///assert
+            ASSERT_IS_NULL(methodHandle);
         }
 
         ///cleanup
@@ -6246,11 +6238,6 @@ BEGIN_TEST_SUITE(Schema_ut)
 
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_pred()
-            .IgnoreArgument_value();
-
         ///act
         SCHEMA_METHOD_HANDLE methodHandle = Schema_GetModelMethodByName(model, "method");
 
@@ -6272,11 +6259,6 @@ BEGIN_TEST_SUITE(Schema_ut)
 
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_pred()
-            .IgnoreArgument_value();
-
         ///act
         SCHEMA_METHOD_HANDLE methodHandle = Schema_GetModelMethodByName(model, "NO WAY THIS EXISTS!");
 
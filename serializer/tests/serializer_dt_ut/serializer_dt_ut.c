@@ -44,6 +44,7 @@ static void my_gballoc_free(void* s)
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "schema.h"
 #include "codefirst.h"
+#include "datamarshaller.h"
 #undef ENABLE_MOCKS
 
 #include "commanddecoder.h"
@@ -106,6 +107,12 @@ TEST_DEFINE_ENUM_TYPE(SERIALIZER_RESULT, SERIALIZER_RESULT_VALUES);
 TEST_DEFINE_ENUM_TYPE(CODEFIRST_RESULT, CODEFIRST_RESULT_VALUES);
 TEST_DEFINE_ENUM_TYPE(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_RESULT_VALUES);
+
+#define TEST_IOTHUB_MESSAGE_HANDLE ((IOTHUB_MESSAGE_HANDLE)0x4243)
+static const DATA_MARSHALLER_ENCODER TEST_JSON_ENCODER = { "application/json", "utf-8", NULL };
+static const DATA_MARSHALLER_ENCODER TEST_CBOR_ENCODER = { "application/cbor", NULL, NULL };
 
 DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
 static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
@@ -246,6 +253,7 @@ BEGIN_TEST_SUITE(serializer_dt_ut)
         (void)umocktypes_stdint_register_types();
 
         REGISTER_TYPE(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_RESULT);
+        REGISTER_TYPE(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_RESULT);
 
         REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_LL_HANDLE, void*);
@@ -260,6 +268,8 @@ BEGIN_TEST_SUITE(serializer_dt_ut)
         REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_REPORTED_STATE_CALLBACK, void*);
         
         REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_DEVICE_TWIN_CALLBACK, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(const DATA_MARSHALLER_ENCODER*, void*);
         
         REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_SetDeviceTwinCallback, my_IoTHubClient_SetDeviceTwinCallback);
         REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_LL_SetDeviceTwinCallback, my_IoTHubClient_LL_SetDeviceTwinCallback);
@@ -272,6 +282,10 @@ BEGIN_TEST_SUITE(serializer_dt_ut)
         REGISTER_GLOBAL_MOCK_RETURNS(CodeFirst_ExecuteMethod, TEST_METHODRETURN_HANDLE, NULL);
         REGISTER_GLOBAL_MOCK_RETURNS(IoTHubClient_SendReportedState, IOTHUB_CLIENT_OK, IOTHUB_CLIENT_ERROR);
         REGISTER_GLOBAL_MOCK_RETURNS(IoTHubClient_LL_SendReportedState, IOTHUB_CLIENT_OK, IOTHUB_CLIENT_ERROR);
+        REGISTER_GLOBAL_MOCK_RETURN(DataMarshaller_GetDefaultEncoder, &TEST_JSON_ENCODER);
+        REGISTER_GLOBAL_MOCK_RETURNS(CodeFirst_GetEncoder, &TEST_JSON_ENCODER, NULL);
+        REGISTER_GLOBAL_MOCK_RETURNS(IoTHubMessage_SetContentTypeSystemProperty, IOTHUB_MESSAGE_OK, IOTHUB_MESSAGE_ERROR);
+        REGISTER_GLOBAL_MOCK_RETURNS(IoTHubMessage_SetContentEncodingSystemProperty, IOTHUB_MESSAGE_OK, IOTHUB_MESSAGE_ERROR);
         
         
         REGISTER_GLOBAL_MOCK_RETURNS(IoTHubClient_SetDeviceTwinCallback, IOTHUB_CLIENT_OK, IOTHUB_CLIENT_ERROR);
@@ -995,6 +1009,135 @@ BEGIN_TEST_SUITE(serializer_dt_ut)
         umock_c_negative_tests_deinit();
     }
 
+    /*Tests_SRS_SERIALIZERDEVICETWIN_09_001: [ If model or messageHandle is NULL then serializer_setmessagecontenttype shall fail and return IOTHUB_MESSAGE_INVALID_ARG. ]*/
+    TEST_FUNCTION(serializer_setmessagecontenttype_with_NULL_model_fails)
+    {
+        ///arrange
+
+        ///act
+        IOTHUB_MESSAGE_RESULT r = serializer_setmessagecontenttype(NULL, TEST_IOTHUB_MESSAGE_HANDLE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, r);
+    }
+
+    /*Tests_SRS_SERIALIZERDEVICETWIN_09_001: [ If model or messageHandle is NULL then serializer_setmessagecontenttype shall fail and return IOTHUB_MESSAGE_INVALID_ARG. ]*/
+    TEST_FUNCTION(serializer_setmessagecontenttype_with_NULL_messageHandle_fails)
+    {
+        ///arrange
+
+        ///act
+        IOTHUB_MESSAGE_RESULT r = serializer_setmessagecontenttype(TEST_DEVICE_HANDLE, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, r);
+    }
+
+    /*Tests_SRS_SERIALIZERDEVICETWIN_09_005: [ If CodeFirst_GetEncoder returns NULL then serializer_setmessagecontenttype shall fail and return IOTHUB_MESSAGE_INVALID_ARG. ]*/
+    TEST_FUNCTION(serializer_setmessagecontenttype_with_an_unknown_model_fails)
+    {
+        ///arrange
+        STRICT_EXPECTED_CALL(CodeFirst_GetEncoder(TEST_DEVICE_HANDLE))
+            .SetReturn(NULL);
+
+        ///act
+        IOTHUB_MESSAGE_RESULT r = serializer_setmessagecontenttype(TEST_DEVICE_HANDLE, TEST_IOTHUB_MESSAGE_HANDLE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, r);
+    }
+
+    /*Tests_SRS_SERIALIZERDEVICETWIN_09_002: [ serializer_setmessagecontenttype shall call IoTHubMessage_SetContentTypeSystemProperty with the contentType of the encoder returned by CodeFirst_GetEncoder for model, which is the encoder of the DataMarshaller instance of model. ]*/
+    /*Tests_SRS_SERIALIZERDEVICETWIN_09_003: [ If the contentEncoding of the encoder is not NULL then serializer_setmessagecontenttype shall call IoTHubMessage_SetContentEncodingSystemProperty with it. ]*/
+    /*Tests_SRS_SERIALIZERDEVICETWIN_09_004: [ If any of the above calls fails then serializer_setmessagecontenttype shall return the error of the call, otherwise it shall return IOTHUB_MESSAGE_OK. ]*/
+    TEST_FUNCTION(serializer_setmessagecontenttype_sets_the_content_type_and_encoding_of_the_JSON_encoder)
+    {
+        ///arrange
+        STRICT_EXPECTED_CALL(CodeFirst_GetEncoder(TEST_DEVICE_HANDLE));
+        STRICT_EXPECTED_CALL(IoTHubMessage_SetContentTypeSystemProperty(TEST_IOTHUB_MESSAGE_HANDLE, "application/json"));
+        STRICT_EXPECTED_CALL(IoTHubMessage_SetContentEncodingSystemProperty(TEST_IOTHUB_MESSAGE_HANDLE, "utf-8"));
+
+        ///act
+        IOTHUB_MESSAGE_RESULT r = serializer_setmessagecontenttype(TEST_DEVICE_HANDLE, TEST_IOTHUB_MESSAGE_HANDLE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, r);
+    }
+
+    /*Tests_SRS_SERIALIZERDEVICETWIN_09_003: [ If the contentEncoding of the encoder is not NULL then serializer_setmessagecontenttype shall call IoTHubMessage_SetContentEncodingSystemProperty with it. ]*/
+    TEST_FUNCTION(serializer_setmessagecontenttype_does_not_set_a_content_encoding_for_the_CBOR_encoder)
+    {
+        ///arrange
+        STRICT_EXPECTED_CALL(CodeFirst_GetEncoder(TEST_DEVICE_HANDLE))
+            .SetReturn(&TEST_CBOR_ENCODER);
+        STRICT_EXPECTED_CALL(IoTHubMessage_SetContentTypeSystemProperty(TEST_IOTHUB_MESSAGE_HANDLE, "application/cbor"));
 
+        ///act
+        IOTHUB_MESSAGE_RESULT r = serializer_setmessagecontenttype(TEST_DEVICE_HANDLE, TEST_IOTHUB_MESSAGE_HANDLE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, r);
+    }
+
+    /*Tests_SRS_SERIALIZERDEVICETWIN_09_002: [ serializer_setmessagecontenttype shall call IoTHubMessage_SetContentTypeSystemProperty with the contentType of the encoder returned by CodeFirst_GetEncoder for model, which is the encoder of the DataMarshaller instance of model. ]*/
+    TEST_FUNCTION(serializer_setmessagecontenttype_uses_the_encoder_of_the_model_after_the_default_encoder_changes)
+    {
+        ///arrange
+        (void)SERIALIZER_REGISTER_NAMESPACE(basic15);
+        basicModel_WithData15* model = IoTHubDeviceTwin_LL_CreatebasicModel_WithData15(TEST_IOTHUB_CLIENT_LL_HANDLE);
+        umock_c_reset_all_calls();
+
+        /*the model was created with JSON, CBOR becomes the default afterwards*/
+        REGISTER_GLOBAL_MOCK_RETURN(DataMarshaller_GetDefaultEncoder, &TEST_CBOR_ENCODER);
+
+        STRICT_EXPECTED_CALL(CodeFirst_GetEncoder(model))
+            .SetReturn(&TEST_JSON_ENCODER);
+        STRICT_EXPECTED_CALL(IoTHubMessage_SetContentTypeSystemProperty(TEST_IOTHUB_MESSAGE_HANDLE, "application/json"));
+        STRICT_EXPECTED_CALL(IoTHubMessage_SetContentEncodingSystemProperty(TEST_IOTHUB_MESSAGE_HANDLE, "utf-8"));
+
+        ///act
+        IOTHUB_MESSAGE_RESULT r = serializer_setmessagecontenttype(model, TEST_IOTHUB_MESSAGE_HANDLE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, r);
+
+        ///clean
+        REGISTER_GLOBAL_MOCK_RETURN(DataMarshaller_GetDefaultEncoder, &TEST_JSON_ENCODER);
+        IoTHubDeviceTwin_LL_DestroybasicModel_WithData15(model);
+    }
+
+    /*Tests_SRS_SERIALIZERDEVICETWIN_09_004: [ If any of the above calls fails then serializer_setmessagecontenttype shall return the error of the call, otherwise it shall return IOTHUB_MESSAGE_OK. ]*/
+    TEST_FUNCTION(serializer_setmessagecontenttype_unhappy_paths)
+    {
+        ///arrange
+        umock_c_negative_tests_init();
+
+        STRICT_EXPECTED_CALL(CodeFirst_GetEncoder(TEST_DEVICE_HANDLE));
+        STRICT_EXPECTED_CALL(IoTHubMessage_SetContentTypeSystemProperty(TEST_IOTHUB_MESSAGE_HANDLE, "application/json"));
+        STRICT_EXPECTED_CALL(IoTHubMessage_SetContentEncodingSystemProperty(TEST_IOTHUB_MESSAGE_HANDLE, "utf-8"));
+
+        umock_c_negative_tests_snapshot();
+
+        for (size_t i = 1; i < umock_c_negative_tests_call_count(); i++) /*CodeFirst_GetEncoder failing is serializer_setmessagecontenttype_with_an_unknown_model_fails*/
+        {
+            umock_c_negative_tests_reset();
+            umock_c_negative_tests_fail_call(i);
+
+            ///act
+            IOTHUB_MESSAGE_RESULT r = serializer_setmessagecontenttype(TEST_DEVICE_HANDLE, TEST_IOTHUB_MESSAGE_HANDLE);
+
+            ///assert
+            ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_ERROR, r);
+        }
+
+        ///clean
+        umock_c_negative_tests_deinit();
+    }
 
 END_TEST_SUITE(serializer_dt_ut)
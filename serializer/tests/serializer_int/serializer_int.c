@@ -2422,4 +2422,172 @@ BEGIN_TEST_SUITE(serializer_int)
     }
 
 
+    /*Tests_SRS_SERIALIZER_H_09_002: [ SERIALIZE_MODEL shall call the SerializeModel_modelName function declared by DECLARE_MODEL, passing destination, destinationSize and the address of modelInstance. ]*/
+    /*Tests_SRS_SERIALIZER_H_09_003: [ Each field shall be written as "name": followed by the value produced by ToJSON_type, which formats the value the same way AgentDataTypes_ToString does. ]*/
+    /*Tests_SRS_SERIALIZER_H_09_007: [ On success SerializeModel_name shall hand the written buffer to the caller in *destination and *destinationSize and return CODEFIRST_OK. ]*/
+    TEST_FUNCTION(SERIALIZE_MODEL_WITH_DATA_IN_ROOT_MODEL_produces_the_same_JSON_as_SERIALIZE)
+    {
+        ///arrange
+        basicModel_WithData1 *modelWithData = CREATE_MODEL_INSTANCE(basic1, basicModel_WithData1, true);
+
+        modelWithData->with_data_double1 = 1.0;
+        modelWithData->with_data_int1 = 2;
+        modelWithData->with_data_float1 = 3.0;
+        modelWithData->with_data_long1 = 4;
+        modelWithData->with_data_sint8_t1 = 5;
+        modelWithData->with_data_uint8_t1 = 6;
+        modelWithData->with_data_int16_t1 = 7;
+        modelWithData->with_data_int32_t1 = 8;
+        modelWithData->with_data_int64_t1 = 9;
+        modelWithData->with_data_bool1 = true;
+        modelWithData->with_data_ascii_char_ptr1 = "e/leven";
+        modelWithData->with_data_ascii_char_ptr_no_quotes1 = "\"twelve\"";
+        modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_year = 114;
+        modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_mon = 6 - 1;
+        modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_mday = 17;
+        modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_hour = 8;
+        modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_min = 51;
+        modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_sec = 23;
+        modelWithData->with_data_EdmDateTimeOffset1.hasFractionalSecond = 1;
+        modelWithData->with_data_EdmDateTimeOffset1.fractionalSecond = 5;
+        modelWithData->with_data_EdmDateTimeOffset1.hasTimeZone = 1;
+        modelWithData->with_data_EdmDateTimeOffset1.timeZoneHour = -8;
+        modelWithData->with_data_EdmDateTimeOffset1.timeZoneMinute = 1;
+        for (size_t i = 0; i < 16; i++)
+        {
+            modelWithData->with_data_EdmGuid1.GUID[i] = (unsigned char)(i * 0x11);
+        }
+
+        unsigned char edmBinary[3] = { '3', '4', '5' };
+        modelWithData->with_data_EdmBinary1.data = edmBinary;
+        modelWithData->with_data_EdmBinary1.size = 3;
+
+        const char* expectedJsonAsString =
+            "{                                                                                   \
+            \"with_data_double1\" : 1.0,                                                          \
+            \"with_data_int1\" : 2,                                                               \
+            \"with_data_float1\" : 3.000000,                                                      \
+            \"with_data_long1\" : 4,                                                              \
+            \"with_data_sint8_t1\" : 5,                                                           \
+            \"with_data_uint8_t1\" : 6,                                                           \
+            \"with_data_int16_t1\" : 7,                                                           \
+            \"with_data_int32_t1\" : 8,                                                           \
+            \"with_data_int64_t1\" : 9,                                                           \
+            \"with_data_bool1\" : true,                                                           \
+            \"with_data_ascii_char_ptr1\" : \"e/leven\",                                          \
+            \"with_data_ascii_char_ptr_no_quotes1\" : \"twelve\",                                 \
+            \"with_data_EdmDateTimeOffset1\" : \"2014-06-17T08:51:23.000000000005-08:01\",        \
+            \"with_data_EdmGuid1\" : \"00112233-4455-6677-8899-AABBCCDDEEFF\",                    \
+            \"with_data_EdmBinary1\": \"MzQ1\"                                                    \
+        }";
+
+        unsigned char* destination;
+        size_t destinationSize;
+
+        ///act
+        CODEFIRST_RESULT result = SERIALIZE_MODEL(basicModel_WithData1, &destination, &destinationSize, *modelWithData);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_IS_TRUE(areTwoJsonsEqual(destination, destinationSize, expectedJsonAsString));
+
+        ///clean
+        free(destination);
+        DESTROY_MODEL_INSTANCE(modelWithData);
+    }
+
+    /*Tests_SRS_SERIALIZER_H_09_003: [ Each field shall be written as "name": followed by the value produced by ToJSON_type, which formats the value the same way AgentDataTypes_ToString does. ]*/
+    TEST_FUNCTION(SERIALIZE_MODEL_WITH_DATA_IN_MODEL_IN_MODEL_produces_the_same_JSON_as_SERIALIZE)
+    {
+        ///arrange
+        basicModel_WithModel3 *modelWithModel = CREATE_MODEL_INSTANCE(basic3, basicModel_WithModel3, true);
+
+        modelWithModel->model3.with_data_double3 = -1.5;
+        modelWithModel->model3.with_data_int3 = -2;
+        modelWithModel->model3.with_data_float3 = 3.25f;
+        modelWithModel->model3.with_data_long3 = -4;
+        modelWithModel->model3.with_data_sint8_t3 = -5;
+        modelWithModel->model3.with_data_uint8_t3 = 250;
+        modelWithModel->model3.with_data_int16_t3 = -7;
+        modelWithModel->model3.with_data_int32_t3 = -8;
+        modelWithModel->model3.with_data_int64_t3 = -9;
+        modelWithModel->model3.with_data_bool3 = false;
+        modelWithModel->model3.with_data_ascii_char_ptr3 = "quote\" backslash\\ tab\t";
+        modelWithModel->model3.with_data_ascii_char_ptr_no_quotes3 = "[1, 2]";
+
+        unsigned char edmBinary[4] = { 0, 1, 2, 3 };
+        modelWithModel->model3.with_data_EdmBinary3.data = edmBinary;
+        modelWithModel->model3.with_data_EdmBinary3.size = 4;
+
+        unsigned char* serializeDestination;
+        size_t serializeDestinationSize;
+        unsigned char* destination;
+        size_t destinationSize;
+
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, SERIALIZE(&serializeDestination, &serializeDestinationSize, *modelWithModel));
+        char* expectedJsonAsString = (char*)malloc(serializeDestinationSize + 1);
+        ASSERT_IS_NOT_NULL(expectedJsonAsString);
+        (void)memcpy(expectedJsonAsString, serializeDestination, serializeDestinationSize);
+        expectedJsonAsString[serializeDestinationSize] = '\0';
+
+        ///act
+        CODEFIRST_RESULT result = SERIALIZE_MODEL(basicModel_WithModel3, &destination, &destinationSize, *modelWithModel);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_IS_TRUE(areTwoJsonsEqual(destination, destinationSize, expectedJsonAsString));
+
+        ///clean
+        free(destination);
+        free(expectedJsonAsString);
+        free(serializeDestination);
+        DESTROY_MODEL_INSTANCE(modelWithModel);
+    }
+
+    /*Tests_SRS_SERIALIZER_H_09_001: [ DECLARE_STRUCT shall declare a function ToJSON_name that writes a struct value as a JSON object straight from its fields. ]*/
+    TEST_FUNCTION(SERIALIZE_MODEL_does_not_need_a_model_instance_created_by_CREATE_MODEL_INSTANCE)
+    {
+        ///arrange
+        basicModel_WithStruct2 modelWithStruct;
+        (void)memset(&modelWithStruct, 0, sizeof(modelWithStruct));
+        modelWithStruct.structure2.with_data_int2 = 42;
+        modelWithStruct.structure2.with_data_ascii_char_ptr2 = "a";
+        modelWithStruct.structure2.with_data_ascii_char_ptr_no_quotes2 = "null";
+
+        const char* expectedJsonAsString =
+            "{                                                                                       \
+            \"structure2\":                                                                          \
+            {                                                                                        \
+                \"with_data_double2\" : 0.0,                                                         \
+                \"with_data_int2\" : 42,                                                             \
+                \"with_data_float2\" : 0.0,                                                          \
+                \"with_data_long2\" : 0,                                                             \
+                \"with_data_sint8_t2\" : 0,                                                          \
+                \"with_data_uint8_t2\" : 0,                                                          \
+                \"with_data_int16_t2\" : 0,                                                          \
+                \"with_data_int32_t2\" : 0,                                                          \
+                \"with_data_int64_t2\" : 0,                                                          \
+                \"with_data_bool2\" : false,                                                         \
+                \"with_data_ascii_char_ptr2\" : \"a\",                                               \
+                \"with_data_ascii_char_ptr_no_quotes2\" : null,                                      \
+                \"with_data_EdmDateTimeOffset2\" : \"1900-00-00T00:00:00Z\",                         \
+                \"with_data_EdmGuid2\" : \"00000000-0000-0000-0000-000000000000\",                   \
+                \"with_data_EdmBinary2\": \"\"                                                       \
+            }                                                                                        \
+        }";
+
+        unsigned char* destination;
+        size_t destinationSize;
+
+        ///act
+        CODEFIRST_RESULT result = SERIALIZE_MODEL(basicModel_WithStruct2, &destination, &destinationSize, modelWithStruct);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_IS_TRUE(areTwoJsonsEqual(destination, destinationSize, expectedJsonAsString));
+
+        ///clean
+        free(destination);
+    }
+
 END_TEST_SUITE(serializer_int)